@@ -37,17 +37,28 @@ void LanguageBasedAnalyzer::setLanguage(const TCHAR* language){
 void LanguageBasedAnalyzer::setStem(bool stem){
 	this->stem = stem;
 }
-TokenStream* LanguageBasedAnalyzer::tokenStream(const TCHAR* fieldName, Reader* reader) {
+class LanguageBasedAnalyzer::SavedStreams : public TokenStream {
+public:
+	Tokenizer* source;
+	TokenStream* result;
+	TCHAR lang[100];
+	bool stem;
+
+	SavedStreams(const TCHAR* lang, bool stem):source(NULL), result(NULL), stem(stem){
+		_tcsncpy(this->lang,lang,100);
+	}
+	virtual ~SavedStreams(){ _CLDELETE(result); }
+
+	void close(){}
+	Token* next(Token* token) {return NULL;}
+};
+
+TokenStream* LanguageBasedAnalyzer::createStream(Reader* reader, Tokenizer*& source) {
 	TokenStream* ret = NULL;
 	if ( _tcscmp(lang, _T("cjk"))==0 ){
-		ret = _CLNEW CL_NS2(analysis,cjk)::CJKTokenizer(reader);
+		ret = source = _CLNEW CL_NS2(analysis,cjk)::CJKTokenizer(reader);
 	}else{
-    BufferedReader* bufferedReader = reader->__asBufferedReader();
-    if ( bufferedReader == NULL )
-      ret =  _CLNEW StandardTokenizer( _CLNEW FilteredBufferedReader(reader, false), true );
-    else
-      ret = _CLNEW StandardTokenizer(bufferedReader);
-
+		ret = source = _CLNEW StandardTokenizer(reader);
 		ret = _CLNEW StandardFilter(ret,true);
 
 		if ( stem )
@@ -64,4 +75,28 @@ TokenStream* LanguageBasedAnalyzer::tokenStream(const TCHAR* fieldName, Reader*
 	return ret;
 }
 
+TokenStream* LanguageBasedAnalyzer::tokenStream(const TCHAR* fieldName, Reader* reader) {
+	Tokenizer* source;
+	return createStream(reader, source);
+}
+
+TokenStream* LanguageBasedAnalyzer::reusableTokenStream(const TCHAR* fieldName, Reader* reader) {
+	SavedStreams* streams = reinterpret_cast<SavedStreams*>(getPreviousTokenStream());
+	if ( streams != NULL && streams->stem == stem && _tcscmp(streams->lang, lang)==0 ){
+		streams->source->reset(reader);
+		return streams->result;
+	}
+
+	//first call on this thread, or the settings changed: build a new chain
+	streams = _CLNEW SavedStreams(lang, stem);
+	try{
+		streams->result = createStream(reader, streams->source);
+	}catch(CLuceneError&){
+		_CLDELETE(streams);
+		throw;
+	}
+	setPreviousTokenStream(streams); //deletes the previous chain, if any
+	return streams->result;
+}
+
 CL_NS_END
@@ -16,12 +16,18 @@ CL_NS_DEF(analysis)
 class CLUCENE_CONTRIBS_EXPORT LanguageBasedAnalyzer: public CL_NS(analysis)::Analyzer{
 	TCHAR lang[100];
 	bool stem;
+	class SavedStreams;
+	TokenStream* createStream(CL_NS(util)::Reader* reader, Tokenizer*& source);
 public:
 	LanguageBasedAnalyzer(const TCHAR* language=NULL, bool stem=true);
 	~LanguageBasedAnalyzer();
 	void setLanguage(const TCHAR* language);
 	void setStem(bool stem);
 	TokenStream* tokenStream(const TCHAR* fieldName, CL_NS(util)::Reader* reader);
+
+	/** Re-uses this thread's previous chain unless the language or
+	* stemming setting has changed since it was built. */
+	TokenStream* reusableTokenStream(const TCHAR* fieldName, CL_NS(util)::Reader* reader);
   };
 
 CL_NS_END
@@ -9,6 +9,7 @@
 #include "CLucene/_ApiHeader.h"
 #include "CJKAnalyzer.h"
 #include "CLucene/util/CLStreams.h"
+#include "CLucene/analysis/Analyzers.h"
 
 CL_NS_DEF2(analysis,cjk)
 CL_NS_USE(analysis)
@@ -189,4 +190,74 @@ CL_NS(analysis)::Token* CJKTokenizer::next(Token* token){
 	return token;
 }
 
+void CJKTokenizer::reset(Reader* input)
+{
+	Tokenizer::reset(input);
+	tokenType = Token::getDefaultType();
+	offset = 0;
+	bufferIndex = 0;
+	dataLen = 0;
+	preIsTokened = false;
+}
+
+
+const TCHAR* CJKAnalyzer::STOP_WORDS[] = {
+	_T("a"), _T("and"), _T("are"), _T("as"), _T("at"), _T("be"),
+	_T("but"), _T("by"), _T("for"), _T("if"), _T("in"),
+	_T("into"), _T("is"), _T("it"), _T("no"), _T("not"),
+	_T("of"), _T("on"), _T("or"), _T("s"), _T("such"),
+	_T("t"), _T("that"), _T("the"), _T("their"), _T("then"),
+	_T("there"), _T("these"), _T("they"), _T("this"), _T("to"),
+	_T("was"), _T("will"), _T("with"), _T(""), _T("www"), NULL
+};
+
+class CJKAnalyzer::SavedStreams : public TokenStream {
+public:
+	CJKTokenizer* source;
+	TokenStream* result;
+
+	SavedStreams():source(NULL), result(NULL) {}
+	virtual ~SavedStreams() { _CLDELETE(result); }
+
+	void close() {}
+	Token* next(Token* token) { return NULL; }
+};
+
+CJKAnalyzer::CJKAnalyzer():
+	stopTable(_CLNEW CLTCSetList(true))
+{
+	StopFilter::fillStopTable(stopTable, STOP_WORDS);
+}
+
+CJKAnalyzer::CJKAnalyzer(const TCHAR** stopWords):
+	stopTable(_CLNEW CLTCSetList(true))
+{
+	StopFilter::fillStopTable(stopTable, stopWords);
+}
+
+CJKAnalyzer::~CJKAnalyzer()
+{
+	//the saved streams of every thread are deleted by ~Analyzer
+	_CLDELETE(stopTable);
+}
+
+TokenStream* CJKAnalyzer::tokenStream(const TCHAR* /*fieldName*/, Reader* reader)
+{
+	return _CLNEW StopFilter(_CLNEW CJKTokenizer(reader), true, stopTable);
+}
+
+TokenStream* CJKAnalyzer::reusableTokenStream(const TCHAR* /*fieldName*/, Reader* reader)
+{
+	SavedStreams* streams = reinterpret_cast<SavedStreams*>(getPreviousTokenStream());
+	if (streams == NULL) {
+		streams = _CLNEW SavedStreams();
+		streams->source = _CLNEW CJKTokenizer(reader);
+		streams->result = _CLNEW StopFilter(streams->source, true, stopTable);
+		setPreviousTokenStream(streams);
+	}
+	else
+		streams->source->reset(reader);
+	return streams->result;
+}
+
 CL_NS_END2
@@ -86,10 +86,37 @@ public:
      */
 	CL_NS(analysis)::Token* next(CL_NS(analysis)::Token* token);
 
+	/** Resets the tokenizer to read from a new reader */
+	void reset(CL_NS(util)::Reader* input);
+
 	bool getIgnoreSurrogates(){ return ignoreSurrogates; };
 	void setIgnoreSurrogates(bool ignoreSurrogates){ this->ignoreSurrogates = ignoreSurrogates; };
 };
 
+/**
+ * Filters {@link CJKTokenizer} with {@link lucene::analysis::StopFilter}.
+ */
+class CLUCENE_CONTRIBS_EXPORT CJKAnalyzer: public CL_NS(analysis)::Analyzer {
+private:
+	CL_NS(analysis)::CLTCSetList* stopTable;
+	class SavedStreams;
+public:
+	/** Builds an analyzer which removes words in STOP_WORDS. */
+	CJKAnalyzer();
+
+	/** Builds an analyzer which removes words in the provided array. */
+	CJKAnalyzer(const TCHAR** stopWords);
+	virtual ~CJKAnalyzer();
+
+	/** Filters CJKTokenizer with StopFilter. */
+	CL_NS(analysis)::TokenStream* tokenStream(const TCHAR* fieldName, CL_NS(util)::Reader* reader);
+	CL_NS(analysis)::TokenStream* reusableTokenStream(const TCHAR* fieldName, CL_NS(util)::Reader* reader);
+
+	/** An array containing some common English words that are not usually
+	* useful for searching and some double-byte interpunctions. */
+	static const TCHAR* STOP_WORDS[];
+};
+
 
 
 CL_NS_END2
@@ -18,8 +18,8 @@ CL_NS_USE(analysis)
 CL_NS_USE2(analysis,de)
 CL_NS_USE2(analysis,standard)
 
-  const TCHAR GermanAnalyzer_DASZ[] = { 0x64, 0x61, 0xdf };
-  const TCHAR GermanAnalyzer_FUER[] = { 0x66, 0xfc, 0x72 };
+  const TCHAR GermanAnalyzer_DASZ[] = { 0x64, 0x61, 0xdf, 0 };
+  const TCHAR GermanAnalyzer_FUER[] = { 0x66, 0xfc, 0x72, 0 };
   const TCHAR* GermanAnalyzer_GERMAN_STOP_WORDS[] = {
     _T("einer"), _T("eine"), _T("eines"), _T("einem"), _T("einen"),
     _T("der"), _T("die"), _T("das"), _T("dass"), GermanAnalyzer_DASZ,
@@ -32,7 +32,7 @@ CL_NS_USE2(analysis,standard)
     _T("als"), GermanAnalyzer_FUER, _T("von"), _T("mit"),
     _T("dich"), _T("dir"), _T("mich"), _T("mir"),
     _T("mein"), _T("sein"), _T("kein"),
-    _T("durch"), _T("wegen"), _T("wird")
+    _T("durch"), _T("wegen"), _T("wird"), NULL
   };
 
   CL_NS(util)::ConstValueArray<const TCHAR*> GermanAnalyzer::GERMAN_STOP_WORDS( GermanAnalyzer_GERMAN_STOP_WORDS, 48 );
@@ -41,10 +41,15 @@ CL_NS_USE2(analysis,standard)
   public:
       StandardTokenizer* tokenStream;
       TokenStream* filteredTokenStream;
+      int32_t exclusionGeneration;
 
-      SavedStreams():tokenStream(NULL), filteredTokenStream(NULL)
+      SavedStreams(int32_t exclusionGeneration):tokenStream(NULL), filteredTokenStream(NULL),
+        exclusionGeneration(exclusionGeneration)
       {
       }
+      virtual ~SavedStreams(){
+        _CLDELETE(filteredTokenStream);
+      }
 
       void close(){}
       Token* next(Token* token) {return NULL;}
@@ -52,28 +57,33 @@ CL_NS_USE2(analysis,standard)
 
   GermanAnalyzer::GermanAnalyzer() {
     exclusionSet = NULL;
+    exclusionGeneration = 0;
     stopSet = _CLNEW CLTCSetList;
     StopFilter::fillStopTable(stopSet, GERMAN_STOP_WORDS.values);
   }
 
   GermanAnalyzer::GermanAnalyzer(const TCHAR** stopwords) {
     exclusionSet = NULL;
+    exclusionGeneration = 0;
     stopSet = _CLNEW CLTCSetList;
     StopFilter::fillStopTable(stopSet, stopwords);
   }
 
   GermanAnalyzer::GermanAnalyzer(CL_NS(analysis)::CLTCSetList* stopwords) {
     exclusionSet = NULL;
+    exclusionGeneration = 0;
     stopSet = stopwords;
   }
 
   GermanAnalyzer::GermanAnalyzer(const char* stopwordsFile, const char* enc) {
     exclusionSet = NULL;
+    exclusionGeneration = 0;
     stopSet = WordlistLoader::getWordSet(stopwordsFile, enc);
   }
 
   GermanAnalyzer::GermanAnalyzer(CL_NS(util)::Reader* stopwordsReader, const bool deleteReader) {
     exclusionSet = NULL;
+    exclusionGeneration = 0;
     stopSet = WordlistLoader::getWordSet(stopwordsReader, NULL, deleteReader);
   }
 
@@ -90,6 +100,7 @@ CL_NS_USE2(analysis,standard)
     }
 
     CL_NS(analysis)::StopFilter::fillStopTable(exclusionSet, exclusionlist);
+    exclusionGeneration++; // force new stemmers to be created
   }
 
   void GermanAnalyzer::setStemExclusionTable(CL_NS(analysis)::CLTCSetList* exclusionlist) {
@@ -97,25 +108,21 @@ CL_NS_USE2(analysis,standard)
       _CLLDELETE(exclusionSet);
       exclusionSet = exclusionlist;
     }
+    exclusionGeneration++; // force new stemmers to be created
   }
 
   void GermanAnalyzer::setStemExclusionTable(const char* exclusionlistFile, const char* enc) {
     exclusionSet = WordlistLoader::getWordSet(exclusionlistFile, enc, exclusionSet);
+    exclusionGeneration++; // force new stemmers to be created
   }
 
   void GermanAnalyzer::setStemExclusionTable(CL_NS(util)::Reader* exclusionlistReader, const bool deleteReader) {
     exclusionSet = WordlistLoader::getWordSet(exclusionlistReader, exclusionSet, deleteReader);
+    exclusionGeneration++; // force new stemmers to be created
   }
 
   TokenStream* GermanAnalyzer::tokenStream(const TCHAR* fieldName, CL_NS(util)::Reader* reader) {
-    TokenStream* result;
-    CL_NS(util)::BufferedReader* bufferedReader = reader->__asBufferedReader();
-
-    if ( bufferedReader == NULL )
-      result = _CLNEW StandardTokenizer( _CLNEW CL_NS(util)::FilteredBufferedReader(reader, false), true );
-    else
-      result = _CLNEW StandardTokenizer(bufferedReader);
-
+    TokenStream* result = _CLNEW StandardTokenizer(reader);
     result = _CLNEW StandardFilter(result, true);
     result = _CLNEW LowerCaseFilter(result, true);
     result = _CLNEW StopFilter(result, true, stopSet);
@@ -128,15 +135,11 @@ CL_NS_USE2(analysis,standard)
   {
     SavedStreams* streams = reinterpret_cast<SavedStreams*>(getPreviousTokenStream());
 
-    if (streams == NULL) {
-      streams = _CLNEW SavedStreams();
-      CL_NS(util)::BufferedReader* bufferedReader = reader->__asBufferedReader();
-
-      if ( bufferedReader == NULL )
-        streams->tokenStream = _CLNEW StandardTokenizer( _CLNEW CL_NS(util)::FilteredBufferedReader(reader, false), true );
-      else
-        streams->tokenStream = _CLNEW StandardTokenizer(bufferedReader);
-
+    // Rebuild the chain if this thread has none yet, or it still stems
+    // with an exclusion table that has since been replaced
+    if (streams == NULL || streams->exclusionGeneration != exclusionGeneration) {
+      streams = _CLNEW SavedStreams(exclusionGeneration);
+      streams->tokenStream = _CLNEW StandardTokenizer(reader);
       streams->filteredTokenStream = _CLNEW StandardFilter(streams->tokenStream, true);
       streams->filteredTokenStream = _CLNEW LowerCaseFilter(streams->filteredTokenStream, true);
       streams->filteredTokenStream = _CLNEW StopFilter(streams->filteredTokenStream, true, stopSet);
@@ -41,6 +41,12 @@ private:
    */
   CL_NS(analysis)::CLTCSetList* exclusionSet;
 
+  /**
+   * Bumped whenever the exclusion table changes, so that the chains
+   * cached for every thread are rebuilt on their next use.
+   */
+  int32_t exclusionGeneration;
+
 public:
 
   /**
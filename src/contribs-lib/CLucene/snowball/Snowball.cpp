@@ -27,6 +27,22 @@ CL_NS_DEF2(analysis,snowball)
 	stopSet = NULL;
   }
 
+  class SnowballAnalyzer::SavedStreams : public TokenStream {
+  public:
+    StandardTokenizer* tokenStream;
+    TokenStream* filteredTokenStream;
+
+    SavedStreams():tokenStream(NULL), filteredTokenStream(NULL)
+    {
+    }
+    virtual ~SavedStreams(){
+      _CLDELETE(filteredTokenStream);
+    }
+
+    void close(){}
+    Token* next(Token* token) {return NULL;}
+  };
+
   SnowballAnalyzer::~SnowballAnalyzer(){
 	  _CLDELETE_CARRAY(language);
 	  if ( stopSet != NULL )
@@ -49,21 +65,36 @@ CL_NS_DEF2(analysis,snowball)
   /** Constructs a {@link StandardTokenizer} filtered by a {@link
       StandardFilter}, a {@link LowerCaseFilter} and a {@link StopFilter}. */
   TokenStream* SnowballAnalyzer::tokenStream(const TCHAR* fieldName, CL_NS(util)::Reader* reader, bool deleteReader) {
-		BufferedReader* bufferedReader = reader->__asBufferedReader();
-		TokenStream* result;
-
-		if ( bufferedReader == NULL )
-			result =  _CLNEW StandardTokenizer( _CLNEW FilteredBufferedReader(reader, deleteReader), true );
-		else
-			result = _CLNEW StandardTokenizer(bufferedReader, deleteReader);
-
-	 result = _CLNEW StandardFilter(result, true);
+    TokenStream* result = _CLNEW StandardTokenizer(reader, deleteReader);
+    result = _CLNEW StandardFilter(result, true);
     result = _CLNEW CL_NS(analysis)::LowerCaseFilter(result, true);
     if (stopSet != NULL)
       result = _CLNEW CL_NS(analysis)::StopFilter(result, true, stopSet);
     result = _CLNEW SnowballFilter(result, language, true);
     return result;
   }
+
+  TokenStream* SnowballAnalyzer::reusableTokenStream(const TCHAR* fieldName, CL_NS(util)::Reader* reader) {
+    SavedStreams* streams = reinterpret_cast<SavedStreams*>(getPreviousTokenStream());
+    if (streams == NULL) {
+      streams = _CLNEW SavedStreams();
+      streams->tokenStream = _CLNEW StandardTokenizer(reader);
+      streams->filteredTokenStream = _CLNEW StandardFilter(streams->tokenStream, true);
+      streams->filteredTokenStream = _CLNEW CL_NS(analysis)::LowerCaseFilter(streams->filteredTokenStream, true);
+      if (stopSet != NULL)
+        streams->filteredTokenStream = _CLNEW CL_NS(analysis)::StopFilter(streams->filteredTokenStream, true, stopSet);
+      try{
+        streams->filteredTokenStream = _CLNEW SnowballFilter(streams->filteredTokenStream, language, true);
+      }catch(CLuceneError&){
+        _CLDELETE(streams); //unknown language: don't keep a chain without its stemmer
+        throw;
+      }
+      setPreviousTokenStream(streams);
+    } else {
+      streams->tokenStream->reset(reader);
+    }
+    return streams->filteredTokenStream;
+  }
   
   
   
@@ -24,6 +24,7 @@ CL_NS_DEF2(analysis,snowball)
 class CLUCENE_CONTRIBS_EXPORT SnowballAnalyzer: public Analyzer {
   TCHAR* language;
   CLTCSetList* stopSet;
+  class SavedStreams;
 
 public:
   /** Builds the named analyzer with no stop words. */
@@ -39,6 +40,10 @@ public:
       StandardFilter}, a {@link LowerCaseFilter} and a {@link StopFilter}. */
   TokenStream* tokenStream(const TCHAR* fieldName, CL_NS(util)::Reader* reader);
   TokenStream* tokenStream(const TCHAR* fieldName, CL_NS(util)::Reader* reader, bool deleteReader);
+
+  /** Re-uses this thread's previous chain, so the snowball stemmer
+      is only created once per thread. */
+  TokenStream* reusableTokenStream(const TCHAR* fieldName, CL_NS(util)::Reader* reader);
 };
 
 CL_NS_END2
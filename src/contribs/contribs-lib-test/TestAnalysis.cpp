@@ -147,6 +147,56 @@ void testCJK(CuTest *tc) {
     _testCJK(tc, "a\xe5\x95\xa4\xe9\x85\x92\xe5\x95\xa4x", exp2);
 }
 
+void _testReusable(CuTest *tc, Analyzer& a, const TCHAR* input, const TCHAR** results) {
+    CL_NS(util)::StringReader reader(input);
+    TokenStream* ts = a.reusableTokenStream(_T("contents"), &reader);
+    Token tok;
+    for (int pos = 0; results[pos] != NULL; pos++) {
+        CLUCENE_ASSERT(ts->next(&tok) != NULL);
+        CuAssertStrEquals(tc, _T("unexpected token value"), results[pos], tok.termBuffer());
+    }
+    CLUCENE_ASSERT(ts->next(&tok) == NULL);
+}
+
+void testCJKReuse(CuTest *tc) {
+    CJKAnalyzer a;
+
+    // stop words and the empty tokens closing double-byte runs are dropped
+    static const TCHAR* exp1[] = {_T("\x5564\x9152"), _T("\x9152\x5564"), _T("test"), NULL};
+    _testReusable(tc, a, _T("a\x5564\x9152\x5564 the test"), exp1);
+
+    // the reused tokenizer must not carry the previous text's state over
+    static const TCHAR* exp2[] = {_T("\x9152\x5564"), _T("values"), NULL};
+    _testReusable(tc, a, _T("\x9152\x5564 values"), exp2);
+
+    CL_NS(util)::StringReader reader1(_T("x"));
+    TokenStream* ts1 = a.reusableTokenStream(_T("contents"), &reader1);
+    CL_NS(util)::StringReader reader2(_T("y"));
+    TokenStream* ts2 = a.reusableTokenStream(_T("contents"), &reader2);
+    CLUCENE_ASSERT(ts1 == ts2);
+}
+
+void testLanguageBasedReuse(CuTest* tc) {
+    LanguageBasedAnalyzer a;
+    a.setLanguage(_T("English"));
+    a.setStem(false);
+
+    static const TCHAR* exp1[] = {_T("he"), _T("abhorred"), _T("accentueren"), NULL};
+    _testReusable(tc, a, _T("he abhorred accentueren"), exp1);
+
+    CL_NS(util)::StringReader reader1(_T("x"));
+    TokenStream* ts1 = a.reusableTokenStream(_T("contents"), &reader1);
+    CL_NS(util)::StringReader reader2(_T("y"));
+    TokenStream* ts2 = a.reusableTokenStream(_T("contents"), &reader2);
+    CLUCENE_ASSERT(ts1 == ts2);
+
+    // changing the settings rebuilds the chain
+    a.setLanguage(_T("Dutch"));
+    a.setStem(true);
+    static const TCHAR* exp2[] = {_T("he"), _T("abhorred"), _T("accentuer"), NULL};
+    _testReusable(tc, a, _T("he abhorred accentueren"), exp2);
+}
+
 void testLanguageBasedAnalyzer(CuTest* tc) {
     LanguageBasedAnalyzer a;
     CL_NS(util)::StringReader reader(_T("he abhorred accentueren"));
@@ -186,6 +236,8 @@ CuSuite *testanalysis(void) {
     SUITE_ADD_TEST(suite, testFile);
     SUITE_ADD_TEST(suite, testCJK);
     SUITE_ADD_TEST(suite, testLanguageBasedAnalyzer);
+    SUITE_ADD_TEST(suite, testCJKReuse);
+    SUITE_ADD_TEST(suite, testLanguageBasedReuse);
 
     return suite;
 }
@@ -29,10 +29,36 @@ void testSnowball(CuTest *tc) {
     _CLDELETE(ts);
 }
 
+void testSnowballReuse(CuTest *tc) {
+    SnowballAnalyzer an(_T("English"));
+    Token t;
+
+    CL_NS(util)::StringReader reader1(_T("he abhorred accents"));
+    TokenStream* ts1 = an.reusableTokenStream(_T("test"), &reader1);
+    CLUCENE_ASSERT(ts1->next(&t)!=NULL);
+    CLUCENE_ASSERT(_tcscmp(t.termBuffer(), _T("he")) == 0);
+    CLUCENE_ASSERT(ts1->next(&t)!=NULL);
+    CLUCENE_ASSERT(_tcscmp(t.termBuffer(), _T("abhor")) == 0);
+    CLUCENE_ASSERT(ts1->next(&t)!=NULL);
+    CLUCENE_ASSERT(_tcscmp(t.termBuffer(), _T("accent")) == 0);
+    CLUCENE_ASSERT(ts1->next(&t) == NULL);
+
+    // the same chain is reset onto the next reader
+    CL_NS(util)::StringReader reader2(_T("Jumping accents"));
+    TokenStream* ts2 = an.reusableTokenStream(_T("test"), &reader2);
+    CLUCENE_ASSERT(ts1 == ts2);
+    CLUCENE_ASSERT(ts2->next(&t)!=NULL);
+    CLUCENE_ASSERT(_tcscmp(t.termBuffer(), _T("jump")) == 0);
+    CLUCENE_ASSERT(ts2->next(&t)!=NULL);
+    CLUCENE_ASSERT(_tcscmp(t.termBuffer(), _T("accent")) == 0);
+    CLUCENE_ASSERT(ts2->next(&t) == NULL);
+}
+
 CuSuite *testsnowball(void) {
     CuSuite *suite = CuSuiteNew(_T("CLucene Snowball Test"));
 
     SUITE_ADD_TEST(suite, testSnowball);
+    SUITE_ADD_TEST(suite, testSnowballReuse);
 
     return suite;
 }
@@ -18,6 +18,7 @@
 #include "CLucene/search/MultiSearcher.h"
 #include "CLucene/search/DateFilter.h"
 #include "CLucene/search/WildcardQuery.h"
+#include "CLucene/search/RegexpQuery.h"
 #include "CLucene/search/FuzzyQuery.h"
 #include "CLucene/search/PhraseQuery.h"
 #include "CLucene/search/PrefixQuery.h"
@@ -184,6 +184,12 @@
 //The initial value set to BooleanQuery::maxClauseCount. Default is 1024
 #define LUCENE_BOOLEANQUERY_MAXCLAUSECOUNT 1024
 //
+//MultiTermQuery::CONSTANT_SCORE_AUTO_REWRITE uses a constant score filter once
+//this many terms match, or once the matching terms' document frequencies
+//add up to this percentage of the index
+#define LUCENE_MULTITERMQUERY_AUTO_TERM_COUNT_CUTOFF 350
+#define LUCENE_MULTITERMQUERY_AUTO_DOC_COUNT_PERCENT 0.1
+//
 //bvk: 12.3.2005
 //==============================================================================
 //Previously the way the tokenizer has worked has been changed to optionally
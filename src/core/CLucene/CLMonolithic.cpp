@@ -32,12 +32,15 @@
 #include "CLucene/index/FieldInfos.cpp"
 #include "CLucene/index/FieldsReader.cpp"
 #include "CLucene/index/FieldsWriter.cpp"
+#include "CLucene/index/ImpactTiers.cpp"
 #include "CLucene/index/IndexDeletionPolicy.cpp"
 #include "CLucene/index/IndexFileDeleter.cpp"
 #include "CLucene/index/IndexFileNameFilter.cpp"
 #include "CLucene/index/IndexFileNames.cpp"
+#include "CLucene/index/IndexingPipeline.cpp"
 #include "CLucene/index/IndexModifier.cpp"
 #include "CLucene/index/IndexWriter.cpp"
+#include "CLucene/index/IndexSorter.cpp"
 #include "CLucene/index/IndexReader.cpp"
 #include "CLucene/index/MergePolicy.cpp"
 #include "CLucene/index/MergeScheduler.cpp"
@@ -56,11 +59,13 @@
 #include "CLucene/index/SegmentTermVector.cpp"
 #include "CLucene/index/SkipListReader.cpp"
 #include "CLucene/index/SkipListWriter.cpp"
+#include "CLucene/index/StoredFieldVisitor.cpp"
 #include "CLucene/index/Term.cpp"
 #include "CLucene/index/Terms.cpp"
 #include "CLucene/index/TermInfo.cpp"
 #include "CLucene/index/TermInfosReader.cpp"
 #include "CLucene/index/TermInfosWriter.cpp"
+#include "CLucene/index/TermGramIndex.cpp"
 #include "CLucene/index/TermVectorReader.cpp"
 #include "CLucene/index/TermVectorWriter.cpp"
 #include "CLucene/queryParser/FastCharStream.cpp"
@@ -98,6 +103,8 @@
 #include "CLucene/search/PhraseScorer.cpp"
 #include "CLucene/search/PrefixQuery.cpp"
 #include "CLucene/search/QueryFilter.cpp"
+#include "CLucene/search/QueryResultCache.cpp"
+#include "CLucene/search/FilterCache.cpp"
 #include "CLucene/search/RangeQuery.cpp"
 #include "CLucene/search/RangeFilter.cpp"
 #include "CLucene/search/SearchHeader.cpp"
@@ -110,6 +117,8 @@
 #include "CLucene/search/TermScorer.cpp"
 #include "CLucene/search/WildcardQuery.cpp"
 #include "CLucene/search/WildcardTermEnum.cpp"
+#include "CLucene/search/AutomatonTermEnum.cpp"
+#include "CLucene/search/RegexpQuery.cpp"
 #include "CLucene/search/spans/NearSpansOrdered.cpp"
 #include "CLucene/search/spans/NearSpansUnordered.cpp"
 #include "CLucene/search/spans/SpanFirstQuery.cpp"
@@ -120,6 +129,11 @@
 #include "CLucene/search/spans/SpanTermQuery.cpp"
 #include "CLucene/search/spans/SpanWeight.cpp"
 #include "CLucene/search/spans/TermSpans.cpp"
+#include "CLucene/search/function/CustomScoreQuery.cpp"
+#include "CLucene/search/function/FieldCacheSource.cpp"
+#include "CLucene/search/function/FloatFunctions.cpp"
+#include "CLucene/search/function/ValueSource.cpp"
+#include "CLucene/search/function/ValueSourceQuery.cpp"
 #include "CLucene/store/FSDirectory.cpp"
 #include "CLucene/store/IndexInput.cpp"
 #include "CLucene/store/Lock.cpp"
@@ -128,9 +142,11 @@
 #include "CLucene/store/IndexOutput.cpp"
 #include "CLucene/store/Directory.cpp"
 #include "CLucene/store/RAMDirectory.cpp"
+#include "CLucene/util/Automaton.cpp"
 #include "CLucene/util/BitSet.cpp"
 #include "CLucene/util/Equators.cpp"
 #include "CLucene/util/FastCharStream.cpp"
+#include "CLucene/util/LZCompressor.cpp"
 #include "CLucene/util/MD5Digester.cpp"
 #include "CLucene/util/Reader.cpp"
 #include "CLucene/util/StringIntern.cpp"
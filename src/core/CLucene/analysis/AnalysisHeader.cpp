@@ -41,7 +41,12 @@ void Analyzer::setPreviousTokenStream(TokenStream* obj)
 }
 TokenStream* Analyzer::reusableTokenStream(const wchar_t* fieldName, CL_NS(util)::Reader* reader)
 {
-    return tokenStream(fieldName, reader);
+    // Analyzers that cannot reset their chain still hand out a stream the
+    // caller does not own: it is parked in the thread local slot and deleted
+    // on this thread's next call (or when the analyzer is destroyed).
+    TokenStream* ts = tokenStream(fieldName, reader);
+    setPreviousTokenStream(ts);
+    return ts;
 }
 
 ///Compares the Token for their order
@@ -266,6 +266,10 @@ public:
 	*  than one TokenStream at the same time from this
 	*  analyzer should use this method for better
 	*  performance.
+	*  <p>
+	*  The returned stream is owned by the analyzer: callers must
+	*  not delete it, and it stays valid until the same thread calls
+	*  this method again or the analyzer is destroyed.
 	*/
 	virtual TokenStream* reusableTokenStream(const wchar_t* fieldName, CL_NS(util)::Reader* reader);
 private:
@@ -265,14 +265,14 @@ public:
     TokenStream* result;
 
     SavedStreams() :source(NULL), result(NULL) {}
+    virtual ~SavedStreams() { _CLDELETE(result); }
 
     void close() {}
     Token* next(Token* token) { return NULL; }
 };
 StopAnalyzer::~StopAnalyzer()
 {
-    SavedStreams* t = reinterpret_cast<SavedStreams*>(this->getPreviousTokenStream());
-    if (t) _CLDELETE(t->result);
+    //the saved streams of every thread are deleted by ~Analyzer
     _CLDELETE(stopTable);
 }
 StopAnalyzer::StopAnalyzer(const wchar_t** stopWords) :
@@ -601,6 +601,173 @@ Token* LengthFilter::next(Token* token)
 }
 
 
+const wchar_t CommonGramsFilter::SEPARATOR = L'_';
+const wchar_t* CommonGramsFilter::GRAM_TYPE = L"gram";
+
+CommonGramsFilter::CommonGramsFilter(TokenStream* in, bool deleteTokenStream, const wchar_t** _commonWords, const bool _ignoreCase) :
+    TokenFilter(in, deleteTokenStream),
+    deleteCommonTable(true),
+    ignoreCase(_ignoreCase),
+    lookahead(_CLNEW Token),
+    hasLookahead(false),
+    pendingGram(false),
+    lastStartOffset(0)
+{
+    commonWords = _CLNEW CLTCSetList(true);
+    StopFilter::fillStopTable(commonWords, _commonWords, _ignoreCase);
+}
+
+CommonGramsFilter::CommonGramsFilter(TokenStream* in, bool deleteTokenStream, CLTCSetList* commonTable,
+    bool _deleteCommonTable, const bool _ignoreCase) :
+    TokenFilter(in, deleteTokenStream),
+    commonWords(commonTable),
+    deleteCommonTable(_deleteCommonTable),
+    ignoreCase(_ignoreCase),
+    lookahead(_CLNEW Token),
+    hasLookahead(false),
+    pendingGram(false),
+    lastStartOffset(0)
+{
+}
+
+CommonGramsFilter::~CommonGramsFilter()
+{
+    _CLLDELETE(lookahead);
+    if (deleteCommonTable)
+        _CLLDELETE(commonWords);
+}
+
+bool CommonGramsFilter::isCommon(Token* token)
+{
+    if (!ignoreCase)
+        return commonWords->find(token->termBuffer()) != commonWords->end();
+
+    //fold a copy, the token itself is passed on unchanged
+    folded.assign(token->termBuffer(), token->termLength());
+    stringCaseFold(&folded[0]);
+    return commonWords->find(&folded[0]) != commonWords->end();
+}
+
+Token* CommonGramsFilter::next(Token* token)
+{
+    if (pendingGram) {
+        // the bigram of the unigram returned last and the lookahead
+        pendingGram = false;
+        const size_t lastLength = lastText.length();
+        const size_t nextLength = lookahead->termLength();
+        const size_t length = lastLength + 1 + nextLength;
+
+        token->clear();
+        wchar_t* buffer = token->resizeTermBuffer(length + 1);
+        wmemcpy(buffer, lastText.c_str(), lastLength);
+        buffer[lastLength] = SEPARATOR;
+        wmemcpy(buffer + lastLength + 1, lookahead->termBuffer(), nextLength);
+        buffer[length] = 0;
+        token->setTermLength((int32_t)length);
+        token->setStartOffset(lastStartOffset);
+        token->setEndOffset(lookahead->endOffset());
+        token->setType(GRAM_TYPE);
+        token->setPositionIncrement(0);
+        return token;
+    }
+
+    if (hasLookahead) {
+        hasLookahead = false;
+        token->set(lookahead->termBuffer(), lookahead->startOffset(), lookahead->endOffset(), lookahead->type());
+        token->setPositionIncrement(lookahead->getPositionIncrement());
+        CL_NS(index)::Payload* payload = lookahead->getPayload();
+        token->setPayload(payload == NULL ? NULL : payload->clone());
+    }
+    else if (input->next(token) == NULL) {
+        return NULL;
+    }
+
+    lookahead->clear();
+    if (input->next(lookahead) != NULL) {
+        hasLookahead = true;
+        // no bigram across a gap, the words are not adjacent
+        if (lookahead->getPositionIncrement() == 1 && (isCommon(token) || isCommon(lookahead))) {
+            pendingGram = true;
+            lastText.assign(token->termBuffer(), token->termLength());
+            lastStartOffset = token->startOffset();
+        }
+    }
+    return token;
+}
+
+void CommonGramsFilter::reset()
+{
+    hasLookahead = false;
+    pendingGram = false;
+    input->reset();
+}
+
+
+CommonGramsQueryFilter::CommonGramsQueryFilter(CommonGramsFilter* in, bool deleteTokenStream) :
+    TokenFilter(in, deleteTokenStream),
+    previous(_CLNEW Token),
+    current(_CLNEW Token),
+    hasPrevious(false),
+    lastWasGram(false)
+{
+}
+
+CommonGramsQueryFilter::~CommonGramsQueryFilter()
+{
+    _CLLDELETE(previous);
+    _CLLDELETE(current);
+}
+
+bool CommonGramsQueryFilter::isGram(const Token* token)
+{
+    return token->type() == CommonGramsFilter::GRAM_TYPE;
+}
+
+void CommonGramsQueryFilter::copyToken(Token* to, Token* from)
+{
+    to->set(from->termBuffer(), from->startOffset(), from->endOffset(), from->type());
+    to->setPositionIncrement(from->getPositionIncrement());
+    CL_NS(index)::Payload* payload = from->getPayload();
+    to->setPayload(payload == NULL ? NULL : payload->clone());
+}
+
+Token* CommonGramsQueryFilter::next(Token* token)
+{
+    // a token is only returned once the next one is known: a unigram followed
+    // by its bigram is replaced by the bigram
+    current->clear();
+    while (input->next(current) != NULL) {
+        if (hasPrevious && !isGram(current)) {
+            copyToken(token, previous);
+            lastWasGram = isGram(previous);
+            Token* tmp = previous; previous = current; current = tmp;
+            return token;
+        }
+        if (hasPrevious) // the bigram takes the place of its first word
+            current->setPositionIncrement(previous->getPositionIncrement());
+        Token* tmp = previous; previous = current; current = tmp;
+        hasPrevious = true;
+        current->clear();
+    }
+
+    // the last word is dropped if it is the end of the last bigram
+    const bool emit = hasPrevious && !lastWasGram;
+    hasPrevious = false;
+    lastWasGram = false;
+    if (!emit)
+        return NULL;
+    copyToken(token, previous);
+    return token;
+}
+
+void CommonGramsQueryFilter::reset()
+{
+    hasPrevious = false;
+    lastWasGram = false;
+    input->reset();
+}
+
+
 CLTCSetList* WordlistLoader::getWordSet(const wchar_t * wordfilePath, const wchar_t * enc, CLTCSetList* stopTable)
 {
     if (enc == NULL)
@@ -392,5 +392,91 @@ public:
 };
 
 
+/**
+* Constructs bigrams for frequently occurring terms while indexing. Every
+* input token is passed through, and whenever a token or the one following
+* it is a common word a bigram of the two, joined by {@link #SEPARATOR}, is
+* emitted in between with a position increment of 0 and the type
+* {@link #GRAM_TYPE}.
+* <p>
+* Indexing "the quick" with "the" as common word yields
+* <code>the, the_quick, quick</code>. A phrase made of common words can
+* then be searched on the bigrams, whose postings are much shorter than
+* the ones of the common words themselves. Use {@link CommonGramsQueryFilter}
+* on the query side to produce these bigrams.
+* <p>
+* No bigram is built across a position gap, such as the one left by a
+* StopFilter with position increments enabled.
+*/
+class CLUCENE_EXPORT CommonGramsFilter: public TokenFilter {
+private:
+	CLTCSetList* commonWords;
+	bool deleteCommonTable;
+	const bool ignoreCase;
+
+	Token* lookahead;
+	bool hasLookahead;
+	bool pendingGram;
+	std::wstring lastText;
+	int32_t lastStartOffset;
+	std::wstring folded;
+
+	bool isCommon(Token* token);
+public:
+	/** Separator placed between the two words of a bigram */
+	static const wchar_t SEPARATOR;
+	/** Type of the bigram tokens */
+	static const wchar_t* GRAM_TYPE;
+
+	/** Constructs a filter that builds bigrams for the words in the array
+	*	of common words, which must be NULL terminated.
+	*/
+	CommonGramsFilter(TokenStream* in, bool deleteTokenStream, const wchar_t** _commonWords, const bool _ignoreCase = false);
+
+	/** Constructs a filter that builds bigrams for the words in commonTable,
+	*	for instance a table filled by StopFilter::fillStopTable or by
+	*	WordlistLoader.
+	*/
+	CommonGramsFilter(TokenStream* in, bool deleteTokenStream, CLTCSetList* commonTable,
+		bool _deleteCommonTable = false, const bool _ignoreCase = false);
+
+	virtual ~CommonGramsFilter();
+
+	/** Returns the next input token or bigram. */
+	Token* next(Token* token);
+
+	void reset();
+};
+
+/**
+* Query time counterpart of {@link CommonGramsFilter}: it wraps a
+* CommonGramsFilter and drops the unigrams that are covered by a bigram,
+* so that a phrase is searched on the bigrams only.
+* <p>
+* "the quick fox" with "the" as common word yields
+* <code>the_quick, quick, fox</code> and "the who" only <code>the_who</code>.
+* Each bigram takes the position of its first word, so the query terms line
+* up with the positions written by CommonGramsFilter at index time.
+*/
+class CLUCENE_EXPORT CommonGramsQueryFilter: public TokenFilter {
+private:
+	Token* previous;
+	Token* current;
+	bool hasPrevious;
+	bool lastWasGram;
+
+	static bool isGram(const Token* token);
+	static void copyToken(Token* to, Token* from);
+public:
+	CommonGramsQueryFilter(CommonGramsFilter* in, bool deleteTokenStream);
+	virtual ~CommonGramsQueryFilter();
+
+	/** Returns the next bigram or unigram not covered by a bigram. */
+	Token* next(Token* token);
+
+	void reset();
+};
+
+
 CL_NS_END
 #endif
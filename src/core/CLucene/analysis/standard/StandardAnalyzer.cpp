@@ -55,27 +55,23 @@ CL_NS_DEF2(analysis,standard)
             SavedStreams():tokenStream(NULL), filteredTokenStream(NULL)
             {
             }
+            virtual ~SavedStreams(){
+                _CLDELETE(filteredTokenStream);
+            }
 
             void close(){}
             Token* next(Token* token) {return NULL;}
         };
 
 	StandardAnalyzer::~StandardAnalyzer(){
-        SavedStreams* t = reinterpret_cast<SavedStreams*>(this->getPreviousTokenStream());
-        if (t) _CLDELETE(t->filteredTokenStream);
+        //the saved streams of every thread are deleted by ~Analyzer
 		_CLLDELETE(stopSet);
 	}
 
 
 	TokenStream* StandardAnalyzer::tokenStream(const wchar_t* /*fieldName*/, Reader* reader)
 	{
-		BufferedReader* bufferedReader = reader->__asBufferedReader();
-		TokenStream* ret;
-
-		if ( bufferedReader == NULL )
-			ret = _CLNEW StandardTokenizer( _CLNEW FilteredBufferedReader(reader, false), true );
-		else
-			ret = _CLNEW StandardTokenizer(bufferedReader);
+		TokenStream* ret = _CLNEW StandardTokenizer(reader);
         //ret->setMaxTokenLength(maxTokenLength);
 		ret = _CLNEW StandardFilter(ret,true);
 		ret = _CLNEW LowerCaseFilter(ret,true);
@@ -89,12 +85,7 @@ CL_NS_DEF2(analysis,standard)
             streams = _CLNEW SavedStreams();
             setPreviousTokenStream(streams);
 
-            BufferedReader* bufferedReader = reader->__asBufferedReader();
-            if ( bufferedReader == NULL )
-                streams->tokenStream = _CLNEW StandardTokenizer( _CLNEW FilteredBufferedReader(reader, false), true);
-            else
-                streams->tokenStream = _CLNEW StandardTokenizer(bufferedReader);
-
+            streams->tokenStream = _CLNEW StandardTokenizer(reader);
             streams->filteredTokenStream = _CLNEW StandardFilter(streams->tokenStream, true);
             streams->filteredTokenStream = _CLNEW LowerCaseFilter(streams->filteredTokenStream, true);
             streams->filteredTokenStream = _CLNEW StopFilter(streams->filteredTokenStream, true, stopSet);
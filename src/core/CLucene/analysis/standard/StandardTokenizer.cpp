@@ -8,10 +8,13 @@
 ------------------------------------------------------------------------------*/
 #include "CLucene/_ApiHeader.h"
 #include "StandardTokenizer.h"
-#include "CLucene/util/StringBuffer.h"
-#include "CLucene/util/_FastCharStream.h"
 #include "CLucene/util/CLStreams.h"
 
+#if defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2) || defined(__SSE2__)
+    #define _CL_STANDARDTOKENIZER_SSE2
+    #include <emmintrin.h>
+#endif
+
 CL_NS_USE(analysis)
 CL_NS_USE(util)
 CL_NS_DEF2(analysis, standard)
@@ -31,21 +34,65 @@ const wchar_t* tokenImageArray[] = {
 const wchar_t** tokenImage = tokenImageArray;
 
 
+
+/* Character classes used by the tokenizer. They are precomputed for the whole
+** BMP, so the hot loops do a single table load instead of calling into the
+** unicode tables for every character. */
+#define CC_ALPHA    0x01
+#define CC_DIGIT    0x02
+#define CC_ALNUM    0x04
+#define CC_SPACE    0x08
+#define CC_CJK      0x10
+#define CC_WORD     0x20 /* ALNUM or UNDERSCORE */
+
+static uint8_t computeCharClass(const int c)
+{
+    uint8_t ret = 0;
+    if (_istalpha((wchar_t)c)) ret |= CC_ALPHA;
+    if (_istdigit(c)) ret |= CC_DIGIT;
+    if (_istalnum(c)) ret |= CC_ALNUM | CC_WORD;
+    if (_istspace((wchar_t)c)) ret |= CC_SPACE;
+    if (c == '_') ret |= CC_WORD;
+    if ((c >= 0x3040 && c <= 0x318f) ||
+        (c >= 0x3300 && c <= 0x337f) ||
+        (c >= 0x3400 && c <= 0x3d2d) ||
+        (c >= 0x4e00 && c <= 0x9fff) ||
+        (c >= 0xf900 && c <= 0xfaff) ||
+        (c >= 0xac00 && c <= 0xd7af)) //korean
+        ret |= CC_CJK;
+    return ret;
+}
+
+static class CharClassTable
+{
+public:
+    uint8_t classes[0x10000];
+    CharClassTable()
+    {
+        for (int c = 0; c < 0x10000; c++)
+            classes[c] = computeCharClass(c);
+    }
+} charClassTable;
+
+static inline uint8_t charClass(const int c)
+{
+    if ((uint32_t) c < 0x10000)
+        return charClassTable.classes[c];
+    //-1 (end of stream) belongs to no class; only platforms with a 32bit wchar_t get any further
+    return c < 0 ? 0 : computeCharClass(c);
+}
+
+
 /* A bunch of shortcut macros, many of which make assumptions about variable
 ** names.  These macros enhance readability, not just convenience! */
-#define EOS           (ch==-1 || rd->Eos())
-#define SPACE         (_istspace((wchar_t)ch) != 0)
-#define ALPHA         (_istalpha((wchar_t)ch) != 0)
-#define ALNUM         (_istalnum(ch) != 0)
-#define DIGIT         (_istdigit(ch) != 0)
+#define EOS           (ch==-1 || eos)
+#define SPACE         ((charClass(ch) & CC_SPACE) != 0)
+#define ALPHA         ((charClass(ch) & CC_ALPHA) != 0)
+#define ALNUM         ((charClass(ch) & CC_ALNUM) != 0)
+#define DIGIT         ((charClass(ch) & CC_DIGIT) != 0)
 #define UNDERSCORE    (ch == '_')
 
-#define _CJK			(  (ch>=0x3040 && ch<=0x318f) || \
-  						   (ch>=0x3300 && ch<=0x337f) || \
-  						   (ch>=0x3400 && ch<=0x3d2d) || \
-  						   (ch>=0x4e00 && ch<=0x9fff) || \
-  						   (ch>=0xf900 && ch<=0xfaff) || \
-  						   (ch>=0xac00 && ch<=0xd7af) ) //korean
+#define _CJK          ((charClass(ch) & CC_CJK) != 0)
 
 
 #define DASH          (ch == '-')
@@ -58,7 +105,7 @@ const wchar_t** tokenImage = tokenImageArray;
 
 
 //freebsd seems to have a problem with defines over multiple lines, so this has to be one long line
-#define _CONSUME_AS_LONG_AS(conditionFails) while (true) { ch = readChar(); if (ch==-1 || (!(conditionFails) || str.length() >= LUCENE_MAX_WORD_LEN)) { break; } str.push_back(ch);}
+#define _CONSUME_AS_LONG_AS(conditionFails) while (true) { ch = readChar(); if (ch==-1 || (!(conditionFails) || str.len >= LUCENE_MAX_WORD_LEN)) { break; } str.buf[str.len++] = ch;}
 
 #define CONSUME_ALPHAS _CONSUME_AS_LONG_AS(ALPHA)
 
@@ -66,8 +113,10 @@ const wchar_t** tokenImage = tokenImageArray;
 
 /* otherMatches is a condition (possibly compound) under which a character
 ** that's not an ALNUM or UNDERSCORE can be considered not to break the
-** span.  Callers should pass false if only ALNUM/UNDERSCORE are acceptable. */
-#define CONSUME_WORD                  _CONSUME_AS_LONG_AS(ALNUM || UNDERSCORE)
+** span.  Callers should pass false if only ALNUM/UNDERSCORE are acceptable.
+** Runs of ASCII word characters that are already buffered are copied in one
+** go by consumeAsciiWord before falling back to the per-character loop. */
+#define CONSUME_WORD                  while (true) { consumeAsciiWord(str); ch = readChar(); if (ch==-1 || (!(ALNUM || UNDERSCORE) || str.len >= LUCENE_MAX_WORD_LEN)) { break; } str.buf[str.len++] = ch;}
 
 /*
 ** Consume CJK characters
@@ -83,24 +132,93 @@ const wchar_t** tokenImage = tokenImageArray;
 **    a token (deliberately doesn't include the likes of '@'/'&'). */
 #define CONSUMED_NOTHING_OF_VALUE (rdPos == specialCharPos || (rdPos == specialCharPos+1 && ( SPACE || !(ALNUM || DOT || DASH || UNDERSCORE) )))
 
-#define RIGHTMOST(sb) (sb[sb.length()-1])
+#define RIGHTMOST(sb) (sb.buf[sb.len-1])
 #define RIGHTMOST_IS(sb, c) (RIGHTMOST(sb) == c)
-/* To discard the last character in a StringBuffer, we decrement the buffer's
-** length indicator and move the terminator back by one character. */
-#define SHAVE_RIGHTMOST(sb) (sb.pop_back())
+/* To discard the last character in the term buffer, we decrement its
+** length indicator. The terminator is written by setToken. */
+#define SHAVE_RIGHTMOST(sb) (sb.len--)
 
-//#define REMOVE_TRAILING_CHARS(sb, charMatchesCondition) { wchar_t* sbBuf = sb.getBuffer(); for (int32_t i = sb.len-1; i >= 0; i--) { wchar_t c = sbBuf[i]; if (charMatchesCondition) { sbBuf[--sb.len] = '\0'; } else {break;}}}
+/* Does the term buffer contain the character c? */
+#define CONTAINS(sb, c) (wmemchr(sb.buf, c, sb.len) != NULL)
+/* Does the term buffer contain any of the characters in string ofThese? */
+#define CONTAINS_ANY(sb, ofThese) (sb.buf[sb.len] = 0, wcscspn(sb.buf, ofThese) != (size_t)sb.len)
 
-/* Does StringBuffer sb contain any of the characters in string ofThese? */
-#define CONTAINS_ANY(sb, ofThese) (wcscspn(sb.c_str(), ofThese) != sb.length())
 
+#ifdef _CL_STANDARDTOKENIZER_SSE2
+/* Returns the index of the first zero bit of mask */
+static inline int32_t firstClearBit(int32_t mask)
+{
+    int32_t i = 0;
+    while (mask & 1)
+    {
+        mask >>= 1;
+        i++;
+    }
+    return i;
+}
 
-StandardTokenizer::StandardTokenizer(BufferedReader* reader, bool deleteReader) :
+/* Returns the length of the run of [A-Za-z0-9_] characters at the start of p,
+** looking at no more than avail characters. Only whole vectors are examined;
+** the caller finishes off the tail. */
+static int32_t asciiWordRun(const wchar_t* p, const int32_t avail)
+{
+    int32_t n = 0;
+    if (sizeof(wchar_t) == 2)
+    {
+        const __m128i caseBit = _mm_set1_epi16(0x20);
+        const __m128i lowerA = _mm_set1_epi16('a');
+        const __m128i zero = _mm_set1_epi16('0');
+        const __m128i underscore = _mm_set1_epi16('_');
+        const __m128i letters = _mm_set1_epi16(26);
+        const __m128i digits = _mm_set1_epi16(10);
+        const __m128i minusOne = _mm_set1_epi16(-1);
+        for (; n + 8 <= avail; n += 8)
+        {
+            const __m128i v = _mm_loadu_si128((const __m128i*)(p + n));
+            const __m128i l = _mm_sub_epi16(_mm_or_si128(v, caseBit), lowerA);
+            const __m128i d = _mm_sub_epi16(v, zero);
+            const __m128i isLetter = _mm_and_si128(_mm_cmpgt_epi16(l, minusOne), _mm_cmplt_epi16(l, letters));
+            const __m128i isDigit = _mm_and_si128(_mm_cmpgt_epi16(d, minusOne), _mm_cmplt_epi16(d, digits));
+            const int32_t mask = _mm_movemask_epi8(_mm_or_si128(_mm_or_si128(isLetter, isDigit), _mm_cmpeq_epi16(v, underscore)));
+            if (mask != 0xFFFF)
+                return n + firstClearBit(mask) / 2;
+        }
+    }
+    else if (sizeof(wchar_t) == 4)
+    {
+        const __m128i caseBit = _mm_set1_epi32(0x20);
+        const __m128i lowerA = _mm_set1_epi32('a');
+        const __m128i zero = _mm_set1_epi32('0');
+        const __m128i underscore = _mm_set1_epi32('_');
+        const __m128i letters = _mm_set1_epi32(26);
+        const __m128i digits = _mm_set1_epi32(10);
+        const __m128i minusOne = _mm_set1_epi32(-1);
+        for (; n + 4 <= avail; n += 4)
+        {
+            const __m128i v = _mm_loadu_si128((const __m128i*)(p + n));
+            const __m128i l = _mm_sub_epi32(_mm_or_si128(v, caseBit), lowerA);
+            const __m128i d = _mm_sub_epi32(v, zero);
+            const __m128i isLetter = _mm_and_si128(_mm_cmpgt_epi32(l, minusOne), _mm_cmplt_epi32(l, letters));
+            const __m128i isDigit = _mm_and_si128(_mm_cmpgt_epi32(d, minusOne), _mm_cmplt_epi32(d, digits));
+            const int32_t mask = _mm_movemask_epi8(_mm_or_si128(_mm_or_si128(isLetter, isDigit), _mm_cmpeq_epi32(v, underscore)));
+            if (mask != 0xFFFF)
+                return n + firstClearBit(mask) / 4;
+        }
+    }
+    return n;
+}
+#endif
+
+
+StandardTokenizer::StandardTokenizer(Reader* reader, bool deleteReader) :
+    Tokenizer(reader),
     /* rdPos is zero-based.  It starts at -1, and will advance to the first
     ** position when readChar() is first called. */
     rdPos(-1),
     tokenStart(-1),
-    rd(_CLNEW FastCharStream(reader))
+    bufferPos(0),
+    bufferLen(0),
+    eos(false)
 {
     this->reader = reader;
     this->deleteReader = deleteReader;
@@ -108,42 +226,104 @@ StandardTokenizer::StandardTokenizer(BufferedReader* reader, bool deleteReader)
 
 StandardTokenizer::~StandardTokenizer()
 {
-    _CLDELETE(rd);
     if (this->deleteReader)
         _CLDELETE(reader)
 }
 
-int StandardTokenizer::readChar()
+bool StandardTokenizer::refill()
+{
+    if (reader == NULL)
+    {
+        eos = true;
+        return false;
+    }
+
+    /* Keep the tail of the current block in front of the new one, so that
+    ** unReadChar() can still step back over the block boundary. */
+    const int32_t keep = cl_min(bufferPos, (int32_t) UNREAD_SLACK);
+    memmove(ioBuffer, ioBuffer + bufferPos - keep, keep * sizeof(wchar_t));
+    bufferPos = bufferLen = keep;
+
+    const wchar_t* start;
+    const int32_t nread = reader->read(start, 1, IO_BUFFER_SIZE);
+    if (nread <= 0)
+    {
+        eos = true;
+        return false;
+    }
+    memcpy(ioBuffer + keep, start, nread * sizeof(wchar_t));
+    bufferLen += nread;
+    return true;
+}
+
+inline int StandardTokenizer::readChar()
 {
     /* Increment by 1 because we're speaking in terms of characters, not
     ** necessarily bytes: */
     rdPos++;
-    return rd->GetNext();
+    if (bufferPos == bufferLen && (eos || !refill()))
+        return -1;
+    return ioBuffer[bufferPos++];
 }
 
-void StandardTokenizer::unReadChar()
+inline void StandardTokenizer::unReadChar()
 {
-    rd->UnGet();
     rdPos--;
+    //like the end of a stream, there is nothing to unread once the end of stream is reached
+    if (eos)
+        return;
+    CND_PRECONDITION(bufferPos > 0, L"No character can be unread");
+    bufferPos--;
 }
 
-inline Token* StandardTokenizer::setToken(Token* t, std::wstring & sb, TokenTypes tokenCode)
+inline int StandardTokenizer::peekChar()
+{
+    if (bufferPos == bufferLen && (eos || !refill()))
+        return -1;
+    return ioBuffer[bufferPos];
+}
+
+inline void StandardTokenizer::consumeAsciiWord(TermBuffer& str)
+{
+    const wchar_t* p = ioBuffer + bufferPos;
+    const int32_t avail = cl_min(bufferLen - bufferPos, LUCENE_MAX_WORD_LEN - str.len);
+    int32_t n = 0;
+#ifdef _CL_STANDARDTOKENIZER_SSE2
+    n = asciiWordRun(p, avail);
+#endif
+    while (n < avail && (uint32_t) p[n] < 0x80 && (charClassTable.classes[p[n]] & CC_WORD) != 0)
+        n++;
+    if (n > 0)
+    {
+        memcpy(str.buf + str.len, p, n * sizeof(wchar_t));
+        str.len += n;
+        bufferPos += n;
+        rdPos += n;
+    }
+}
+
+inline Token* StandardTokenizer::setToken(Token* t, TermBuffer& sb, TokenTypes tokenCode)
 {
     t->setStartOffset(tokenStart);
-    t->setEndOffset(tokenStart + sb.length());
+    t->setEndOffset(tokenStart + sb.len);
     t->setType(tokenImage[tokenCode]);
-    sb.c_str(); //null terminates the buffer
-    t->resetTermTextLen();
+    sb.buf[sb.len] = 0; //null terminates the buffer
+    t->setTermLength(sb.len);
     return t;
 }
 
 void StandardTokenizer::reset(Reader* _input)
 {
+    if (this->deleteReader && this->reader != _input)
+        _CLDELETE(this->reader);
+    this->deleteReader = false;
     this->input = _input;
-    if (rd->input == NULL) rd->input = _input->__asBufferedReader();
+    this->reader = _input;
     rdPos = -1;
     tokenStart = -1;
-    rd->reset();
+    bufferPos = 0;
+    bufferLen = 0;
+    eos = false;
 }
 
 Token* StandardTokenizer::next(Token* t)
@@ -187,18 +367,27 @@ Token* StandardTokenizer::next(Token* t)
 
 Token* StandardTokenizer::ReadNumber(const wchar_t* previousNumber, const wchar_t prev, Token* t)
 {
-    /* previousNumber is only non-NULL if this function already read a complete
+    t->growBuffer(LUCENE_MAX_WORD_LEN + 1);//make sure token can hold the next word
+    TermBuffer str = { t->termBuffer(), 0 }; //read the data straight into the termBuffer
+    if (previousNumber != NULL)
+    {
+        str.len = cl_min((int32_t) wcslen(previousNumber), (int32_t) LUCENE_MAX_WORD_LEN);
+        wmemmove(str.buf, previousNumber, str.len); //previousNumber may be the termBuffer itself
+    }
+    return ReadNumber(str, previousNumber != NULL, prev, t);
+}
+
+Token* StandardTokenizer::ReadNumber(TermBuffer& str, const bool continuesHost, const wchar_t prev, Token* t)
+{
+    /* continuesHost is only true if this function already read a complete
     ** number in a previous recursion, yet has been asked to read additional
     ** numeric segments.  For example, in the HOST "192.168.1.3", "192.168" is
     ** a complete number, but this function will recurse to read the "1.3",
     ** generating a single HOST token "192.168.1.3". */
-    t->growBuffer(LUCENE_MAX_WORD_LEN + 1);//make sure token can hold the next word
-    std::wstring str(t->termBuffer(), t->bufferLength()); //use stringbuffer to read data onto the termText
     TokenTypes tokenType;
     bool decExhausted;
-    if (previousNumber != NULL)
+    if (continuesHost)
     {
-        str.insert(0, previousNumber);
         tokenType = CL_NS2(analysis, standard)::HOST;
         decExhausted = false;
     }
@@ -207,21 +396,21 @@ Token* StandardTokenizer::ReadNumber(const wchar_t* previousNumber, const wchar_
         tokenType = CL_NS2(analysis, standard)::NUM;
         decExhausted = (prev == '.');
     }
-    if (str.length() >= LUCENE_MAX_WORD_LEN)
+    if (str.len >= LUCENE_MAX_WORD_LEN)
     {
         //if a number is too long, i would say there is no point
         //storing it, because its going to be the wrong number anyway?
         //what do people think?
         return NULL;
     }
-    str.push_back(prev);
+    str.buf[str.len++] = prev;
 
     const bool signExhausted = (prev == '-');
     int ch = prev;
 
     CONSUME_DIGITS;
 
-    if (str.length() < 2 /* CONSUME_DIGITS didn't find any digits. */
+    if (str.len < 2 /* CONSUME_DIGITS didn't find any digits. */
         && (
         (signExhausted && !DECIMAL)
             || (decExhausted /* && !DIGIT is implied, since CONSUME_DIGITS stopped on a non-digit. */)
@@ -246,9 +435,9 @@ Token* StandardTokenizer::ReadNumber(const wchar_t* previousNumber, const wchar_
     {
         if (DECIMAL)
         {
-            if (str.length() >= LUCENE_MAX_WORD_LEN)
+            if (str.len >= LUCENE_MAX_WORD_LEN)
                 return NULL; //read above for rationale
-            str.push_back(ch);
+            str.buf[str.len++] = ch;
         }
         else
         {
@@ -261,12 +450,12 @@ Token* StandardTokenizer::ReadNumber(const wchar_t* previousNumber, const wchar_
         {
             unReadChar();
         }
-        else if (!EOS && DECIMAL && _istdigit(rd->Peek()))
+        else if (!EOS && DECIMAL && (charClass(peekChar()) & CC_DIGIT) != 0)
         {
             /* We just read the fractional digit group, but it's also followed by
             ** a decimal symbol and at least one more digit, so this must be a
             ** HOST rather than a real number. */
-            return ReadNumber(str.c_str(), '.', t);
+            return ReadNumber(str, true, '.', t);
         }
     }
 
@@ -282,7 +471,7 @@ SUCCESSFULLY_EXTRACTED_NUMBER:
     /* If all we have left is a negative sign, it's not a valid number. */
     if (rightmost == '-')
     {
-        CND_PRECONDITION(str.length() == 1, L"Number is invalid");
+        CND_PRECONDITION(str.len == 1, L"Number is invalid");
         return NULL;
     }
 
@@ -292,28 +481,28 @@ SUCCESSFULLY_EXTRACTED_NUMBER:
 Token* StandardTokenizer::ReadAlphaNum(const wchar_t prev, Token* t)
 {
     t->growBuffer(LUCENE_MAX_WORD_LEN + 1);//make sure token can hold the next word
-    std::wstring str(t->termBuffer(), t->bufferLength()); //use stringbuffer to read data onto the termText
-    if (str.length() < LUCENE_MAX_WORD_LEN)
+    TermBuffer str = { t->termBuffer(), 0 }; //read the data straight into the termBuffer
+    if (str.len < LUCENE_MAX_WORD_LEN)
     {
-        str.push_back(prev);
+        str.buf[str.len++] = prev;
         int ch = prev;
 
         CONSUME_WORD;
-        if (!EOS && str.length() < LUCENE_MAX_WORD_LEN - 1)
+        if (!EOS && str.len < LUCENE_MAX_WORD_LEN - 1)
         { //still have space for 1 more character?
             switch (ch)
             { /* What follows the first alphanum segment? */
             case '.':
-                str.push_back('.');
+                str.buf[str.len++] = '.';
                 return ReadDotted(str, CL_NS2(analysis, standard)::UNKNOWN, t);
             case '\'':
-                str.push_back('\'');
+                str.buf[str.len++] = '\'';
                 return ReadApostrophe(str, t);
             case '@':
-                str.push_back('@');
+                str.buf[str.len++] = '@';
                 return ReadAt(str, t);
             case '&':
-                str.push_back('&');
+                str.buf[str.len++] = '&';
                 return ReadCompany(str, t);
                 /* default: fall through to end of this function. */
             }
@@ -325,10 +514,10 @@ Token* StandardTokenizer::ReadAlphaNum(const wchar_t prev, Token* t)
 Token* StandardTokenizer::ReadCJK(const wchar_t prev, Token * t)
 {
     t->growBuffer(LUCENE_MAX_WORD_LEN + 1);//make sure token can hold the next word
-    std::wstring str(t->termBuffer(), t->bufferLength()); //use stringbuffer to read data onto the termText
-    if (str.length() < LUCENE_MAX_WORD_LEN)
+    TermBuffer str = { t->termBuffer(), 0 }; //read the data straight into the termBuffer
+    if (str.len < LUCENE_MAX_WORD_LEN)
     {
-        str.push_back(prev);
+        str.buf[str.len++] = prev;
         int ch = prev;
 
         CONSUME_CJK;
@@ -338,7 +527,7 @@ Token* StandardTokenizer::ReadCJK(const wchar_t prev, Token * t)
 }
 
 
-Token * StandardTokenizer::ReadDotted(std::wstring & str, TokenTypes forcedType, Token * t)
+Token * StandardTokenizer::ReadDotted(TermBuffer& str, TokenTypes forcedType, Token * t)
 {
     const int32_t specialCharPos = rdPos;
 
@@ -346,12 +535,12 @@ Token * StandardTokenizer::ReadDotted(std::wstring & str, TokenTypes forcedType,
     ** Even though hosts, e-mail addresses, etc., could have a dotted-segment
     ** that begins with a dot or a dash, it's far more common in source text
     ** for a pattern like "abc.--def" to be intended as two tokens. */
-    int ch = rd->Peek();
+    int ch = peekChar();
     if (!(DOT || DASH))
     {
         bool prevWasDot;
         bool prevWasDash;
-        if (str.length() == 0)
+        if (str.len == 0)
         {
             prevWasDot = false;
             prevWasDash = false;
@@ -361,7 +550,7 @@ Token * StandardTokenizer::ReadDotted(std::wstring & str, TokenTypes forcedType,
             prevWasDot = RIGHTMOST(str) == '.';
             prevWasDash = RIGHTMOST(str) == '-';
         }
-        while (!EOS && str.length() < LUCENE_MAX_WORD_LEN - 1)
+        while (!EOS && str.len < LUCENE_MAX_WORD_LEN - 1)
         {
             ch = readChar();
             const bool dot = ch == '.';
@@ -388,78 +577,67 @@ Token * StandardTokenizer::ReadDotted(std::wstring & str, TokenTypes forcedType,
                 break;
             }
 
-            str.push_back(ch);
+            str.buf[str.len++] = ch;
 
             prevWasDot = dot;
             prevWasDash = dash;
         }
     }
 
-    /* There's a potential StringBuffer.append call in the code above, which
-    ** could cause str to reallocate its internal buffer.  We must wait to
-    ** obtain the optimization-oriented strBuf pointer until after the initial
-    ** potentially realloc-triggering operations on str.
-    ** Because there can be other such ops much later in this function, strBuf
-    ** is guarded within a block to prevent its use during or after the calls
-    ** that would potentially invalidate it. */
-    { /* Begin block-guard of strBuf */
-        const wchar_t* strBuf = str.c_str();
-
-        bool rightmostIsDot = RIGHTMOST_IS(str, '.');
-        if (CONSUMED_NOTHING_OF_VALUE)
+    bool rightmostIsDot = RIGHTMOST_IS(str, '.');
+    if (CONSUMED_NOTHING_OF_VALUE)
+    {
+        /* No more alphanums available for this token; shave trailing dot, if any. */
+        if (rightmostIsDot)
         {
-            /* No more alphanums available for this token; shave trailing dot, if any. */
-            if (rightmostIsDot)
-            {
-                SHAVE_RIGHTMOST(str);
-            }
-            /* If there are no dots remaining, this is a generic ALPHANUM. */
-            if (wcschr(strBuf, '.') == NULL)
-            {
-                forcedType = CL_NS2(analysis, standard)::ALPHANUM;
-            }
-
-            /* Check the token to see if it's an acronym.  An acronym must have a
-            ** letter in every even slot and a dot in every odd slot, including the
-            ** last slot (for example, "U.S.A."). */
+            SHAVE_RIGHTMOST(str);
         }
-        else if (rightmostIsDot)
+        /* If there are no dots remaining, this is a generic ALPHANUM. */
+        if (!CONTAINS(str, '.'))
         {
-            bool isAcronym = true;
-            const int32_t upperCheckLimit = str.length() - 1; /* -1 b/c we already checked the last slot. */
+            forcedType = CL_NS2(analysis, standard)::ALPHANUM;
+        }
 
-            for (int32_t i = 0; i < upperCheckLimit; i++)
-            {
-                const bool even = (i % 2 == 0);
-                ch = strBuf[i];
-                if ((even && !ALPHA) || (!even && !DOT))
-                {
-                    isAcronym = false;
-                    break;
-                }
-            }
-            if (isAcronym)
+        /* Check the token to see if it's an acronym.  An acronym must have a
+        ** letter in every even slot and a dot in every odd slot, including the
+        ** last slot (for example, "U.S.A."). */
+    }
+    else if (rightmostIsDot)
+    {
+        bool isAcronym = true;
+        const int32_t upperCheckLimit = str.len - 1; /* -1 b/c we already checked the last slot. */
+
+        for (int32_t i = 0; i < upperCheckLimit; i++)
+        {
+            const bool even = (i % 2 == 0);
+            ch = str.buf[i];
+            if ((even && !ALPHA) || (!even && !DOT))
             {
-                forcedType = CL_NS2(analysis, standard)::ACRONYM;
+                isAcronym = false;
+                break;
             }
-            else
+        }
+        if (isAcronym)
+        {
+            forcedType = CL_NS2(analysis, standard)::ACRONYM;
+        }
+        else
+        {
+            /* If it's not an acronym, we don't want the trailing dot. */
+            SHAVE_RIGHTMOST(str);
+            /* If there are no dots remaining, this is a generic ALPHANUM. */
+            if (!CONTAINS(str, '.'))
             {
-                /* If it's not an acronym, we don't want the trailing dot. */
-                SHAVE_RIGHTMOST(str);
-                /* If there are no dots remaining, this is a generic ALPHANUM. */
-                if (wcschr(strBuf, '.') == NULL)
-                {
-                    forcedType = CL_NS2(analysis, standard)::ALPHANUM;
-                }
+                forcedType = CL_NS2(analysis, standard)::ALPHANUM;
             }
         }
-    } /* End block-guard of strBuf */
+    }
 
     if (!EOS)
     {
-        if (ch == '@' && str.length() < LUCENE_MAX_WORD_LEN - 1)
+        if (ch == '@' && str.len < LUCENE_MAX_WORD_LEN - 1)
         {
-            str.push_back('@');
+            str.buf[str.len++] = '@';
             return ReadAt(str, t);
         }
         else
@@ -472,7 +650,7 @@ Token * StandardTokenizer::ReadDotted(std::wstring & str, TokenTypes forcedType,
         ? forcedType : CL_NS2(analysis, standard)::HOST);
 }
 
-Token* StandardTokenizer::ReadApostrophe(std::wstring & str, Token* t)
+Token* StandardTokenizer::ReadApostrophe(TermBuffer& str, Token* t)
 {
 
     TokenTypes tokenType = CL_NS2(analysis, standard)::APOSTROPHE;
@@ -495,18 +673,18 @@ Token* StandardTokenizer::ReadApostrophe(std::wstring & str, Token* t)
     return setToken(t, str, tokenType);
 }
 
-Token* StandardTokenizer::ReadAt(std::wstring & str, Token* t)
+Token* StandardTokenizer::ReadAt(TermBuffer& str, Token* t)
 {
     ReadDotted(str, CL_NS2(analysis, standard)::EMAIL, t);
     /* JLucene grammar indicates dots/digits not allowed in company name: */
-    if (!CONTAINS_ANY((str), L".0123456789"))
+    if (!CONTAINS_ANY(str, L".0123456789"))
     {
         setToken(t, str, CL_NS2(analysis, standard)::COMPANY);
     }
     return t;
 }
 
-Token* StandardTokenizer::ReadCompany(std::wstring & str, Token* t)
+Token* StandardTokenizer::ReadCompany(TermBuffer& str, Token* t)
 {
     const int32_t specialCharPos = rdPos;
     int ch = 0;
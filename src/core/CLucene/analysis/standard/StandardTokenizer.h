@@ -9,13 +9,12 @@
 #pragma once
 
 
+#include "CLucene/clucene-config.h"
 #include "../AnalysisHeader.h" //required for Tokenizer
 #include "StandardTokenizerConstants.h"
 
 CL_CLASS_DEF(analysis,Token)
-CL_CLASS_DEF(util,BufferedReader)
-CL_CLASS_DEF(util,StringBuffer)
-CL_CLASS_DEF(util,FastCharStream)
+CL_CLASS_DEF(util,Reader)
 
 CL_NS_DEF2(analysis,standard)
 
@@ -38,26 +37,60 @@ CL_NS_DEF2(analysis,standard)
   class CLUCENE_EXPORT StandardTokenizer: public Tokenizer
 {
   private:
+    /* The text of the token being read. buf points into the Token's termBuffer,
+    ** so the token is built in place without an intermediate string. */
+    struct TermBuffer {
+        wchar_t* buf;
+        int32_t len;
+    };
+
+    /* Number of characters pulled from the Reader per block, and number of
+    ** already-read characters kept in front of each new block so that
+    ** unReadChar() can step back across a refill. */
+    LUCENE_STATIC_CONSTANT(int32_t, IO_BUFFER_SIZE = LUCENE_IO_BUFFER_SIZE);
+    LUCENE_STATIC_CONSTANT(int32_t, UNREAD_SLACK = 16);
+
     int32_t rdPos;
     int32_t tokenStart;
 
+    wchar_t ioBuffer[UNREAD_SLACK + IO_BUFFER_SIZE];
+    int32_t bufferPos;
+    int32_t bufferLen;
+    bool eos;
+
+    // Reads the next block of characters from the reader. Returns false at end-of-stream.
+    bool refill();
     // Advance by one character, incrementing rdPos and returning the character.
-    int readChar();
+    inline int readChar();
     // Retreat by one character, decrementing rdPos.
-    void unReadChar();
+    inline void unReadChar();
+    // Returns the next character without consuming it.
+    inline int peekChar();
+    // Copies the run of buffered [A-Za-z0-9_] characters into str, up to LUCENE_MAX_WORD_LEN.
+    inline void consumeAsciiWord(TermBuffer& str);
 
     // createToken centralizes token creation for auditing purposes.
-    inline Token* setToken(Token* t, std::wstring & sb, TokenTypes tokenCode);
+    inline Token* setToken(Token* t, TermBuffer& sb, TokenTypes tokenCode);
 
-    Token* ReadDotted(std::wstring & , TokenTypes forcedType,Token* t);
+    Token* ReadNumber(TermBuffer& str, const bool continuesHost, const wchar_t prev, Token* t);
+    Token* ReadDotted(TermBuffer& str, TokenTypes forcedType, Token* t);
+
+    // Reads for apostrophe-containing word.
+    Token* ReadApostrophe(TermBuffer& str, Token* t);
 
-	CL_NS(util)::BufferedReader* reader;
+    // Reads for something@... it may be a COMPANY name or a EMAIL address
+    Token* ReadAt(TermBuffer& str, Token* t);
+
+    // Reads for COMPANY name like AT&T.
+    Token* ReadCompany(TermBuffer& str, Token* t);
+
+	CL_NS(util)::Reader* reader;
 	bool deleteReader;
-	CL_NS(util)::FastCharStream* rd;
   public:
 
-    // Constructs a tokenizer for this Reader.
-    StandardTokenizer(CL_NS(util)::BufferedReader* reader, bool deleteReader=false);
+    /** Constructs a tokenizer for this Reader. The reader is consumed in blocks,
+    * so it does not need to be a BufferedReader. */
+    StandardTokenizer(CL_NS(util)::Reader* reader, bool deleteReader=false);
 
     virtual ~StandardTokenizer();
 
@@ -71,15 +104,6 @@ CL_NS_DEF2(analysis,standard)
 
     Token* ReadAlphaNum(const wchar_t prev, Token* t);
 
-    // Reads for apostrophe-containing word.
-    Token* ReadApostrophe(std::wstring & str, Token* t);
-
-    // Reads for something@... it may be a COMPANY name or a EMAIL address
-    Token* ReadAt(std::wstring & str, Token* t);
-
-    // Reads for COMPANY name like AT&T.
-    Token* ReadCompany(std::wstring & str, Token* t);
-    
     // Reads CJK characters
     Token* ReadCJK(const wchar_t prev, Token* t);
 
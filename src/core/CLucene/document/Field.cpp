@@ -136,6 +136,24 @@ void Field::setOmitNorms(const bool omitNorms)
         config &= ~INDEX_NONORMS;
 }
 
+bool Field::getIndexTermGrams() const { return (config & INDEX_TERMGRAMS) != 0; }
+void Field::setIndexTermGrams(const bool indexTermGrams)
+{
+    if (indexTermGrams)
+        config |= INDEX_TERMGRAMS;
+    else
+        config &= ~INDEX_TERMGRAMS;
+}
+
+bool Field::getImpactTiers() const { return (config & INDEX_IMPACTTIERS) != 0; }
+void Field::setImpactTiers(const bool impactTiers)
+{
+    if (impactTiers)
+        config |= INDEX_IMPACTTIERS;
+    else
+        config &= ~INDEX_IMPACTTIERS;
+}
+
 bool Field::isLazy() const { return lazy; }
 
 void Field::setValue(wchar_t* value, const bool duplicateValue)
@@ -212,6 +230,13 @@ void Field::setConfig(const uint32_t x)
 
         if (!index)
             newConfig |= INDEX_NO;
+        else
+        {
+            if (x & INDEX_TERMGRAMS)
+                newConfig |= INDEX_TERMGRAMS;
+            if (x & INDEX_IMPACTTIERS)
+                newConfig |= INDEX_IMPACTTIERS;
+        }
     }
     else
         newConfig |= INDEX_NO;
@@ -306,6 +331,14 @@ std::wstring Field::toString()
     {
         result.append(L",omitNorms");
     }
+    if (getIndexTermGrams())
+    {
+        result.append(L",termGrams");
+    }
+    if (getImpactTiers())
+    {
+        result.append(L",impactTiers");
+    }
     if (isLazy())
     {
         result.append(L",lazy");
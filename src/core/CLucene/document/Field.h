@@ -80,7 +80,25 @@ public:
 		* to have the above described effect on a field, all instances of that
 		* field must be indexed with NO_NORMS from the beginning.
 		*/
-		INDEX_NONORMS=128
+		INDEX_NONORMS=128,
+
+		/** Expert: also write a k-gram index of the field's terms, which
+		* lets wildcard queries with a leading wildcard find their matching
+		* terms without scanning the whole term dictionary. Combine it with
+		* one of the other INDEX_ values. Like term vectors, once a field has
+		* been indexed with k-grams, later segments of that field keep them.
+		*/
+		INDEX_TERMGRAMS=4096,
+
+		/** Expert: also write, when segments are merged, the impact tier of
+		* each term of the field that is in many documents: the documents
+		* where the term weighs the most, which an IndexSearcher set to use
+		* them (see IndexSearcher#setImpactTiers) scores first, so that it
+		* can skip the rest of the term's documents once they cannot make
+		* the top hits. Combine it with one of the other INDEX_ values. Once
+		* a field has impact tiers, later segments of that field keep them.
+		*/
+		INDEX_IMPACTTIERS=8192
 	};
 
 	enum TermVector{
@@ -253,6 +271,28 @@ public:
 	*/
 	void setOmitNorms(const bool omitNorms);
 
+	/** True if a k-gram index of this field's terms is written */
+	bool getIndexTermGrams() const;
+
+	/** Expert:
+	*
+	* If set, a k-gram index of this indexed field's terms is written so that
+	* leading wildcard queries can find candidate terms without a full scan.
+	* @see INDEX_TERMGRAMS
+	*/
+	void setIndexTermGrams(const bool indexTermGrams);
+
+	/** True if merges write the impact tiers of this field's terms */
+	bool getImpactTiers() const;
+
+	/** Expert:
+	*
+	* If set, merges write the impact tiers of this indexed field's frequent
+	* terms, so that searches can skip their documents that weigh the least.
+	* @see INDEX_IMPACTTIERS
+	*/
+	void setImpactTiers(const bool impactTiers);
+
 	/**
 	* Indicates whether a Field is Lazy or not.  The semantics of Lazy loading are such that if a Field is lazily loaded, retrieving
 	* it's values via {@link #stringValue()} or {@link #binaryValue()} is only valid as long as the {@link org.apache.lucene.index.IndexReader} that
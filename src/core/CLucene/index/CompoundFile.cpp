@@ -75,6 +75,9 @@ public:
 
     int64_t length() const { return _length; }
 
+    /** Maps into the compound file, if it is mapped */
+    const uint8_t* getMappedBytes(const int64_t pos, const int32_t len);
+
     const std::wstring getDirectoryType() const { return CompoundFileReader::getClassName(); }
   const std::wstring getObjectName() const { return getClassName(); }
   static const std::wstring getClassName() { return L"CSIndexInput"; }
@@ -131,6 +134,13 @@ void CSIndexInput::close()
 {
 }
 
+const uint8_t* CSIndexInput::getMappedBytes(const int64_t pos, const int32_t len)
+{
+    if (pos < 0 || len < 0 || pos + len > _length)
+        return NULL;
+    return base->getMappedBytes(fileOffset + pos, len);
+}
+
 
 
 CompoundFileReader::CompoundFileReader(Directory* dir, const wchar_t * name, int32_t _readBufferSize) :
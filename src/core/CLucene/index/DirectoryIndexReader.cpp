@@ -24,6 +24,8 @@ CL_NS_DEF(index)
 
 
   void DirectoryIndexReader::doClose() {
+    if (writer != NULL)
+      writer->releaseReader(this);
     if(closeDirectory && _directory){
         _directory->close();
     }
@@ -83,6 +85,8 @@ CL_NS_DEF(index)
   }
 
   void DirectoryIndexReader::acquireWriteLock() {
+    if (fromWriter)
+      _CLTHROWA(CL_ERR_UnsupportedOperation, "This IndexReader was returned by IndexWriter::getReader and cannot modify the index; use the IndexWriter instead");
     if (segmentInfos != NULL) {
       ensureOpen();
       if (stale)
@@ -114,6 +118,8 @@ CL_NS_DEF(index)
     this->stale = false;
     this->writeLock = NULL;
     this->rollbackSegmentInfos = NULL;
+    this->writer = NULL;
+    this->fromWriter = false;
     this->_directory = _CL_POINTER(__directory);
     this->segmentInfos = segmentInfos;
     this->closeDirectory = closeDirectory;
@@ -125,6 +131,8 @@ CL_NS_DEF(index)
   }
   DirectoryIndexReader::~DirectoryIndexReader(){
     try {
+      if (writer != NULL)
+        writer->releaseReader(this);
       if (writeLock != NULL) {
         writeLock->release();                        // release write lock
         writeLock = NULL;
@@ -184,11 +192,18 @@ CL_NS_DEF(index)
       SegmentInfos* infos = _CLNEW SegmentInfos();
       infos->read(directory, segmentFileName);
 
+      // asked first, reopening hands the reused segments over
+      const size_t skipListCacheSize = _this->getSkipListCacheSize();
+      const int32_t skipListCacheMinDocFreq = _this->getSkipListCacheMinDocFreq();
+
       DirectoryIndexReader* newReader = _this->doReopen(infos);
 
       if (_this != newReader) {
         newReader->init(directory, infos, closeDirectory);
         newReader->deletionPolicy = deletionPolicy;
+        // the segments that are new get the skip list cache too
+        if (skipListCacheSize > 0)
+          newReader->setSkipListCache(skipListCacheSize, skipListCacheMinDocFreq);
       }
 
       return newReader;
@@ -212,17 +227,31 @@ CL_NS_DEF(index)
       // the index hasn't changed - nothing to do here
       return this;
     }
-    FindSegmentsFile_Reopen runner(closeDirectory, deletionPolicy, _directory, this);
-    IndexReader* ret = runner.run();
+    IndexReader* ret;
+    if (fromWriter) {
+      // our segments may not be committed yet: ask the writer
+      ensureWriterOpen();
+      ret = writer->openReader(this);
+    } else {
+      FindSegmentsFile_Reopen runner(closeDirectory, deletionPolicy, _directory, this);
+      ret = runner.run();
+    }
 
-    //disown this memory...
-    this->writeLock = NULL;
-    this->_directory = NULL;
-    this->deletionPolicy = NULL;
+    if (ret != this) {
+      //disown this memory...
+      this->writeLock = NULL;
+      this->_directory = NULL;
+      this->deletionPolicy = NULL;
+    }
 
     return ret;
   }
 
+  void DirectoryIndexReader::ensureWriterOpen() {
+    if (writer == NULL)
+      _CLTHROWA(CL_ERR_AlreadyClosed, "the IndexWriter this reader was returned by is closed");
+  }
+
   void DirectoryIndexReader::setDeletionPolicy(IndexDeletionPolicy* deletionPolicy) {
     this->deletionPolicy = deletionPolicy;
   }
@@ -258,6 +287,10 @@ CL_NS_DEF(index)
    */
   bool DirectoryIndexReader::isCurrent(){
     ensureOpen();
+    if (fromWriter) {
+      ensureWriterOpen();
+      return writer->isReaderCurrent(this);
+    }
     return SegmentInfos::readCurrentVersion(_directory) == segmentInfos->getVersion();
   }
 
@@ -15,6 +15,7 @@ CL_CLASS_DEF(store,LuceneLock)
 
 CL_NS_DEF(index)
 class IndexDeletionPolicy;
+class IndexWriter;
 
 /**
  * IndexReader implementation that has access to a Directory.
@@ -35,6 +36,17 @@ private:
   bool rollbackHasChanges;
   SegmentInfos* rollbackSegmentInfos;
 
+  /** Set for readers returned by IndexWriter::getReader: they see
+   *  the writer's uncommitted segments and are reopened through it.
+   *  Reset to NULL once that writer is closed. */
+  IndexWriter* writer;
+  bool fromWriter;
+
+  /** Throws CL_ERR_AlreadyClosed if the writer this reader came
+   *  from has been closed */
+  void ensureWriterOpen();
+  friend class IndexWriter;
+
   class FindSegmentsFile_Open;
   class FindSegmentsFile_Reopen;
   friend class FindSegmentsFile_Open;
@@ -109,6 +109,8 @@ DocumentsWriter::DocumentsWriter(CL_NS(store)::Directory* directory, IndexWriter
   infoStream = NULL;
   fieldsWriter = NULL;
   tvx = tvf = tvd = NULL;
+  flushBuffer = NULL;
+  numBytesFlushing = 0;
   postingsFreeCountDW = postingsAllocCountDW = numWaiting = pauseThreads = abortCount = 0;
   docStoreOffset = nextDocID = numDocsInRAM = numDocsInStore = nextWriteDocID = 0;
 }
@@ -119,9 +121,13 @@ DocumentsWriter::~DocumentsWriter(){
   _CLLDELETE(_files);
   _CLLDELETE(fieldInfos);
 
+  _CLLDELETE(flushBuffer);
   for(size_t i=0;i<threadStates.length;i++) {
     _CLLDELETE(threadStates.values[i]);
   }
+  for(size_t i=0;i<freeThreadStates.size();i++) {
+    _CLLDELETE(freeThreadStates[i]);
+  }
 
   // Make sure unused posting slots aren't attempted delete on
   if (this->postingsFreeListDW.values){
@@ -207,9 +213,8 @@ std::wstring DocumentsWriter::closeDocStore() {
     if (fieldsWriter != NULL) {
       assert (!docStoreSegment.empty());
       fieldsWriter->close();
+      assert(fieldsWriter->indexLength(numDocsInStore) == directory->fileLength( (docStoreSegment + L"." + IndexFileNames::FIELDS_INDEX_EXTENSION).c_str() ) );// "after flush: fdx size mismatch: " + numDocsInStore + " docs vs " + directory->fileLength(docStoreSegment + "." + IndexFileNames::FIELDS_INDEX_EXTENSION) + " length in bytes of " + docStoreSegment + "." + IndexFileNames::FIELDS_INDEX_EXTENSION;
       _CLDELETE(fieldsWriter);
-
-      assert(numDocsInStore*8 == directory->fileLength( (docStoreSegment + L"." + IndexFileNames::FIELDS_INDEX_EXTENSION).c_str() ) );// "after flush: fdx size mismatch: " + numDocsInStore + " docs vs " + directory->fileLength(docStoreSegment + "." + IndexFileNames::FIELDS_INDEX_EXTENSION) + " length in bytes of " + docStoreSegment + "." + IndexFileNames::FIELDS_INDEX_EXTENSION;
     }
 
     std::wstring s = docStoreSegment;
@@ -252,6 +257,13 @@ const std::vector<std::wstring>& DocumentsWriter::files() {
   return *_files;
 }
 
+void DocumentsWriter::copyFiles(std::vector<std::wstring>& result) {
+	SCOPED_LOCK_MUTEX(THIS_LOCK)
+
+  const std::vector<std::wstring>& current = files();
+  result.insert(result.end(), current.begin(), current.end());
+}
+
 void DocumentsWriter::setAborting() {
 	SCOPED_LOCK_MUTEX(THIS_LOCK)
 
@@ -432,55 +444,141 @@ bool DocumentsWriter::allThreadsIdle() {
   return true;
 }
 
-int32_t DocumentsWriter::flush(bool _closeDocStore) {
+DocumentsWriter::FlushBuffer::FlushBuffer():
+  numDocs(0), numBytesUsed(0), hasNorms(false), fieldInfos(NULL),
+  deleteTerms(NULL), numDeleteTerms(0)
+{
+}
+DocumentsWriter::FlushBuffer::~FlushBuffer(){
+  for(size_t i=0;i<threadStates.length;i++) {
+    _CLLDELETE(threadStates.values[i]);
+  }
+  _CLLDELETE(fieldInfos);
+  if (deleteTerms != NULL) {
+    // The terms are reference counted
+    TermNumMapType::iterator term = deleteTerms->begin();
+    while ( term != deleteTerms->end() ){
+      Term* t = term->first;
+      _CLDELETE(term->second);
+      deleteTerms->erase(term);
+      _CLDECDELETE(t);
+      term = deleteTerms->begin();
+    }
+    _CLDELETE(deleteTerms);
+  }
+}
+
+void DocumentsWriter::startFlush(bool _closeDocStore) {
 	SCOPED_LOCK_MUTEX(THIS_LOCK)
 
   assert ( allThreadsIdle() );
-
-  if (segment.empty()){
-      // In case we are asked to flush an empty segment
-      segment = writer->newSegmentName();
-  }
+  assert ( flushBuffer == NULL );
 
   newFiles.clear();
 
-  docStoreOffset = numDocsInStore;
+  FlushBuffer* buffer = _CLNEW FlushBuffer();
 
-  int32_t docCount;
+  try {
+    if (numDocsInRAM > 0) {
+      docStoreOffset = numDocsInStore;
+
+      if (infoStream != NULL)
+        (*infoStream) << std::wstring(L"\nflush postings as segment ") << segment << std::wstring(L" numDocs=") << Misc::toString(numDocsInRAM) << std::wstring(L"\n");
+
+      if (_closeDocStore) {
+        assert ( !docStoreSegment.empty());
+        assert ( docStoreSegment.compare(segment) == 0 );
+        const std::vector<std::wstring>& tmp = files();
+        for (std::vector<std::wstring>::const_iterator itr = tmp.begin();
+          itr != tmp.end(); itr++ )
+          newFiles.push_back(*itr);
+        closeDocStore();
+      }
 
-  assert ( numDocsInRAM > 0 );
+      buffer->segment = segment;
+      buffer->numDocs = numDocsInRAM;
+      buffer->hasNorms = hasNorms;
+      buffer->fieldInfos = fieldInfos->clone();
+    }
+  } catch (...) {
+    _CLDELETE(buffer);
+    throw;
+  }
 
-  if (infoStream != NULL)
-    (*infoStream) << std::wstring(L"\nflush postings as segment ") << segment << std::wstring(L" numDocs=") << Misc::toString(numDocsInRAM) << std::wstring(L"\n");
+  if (buffer->numDocs > 0) {
+    // Hand the ThreadStates and norms over; threads get
+    // fresh ones for the next segment
+    buffer->threadStates.length = threadStates.length;
+    buffer->threadStates.values = threadStates.takeArray();
+    threadStates.length = 0;
+
+    const size_t numNorms = norms.length;
+    buffer->norms.length = numNorms;
+    buffer->norms.values = norms.takeArray();
+    norms.length = 0;
+    norms.resize(numNorms);
+
+    threadBindings.clear();
+    segment.erase();
+    numDocsInRAM = 0;
+    nextDocID = 0;
+    nextWriteDocID = 0;
+  }
 
-  bool success = false;
+  buffer->deleteTerms = bufferedDeleteTerms;
+  bufferedDeleteTerms = _CLNEW TermNumMapType(true, true);
+  buffer->deleteDocIDs.swap(bufferedDeleteDocIDs);
+  buffer->numDeleteTerms = numBufferedDeleteTerms;
+  numBufferedDeleteTerms = 0;
 
-  try {
+  buffer->numBytesUsed = numBytesUsed;
+  numBytesFlushing = numBytesUsed;
+  numBytesUsed = 0;
+  bufferIsFull = false;
 
-    if (_closeDocStore) {
-      assert ( !docStoreSegment.empty());
-	    assert ( docStoreSegment.compare(segment) == 0 );
-	    const std::vector<std::wstring>& tmp = files();
-	    for (std::vector<std::wstring>::const_iterator itr = tmp.begin();
-		    itr != tmp.end(); itr++ )
-		    newFiles.push_back(*itr);
-      closeDocStore();
-    }
+  flushBuffer = buffer;
+}
 
-    fieldInfos->write(directory, (segment + L".fnm").c_str() );
+int32_t DocumentsWriter::flush() {
+  FlushBuffer* buffer = flushBuffer;
+  assert ( buffer != NULL && buffer->numDocs > 0 );
 
-    docCount = numDocsInRAM;
+  buffer->fieldInfos->write(directory, (buffer->segment + L".fnm").c_str() );
 
-    writeSegment(newFiles); //write new files directly...
+  writeSegment(buffer, newFiles); //write new files directly...
 
-    success = true;
+  return buffer->numDocs;
+}
 
-  } _CLFINALLY(
-    if (!success)
-      abort(NULL);
-  )
+void DocumentsWriter::finishFlush() {
+	SCOPED_LOCK_MUTEX(THIS_LOCK)
+
+  if (flushBuffer == NULL)
+    return;
+
+  // Keep the flushed ThreadStates around for the next new
+  // threads; their hashes and pools are already sized
+  ValueArray<ThreadState*>& states = flushBuffer->threadStates;
+  for(size_t i=0;i<states.length;i++) {
+    ThreadState* state = states[i];
+    state->resetPostings();
+    freeThreadStates.push_back(state);
+    states.values[i] = NULL;
+  }
+  _CLDELETE(flushBuffer);
+  numBytesFlushing = 0;
+
+  // Maybe downsize this->postingsFreeListDW array.  The
+  // Postings that threads hold now must still fit back.
+  if (this->postingsFreeListDW.length > 1.5*this->postingsAllocCountDW) {
+    int32_t newSize = this->postingsFreeListDW.length;
+    while(newSize > 1.25*this->postingsAllocCountDW) {
+      newSize = (int32_t) (newSize*0.8);
+    }
+    this->postingsFreeListDW.resize(newSize);
+  }
 
-  return docCount;
+  balanceRAM();
 }
 
 void DocumentsWriter::createCompoundFile(const std::wstring& segment)
@@ -512,18 +610,19 @@ void DocumentsWriter::clearFlushPending() {
   flushPending = false;
 }
 
-void DocumentsWriter::writeNorms(const std::wstring& segmentName, int32_t totalNumDoc) {
-  IndexOutput* normsOut = directory->createOutput( (segmentName + L"." + IndexFileNames::NORMS_EXTENSION).c_str() );
+void DocumentsWriter::writeNorms(FlushBuffer* buffer) {
+  const int32_t totalNumDoc = buffer->numDocs;
+  IndexOutput* normsOut = directory->createOutput( (buffer->segment + L"." + IndexFileNames::NORMS_EXTENSION).c_str() );
 
   try {
 	  normsOut->writeBytes(SegmentMerger::NORMS_HEADER, SegmentMerger::NORMS_HEADER_length);
 
-    const int32_t numField = fieldInfos->size();
+    const int32_t numField = buffer->fieldInfos->size();
 
     for (int32_t fieldIdx=0;fieldIdx<numField;fieldIdx++) {
-      FieldInfo* fi = fieldInfos->fieldInfo(fieldIdx);
+      FieldInfo* fi = buffer->fieldInfos->fieldInfo(fieldIdx);
       if (fi->isIndexed && !fi->omitNorms) {
-        BufferedNorms* n = norms[fieldIdx];
+        BufferedNorms* n = buffer->norms[fieldIdx];
         int64_t v;
         if (n == NULL)
           v = 0;
@@ -542,16 +641,15 @@ void DocumentsWriter::writeNorms(const std::wstring& segmentName, int32_t totalN
   )
 }
 
-void DocumentsWriter::writeSegment(std::vector<std::wstring>& flushedFiles) {
-
-  assert ( allThreadsIdle() );
-
-  assert ( nextDocID == numDocsInRAM );
+void DocumentsWriter::writeSegment(FlushBuffer* buffer, std::vector<std::wstring>& flushedFiles) {
 
-  const std::wstring segmentName = segment;
+  const std::wstring& segmentName = buffer->segment;
+  const int32_t numDocs = buffer->numDocs;
+  ValueArray<ThreadState*>& states = buffer->threadStates;
 
-  TermInfosWriter* termsOut = _CLNEW TermInfosWriter(directory, segmentName.c_str(), fieldInfos,
-                                                 writer->getTermIndexInterval());
+  TermInfosWriter* termsOut = _CLNEW TermInfosWriter(directory, segmentName.c_str(), buffer->fieldInfos,
+                                                 writer->getTermIndexInterval(),
+                                                 writer->getSkipInterval(), writer->getMaxSkipLevels());
 
   IndexOutput* freqOut = directory->createOutput( (segmentName + L".frq").c_str() );
   IndexOutput* proxOut = directory->createOutput( (segmentName + L".prx").c_str() );
@@ -559,9 +657,8 @@ void DocumentsWriter::writeSegment(std::vector<std::wstring>& flushedFiles) {
   // Gather all FieldData's that have postings, across all
   // ThreadStates
   std::vector<ThreadState::FieldData*> allFields;
-  assert ( allThreadsIdle() );
-  for(size_t i=0;i<threadStates.length;i++) {
-    ThreadState* state = threadStates[i];
+  for(size_t i=0;i<states.length;i++) {
+    ThreadState* state = states[i];
     state->trimFields();
     const int32_t numFields = state->numAllFieldData;
     for(int32_t j=0;j<numFields;j++) {
@@ -577,7 +674,7 @@ void DocumentsWriter::writeSegment(std::vector<std::wstring>& flushedFiles) {
 
   skipListWriter = _CLNEW DefaultSkipListWriter(termsOut->skipInterval,
                                              termsOut->maxSkipLevels,
-                                             numDocsInRAM, freqOut, proxOut);
+                                             numDocs, freqOut, proxOut);
 
   int32_t start = 0;
   while(start < numAllFields) {
@@ -594,7 +691,7 @@ void DocumentsWriter::writeSegment(std::vector<std::wstring>& flushedFiles) {
 
     // If this field has postings then add them to the
     // segment
-    appendPostings(&fields, termsOut, freqOut, proxOut);
+    appendPostings(buffer, &fields, termsOut, freqOut, proxOut);
 
     for(size_t i=0;i<fields.length;i++)
       fields[i]->resetPostingArrays();
@@ -611,49 +708,33 @@ void DocumentsWriter::writeSegment(std::vector<std::wstring>& flushedFiles) {
   _CLDELETE(skipListWriter);
 
   // Record all files we have flushed
-  flushedFiles.push_back(segmentFileName(IndexFileNames::FIELD_INFOS_EXTENSION));
-  flushedFiles.push_back(segmentFileName(IndexFileNames::FREQ_EXTENSION));
-  flushedFiles.push_back(segmentFileName(IndexFileNames::PROX_EXTENSION));
-  flushedFiles.push_back(segmentFileName(IndexFileNames::TERMS_EXTENSION));
-  flushedFiles.push_back(segmentFileName(IndexFileNames::TERMS_INDEX_EXTENSION));
-
-  if (hasNorms) {
-    writeNorms(segmentName, numDocsInRAM);
-    flushedFiles.push_back(segmentFileName(IndexFileNames::NORMS_EXTENSION));
+  const std::wstring prefix = segmentName + L".";
+  flushedFiles.push_back(prefix + IndexFileNames::FIELD_INFOS_EXTENSION);
+  flushedFiles.push_back(prefix + IndexFileNames::FREQ_EXTENSION);
+  flushedFiles.push_back(prefix + IndexFileNames::PROX_EXTENSION);
+  flushedFiles.push_back(prefix + IndexFileNames::TERMS_EXTENSION);
+  flushedFiles.push_back(prefix + IndexFileNames::TERMS_INDEX_EXTENSION);
+  if (buffer->fieldInfos->hasTermGrams())
+    flushedFiles.push_back(prefix + IndexFileNames::TERM_GRAMS_EXTENSION);
+
+  if (buffer->hasNorms) {
+    writeNorms(buffer);
+    flushedFiles.push_back(prefix + IndexFileNames::NORMS_EXTENSION);
   }
 
   if (infoStream != NULL) {
     const int64_t newSegmentSize = segmentSize(segmentName);
 
-    (*infoStream) << std::wstring(L"  oldRAMSize=") << Misc::toString(numBytesUsed) <<
+    (*infoStream) << std::wstring(L"  oldRAMSize=") << Misc::toString(buffer->numBytesUsed) <<
 				std::wstring(L" newFlushedSize=") << Misc::toString(newSegmentSize) <<
-        std::wstring(L" docs/MB=") << Misc::toString((float_t)(numDocsInRAM/(newSegmentSize/1024.0/1024.0))) <<
-        std::wstring(L" new/old=") << Misc::toString((float_t)(100.0*newSegmentSize/numBytesUsed)) << std::wstring(L"%\n");
-  }
-
-  resetPostingsData();
-
-  nextDocID = 0;
-  nextWriteDocID = 0;
-  numDocsInRAM = 0;
-  _CLDELETE(_files);
-
-  // Maybe downsize this->postingsFreeListDW array
-  if (this->postingsFreeListDW.length > 1.5*this->postingsFreeCountDW) {
-    int32_t newSize = this->postingsFreeListDW.length;
-    while(newSize > 1.25*this->postingsFreeCountDW) {
-      newSize = (int32_t) (newSize*0.8);
-    }
-    this->postingsFreeListDW.resize(newSize);
+        std::wstring(L" docs/MB=") << Misc::toString((float_t)(numDocs/(newSegmentSize/1024.0/1024.0))) <<
+        std::wstring(L" new/old=") << Misc::toString((float_t)(100.0*newSegmentSize/buffer->numBytesUsed)) << std::wstring(L"%\n");
   }
 
-}
-
-std::wstring DocumentsWriter::segmentFileName(const wchar_t * extension) {
-  return segmentFileName( std::wstring(extension) );
-}
-std::wstring DocumentsWriter::segmentFileName(const std::wstring& extension) {
-  return segment + L"." + extension;
+  // Give the blocks and Postings back while we are not
+  // holding the lock
+  for(size_t i=0;i<states.length;i++)
+    states[i]->resetPostings();
 }
 
 int32_t DocumentsWriter::compareText(const wchar_t* text1, const wchar_t* text2) {
@@ -678,7 +759,8 @@ int32_t pos2=0;
 }
 
 
-void DocumentsWriter::appendPostings(ArrayBase<ThreadState::FieldData*>* fields,
+void DocumentsWriter::appendPostings(FlushBuffer* buffer,
+                    ArrayBase<ThreadState::FieldData*>* fields,
                     TermInfosWriter* termsOut,
                     IndexOutput* freqOut,
                     IndexOutput* proxOut) {
@@ -703,7 +785,9 @@ void DocumentsWriter::appendPostings(ArrayBase<ThreadState::FieldData*>* fields,
   memcpy(mergeStates.values,mergeStatesData.values,sizeof(FieldMergeState*) * numFields);
 
   const int32_t skipInterval = termsOut->skipInterval;
-  currentFieldStorePayloads = (*fields)[0]->fieldInfo->storePayloads;
+  // Threads adding documents may turn payloads on for the
+  // field meanwhile; those postings go to the next segment
+  currentFieldStorePayloads = buffer->fieldInfos->fieldInfo(fieldNumber)->storePayloads;
 
   ValueArray<FieldMergeState*> termStates(numFields);
 
@@ -758,7 +842,7 @@ void DocumentsWriter::appendPostings(ArrayBase<ThreadState::FieldData*>* fields,
       const int32_t doc = minState->docID;
       const int32_t termDocFreq = minState->termFreq;
 
-      assert (doc < numDocsInRAM);
+      assert (doc < buffer->numDocs);
       assert ( doc > lastDoc || df == 1 );
 
       const int32_t newDocCode = (doc-lastDoc)<<1;
@@ -852,36 +936,51 @@ DocumentsWriter::ThreadState* DocumentsWriter::getThreadState(Document* doc, Ter
   // has affinity to a specific ThreadState, use that one
   // again.
   ThreadState* state = NULL;
-  if ( threadBindings.find(_LUCENE_CURRTHREADID) == threadBindings.end() ){
-    // First time this thread has called us since last flush
-    ThreadState* minThreadState = NULL;
-    for(size_t i=0;i<threadStates.length;i++) {
-      ThreadState* ts = threadStates[i];
-      if (minThreadState == NULL || ts->numThreads < minThreadState->numThreads)
-        minThreadState = ts;
-    }
-    if (minThreadState != NULL && (minThreadState->numThreads == 0 || threadStates.length == MAX_THREAD_STATE)) {
-      state = minThreadState;
-      state->numThreads++;
-    } else {
-      // Just create a new "private" thread state
-      threadStates.resize(1+threadStates.length);
-      //fill the new position
-      state = threadStates.values[threadStates.length-1] = _CLNEW ThreadState(this);
+  while (state == NULL) {
+    if ( threadBindings.find(_LUCENE_CURRTHREADID) == threadBindings.end() ){
+      // First time this thread has called us since last flush
+      ThreadState* minThreadState = NULL;
+      for(size_t i=0;i<threadStates.length;i++) {
+        ThreadState* ts = threadStates[i];
+        if (minThreadState == NULL || ts->numThreads < minThreadState->numThreads)
+          minThreadState = ts;
+      }
+      if (minThreadState != NULL && (minThreadState->numThreads == 0 || threadStates.length == MAX_THREAD_STATE)) {
+        state = minThreadState;
+        state->numThreads++;
+      } else {
+        // Just create a new "private" thread state, or reuse
+        // one given back by a flush
+        if (freeThreadStates.empty())
+          state = _CLNEW ThreadState(this);
+        else {
+          state = freeThreadStates.back();
+          freeThreadStates.pop_back();
+          state->numThreads = 1;
+        }
+        threadStates.resize(1+threadStates.length);
+        //fill the new position
+        threadStates.values[threadStates.length-1] = state;
+      }
+      threadBindings.put(_LUCENE_CURRTHREADID, state);
+    }else{
+      state = threadBindings[_LUCENE_CURRTHREADID];
     }
-    threadBindings.put(_LUCENE_CURRTHREADID, state);
-  }else{
-    state = threadBindings[_LUCENE_CURRTHREADID];
-  }
 
-  // Next, wait until my thread state is idle (in case
-  // it's shared with other threads) and for threads to
-  // not be paused nor a flush pending:
-  while(!closed && (!state->isIdle || pauseThreads != 0 || flushPending || abortCount > 0))
-    CONDITION_WAIT(THIS_LOCK, THIS_WAIT_CONDITION)
+    // Next, wait until my thread state is idle (in case
+    // it's shared with other threads) and for threads to
+    // not be paused nor a flush pending:
+    while(!closed && (!state->isIdle || pauseThreads != 0 || flushPending || abortCount > 0))
+      CONDITION_WAIT(THIS_LOCK, THIS_WAIT_CONDITION)
 
-  if (closed)
-    _CLTHROWA(CL_ERR_AlreadyClosed, "this IndexWriter is closed");
+    if (closed)
+      _CLTHROWA(CL_ERR_AlreadyClosed, "this IndexWriter is closed");
+
+    // If a flush started meanwhile, it took my ThreadState
+    // away with the segment; start over with a fresh one
+    if (threadBindings.get(_LUCENE_CURRTHREADID) != state)
+      state = NULL;
+  }
 
   if (segment.empty())
     segment = writer->newSegmentName();
@@ -992,21 +1091,19 @@ const std::vector<int32_t>* DocumentsWriter::getBufferedDeleteDocIDs() {
   return &bufferedDeleteDocIDs;
 }
 
-// Reset buffered deletes.
-void DocumentsWriter::clearBufferedDeletes() {
-	SCOPED_LOCK_MUTEX(THIS_LOCK)
-  DocumentsWriter::TermNumMapType::iterator term = bufferedDeleteTerms->begin();
-  while ( term != bufferedDeleteTerms->end() ){
-    Term* t = term->first;
-    _CLDELETE(term->second);
-    bufferedDeleteTerms->erase(term);
-    _CLDECDELETE(t);
-    term = bufferedDeleteTerms->begin();
-  }
-  bufferedDeleteDocIDs.clear();
-  numBufferedDeleteTerms = 0;
-  if (numBytesUsed > 0)
-    resetPostingsData();
+int32_t DocumentsWriter::getNumFlushedDeleteTerms() {
+  assert (flushBuffer != NULL);
+  return flushBuffer->numDeleteTerms;
+}
+
+const DocumentsWriter::TermNumMapType& DocumentsWriter::getFlushedDeleteTerms() {
+  assert (flushBuffer != NULL);
+  return *flushBuffer->deleteTerms;
+}
+
+const std::vector<int32_t>* DocumentsWriter::getFlushedDeleteDocIDs() {
+  assert (flushBuffer != NULL);
+  return &flushBuffer->deleteDocIDs;
 }
 
 bool DocumentsWriter::bufferDeleteTerms(const ArrayBase<Term*>* terms) {
@@ -1137,6 +1234,10 @@ int64_t DocumentsWriter::getRAMUsed() {
   return numBytesUsed;
 }
 
+int64_t DocumentsWriter::getRAMFlushing() {
+  return numBytesFlushing;
+}
+
 void DocumentsWriter::fillBytes(IndexOutput* out, uint8_t b, int32_t numBytes) {
   for(int32_t i=0;i<numBytes;i++)
     out->writeByte(b);
@@ -1289,7 +1390,9 @@ void DocumentsWriter::balanceRAM() {
   // We flush when we've used our target usage
   const int64_t flushTrigger = (int64_t) ramBufferSize;
 
-  if (numBytesAlloc > freeTrigger) {
+  // RAM held by a segment being flushed comes back when
+  // that flush finishes, so it does not count here
+  if (numBytesAlloc - numBytesFlushing > freeTrigger) {
     if (infoStream != NULL)
       (*infoStream) << std::wstring(L"  RAM: now balance allocations: usedMB=") << toMB(numBytesUsed) +
                          std::wstring(L" vs trigger=") << toMB(flushTrigger) <<
@@ -1312,7 +1415,7 @@ void DocumentsWriter::balanceRAM() {
     // chunks until we are below our threshold
     // (freeLevel)
 
-    while(numBytesAlloc > freeLevel) {
+    while(numBytesAlloc - numBytesFlushing > freeLevel) {
       if (0 == freeByteBlocks.size() && 0 == freeCharBlocks.size() && 0 == this->postingsFreeCountDW) {
         // Nothing else to free -- must flush now.
         bufferIsFull = true;
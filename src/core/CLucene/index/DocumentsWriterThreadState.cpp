@@ -205,6 +205,10 @@ void DocumentsWriter::ThreadState::init(Document* doc, int32_t docID) {
     FieldInfo* fi = _parent->fieldInfos->add(field->name(), field->isIndexed(), field->isTermVectorStored(),
                                   field->isStorePositionWithTermVector(), field->isStoreOffsetWithTermVector(),
                                   field->getOmitNorms(), false);
+    if (field->getIndexTermGrams())
+      fi->indexTermGrams = true;
+    if (field->getImpactTiers())
+      fi->impactTiers = true;
     if (fi->isIndexed && !fi->omitNorms) {
       // Maybe grow our buffered norms
       if (_parent->norms.length <= fi->number) {
@@ -304,7 +308,8 @@ void DocumentsWriter::ThreadState::init(Document* doc, int32_t docID) {
       // because those files will be in an unknown
       // state:
       try {
-        _parent->fieldsWriter = _CLNEW FieldsWriter(_parent->directory, _parent->docStoreSegment.c_str(), _parent->fieldInfos);
+        _parent->fieldsWriter = _CLNEW FieldsWriter(_parent->directory, _parent->docStoreSegment.c_str(), _parent->fieldInfos,
+          (uint8_t)_parent->writer->getStoredFieldsCompression());
       } catch (CLuceneError& t) {
         throw AbortException(t,_parent);
       }
@@ -512,17 +517,6 @@ void DocumentsWriter::ThreadState::trimFields() {
     allFieldDataArray[i] = NULL;
   }
 
-  // If we didn't see any norms for this field since
-  // last flush, free it
-  for(size_t i=0;i<_parent->norms.length;i++) {
-    BufferedNorms* n = _parent->norms[i];
-    if (n != NULL && n->upto == 0)
-    {
-      _CLLDELETE(n);
-      _parent->norms.values[i] = NULL;
-    }
-  }
-
   numAllFieldData = upto;
 
   // Also pare back PostingsVectors if it's excessively
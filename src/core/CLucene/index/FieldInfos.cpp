@@ -38,7 +38,9 @@ FieldInfo::FieldInfo(	const wchar_t* _fieldName,
 	storeTermVector(_storeTermVector),
 	storeOffsetWithTermVector(_storeOffsetWithTermVector),
 	storePositionWithTermVector(_storePositionWithTermVector),
-	omitNorms(_omitNorms), storePayloads(_storePayloads)
+	omitNorms(_omitNorms), storePayloads(_storePayloads),
+	indexTermGrams(false),
+	impactTiers(false)
 {
 }
 
@@ -47,8 +49,11 @@ FieldInfo::~FieldInfo(){
 }
 
 FieldInfo* FieldInfo::clone() {
-	return _CLNEW FieldInfo(name, isIndexed, number, storeTermVector, storePositionWithTermVector,
+	FieldInfo* fi = _CLNEW FieldInfo(name, isIndexed, number, storeTermVector, storePositionWithTermVector,
 		storeOffsetWithTermVector, omitNorms, storePayloads);
+	fi->indexTermGrams = indexTermGrams;
+	fi->impactTiers = impactTiers;
+	return fi;
 }
 
 FieldInfos::FieldInfos():
@@ -89,8 +94,12 @@ void FieldInfos::add(const Document* doc) {
 	Field* field;
   for ( Document::FieldsType::const_iterator itr = fields.begin() ; itr != fields.end() ; itr++ ){
 			field = *itr;
-			add(field->name(), field->isIndexed(), field->isTermVectorStored(), field->isStorePositionWithTermVector(),
+			FieldInfo* fi = add(field->name(), field->isIndexed(), field->isTermVectorStored(), field->isStorePositionWithTermVector(),
               field->isStoreOffsetWithTermVector(), field->getOmitNorms());
+			if (field->getIndexTermGrams())
+				fi->indexTermGrams = true;           // once k-grams, always k-grams
+			if (field->getImpactTiers())
+				fi->impactTiers = true;
 	}
 }
 
@@ -189,6 +198,22 @@ bool FieldInfos::hasVectors() const{
 	return false;
 }
 
+bool FieldInfos::hasTermGrams() const{
+	for (size_t i = 0; i < size(); i++) {
+	   if (fieldInfo(i)->isIndexed && fieldInfo(i)->indexTermGrams)
+	      return true;
+	}
+	return false;
+}
+
+bool FieldInfos::hasImpactTiers() const{
+	for (size_t i = 0; i < size(); i++) {
+	   if (fieldInfo(i)->isIndexed && fieldInfo(i)->impactTiers)
+	      return true;
+	}
+	return false;
+}
+
 void FieldInfos::write(Directory* d, const wchar_t * name) const{
 	IndexOutput* output = d->createOutput(name);
 	try {
@@ -212,6 +237,8 @@ void FieldInfos::write(IndexOutput* output) const{
  		if (fi->storeOffsetWithTermVector) bits |= STORE_OFFSET_WITH_TERMVECTOR;
  		if (fi->omitNorms) bits |= OMIT_NORMS;
 		if (fi->storePayloads) bits |= STORE_PAYLOADS;
+		if (fi->indexTermGrams) bits |= INDEX_TERMGRAMS;
+		if (fi->impactTiers) bits |= IMPACT_TIERS;
 
 	    output->writeString(fi->name,wcslen(fi->name));
 	    output->writeByte(bits);
@@ -232,7 +259,9 @@ void FieldInfos::read(IndexInput* input) {
    		omitNorms = (bits & OMIT_NORMS) != 0;
 		storePayloads = (bits & STORE_PAYLOADS) != 0;
    
-   		addInternal(name, isIndexed, storeTermVector, storePositionsWithTermVector, storeOffsetWithTermVector, omitNorms, storePayloads);
+   		FieldInfo* fi = addInternal(name, isIndexed, storeTermVector, storePositionsWithTermVector, storeOffsetWithTermVector, omitNorms, storePayloads);
+		fi->indexTermGrams = (bits & INDEX_TERMGRAMS) != 0;
+		fi->impactTiers = (bits & IMPACT_TIERS) != 0;
    		_CLDELETE_CARRAY(name);
 	}
 }
@@ -20,6 +20,8 @@
 #include "_FieldsWriter.h"
 #include "_FieldsReader.h"
 #include "CLucene/analysis/AnalysisHeader.h"
+#include "CLucene/util/_LZCompressor.h"
+#include "StoredFieldVisitor.h"
 #include <sstream>
 
 CL_NS_USE(store)
@@ -27,9 +29,55 @@ CL_NS_USE(document)
 CL_NS_USE(util)
 CL_NS_DEF(index)
 
+/** Reads the documents of the decompressed chunk, or of a range of the
+* fields file read ahead, whose file pointers start at <code>base</code> */
+class FieldsReader::ChunkInput: public IndexInput {
+private:
+	const uint8_t* data;
+	int32_t len;
+	int32_t pos;
+	int64_t base;
+public:
+	ChunkInput(): data(NULL), len(0), pos(0), base(0) {}
+	ChunkInput(const ChunkInput& other): IndexInput(other), data(other.data), len(other.len), pos(other.pos), base(other.base) {}
+	virtual ~ChunkInput() {}
+
+	void reset(const uint8_t* _data, const int32_t _length, const int64_t _base = 0){
+		data = _data;
+		len = _length;
+		pos = 0;
+		base = _base;
+	}
+	uint8_t readByte(){
+		if (pos >= len)
+			_CLTHROWA(CL_ERR_IO, "read past EOF");
+		return data[pos++];
+	}
+	void readBytes(uint8_t* b, const int32_t length){
+		memcpy(b, readInPlace(length), length);
+	}
+	/** Skips <code>length</code> bytes and returns where they are in the buffer */
+	const uint8_t* readInPlace(const int32_t length){
+		if (length < 0 || length > len - pos)
+			_CLTHROWA(CL_ERR_IO, "read past EOF");
+		const uint8_t* ret = data + pos;
+		pos += length;
+		return ret;
+	}
+	void close() {}
+	int64_t getFilePointer() const { return base + pos; }
+	void seek(const int64_t p) { pos = (int32_t)(p - base); }
+	int64_t length() const { return base + len; }
+	IndexInput* clone() const { return _CLNEW ChunkInput(*this); }
+	const std::wstring getDirectoryType() const { return L"CHUNK"; }
+	const std::wstring getObjectName() const { return getClassName(); }
+	static const std::wstring getClassName() { return L"FieldsReader::ChunkInput"; }
+};
+
 FieldsReader::FieldsReader(Directory* d, const wchar_t * segment, FieldInfos* fn, int32_t _readBufferSize, int32_t _docStoreOffset, int32_t size):
 	fieldInfos(fn), cloneableFieldsStream(NULL), fieldsStream(NULL), indexStream(NULL),
-        numTotalDocs(0),_size(0), closed(false),docStoreOffset(0)
+        numTotalDocs(0),_size(0), closed(false),docStoreOffset(0),
+	chunked(false), indexHeaderLength(0), chunkPointer(-1), chunkDocBase(0), chunkStream(NULL), docStream(NULL)
 {
 //Func - Constructor
 //Pre  - d contains a valid reference to a Directory
@@ -47,6 +95,14 @@ FieldsReader::FieldsReader(Directory* d, const wchar_t * segment, FieldInfos* fn
 
 		indexStream = d->openInput( Misc::segmentname(segment,L".fdx").c_str(), _readBufferSize );
 
+		// a per document index starts with the pointer 0 of its first document
+		if (indexStream->length() >= 4 && indexStream->readInt() == FieldsWriter::FORMAT_CHUNKS) {
+			chunked = true;
+			indexHeaderLength = 4;
+			chunkStream = _CLNEW ChunkInput();
+		}
+		const int64_t indexLength = indexStream->length() - indexHeaderLength;
+
 		if (_docStoreOffset != -1) {
 			// We read only a slice out of this shared fields file
 			this->docStoreOffset = _docStoreOffset;
@@ -54,16 +110,16 @@ FieldsReader::FieldsReader(Directory* d, const wchar_t * segment, FieldInfos* fn
 
 			// Verify the file is long enough to hold all of our
 			// docs
-			CND_CONDITION(((int32_t) (indexStream->length() / 8)) >= size + this->docStoreOffset,
+			CND_CONDITION(((int32_t) (indexLength / 8)) >= size + this->docStoreOffset,
 				L"the file is not long enough to hold all of our docs");
 		} else {
 			this->docStoreOffset = 0;
-			this->_size = (int32_t) (indexStream->length() >> 3);
+			this->_size = (int32_t) (indexLength >> 3);
 		}
 
 		//_size = (int32_t)indexStream->length()/8;
 
-		numTotalDocs = (int32_t) (indexStream->length() >> 3);
+		numTotalDocs = (int32_t) (indexLength >> 3);
 		success = true;
 	} _CLFINALLY ({
 		// With lock-less commits, it's entirely possible (and
@@ -105,6 +161,8 @@ void FieldsReader::close() {
 			indexStream->close();
 			_CLDELETE(indexStream);
 		}
+		_CLDELETE(chunkStream);
+		docStream = NULL;
 		/*
 		CL_NS(store)::IndexInput* localFieldsStream = fieldsStreamTL.get();
 		if (localFieldsStream != NULL) {
@@ -119,22 +177,229 @@ int32_t FieldsReader::size() const{
 	return _size;
 }
 
+bool FieldsReader::canReadRawDocs() const{
+	return !chunked;
+}
+
+void FieldsReader::readChunk(const int64_t pointer) {
+	chunkPointer = -1;                       // invalid until fully read
+	fieldsStream->seek(pointer);
+	chunkDocBase = fieldsStream->readVInt();
+	const int32_t numDocs = fieldsStream->readVInt();
+	chunkDocOffsets.resize(numDocs);
+	int32_t offset = 0;
+	for (int32_t i = 0; i < numDocs; i++) {
+		chunkDocOffsets[i] = offset;
+		offset += fieldsStream->readVInt();
+	}
+	const uint8_t codec = fieldsStream->readByte();
+	const int32_t length = fieldsStream->readVInt();
+	const int32_t compressedLength = fieldsStream->readVInt();
+	if (length != offset || compressedLength < 0)
+		_CLTHROWA(CL_ERR_CorruptIndex, "Stored fields chunk is corrupt");
+
+	if ((int32_t)compressedData.length < compressedLength)
+		compressedData.resize(compressedLength);
+	fieldsStream->readBytes(compressedData.values, compressedLength);
+	if ((int32_t)chunkData.length < length)
+		chunkData.resize(length);
+
+	if (codec == FieldsWriter::CODEC_LZ) {
+		LZCompressor::decompress(compressedData.values, compressedLength, chunkData.values, length);
+	} else if (codec == FieldsWriter::CODEC_ZLIB) {
+		stringstream out;
+		string err;
+		if (!Misc::inflate(compressedData.values, compressedLength, out, err))
+			_CLTHROWA(CL_ERR_IO, err.c_str());
+		out.read((char*)chunkData.values, length);
+		if (out.gcount() != length)
+			_CLTHROWA(CL_ERR_CorruptIndex, "Stored fields chunk has the wrong length");
+	} else {
+		_CLTHROWA(CL_ERR_CorruptIndex, "Unknown stored fields codec");
+	}
+
+	chunkStream->reset(chunkData.values, length);
+	chunkPointer = pointer;
+}
+
 bool FieldsReader::doc(int32_t n, Document& doc, const CL_NS(document)::FieldSelector* fieldSelector) {
-  if ( (n + docStoreOffset) * 8L > indexStream->length() )
+	if (!seekDocument(n))
+		return false;
+	return readFields(doc, fieldSelector);
+}
+
+bool FieldsReader::seekDocument(const int32_t n) {
+  const int64_t indexPointer = indexHeaderLength + (n + docStoreOffset) * 8L;
+  if ( indexPointer > indexStream->length() )
       return false;
-	indexStream->seek((n + docStoreOffset) * 8L);
+	indexStream->seek(indexPointer);
 	int64_t position = indexStream->readLong();
-	fieldsStream->seek(position);
+	if (chunked) {
+		if (position != chunkPointer)
+			readChunk(position);
+		const int32_t i = n + docStoreOffset - chunkDocBase;
+		if (i < 0 || i >= (int32_t)chunkDocOffsets.size())
+			_CLTHROWA(CL_ERR_CorruptIndex, "Document is not in its stored fields chunk");
+		chunkStream->seek(chunkDocOffsets[i]);
+		docStream = chunkStream;
+	} else {
+		fieldsStream->seek(position);
+		docStream = fieldsStream;
+	}
+	return true;
+}
+
+bool FieldsReader::visitDocument(const int32_t n, StoredFieldVisitor* visitor) {
+	if (!seekDocument(n))
+		return false;
 
-	int32_t numFields = fieldsStream->readVInt();
+	const int32_t numFields = docStream->readVInt();
 	for (int32_t i = 0; i < numFields; i++) {
-		const int32_t fieldNumber = fieldsStream->readVInt();
+		const int32_t fieldNumber = docStream->readVInt();
+		const FieldInfo* fi = fieldInfos->fieldInfo(fieldNumber);
+		if ( fi == NULL ) _CLTHROWA(CL_ERR_IO, "Field stream is invalid");
+
+		const uint8_t bits = docStream->readByte();
+		const bool compressed = (bits & FieldsWriter::FIELD_IS_COMPRESSED) != 0;
+		const bool tokenize = (bits & FieldsWriter::FIELD_IS_TOKENIZED) != 0;
+		const bool binary = (bits & FieldsWriter::FIELD_IS_BINARY) != 0;
+
+		const StoredFieldVisitor::Status status = visitor->needsField(fi->name);
+		if (status != StoredFieldVisitor::YES) {
+			skipField(binary, compressed);
+			if (status == StoredFieldVisitor::STOP)
+				break;
+			continue;
+		}
+
+		int config = compressed ? Field::STORE_COMPRESS : Field::STORE_YES;
+		if (!binary) {
+			config |= getIndexType(fi, tokenize) | getTermVectorType(fi);
+			if (fi->omitNorms)
+				config |= Field::INDEX_NONORMS;
+		}
+
+		const uint8_t* value;
+		int32_t length;
+		if (binary || compressed) {
+			length = docStream->readVInt();
+			value = readFieldBytes(length);
+			if (compressed) {
+				ValueArray<uint8_t> compressedValue;
+				compressedValue.values = const_cast<uint8_t*>(value);
+				compressedValue.length = length;
+				try {
+					uncompress(compressedValue, uncompressedData);
+				} _CLFINALLY( compressedValue.values = NULL; )
+				value = uncompressedData.values;
+				length = (int32_t)uncompressedData.length - 1;   // without the terminator uncompress adds
+			}
+		} else {
+			value = readFieldChars(docStream->readVInt(), length);
+		}
+
+		if (binary)
+			visitor->binaryField(fi->name, config, value, length);
+		else
+			visitor->stringField(fi->name, config, value, length);
+	}
+	return true;
+}
+
+const uint8_t* FieldsReader::readFieldBytes(const int32_t length) {
+	if (docStream == chunkStream)
+		return chunkStream->readInPlace(length);
+	if ((int32_t)fieldData.length < length)
+		fieldData.resize(length);
+	docStream->readBytes(fieldData.values, length);
+	return fieldData.values;
+}
+
+const uint8_t* FieldsReader::readFieldChars(const int32_t numChars, int32_t& length) {
+	// the stored chars are 1 to 3 bytes each, see IndexInput::skipChars
+	if (docStream == chunkStream) {
+		const int64_t start = chunkStream->getFilePointer();
+		chunkStream->skipChars(numChars);
+		length = (int32_t)(chunkStream->getFilePointer() - start);
+		chunkStream->seek(start);
+		return chunkStream->readInPlace(length);
+	}
+
+	length = 0;
+	for (int32_t i = 0; i < numChars; i++) {
+		if ((int32_t)fieldData.length < length + 3)
+			fieldData.resize(length + 3 > 2 * (int32_t)fieldData.length ? length + 3 : 2 * (int32_t)fieldData.length);
+		const uint8_t b = docStream->readByte();
+		fieldData[length++] = b;
+		if ((b & 0x80) != 0) {
+			fieldData[length++] = docStream->readByte();
+			if ((b & 0xE0) == 0xE0)
+				fieldData[length++] = docStream->readByte();
+		}
+	}
+	return fieldData.values;
+}
+
+void FieldsReader::docs(const int32_t* docs, const int32_t count, Document** documents, const FieldSelector* fieldSelector) {
+	if (chunked) {
+		// the chunk cache already decompresses each chunk once
+		for (int32_t i = 0; i < count; i++)
+			doc(docs[i], *documents[i], fieldSelector);
+		return;
+	}
+
+	// where each document starts and ends, in one pass over the index
+	std::vector<int64_t> starts(count), ends(count);
+	for (int32_t i = 0; i < count; i++) {
+		CND_PRECONDITION(i == 0 || docs[i - 1] <= docs[i], L"documents are not sorted");
+		const int32_t n = docs[i] + docStoreOffset;
+		if (docs[i] < 0 || n >= numTotalDocs)
+			_CLTHROWA(CL_ERR_IndexOutOfBounds, "document number out of range");
+		indexStream->seek(n * 8L);
+		starts[i] = indexStream->readLong();
+		ends[i] = n + 1 < numTotalDocs ? indexStream->readLong() : fieldsStream->length();
+	}
+
+	if (chunkStream == NULL)
+		chunkStream = _CLNEW ChunkInput();
+	int32_t i = 0;
+	while (i < count) {
+		// the documents that fit in one read
+		int32_t j = i + 1;
+		while (j < count && ends[j] - starts[i] <= READ_AHEAD_SIZE)
+			j++;
+
+		if (j == i + 1 && ends[i] - starts[i] > READ_AHEAD_SIZE) {
+			fieldsStream->seek(starts[i]);
+			docStream = fieldsStream;
+			readFields(*documents[i], fieldSelector);
+		} else {
+			const int32_t length = (int32_t)(ends[j - 1] - starts[i]);
+			if ((int32_t)chunkData.length < length)
+				chunkData.resize(length);
+			fieldsStream->seek(starts[i]);
+			fieldsStream->readBytes(chunkData.values, length);
+			chunkStream->reset(chunkData.values, length, starts[i]);
+			docStream = chunkStream;
+			for (int32_t k = i; k < j; k++) {
+				chunkStream->seek(starts[k]);
+				readFields(*documents[k], fieldSelector);
+			}
+		}
+		i = j;
+	}
+}
+
+bool FieldsReader::readFields(Document& doc, const FieldSelector* fieldSelector) {
+	int32_t numFields = docStream->readVInt();
+	for (int32_t i = 0; i < numFields; i++) {
+		const int32_t fieldNumber = docStream->readVInt();
 		FieldInfo* fi = fieldInfos->fieldInfo(fieldNumber);
     if ( fi == NULL ) _CLTHROWA(CL_ERR_IO, "Field stream is invalid");
 
 		FieldSelector::FieldSelectorResult acceptField = (fieldSelector == NULL) ?	FieldSelector::LOAD : fieldSelector->accept(fi->name);
 
-		uint8_t bits = fieldsStream->readByte();
+		uint8_t bits = docStream->readByte();
 		CND_CONDITION(bits <= FieldsWriter::FIELD_IS_COMPRESSED + FieldsWriter::FIELD_IS_TOKENIZED + FieldsWriter::FIELD_IS_BINARY,
 			L"invalid field bits");
 
@@ -155,7 +420,13 @@ bool FieldsReader::doc(int32_t n, Document& doc, const CL_NS(document)::FieldSel
 			break;//Get out of this loop
 		}
 		else if (acceptField == FieldSelector::LAZY_LOAD) {
-			addFieldLazy(doc, fi, binary, compressed, tokenize);
+			// a lazy field is read from the file later, but a chunk is only
+			// readable decompressed: load it now. Fields read ahead by docs()
+			// keep their file pointers, so they can still be lazy.
+			if (chunked)
+				addField(doc, fi, binary, compressed, tokenize);
+			else
+				addFieldLazy(doc, fi, binary, compressed, tokenize);
 		}
 		else if (acceptField == FieldSelector::SIZE){
 			skipField(binary, compressed, addFieldSize(doc, fi, binary, compressed));
@@ -171,6 +442,7 @@ bool FieldsReader::doc(int32_t n, Document& doc, const CL_NS(document)::FieldSel
 }
 
 CL_NS(store)::IndexInput* FieldsReader::rawDocs(int32_t* lengths, const int32_t startDocID, const int32_t numDocs) {
+	CND_PRECONDITION(!chunked, L"raw documents of compressed chunks cannot be read");
 	indexStream->seek((docStoreOffset+startDocID) * 8L);
 	int64_t startOffset = indexStream->readLong();
 	int64_t lastOffset = startOffset;
@@ -193,45 +465,45 @@ CL_NS(store)::IndexInput* FieldsReader::rawDocs(int32_t* lengths, const int32_t
 }
 
 void FieldsReader::skipField(const bool binary, const bool compressed) {
-	skipField(binary, compressed, fieldsStream->readVInt());
+	skipField(binary, compressed, docStream->readVInt());
 }
 
 void FieldsReader::skipField(const bool binary, const bool compressed, const int32_t toRead) {
 	if (binary || compressed) {
-		int64_t pointer = fieldsStream->getFilePointer();
-		fieldsStream->seek(pointer + toRead);
+		int64_t pointer = docStream->getFilePointer();
+		docStream->seek(pointer + toRead);
 	} else {
 		//We need to skip chars.  This will slow us down, but still better
-		fieldsStream->skipChars(toRead);
+		docStream->skipChars(toRead);
 	}
 }
 
 void FieldsReader::addFieldLazy(CL_NS(document)::Document& doc, const FieldInfo* fi, const bool binary,
 								const bool compressed, const bool tokenize) {
 	if (binary) {
-		int32_t toRead = fieldsStream->readVInt();
-		int64_t pointer = fieldsStream->getFilePointer();
+		int32_t toRead = docStream->readVInt();
+		int64_t pointer = docStream->getFilePointer();
 		if (compressed) {
 			doc.add(*_CLNEW LazyField(this, fi->name, Field::STORE_COMPRESS, toRead, pointer));
 		} else {
 			doc.add(*_CLNEW LazyField(this, fi->name, Field::STORE_YES, toRead, pointer));
 		}
 		//Need to move the pointer ahead by toRead positions
-		fieldsStream->seek(pointer + toRead);
+		docStream->seek(pointer + toRead);
 	} else {
 		LazyField* f = NULL;
 		if (compressed) {
-			int32_t toRead = fieldsStream->readVInt();
-			int64_t pointer = fieldsStream->getFilePointer();
+			int32_t toRead = docStream->readVInt();
+			int64_t pointer = docStream->getFilePointer();
 			f = _CLNEW LazyField(this, fi->name, Field::STORE_COMPRESS, toRead, pointer);
 			//skip over the part that we aren't loading
-			fieldsStream->seek(pointer + toRead);
+			docStream->seek(pointer + toRead);
 			f->setOmitNorms(fi->omitNorms);
 		} else {
-			int32_t length = fieldsStream->readVInt();
-			int64_t pointer = fieldsStream->getFilePointer();
+			int32_t length = docStream->readVInt();
+			int64_t pointer = docStream->getFilePointer();
 			//Skip ahead of where we are by the length of what is stored
-			fieldsStream->skipChars(length);
+			docStream->skipChars(length);
 			f = _CLNEW LazyField(this, fi->name, Field::STORE_YES | getIndexType(fi, tokenize) | getTermVectorType(fi), length, pointer);
 			f->setOmitNorms(fi->omitNorms);
 		}
@@ -245,13 +517,13 @@ void FieldsReader::addFieldForMerge(CL_NS(document)::Document& doc, const FieldI
 	Field::ValueType v;
 
 	if ( binary || compressed) {
-		int32_t toRead = fieldsStream->readVInt();
-    CL_NS(util)::ValueArray<uint8_t> b(toRead);
-    fieldsStream->readBytes(b.values,toRead);
+		int32_t toRead = docStream->readVInt();
+    CL_NS(util)::ValueArray<uint8_t>* b = _CLNEW CL_NS(util)::ValueArray<uint8_t>(toRead);
+    docStream->readBytes(b->values,toRead);
 		v = Field::VALUE_BINARY;
-    data = b.takeArray();
+    data = b;
 	} else {
-		data = fieldsStream->readString();
+		data = docStream->readString();
 		v = Field::VALUE_STRING;
 	}
 
@@ -262,9 +534,9 @@ void FieldsReader::addField(CL_NS(document)::Document& doc, const FieldInfo* fi,
 
 	//we have a binary stored field, and it may be compressed
 	if (binary) {
-		const int32_t toRead = fieldsStream->readVInt();
+		const int32_t toRead = docStream->readVInt();
     ValueArray<uint8_t>* b = _CLNEW ValueArray<uint8_t>(toRead);
-    fieldsStream->readBytes(b->values,toRead);
+    docStream->readBytes(b->values,toRead);
 		if (compressed) {
 			// we still do not support compressed fields
       ValueArray<uint8_t>* data = _CLNEW ValueArray<uint8_t>;
@@ -282,16 +554,16 @@ void FieldsReader::addField(CL_NS(document)::Document& doc, const FieldInfo* fi,
     }
     //no need to clean up, Field consumes b
 	} else {
-		uint8_t bits = 0;
+		int bits = 0;
 		bits |= getIndexType(fi, tokenize);
 		bits |= getTermVectorType(fi);
 
 		Field* f = NULL;
 		if (compressed) {
       bits |= Field::STORE_COMPRESS;
-      const int32_t toRead = fieldsStream->readVInt();
+      const int32_t toRead = docStream->readVInt();
       ValueArray<uint8_t>* b = _CLNEW ValueArray<uint8_t>(toRead);
-      fieldsStream->readBytes(b->values,toRead);
+      docStream->readBytes(b->values,toRead);
       ValueArray<uint8_t> data;
       try{
         uncompress(*b, data);
@@ -321,7 +593,7 @@ void FieldsReader::addField(CL_NS(document)::Document& doc, const FieldInfo* fi,
       f->setOmitNorms(fi->omitNorms);
 		} else {
 			bits |= Field::STORE_YES;
-      wchar_t* str = fieldsStream->readString();
+      wchar_t* str = docStream->readString();
 			f = _CLNEW Field(fi->name,     // name
 				str, // read value
 				bits, false);
@@ -332,7 +604,7 @@ void FieldsReader::addField(CL_NS(document)::Document& doc, const FieldInfo* fi,
 }
 
 int32_t FieldsReader::addFieldSize(CL_NS(document)::Document& doc, const FieldInfo* fi, const bool binary, const bool compressed) {
-	const int32_t size = fieldsStream->readVInt();
+	const int32_t size = docStream->readVInt();
 	const uint32_t bytesize = binary || compressed ? size : 2*size;
 	ValueArray<uint8_t>* sizebytes = _CLNEW ValueArray<uint8_t>(4);
   sizebytes->values[0] = (uint8_t) (bytesize>>24);
@@ -524,6 +796,7 @@ FieldsReader::FieldForMerge::FieldForMerge(void* _value, ValueType _type, const
 
 	uint32_t bits = STORE_YES;
 
+	this->binary = binary;
 	this->fieldsData = _value;
 	this->valueType = _type;
 
@@ -540,6 +813,9 @@ FieldsReader::FieldForMerge::FieldForMerge(void* _value, ValueType _type, const
 }
 FieldsReader::FieldForMerge::~FieldForMerge(){
 }
+bool FieldsReader::FieldForMerge::isStoredBinary() const{
+  return binary;
+}
 const std::wstring FieldsReader::FieldForMerge::getClassName(){
   return L"FieldsReader::FieldForMerge";
 }
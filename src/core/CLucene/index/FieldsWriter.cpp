@@ -19,6 +19,7 @@
 #include "CLucene/document/Field.h"
 #include "_FieldInfos.h"
 #include "_FieldsReader.h"
+#include "CLucene/util/_LZCompressor.h"
 #include <sstream>
 
 CL_NS_USE(store)
@@ -26,7 +27,41 @@ CL_NS_USE(util)
 CL_NS_USE(document)
 CL_NS_DEF(index)
 
-FieldsWriter::FieldsWriter(Directory* d, const wchar_t * segment, FieldInfos* fn):
+/** Growable in-memory output holding the documents of a chunk */
+class FieldsWriter::ChunkOutput: public IndexOutput {
+private:
+	ValueArray<uint8_t> buffer;
+	int32_t pos;
+	int32_t len;
+public:
+	ChunkOutput(): buffer(FieldsWriter::CHUNK_SIZE + 1024), pos(0), len(0) {}
+	virtual ~ChunkOutput() {}
+
+	void writeByte(const uint8_t b){
+		ensureCapacity(pos + 1);
+		buffer.values[pos++] = b;
+		if (pos > len) len = pos;
+	}
+	void writeBytes(const uint8_t* b, const int32_t length){
+		ensureCapacity(pos + length);
+		memcpy(buffer.values + pos, b, length);
+		pos += length;
+		if (pos > len) len = pos;
+	}
+	void ensureCapacity(const int32_t size){
+		if (size > (int32_t)buffer.length)
+			buffer.resize(cl_max(size, (int32_t)buffer.length * 2));
+	}
+	void close() {}
+	void flush() {}
+	int64_t getFilePointer() const { return pos; }
+	void seek(const int64_t p) { pos = (int32_t)p; }
+	int64_t length() const { return len; }
+	void reset() { pos = len = 0; }
+	const uint8_t* data() const { return buffer.values; }
+};
+
+FieldsWriter::FieldsWriter(Directory* d, const wchar_t * segment, FieldInfos* fn, const uint8_t codec):
 	fieldInfos(fn)
 {
 //Func - Constructor
@@ -45,6 +80,7 @@ FieldsWriter::FieldsWriter(Directory* d, const wchar_t * segment, FieldInfos* fn
 	CND_CONDITION(indexStream != NULL,L"indexStream is NULL");
 
 	doClose = true;
+	init(codec);
 }
 
 FieldsWriter::FieldsWriter(CL_NS(store)::IndexOutput* fdx, CL_NS(store)::IndexOutput* fdt, FieldInfos* fn):
@@ -55,6 +91,21 @@ FieldsWriter::FieldsWriter(CL_NS(store)::IndexOutput* fdx, CL_NS(store)::IndexOu
 	indexStream = fdx;
 	CND_CONDITION(fieldsStream != NULL,L"fieldsStream is NULL");
 	doClose = false;
+	init(CODEC_NONE);
+}
+
+void FieldsWriter::init(const uint8_t codec){
+	chunkCodec = codec;
+	chunkDocBase = 0;
+	docStart = 0;
+	if (codec == CODEC_NONE){
+		chunk = NULL;
+		docStream = fieldsStream;
+	}else{
+		chunk = _CLNEW ChunkOutput();
+		docStream = chunk;
+		indexStream->writeInt(FORMAT_CHUNKS);
+	}
 }
 
 FieldsWriter::~FieldsWriter(){
@@ -63,6 +114,7 @@ FieldsWriter::~FieldsWriter(){
 //Post - Instance has been destroyed
 
 	close();
+	_CLDELETE(chunk);
 }
 
 void FieldsWriter::close() {
@@ -75,6 +127,8 @@ void FieldsWriter::close() {
 
 	//Check if fieldsStream is valid
 	if (fieldsStream){
+		flushChunk();
+
 		//Close fieldsStream
 		fieldsStream->close();
 		_CLDELETE( fieldsStream );
@@ -98,7 +152,7 @@ void FieldsWriter::addDocument(Document* doc) {
 	CND_PRECONDITION(indexStream != NULL,L"indexStream is NULL");
 	CND_PRECONDITION(fieldsStream != NULL,L"fieldsStream is NULL");
 
-	indexStream->writeLong(fieldsStream->getFilePointer());
+	startDocument();
 
 	int32_t storedCount = 0;
   {
@@ -108,7 +162,7 @@ void FieldsWriter::addDocument(Document* doc) {
 		  if (field->isStored())
 			  storedCount++;
 	  }
-	  fieldsStream->writeVInt(storedCount);
+	  docStream->writeVInt(storedCount);
   }
   {
 	  const Document::FieldsType& fields = *doc->getFields();
@@ -119,6 +173,7 @@ void FieldsWriter::addDocument(Document* doc) {
 		  }
 	  }
   }
+  finishDocument();
 }
 
 void FieldsWriter::writeField(FieldInfo* fi, CL_NS(document)::Field* field)
@@ -128,16 +183,16 @@ void FieldsWriter::writeField(FieldInfo* fi, CL_NS(document)::Field* field)
 	// with isCompressed()==true, so we disable compression in that case
 	bool disableCompression = (field->instanceOf(FieldsReader::FieldForMerge::getClassName()));
 
-	fieldsStream->writeVInt(fi->number);
+	docStream->writeVInt(fi->number);
 	uint8_t bits = 0;
 	if (field->isTokenized())
 		bits |= FieldsWriter::FIELD_IS_TOKENIZED;
-	if (field->isBinary())
+	if (disableCompression ? static_cast<FieldsReader::FieldForMerge*>(field)->isStoredBinary() : field->isBinary())
 		bits |= FieldsWriter::FIELD_IS_BINARY;
 	if (field->isCompressed())
 		bits |= FieldsWriter::FIELD_IS_COMPRESSED;
 
-	fieldsStream->writeByte(bits);
+	docStream->writeByte(bits);
 
 	if ( field->isCompressed() ){
     // compression is enabled for the current field
@@ -183,8 +238,8 @@ void FieldsWriter::writeField(FieldInfo* fi, CL_NS(document)::Field* field)
         utfstr.values = NULL;
       }
     }
-    fieldsStream->writeVInt(data->length);
-    fieldsStream->writeBytes(data->values, data->length);
+    docStream->writeVInt(data->length);
+    docStream->writeBytes(data->values, data->length);
 
 	}else{
 
@@ -203,8 +258,8 @@ void FieldsWriter::writeField(FieldInfo* fi, CL_NS(document)::Field* field)
 		// compression is disabled for the current field
 		if (field->isBinary()) {
 			const CL_NS(util)::ValueArray<uint8_t>* data = field->binaryValue();
-      fieldsStream->writeVInt(data->length);
-      fieldsStream->writeBytes(data->values, data->length);
+      docStream->writeVInt(data->length);
+      docStream->writeBytes(data->values, data->length);
 
 		}else if ( field->stringValue() == NULL ){ //we must be using readerValue
 			CND_PRECONDITION(!field->isIndexed(), L"Cannot store reader if it is indexed too")
@@ -222,26 +277,89 @@ void FieldsWriter::writeField(FieldInfo* fi, CL_NS(document)::Field* field)
 			else if ( rl < 0 )
 				rl = 0;
 
-			fieldsStream->writeString( rv, (int32_t)rl);
+			docStream->writeString( rv, (int32_t)rl);
 		}else if ( field->stringValue() != NULL ){
-			fieldsStream->writeString(field->stringValue(),wcslen(field->stringValue()));
+			docStream->writeString(field->stringValue(),wcslen(field->stringValue()));
 		}else
 			_CLTHROWA(CL_ERR_Runtime, "No values are set for the field");
 	}
 }
 
 void FieldsWriter::flushDocument(int32_t numStoredFields, CL_NS(store)::RAMOutputStream* buffer) {
+	startDocument();
+	docStream->writeVInt(numStoredFields);
+	buffer->writeTo(docStream);
+	finishDocument();
+}
+
+void FieldsWriter::startDocument() {
+	// with chunks this is the pointer of the chunk the document goes to
 	indexStream->writeLong(fieldsStream->getFilePointer());
-	fieldsStream->writeVInt(numStoredFields);
-	buffer->writeTo(fieldsStream);
+	if (chunk != NULL)
+		docStart = chunk->getFilePointer();
+}
+
+void FieldsWriter::finishDocument() {
+	if (chunk == NULL)
+		return;
+	chunkDocLengths.push_back((int32_t)(chunk->getFilePointer() - docStart));
+	if (chunk->getFilePointer() >= CHUNK_SIZE)
+		flushChunk();
+}
+
+void FieldsWriter::flushChunk() {
+	const int32_t numChunkDocs = (int32_t)chunkDocLengths.size();
+	if (chunk == NULL || numChunkDocs == 0)
+		return;
+
+	fieldsStream->writeVInt(chunkDocBase);
+	fieldsStream->writeVInt(numChunkDocs);
+	for (int32_t i = 0; i < numChunkDocs; i++)
+		fieldsStream->writeVInt(chunkDocLengths[i]);
+	fieldsStream->writeByte(chunkCodec);
+
+	const int32_t length = (int32_t)chunk->length();
+	fieldsStream->writeVInt(length);
+	if (chunkCodec == CODEC_LZ) {
+		const int32_t compressedLength = LZCompressor::compress(chunk->data(), length, compressed);
+		fieldsStream->writeVInt(compressedLength);
+		fieldsStream->writeBytes(compressed.values, compressedLength);
+	} else {
+		ValueArray<uint8_t> input;
+		input.values = const_cast<uint8_t*>(chunk->data());
+		input.length = length;
+		try {
+			compress(input, compressed);
+		} _CLFINALLY( input.values = NULL; )
+		fieldsStream->writeVInt((int32_t)compressed.length);
+		fieldsStream->writeBytes(compressed.values, (int32_t)compressed.length);
+	}
+
+	chunkDocBase += numChunkDocs;
+	chunkDocLengths.clear();
+	chunk->reset();
 }
 
 void FieldsWriter::flush() {
+  flushChunk();
   indexStream->flush();
   fieldsStream->flush();
 }
 
+int64_t FieldsWriter::indexLength(const int32_t numDocs) const {
+	return (chunk == NULL ? 0 : 4) + numDocs * 8L;
+}
+
 void FieldsWriter::addRawDocuments(CL_NS(store)::IndexInput* stream, const int32_t* lengths, const int32_t numDocs) {
+	if (chunk != NULL) {
+		// raw documents are uncompressed, they are added to the chunk one by one
+		for(int32_t i=0;i<numDocs;i++) {
+			startDocument();
+			chunk->copyBytes(stream, lengths[i]);
+			finishDocument();
+		}
+		return;
+	}
 	int64_t position = fieldsStream->getFilePointer();
 	const int64_t start = position;
 	for(int32_t i=0;i<numDocs;i++) {
@@ -0,0 +1,190 @@
+/*------------------------------------------------------------------------------
+* Copyright (C) 2003-2006 Ben van Klinken and the CLucene Team
+
+* Updated by https://github.com/farfella/.
+*
+* Distributable under the terms of either the Apache License (Version 2.0) or
+* the GNU Lesser General Public License, as specified in the COPYING file.
+------------------------------------------------------------------------------*/
+#include "CLucene/_ApiHeader.h"
+#include "CLucene/store/Directory.h"
+#include "CLucene/store/IndexInput.h"
+#include "CLucene/store/IndexOutput.h"
+#include "CLucene/search/Similarity.h"
+#include "_IndexFileNames.h"
+#include "_ImpactTiers.h"
+#include <algorithm>
+
+CL_NS_USE(util)
+CL_NS_USE(store)
+CL_NS_USE(search)
+CL_NS_DEF(index)
+
+	int32_t ImpactTier::nextDoc(int32_t target, int32_t& pos) const{
+		if (pos > 0 && docs[pos - 1] >= target)
+			pos = 0;                                   // the targets went back
+		std::vector<int32_t>::const_iterator itr = std::lower_bound(docs.begin() + pos, docs.end(), target);
+		pos = static_cast<int32_t>(itr - docs.begin());
+		return itr == docs.end() ? LUCENE_INT32_MAX_SHOULDBE : *itr;
+	}
+
+
+	/** Orders postings by falling impact, and then by document */
+	class ImpactTierWriter::ImpactGreater{
+		const std::vector<Posting>& postings;
+		const std::vector<float_t>& impacts;
+	public:
+		ImpactGreater(const std::vector<Posting>& _postings, const std::vector<float_t>& _impacts):
+			postings(_postings), impacts(_impacts){}
+		bool operator()(const int32_t a, const int32_t b) const{
+			if (impacts[a] != impacts[b])
+				return impacts[a] > impacts[b];
+			return postings[a].doc < postings[b].doc;
+		}
+	};
+
+	ImpactTierWriter::ImpactTierWriter(Directory* directory, const wchar_t* segment, int32_t _tierSize):
+		tierSize(_tierSize),
+		termCount(0)
+	{
+		CND_PRECONDITION(segment != NULL, L"segment is NULL");
+
+		output = directory->createOutput( (std::wstring(segment) + L"." + IndexFileNames::IMPACT_TIERS_EXTENSION).c_str() );
+		output->writeInt(FORMAT);
+		output->writeInt(0);                           // leave space for the term count
+	}
+
+	ImpactTierWriter::~ImpactTierWriter(){
+		close();
+	}
+
+	bool ImpactTierWriter::wants(int32_t docFreq) const{
+		return docFreq > MIN_DOC_FREQ_RATIO * tierSize;
+	}
+
+	void ImpactTierWriter::add(int32_t fieldNumber, const wchar_t* termText, const std::vector<Posting>& postings){
+		const int32_t df = static_cast<int32_t>(postings.size());
+		if (!wants(df))
+			return;
+
+		// the tier is the postings that the default scoring weighs the most
+		Similarity* similarity = Similarity::getDefault();
+		impacts.resize(df);
+		order.resize(df);
+		for (int32_t i = 0; i < df; i++){
+			impacts[i] = similarity->tf(postings[i].freq) * Similarity::decodeNorm(postings[i].norm);
+			order[i] = i;
+		}
+		std::nth_element(order.begin(), order.begin() + tierSize, order.end(), ImpactGreater(postings, impacts));
+
+		std::vector<int32_t> docs(tierSize);
+		for (int32_t i = 0; i < tierSize; i++)
+			docs[i] = postings[order[i]].doc;
+		std::sort(docs.begin(), docs.end());
+
+		// the other postings that no other one beats in both frequency and norm
+		std::vector<std::pair<uint8_t, int32_t> > rest(df - tierSize);
+		for (int32_t i = tierSize; i < df; i++)
+			rest[i - tierSize] = std::make_pair(postings[order[i]].norm, postings[order[i]].freq);
+		std::sort(rest.begin(), rest.end());
+		std::vector<std::pair<uint8_t, int32_t> > bounds;
+		for (size_t i = rest.size(); i-- > 0; ){          // by falling norm
+			if (bounds.empty() || rest[i].second > bounds.back().second)
+				bounds.push_back(rest[i]);
+		}
+
+		output->writeVInt(fieldNumber);
+		output->writeString(termText, static_cast<int32_t>(wcslen(termText)));
+		output->writeVInt(tierSize);
+		int32_t lastDoc = 0;
+		for (int32_t i = 0; i < tierSize; i++){
+			output->writeVInt(docs[i] - lastDoc);
+			lastDoc = docs[i];
+		}
+		output->writeVInt(static_cast<int32_t>(bounds.size()));
+		for (size_t i = 0; i < bounds.size(); i++){
+			output->writeVInt(bounds[i].second);
+			output->writeByte(bounds[i].first);
+		}
+		termCount++;
+	}
+
+	void ImpactTierWriter::close(){
+		if (output){
+			output->seek(4);                           // write term count after format
+			output->writeInt(termCount);
+			output->close();
+			_CLDELETE(output);
+		}
+	}
+
+
+	ImpactTierReader::ImpactTierReader(Directory* directory, const wchar_t* segment, int32_t readBufferSize)
+	{
+		CND_PRECONDITION(segment != NULL, L"segment is NULL");
+		input = directory->openInput( (std::wstring(segment) + L"." + IndexFileNames::IMPACT_TIERS_EXTENSION).c_str(), readBufferSize );
+	}
+
+	ImpactTierReader::~ImpactTierReader(){
+		close();
+		for (TiersType::iterator itr = tiers.begin(); itr != tiers.end(); ++itr)
+			_CLDELETE(itr->second);
+	}
+
+	void ImpactTierReader::close(){
+		if (input != NULL){
+			input->close();
+			_CLDELETE(input);
+		}
+	}
+
+	void ImpactTierReader::load(){
+		TiersType loaded;
+		try{
+			const int32_t format = input->readInt();
+			if (format != ImpactTierWriter::FORMAT)
+				_CLTHROWA(CL_ERR_CorruptIndex, "Unknown format version of the impact tiers");
+			const int32_t termCount = input->readInt();
+
+			for (int32_t i = 0; i < termCount; i++){
+				const int32_t fieldNumber = input->readVInt();
+				wchar_t* text = input->readString();
+				ImpactTier* tier = _CLNEW ImpactTier;
+				loaded[std::make_pair(fieldNumber, std::wstring(text))] = tier;
+				_CLDELETE_CARRAY(text);
+
+				const int32_t docCount = input->readVInt();
+				tier->docs.resize(docCount);
+				int32_t doc = 0;
+				for (int32_t j = 0; j < docCount; j++){
+					doc += input->readVInt();
+					tier->docs[j] = doc;
+				}
+
+				const int32_t boundCount = input->readVInt();
+				tier->freqs.resize(boundCount);
+				tier->norms.resize(boundCount);
+				for (int32_t j = 0; j < boundCount; j++){
+					tier->freqs[j] = input->readVInt();
+					tier->norms[j] = input->readByte();
+				}
+			}
+		}catch(...){
+			for (TiersType::iterator itr = loaded.begin(); itr != loaded.end(); ++itr)
+				_CLDELETE(itr->second);
+			close();
+			throw;
+		}
+		tiers.swap(loaded);
+		close();
+	}
+
+	const ImpactTier* ImpactTierReader::get(int32_t fieldNumber, const wchar_t* termText){
+		SCOPED_LOCK_MUTEX(THIS_LOCK)
+		if (input != NULL)
+			load();
+		TiersType::const_iterator itr = tiers.find(std::make_pair(fieldNumber, std::wstring(termText)));
+		return itr == tiers.end() ? NULL : itr->second;
+	}
+
+CL_NS_END
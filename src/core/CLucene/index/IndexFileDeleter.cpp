@@ -438,14 +438,13 @@ void IndexFileDeleter::checkpoint(SegmentInfos* segmentInfos, bool isCommit)
 
     // Incref the files:
     incRef(segmentInfos, isCommit);
-    const std::vector<std::wstring>* docWriterFiles = NULL;
+    // Copy the list: indexing threads may open a new doc store
+    // (and discard docWriter's list) while we checkpoint
+    std::vector<std::wstring> docWriterFiles;
     if (docWriter != NULL)
     {
-        docWriterFiles = &docWriter->files();
-        if (!docWriterFiles->empty())
-            incRef(*docWriterFiles);
-        else
-            docWriterFiles = NULL;
+        docWriter->copyFiles(docWriterFiles);
+        incRef(docWriterFiles);
     }
 
     if (isCommit)
@@ -483,8 +482,7 @@ void IndexFileDeleter::checkpoint(SegmentInfos* segmentInfos, bool isCommit)
             }
         }
     }
-    if (docWriterFiles != NULL)
-        lastFiles.insert(lastFiles.end(), docWriterFiles->begin(), docWriterFiles->end());
+    lastFiles.insert(lastFiles.end(), docWriterFiles.begin(), docWriterFiles.end());
 }
 
 void IndexFileDeleter::incRef(SegmentInfos* segmentInfos, bool isCommit)
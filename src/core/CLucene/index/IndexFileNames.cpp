@@ -23,6 +23,8 @@ CL_NS_DEF(index)
 	const wchar_t* IndexFileNames::PROX_EXTENSION = L"prx";
 	const wchar_t* IndexFileNames::TERMS_EXTENSION = L"tis";
 	const wchar_t* IndexFileNames::TERMS_INDEX_EXTENSION = L"tii";
+	const wchar_t* IndexFileNames::TERM_GRAMS_EXTENSION = L"tgi";
+	const wchar_t* IndexFileNames::IMPACT_TIERS_EXTENSION = L"imp";
 	const wchar_t* IndexFileNames::FIELDS_INDEX_EXTENSION = L"fdx";
 	const wchar_t* IndexFileNames::FIELDS_EXTENSION = L"fdt";
 	const wchar_t* IndexFileNames::VECTORS_FIELDS_EXTENSION = L"tvf";
@@ -52,14 +54,16 @@ CL_NS_DEF(index)
 			IndexFileNames::VECTORS_FIELDS_EXTENSION,
 			IndexFileNames::GEN_EXTENSION,
 			IndexFileNames::NORMS_EXTENSION,
-			IndexFileNames::COMPOUND_FILE_STORE_EXTENSION
+			IndexFileNames::COMPOUND_FILE_STORE_EXTENSION,
+			IndexFileNames::TERM_GRAMS_EXTENSION,
+			IndexFileNames::IMPACT_TIERS_EXTENSION
 		};
   
 	CL_NS(util)::ConstValueArray<const wchar_t*> IndexFileNames::_INDEX_EXTENSIONS;
   CL_NS(util)::ConstValueArray<const wchar_t*>& IndexFileNames::INDEX_EXTENSIONS(){
     if ( _INDEX_EXTENSIONS.length == 0 ){
       _INDEX_EXTENSIONS.values = IndexFileNames_INDEX_EXTENSIONS_s;
-      _INDEX_EXTENSIONS.length = 15;
+      _INDEX_EXTENSIONS.length = 17;
     }
     return _INDEX_EXTENSIONS;
   }
@@ -75,13 +79,15 @@ CL_NS_DEF(index)
 		IndexFileNames::VECTORS_INDEX_EXTENSION,
 		IndexFileNames::VECTORS_DOCUMENTS_EXTENSION,
 		IndexFileNames::VECTORS_FIELDS_EXTENSION,
-		IndexFileNames::NORMS_EXTENSION
+		IndexFileNames::NORMS_EXTENSION,
+		IndexFileNames::TERM_GRAMS_EXTENSION,
+		IndexFileNames::IMPACT_TIERS_EXTENSION
 	};
 	CL_NS(util)::ConstValueArray<const wchar_t*> IndexFileNames::_INDEX_EXTENSIONS_IN_COMPOUND_FILE;
   CL_NS(util)::ConstValueArray<const wchar_t*>& IndexFileNames::INDEX_EXTENSIONS_IN_COMPOUND_FILE(){
     if ( _INDEX_EXTENSIONS_IN_COMPOUND_FILE.length == 0 ){
       _INDEX_EXTENSIONS_IN_COMPOUND_FILE.values = IndexFileNames_INDEX_EXTENSIONS_IN_COMPOUND_FILE_s;
-      _INDEX_EXTENSIONS_IN_COMPOUND_FILE.length = 11;
+      _INDEX_EXTENSIONS_IN_COMPOUND_FILE.length = 13;
     }
     return _INDEX_EXTENSIONS_IN_COMPOUND_FILE;
   }
@@ -108,13 +114,15 @@ CL_NS_DEF(index)
 		IndexFileNames::PROX_EXTENSION,
 		IndexFileNames::TERMS_EXTENSION,
 		IndexFileNames::TERMS_INDEX_EXTENSION,
-		IndexFileNames::NORMS_EXTENSION
+		IndexFileNames::NORMS_EXTENSION,
+		IndexFileNames::TERM_GRAMS_EXTENSION,
+		IndexFileNames::IMPACT_TIERS_EXTENSION
 	};
 	CL_NS(util)::ConstValueArray<const wchar_t*> IndexFileNames::_NON_STORE_INDEX_EXTENSIONS;
   CL_NS(util)::ConstValueArray<const wchar_t*>& IndexFileNames::NON_STORE_INDEX_EXTENSIONS(){
     if ( _NON_STORE_INDEX_EXTENSIONS.length == 0 ){
       _NON_STORE_INDEX_EXTENSIONS.values = IndexFileNames_NON_STORE_INDEX_EXTENSIONS_s;
-      _NON_STORE_INDEX_EXTENSIONS.length = 6;
+      _NON_STORE_INDEX_EXTENSIONS.length = 8;
     }
     return _NON_STORE_INDEX_EXTENSIONS;
   }
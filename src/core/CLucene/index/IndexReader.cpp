@@ -20,7 +20,9 @@
 #include "_SegmentHeader.h"
 #include "MultiReader.h"
 #include "Terms.h"
+#include "StoredFieldVisitor.h"
 #include <assert.h>
+#include <algorithm>
 
 CL_NS_USE(util)
 CL_NS_USE(store)
@@ -62,6 +64,9 @@ CL_NS_DEF(index)
       CloseCallbackCompare,
       CloseCallbackCompare> CloseCallbackMap;
     CloseCallbackMap closeCallbacks;
+    //guards closeCallbacks, which caches fill from any searching thread.
+    //Not THIS_LOCK: close() holds that while the callbacks take their cache's lock
+    DEFINE_MUTEX(closeCallbacks_LOCK)
 
     Internal(Directory* directory, IndexReader* _this)
     {
@@ -191,6 +196,18 @@ CL_NS_DEF(index)
     _CLTHROWA(CL_ERR_UnsupportedOperation, "This reader does not support this method.");
   }
 
+  void IndexReader::setSkipListCache(const size_t /*maxBytes*/, const int32_t /*minDocFreq*/) {
+    _CLTHROWA(CL_ERR_UnsupportedOperation, "This reader does not support this method.");
+  }
+
+  size_t IndexReader::getSkipListCacheSize() {
+    _CLTHROWA(CL_ERR_UnsupportedOperation, "This reader does not support this method.");
+  }
+
+  int32_t IndexReader::getSkipListCacheMinDocFreq() {
+    _CLTHROWA(CL_ERR_UnsupportedOperation, "This reader does not support this method.");
+  }
+
   bool IndexReader::isCurrent() {
     _CLTHROWA(CL_ERR_UnsupportedOperation, "This reader does not support this method.");
   }
@@ -198,6 +215,14 @@ CL_NS_DEF(index)
     _CLTHROWA(CL_ERR_UnsupportedOperation, "This reader does not support this method.");
   }
 
+  const ArrayBase<IndexReader*>* IndexReader::getSubReaders() const {
+    return NULL;
+  }
+
+  const wchar_t* IndexReader::getIndexSort() const {
+    return NULL;
+  }
+
   uint64_t IndexReader::lastModified(Directory* directory2) {
   //Func - Static method
   //       Returns the time the index in this directory was last modified.
@@ -302,6 +327,70 @@ CL_NS_DEF(index)
     return document(n, doc, NULL);
   }
 
+  void IndexReader::documents(const int32_t* docs, const int32_t count, CL_NS(document)::Document** result, const CL_NS(document)::FieldSelector* fieldSelector){
+    ensureOpen();
+    std::vector<int32_t> sortedDocs;
+    std::vector<CL_NS(document)::Document*> sortedResult;
+    sortDocuments(docs, count, result, sortedDocs, sortedResult);
+    for (int32_t i = 0; i < count; i++)
+      document(sortedDocs[i], *sortedResult[i], fieldSelector);
+  }
+
+  void IndexReader::visitDocument(const int32_t n, StoredFieldVisitor* visitor){
+    ensureOpen();
+    CL_NS(document)::Document doc;
+    document(n, doc, NULL);
+
+    const CL_NS(document)::Document::FieldsType* fields = doc.getFields();
+    for (CL_NS(document)::Document::FieldsType::const_iterator it = fields->begin(); it != fields->end(); ++it) {
+      CL_NS(document)::Field* f = *it;
+      const StoredFieldVisitor::Status status = visitor->needsField(f->name());
+      if (status == StoredFieldVisitor::STOP)
+        break;
+      if (status == StoredFieldVisitor::NO)
+        continue;
+
+      int config = f->isCompressed() ? CL_NS(document)::Field::STORE_COMPRESS : CL_NS(document)::Field::STORE_YES;
+      if (f->isBinary()) {
+        const ValueArray<uint8_t>* value = f->binaryValue();
+        visitor->binaryField(f->name(), config, value->values, (int32_t)value->length);
+        continue;
+      }
+      if (f->isTokenized())
+        config |= CL_NS(document)::Field::INDEX_TOKENIZED;
+      else if (f->isIndexed())
+        config |= CL_NS(document)::Field::INDEX_UNTOKENIZED;
+      else
+        config |= CL_NS(document)::Field::INDEX_NO;
+      if (f->isTermVectorStored())
+        config |= CL_NS(document)::Field::TERMVECTOR_YES;
+      if (f->isStorePositionWithTermVector())
+        config |= CL_NS(document)::Field::TERMVECTOR_WITH_POSITIONS;
+      if (f->isStoreOffsetWithTermVector())
+        config |= CL_NS(document)::Field::TERMVECTOR_WITH_OFFSETS;
+      if (f->getOmitNorms())
+        config |= CL_NS(document)::Field::INDEX_NONORMS;
+
+      const std::string value = lucene_wcstoutf8string(f->stringValue(), wcslen(f->stringValue()));
+      visitor->stringField(f->name(), config, (const uint8_t*)value.c_str(), (int32_t)value.length());
+    }
+  }
+
+  void IndexReader::sortDocuments(const int32_t* docs, const int32_t count, CL_NS(document)::Document** result,
+      std::vector<int32_t>& sortedDocs, std::vector<CL_NS(document)::Document*>& sortedResult){
+    std::vector< std::pair<int32_t, int32_t> > order(count);
+    for (int32_t i = 0; i < count; i++)
+      order[i] = std::make_pair(docs[i], i);
+    std::sort(order.begin(), order.end());
+
+    sortedDocs.resize(count);
+    sortedResult.resize(count);
+    for (int32_t i = 0; i < count; i++) {
+      sortedDocs[i] = order[i].first;
+      sortedResult[i] = result[order[i].second];
+    }
+  }
+
   void IndexReader::deleteDoc(const int32_t docNum){
     deleteDocument(docNum);
   }
@@ -403,11 +492,15 @@ CL_NS_DEF(index)
   //       saved to disk
     SCOPED_LOCK_MUTEX(THIS_LOCK)
     if ( !closed ){
-      Internal::CloseCallbackMap::iterator iter = _internal->closeCallbacks.begin();
-      for ( ;iter!=_internal->closeCallbacks.end();iter++){
-        CloseCallback callback = *iter->first;
-        callback(this,iter->second);
+      std::vector< std::pair<CloseCallback, void*> > callbacks;
+      {
+        SCOPED_LOCK_MUTEX(_internal->closeCallbacks_LOCK)
+        Internal::CloseCallbackMap::iterator iter = _internal->closeCallbacks.begin();
+        for ( ;iter!=_internal->closeCallbacks.end();iter++)
+          callbacks.push_back(std::make_pair(iter->first, iter->second));
       }
+      for ( size_t i=0;i<callbacks.size();i++ )
+        callbacks[i].first(this,callbacks[i].second);
       commit();
       doClose();
     }
@@ -451,6 +544,15 @@ bool IndexReader::hasNorms(const wchar_t* field) {
 	return norms(field) != NULL;
 }
 
+bool IndexReader::getTermGramCandidates(const wchar_t* /*field*/, const std::vector<std::wstring>& /*substrings*/,
+	std::vector<std::wstring>& /*candidates*/) {
+	return false;
+}
+
+const ImpactTier* IndexReader::getImpactTier(const Term* /*t*/) {
+	return NULL;
+}
+
 void IndexReader::unlock(const wchar_t * path){
 	FSDirectory* dir = FSDirectory::getDirectory(path);
 	unlock(dir);
@@ -529,6 +631,7 @@ CL_NS(store)::Directory* IndexReader::getDirectory() {
 }
 
 	void IndexReader::addCloseCallback(CloseCallback callback, void* parameter){
+		SCOPED_LOCK_MUTEX(_internal->closeCallbacks_LOCK)
 		_internal->closeCallbacks.put(callback, parameter);
 	}
 
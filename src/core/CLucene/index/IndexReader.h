@@ -10,14 +10,17 @@
 #define _lucene_index_IndexReader_
 
 
+#include "CLucene/clucene-config.h"
 #include "CLucene/util/Array.h"
 #include "CLucene/util/VoidList.h"
 #include "CLucene/LuceneThreads.h"
+#include <vector>
 
 CL_CLASS_DEF(store,Directory)
 CL_CLASS_DEF(store,LuceneLock)
 CL_CLASS_DEF(document,Document)
 CL_CLASS_DEF(document,FieldSelector)
+CL_CLASS_DEF(index,StoredFieldVisitor)
 
 CL_NS_DEF(index)
 class SegmentInfos;
@@ -28,6 +31,7 @@ class TermDocs;
 class TermPositions;
 class IndexDeletionPolicy;
 class TermVectorMapper;
+class ImpactTier;
 
 /** IndexReader is an abstract class, providing an interface for accessing an
  index.  Search of an index is done entirely through this abstract interface,
@@ -100,6 +104,11 @@ protected:
    *  index modifications must implement this method. */
   virtual void acquireWriteLock();
 
+  /** Sorts a batch of documents() by document number, keeping each
+  * document with its result. */
+  static void sortDocuments(const int32_t* docs, const int32_t count, CL_NS(document)::Document** result,
+    std::vector<int32_t>& sortedDocs, std::vector<CL_NS(document)::Document*>& sortedResult);
+
 public:
 	//Callback for classes that need to know if IndexReader is closing.
 	typedef void (*CloseCallback)(IndexReader*, void*);
@@ -373,6 +382,33 @@ public:
    *  @see #setTermInfosIndexDivisor */
   int32_t getTermInfosIndexDivisor();
 
+  /** The default minimum number of documents of the terms whose skip
+   *  lists {@link #setSkipListCache} keeps in memory. */
+  LUCENE_STATIC_CONSTANT(int32_t, DEFAULT_SKIP_LIST_CACHE_MIN_DOCFREQ = 4096);
+
+  /** Expert: for IndexReader implementations that read segments, keeps
+   *  the decoded skip lists of the terms in at least <code>minDocFreq</code>
+   *  documents in memory, up to about <code>maxBytes</code> per segment,
+   *  shared by all the {@link TermDocs} and {@link TermPositions} of the
+   *  segment. {@link TermDocs#skipTo} then finds its entry by binary search
+   *  instead of reading the skip data from the postings again after each
+   *  seek, which pays off when conjunctions skip through the same common
+   *  terms query after query. A size of 0, the default, caches nothing.
+   *  The setting is kept by the readers {@link #reopen} returns.
+   *
+   *  <b>NOTE:</b> call this before searching with the reader.
+   */
+  virtual void setSkipListCache(const size_t maxBytes, const int32_t minDocFreq = DEFAULT_SKIP_LIST_CACHE_MIN_DOCFREQ);
+
+  /** Expert: returns the size of the skip list cache of each segment.
+   *  @see #setSkipListCache */
+  virtual size_t getSkipListCacheSize();
+
+  /** Expert: returns the minimum number of documents of the terms whose
+   *  skip lists are cached.
+   *  @see #setSkipListCache */
+  virtual int32_t getSkipListCacheMinDocFreq();
+
   /**
    * Check whether this IndexReader is still using the
    * current (i.e., most recently committed) version of the
@@ -401,6 +437,22 @@ public:
    */
   virtual bool isOptimized();
 
+  /**
+   * Expert: returns the sequential sub readers this reader is made of, in
+   * document order, or NULL if it is not made of sub readers. The documents
+   * of each sub reader are numbered after those of the readers before it.
+   * IndexSearcher uses this to score each segment on its own, with the
+   * segment's norms, rather than through norms copied for the whole index.
+   */
+  virtual const CL_NS(util)::ArrayBase<IndexReader*>* getSubReaders() const;
+
+  /**
+   * Expert: returns the index sort that the documents of this reader are
+   * in, as IndexWriter#setIndexSort recorded it, or NULL if they are not
+   * known to be sorted. Only the readers of single segments are.
+   */
+  virtual const wchar_t* getIndexSort() const;
+
   /**
    *  Return an array of term frequency vectors for the specified document.
    *  The array contains a vector for each vectorized field in the document.
@@ -512,6 +564,33 @@ public:
   */
   bool document(int32_t n, CL_NS(document)::Document& doc);
 
+  /**
+   * Gets the stored fields of a batch of documents, such as a page of
+   * search results: the fields of <code>docs[i]</code> are loaded into
+   * <code>result[i]</code>. The documents are read in document order
+   * whatever the order of <code>docs</code>, so a page costs one pass over
+   * the stored fields instead of a seek per document.
+   * The fields are not cleared before retrieving the documents.
+   *
+   * @param fieldSelector used for every document, may be null to load all fields
+   * @throws CorruptIndexException if the index is corrupt
+   * @throws IOException if there is a low-level IO error
+   * @see #document(int32_t, Document&, const FieldSelector*)
+   */
+  virtual void documents(const int32_t* docs, const int32_t count, CL_NS(document)::Document** result,
+    const CL_NS(document)::FieldSelector* fieldSelector = NULL);
+
+  /**
+   * Expert: passes the stored fields of the <code>n</code><sup>th</sup>
+   * document to <code>visitor</code> without building a Document, see
+   * {@link StoredFieldVisitor}. Readers over segments pass the stored
+   * bytes directly; this default loads the document and converts it.
+   *
+   * @throws CorruptIndexException if the index is corrupt
+   * @throws IOException if there is a low-level IO error
+   */
+  virtual void visitDocument(const int32_t n, StoredFieldVisitor* visitor);
+
 	_CL_DEPRECATED( document(i, Document&) ) bool document(int32_t n, CL_NS(document)::Document*);
 
 	_CL_DEPRECATED( document(i, document) ) CL_NS(document)::Document* document(const int32_t n);
@@ -546,6 +625,26 @@ public:
 	*/
 	virtual TermEnum* terms(const Term* t) = 0;
 
+  /** Expert: appends to <code>candidates</code> the terms of <code>field</code>
+  * that contain every k-gram of each of <code>substrings</code>, using the
+  * k-gram term index written for fields indexed with
+  * {@link Field#INDEX_TERMGRAMS}. The candidates are a superset of the terms
+  * containing all the substrings, so they must still be checked; they may
+  * contain duplicates and are only sorted within each segment.
+  * Returns false if the index cannot narrow the terms down (some segment
+  * was written without it, or no substring is long enough), in which case
+  * the caller has to enumerate the terms of the field itself.
+  */
+	virtual bool getTermGramCandidates(const wchar_t* field, const std::vector<std::wstring>& substrings,
+		std::vector<std::wstring>& candidates);
+
+  /** Expert: returns the impact tier of <code>t</code>, written when segments
+  * are merged for fields indexed with {@link Field#INDEX_IMPACTTIERS}, or NULL
+  * if the term has none or the norms of its field have changed since. The
+  * tier belongs to the reader. Only single segments have tiers.
+  */
+	virtual const ImpactTier* getImpactTier(const Term* t);
+
   /** Returns the number of documents containing the term <code>t</code>.
    * @throws IOException if there is a low-level IO error
    */
@@ -674,7 +773,7 @@ public:
 
 	/**
 	* For classes that need to know when the IndexReader closes (such as caches, etc),
-	* should pass their callback function to this.
+	* should pass their callback function to this. Thread safe.
 	*/
 	void addCloseCallback(CloseCallback callback, void* parameter);
 
@@ -0,0 +1,202 @@
+/*------------------------------------------------------------------------------
+* Copyright (C) 2003-2006 Ben van Klinken and the CLucene Team
+
+* Updated by https://github.com/farfella/.
+*
+* Distributable under the terms of either the Apache License (Version 2.0) or
+* the GNU Lesser General Public License, as specified in the COPYING file.
+------------------------------------------------------------------------------*/
+#include "CLucene/_ApiHeader.h"
+#include "_IndexSorter.h"
+#include "IndexReader.h"
+#include "CLucene/search/Sort.h"
+#include "CLucene/search/FieldCache.h"
+#include <algorithm>
+
+CL_NS_USE(search)
+CL_NS_USE(util)
+CL_NS_DEF(index)
+
+namespace {
+	/** The values of one sort key in each of the segments being merged */
+	struct KeyValues{
+		int32_t type;
+		bool reverse;
+		std::vector<const int32_t*> ints;
+		std::vector<const float_t*> floats;
+		std::vector<const FieldCache::StringIndex*> strings;
+	};
+
+	/** A document of one of the segments being merged */
+	struct MergedDoc{
+		int32_t reader;
+		int32_t doc;
+	};
+
+	/** Orders documents by the sort keys */
+	class MergedDocLess{
+		const std::vector<KeyValues>* keys;
+
+		static int32_t compare(const KeyValues& key, const MergedDoc& a, const MergedDoc& b){
+			switch (key.type) {
+			case SortField::INT: {
+				const int32_t va = key.ints[a.reader][a.doc];
+				const int32_t vb = key.ints[b.reader][b.doc];
+				return va < vb ? -1 : (va > vb ? 1 : 0);
+			}
+			case SortField::FLOAT: {
+				const float_t va = key.floats[a.reader][a.doc];
+				const float_t vb = key.floats[b.reader][b.doc];
+				return va < vb ? -1 : (va > vb ? 1 : 0);
+			}
+			default: {
+				const FieldCache::StringIndex* sa = key.strings[a.reader];
+				const FieldCache::StringIndex* sb = key.strings[b.reader];
+				if (sa == sb) {
+					const int32_t oa = sa->order[a.doc];
+					const int32_t ob = sa->order[b.doc];
+					return oa < ob ? -1 : (oa > ob ? 1 : 0);
+				}
+				const wchar_t* va = sa->lookup[sa->order[a.doc]];
+				const wchar_t* vb = sb->lookup[sb->order[b.doc]];
+				if (va == NULL || vb == NULL)           // documents without a value sort first
+					return va == vb ? 0 : (va == NULL ? -1 : 1);
+				return wcscmp(va, vb);
+			}
+			}
+		}
+	public:
+		MergedDocLess(const std::vector<KeyValues>& _keys): keys(&_keys){}
+
+		bool operator()(const MergedDoc& a, const MergedDoc& b) const{
+			for (size_t i = 0; i < keys->size(); i++) {
+				const KeyValues& key = (*keys)[i];
+				const int32_t c = compare(key, a, b);
+				if (c != 0)
+					return key.reverse ? c > 0 : c < 0;
+			}
+			return false;
+		}
+	};
+}
+
+IndexSorter::IndexSorter(const Sort* sort){
+	SortField** fields = sort->getSort();
+	int32_t count = 0;
+	while (fields[count] != NULL)
+		count++;
+	// a sort ends with the tie break by document number, which the merge keeps anyway
+	if (count > 0 && fields[count-1]->getType() == SortField::DOC && !fields[count-1]->getReverse())
+		count--;
+	if (count == 0)
+		_CLTHROWA(CL_ERR_IllegalArgument, "The index sort has no fields");
+
+	for (int32_t i = 0; i < count; i++) {
+		const int32_t type = fields[i]->getType();
+		if (type != SortField::INT && type != SortField::FLOAT && type != SortField::STRING)
+			_CLTHROWA(CL_ERR_IllegalArgument, "The fields of an index sort must be INT, FLOAT or STRING fields");
+		Key key;
+		key.field = fields[i]->getField();
+		key.type = type;
+		key.reverse = fields[i]->getReverse();
+		keys.push_back(key);
+	}
+	description = describe(fields, count);
+}
+
+IndexSorter::~IndexSorter(){
+}
+
+int32_t IndexSorter::sort(IndexReader** readers, const int32_t numReaders,
+	std::vector<int32_t*>& docMaps, ValueArray<int32_t>& sortedDocs) const{
+	std::vector<KeyValues> values(keys.size());
+	for (size_t i = 0; i < keys.size(); i++) {
+		values[i].type = keys[i].type;
+		values[i].reverse = keys[i].reverse;
+		const wchar_t* field = keys[i].field.c_str();
+		for (int32_t r = 0; r < numReaders; r++) {
+			switch (keys[i].type) {
+			case SortField::INT:
+				values[i].ints.push_back(FieldCache::DEFAULT()->getInts(readers[r], field)->intArray);
+				break;
+			case SortField::FLOAT:
+				values[i].floats.push_back(FieldCache::DEFAULT()->getFloats(readers[r], field)->floatArray);
+				break;
+			default:
+				values[i].strings.push_back(FieldCache::DEFAULT()->getStringIndex(readers[r], field)->stringIndex);
+				break;
+			}
+		}
+	}
+
+	std::vector<MergedDoc> docs;
+	for (int32_t r = 0; r < numReaders; r++) {
+		const int32_t maxDoc = readers[r]->maxDoc();
+		for (int32_t doc = 0; doc < maxDoc; doc++) {
+			if (!readers[r]->isDeleted(doc)) {
+				MergedDoc merged = { r, doc };
+				docs.push_back(merged);
+			}
+		}
+	}
+	std::stable_sort(docs.begin(), docs.end(), MergedDocLess(values));
+
+	const int32_t numDocs = (int32_t)docs.size();
+	docMaps.resize(numReaders);
+	for (int32_t r = 0; r < numReaders; r++) {
+		const int32_t maxDoc = readers[r]->maxDoc();
+		docMaps[r] = _CL_NEWARRAY(int32_t, maxDoc);
+		for (int32_t doc = 0; doc < maxDoc; doc++)
+			docMaps[r][doc] = -1;
+	}
+	for (int32_t i = 0; i < numDocs; i++)
+		docMaps[docs[i].reader][docs[i].doc] = i;
+
+	sortedDocs.resize(numDocs);
+	int32_t upto = 0;
+	for (int32_t r = 0; r < numReaders; r++) {
+		const int32_t maxDoc = readers[r]->maxDoc();
+		for (int32_t doc = 0; doc < maxDoc; doc++) {
+			if (docMaps[r][doc] != -1)
+				sortedDocs.values[upto++] = docMaps[r][doc];
+		}
+	}
+	return numDocs;
+}
+
+const std::wstring& IndexSorter::toString() const{
+	return description;
+}
+
+std::wstring IndexSorter::describe(SortField* const* fields, const int32_t count){
+	std::wstring buffer;
+	for (int32_t i = 0; i < count; i++) {
+		if (i > 0)
+			buffer.push_back(L',');
+		switch (fields[i]->getType()) {
+		case SortField::INT:
+			buffer.append(fields[i]->getField()).append(L":int");
+			break;
+		case SortField::FLOAT:
+			buffer.append(fields[i]->getField()).append(L":float");
+			break;
+		case SortField::STRING:
+			buffer.append(fields[i]->getField()).append(L":string");
+			break;
+		case SortField::DOCSCORE:
+			buffer.append(L"<score>");
+			break;
+		case SortField::DOC:
+			buffer.append(L"<doc>");
+			break;
+		default:
+			buffer.append(L"<other>");
+			break;
+		}
+		if (fields[i]->getReverse())
+			buffer.push_back(L'!');
+	}
+	return buffer;
+}
+
+CL_NS_END
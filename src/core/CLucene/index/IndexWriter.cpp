@@ -9,6 +9,8 @@
 #include "CLucene/_ApiHeader.h"
 #include "IndexWriter.h"
 #include "IndexReader.h"
+#include "DirectoryIndexReader.h"
+#include "_MultiSegmentReader.h"
 #include "CLucene/document/Document.h"
 #include "CLucene/store/Directory.h"
 #include "CLucene/search/Similarity.h"
@@ -30,6 +32,7 @@
 #include "MergeScheduler.h"
 #include "_IndexFileDeleter.h"
 #include "_Term.h"
+#include "_IndexSorter.h"
 #include <assert.h>
 #include <algorithm>
 #include <iostream>
@@ -83,6 +86,8 @@ void IndexWriter::deinit(bool releaseWriteLock) throw()
         _CLLDELETE(writeLock);
     }
     _CLLDELETE(segmentInfos);
+    detachReaders();
+    _CLLDELETE(openReaders);
     _CLLDELETE(mergingSegments);
     _CLLDELETE(pendingMerges);
     _CLLDELETE(runningMerges);
@@ -92,6 +97,7 @@ void IndexWriter::deinit(bool releaseWriteLock) throw()
     _CLLDELETE(mergePolicy);
     _CLLDELETE(deleter);
     _CLLDELETE(docWriter);
+    _CLLDELETE(indexSorter);
     if (bOwnsDirectory) _CLLDECDELETE(directory);
     delete _internal;
 }
@@ -175,6 +181,74 @@ int32_t IndexWriter::getTermIndexInterval()
     return termIndexInterval;
 }
 
+void IndexWriter::setSkipInterval(int32_t interval)
+{
+    ensureOpen();
+    if (interval < 2)
+        _CLTHROWA(CL_ERR_IllegalArgument, "skipInterval must be at least 2");
+    this->skipInterval = interval;
+}
+
+int32_t IndexWriter::getSkipInterval()
+{
+    ensureOpen();
+    return skipInterval;
+}
+
+void IndexWriter::setMaxSkipLevels(int32_t levels)
+{
+    ensureOpen();
+    if (levels < 1)
+        _CLTHROWA(CL_ERR_IllegalArgument, "maxSkipLevels must be at least 1");
+    this->maxSkipLevels = levels;
+}
+
+int32_t IndexWriter::getMaxSkipLevels()
+{
+    ensureOpen();
+    return maxSkipLevels;
+}
+
+void IndexWriter::setImpactTierSize(int32_t size)
+{
+    ensureOpen();
+    if (size < 1)
+        _CLTHROWA(CL_ERR_IllegalArgument, "impactTierSize must be at least 1");
+    this->impactTierSize = size;
+}
+
+int32_t IndexWriter::getImpactTierSize()
+{
+    ensureOpen();
+    return impactTierSize;
+}
+
+void IndexWriter::setStoredFieldsCompression(int32_t mode)
+{
+    ensureOpen();
+    if (mode != STORED_FIELDS_UNCOMPRESSED && mode != STORED_FIELDS_FAST && mode != STORED_FIELDS_HIGH_COMPRESSION)
+        _CLTHROWA(CL_ERR_IllegalArgument, "Unknown stored fields compression");
+    this->storedFieldsCompression = mode;
+}
+
+int32_t IndexWriter::getStoredFieldsCompression() const
+{
+    return storedFieldsCompression;
+}
+
+void IndexWriter::setIndexSort(const Sort* sort)
+{
+    ensureOpen();
+    IndexSorter* sorter = sort == NULL ? NULL : _CLNEW IndexSorter(sort);
+    _CLDELETE(indexSorter);
+    indexSorter = sorter;
+}
+
+IndexSorter* IndexWriter::getIndexSorter() const
+{
+    return indexSorter;
+}
+
 IndexWriter::IndexWriter(const wchar_t * path, Analyzer* a, bool create) :bOwnsDirectory(true)
 {
     init(FSDirectory::getDirectory(path, create), a, create, true, (IndexDeletionPolicy*) NULL, true);
@@ -212,8 +286,14 @@ void IndexWriter::init(Directory* d, Analyzer* a, const bool create, const bool
 {
     this->_internal = new Internal(this);
     this->termIndexInterval = IndexWriter::DEFAULT_TERM_INDEX_INTERVAL;
+    this->skipInterval = IndexWriter::DEFAULT_SKIP_INTERVAL;
+    this->maxSkipLevels = IndexWriter::DEFAULT_MAX_SKIP_LEVELS;
+    this->impactTierSize = IndexWriter::DEFAULT_IMPACT_TIER_SIZE;
+    this->storedFieldsCompression = IndexWriter::STORED_FIELDS_UNCOMPRESSED;
+    this->indexSorter = NULL;
     this->mergeScheduler = _CLNEW SerialMergeScheduler(); //TODO: implement and use ConcurrentMergeScheduler
     this->mergingSegments = _CLNEW MergingSegmentsType;
+    this->openReaders = _CLNEW OpenReadersType;
     this->pendingMerges = _CLNEW PendingMergesType;
     this->runningMerges = _CLNEW RunningMergesType;
     this->mergeExceptions = _CLNEW MergeExceptionsType;
@@ -652,6 +732,7 @@ void IndexWriter::closeInternal(bool waitForMerges)
 
             _CLDELETE(docWriter);
             deleter->close();
+            detachReaders();
         }
 
         if (closeDir)
@@ -685,7 +766,8 @@ bool IndexWriter::flushDocStores()
 {
     SCOPED_LOCK_MUTEX(THIS_LOCK)
 
-        const std::vector<std::wstring>& files = docWriter->files();
+        // copied: closeDocStore() frees the list files() returns
+        const std::vector<std::wstring> files = docWriter->files();
 
     bool useCompoundDocStore = false;
 
@@ -1348,6 +1430,8 @@ void IndexWriter::finishMerges(bool waitForMerges)
 void IndexWriter::checkpoint()
 {
     SCOPED_LOCK_MUTEX(THIS_LOCK)
+        // lets readers from getReader() tell they are out of date
+        segmentInfos->version++;
         if (autoCommit)
         {
             segmentInfos->write(directory);
@@ -1579,6 +1663,7 @@ bool IndexWriter::doFlush(bool _flushDocStores)
         }
 
     bool ret = false;
+    bool threadsResumed = false;
     try
     {
 
@@ -1656,6 +1741,15 @@ bool IndexWriter::doFlush(bool _flushDocStores)
 
             try
             {
+                // Move the buffered docs and deletes aside, then
+                // let the indexing threads fill a fresh buffer
+                // while we write them. Should they fill it before
+                // we are done, their own flush waits for our lock.
+                docWriter->startFlush(flushDocs && _flushDocStores);
+                docWriter->clearFlushPending();
+                docWriter->resumeAllThreads();
+                threadsResumed = true;
+
                 if (flushDocs)
                 {
 
@@ -1671,7 +1765,7 @@ bool IndexWriter::doFlush(bool _flushDocStores)
                         docStoreSegment.clear();
                     }
 
-                    int32_t flushedDocCount = docWriter->flush(_flushDocStores);
+                    int32_t flushedDocCount = docWriter->flush();
 
                     newSegment = _CLNEW SegmentInfo(segment.c_str(),
                         flushedDocCount,
@@ -1693,6 +1787,7 @@ bool IndexWriter::doFlush(bool _flushDocStores)
                 checkpoint();
                 success = true;
             } _CLFINALLY(
+                docWriter->finishFlush();
                 if (!success)
                 {
 
@@ -1729,7 +1824,10 @@ bool IndexWriter::doFlush(bool _flushDocStores)
                             segmentInfos->info(segmentInfos->size() - 1) == newSegment)
                             segmentInfos->remove(segmentInfos->size() - 1);
                     }
-                    if (flushDocs)
+                    // Docs added since startFlush belong to the
+                    // next segment; only a failed startFlush leaves
+                    // them inconsistent
+                    if (flushDocs && !threadsResumed)
                         docWriter->abort(NULL);
                     deletePartialSegmentsFile();
                     deleter->checkpoint(segmentInfos, false);
@@ -1776,18 +1874,110 @@ bool IndexWriter::doFlush(bool _flushDocStores)
         hitOOM = true;
         _CLTHROWA(CL_ERR_OutOfMemory, "Out of memory");
     } _CLFINALLY(
-        docWriter->clearFlushPending();
-    docWriter->resumeAllThreads();
+        if (!threadsResumed)
+        {
+            docWriter->clearFlushPending();
+            docWriter->resumeAllThreads();
+        }
     )
         return ret;
 }
 
+IndexReader* IndexWriter::getReader()
+{
+    ensureOpen();
+
+    // Flush the buffered docs and deletes, and close the doc
+    // stores so the reader can load stored fields, but don't
+    // commit. Merges wait until the reader is open.
+    flush(false, true);
+    IndexReader* reader = openReader(NULL);
+    maybeMerge();
+    return reader;
+}
+
+DirectoryIndexReader* IndexWriter::openReader(DirectoryIndexReader* previous)
+{
+    if (previous != NULL)
+        flush(false, true);
+
+    SCOPED_LOCK_MUTEX(THIS_LOCK)
+        ensureOpen();
+
+    SegmentInfos* infos = segmentInfos->clone();
+    infos->version = segmentInfos->version;
+
+    DirectoryIndexReader* reader;
+    bool success = false;
+    try
+    {
+        // A SegmentReader reopened on several segments would end up
+        // owned by the new MultiSegmentReader while the caller still
+        // deletes it, so that case is opened from scratch
+        if (previous != NULL && (infos->size() == 1 ||
+            previous->instanceOf(MultiSegmentReader::getClassName())))
+            reader = previous->doReopen(infos);
+        else if (infos->size() == 1)
+            reader = SegmentReader::get(infos, infos->info(0), false);
+        else
+            reader = _CLNEW MultiSegmentReader(directory, infos, false);
+        success = true;
+    } _CLFINALLY(
+        if (!success)
+            _CLDELETE(infos);
+    )
+
+    if (reader == previous)
+    {
+        // the segment was reopened in place and now refers to the
+        // SegmentInfo in infos
+        _CLDELETE(reader->segmentInfos);
+        reader->segmentInfos = infos;
+    }
+    else if (previous != NULL && reader->segmentInfos != infos)
+        reader->init(directory, infos, false);
+    reader->writer = this;
+    reader->fromWriter = true;
+    openReaders->insert(reader);
+    return reader;
+}
+
+void IndexWriter::releaseReader(DirectoryIndexReader* reader)
+{
+    SCOPED_LOCK_MUTEX(THIS_LOCK)
+        OpenReadersType::iterator itr = openReaders->find(reader);
+    if (itr != openReaders->end()) openReaders->remove(itr);
+    reader->writer = NULL;
+}
+
+void IndexWriter::detachReaders()
+{
+    SCOPED_LOCK_MUTEX(THIS_LOCK)
+        for (OpenReadersType::iterator itr = openReaders->begin(); itr != openReaders->end(); ++itr)
+            (*itr)->writer = NULL;
+    openReaders->clear();
+}
+
+bool IndexWriter::isReaderCurrent(DirectoryIndexReader* reader)
+{
+    SCOPED_LOCK_MUTEX(THIS_LOCK)
+        ensureOpen();
+    return reader->segmentInfos->getVersion() == segmentInfos->getVersion()
+        && docWriter->getNumDocsInRAM() == 0 && !docWriter->hasDeletes();
+}
+
 int64_t IndexWriter::ramSizeInBytes()
 {
     ensureOpen();
     return docWriter->getRAMUsed();
 }
 
+int64_t IndexWriter::ramSizeFlushingInBytes()
+{
+    ensureOpen();
+    return docWriter->getRAMFlushing();
+}
+
 int32_t IndexWriter::numRamDocs()
 {
     SCOPED_LOCK_MUTEX(THIS_LOCK)
@@ -1875,6 +2065,8 @@ bool IndexWriter::commitMerge(MergePolicy::OneMerge* _merge)
 
         BitVector* deletes = NULL;
         int32_t docUpto = 0;
+        // the new number of each merged document, if the merge sorted them
+        const int32_t* sortedDocs = _merge->sortedDocs.values;
 
         const int32_t numSegmentsToMerge = sourceSegments->size();
         for (int32_t i = 0; i < numSegmentsToMerge; i++)
@@ -1917,7 +2109,7 @@ bool IndexWriter::commitMerge(MergePolicy::OneMerge* _merge)
                         else
                         {
                             if (currentDeletes.get(j))
-                                deletes->set(docUpto);
+                                deletes->set(sortedDocs == NULL ? docUpto : sortedDocs[docUpto]);
                             docUpto++;
                         }
                     }
@@ -1937,7 +2129,7 @@ bool IndexWriter::commitMerge(MergePolicy::OneMerge* _merge)
                 for (int32_t j = 0; j < docCount; j++)
                 {
                     if (currentDeletes.get(j))
-                        deletes->set(docUpto);
+                        deletes->set(sortedDocs == NULL ? docUpto : sortedDocs[docUpto]);
                     docUpto++;
                 }
 
@@ -2257,6 +2449,10 @@ void IndexWriter::_mergeInit(MergePolicy::OneMerge* _merge)
             doFlushDocStore = true;
     }
 
+    // A sorted merge moves documents, so it rewrites the doc stores
+    if (indexSorter != NULL)
+        mergeDocStores = true;
+
     int32_t docStoreOffset;
     std::wstring docStoreSegment;
     bool docStoreIsCompoundFile;
@@ -2386,6 +2582,8 @@ int32_t IndexWriter::mergeMiddle(MergePolicy::OneMerge* _merge)
         _merge->checkAborted(directory);
 
         mergedDocCount = _merge->info->docCount = merger.merge(_merge->mergeDocStores);
+        if (merger.sorter != NULL)
+            _merge->info->setIndexSort(merger.sorter->toString());
 
         assert(mergedDocCount == totDocCount);
 
@@ -2545,11 +2743,11 @@ void IndexWriter::deletePartialSegmentsFile()
 
 void IndexWriter::applyDeletes(bool flushedNewSegment)
 {
-    const DocumentsWriter::TermNumMapType& bufferedDeleteTerms = docWriter->getBufferedDeleteTerms();
-    const vector<int32_t>* bufferedDeleteDocIDs = docWriter->getBufferedDeleteDocIDs();
+    const DocumentsWriter::TermNumMapType& bufferedDeleteTerms = docWriter->getFlushedDeleteTerms();
+    const vector<int32_t>* bufferedDeleteDocIDs = docWriter->getFlushedDeleteDocIDs();
 
     if (infoStream != NULL)
-        message(std::wstring(L"flush ") + Misc::toString(docWriter->getNumBufferedDeleteTerms()) +
+        message(std::wstring(L"flush ") + Misc::toString(docWriter->getNumFlushedDeleteTerms()) +
             L" buffered deleted terms and " + Misc::toString((int32_t) bufferedDeleteDocIDs->size()) +
             L" deleted docIDs on " + Misc::toString((int32_t) segmentInfos->size()) + L" segments.");
 
@@ -2609,9 +2807,6 @@ void IndexWriter::applyDeletes(bool flushedNewSegment)
             }
         )
     }
-
-    // Clean up bufferedDeleteTerms.
-    docWriter->clearBufferedDeletes();
 }
 
 
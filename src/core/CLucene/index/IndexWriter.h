@@ -17,6 +17,7 @@ CL_CLASS_DEF(analysis,Analyzer)
 CL_CLASS_DEF(store,Directory)
 CL_CLASS_DEF(store,LuceneLock)
 CL_CLASS_DEF(document,Document)
+CL_CLASS_DEF(search,Sort)
 
 #include "MergePolicy.h"
 #include "CLucene/LuceneThreads.h"
@@ -26,6 +27,7 @@ class SegmentInfo;
 class SegmentInfos;
 class MergePolicy;
 class IndexReader;
+class DirectoryIndexReader;
 class SegmentReader;
 class MergeScheduler;
 class DocumentsWriter;
@@ -33,6 +35,7 @@ class IndexFileDeleter;
 class LogMergePolicy;
 class IndexDeletionPolicy;
 class Term;
+class IndexSorter;
 
 /**
   An <code>IndexWriter</code> creates and maintains an index.
@@ -192,6 +195,12 @@ class CLUCENE_EXPORT IndexWriter:LUCENE_BASE {
   // merges
   typedef CL_NS(util)::CLHashSet<SegmentInfo*, CL_NS(util)::Compare::Void<SegmentInfo> > MergingSegmentsType;
   MergingSegmentsType* mergingSegments;
+
+  // Readers handed out by openReader that are still open. They
+  // are detached when this writer is closed, so they no longer
+  // call back into it
+  typedef CL_NS(util)::CLHashSet<DirectoryIndexReader*, CL_NS(util)::Compare::Void<DirectoryIndexReader> > OpenReadersType;
+  OpenReadersType* openReaders;
   MergePolicy* mergePolicy;
   MergeScheduler* mergeScheduler;
 
@@ -248,6 +257,11 @@ class CLUCENE_EXPORT IndexWriter:LUCENE_BASE {
   int32_t minMergeDocs;
   int32_t maxMergeDocs;
   int32_t termIndexInterval;
+  int32_t skipInterval;
+  int32_t maxSkipLevels;
+  int32_t impactTierSize;
+  int32_t storedFieldsCompression;
+  IndexSorter* indexSorter;
 
   int64_t writeLockTimeout;
   int64_t commitLockTimeout;
@@ -444,6 +458,115 @@ public:
    */
   int32_t getTermIndexInterval();
 
+  /** Expert: The default number of postings between the entries of a
+   *  term's skip list. */
+  LUCENE_STATIC_CONSTANT(int32_t, DEFAULT_SKIP_INTERVAL = 16);
+  /** Expert: The default maximum number of levels of a skip list. */
+  LUCENE_STATIC_CONSTANT(int32_t, DEFAULT_MAX_SKIP_LEVELS = 10);
+
+  /** Expert: Set the number of postings between the entries of the skip
+   * lists written for the terms of new segments, which
+   * {@link TermDocs#skipTo(int32_t)} uses to jump through long postings.
+   * Small values land closer to the target of each skip, for larger
+   * .frq files and more skip data to read; large values make smaller
+   * files, and skips that scan more postings. Terms in fewer documents
+   * than the interval have no skip list.
+   *
+   * The values are recorded in each segment, so segments written with
+   * different ones are read together. This must never be less than 2.
+   *
+   * @see #DEFAULT_SKIP_INTERVAL
+   */
+  void setSkipInterval(int32_t interval);
+  /** Expert: Return the number of postings between skip list entries.
+   *
+   * @see #setSkipInterval(int32_t)
+   */
+  int32_t getSkipInterval();
+
+  /** Expert: Set the maximum number of levels of the skip lists written
+   * for new segments. Each level has an entry every skip interval entries
+   * of the level below it, so that skipping far into the postings of a
+   * very common term reads few entries. Fewer levels make slightly smaller
+   * indexes. This must never be less than 1.
+   *
+   * @see #DEFAULT_MAX_SKIP_LEVELS
+   */
+  void setMaxSkipLevels(int32_t levels);
+  /** Expert: Return the maximum number of skip list levels.
+   *
+   * @see #setMaxSkipLevels(int32_t)
+   */
+  int32_t getMaxSkipLevels();
+
+  /** Expert: The default number of documents of an impact tier. */
+  LUCENE_STATIC_CONSTANT(int32_t, DEFAULT_IMPACT_TIER_SIZE = 256);
+
+  /** Expert: Set the number of documents in the impact tiers that merges
+   * write for the fields indexed with {@link Field#INDEX_IMPACTTIERS}.
+   * Terms in more than four times as many documents get a tier. Larger
+   * tiers are more likely to hold all the top hits of a search, so that
+   * the rest of the documents are skipped, but cost more to score first.
+   * This must never be less than 1.
+   *
+   * @see #DEFAULT_IMPACT_TIER_SIZE
+   */
+  void setImpactTierSize(int32_t size);
+  /** Expert: Return the number of documents in an impact tier.
+   *
+   * @see #setImpactTierSize(int32_t)
+   */
+  int32_t getImpactTierSize();
+
+  /** Stored fields are written one document at a time, the default */
+  LUCENE_STATIC_CONSTANT(int32_t, STORED_FIELDS_UNCOMPRESSED = 0);
+  /** Stored fields are packed into chunks of about 16 KB compressed with a fast LZ77 codec */
+  LUCENE_STATIC_CONSTANT(int32_t, STORED_FIELDS_FAST = 1);
+  /** Stored fields are packed into chunks of about 16 KB compressed with zlib */
+  LUCENE_STATIC_CONSTANT(int32_t, STORED_FIELDS_HIGH_COMPRESSION = 2);
+
+  /** Expert: Set how stored fields are written. Compressing documents in
+   * chunks shrinks the stored fields far more than {@link Field#STORE_COMPRESS}
+   * on small fields, at the cost of decompressing a chunk to read one of its
+   * documents. The last chunk read is cached, so documents that are read in
+   * order decompress each chunk only once.
+   *
+   * <p>The setting applies to the stored fields files created from then on,
+   * by flushes and by merges; segments in either format can be read and
+   * merged together.</p>
+   *
+   * @throws CL_ERR_IllegalArgument if mode is not one of the STORED_FIELDS_ values
+   */
+  void setStoredFieldsCompression(int32_t mode);
+  /** Expert: Return how stored fields are written.
+   *
+   * @see #setStoredFieldsCompression(int)
+   */
+  int32_t getStoredFieldsCompression() const;
+
+  /** Expert: Set the order of the documents in the segments written by
+   * merges, including {@link #optimize}. The fields of the sort must be
+   * INT, FLOAT or STRING fields, indexed with a single term per document;
+   * documents that compare equal keep their relative order. Flushed
+   * segments stay in the order the documents were added until they are
+   * merged.
+   *
+   * <p>A search sorted the same way, or by a leading part of the sort,
+   * can then stop reading a sorted segment once it has collected enough
+   * of its hits, see IndexSearcher#setEarlyTermination. Every merge
+   * rewrites the stored fields and term vectors of the segments it merges.</p>
+   *
+   * @param sort the sort, or NULL to stop sorting; it is copied
+   * @throws CL_ERR_IllegalArgument if a field of the sort is not an INT,
+   * FLOAT or STRING field
+   */
+  void setIndexSort(const CL_NS(search)::Sort* sort);
+  /** Expert: Return the sort of the merged segments, or NULL.
+   *
+   * @see #setIndexSort
+   */
+  IndexSorter* getIndexSorter() const;
+
   /**Determines the largest number of documents ever merged by addDocument().
    *  Small values (e.g., less than 10,000) are best for interactive indexing,
    *  as this limits the length of pauses while indexing to a few seconds.
@@ -679,6 +802,10 @@ public:
    * is also enabled, then the flush will be triggered by
    * whichever comes first.</p>
    *
+   * <p>Other threads go on adding documents while a flush
+   * is written, so up to twice this much RAM may be in
+   * use.</p>
+   *
    * <p> The default value is {@link #DEFAULT_RAM_BUFFER_SIZE_MB}.</p>
    *
    * @throws IllegalArgumentException if ramBufferSize is
@@ -910,6 +1037,30 @@ public:
    */
   void flush();
 
+  /**
+   * Returns a reader that sees every document added and deleted
+   * through this writer so far, without committing.
+   *
+   * <p>Buffered documents and deletes are flushed to new segments
+   * and the doc stores are closed so their stored fields can be
+   * read. No segments_N file is written and the Directory is not
+   * synced. This makes it much cheaper than {@link #close} or a
+   * commit followed by {@link IndexReader#open}.</p>
+   *
+   * <p>Calling {@link IndexReader#reopen} on the returned reader asks
+   * this writer again. The new reader shares the SegmentReaders of
+   * segments that did not change, and segments that only gained
+   * deletes reuse their postings and stored fields.</p>
+   *
+   * <p>The reader is for searching only. Deleting documents or
+   * setting norms through it throws; use this writer instead. The
+   * caller must close and delete the reader. It may outlive this
+   * writer, but once the writer is closed or deleted its
+   * {@link IndexReader#isCurrent} and {@link IndexReader#reopen}
+   * throw CL_ERR_AlreadyClosed.</p>
+   */
+  IndexReader* getReader();
+
   /**
    * Adds a document to this index.  If the document contains more than
    * {@link #setMaxFieldLength(int)} terms for a given field, the remainder are
@@ -1090,10 +1241,18 @@ public:
   void addIndexes(CL_NS(util)::ArrayBase<CL_NS(store)::Directory*>& dirs);
 
   /** Expert:  Return the total size of all index files currently cached in memory.
-   * Useful for size management with flushRamDocs()
+   * Useful for size management with flushRamDocs().
+   * A segment that is being flushed is not included; see
+   * {@link #ramSizeFlushingInBytes}.
    */
   int64_t ramSizeInBytes();
 
+  /** Expert:  Return the RAM still held by a segment that is being
+   * flushed while new documents are buffered, or 0 if no flush is
+   * running.
+   */
+  int64_t ramSizeFlushingInBytes();
+
   /** Expert:  Return the number of documents whose segments are currently cached in memory.
    * Useful when calling flush()
    */
@@ -1107,6 +1266,22 @@ private:
   friend class LockWith2;
   friend class LockWithCFS;
   friend class DocumentsWriter;
+  friend class DirectoryIndexReader;
+
+  /** Opens a reader on the current, possibly uncommitted, segments.
+   *  If previous is not NULL it is reopened instead, sharing the
+   *  readers of unchanged segments. */
+  DirectoryIndexReader* openReader(DirectoryIndexReader* previous);
+
+  /** True if reader (from openReader) reflects every change made
+   *  through this writer */
+  bool isReaderCurrent(DirectoryIndexReader* reader);
+
+  /** Called by a reader from openReader when it is closed */
+  void releaseReader(DirectoryIndexReader* reader);
+
+  /** Detaches every reader still open from this writer */
+  void detachReaders();
 
   /** Merges all RAM-resident segments. */
   void flushRamSegments();
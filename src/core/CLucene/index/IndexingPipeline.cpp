@@ -0,0 +1,331 @@
+/*------------------------------------------------------------------------------
+* Copyright (C) 2003-2006 Ben van Klinken and the CLucene Team
+
+* Updated by https://github.com/farfella/.
+*
+* Distributable under the terms of either the Apache License (Version 2.0) or
+* the GNU Lesser General Public License, as specified in the COPYING file.
+------------------------------------------------------------------------------*/
+#include "CLucene/_ApiHeader.h"
+#include "IndexingPipeline.h"
+#include "IndexWriter.h"
+#include "CLucene/document/Document.h"
+#include <map>
+
+CL_NS_USE(util)
+CL_NS_USE(document)
+CL_NS_USE(analysis)
+CL_NS_DEF(index)
+
+const float_t IndexingPipeline::DEFAULT_RAM_HIGH_WATER_MARK = 1.0f;
+
+struct IndexingPipeline::Internal
+{
+	struct Entry {
+		Document* doc;
+		int64_t batchId;
+	};
+	struct BatchState {
+		int32_t numDocs;
+		int32_t remaining;
+		int32_t failed;
+	};
+
+	IndexWriter* writer;
+	Analyzer* analyzer;
+	BatchListener* listener;
+	int32_t numThreads;
+	float_t ramHighWaterMark;
+
+	//bounded ring buffer of queued documents
+	Entry* queue;
+	int32_t queueCapacity;
+	int32_t head;
+	int32_t count;
+
+	int32_t inFlight;   //documents taken off the queue but not finished
+	bool closing;
+	int64_t nextBatchId;
+	std::map<int64_t, BatchState> pending;
+	int64_t numIndexed;
+	int64_t numFailed;
+	_LUCENE_THREADID_TYPE* threads;
+
+	DEFINE_MUTEX(THIS_LOCK)
+	DEFINE_CONDITION(QUEUE_NOT_EMPTY)  //workers wait here
+	DEFINE_CONDITION(PROGRESS)         //producers and waitFor* wait here
+};
+
+struct IndexingPipelineWorker {
+	static void run(IndexingPipeline* pipeline) { pipeline->runWorker(); }
+};
+
+_LUCENE_THREAD_FUNC(indexingPipelineWorker, arg)
+{
+	IndexingPipelineWorker::run(static_cast<IndexingPipeline*>(arg));
+	_LUCENE_THREAD_FUNC_RETURN(0);
+}
+
+IndexingPipeline::BatchListener::~BatchListener() {
+}
+
+IndexingPipeline::IndexingPipeline(IndexWriter* writer, int32_t numThreads,
+	int32_t queueCapacity, Analyzer* analyzer)
+{
+	if (writer == NULL)
+		_CLTHROWA(CL_ERR_NullPointer, "writer must not be NULL");
+	if (numThreads < 1)
+		_CLTHROWA(CL_ERR_IllegalArgument, "numThreads must be at least 1");
+	if (queueCapacity < 1)
+		_CLTHROWA(CL_ERR_IllegalArgument, "queueCapacity must be at least 1");
+
+	_internal = _CLNEW Internal;
+	_internal->writer = writer;
+	_internal->analyzer = analyzer;
+	_internal->listener = NULL;
+	_internal->numThreads = numThreads;
+	_internal->ramHighWaterMark = DEFAULT_RAM_HIGH_WATER_MARK;
+	_internal->queue = _CL_NEWARRAY(Internal::Entry, queueCapacity);
+	_internal->queueCapacity = queueCapacity;
+	_internal->head = 0;
+	_internal->count = 0;
+	_internal->inFlight = 0;
+	_internal->closing = false;
+	_internal->nextBatchId = 0;
+	_internal->numIndexed = 0;
+	_internal->numFailed = 0;
+
+	_internal->threads = _CL_NEWARRAY(_LUCENE_THREADID_TYPE, numThreads);
+	for (int32_t i = 0; i < numThreads; i++)
+		_internal->threads[i] = _LUCENE_THREAD_CREATE(&indexingPipelineWorker, this);
+}
+
+IndexingPipeline::~IndexingPipeline()
+{
+	close();
+	_CLDELETE_ARRAY(_internal->queue);
+	_CLDELETE(_internal);
+}
+
+bool IndexingPipeline::mustWaitForRoom()
+{
+	if (_internal->count >= _internal->queueCapacity)
+		return true;
+
+	//with nothing in flight no flush is coming to free RAM, so don't stall
+	if (_internal->count + _internal->inFlight == 0)
+		return false;
+
+	const float_t ramBufferSizeMB = _internal->writer->getRAMBufferSizeMB();
+	if (ramBufferSizeMB == IndexWriter::DISABLE_AUTO_FLUSH)
+		return false;
+
+	//a full buffer is flushed by the next document, and indexing goes on
+	//into a new one while it is written. Only hold back when that buffer
+	//fills up too before the previous flush has finished
+	if (_internal->writer->ramSizeFlushingInBytes() == 0)
+		return false;
+	const int64_t highWater = (int64_t)(ramBufferSizeMB * _internal->ramHighWaterMark * 1024 * 1024);
+	return _internal->writer->ramSizeInBytes() > highWater;
+}
+
+int64_t IndexingPipeline::addDocument(Document* doc)
+{
+	return addDocuments(&doc, 1);
+}
+
+int64_t IndexingPipeline::addDocuments(Document** docs, int32_t numDocs)
+{
+	CND_PRECONDITION(numDocs >= 0, L"numDocs is negative");
+
+	SCOPED_LOCK_MUTEX(_internal->THIS_LOCK)
+	if (_internal->closing)
+		_CLTHROWA(CL_ERR_IllegalState, "this IndexingPipeline is closed");
+
+	const int64_t batchId = _internal->nextBatchId++;
+	if (numDocs == 0)
+		return batchId;
+
+	Internal::BatchState& batch = _internal->pending[batchId];
+	batch.numDocs = numDocs;
+	batch.remaining = numDocs;
+	batch.failed = 0;
+
+	for (int32_t i = 0; i < numDocs; i++) {
+		while (!_internal->closing && mustWaitForRoom())
+			CONDITION_WAIT(_internal->THIS_LOCK, _internal->PROGRESS)
+
+		if (_internal->closing) {
+			//closed while we were blocked: the workers may already have
+			//exited, so the rest of the batch can't be queued
+			for (int32_t j = i; j < numDocs; j++)
+				_CLDELETE(docs[j]);
+			_internal->numFailed += numDocs - i;
+			batch.failed += numDocs - i;
+			batch.remaining -= numDocs - i;
+			if (batch.remaining == 0)
+				_internal->pending.erase(batchId);
+			CONDITION_NOTIFYALL(_internal->PROGRESS)
+			_CLTHROWA(CL_ERR_IllegalState, "this IndexingPipeline is closed");
+		}
+
+		Internal::Entry& entry = _internal->queue[(_internal->head + _internal->count) % _internal->queueCapacity];
+		entry.doc = docs[i];
+		entry.batchId = batchId;
+		_internal->count++;
+		CONDITION_NOTIFYALL(_internal->QUEUE_NOT_EMPTY)
+	}
+	return batchId;
+}
+
+void IndexingPipeline::runWorker()
+{
+	for (;;) {
+		Internal::Entry entry;
+		{
+			SCOPED_LOCK_MUTEX(_internal->THIS_LOCK)
+			while (_internal->count == 0 && !_internal->closing)
+				CONDITION_WAIT(_internal->THIS_LOCK, _internal->QUEUE_NOT_EMPTY)
+
+			if (_internal->count == 0) {
+				//closing and drained: pass the wake-up on to the other workers
+				CONDITION_NOTIFYALL(_internal->QUEUE_NOT_EMPTY)
+				break;
+			}
+
+			entry = _internal->queue[_internal->head];
+			_internal->head = (_internal->head + 1) % _internal->queueCapacity;
+			_internal->count--;
+			_internal->inFlight++;
+			if (_internal->count > 0)
+				CONDITION_NOTIFYALL(_internal->QUEUE_NOT_EMPTY)
+			CONDITION_NOTIFYALL(_internal->PROGRESS)
+		}
+
+		bool failed = false;
+		try {
+			_internal->writer->addDocument(entry.doc, _internal->analyzer);
+		} catch (CLuceneError&) {
+			failed = true;
+		}
+		_CLDELETE(entry.doc);
+
+		BatchListener* listener = NULL;
+		Internal::BatchState done;
+		{
+			SCOPED_LOCK_MUTEX(_internal->THIS_LOCK)
+			if (failed)
+				_internal->numFailed++;
+			else
+				_internal->numIndexed++;
+
+			Internal::BatchState& batch = _internal->pending[entry.batchId];
+			if (failed)
+				batch.failed++;
+			if (--batch.remaining > 0 || _internal->listener == NULL) {
+				if (batch.remaining == 0)
+					_internal->pending.erase(entry.batchId);
+				_internal->inFlight--;
+				CONDITION_NOTIFYALL(_internal->PROGRESS)
+				continue;
+			}
+			listener = _internal->listener;
+			done = batch;
+		}
+
+		//the batch stays pending until its listener has returned, so
+		//waitForBatch never returns before the notification is delivered
+		listener->batchCompleted(entry.batchId, done.numDocs, done.failed);
+		{
+			SCOPED_LOCK_MUTEX(_internal->THIS_LOCK)
+			_internal->pending.erase(entry.batchId);
+			_internal->inFlight--;
+			CONDITION_NOTIFYALL(_internal->PROGRESS)
+		}
+	}
+}
+
+bool IndexingPipeline::isBatchComplete(int64_t batchId)
+{
+	SCOPED_LOCK_MUTEX(_internal->THIS_LOCK)
+	return batchId < _internal->nextBatchId &&
+		_internal->pending.find(batchId) == _internal->pending.end();
+}
+
+void IndexingPipeline::waitForBatch(int64_t batchId)
+{
+	SCOPED_LOCK_MUTEX(_internal->THIS_LOCK)
+	while (_internal->pending.find(batchId) != _internal->pending.end())
+		CONDITION_WAIT(_internal->THIS_LOCK, _internal->PROGRESS)
+}
+
+void IndexingPipeline::waitForAll()
+{
+	SCOPED_LOCK_MUTEX(_internal->THIS_LOCK)
+	while (_internal->count > 0 || _internal->inFlight > 0)
+		CONDITION_WAIT(_internal->THIS_LOCK, _internal->PROGRESS)
+}
+
+void IndexingPipeline::close()
+{
+	_LUCENE_THREADID_TYPE* threads;
+	{
+		SCOPED_LOCK_MUTEX(_internal->THIS_LOCK)
+		if (_internal->threads == NULL)
+			return;
+		threads = _internal->threads;
+		_internal->threads = NULL;
+		_internal->closing = true;
+		CONDITION_NOTIFYALL(_internal->QUEUE_NOT_EMPTY)
+		CONDITION_NOTIFYALL(_internal->PROGRESS)
+	}
+
+	//workers finish whatever is still queued before they exit
+	for (int32_t i = 0; i < _internal->numThreads; i++)
+		_LUCENE_THREAD_JOIN(threads[i]);
+	_CLDELETE_ARRAY(threads);
+}
+
+void IndexingPipeline::setBatchListener(BatchListener* listener)
+{
+	SCOPED_LOCK_MUTEX(_internal->THIS_LOCK)
+	_internal->listener = listener;
+}
+
+void IndexingPipeline::setRAMHighWaterMark(float_t fraction)
+{
+	if (fraction <= 0)
+		_CLTHROWA(CL_ERR_IllegalArgument, "fraction must be > 0");
+	SCOPED_LOCK_MUTEX(_internal->THIS_LOCK)
+	_internal->ramHighWaterMark = fraction;
+	CONDITION_NOTIFYALL(_internal->PROGRESS)
+}
+
+float_t IndexingPipeline::getRAMHighWaterMark() const
+{
+	return _internal->ramHighWaterMark;
+}
+
+int32_t IndexingPipeline::getNumThreads() const
+{
+	return _internal->numThreads;
+}
+
+int32_t IndexingPipeline::getQueueCapacity() const
+{
+	return _internal->queueCapacity;
+}
+
+int64_t IndexingPipeline::getNumIndexed()
+{
+	SCOPED_LOCK_MUTEX(_internal->THIS_LOCK)
+	return _internal->numIndexed;
+}
+
+int64_t IndexingPipeline::getNumFailed()
+{
+	SCOPED_LOCK_MUTEX(_internal->THIS_LOCK)
+	return _internal->numFailed;
+}
+
+CL_NS_END
@@ -0,0 +1,154 @@
+/*------------------------------------------------------------------------------
+* Copyright (C) 2003-2006 Ben van Klinken and the CLucene Team
+
+* Updated by https://github.com/farfella/.
+*
+* Distributable under the terms of either the Apache License (Version 2.0) or
+* the GNU Lesser General Public License, as specified in the COPYING file.
+------------------------------------------------------------------------------*/
+#ifndef _lucene_index_IndexingPipeline_
+#define _lucene_index_IndexingPipeline_
+
+#include "CLucene/clucene-config.h"
+
+CL_CLASS_DEF(document, Document)
+CL_CLASS_DEF(analysis, Analyzer)
+
+CL_NS_DEF(index)
+
+class IndexWriter;
+
+/**
+* Feeds documents to an {@link IndexWriter} from a pool of worker threads.
+*
+* <p>Documents are handed over in batches through {@link #addDocuments}
+* (or one at a time through {@link #addDocument}) and placed on a bounded
+* queue. Each worker takes documents off the queue and runs them through
+* {@link IndexWriter#addDocument}, so analysis, inversion and stored field
+* writing all happen on the pipeline's threads and the DocumentsWriter
+* sees one ThreadState per worker.</p>
+*
+* <p>The producer is held back (backpressure) while the queue is full, or
+* while flushing falls behind: a segment is still being flushed, the
+* buffer that documents are added to meanwhile is already above
+* {@link #getRAMHighWaterMark} of {@link IndexWriter#getRAMBufferSizeMB},
+* and documents are still in flight. Below that the workers keep
+* indexing concurrently right up to the flush.</p>
+*
+* <p>Completion is reported per batch: poll {@link #isBatchComplete},
+* block in {@link #waitForBatch} or register a {@link BatchListener}.
+* Documents that fail to index are counted, not rethrown, since the caller
+* that submitted them is usually long gone.</p>
+*
+* <p>The pipeline does not close or commit the writer. Call {@link #close}
+* (or delete the pipeline) to drain the queue and stop the workers before
+* closing the writer.</p>
+*
+* <pre>
+*   IndexingPipeline pipeline(&writer, 4);
+*   Document** docs = ...;
+*   int64_t batch = pipeline.addDocuments(docs, numDocs);
+*   ...
+*   pipeline.waitForBatch(batch);
+*   pipeline.close();
+*   writer.close();
+* </pre>
+*/
+class CLUCENE_EXPORT IndexingPipeline: LUCENE_BASE {
+public:
+	/**
+	* Notified when every document of a batch has been indexed (or has
+	* failed). Called from a worker thread, without any pipeline lock held.
+	*/
+	class CLUCENE_EXPORT BatchListener {
+	public:
+		virtual ~BatchListener();
+		virtual void batchCompleted(int64_t batchId, int32_t numDocs, int32_t numFailed) = 0;
+	};
+
+	/** Default number of documents the queue holds before addDocuments blocks */
+	LUCENE_STATIC_CONSTANT(int32_t, DEFAULT_QUEUE_CAPACITY = 256);
+
+	/** Default fraction of the RAM buffer at which producers are held back
+	* while a flush is running */
+	static const float_t DEFAULT_RAM_HIGH_WATER_MARK;
+
+	/**
+	* Starts <code>numThreads</code> workers feeding <code>writer</code>.
+	* @param analyzer analyzer passed to IndexWriter::addDocument, or NULL
+	*   to use the writer's analyzer. Must support being used from several
+	*   threads at once, which all core analyzers do.
+	*/
+	IndexingPipeline(IndexWriter* writer, int32_t numThreads,
+		int32_t queueCapacity = DEFAULT_QUEUE_CAPACITY,
+		CL_NS(analysis)::Analyzer* analyzer = NULL);
+
+	/** Drains the queue and stops the workers. Does not close the writer. */
+	virtual ~IndexingPipeline();
+
+	/**
+	* Queues a single document as its own batch.
+	* The pipeline takes ownership of <code>doc</code> and deletes it once indexed.
+	* @return the batch id
+	*/
+	int64_t addDocument(CL_NS(document)::Document* doc);
+
+	/**
+	* Queues <code>numDocs</code> documents as one batch, blocking while the
+	* queue is full or flushing has fallen behind.
+	* The pipeline takes ownership of the documents (but not of the array).
+	* <p>Throws CL_ERR_IllegalState if the pipeline was already closed, in
+	* which case the documents still belong to the caller. If it is closed
+	* while this call is blocked, the documents not yet queued are deleted
+	* and counted as failed before the error is thrown.</p>
+	* @return the batch id
+	*/
+	int64_t addDocuments(CL_NS(document)::Document** docs, int32_t numDocs);
+
+	/** Returns true once every document of the batch has been processed */
+	bool isBatchComplete(int64_t batchId);
+
+	/** Blocks until every document of the batch has been processed */
+	void waitForBatch(int64_t batchId);
+
+	/** Blocks until the queue is empty and no document is in flight */
+	void waitForAll();
+
+	/**
+	* Processes all queued documents and stops the worker threads.
+	* No documents may be added afterwards. Safe to call more than once.
+	*/
+	void close();
+
+	/** Set the listener notified of batch completion. Not owned. */
+	void setBatchListener(BatchListener* listener);
+
+	/**
+	* Set the fraction of IndexWriter#getRAMBufferSizeMB above which
+	* producers are held back while a previous segment is still being
+	* flushed. Has no effect when the writer flushes by document count
+	* only.
+	*/
+	void setRAMHighWaterMark(float_t fraction);
+	float_t getRAMHighWaterMark() const;
+
+	int32_t getNumThreads() const;
+	int32_t getQueueCapacity() const;
+
+	/** Number of documents indexed successfully so far */
+	int64_t getNumIndexed();
+
+	/** Number of documents whose IndexWriter::addDocument threw */
+	int64_t getNumFailed();
+
+private:
+	struct Internal;
+	Internal* _internal;
+
+	bool mustWaitForRoom();
+	void runWorker();
+	friend struct IndexingPipelineWorker;
+};
+
+CL_NS_END
+#endif
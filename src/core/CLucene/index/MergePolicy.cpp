@@ -10,6 +10,7 @@
 #include "MergePolicy.h"
 #include "_SegmentInfos.h"
 #include "IndexWriter.h"
+#include "_IndexSorter.h"
 #include "CLucene/store/Directory.h"
 #include <assert.h>
 
@@ -172,7 +173,8 @@ bool LogMergePolicy::isOptimized(IndexWriter* writer, SegmentInfo* info)
     return !info->hasDeletions() &&
         !info->hasSeparateNorms() &&
         info->dir == writer->getDirectory() &&
-        info->getUseCompoundFile() == _useCompoundFile;
+        info->getUseCompoundFile() == _useCompoundFile &&
+        (writer->getIndexSorter() == NULL || info->getIndexSort() == writer->getIndexSorter()->toString());
 }
 
 LogMergePolicy::LogMergePolicy()
@@ -11,6 +11,7 @@
 #include "CLucene/clucene-config.h"
 
 #include "CLucene/util/VoidList.h"
+#include "CLucene/util/Array.h"
 CL_CLASS_DEF(store, Directory)
 CL_NS_DEF(index)
 
@@ -66,6 +67,7 @@ public:
       int64_t mergeGen;                  // used by IndexWriter
       bool isExternal;             // used by IndexWriter
       int32_t maxNumSegmentsOptimize;     // used by IndexWriter
+      CL_NS(util)::ValueArray<int32_t> sortedDocs; // used by IndexWriter: the new number of each merged document when the index is sorted
 
       SegmentInfos* segments;
       const bool useCompoundFile;
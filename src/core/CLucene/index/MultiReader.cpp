@@ -230,6 +230,31 @@ bool MultiReader::document(int32_t n, CL_NS(document)::Document& doc, const Fiel
     return (*subReaders)[i]->document(n - starts[i], doc, fieldSelector);	  // dispatch to segment reader
 }
 
+void MultiReader::visitDocument(const int32_t n, StoredFieldVisitor* visitor)
+{
+    ensureOpen();
+    int32_t i = readerIndex(n);			  // find segment num
+    (*subReaders)[i]->visitDocument(n - starts[i], visitor);	  // dispatch to segment reader
+}
+
+void MultiReader::documents(const int32_t* docs, const int32_t count, CL_NS(document)::Document** result, const FieldSelector* fieldSelector)
+{
+    ensureOpen();
+    // each segment gets its share of the batch at once
+    const size_t numReaders = subReaders->length;
+    std::vector< std::vector<int32_t> > subDocs(numReaders);
+    std::vector< std::vector<CL_NS(document)::Document*> > subResult(numReaders);
+    for (int32_t j = 0; j < count; j++) {
+        int32_t i = readerIndex(docs[j]);
+        subDocs[i].push_back(docs[j] - starts[i]);
+        subResult[i].push_back(result[j]);
+    }
+    for (size_t i = 0; i < numReaders; i++) {
+        if (!subDocs[i].empty())
+            (*subReaders)[i]->documents(&subDocs[i][0], (int32_t)subDocs[i].size(), &subResult[i][0], fieldSelector);
+    }
+}
+
 bool MultiReader::isDeleted(const int32_t n)
 {
     // Don't call ensureOpen() here (it could affect performance)
@@ -306,6 +331,13 @@ TermEnum* MultiReader::terms(const Term* term)
     return _CLNEW MultiTermEnum(subReaders, starts, term);
 }
 
+bool MultiReader::getTermGramCandidates(const wchar_t* field, const std::vector<std::wstring>& substrings,
+    std::vector<std::wstring>& candidates)
+{
+    ensureOpen();
+    return MultiSegmentReader::getTermGramCandidates(field, substrings, candidates, subReaders);
+}
+
 int32_t MultiReader::docFreq(const Term* t)
 {
     ensureOpen();
@@ -92,6 +92,9 @@ public:
 	int32_t numDocs();
 	int32_t maxDoc() const;
   bool document(int32_t n, CL_NS(document)::Document& doc, const CL_NS(document)::FieldSelector* fieldSelector);
+  void visitDocument(const int32_t n, StoredFieldVisitor* visitor);
+  void documents(const int32_t* docs, const int32_t count, CL_NS(document)::Document** result,
+    const CL_NS(document)::FieldSelector* fieldSelector = NULL);
 	bool isDeleted(const int32_t n);
 	bool hasDeletions() const;
 	uint8_t* norms(const wchar_t* field);
@@ -99,6 +102,9 @@ public:
 	TermEnum* terms();
 	TermEnum* terms(const Term* term);
 
+	bool getTermGramCandidates(const wchar_t* field, const std::vector<std::wstring>& substrings,
+		std::vector<std::wstring>& candidates);
+
 	//Returns the document frequency of the current term in the set
 	int32_t docFreq(const Term* t=NULL);
 	TermDocs* termDocs();
@@ -91,9 +91,7 @@ MultiSegmentReader::MultiSegmentReader(
     CL_NS(store)::Directory* directory,
     SegmentInfos* infos,
     bool closeDirectory,
-    CL_NS(util)::ArrayBase<IndexReader*>* oldReaders,
-    int32_t* oldStarts,
-    NormsCacheType* oldNormsCache) :
+    CL_NS(util)::ArrayBase<IndexReader*>* oldReaders) :
     DirectoryIndexReader(directory, infos, closeDirectory),
     normsCache(NormsCacheType(true, true))
 {
@@ -170,49 +168,10 @@ MultiSegmentReader::MultiSegmentReader(
         )
     }
 
-    // initialize the readers to calculate maxDoc before we try to reuse the old normsCache
+    // the norms of the whole index are not carried over from the old reader:
+    // searches score each segment with its own norms, so they are only
+    // concatenated again if norms() is called for the field
     initialize(newReaders);
-
-    // try to copy unchanged norms from the old normsCache to the new one
-    if (oldNormsCache != NULL)
-    {
-        NormsCacheType::iterator it = oldNormsCache->begin();
-        while (it != oldNormsCache->end())
-        {
-            wchar_t* field = it->first;
-            if (!hasNorms(field))
-            {
-                continue;
-            }
-            uint8_t* oldBytes = it->second;
-            uint8_t* bytes = _CL_NEWARRAY(uint8_t, maxDoc());
-
-
-            for (size_t i = 0; i < subReaders->length; i++)
-            {
-                std::map<std::wstring, size_t>::iterator oldReaderIndex = segmentReaders.find(((SegmentReader*) (*subReaders)[i])->getSegmentName());
-
-                // this SegmentReader was not re-opened, we can copy all of its norms
-                if (oldReaderIndex != segmentReaders.end() &&
-                    ((*oldReaders)[oldReaderIndex->second] == (*subReaders)[i]
-                        || ((SegmentReader*) (*oldReaders)[oldReaderIndex->second])->_norms.get(field) == ((SegmentReader*) (*subReaders)[i])->_norms.get(field)))
-                {
-                    // we don't have to synchronize here: either this constructor is called from a SegmentReader,
-                    // in which case no old norms cache is present, or it is called from MultiReader.reopen(),
-                    // which is synchronized
-                    memcpy(bytes + starts[i], oldBytes + oldStarts[oldReaderIndex->second], starts[i + 1] - starts[i]);
-                }
-                else
-                {
-                    (*subReaders)[i]->norms(field, bytes + starts[i]);
-                }
-            }
-
-            normsCache.put(field, bytes);      // update cache
-
-            it++;
-        }
-    }
 }
 
 
@@ -245,7 +204,7 @@ DirectoryIndexReader* MultiSegmentReader::doReopen(SegmentInfos* infos)
         }
         else
         {
-            return _CLNEW MultiSegmentReader(_directory, infos, closeDirectory, subReaders, starts, &normsCache);
+            return _CLNEW MultiSegmentReader(_directory, infos, closeDirectory, subReaders);
         }
 }
 
@@ -315,6 +274,31 @@ bool MultiSegmentReader::document(int32_t n, CL_NS(document)::Document& doc, con
     return (*subReaders)[i]->document(n - starts[i], doc, fieldSelector);	  // dispatch to segment reader
 }
 
+void MultiSegmentReader::visitDocument(const int32_t n, StoredFieldVisitor* visitor)
+{
+    ensureOpen();
+    int32_t i = readerIndex(n);			  // find segment num
+    (*subReaders)[i]->visitDocument(n - starts[i], visitor);	  // dispatch to segment reader
+}
+
+void MultiSegmentReader::documents(const int32_t* docs, const int32_t count, CL_NS(document)::Document** result, const FieldSelector* fieldSelector)
+{
+    ensureOpen();
+    // each segment gets its share of the batch at once
+    const size_t numReaders = subReaders->length;
+    std::vector< std::vector<int32_t> > subDocs(numReaders);
+    std::vector< std::vector<CL_NS(document)::Document*> > subResult(numReaders);
+    for (int32_t j = 0; j < count; j++) {
+        int32_t i = readerIndex(docs[j]);
+        subDocs[i].push_back(docs[j] - starts[i]);
+        subResult[i].push_back(result[j]);
+    }
+    for (size_t i = 0; i < numReaders; i++) {
+        if (!subDocs[i].empty())
+            (*subReaders)[i]->documents(&subDocs[i][0], (int32_t)subDocs[i].size(), &subResult[i][0], fieldSelector);
+    }
+}
+
 bool MultiSegmentReader::isDeleted(const int32_t n)
 {
     // Don't call ensureOpen() here (it could affect performance)
@@ -366,8 +350,8 @@ void MultiSegmentReader::norms(const wchar_t* field, uint8_t* result)
 
     if (bytes != NULL)
     {                            // cache hit
-        int32_t len = maxDoc();
-        memcpy(result, bytes, len * sizeof(int32_t));
+        memcpy(result, bytes, maxDoc());
+        return;
     }
 
     for (size_t i = 0; i < subReaders->length; i++)      // read from segments
@@ -394,6 +378,29 @@ TermEnum* MultiSegmentReader::terms(const Term* term)
     return _CLNEW MultiTermEnum(subReaders, starts, term);
 }
 
+bool MultiSegmentReader::getTermGramCandidates(const wchar_t* field, const std::vector<std::wstring>& substrings,
+    std::vector<std::wstring>& candidates)
+{
+    ensureOpen();
+    return getTermGramCandidates(field, substrings, candidates, subReaders);
+}
+
+bool MultiSegmentReader::getTermGramCandidates(const wchar_t* field, const std::vector<std::wstring>& substrings,
+    std::vector<std::wstring>& candidates, CL_NS(util)::ArrayBase<IndexReader*>* subReaders)
+{
+    // the candidates are only useful if every sub-reader can supply them
+    const size_t start = candidates.size();
+    for (size_t i = 0; i < subReaders->length; i++)
+    {
+        if (!(*subReaders)[i]->getTermGramCandidates(field, substrings, candidates))
+        {
+            candidates.resize(start);
+            return false;
+        }
+    }
+    return true;
+}
+
 int32_t MultiSegmentReader::docFreq(const Term* t)
 {
     ensureOpen();
@@ -431,6 +438,22 @@ int32_t MultiSegmentReader::getTermInfosIndexDivisor()
         _CLTHROWA(CL_ERR_IllegalState, "no readers");
 }
 
+void MultiSegmentReader::setSkipListCache(const size_t maxBytes, const int32_t minDocFreq)
+{
+    for (size_t i = 0; i < subReaders->length; i++)
+        (*subReaders)[i]->setSkipListCache(maxBytes, minDocFreq);
+}
+
+size_t MultiSegmentReader::getSkipListCacheSize()
+{
+    return subReaders->length > 0 ? (*subReaders)[0]->getSkipListCacheSize() : 0;
+}
+
+int32_t MultiSegmentReader::getSkipListCacheMinDocFreq()
+{
+    return subReaders->length > 0 ? (*subReaders)[0]->getSkipListCacheMinDocFreq() : DEFAULT_SKIP_LIST_CACHE_MIN_DOCFREQ;
+}
+
 void MultiSegmentReader::doDelete(const int32_t n)
 {
     _numDocs = -1;				  // invalidate cache
@@ -636,6 +659,16 @@ int32_t MultiTermDocs::freq() const
     return current->freq();
 }
 
+int32_t MultiTermDocs::docFreq() const
+{
+    if (term == NULL || subReaders == NULL)
+        return -1;
+    int32_t total = 0;
+    for (size_t i = 0; i < subReaders->length; i++)
+        total += subReaders->values[i]->docFreq(term);
+    return total;
+}
+
 void MultiTermDocs::seek(TermEnum* termEnum)
 {
     seek(termEnum->term(false));
@@ -118,10 +118,14 @@ public:
 	}
 };
 
-MultipleTermPositions::MultipleTermPositions(IndexReader* indexReader, const CL_NS(util)::ArrayBase<Term*>* terms) : _posList(_CLNEW IntQueue()){
+MultipleTermPositions::MultipleTermPositions(IndexReader* indexReader, const CL_NS(util)::ArrayBase<Term*>* terms) :
+	_doc(0), _freq(0), _docFreq(0), _posList(_CLNEW IntQueue()), _positionsLoaded(false){
 	CLLinkedList<TermPositions*> termPositions;
   for ( size_t i=0;i<terms->length;i++){
-    termPositions.push_back( indexReader->termPositions(terms->values[i]));
+    TermPositions* tp = indexReader->termPositions(terms->values[i]);
+    const int32_t df = tp->docFreq();
+    _docFreq = (df < 0 || _docFreq < 0) ? -1 : _docFreq + df;
+    termPositions.push_back(tp);
 	}
 
 	TermPositions** tps = _CL_NEWARRAY(TermPositions*, terms->length+1); // i == tpsSize
@@ -132,44 +136,63 @@ MultipleTermPositions::MultipleTermPositions(IndexReader* indexReader, const CL_
 }
 
 MultipleTermPositions::~MultipleTermPositions() {
+	close();
 	_CLLDELETE(_termPositionsQueue);
 	_CLLDELETE(_posList);
 }
 
-bool MultipleTermPositions::next() {
+void MultipleTermPositions::requeueCurrent(const int32_t target) {
+	// positions that were not read are skipped lazily by the term positions
+	for (size_t i = 0; i < _current.size(); i++) {
+		TermPositions* tp = _current[i];
+		if (target > tp->doc() ? tp->skipTo(target) : tp->next())
+			_termPositionsQueue->put(tp);
+		else {
+			tp->close();
+			_CLLDELETE(tp);
+		}
+	}
+	_current.clear();
+}
+
+bool MultipleTermPositions::popCurrent() {
 	if (_termPositionsQueue->size() == 0)
 		return false;
 
 	_posList->clear();
+	_positionsLoaded = false;
 	_doc = _termPositionsQueue->peek()->doc();
+	_freq = 0;
 
-	TermPositions* tp;
 	do {
-		tp = _termPositionsQueue->peek();
-
-		for (int32_t i = 0; i < tp->freq(); i++)
-			_posList->add(tp->nextPosition());
-
-		if (tp->next())
-			_termPositionsQueue->adjustTop();
-		else {
-			_termPositionsQueue->pop();
-			tp->close();
-			_CLLDELETE(tp);
-		}
+		TermPositions* tp = _termPositionsQueue->pop();
+		_freq += tp->freq();
+		_current.push_back(tp);
 	} while (_termPositionsQueue->size() > 0 && _termPositionsQueue->peek()->doc() == _doc);
 
-	_posList->sort();
-	_freq = _posList->size();
-
 	return true;
 }
 
+bool MultipleTermPositions::next() {
+	requeueCurrent(-1);
+	return popCurrent();
+}
+
 int32_t MultipleTermPositions::nextPosition() {
+	if (!_positionsLoaded) {
+		for (size_t i = 0; i < _current.size(); i++) {
+			TermPositions* tp = _current[i];
+			for (int32_t j = tp->freq(); j > 0; j--)
+				_posList->add(tp->nextPosition());
+		}
+		_posList->sort();
+		_positionsLoaded = true;
+	}
 	return _posList->next();
 }
 
 bool MultipleTermPositions::skipTo(int32_t target) {
+	requeueCurrent(target);
 	while (_termPositionsQueue->peek() != NULL && target > _termPositionsQueue->peek()->doc()) {
 		TermPositions* tp = _termPositionsQueue->pop();
 		if (tp->skipTo(target))
@@ -179,7 +202,7 @@ bool MultipleTermPositions::skipTo(int32_t target) {
 			_CLLDELETE(tp);
 		}
 	}
-	return next();
+	return popCurrent();
 }
 
 int32_t MultipleTermPositions::doc() const {
@@ -190,7 +213,16 @@ int32_t MultipleTermPositions::freq() const {
 	return _freq;
 }
 
+int32_t MultipleTermPositions::docFreq() const {
+	return _docFreq;
+}
+
 void MultipleTermPositions::close() {
+	for (size_t i = 0; i < _current.size(); i++) {
+		_current[i]->close();
+		_CLLDELETE(_current[i]);
+	}
+	_current.clear();
 	while (_termPositionsQueue->size() > 0) {
 		TermPositions* tp = _termPositionsQueue->pop();
 		tp->close();
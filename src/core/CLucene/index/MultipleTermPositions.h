@@ -11,12 +11,19 @@
 
 #include "Terms.h"
 #include "CLucene/util/Array.h"
+#include <vector>
 
 CL_NS_DEF(index)
 
 class Term;
 class IndexReader;
 
+/**
+* Merges the positions of several terms as if they were a single term.
+* The positions of a document are only read, and merged, when
+* {@link #nextPosition()} is first called on it, so documents that are
+* only iterated through cost no .prx reads.
+*/
 class CLUCENE_EXPORT MultipleTermPositions : public TermPositions {
 private:
 	class TermPositionsQueue;
@@ -24,8 +31,16 @@ private:
 
 	int32_t _doc;
 	int32_t _freq;
+	int32_t _docFreq; //the sum of the terms' docFreq, or -1
 	TermPositionsQueue* _termPositionsQueue;
 	IntQueue* _posList;
+	std::vector<TermPositions*> _current; //the term positions on _doc, taken out of the queue
+	bool _positionsLoaded;
+
+	/** Advances the term positions of the current document and puts them back in the queue. */
+	void requeueCurrent(const int32_t target);
+	/** Takes the term positions of the lowest document out of the queue. */
+	bool popCurrent();
 
 public:
 	/**
@@ -46,6 +61,9 @@ public:
 
 	int32_t freq() const;
 
+	/** The sum of the number of documents each term is in */
+	int32_t docFreq() const;
+
 	void close();
 
 	/**
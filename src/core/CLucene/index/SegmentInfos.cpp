@@ -132,6 +132,12 @@ SegmentInfo::SegmentInfo(CL_NS(store)::Directory* _dir, int32_t format, CL_NS(st
         }
         isCompoundFile = input->readByte();
         preLockless = (isCompoundFile == CHECK_DIR);
+        if (format <= SegmentInfos::FORMAT_INDEX_SORT)
+        {
+            wchar_t* sort = input->readString();
+            indexSort = sort;
+            _CLDELETE_CARRAY(sort);
+        }
     }
     else
     {
@@ -174,6 +180,7 @@ void SegmentInfo::reset(const SegmentInfo* src)
     }
     isCompoundFile = src->isCompoundFile;
     hasSingleNormFile = src->hasSingleNormFile;
+    indexSort = src->indexSort;
 }
 
 SegmentInfo::~SegmentInfo()
@@ -433,6 +440,7 @@ SegmentInfo* SegmentInfo::clone()
     si->docStoreOffset = docStoreOffset;
     si->docStoreSegment = docStoreSegment;
     si->docStoreIsCompoundFile = docStoreIsCompoundFile;
+    si->indexSort = indexSort;
 
     return si;
 }
@@ -628,6 +636,16 @@ void SegmentInfo::setDocStoreOffset(const int32_t offset)
     clearFiles();
 }
 
+const std::wstring& SegmentInfo::getIndexSort() const
+{
+    return indexSort;
+}
+
+void SegmentInfo::setIndexSort(const std::wstring& sort)
+{
+    indexSort = sort;
+}
+
 void SegmentInfo::write(CL_NS(store)::IndexOutput* output)
 {
     output->writeString(name);
@@ -654,6 +672,7 @@ void SegmentInfo::write(CL_NS(store)::IndexOutput* output)
         }
     }
     output->writeByte(isCompoundFile);
+    output->writeString(indexSort);
 }
 
 void SegmentInfo::clearFiles()
@@ -20,10 +20,14 @@
 #include "_CompoundFile.h"
 #include "_SkipListWriter.h"
 #include "CLucene/document/FieldSelector.h"
+#include "_IndexSorter.h"
+#include "CLucene/search/Similarity.h"
+#include <algorithm>
 
 CL_NS_USE(util)
 CL_NS_USE(document)
 CL_NS_USE(store)
+CL_NS_USE(search)
 CL_NS_DEF(index)
 
 const uint8_t SegmentMerger::NORMS_HEADER[] = {'N','R','M', (uint8_t)-1};
@@ -39,6 +43,11 @@ void SegmentMerger::init(){
   fieldInfos       = NULL;
   checkAbort       = NULL;
   skipInterval     = 0;
+  maxSkipLevels    = 0;
+  impactTierWriter = NULL;
+  impactTierSize   = 0;
+  sorter           = NULL;
+  oneMerge         = NULL;
 }
 
 SegmentMerger::SegmentMerger(IndexWriter* writer, const wchar_t * name, MergePolicy::OneMerge* merge){
@@ -52,11 +61,19 @@ SegmentMerger::SegmentMerger(IndexWriter* writer, const wchar_t * name, MergePol
   this->init();
   this->directory		   = writer->getDirectory();
   this->segment        = name;
-  if (merge != NULL)
+  if (merge != NULL){
     this->checkAbort = _CLNEW CheckAbort(merge, directory);
+    // documents are sorted by the merges of the writer, not by addIndexes
+    if (merge->mergeDocStores)
+      this->sorter = writer->getIndexSorter();
+    this->oneMerge = merge;
+  }
   this->termIndexInterval= writer->getTermIndexInterval();
+  this->skipInterval = writer->getSkipInterval();
+  this->storedFieldsCodec = (uint8_t)writer->getStoredFieldsCompression();
   this->mergedDocs = 0;
-  this->maxSkipLevels = 0;
+  this->maxSkipLevels = writer->getMaxSkipLevels();
+  this->impactTierSize = writer->getImpactTierSize();
 }
 
 SegmentMerger::~SegmentMerger(){
@@ -92,6 +109,8 @@ SegmentMerger::~SegmentMerger(){
 
   _CLDELETE(checkAbort);
   _CLDELETE(skipListWriter);
+  for (size_t i = 0; i < sortedDocMaps.size(); i++)
+    _CLDELETE_ARRAY(sortedDocMaps[i]);
 
 }
 
@@ -128,6 +147,22 @@ int32_t SegmentMerger::merge(bool mergeDocStores) {
   // IndexWriter.close(false) takes to actually stop the
   // threads.
 
+  if (sorter != NULL && readers.size() > 0) {
+    // the deletes committed after the merge started are mapped
+    // through oneMerge->sortedDocs, see IndexWriter::commitMerge
+    sortedDocs.resize(sorter->sort(&readers[0], (int32_t)readers.size(), sortedDocMaps, oneMerge->sortedDocs));
+    for (size_t r = 0; r < readers.size(); r++) {
+      const int32_t maxDoc = readers[r]->maxDoc();
+      for (int32_t doc = 0; doc < maxDoc; doc++) {
+        const int32_t newDoc = sortedDocMaps[r][doc];
+        if (newDoc == -1)
+          continue;
+        sortedDocs[newDoc].reader = (int32_t)r;
+        sortedDocs[newDoc].doc = doc;
+      }
+    }
+  }
+
   mergedDocs = mergeFields();
 
 	mergeTerms();
@@ -174,6 +209,14 @@ void SegmentMerger::createCompoundFile(const wchar_t * filename, std::vector<std
 		}
 	}
 
+  // Term k-gram index
+  if (fieldInfos->hasTermGrams())
+    files->push_back ( segment + L"." + IndexFileNames::TERM_GRAMS_EXTENSION );
+
+  // Impact tiers
+  if (fieldInfos->hasImpactTiers())
+    files->push_back ( segment + L"." + IndexFileNames::IMPACT_TIERS_EXTENSION );
+
   // Vector files
   if ( mergeDocStores && fieldInfos->hasVectors()) {
     for (int32_t i = 0; i < IndexFileNames::VECTOR_EXTENSIONS().length; i++) {
@@ -253,9 +296,13 @@ int32_t SegmentMerger::mergeFields() {
       SegmentReader* segmentReader = (SegmentReader*) reader;
       for (size_t j = 0; j < segmentReader->getFieldInfos()->size(); j++) {
         FieldInfo* fi = segmentReader->getFieldInfos()->fieldInfo(j);
-        fieldInfos->add(fi->name, fi->isIndexed, fi->storeTermVector,
+        FieldInfo* merged = fieldInfos->add(fi->name, fi->isIndexed, fi->storeTermVector,
           fi->storePositionWithTermVector, fi->storeOffsetWithTermVector,
           !reader->hasNorms(fi->name), fi->storePayloads);
+        if (fi->indexTermGrams)
+          merged->indexTermGrams = true;
+        if (fi->impactTiers)
+          merged->impactTiers = true;
       }
     } else {
 	    StringArrayWithDeletor tmp;
@@ -322,9 +369,22 @@ int32_t SegmentMerger::mergeFields() {
     ValueArray<int32_t> rawDocLengths(MAX_RAW_MERGE_DOCS);
 
     // merge field values
-    FieldsWriter fieldsWriter(directory, segment.c_str(), fieldInfos);
+    FieldsWriter fieldsWriter(directory, segment.c_str(), fieldInfos, storedFieldsCodec);
 
     try {
+      if (sorter != NULL) {
+        // documents move, so none of them is copied raw
+        Document doc;
+        FieldSelectorMerge fieldSelectorMerge;
+        for (size_t i = 0; i < sortedDocs.size(); i++) {
+          doc.clear();
+          readers[sortedDocs[i].reader]->document(sortedDocs[i].doc, doc, &fieldSelectorMerge);
+          fieldsWriter.addDocument(&doc);
+          docCount++;
+          if (checkAbort != NULL)
+            checkAbort->work(300);
+        }
+      } else
       for (size_t i = 0; i < readers.size(); i++) {
         IndexReader* reader = readers[i];
         SegmentReader* matchingSegmentReader = matchingSegmentReaders[i];
@@ -333,6 +393,11 @@ int32_t SegmentMerger::mergeFields() {
           matchingFieldsReader = matchingSegmentReader->getFieldsReader();
         else
           matchingFieldsReader = NULL;
+        // documents of compressed chunks are merged one by one
+        if (matchingFieldsReader != NULL && !matchingFieldsReader->canReadRawDocs()) {
+          matchingSegmentReader = NULL;
+          matchingFieldsReader = NULL;
+        }
         const int32_t maxDoc = reader->maxDoc();
         Document doc;
         FieldSelectorMerge fieldSelectorMerge;
@@ -371,7 +436,7 @@ int32_t SegmentMerger::mergeFields() {
       fieldsWriter.close();
     )
 
-    CND_PRECONDITION (docCount*8 == directory->fileLength( (segment + L"." + IndexFileNames::FIELDS_INDEX_EXTENSION).c_str() ),
+    CND_PRECONDITION (fieldsWriter.indexLength(docCount) == directory->fileLength( (segment + L"." + IndexFileNames::FIELDS_INDEX_EXTENSION).c_str() ),
     (std::wstring(L"after mergeFields: fdx size mismatch: ") + Misc::toString(docCount) + L" docs vs " + Misc::toString(directory->fileLength( (segment + L"." + IndexFileNames::FIELDS_INDEX_EXTENSION).c_str() )) + L" length in bytes of " + segment + L"." + IndexFileNames::FIELDS_INDEX_EXTENSION).c_str() );
 
   } else{
@@ -390,6 +455,15 @@ void SegmentMerger::mergeVectors(){
 		_CLNEW TermVectorsWriter(directory, segment.c_str(), fieldInfos);
 
 	try {
+		if (sorter != NULL) {
+			for (size_t i = 0; i < sortedDocs.size(); i++) {
+				ArrayBase<TermFreqVector*>* tmp = readers[sortedDocs[i].reader]->getTermFreqVectors(sortedDocs[i].doc);
+				termVectorsWriter->addAllDocVectors(tmp);
+				_CLLDELETE(tmp);
+				if (checkAbort != NULL)
+					checkAbort->work(300);
+			}
+		} else
 		for (uint32_t r = 0; r < readers.size(); r++) {
 			IndexReader* reader = readers[r];
 			int32_t maxDoc = reader->maxDoc();
@@ -436,7 +510,8 @@ void SegmentMerger::mergeTerms() {
 
       //Instantiate  a new termInfosWriter which will write in directory
       //for the segment name segment using the new merged fieldInfos
-      termInfosWriter = _CLNEW TermInfosWriter(directory, segment.c_str(), fieldInfos, termIndexInterval);
+      termInfosWriter = _CLNEW TermInfosWriter(directory, segment.c_str(), fieldInfos, termIndexInterval,
+          skipInterval, maxSkipLevels);
 
       //Condition check to see if termInfosWriter points to a valid instance
       CND_CONDITION(termInfosWriter != NULL,L"Memory allocation for termInfosWriter failed")	;
@@ -444,6 +519,8 @@ void SegmentMerger::mergeTerms() {
       skipInterval = termInfosWriter->skipInterval;
       maxSkipLevels = termInfosWriter->maxSkipLevels;
       skipListWriter = _CLNEW DefaultSkipListWriter(skipInterval, maxSkipLevels, mergedDocs, freqOutput, proxOutput);
+      if (fieldInfos->hasImpactTiers())
+        impactTierWriter = _CLNEW ImpactTierWriter(directory, segment.c_str(), impactTierSize);
       queue = _CLNEW SegmentMergeQueue(readers.size());
 
       //And merge the Term Infos
@@ -461,6 +538,10 @@ void SegmentMerger::mergeTerms() {
         termInfosWriter->close();
         _CLDELETE(termInfosWriter);
       }
+      if ( impactTierWriter != NULL ){
+        impactTierWriter->close();
+        _CLDELETE(impactTierWriter);
+      }
       if ( queue != NULL ){
         queue->close();
         _CLDELETE(queue);
@@ -606,6 +687,9 @@ int32_t SegmentMerger::mergeTermInfo( SegmentMergeInfo** smis, int32_t n){
     CND_PRECONDITION(smis[0]->term != NULL, L"smis[0]->term is NULL");
     //Write a new TermInfo
     termInfosWriter->add(smis[0]->term, &termInfo);
+
+    if (!impactPostings.empty())
+      impactTierWriter->add(fieldInfos->fieldNumber(smis[0]->term->field()), smis[0]->term->text(), impactPostings);
   }
   return df;
 }
@@ -625,11 +709,16 @@ int32_t SegmentMerger::appendPostings(SegmentMergeInfo** smis, int32_t n){
   CND_PRECONDITION(freqOutput != NULL, L"freqOutput is NULL");
   CND_PRECONDITION(proxOutput != NULL, L"proxOutput is NULL");
 
+  impactPostings.clear();
+  if (sorter != NULL)
+    return appendSortedPostings(smis, n);
+
   int32_t lastDoc = 0;
   int32_t df = 0;       //Document Counter
 
   skipListWriter->resetSkip();
   bool storePayloads = fieldInfos->fieldInfo(smis[0]->term->field())->storePayloads;
+  const bool recordImpacts = wantsImpacts(smis, n);
   int32_t lastPayloadLength = -1;   // ensures that we write the first length
 
   SegmentMergeInfo* smi = NULL;
@@ -649,10 +738,12 @@ int32_t SegmentMerger::appendPostings(SegmentMergeInfo** smis, int32_t n){
     int32_t base = smi->base;
     //Get the docMap so we can see which documents have been deleted
     int32_t* docMap = smi->getDocMap();
+    const uint8_t* norms = recordImpacts ? impactNorms(smi) : NULL;
     //Seek the termpost
     postings->seek(smi->termEnum);
     while (postings->next()) {
       int32_t doc = postings->doc();
+      const uint8_t norm = recordImpacts ? impactNorm(norms, doc) : 0;
       //Check if there are deletions
       if (docMap != NULL)
         doc = docMap[doc]; // map around deletions
@@ -678,6 +769,10 @@ int32_t SegmentMerger::appendPostings(SegmentMergeInfo** smis, int32_t n){
 
       //Get the frequency of the Term
       int32_t freq = postings->freq();
+      if (recordImpacts) {
+        const ImpactTierWriter::Posting impact = { doc, freq, norm };
+        impactPostings.push_back(impact);
+      }
       if (freq == 1){
         //write doc & freq=1
         freqOutput->writeVInt(docCode | 1);
@@ -725,6 +820,126 @@ int32_t SegmentMerger::appendPostings(SegmentMergeInfo** smis, int32_t n){
   return df;
 }
 
+int32_t SegmentMerger::appendSortedPostings(SegmentMergeInfo** smis, int32_t n){
+  bool storePayloads = fieldInfos->fieldInfo(smis[0]->term->field())->storePayloads;
+  const bool recordImpacts = wantsImpacts(smis, n);
+  sortedPostings.clear();
+  sortedPositions.clear();
+  sortedPayloads.clear();
+
+  for (int32_t i = 0; i < n; i++) {
+    SegmentMergeInfo* smi = smis[i];
+    size_t r = 0;
+    while (readers[r] != smi->reader)
+      r++;
+    const int32_t* docMap = sortedDocMaps[r];
+    const uint8_t* norms = recordImpacts ? impactNorms(smi) : NULL;
+
+    TermPositions* postings = smi->getPositions();
+    postings->seek(smi->termEnum);
+    while (postings->next()) {
+      const int32_t doc = docMap[postings->doc()];
+      if (doc < 0)
+        continue;                               // deleted
+      SortedPosting posting;
+      posting.doc = doc;
+      posting.freq = postings->freq();
+      if (recordImpacts) {
+        const ImpactTierWriter::Posting impact = { doc, posting.freq, impactNorm(norms, postings->doc()) };
+        impactPostings.push_back(impact);
+      }
+      posting.positions = sortedPositions.size();
+      posting.payload = sortedPayloads.size();
+      for (int32_t j = 0; j < posting.freq; j++) {
+        sortedPositions.push_back(postings->nextPosition());
+        int32_t payloadLength = 0;
+        if (storePayloads) {
+          payloadLength = postings->getPayloadLength();
+          if (payloadLength > 0) {
+            const size_t start = sortedPayloads.size();
+            sortedPayloads.resize(start + payloadLength);
+            postings->getPayload(&sortedPayloads[start]);
+          }
+        }
+        sortedPositions.push_back(payloadLength);
+      }
+      sortedPostings.push_back(posting);
+    }
+  }
+  std::sort(sortedPostings.begin(), sortedPostings.end());
+
+  // written as appendPostings writes them
+  int32_t lastDoc = 0;
+  int32_t df = 0;
+  skipListWriter->resetSkip();
+  int32_t lastPayloadLength = -1;
+  for (size_t i = 0; i < sortedPostings.size(); i++) {
+    const SortedPosting& posting = sortedPostings[i];
+    const int32_t doc = posting.doc;
+    df++;
+
+    if ((df % skipInterval) == 0) {
+      skipListWriter->setSkipData(lastDoc, storePayloads, lastPayloadLength);
+      skipListWriter->bufferSkip(df);
+    }
+
+    const int32_t docCode = (doc - lastDoc) << 1;
+    lastDoc = doc;
+    if (posting.freq == 1){
+      freqOutput->writeVInt(docCode | 1);
+    }else{
+      freqOutput->writeVInt(docCode);
+      freqOutput->writeVInt(posting.freq);
+    }
+
+    int32_t lastPosition = 0;
+    size_t payload = posting.payload;
+    for (int32_t j = 0; j < posting.freq; j++) {
+      const int32_t position = sortedPositions[posting.positions + 2*j];
+      const int32_t delta = position - lastPosition;
+      if (storePayloads) {
+        const int32_t payloadLength = sortedPositions[posting.positions + 2*j + 1];
+        if (payloadLength == lastPayloadLength) {
+          proxOutput->writeVInt(delta * 2);
+        } else {
+          proxOutput->writeVInt(delta * 2 + 1);
+          proxOutput->writeVInt(payloadLength);
+          lastPayloadLength = payloadLength;
+        }
+        if (payloadLength > 0) {
+          proxOutput->writeBytes(&sortedPayloads[payload], payloadLength);
+          payload += payloadLength;
+        }
+      } else {
+        proxOutput->writeVInt(delta);
+      }
+      lastPosition = position;
+    }
+  }
+  return df;
+}
+
+bool SegmentMerger::wantsImpacts(SegmentMergeInfo** smis, int32_t n){
+  if (impactTierWriter == NULL || !fieldInfos->fieldInfo(smis[0]->term->field())->impactTiers)
+    return false;
+  int32_t docFreq = 0;                          // before deletions
+  for (int32_t i = 0; i < n; i++)
+    docFreq += smis[i]->termEnum->docFreq();
+  return impactTierWriter->wants(docFreq);
+}
+
+const uint8_t* SegmentMerger::impactNorms(SegmentMergeInfo* smi){
+  // the norms the merged segment will have
+  if (fieldInfos->fieldInfo(smi->term->field())->omitNorms)
+    return NULL;
+  return smi->reader->norms(smi->term->field());
+}
+
+uint8_t SegmentMerger::impactNorm(const uint8_t* norms, int32_t doc){
+  // readers without norms for the field score as if every norm was 1
+  return norms != NULL ? norms[doc] : Similarity::encodeNorm(1.0f);
+}
+
 void SegmentMerger::mergeNorms() {
 //Func - Merges the norms for all fields
 //Pre  - fieldInfos != NULL
@@ -736,6 +951,9 @@ void SegmentMerger::mergeNorms() {
     CND_PRECONDITION(fieldInfos != NULL, L"fieldInfos is NULL");
 
 	  IndexReader* reader  = NULL;
+	  ValueArray<uint8_t> sortedNorms;
+	  if (sorter != NULL)
+	    sortedNorms.resize(mergedDocs);
 
 	  //iterate through all the Field Infos instances
     for (size_t i = 0; i < fieldInfos->size(); i++) {
@@ -770,7 +988,14 @@ void SegmentMerger::mergeNorms() {
 			    }
           reader->norms(fi->name, normBuffer.values);
 
-          if (!reader->hasDeletions()) {
+          if (sorter != NULL) {
+            // written once all the readers' norms are in place
+            const int32_t* docMap = sortedDocMaps[j];
+            for (size_t k = 0; k < maxDoc; k++) {
+              if (docMap[k] != -1)
+                sortedNorms.values[docMap[k]] = normBuffer[k];
+            }
+          } else if (!reader->hasDeletions()) {
             //optimized case for segments without deleted docs
             output->writeBytes(normBuffer.values, maxDoc);
           } else {
@@ -788,6 +1013,8 @@ void SegmentMerger::mergeNorms() {
           if (checkAbort != NULL)
             checkAbort->work(maxDoc);
 		    }
+        if (sorter != NULL)
+          output->writeBytes(sortedNorms.values, mergedDocs);
 	    }
 	  }
   }_CLFINALLY(
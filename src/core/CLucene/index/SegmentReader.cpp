@@ -14,6 +14,8 @@
 #include "_FieldsReader.h"
 #include "IndexReader.h"
 #include "_TermInfosReader.h"
+#include "_TermGramIndex.h"
+#include "_ImpactTiers.h"
 #include "Terms.h"
 #include "CLucene/search/Similarity.h"
 #include "CLucene/store/FSDirectory.h"
@@ -35,7 +37,8 @@ SegmentReader::Norm::Norm(IndexInput* instrm, bool _useSingleNormStream, int32_t
     useSingleNormStream(_useSingleNormStream),
     in(instrm),
     bytes(NULL),
-    dirty(false)
+    dirty(false),
+    mapped(false)
 {
     //Func - Constructor
     //Pre  - instrm is a valid reference to an IndexInput
@@ -58,8 +61,9 @@ SegmentReader::Norm::~Norm()
     if (in != _this->singleNormStream)
         _CLDELETE(in);
 
-    //Delete the bytes array
-    _CLDELETE_ARRAY(bytes);
+    //Delete the bytes array, unless it belongs to the mapped file
+    if (!mapped)
+        _CLDELETE_ARRAY(bytes);
 
 }
 void SegmentReader::Norm::doDelete(Norm* norm)
@@ -142,6 +146,9 @@ void SegmentReader::initialize(SegmentInfo* si, int32_t readBufferSize, bool doO
     this->termVectorsReaderOrig = NULL;
     this->_fieldInfos = NULL;
     this->tis = NULL;
+    this->termGrams = NULL;
+    this->impactTiers = NULL;
+    this->skipCache = NULL;
     this->fieldsReader = NULL;
     this->cfsReader = NULL;
     this->storeCFSReader = NULL;
@@ -217,6 +224,11 @@ void SegmentReader::initialize(SegmentInfo* si, int32_t readBufferSize, bool doO
         }
 
         tis = _CLNEW TermInfosReader(cfsDir, segment.c_str(), _fieldInfos, readBufferSize);
+        if (_fieldInfos->hasTermGrams())
+            termGrams = _CLNEW TermGramReader(cfsDir, segment.c_str(), readBufferSize);
+        // flushed segments have no tiers, only merged ones
+        if (_fieldInfos->hasImpactTiers() && cfsDir->fileExists((segment + L"." + IndexFileNames::IMPACT_TIERS_EXTENSION).c_str()))
+            impactTiers = _CLNEW ImpactTierReader(cfsDir, segment.c_str(), readBufferSize);
 
         loadDeletedDocs();
 
@@ -296,6 +308,9 @@ SegmentReader::~SegmentReader()
     _CLDELETE(_fieldInfos);
     _CLDELETE(fieldsReader);
     _CLDELETE(tis);
+    _CLDELETE(termGrams);
+    _CLDELETE(impactTiers);
+    _CLDELETE(skipCache);
     _CLDELETE(freqStream);
     _CLDELETE(proxStream);
     _CLDELETE(deletedDocs);
@@ -371,6 +386,20 @@ void SegmentReader::doClose()
         _CLDELETE(tis);
     }
 
+    if (termGrams != NULL)
+    {
+        termGrams->close();
+        _CLDELETE(termGrams);
+    }
+
+    if (impactTiers != NULL)
+    {
+        impactTiers->close();
+        _CLDELETE(impactTiers);
+    }
+
+    _CLDELETE(skipCache);
+
     //Close the frequency stream
     if (freqStream != NULL)
     {
@@ -510,6 +539,39 @@ TermEnum* SegmentReader::terms(const Term* t)
     return tis->terms(t);
 }
 
+bool SegmentReader::getTermGramCandidates(const wchar_t* field, const std::vector<std::wstring>& substrings,
+    std::vector<std::wstring>& candidates)
+{
+    ensureOpen();
+    FieldInfo* fi = _fieldInfos->fieldInfo(field);
+    if (fi == NULL || !fi->isIndexed)
+    {
+        // no terms to narrow down, but nothing to scan either
+        return true;
+    }
+    if (!fi->indexTermGrams || termGrams == NULL)
+        return false;
+    return termGrams->getCandidates(fi->number, substrings, candidates);
+}
+
+const ImpactTier* SegmentReader::getImpactTier(const Term* t)
+{
+    ensureOpen();
+    if (impactTiers == NULL)
+        return NULL;
+    FieldInfo* fi = _fieldInfos->fieldInfo(t->field());
+    if (fi == NULL || !fi->impactTiers)
+        return NULL;
+
+    // the bounds of the tiers hold for the norms they were written with
+    if (si->hasSeparateNorms(fi->number))
+        return NULL;
+    Norm* norm = _norms.get(t->field());
+    if (norm != NULL && norm->dirty)
+        return NULL;
+    return impactTiers->get(fi->number, t->text());
+}
+
 bool SegmentReader::document(int32_t n, Document& doc, const FieldSelector* fieldSelector)
 {
     //Func - writes the fields of document n into doc
@@ -534,6 +596,45 @@ bool SegmentReader::document(int32_t n, Document& doc, const FieldSelector* fiel
 }
 
 
+void SegmentReader::visitDocument(const int32_t n, StoredFieldVisitor* visitor)
+{
+    SCOPED_LOCK_MUTEX(THIS_LOCK)
+
+        ensureOpen();
+
+    CND_PRECONDITION(n >= 0, L"n is a negative number");
+    if (isDeleted(n))
+    {
+        _CLTHROWA(CL_ERR_InvalidState, "attempt to access a deleted document");
+    }
+
+    fieldsReader->visitDocument(n, visitor);
+}
+
+void SegmentReader::documents(const int32_t* docs, const int32_t count, Document** result, const FieldSelector* fieldSelector)
+{
+    if (count <= 0)
+        return;
+    std::vector<int32_t> sortedDocs;
+    std::vector<Document*> sortedResult;
+    sortDocuments(docs, count, result, sortedDocs, sortedResult);
+
+    SCOPED_LOCK_MUTEX(THIS_LOCK)
+
+        ensureOpen();
+
+    for (int32_t i = 0; i < count; i++)
+    {
+        CND_PRECONDITION(sortedDocs[i] >= 0, L"n is a negative number");
+        if (isDeleted(sortedDocs[i]))
+        {
+            _CLTHROWA(CL_ERR_InvalidState, "attempt to access a deleted document");
+        }
+    }
+
+    fieldsReader->docs(&sortedDocs[0], count, &sortedResult[0], fieldSelector);
+}
+
 bool SegmentReader::isDeleted(const int32_t n)
 {
     //Func - Checks if the n-th document has been marked deleted
@@ -639,6 +740,36 @@ int32_t SegmentReader::getTermInfosIndexDivisor()
     return tis->getIndexDivisor();
 }
 
+void SegmentReader::setSkipListCache(const size_t maxBytes, const int32_t minDocFreq)
+{
+    SCOPED_LOCK_MUTEX(THIS_LOCK)
+    if (skipCache != NULL && skipCache->getMaxBytes() == maxBytes && skipCache->getMinDocFreq() == minDocFreq)
+        return;
+    _CLDELETE(skipCache);
+    if (maxBytes > 0)
+        skipCache = _CLNEW SkipListCache(maxBytes, minDocFreq);
+}
+
+size_t SegmentReader::getSkipListCacheSize()
+{
+    return skipCache == NULL ? 0 : skipCache->getMaxBytes();
+}
+
+int32_t SegmentReader::getSkipListCacheMinDocFreq()
+{
+    return skipCache == NULL ? DEFAULT_SKIP_LIST_CACHE_MIN_DOCFREQ : skipCache->getMinDocFreq();
+}
+
+SkipListCache* SegmentReader::getSkipListCache() const
+{
+    return skipCache;
+}
+
+const wchar_t* SegmentReader::getIndexSort() const
+{
+    return si->getIndexSort().empty() ? NULL : si->getIndexSort().c_str();
+}
+
 
 void SegmentReader::getFieldNames(FieldOption fldOption, StringArrayWithDeletor& retarray)
 {
@@ -764,6 +895,17 @@ uint8_t* SegmentReader::getNorms(const wchar_t* field)
         SCOPED_LOCK_MUTEX(norm->THIS_LOCK)
             if (norm->bytes == NULL)
             {                     // value not yet read
+                // if the norms file is mapped, use the bytes in place. The
+                // stream stays open for as long as the norm uses the mapping.
+                IndexInput* normStream = norm->useSingleNormStream ? singleNormStream : norm->in;
+                const uint8_t* mappedBytes = normStream->getMappedBytes(norm->normSeek, maxDoc());
+                if (mappedBytes != NULL)
+                {
+                    norm->bytes = const_cast<uint8_t*>(mappedBytes);
+                    norm->mapped = true;
+                    return norm->bytes;
+                }
+
                 uint8_t* bytes = _CL_NEWARRAY(uint8_t, maxDoc());
                 norms(field, bytes);
                 norm->bytes = bytes;                         // cache it
@@ -810,7 +952,7 @@ DirectoryIndexReader* SegmentReader::doReopen(SegmentInfos* infos)
     {
         ValueArray<IndexReader*> readers(1);
         readers.values[0] = this;
-        return _CLNEW MultiSegmentReader(_directory, infos, closeDirectory, &readers, NULL, NULL);
+        return _CLNEW MultiSegmentReader(_directory, infos, closeDirectory, &readers);
     }
 
     return newReader;
@@ -843,6 +985,16 @@ void SegmentReader::doSetNorm(int32_t doc, const wchar_t* field, uint8_t value)
     normsDirty = true;
 
     uint8_t* bits = norms(field);
+    if (norm->mapped)
+    {
+        // the mapped file is read only: copy the norms before changing them
+        SCOPED_LOCK_MUTEX(norm->THIS_LOCK)
+        bits = _CL_NEWARRAY(uint8_t, maxDoc());
+        memcpy(bits, norm->bytes, maxDoc());
+        norm->bytes = bits;
+        norm->mapped = false;
+        norm->close();
+    }
     bits[doc] = value;                    // set the value
 }
 
@@ -1065,6 +1217,9 @@ SegmentReader* SegmentReader::reopenSegment(SegmentInfo* si)
         clone->storeCFSReader = storeCFSReader;
         clone->_fieldInfos = _fieldInfos;
         clone->tis = tis;
+        clone->termGrams = termGrams;
+        clone->impactTiers = impactTiers;
+        clone->skipCache = skipCache;
         clone->freqStream = freqStream;
         clone->proxStream = proxStream;
         clone->termVectorsReaderOrig = termVectorsReaderOrig;
@@ -1111,6 +1266,10 @@ SegmentReader* SegmentReader::reopenSegment(SegmentInfo* si)
             clone->deletedDocs = this->deletedDocs;
         }
 
+        // the .nrm file of a segment never changes, so the clone takes over the
+        // stream, and with it the mapping that unchanged norms may point into
+        clone->singleNormStream = singleNormStream;
+
         if (!normsUpToDate)
         {
             // load norms
@@ -1181,6 +1340,9 @@ SegmentReader* SegmentReader::reopenSegment(SegmentInfo* si)
         this->freqStream = NULL;
     this->_fieldInfos = NULL;
     this->tis = NULL;
+    this->termGrams = NULL;
+    this->impactTiers = NULL;
+    this->skipCache = NULL;
     this->deletedDocs = NULL;
     this->ones = NULL;
     this->termVectorsReaderOrig = NULL;
@@ -17,7 +17,7 @@ CL_NS_DEF(index)
 
   SegmentTermDocs::SegmentTermDocs(const SegmentReader* _parent) : parent(_parent),freqStream(_parent->freqStream->clone()),
 		count(0),df(0),deletedDocs(_parent->deletedDocs),_doc(0),_freq(0),skipInterval(_parent->tis->getSkipInterval()),
-		maxSkipLevels(_parent->tis->getMaxSkipLevels()),skipListReader(NULL),freqBasePointer(0),proxBasePointer(0),
+		maxSkipLevels(_parent->tis->getMaxSkipLevels()),skipListReader(NULL),decodedSkipList(NULL),skipEntry(-1),freqBasePointer(0),proxBasePointer(0),
 		skipPointer(0),haveSkipped(false)
 	{
       CND_CONDITION(_parent != NULL,L"Parent is NULL");
@@ -75,6 +75,7 @@ CL_NS_DEF(index)
   void SegmentTermDocs::close() {
 	  _CLDELETE( freqStream );
 	  _CLDELETE( skipListReader );
+	  _CLDECDELETE( decodedSkipList );
   }
 
   int32_t SegmentTermDocs::doc()const { 
@@ -83,6 +84,9 @@ CL_NS_DEF(index)
   int32_t SegmentTermDocs::freq()const { 
 	  return _freq; 
   }
+  int32_t SegmentTermDocs::docFreq()const { 
+	  return df; 
+  }
 
   bool SegmentTermDocs::next() {
     while (true) {
@@ -137,16 +141,40 @@ CL_NS_DEF(index)
 	  if (!haveSkipped) {                          // lazily initialize skip stream
 		  skipListReader->init(skipPointer, freqBasePointer, proxBasePointer, df, currentFieldStoresPayloads);
 		  haveSkipped = true;
-	  }
 
-      int32_t newCount = skipListReader->skipTo(target); 
-      if (newCount > count) {
-        freqStream->seek(skipListReader->getFreqPointer());
-        skipProx(skipListReader->getProxPointer(), skipListReader->getPayloadLength());
+		  // the skip lists of common terms are decoded once per segment
+		  _CLDECDELETE(decodedSkipList);
+		  SkipListCache* skipCache = parent->skipCache;
+		  if (skipCache != NULL && df >= skipCache->getMinDocFreq()) {
+			  decodedSkipList = skipCache->get(skipPointer);
+			  if (decodedSkipList == NULL) {
+				  decodedSkipList = skipListReader->decode();
+				  skipCache->put(skipPointer, decodedSkipList);
+			  }
+			  skipEntry = -1;
+		  }
+	  }
 
-        _doc = skipListReader->getDoc();
-        count = newCount;
-      }      
+      if (decodedSkipList != NULL) {
+        skipEntry = decodedSkipList->find(target, skipEntry);
+        int32_t newCount = (skipEntry + 1) * skipInterval - 1;
+        if (newCount > count) {
+          freqStream->seek(decodedSkipList->freqPointers[skipEntry]);
+          skipProx(decodedSkipList->proxPointers[skipEntry], decodedSkipList->payloadLengths[skipEntry]);
+
+          _doc = decodedSkipList->docs[skipEntry];
+          count = newCount;
+        }
+      } else {
+        int32_t newCount = skipListReader->skipTo(target); 
+        if (newCount > count) {
+          freqStream->seek(skipListReader->getFreqPointer());
+          skipProx(skipListReader->getProxPointer(), skipListReader->getPayloadLength());
+
+          _doc = skipListReader->getDoc();
+          count = newCount;
+        }
+      }
 	}
 
     // done skipping, now just scan
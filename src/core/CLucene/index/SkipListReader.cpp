@@ -8,10 +8,119 @@
 ------------------------------------------------------------------------------*/
 #include "CLucene/_ApiHeader.h"
 #include "_SkipListReader.h"
+#include <algorithm>
 
 CL_NS_USE(store)
 CL_NS_DEF(index)
 
+DecodedSkipList::DecodedSkipList(const int32_t _length) :
+    length(_length),
+    docs(_CL_NEWARRAY(int32_t, _length)),
+    freqPointers(_CL_NEWARRAY(int64_t, _length)),
+    proxPointers(_CL_NEWARRAY(int64_t, _length)),
+    payloadLengths(_CL_NEWARRAY(int32_t, _length))
+{
+}
+
+DecodedSkipList::~DecodedSkipList()
+{
+    _CLDELETE_LARRAY(docs);
+    _CLDELETE_LARRAY(freqPointers);
+    _CLDELETE_LARRAY(proxPointers);
+    _CLDELETE_LARRAY(payloadLengths);
+}
+
+int32_t DecodedSkipList::find(const int32_t target, const int32_t from) const
+{
+    const int32_t* next = std::lower_bound(docs + from + 1, docs + length, target);
+    const int32_t last = (int32_t) (next - docs) - 1;
+    return last > from ? last : from;
+}
+
+size_t DecodedSkipList::getSizeInBytes() const
+{
+    return sizeof(DecodedSkipList) + length * (2 * sizeof(int32_t) + 2 * sizeof(int64_t));
+}
+
+SkipListCache::SkipListCache(const size_t _maxBytes, const int32_t _minDocFreq) :
+    maxBytes(_maxBytes),
+    minDocFreq(_minDocFreq),
+    bytes(0),
+    hitCount(0),
+    missCount(0)
+{
+}
+
+SkipListCache::~SkipListCache()
+{
+    while (!entries.empty())
+        remove(entries.begin());
+}
+
+DecodedSkipList* SkipListCache::get(const int64_t skipPointer)
+{
+    SCOPED_LOCK_MUTEX(THIS_LOCK)
+    std::map<int64_t, EntryList::iterator>::iterator found = index.find(skipPointer);
+    if (found == index.end())
+    {
+        missCount++;
+        return NULL;
+    }
+    hitCount++;
+    entries.splice(entries.begin(), entries, found->second);
+    return _CL_POINTER(found->second->second);
+}
+
+void SkipListCache::put(const int64_t skipPointer, DecodedSkipList* list)
+{
+    const size_t listBytes = list->getSizeInBytes();
+    if (listBytes > maxBytes)
+        return;
+
+    SCOPED_LOCK_MUTEX(THIS_LOCK)
+    if (index.find(skipPointer) != index.end())     // decoded by another thread in the meantime
+        return;
+    entries.push_front(std::make_pair(skipPointer, _CL_POINTER(list)));
+    index[skipPointer] = entries.begin();
+    bytes += listBytes;
+    while (bytes > maxBytes)
+        remove(--entries.end());                    // least recently used
+}
+
+void SkipListCache::remove(EntryList::iterator entry)
+{
+    DecodedSkipList* list = entry->second;
+    bytes -= list->getSizeInBytes();
+    index.erase(entry->first);
+    entries.erase(entry);
+    _CLDECDELETE(list);
+}
+
+size_t SkipListCache::getMaxBytes() const
+{
+    return maxBytes;
+}
+int32_t SkipListCache::getMinDocFreq() const
+{
+    return minDocFreq;
+}
+size_t SkipListCache::size() const
+{
+    return index.size();
+}
+size_t SkipListCache::getSizeInBytes() const
+{
+    return bytes;
+}
+int64_t SkipListCache::getHitCount() const
+{
+    return hitCount;
+}
+int64_t SkipListCache::getMissCount() const
+{
+    return missCount;
+}
+
 MultiLevelSkipListReader::MultiLevelSkipListReader(IndexInput* _skipStream, const int32_t maxSkipLevels,
     const int32_t _skipInterval) :
     maxNumberOfSkipLevels(maxSkipLevels), numberOfLevelsToBuffer(1),
@@ -163,6 +272,26 @@ void MultiLevelSkipListReader::init(const int64_t _skipPointer, const int32_t df
     haveSkipped = false;
 }
 
+IndexInput* MultiLevelSkipListReader::seekLowestLevel(int32_t& entries)
+{
+    int32_t levels = (docCount == 0) ? 0 : (int32_t) floor(log((double) docCount) / log((double) skipInterval[0]));
+    if (levels > maxNumberOfSkipLevels)
+    {
+        levels = maxNumberOfSkipLevels;
+    }
+
+    // the upper levels come first, each after its length
+    skipStream[0]->seek(skipPointer[0]);
+    for (int32_t i = levels - 1; i > 0; i--)
+    {
+        const int64_t length = skipStream[0]->readVLong();
+        skipStream[0]->seek(skipStream[0]->getFilePointer() + length);
+    }
+
+    entries = docCount / skipInterval[0];
+    return skipStream[0];
+}
+
 void MultiLevelSkipListReader::loadSkipLevels()
 {
     numberOfSkipLevels = (docCount == 0) ? 0 : (int32_t) floor(log((double) docCount) / log((double) skipInterval[0]));
@@ -330,6 +459,24 @@ int32_t DefaultSkipListReader::getPayloadLength() const
     return lastPayloadLength;
 }
 
+DecodedSkipList* DefaultSkipListReader::decode()
+{
+    int32_t entries;
+    IndexInput* stream = seekLowestLevel(entries);
+
+    DecodedSkipList* list = _CLNEW DecodedSkipList(entries);
+    int32_t doc = 0;
+    for (int32_t i = 0; i < entries; i++)
+    {
+        doc += readSkipData(0, stream);
+        list->docs[i] = doc;
+        list->freqPointers[i] = freqPointer[0];
+        list->proxPointers[i] = proxPointer[0];
+        list->payloadLengths[i] = payloadLength[0];
+    }
+    return list;
+}
+
 void DefaultSkipListReader::seekChild(const int32_t level)
 {
     MultiLevelSkipListReader::seekChild(level);
@@ -0,0 +1,97 @@
+/*------------------------------------------------------------------------------
+* Copyright (C) 2003-2006 Ben van Klinken and the CLucene Team
+
+* Updated by https://github.com/farfella/.
+*
+* Distributable under the terms of either the Apache License (Version 2.0) or
+* the GNU Lesser General Public License, as specified in the COPYING file.
+------------------------------------------------------------------------------*/
+#include "CLucene/_ApiHeader.h"
+#include "StoredFieldVisitor.h"
+#include "CLucene/document/Document.h"
+#include "CLucene/document/Field.h"
+#include "CLucene/document/FieldSelector.h"
+
+CL_NS_USE(document)
+CL_NS_USE(util)
+CL_NS_DEF(index)
+
+StoredFieldVisitor::~StoredFieldVisitor(){
+}
+
+void StoredFieldVisitor::stringField(const wchar_t* /*field*/, const int /*config*/, const uint8_t* /*utf8*/, const int32_t /*length*/){
+}
+
+void StoredFieldVisitor::binaryField(const wchar_t* /*field*/, const int /*config*/, const uint8_t* /*value*/, const int32_t /*length*/){
+}
+
+int32_t StoredFieldVisitor::decode(const uint8_t* utf8, const int32_t length, wchar_t* result){
+	int32_t n = 0;
+	int32_t i = 0;
+	while (i < length) {
+		const uint8_t b = utf8[i++];
+		uint32_t c;
+		int32_t more;
+		if ((b & 0x80) == 0) {
+			c = b;
+			more = 0;
+		} else if ((b & 0xE0) == 0xC0) {
+			c = b & 0x1F;
+			more = 1;
+		} else if ((b & 0xF0) == 0xE0) {
+			c = b & 0x0F;
+			more = 2;
+		} else {
+			c = b & 0x07;
+			more = 3;
+		}
+		for (; more > 0 && i < length; more--)
+			c = (c << 6) | (utf8[i++] & 0x3F);
+		result[n++] = (wchar_t)c;
+	}
+	result[n] = 0;
+	return n;
+}
+
+
+DocumentStoredFieldVisitor::DocumentStoredFieldVisitor(Document* _doc, const FieldSelector* _fieldSelector):
+	doc(_doc), fieldSelector(_fieldSelector), stop(false)
+{
+}
+
+DocumentStoredFieldVisitor::~DocumentStoredFieldVisitor(){
+}
+
+StoredFieldVisitor::Status DocumentStoredFieldVisitor::needsField(const wchar_t* field){
+	if (stop)
+		return STOP;
+	if (fieldSelector == NULL)
+		return YES;
+
+	switch (fieldSelector->accept(field)) {
+	case FieldSelector::NO_LOAD:
+		return NO;
+	case FieldSelector::LOAD_AND_BREAK:
+	case FieldSelector::SIZE_AND_BREAK:
+		stop = true;
+		return YES;
+	default:
+		return YES;
+	}
+}
+
+void DocumentStoredFieldVisitor::stringField(const wchar_t* field, const int config, const uint8_t* utf8, const int32_t length){
+	wchar_t* value = _CL_NEWARRAY(wchar_t, length + 1);
+	decode(utf8, length, value);
+	Field* f = _CLNEW Field(field, value, config & ~Field::INDEX_NONORMS, false);
+	f->setOmitNorms((config & Field::INDEX_NONORMS) != 0);
+	doc->add(*f);
+}
+
+void DocumentStoredFieldVisitor::binaryField(const wchar_t* field, const int config, const uint8_t* value, const int32_t length){
+	ValueArray<uint8_t>* data = _CLNEW ValueArray<uint8_t>(length);
+	memcpy(data->values, value, length);
+	doc->add(*_CLNEW Field(field, data, config, false));
+}
+
+CL_NS_END
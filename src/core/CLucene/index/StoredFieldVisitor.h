@@ -0,0 +1,97 @@
+/*------------------------------------------------------------------------------
+* Copyright (C) 2003-2006 Ben van Klinken and the CLucene Team
+
+* Updated by https://github.com/farfella/.
+*
+* Distributable under the terms of either the Apache License (Version 2.0) or
+* the GNU Lesser General Public License, as specified in the COPYING file.
+------------------------------------------------------------------------------*/
+#ifndef _lucene_index_StoredFieldVisitor_
+#define _lucene_index_StoredFieldVisitor_
+
+#include "CLucene/clucene-config.h"
+
+CL_CLASS_DEF(document, Document)
+CL_CLASS_DEF(document, FieldSelector)
+
+CL_NS_DEF(index)
+
+/**
+* Expert: receives the stored fields of a document from
+* {@link IndexReader#visitDocument}, without a {@link Document} or any
+* {@link Field} being built.
+*
+* <p>The reader asks {@link #needsField} about each stored field in turn,
+* and hands the value of the fields it needs to {@link #stringField} or
+* {@link #binaryField}. The values point into the reader's buffers and are
+* only valid during the call: copy what you keep. Fields that are not
+* needed are skipped without being decoded.</p>
+*
+* <p>Strings are passed as the UTF-8 bytes stored in the index, so that
+* an ID can be compared or exported without converting it to wide
+* characters. A NUL character may be encoded as the two bytes 0xC0 0x80,
+* as Java's modified UTF-8 does; {@link #decode} handles both. Compressed
+* fields are passed uncompressed.</p>
+*
+* <p>The <code>config</code> of a field holds the {@link Field} flags it
+* was stored with: <code>STORE_YES</code> or <code>STORE_COMPRESS</code>,
+* the index and term vector flags, and <code>INDEX_NONORMS</code> if the
+* field omits norms, which belongs in {@link Field#setOmitNorms} rather
+* than in a Field constructor.</p>
+*/
+class CLUCENE_EXPORT StoredFieldVisitor {
+public:
+	enum Status {
+		/** Pass the field's value to the visitor */
+		YES,
+		/** Skip the field */
+		NO,
+		/** Skip the field and stop visiting the document */
+		STOP
+	};
+
+	virtual ~StoredFieldVisitor();
+
+	/** Called before a field is read. <code>field</code> is the interned field name. */
+	virtual Status needsField(const wchar_t* field) = 0;
+
+	/** The value of a stored string field: <code>length</code> bytes of UTF-8 */
+	virtual void stringField(const wchar_t* field, const int config, const uint8_t* utf8, const int32_t length);
+
+	/** The value of a stored binary field */
+	virtual void binaryField(const wchar_t* field, const int config, const uint8_t* value, const int32_t length);
+
+	/**
+	* Decodes the UTF-8 value of a string field into <code>result</code>,
+	* which must have room for <code>length+1</code> characters, and
+	* returns the number of characters, not counting the terminating 0.
+	*/
+	static int32_t decode(const uint8_t* utf8, const int32_t length, wchar_t* result);
+};
+
+/**
+* A {@link StoredFieldVisitor} that adds the fields it visits to a
+* {@link Document}, as {@link IndexReader#document} does.
+*
+* <p>If a {@link FieldSelector} is given, <code>NO_LOAD</code> fields are
+* skipped and visiting stops after a <code>LOAD_AND_BREAK</code> or
+* <code>SIZE_AND_BREAK</code> field. Every other field is loaded with its
+* value: lazy fields are not deferred and sizes are not computed.</p>
+*/
+class CLUCENE_EXPORT DocumentStoredFieldVisitor: public StoredFieldVisitor {
+private:
+	CL_NS(document)::Document* doc;
+	const CL_NS(document)::FieldSelector* fieldSelector;
+	bool stop;
+public:
+	/** Adds the fields to <code>doc</code>, which the caller owns */
+	DocumentStoredFieldVisitor(CL_NS(document)::Document* doc, const CL_NS(document)::FieldSelector* fieldSelector = NULL);
+	virtual ~DocumentStoredFieldVisitor();
+
+	Status needsField(const wchar_t* field);
+	void stringField(const wchar_t* field, const int config, const uint8_t* utf8, const int32_t length);
+	void binaryField(const wchar_t* field, const int config, const uint8_t* value, const int32_t length);
+};
+
+CL_NS_END
+#endif
@@ -0,0 +1,237 @@
+/*------------------------------------------------------------------------------
+* Copyright (C) 2003-2006 Ben van Klinken and the CLucene Team
+
+* Updated by https://github.com/farfella/.
+*
+* Distributable under the terms of either the Apache License (Version 2.0) or
+* the GNU Lesser General Public License, as specified in the COPYING file.
+------------------------------------------------------------------------------*/
+#include "CLucene/_ApiHeader.h"
+#include "CLucene/store/Directory.h"
+#include "CLucene/store/IndexInput.h"
+#include "CLucene/store/IndexOutput.h"
+#include "CLucene/util/Misc.h"
+#include "_FieldInfos.h"
+#include "_IndexFileNames.h"
+#include "_TermGramIndex.h"
+#include <algorithm>
+#include <iterator>
+
+CL_NS_USE(util)
+CL_NS_USE(store)
+CL_NS_DEF(index)
+
+	TermGramWriter::TermGramWriter(Directory* directory, const wchar_t* segment, FieldInfos* fis):
+		fieldInfos(fis),
+		fieldCount(0),
+		currentField(-1)
+	{
+		CND_PRECONDITION(segment != NULL, L"segment is NULL");
+
+		output = directory->createOutput( (std::wstring(segment) + L"." + IndexFileNames::TERM_GRAMS_EXTENSION).c_str() );
+		output->writeInt(FORMAT);
+		output->writeInt(GRAM_SIZE);
+		output->writeInt(0);                           // leave space for the field count
+	}
+
+	TermGramWriter::~TermGramWriter(){
+		close();
+	}
+
+	void TermGramWriter::add(int32_t fieldNumber, const wchar_t* termText, int32_t termTextLength){
+		if (fieldNumber != currentField){
+			if (!terms.empty())
+				writeField();
+			currentField = fieldNumber;
+		}
+		FieldInfo* fi = fieldInfos->fieldInfo(fieldNumber);
+		if (!fi->isIndexed || !fi->indexTermGrams)
+			return;
+
+		const int32_t ordinal = static_cast<int32_t>(terms.size());
+		terms.push_back(std::wstring(termText, termTextLength));
+
+		for (int32_t i = 0; i + GRAM_SIZE <= termTextLength; i++){
+			std::vector<int32_t>& ordinals = grams[std::wstring(termText + i, GRAM_SIZE)];
+			//a gram repeated within the term is only recorded once
+			if (ordinals.empty() || ordinals.back() != ordinal)
+				ordinals.push_back(ordinal);
+		}
+	}
+
+	void TermGramWriter::writeField(){
+		output->writeVInt(currentField);
+
+		output->writeVInt(static_cast<int32_t>(terms.size()));
+		const std::wstring* last = NULL;
+		for (std::vector<std::wstring>::const_iterator itr = terms.begin(); itr != terms.end(); ++itr){
+			const std::wstring& term = *itr;
+			int32_t start = 0;
+			if (last != NULL){
+				const size_t limit = cl_min(term.length(), last->length());
+				while (static_cast<size_t>(start) < limit && term[start] == (*last)[start])
+					start++;
+			}
+			const int32_t length = static_cast<int32_t>(term.length()) - start;
+			output->writeVInt(start);                  // write shared prefix length
+			output->writeVInt(length);                 // write delta length
+			output->writeChars(term.c_str() + start, length);
+			last = &term;
+		}
+
+		output->writeVInt(static_cast<int32_t>(grams.size()));
+		for (GramsType::const_iterator itr = grams.begin(); itr != grams.end(); ++itr){
+			output->writeString(itr->first);
+			const std::vector<int32_t>& ordinals = itr->second;
+			output->writeVInt(static_cast<int32_t>(ordinals.size()));
+			int32_t lastOrdinal = 0;
+			for (size_t i = 0; i < ordinals.size(); i++){
+				output->writeVInt(ordinals[i] - lastOrdinal);
+				lastOrdinal = ordinals[i];
+			}
+		}
+
+		fieldCount++;
+		terms.clear();
+		grams.clear();
+	}
+
+	void TermGramWriter::close(){
+		if (output){
+			if (!terms.empty())
+				writeField();
+
+			output->seek(8);                           // write field count after format and gram size
+			output->writeInt(fieldCount);
+			output->close();
+			_CLDELETE(output);
+		}
+	}
+
+
+	TermGramReader::TermGramReader(Directory* directory, const wchar_t* segment, int32_t readBufferSize):
+		gramSize(0)
+	{
+		CND_PRECONDITION(segment != NULL, L"segment is NULL");
+		input = directory->openInput( (std::wstring(segment) + L"." + IndexFileNames::TERM_GRAMS_EXTENSION).c_str(), readBufferSize );
+	}
+
+	TermGramReader::~TermGramReader(){
+		close();
+		for (FieldsType::iterator itr = fields.begin(); itr != fields.end(); ++itr)
+			delete itr->second;
+	}
+
+	void TermGramReader::close(){
+		if (input != NULL){
+			input->close();
+			_CLDELETE(input);
+		}
+	}
+
+	void TermGramReader::load(){
+		FieldsType loaded;
+		try{
+			const int32_t format = input->readInt();
+			if (format != TermGramWriter::FORMAT)
+				_CLTHROWA(CL_ERR_CorruptIndex, "Unknown format version of the term k-gram index");
+			const int32_t size = input->readInt();
+			const int32_t fieldCount = input->readInt();
+
+			for (int32_t i = 0; i < fieldCount; i++){
+				FieldGrams* field = new FieldGrams;
+				loaded[input->readVInt()] = field;
+
+				const int32_t termCount = input->readVInt();
+				field->terms.resize(termCount);
+				for (int32_t j = 0; j < termCount; j++){
+					const int32_t start = input->readVInt();
+					const int32_t length = input->readVInt();
+					std::wstring& term = field->terms[j];
+					term.resize(start + length);
+					if (start > 0)
+						term.replace(0, start, field->terms[j - 1], 0, start);
+					if (length > 0)
+						input->readChars(&term[0], start, length);
+				}
+
+				const int32_t gramCount = input->readVInt();
+				for (int32_t j = 0; j < gramCount; j++){
+					wchar_t* gram = input->readString();
+					std::vector<int32_t>& ordinals = field->grams[gram];
+					_CLDELETE_CARRAY(gram);
+
+					const int32_t ordinalCount = input->readVInt();
+					ordinals.resize(ordinalCount);
+					int32_t ordinal = 0;
+					for (int32_t k = 0; k < ordinalCount; k++){
+						ordinal += input->readVInt();
+						ordinals[k] = ordinal;
+					}
+				}
+			}
+			gramSize = size;
+		}catch(...){
+			for (FieldsType::iterator itr = loaded.begin(); itr != loaded.end(); ++itr)
+				delete itr->second;
+			close();
+			throw;
+		}
+		fields.swap(loaded);
+		close();
+	}
+
+	bool TermGramReader::getCandidates(int32_t fieldNumber, const std::vector<std::wstring>& substrings,
+		std::vector<std::wstring>& candidates)
+	{
+		SCOPED_LOCK_MUTEX(THIS_LOCK)
+		if (input != NULL)
+			load();
+		if (gramSize <= 0)
+			return false;
+
+		FieldsType::const_iterator field = fields.find(fieldNumber);
+		std::vector<const std::vector<int32_t>*> lists;
+		bool hasGrams = false;
+		bool empty = (field == fields.end());
+		for (size_t i = 0; i < substrings.size(); i++){
+			const std::wstring& s = substrings[i];
+			for (size_t j = 0; j + static_cast<size_t>(gramSize) <= s.length(); j++){
+				hasGrams = true;
+				if (empty)
+					break;
+				GramsType::const_iterator gram = field->second->grams.find(s.substr(j, gramSize));
+				if (gram == field->second->grams.end()){
+					empty = true;
+					break;
+				}
+				lists.push_back(&gram->second);
+			}
+		}
+		if (!hasGrams)
+			return false;
+		if (empty)
+			return true;
+
+		//intersect the ordinal lists, shortest first
+		std::sort(lists.begin(), lists.end(), listSizeLess);
+		std::vector<int32_t> matches(*lists[0]);
+		std::vector<int32_t> tmp;
+		for (size_t i = 1; i < lists.size() && !matches.empty(); i++){
+			tmp.clear();
+			std::set_intersection(matches.begin(), matches.end(), lists[i]->begin(), lists[i]->end(),
+				std::back_inserter(tmp));
+			matches.swap(tmp);
+		}
+
+		const std::vector<std::wstring>& terms = field->second->terms;
+		for (size_t i = 0; i < matches.size(); i++)
+			candidates.push_back(terms[matches[i]]);
+		return true;
+	}
+
+	bool TermGramReader::listSizeLess(const std::vector<int32_t>* a, const std::vector<int32_t>* b){
+		return a->size() < b->size();
+	}
+
+CL_NS_END
@@ -15,13 +15,15 @@
 #include "IndexWriter.h"
 #include "_FieldInfos.h"
 #include "_TermInfosWriter.h"
+#include "_TermGramIndex.h"
 #include <assert.h>
 
 CL_NS_USE(util)
 CL_NS_USE(store)
 CL_NS_DEF(index)
 
-	TermInfosWriter::TermInfosWriter(Directory* directory, const wchar_t * segment, FieldInfos* fis, int32_t interval):
+	TermInfosWriter::TermInfosWriter(Directory* directory, const wchar_t * segment, FieldInfos* fis, int32_t interval,
+		int32_t skipInterval, int32_t maxSkipLevels):
         fieldInfos(fis){
     //Func - Constructor
     //Pre  - directory contains a valid reference to a Directory
@@ -31,16 +33,20 @@ CL_NS_DEF(index)
 
     CND_PRECONDITION(segment != NULL, L"segment is NULL");
     //Initialize instance
-    initialise(directory,segment,interval, false);
+    initialise(directory,segment,interval,skipInterval,maxSkipLevels, false);
 
-		other = _CLNEW TermInfosWriter(directory, segment,fieldInfos, interval, true);
+		other = _CLNEW TermInfosWriter(directory, segment,fieldInfos, interval, skipInterval, maxSkipLevels, true);
 
 		CND_CONDITION(other != NULL, L"other is NULL");
 
 		other->other = this;
+
+		if (fieldInfos->hasTermGrams())
+			termGrams = _CLNEW TermGramWriter(directory, segment, fieldInfos);
 	}
 
-  TermInfosWriter::TermInfosWriter(Directory* directory, const wchar_t * segment, FieldInfos* fis, int32_t interval, bool isIndex):
+  TermInfosWriter::TermInfosWriter(Directory* directory, const wchar_t * segment, FieldInfos* fis, int32_t interval,
+	  int32_t skipInterval, int32_t maxSkipLevels, bool isIndex):
 	    fieldInfos(fis){
     //Func - Constructor
     //Pre  - directory contains a valid reference to a Directory
@@ -50,10 +56,11 @@ CL_NS_DEF(index)
     //Post - The instance has been created
 
       CND_PRECONDITION(segment != NULL, L"segment is NULL");
-      initialise(directory,segment,interval,isIndex);
+      initialise(directory,segment,interval,skipInterval,maxSkipLevels,isIndex);
   }
 
-  void TermInfosWriter::initialise(Directory* directory, const wchar_t * segment, int32_t interval, bool IsIndex){
+  void TermInfosWriter::initialise(Directory* directory, const wchar_t * segment, int32_t interval,
+	  int32_t _skipInterval, int32_t _maxSkipLevels, bool IsIndex){
     //Func - Helps constructors to initialize Instance
     //Pre  - directory contains a valid reference to a Directory
     //       segment != NULL
@@ -61,7 +68,7 @@ CL_NS_DEF(index)
     //Post - The instance has been initialized
 
 
-    maxSkipLevels = 10;
+    maxSkipLevels = _maxSkipLevels;
     lastTermTextLength = 0;
     lastFieldNumber = -1;
 
@@ -73,7 +80,7 @@ CL_NS_DEF(index)
     size             = 0;
     isIndex          = IsIndex;
     indexInterval = interval;
-    skipInterval = TermInfosWriter::DEFAULT_TERMDOCS_SKIP_INTERVAL;
+    skipInterval = _skipInterval;
 
     output = directory->createOutput( Misc::segmentname(segment, (isIndex ? L".tii" : L".tis")).c_str() );
 
@@ -86,6 +93,7 @@ CL_NS_DEF(index)
 
     //Set other to NULL by Default
     other = NULL;
+    termGrams = NULL;
   }
 
 	TermInfosWriter::~TermInfosWriter(){
@@ -170,6 +178,9 @@ CL_NS_DEF(index)
       other->add(lastFieldNumber, lastTermText.values, lastTermTextLength, lastTi);                      // add an index term
 		}
 
+		if (termGrams != NULL)
+			termGrams->add(fieldNumber, termText, termTextLength);
+
 		//write term
 		writeTerm(fieldNumber, termText, termTextLength);
 		// write doc freq
@@ -217,6 +228,10 @@ CL_NS_DEF(index)
 			      other->close();
 			      _CLDELETE( other );
           }
+			   if (termGrams){
+			      termGrams->close();
+			      _CLDELETE( termGrams );
+			   }
         }
         _CLDELETE(lastTi);
 		   }
@@ -15,6 +15,10 @@ CL_NS_DEF(index)
 TermDocs::~TermDocs(){
 }
 
+int32_t TermDocs::docFreq() const{
+	return -1;
+}
+
 TermEnum::~TermEnum(){
 }
 
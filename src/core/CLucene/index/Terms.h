@@ -73,6 +73,10 @@ public:
 	// Some implementations are considerably more efficient than that.
 	virtual bool skipTo(const int32_t target)=0;
 
+	// Returns the number of documents the term is in, counting deleted ones,
+	// or -1 if that is not known. Scorers use it to estimate their cost.
+	virtual int32_t docFreq() const;
+
 	// Frees associated resources.
 	virtual void close() = 0;
 
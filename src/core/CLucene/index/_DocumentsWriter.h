@@ -105,6 +105,13 @@ public:
  * means you can call flush with a given thread even while
  * other threads are actively adding/deleting documents.
  *
+ * Threads are idle only while startFlush moves the
+ * buffered ThreadStates, norms and deletes aside into a
+ * FlushBuffer.  They then add documents to fresh
+ * ThreadStates, for the next segment, while flush writes
+ * the buffer.  If they fill the RAM buffer again before
+ * that flush is done, the next flush waits for it.
+ *
  *
  * Exceptions:
  *
@@ -345,14 +352,12 @@ private:
 
     bool currentFieldStorePayloads;
 
-    /** Creates a segment from all Postings in the Postings
-     *  hashes across all ThreadStates & FieldDatas. */
-    void writeSegment(std::vector<std::wstring>& flushedFiles);
+    class FlushBuffer;
 
-    /** Returns the name of the file with this extension, on
-     *  the current segment we are working on. */
-    std::wstring segmentFileName(const std::wstring& extension);
-    std::wstring segmentFileName(const wchar_t * extension);
+    /** Creates a segment from all Postings in the Postings
+     *  hashes across all ThreadStates & FieldDatas of the
+     *  buffer. */
+    void writeSegment(FlushBuffer* buffer, std::vector<std::wstring>& flushedFiles);
 
     TermInfo termInfo; // minimize consing
 
@@ -753,6 +758,34 @@ private:
 
     CL_NS(util)::ObjectArray<BufferedNorms> norms;   // Holds norms until we flush
 
+    /** Holds the buffered docs and deletes of the segment
+     * being flushed.  startFlush moves them here while all
+     * threads are paused, so that flush can write them while
+     * the threads go on indexing into fresh ThreadStates. */
+    class FlushBuffer
+    {
+    public:
+        std::wstring segment;                    // Segment being flushed
+        int32_t numDocs;                         // # docs in the segment
+        int64_t numBytesUsed;                    // RAM used by the docs and deletes
+        bool hasNorms;
+        FieldInfos* fieldInfos;                  // Fields as of startFlush
+        CL_NS(util)::ValueArray<ThreadState*> threadStates;
+        CL_NS(util)::ObjectArray<BufferedNorms> norms;
+        TermNumMapType* deleteTerms;
+        std::vector<int32_t> deleteDocIDs;
+        int32_t numDeleteTerms;
+
+        FlushBuffer();
+        ~FlushBuffer();
+    };
+    FlushBuffer* flushBuffer;                    // Non-NULL between startFlush and finishFlush
+    int64_t numBytesFlushing;                    // RAM held by flushBuffer
+
+    // ThreadStates given back by finishFlush, reused before
+    // allocating new ones
+    std::vector<ThreadState*> freeThreadStates;
+
     /** Does the synchronized work to finish/flush the
      * inverted document. */
     void finishDocument(ThreadState* state);
@@ -832,6 +865,12 @@ public:
      * including any flushed segments. */
     const std::vector<std::wstring>& files();
 
+    /* Copies files() into result while holding our lock. Use
+     * this when indexing threads may be running, since they
+     * discard the list returned by files() when they open a
+     * new doc store. */
+    void copyFiles(std::vector<std::wstring>& result);
+
     void setAborting();
 
     /** Called if we hit an exception when adding docs,
@@ -848,8 +887,18 @@ public:
 
     std::vector<std::wstring> newFiles;
 
-    /** Flush all pending docs to a new segment */
-    int32_t flush(bool closeDocStore);
+    /** Moves all buffered docs and deletes aside for flush
+     *  and starts a new segment.  All threads must be paused;
+     *  they may be resumed as soon as this returns. */
+    void startFlush(bool closeDocStore);
+
+    /** Writes the docs moved aside by startFlush to a new
+     *  segment.  Threads may be adding documents meanwhile. */
+    int32_t flush();
+
+    /** Releases what startFlush moved aside, whether or not
+     *  it was flushed.  Does nothing if no flush is started. */
+    void finishFlush();
 
     /** Build compound file for the segment we just flushed */
     void createCompoundFile(const std::wstring& segment);
@@ -864,14 +913,15 @@ public:
 
     /** Write norms in the "true" segment format.  This is
     *  called only during commit, to create the .nrm file. */
-    void writeNorms(const std::wstring& segmentName, int32_t totalNumDoc);
+    void writeNorms(FlushBuffer* buffer);
 
     int32_t compareText(const wchar_t* text1, const wchar_t* text2);
 
     /* Walk through all unique text tokens (Posting
      * instances) found in this field and serialize them
      * into a single RAM segment. */
-    void appendPostings(CL_NS(util)::ArrayBase<ThreadState::FieldData*>* fields,
+    void appendPostings(FlushBuffer* buffer,
+        CL_NS(util)::ArrayBase<ThreadState::FieldData*>* fields,
         TermInfosWriter* termsOut,
         CL_NS(store)::IndexOutput* freqOut,
         CL_NS(store)::IndexOutput* proxOut);
@@ -899,8 +949,13 @@ public:
 
     const std::vector<int32_t>* getBufferedDeleteDocIDs();
 
-    // Reset buffered deletes.
-    void clearBufferedDeletes();
+    // Deletes moved aside by startFlush, to be applied by the
+    // flushing thread.
+    int32_t getNumFlushedDeleteTerms();
+
+    const TermNumMapType& getFlushedDeleteTerms();
+
+    const std::vector<int32_t>* getFlushedDeleteDocIDs();
 
     bool bufferDeleteTerms(const CL_NS(util)::ArrayBase<Term*>* terms);
 
@@ -914,6 +969,9 @@ public:
 
     int64_t getRAMUsed();
 
+    // RAM still held by a segment that is being flushed
+    int64_t getRAMFlushing();
+
     int64_t numBytesAlloc;
     int64_t numBytesUsed;
 
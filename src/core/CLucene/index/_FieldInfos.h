@@ -36,6 +36,10 @@ class FieldInfo :LUCENE_BASE{
 
 	bool storePayloads; // whether this field stores payloads together with term positions
 
+	bool indexTermGrams; // whether a k-gram index of this field's terms is written
+
+	bool impactTiers; // whether merges write the impact tiers of this field's frequent terms
+
 	//Func - Constructor
 	//       Initialises FieldInfo.
 	//       na holds the name of the field
@@ -88,7 +92,9 @@ public:
 		STORE_POSITIONS_WITH_TERMVECTOR = 0x4,
 		STORE_OFFSET_WITH_TERMVECTOR = 0x8,
 		OMIT_NORMS = 0x10,
-		STORE_PAYLOADS = 0x20
+		STORE_PAYLOADS = 0x20,
+		INDEX_TERMGRAMS = 0x40,
+		IMPACT_TIERS = 0x80
 	};
 
 	FieldInfos();
@@ -187,6 +193,12 @@ public:
 	size_t size()const;
   	bool hasVectors() const;
 
+	/** Returns true if any field asks for a k-gram index of its terms */
+	bool hasTermGrams() const;
+
+	/** Returns true if any field asks for the impact tiers of its terms */
+	bool hasImpactTiers() const;
+
 
 	void write(CL_NS(store)::Directory* d, const wchar_t * name) const;
 	void write(CL_NS(store)::IndexOutput* output) const;
@@ -10,6 +10,7 @@
 #define _lucene_index_FieldsReader_
 
 #include "CLucene/util/_ThreadLocal.h"
+#include <vector>
 CL_CLASS_DEF(store,Directory)
 CL_CLASS_DEF(document,Document)
 #include "CLucene/document/Field.h"
@@ -17,6 +18,7 @@ CL_CLASS_DEF(document,FieldSelector)
 CL_CLASS_DEF(index, FieldInfo)
 CL_CLASS_DEF(index, FieldInfos)
 CL_CLASS_DEF(store,IndexInput)
+CL_CLASS_DEF(index,StoredFieldVisitor)
 
 CL_NS_DEF(index)
 
@@ -24,9 +26,21 @@ CL_NS_DEF(index)
 	* Class responsible for access to stored document fields.
   * <p/>
 	* It uses &lt;segment&gt;.fdt and &lt;segment&gt;.fdx; files.
+	* <p/>
+	* When the documents are stored in compressed chunks (see FieldsWriter),
+	* the last chunk read is kept decompressed, so reading the documents of a
+	* chunk in turn decompresses it once. Access is serialized by the owning
+	* SegmentReader, and every clone gets its own FieldsReader, so the cache
+	* is never shared between threads.
+	* <p/>
+	* docs() reads a batch of documents in document order: the .fdx entries
+	* are read in one pass, and documents close to each other in the .fdt
+	* file are read with a single read into a buffer they are parsed from.
 	*/
 	class FieldsReader :LUCENE_BASE{
 	private:
+		class ChunkInput;
+
 		const FieldInfos* fieldInfos;
 
 		// The main fieldStream, used only for cloning.
@@ -45,6 +59,40 @@ CL_NS_DEF(index)
 		// file.  This will be 0 if we have our own private file.
 		int32_t docStoreOffset;
 
+		// true if the documents are stored in compressed chunks
+		bool chunked;
+		// length of the header of the index file
+		int32_t indexHeaderLength;
+
+		// the last chunk read
+		int64_t chunkPointer;
+		int32_t chunkDocBase;
+		std::vector<int32_t> chunkDocOffsets;
+		CL_NS(util)::ValueArray<uint8_t> chunkData;
+		CL_NS(util)::ValueArray<uint8_t> compressedData;
+		ChunkInput* chunkStream;
+
+		// the stream the current document is read from: fieldsStream or chunkStream
+		CL_NS(store)::IndexInput* docStream;
+
+		void readChunk(const int64_t pointer);
+
+		// positions docStream at the document, false if there is none
+		bool seekDocument(const int32_t n);
+
+		// the value of a field being visited, read in place from a chunk or
+		// into fieldData. Strings are stored as numChars chars of UTF-8.
+		const uint8_t* readFieldBytes(const int32_t length);
+		const uint8_t* readFieldChars(const int32_t numChars, int32_t& length);
+		CL_NS(util)::ValueArray<uint8_t> fieldData;
+		CL_NS(util)::ValueArray<uint8_t> uncompressedData;
+
+		// reads the fields of the document docStream is positioned at
+		bool readFields(CL_NS(document)::Document& doc, const CL_NS(document)::FieldSelector* fieldSelector);
+
+		// the most bytes docs() reads at once
+		LUCENE_STATIC_CONSTANT(int32_t, READ_AHEAD_SIZE = 65536);
+
 		DEFINE_MUTEX(THIS_LOCK)
 		CL_NS(util)::ThreadLocal<CL_NS(store)::IndexInput*, CL_NS(util)::Deletor::Object<CL_NS(store)::IndexInput> > fieldsStreamTL;
     static void uncompress(const CL_NS(util)::ValueArray<uint8_t>& input, CL_NS(util)::ValueArray<uint8_t>& output);
@@ -68,10 +116,23 @@ CL_NS_DEF(index)
 		void close();
 
 		int32_t size() const;
+
+		/** False if the documents are compressed in chunks, which rawDocs cannot return */
+		bool canReadRawDocs() const;
 		
 		/** Loads the fields from n'th document into doc. returns true on success. */
 		bool doc(int32_t n, CL_NS(document)::Document& doc, const CL_NS(document)::FieldSelector* fieldSelector = NULL);
 
+		/**
+		* Loads the fields of documents docs[0..count) into documents[0..count).
+		* The document numbers must be sorted in increasing order.
+		*/
+		void docs(const int32_t* docs, const int32_t count, CL_NS(document)::Document** documents,
+			const CL_NS(document)::FieldSelector* fieldSelector = NULL);
+
+		/** Passes the stored fields of the n'th document to the visitor. returns true on success. */
+		bool visitDocument(const int32_t n, StoredFieldVisitor* visitor);
+
 	protected:
 		/** Returns the length in bytes of each raw document in a
 		*  contiguous range of length numDocs starting with
@@ -154,7 +215,11 @@ CL_NS_DEF(index)
 		// Instances of this class hold field properties and data
 		// for merge
 		class FieldForMerge : public CL_NS(document)::Field {
+			bool binary;
 		public:
+			/** Whether the field was stored binary: the value of a compressed
+			* field is always binary here, so isBinary() cannot tell. */
+			bool isStoredBinary() const;
 			const wchar_t* stringValue() const;
 			CL_NS(util)::Reader* readerValue() const;
 			const CL_NS(util)::ValueArray<uint8_t>* binaryValue();
@@ -19,10 +19,27 @@ CL_CLASS_DEF(document,Document)
 CL_CLASS_DEF(document,Field)
 CL_CLASS_DEF(index,FieldInfos)
 #include "CLucene/util/Array.h"
+#include <vector>
 
 CL_NS_DEF(index)
+
+/**
+* Writes the stored fields of documents to &lt;segment&gt;.fdt and, for each
+* document, its pointer in that file to &lt;segment&gt;.fdx.
+* <p>
+* With a chunk codec, documents are first serialized to a buffer, and every
+* {@link #CHUNK_SIZE} bytes the buffered documents are compressed as one
+* unit. The .fdx then starts with {@link #FORMAT_CHUNKS} and points each
+* document to the start of its chunk. A chunk is written as:
+* first document number (VInt), document count (VInt), the length of each
+* document (VInts), codec (Byte), uncompressed length (VInt), compressed
+* length (VInt) and the compressed documents.
+* </p>
+*/
 class FieldsWriter :LUCENE_BASE{
 private:
+	class ChunkOutput;
+
 	FieldInfos* fieldInfos;
 
 	CL_NS(store)::IndexOutput* fieldsStream;
@@ -30,6 +47,23 @@ private:
 
 	bool doClose;
 
+	// the documents of the chunk being filled, NULL if documents are
+	// written to fieldsStream one at a time
+	ChunkOutput* chunk;
+	uint8_t chunkCodec;
+	int32_t chunkDocBase;
+	int64_t docStart;
+	std::vector<int32_t> chunkDocLengths;
+	CL_NS(util)::ValueArray<uint8_t> compressed;
+
+	// where the fields of the current document go: chunk or fieldsStream
+	CL_NS(store)::IndexOutput* docStream;
+
+	void init(const uint8_t codec);
+	void startDocument();
+	void finishDocument();
+	void flushChunk();
+
   static void compress(const CL_NS(util)::ValueArray<uint8_t>& input, CL_NS(util)::ValueArray<uint8_t>& output);
 
 public:
@@ -37,7 +71,22 @@ public:
 	LUCENE_STATIC_CONSTANT(uint8_t, FIELD_IS_BINARY = 0x2);
 	LUCENE_STATIC_CONSTANT(uint8_t, FIELD_IS_COMPRESSED = 0x4);
 
-	FieldsWriter(CL_NS(store)::Directory* d, const wchar_t * segment, FieldInfos* fn);
+	// the codecs have the values of the IndexWriter::STORED_FIELDS_ constants
+	/** Documents are written one at a time, uncompressed */
+	LUCENE_STATIC_CONSTANT(uint8_t, CODEC_NONE = 0);
+	/** Documents are packed into chunks compressed with LZCompressor */
+	LUCENE_STATIC_CONSTANT(uint8_t, CODEC_LZ = 1);
+	/** Documents are packed into chunks compressed with zlib */
+	LUCENE_STATIC_CONSTANT(uint8_t, CODEC_ZLIB = 2);
+
+	/** First int of an .fdx holding chunks. A per document .fdx starts
+	* with the pointer 0 of its first document instead. */
+	LUCENE_STATIC_CONSTANT(int32_t, FORMAT_CHUNKS = -1);
+
+	/** A chunk is compressed once its documents take this many bytes */
+	LUCENE_STATIC_CONSTANT(int32_t, CHUNK_SIZE = 16384);
+
+	FieldsWriter(CL_NS(store)::Directory* d, const wchar_t * segment, FieldInfos* fn, const uint8_t codec = CODEC_NONE);
 	FieldsWriter(CL_NS(store)::IndexOutput* fdx, CL_NS(store)::IndexOutput* fdt, FieldInfos* fn);
 	~FieldsWriter();
 
@@ -53,6 +102,9 @@ public:
 
 	void close();
 
+	/** The expected length of the .fdx once numDocs documents are written */
+	int64_t indexLength(const int32_t numDocs) const;
+
   /** Bulk write a contiguous series of documents.  The
   *  lengths array is the length (in bytes) of each raw
   *  document.  The stream IndexInput is the
@@ -0,0 +1,121 @@
+/*------------------------------------------------------------------------------
+* Copyright (C) 2003-2006 Ben van Klinken and the CLucene Team
+
+* Updated by https://github.com/farfella/.
+*
+* Distributable under the terms of either the Apache License (Version 2.0) or
+* the GNU Lesser General Public License, as specified in the COPYING file.
+------------------------------------------------------------------------------*/
+#ifndef _lucene_index_ImpactTiers_
+#define _lucene_index_ImpactTiers_
+
+#include "CLucene/clucene-config.h"
+#include "CLucene/LuceneThreads.h"
+#include <map>
+#include <vector>
+
+CL_CLASS_DEF(store,Directory)
+CL_CLASS_DEF(store,IndexInput)
+CL_CLASS_DEF(store,IndexOutput)
+
+CL_NS_DEF(index)
+
+	/**
+	* The impact tier of a term in a segment: the documents in which the term
+	* weighs the most, by tf times norm, and what the term weighs at most in
+	* the other documents.
+	* <p>The weight outside the tier is kept as the pairs of frequency and
+	* norm that no other document outside the tier exceeds in both, so that
+	* any score that does not decrease as either grows is highest for one of
+	* them, whatever the Similarity.</p>
+	*/
+	class ImpactTier :LUCENE_BASE{
+	public:
+		/** The documents of the tier, ascending */
+		std::vector<int32_t> docs;
+		/** The frequencies of the pairs bounding the documents outside the tier, ascending */
+		std::vector<int32_t> freqs;
+		/** The norms of the pairs bounding the documents outside the tier, descending */
+		std::vector<uint8_t> norms;
+
+		/**
+		* Returns the first document of the tier at or after <code>target</code>,
+		* or LUCENE_INT32_MAX_SHOULDBE if there is none. The search starts
+		* at <code>pos</code> when the targets go up, and leaves it at the
+		* document returned.
+		*/
+		int32_t nextDoc(int32_t target, int32_t& pos) const;
+	};
+
+	/**
+	* Writes the impact tiers of a segment (the .imp file) for the fields
+	* indexed with Field::INDEX_IMPACTTIERS. For each term in more than
+	* MIN_DOC_FREQ_RATIO times as many documents as a tier holds, the file
+	* holds the field number and text of the term, the documents of its
+	* tier, delta encoded, and the frequency and norm pairs bounding the
+	* other documents.
+	* <p>The tiers are written by SegmentMerger, which knows the norm of
+	* every posting it merges; flushed segments have none.</p>
+	*/
+	class ImpactTierWriter :LUCENE_BASE{
+	public:
+		struct Posting{
+			int32_t doc;
+			int32_t freq;
+			uint8_t norm;
+		};
+	private:
+		CL_NS(store)::IndexOutput* output;
+		int32_t tierSize;
+		int32_t termCount;
+		std::vector<float_t> impacts;   // minimize consing
+		std::vector<int32_t> order;
+
+		class ImpactGreater;
+	public:
+		/** The file format version, a negative number. */
+		LUCENE_STATIC_CONSTANT(int32_t,FORMAT=-1);
+
+		/** Terms in at most this many times as many documents as a tier
+		* holds are cheap enough to score in full, and get no tier. */
+		LUCENE_STATIC_CONSTANT(int32_t,MIN_DOC_FREQ_RATIO=4);
+
+		ImpactTierWriter(CL_NS(store)::Directory* directory, const wchar_t* segment, int32_t tierSize);
+		~ImpactTierWriter();
+
+		/** True if a term in <code>docFreq</code> documents gets a tier */
+		bool wants(int32_t docFreq) const;
+
+		/** Records the tier of a term, from its postings in any order. Terms
+		* must be added in term dictionary order. */
+		void add(int32_t fieldNumber, const wchar_t* termText, const std::vector<Posting>& postings);
+
+		/** Called to complete the file. */
+		void close();
+	};
+
+	/**
+	* Reads the .imp file written by ImpactTierWriter. The input is opened
+	* together with the other files of the segment, but it is only parsed
+	* the first time a tier is asked for.
+	*/
+	class ImpactTierReader :LUCENE_BASE{
+	private:
+		typedef std::map<std::pair<int32_t, std::wstring>, ImpactTier*> TiersType;
+
+		CL_NS(store)::IndexInput* input;
+		TiersType tiers;
+		DEFINE_MUTEX(THIS_LOCK)
+
+		void load();
+	public:
+		ImpactTierReader(CL_NS(store)::Directory* directory, const wchar_t* segment, int32_t readBufferSize);
+		~ImpactTierReader();
+
+		/** Returns the tier of a term, which belongs to the reader, or NULL if it has none */
+		const ImpactTier* get(int32_t fieldNumber, const wchar_t* termText);
+
+		void close();
+	};
+CL_NS_END
+#endif
@@ -23,6 +23,8 @@ public:
 	static const wchar_t* PROX_EXTENSION;
 	static const wchar_t* TERMS_EXTENSION;
 	static const wchar_t* TERMS_INDEX_EXTENSION;
+	static const wchar_t* TERM_GRAMS_EXTENSION;
+	static const wchar_t* IMPACT_TIERS_EXTENSION;
 	static const wchar_t* FIELDS_INDEX_EXTENSION;
 	static const wchar_t* FIELDS_EXTENSION;
 	static const wchar_t* VECTORS_FIELDS_EXTENSION;
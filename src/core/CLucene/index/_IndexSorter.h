@@ -0,0 +1,69 @@
+/*------------------------------------------------------------------------------
+* Copyright (C) 2003-2006 Ben van Klinken and the CLucene Team
+
+* Updated by https://github.com/farfella/.
+*
+* Distributable under the terms of either the Apache License (Version 2.0) or
+* the GNU Lesser General Public License, as specified in the COPYING file.
+------------------------------------------------------------------------------*/
+#ifndef _lucene_index_IndexSorter_
+#define _lucene_index_IndexSorter_
+
+#include "CLucene/util/Array.h"
+#include <vector>
+
+CL_CLASS_DEF(search,Sort)
+CL_CLASS_DEF(search,SortField)
+
+CL_NS_DEF(index)
+class IndexReader;
+
+	/**
+	* Orders the documents of a merged segment by the index sort of an
+	* IndexWriter (see IndexWriter#setIndexSort).
+	* <p>The sort is given by int, float and string fields, each in either
+	* order. Documents that compare equal keep the order they had in the
+	* segments being merged. The sort is recorded in the SegmentInfo of the
+	* segments written in it as the string returned by toString(), which
+	* describe() builds from the fields of a search's Sort, so that a search
+	* can tell whether a segment is sorted the way it sorts.</p>
+	*/
+	class IndexSorter :LUCENE_BASE{
+	private:
+		struct Key{
+			std::wstring field;
+			int32_t type;
+			bool reverse;
+		};
+		std::vector<Key> keys;
+		std::wstring description;
+	public:
+		/**
+		* @throws CL_ERR_IllegalArgument if a field of the sort is not an INT,
+		* FLOAT or STRING field
+		*/
+		IndexSorter(const CL_NS(search)::Sort* sort);
+		~IndexSorter();
+
+		/**
+		* Orders the documents of <code>readers</code> that are not deleted,
+		* taken in turn. <code>docMaps[i][doc]</code> is set to the new number
+		* of a document of the i'th reader, or -1 if it is deleted, and
+		* <code>sortedDocs[i]</code> to the new number of the i'th document
+		* that is not deleted. Returns the number of documents.
+		*/
+		int32_t sort(IndexReader** readers, const int32_t numReaders,
+			std::vector<int32_t*>& docMaps, CL_NS(util)::ValueArray<int32_t>& sortedDocs) const;
+
+		/** The sort, as recorded in the segments written in it */
+		const std::wstring& toString() const;
+
+		/**
+		* Describes the first <code>count</code> fields of a sort, with
+		* their types resolved, in the form toString() takes.
+		*/
+		static std::wstring describe(CL_NS(search)::SortField* const* fields, const int32_t count);
+	};
+
+CL_NS_END
+#endif
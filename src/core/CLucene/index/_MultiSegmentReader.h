@@ -67,9 +67,7 @@ public:
       CL_NS(store)::Directory* directory,
       SegmentInfos* sis,
       bool closeDirectory,
-      CL_NS(util)::ArrayBase<IndexReader*>* oldReaders,
-      int32_t* oldStarts,
-      NormsCacheType* oldNormsCache);
+      CL_NS(util)::ArrayBase<IndexReader*>* oldReaders);
 
 	virtual ~MultiSegmentReader();
 
@@ -91,6 +89,9 @@ public:
 	int32_t maxDoc() const;
 
   bool document(int32_t n, CL_NS(document)::Document& doc, const CL_NS(document)::FieldSelector* fieldSelector);
+  void visitDocument(const int32_t n, StoredFieldVisitor* visitor);
+  void documents(const int32_t* docs, const int32_t count, CL_NS(document)::Document** result,
+    const CL_NS(document)::FieldSelector* fieldSelector = NULL);
 
 	bool isDeleted(const int32_t n);
 	bool hasDeletions() const;
@@ -102,6 +103,11 @@ public:
 	TermEnum* terms();
 	TermEnum* terms(const Term* term);
 
+	bool getTermGramCandidates(const wchar_t* field, const std::vector<std::wstring>& substrings,
+		std::vector<std::wstring>& candidates);
+	static bool getTermGramCandidates(const wchar_t* field, const std::vector<std::wstring>& substrings,
+		std::vector<std::wstring>& candidates, CL_NS(util)::ArrayBase<IndexReader*>* subReaders);
+
 	//Returns the document frequency of the current term in the set
 	int32_t docFreq(const Term* t=NULL);
 	TermDocs* termDocs();
@@ -112,6 +118,9 @@ public:
 
   void setTermInfosIndexDivisor(int32_t indexDivisor);
   int32_t getTermInfosIndexDivisor();
+  void setSkipListCache(const size_t maxBytes, const int32_t minDocFreq = DEFAULT_SKIP_LIST_CACHE_MIN_DOCFREQ);
+  size_t getSkipListCacheSize();
+  int32_t getSkipListCacheMinDocFreq();
 
   const CL_NS(util)::ArrayBase<IndexReader*>* getSubReaders() const;
 
@@ -146,6 +155,8 @@ public:
 
   int32_t doc() const;
   int32_t freq() const;
+  /** Looks the term up in each segment */
+  int32_t docFreq() const;
 
   void seek(TermEnum* termEnum);
   void seek(Term* tterm);
@@ -30,6 +30,8 @@
 
 CL_NS_DEF(index)
 class SegmentReader;
+class TermGramReader;
+class ImpactTierReader;
 
 class SegmentTermDocs:public virtual TermDocs {
 protected:
@@ -45,6 +47,8 @@ private:
   int32_t skipInterval;
   int32_t maxSkipLevels;
   DefaultSkipListReader* skipListReader;
+  DecodedSkipList* decodedSkipList;  // the current term's, from the skip list cache
+  int32_t skipEntry;                 // the entry of decodedSkipList last skipped to
 
   int64_t freqBasePointer;
   int64_t proxBasePointer;
@@ -67,6 +71,7 @@ public:
   virtual void close();
   virtual int32_t doc()const;
   virtual int32_t freq()const;
+  virtual int32_t docFreq()const;
 
   virtual bool next();
 
@@ -159,6 +164,7 @@ private:
   void seek(TermEnum* termEnum){ SegmentTermDocs::seek(termEnum); }
   int32_t doc() const{ return SegmentTermDocs::doc(); }
   int32_t freq() const{ return SegmentTermDocs::freq(); }
+  int32_t docFreq() const{ return SegmentTermDocs::docFreq(); }
   bool skipTo(const int32_t target){ return SegmentTermDocs::skipTo(target); }
 };
 
@@ -171,7 +177,9 @@ private:
 class SegmentReader: public DirectoryIndexReader {
   /**
    * The class Norm represents the normalizations for a field.
-   * These normalizations are read from an IndexInput in into an array of bytes called bytes
+   * These normalizations are read from an IndexInput in into an array of bytes called bytes.
+   * If the norms file is mapped into memory, bytes points into the mapping instead, and is
+   * only copied when a norm is changed.
    */
   class Norm :LUCENE_BASE{
     int32_t number;
@@ -194,6 +202,8 @@ class SegmentReader: public DirectoryIndexReader {
     CL_NS(store)::IndexInput* in;
     uint8_t* bytes;
     bool dirty;
+    // true if bytes points into the mapped norms file, which must stay open
+    bool mapped;
     //Constructor
     Norm(CL_NS(store)::IndexInput* instrm, bool useSingleNormStream, int32_t number, int64_t normSeek, SegmentReader* reader, const wchar_t * segment);
     //Destructor
@@ -327,9 +337,20 @@ public:
   ///Returns an enumeration of terms starting at or after the named term t
   TermEnum* terms(const Term* t);
 
+  bool getTermGramCandidates(const wchar_t* field, const std::vector<std::wstring>& substrings,
+    std::vector<std::wstring>& candidates);
+  const ImpactTier* getImpactTier(const Term* t);
+
   ///Gets the document identified by n
   bool document(int32_t n, CL_NS(document)::Document& doc, const CL_NS(document)::FieldSelector* fieldSelector);
 
+  ///Passes the stored fields of document n to the visitor
+  void visitDocument(const int32_t n, StoredFieldVisitor* visitor);
+
+  ///Gets a batch of documents in one pass over the stored fields
+  void documents(const int32_t* docs, const int32_t count, CL_NS(document)::Document** result,
+    const CL_NS(document)::FieldSelector* fieldSelector = NULL);
+
   ///Checks if the n-th document has been marked deleted
   bool isDeleted(const int32_t n);
 
@@ -352,6 +373,16 @@ public:
 
   int32_t getTermInfosIndexDivisor();
 
+  void setSkipListCache(const size_t maxBytes, const int32_t minDocFreq = DEFAULT_SKIP_LIST_CACHE_MIN_DOCFREQ);
+  size_t getSkipListCacheSize();
+  int32_t getSkipListCacheMinDocFreq();
+
+  ///Returns the cache of decoded skip lists, or NULL
+  SkipListCache* getSkipListCache() const;
+
+  ///Returns the index sort recorded for the segment, or NULL
+  const wchar_t* getIndexSort() const;
+
   ///Returns the bytes array that holds the norms of a named field.
   ///Returns fake norms if norms aren't available
   uint8_t* norms(const wchar_t* field);
@@ -409,6 +440,12 @@ private:
   FieldInfos* _fieldInfos;
   ///For reading the Term Dictionary .tis file
   TermInfosReader* tis;
+  ///For reading the term k-gram index .tgi file, if there is one
+  TermGramReader* termGrams;
+  ///For reading the impact tiers .imp file, if the segment was merged with one
+  ImpactTierReader* impactTiers;
+  ///The decoded skip lists of the most skipped terms, or NULL
+  SkipListCache* skipCache;
   ///an IndexInput to the prox file
   CL_NS(store)::IndexInput* proxStream;
 
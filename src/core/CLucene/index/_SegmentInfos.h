@@ -75,6 +75,9 @@ private:
 
     bool docStoreIsCompoundFile;			  // whether doc store files are stored in compound file (*.cfx)
 
+    std::wstring indexSort;					  // the index sort the documents of this segment are in
+                                              // (see IndexSorter#toString), empty if they are not sorted
+
     /* Called whenever any change is made that affects which
     * files this segment has. */
     void clearFiles();
@@ -183,6 +186,14 @@ public:
 
     void setDocStoreOffset(const int32_t offset);
 
+    /**
+    * Returns the index sort that the documents of this segment are in,
+    * as IndexSorter#toString describes it, or an empty string.
+    */
+    const std::wstring& getIndexSort() const;
+
+    void setIndexSort(const std::wstring& sort);
+
     /** We consider another SegmentInfo instance equal if it
     *  has the same dir and same name. */
     bool equals(const SegmentInfo* obj);
@@ -260,9 +271,13 @@ public:
     * vectors and stored fields file. */
     LUCENE_STATIC_CONSTANT(int32_t, FORMAT_SHARED_DOC_STORE = -4);
 
+    /** This format records the index sort that the documents of each
+    * segment are in. */
+    LUCENE_STATIC_CONSTANT(int32_t, FORMAT_INDEX_SORT = -5);
+
 private:
     /* This must always point to the most recent file format. */
-    LUCENE_STATIC_CONSTANT(int32_t, CURRENT_FORMAT = FORMAT_SHARED_DOC_STORE);
+    LUCENE_STATIC_CONSTANT(int32_t, CURRENT_FORMAT = FORMAT_INDEX_SORT);
 
 public:
     int32_t counter;  // used to name new segments
@@ -16,11 +16,13 @@ CL_CLASS_DEF(store,Directory)
 #include "_SegmentMergeQueue.h"
 #include "IndexReader.h"
 #include "_TermInfosWriter.h"
+#include "_ImpactTiers.h"
 #include "Terms.h"
 #include "MergePolicy.h"
 
 CL_NS_DEF(index)
 class DefaultSkipListWriter;
+class IndexSorter;
 /**
 * The SegmentMerger class combines two or more Segments, represented by an IndexReader ({@link #add},
 * into a single Segment.  After adding the appropriate readers, call the merge method to combine the 
@@ -67,10 +69,41 @@ class SegmentMerger:LUCENE_BASE {
 	TermInfo termInfo; //(new) minimize consing
 
   int32_t termIndexInterval;
+  uint8_t storedFieldsCodec;
 	int32_t skipInterval;
   int32_t maxSkipLevels;
   DefaultSkipListWriter* skipListWriter;
 
+  // Writes the impact tiers of the fields indexed with INDEX_IMPACTTIERS, or NULL
+  ImpactTierWriter* impactTierWriter;
+  int32_t impactTierSize;
+  // The postings of the current term, if it may get a tier
+  std::vector<ImpactTierWriter::Posting> impactPostings;
+
+  // The index sort of the writer, if the merged documents are sorted
+  const IndexSorter* sorter;
+  MergePolicy::OneMerge* oneMerge;
+  struct SortedDoc{
+    int32_t reader;
+    int32_t doc;
+  };
+  // The merged documents in their new order, and the new number of each
+  // document of each reader, or -1 if it is deleted
+  std::vector<SortedDoc> sortedDocs;
+  std::vector<int32_t*> sortedDocMaps;
+
+  // The postings of a term, buffered to be written in the new order
+  struct SortedPosting{
+    int32_t doc;
+    int32_t freq;
+    size_t positions;   // the first of freq (position, payload length) pairs
+    size_t payload;     // the first byte of its payloads
+    bool operator<(const SortedPosting& other) const{ return doc < other.doc; }
+  };
+  std::vector<SortedPosting> sortedPostings;
+  std::vector<int32_t> sortedPositions;
+  std::vector<uint8_t> sortedPayloads;
+
 public:
   static const uint8_t NORMS_HEADER[]; 
   static const int NORMS_HEADER_length;
@@ -190,6 +223,15 @@ private:
 	*/
 	int32_t appendPostings(SegmentMergeInfo** smis, int32_t n);
 
+	/** appendPostings for a sorted merge: the postings of the term are
+	* read from all the segments, then written in the new order */
+	int32_t appendSortedPostings(SegmentMergeInfo** smis, int32_t n);
+
+	/** True if the postings of the term of smis are buffered for its impact tier */
+	bool wantsImpacts(SegmentMergeInfo** smis, int32_t n);
+	const uint8_t* impactNorms(SegmentMergeInfo* smi);
+	static uint8_t impactNorm(const uint8_t* norms, int32_t doc);
+
 	//Merges the norms for all fields 
 	void mergeNorms();
 
@@ -11,9 +11,80 @@
 
 #include "CLucene/store/IndexInput.h"
 #include "CLucene/util/Array.h"
+#include <list>
+#include <map>
 
 CL_NS_DEF(index)
 
+/**
+ * The entries of the lowest level of a term's skip list, decoded: the
+ * document of each entry and the .frq and .prx pointers and payload length
+ * to resume reading the postings after it. Reference counted: release it
+ * with _CLDECDELETE.
+ */
+class DecodedSkipList: LUCENE_REFBASE {
+public:
+	const int32_t length;
+	int32_t* docs;               // in order
+	int64_t* freqPointers;
+	int64_t* proxPointers;
+	int32_t* payloadLengths;
+
+	DecodedSkipList(const int32_t length);
+	~DecodedSkipList();
+
+	/** Returns the last entry after <code>from</code> whose document is
+	* less than <code>target</code>, or <code>from</code> if there is none */
+	int32_t find(const int32_t target, const int32_t from) const;
+
+	/** The memory the entries hold */
+	size_t getSizeInBytes() const;
+};
+
+/**
+ * Keeps the decoded skip lists of a segment's terms in at least a minimum
+ * number of documents, so that the TermDocs of the segment skip through
+ * them by binary search instead of reading and decoding the skip data of
+ * the .frq file on each seek. The lists are kept within a number of bytes,
+ * evicting the least recently used first. Thread safe.
+ */
+class SkipListCache: LUCENE_BASE {
+public:
+	SkipListCache(const size_t maxBytes, const int32_t minDocFreq);
+	~SkipListCache();
+
+	/** Returns the skip list that starts at <code>skipPointer</code> in
+	* the .frq file, with a reference the caller releases, or NULL */
+	DecodedSkipList* get(const int64_t skipPointer);
+
+	/** Caches <code>list</code>, if it fits */
+	void put(const int64_t skipPointer, DecodedSkipList* list);
+
+	size_t getMaxBytes() const;
+	int32_t getMinDocFreq() const;
+	/** The number of skip lists */
+	size_t size() const;
+	/** The memory held by the skip lists */
+	size_t getSizeInBytes() const;
+	/** The number of skip lists found in the cache */
+	int64_t getHitCount() const;
+	/** The number of skip lists decoded */
+	int64_t getMissCount() const;
+
+private:
+	typedef std::list<std::pair<int64_t, DecodedSkipList*> > EntryList;
+	EntryList entries;                                  // most recently used first
+	std::map<int64_t, EntryList::iterator> index;       // by skip pointer
+	size_t maxBytes;
+	int32_t minDocFreq;
+	size_t bytes;
+	int64_t hitCount;
+	int64_t missCount;
+	DEFINE_MUTEX(THIS_LOCK)
+
+	void remove(EntryList::iterator entry);
+};
+
 /**
  * This abstract class reads skip lists with multiple levels.
  *
@@ -83,6 +154,11 @@ protected:
 	/** initializes the reader */
 	void init(const int64_t _skipPointer, const int32_t df);
 
+	/** Seeks the base stream to the lowest skip level, instead of
+	* skipping after #init, and returns it
+	* @param entries set to the number of entries of the level */
+	CL_NS(store)::IndexInput* seekLowestLevel(int32_t& entries);
+
 private:
 	/** Loads the skip levels  */
 	void loadSkipLevels();
@@ -171,6 +247,10 @@ public:
 	* has skipped.  */
 	int32_t getPayloadLength() const;
 
+	/** Decodes the lowest level of the skip list given to #init, the
+	* upper levels are only needed to skip through it */
+	DecodedSkipList* decode();
+
 protected:
 	void seekChild(const int32_t level);
 
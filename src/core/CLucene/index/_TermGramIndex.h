@@ -0,0 +1,100 @@
+/*------------------------------------------------------------------------------
+* Copyright (C) 2003-2006 Ben van Klinken and the CLucene Team
+
+* Updated by https://github.com/farfella/.
+*
+* Distributable under the terms of either the Apache License (Version 2.0) or
+* the GNU Lesser General Public License, as specified in the COPYING file.
+------------------------------------------------------------------------------*/
+#ifndef _lucene_index_TermGramIndex_
+#define _lucene_index_TermGramIndex_
+
+#include "CLucene/clucene-config.h"
+#include "CLucene/LuceneThreads.h"
+#include <map>
+#include <vector>
+
+CL_CLASS_DEF(store,Directory)
+CL_CLASS_DEF(store,IndexInput)
+CL_CLASS_DEF(store,IndexOutput)
+
+CL_NS_DEF(index)
+class FieldInfos;
+
+	/**
+	* Writes the k-gram index of a segment (the .tgi file) for the fields
+	* indexed with Field::INDEX_TERMGRAMS. For each such field the file holds
+	* the field's terms, prefix compressed as in the term dictionary, followed
+	* by every k-gram occurring in them with the ascending ordinals of the
+	* terms containing it.
+	* <p>Terms are fed in term dictionary order by the TermInfosWriter of the
+	* segment, so the index is built both when flushing and when merging.</p>
+	*/
+	class TermGramWriter :LUCENE_BASE{
+	private:
+		typedef std::map<std::wstring, std::vector<int32_t> > GramsType;
+
+		FieldInfos* fieldInfos;
+		CL_NS(store)::IndexOutput* output;
+		int32_t fieldCount;
+		int32_t currentField;
+		std::vector<std::wstring> terms;
+		GramsType grams;
+
+		/** Writes the section of the current field and resets the buffers */
+		void writeField();
+	public:
+		/** The file format version, a negative number. */
+		LUCENE_STATIC_CONSTANT(int32_t,FORMAT=-1);
+
+		/** Length of the grams written */
+		LUCENE_STATIC_CONSTANT(int32_t,GRAM_SIZE=3);
+
+		TermGramWriter(CL_NS(store)::Directory* directory, const wchar_t* segment, FieldInfos* fis);
+		~TermGramWriter();
+
+		/** Records a term. Terms must be added in term dictionary order. */
+		void add(int32_t fieldNumber, const wchar_t* termText, int32_t termTextLength);
+
+		/** Called to complete the file. */
+		void close();
+	};
+
+	/**
+	* Reads the .tgi file written by TermGramWriter. The input is opened
+	* together with the other files of the segment, but it is only parsed
+	* the first time candidates are asked for.
+	*/
+	class TermGramReader :LUCENE_BASE{
+	private:
+		typedef std::map<std::wstring, std::vector<int32_t> > GramsType;
+		struct FieldGrams {
+			std::vector<std::wstring> terms;
+			GramsType grams;
+		};
+		typedef std::map<int32_t, FieldGrams*> FieldsType;
+
+		CL_NS(store)::IndexInput* input;
+		int32_t gramSize;
+		FieldsType fields;
+		DEFINE_MUTEX(THIS_LOCK)
+
+		void load();
+		static bool listSizeLess(const std::vector<int32_t>* a, const std::vector<int32_t>* b);
+	public:
+		TermGramReader(CL_NS(store)::Directory* directory, const wchar_t* segment, int32_t readBufferSize);
+		~TermGramReader();
+
+		/**
+		* Appends to <code>candidates</code> the terms of the field that contain
+		* every k-gram of each of <code>substrings</code>, in term order.
+		* Returns false if none of the substrings is long enough to have a
+		* k-gram, in which case nothing is appended.
+		*/
+		bool getCandidates(int32_t fieldNumber, const std::vector<std::wstring>& substrings,
+			std::vector<std::wstring>& candidates);
+
+		void close();
+	};
+CL_NS_END
+#endif
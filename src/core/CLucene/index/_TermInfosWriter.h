@@ -19,6 +19,7 @@ CL_CLASS_DEF(store,Directory)
 CL_NS_DEF(index)
 class FieldInfos;
 class TermInfo;
+class TermGramWriter;
 
 	// This stores a monotonically increasing set of <Term, TermInfo> pairs in a
 	// Directory.  A TermInfos can be written once, in order.
@@ -39,8 +40,12 @@ class TermInfo;
 
 		TermInfosWriter* other;
 
+		// k-gram index of the fields indexed with INDEX_TERMGRAMS, or NULL
+		TermGramWriter* termGrams;
+
 		//inititalize
-		TermInfosWriter(CL_NS(store)::Directory* directory, const wchar_t * segment, FieldInfos* fis, int32_t interval, bool isIndex);
+		TermInfosWriter(CL_NS(store)::Directory* directory, const wchar_t * segment, FieldInfos* fis, int32_t interval,
+			int32_t skipInterval, int32_t maxSkipLevels, bool isIndex);
 
     int32_t compareToLastTerm(int32_t fieldNumber, const wchar_t* termText, int32_t length);
 	public:
@@ -59,6 +64,9 @@ class TermInfo;
     //accelerable cases. More detailed experiments would be useful here. */
     LUCENE_STATIC_CONSTANT(int32_t, DEFAULT_TERMDOCS_SKIP_INTERVAL=16);
 
+    /** The default maximum number of skip levels */
+    LUCENE_STATIC_CONSTANT(int32_t, DEFAULT_MAX_SKIP_LEVELS=10);
+
 
 		/**
 		* Expert: The fraction of terms in the "dictionary" which should be stored
@@ -78,7 +86,8 @@ class TermInfo;
 		*/
 		int32_t skipInterval;// = 16
 
-		TermInfosWriter(CL_NS(store)::Directory* directory, const wchar_t * segment, FieldInfos* fis, int32_t interval);
+		TermInfosWriter(CL_NS(store)::Directory* directory, const wchar_t * segment, FieldInfos* fis, int32_t interval,
+			int32_t skipInterval = DEFAULT_TERMDOCS_SKIP_INTERVAL, int32_t maxSkipLevels = DEFAULT_MAX_SKIP_LEVELS);
 
 		~TermInfosWriter();
 
@@ -95,7 +104,8 @@ class TermInfo;
 
 	private:
         /** Helps constructors to initialize instances */
-		void initialise(CL_NS(store)::Directory* directory, const wchar_t * segment, int32_t interval, bool IsIndex);
+		void initialise(CL_NS(store)::Directory* directory, const wchar_t * segment, int32_t interval,
+			int32_t skipInterval, int32_t maxSkipLevels, bool IsIndex);
 		void writeTerm(int32_t fieldNumber, const wchar_t* termText, int32_t termTextLength);
 	};
 CL_NS_END
@@ -361,7 +361,7 @@ Query* QueryParser::getFieldQuery(const wchar_t* _field, wchar_t* queryText)
     // PhraseQuery, or nothing based on the term count
 
     StringReader reader(queryText);
-    TokenStream* source = analyzer->tokenStream(_field, &reader);
+    TokenStream* source = analyzer->reusableTokenStream(_field, &reader);
 
     CLVector<CL_NS(analysis)::Token*, Deletor::Object<CL_NS(analysis)::Token> > v;
     CL_NS(analysis)::Token* t = NULL;
@@ -375,7 +375,7 @@ Query* QueryParser::getFieldQuery(const wchar_t* _field, wchar_t* queryText)
         {
             Token* _t = source->next(t);
             if (_t == NULL) _CLDELETE(t);
-        }_CLCATCH_ERR(CL_ERR_IO, _CLLDELETE(source); _CLLDELETE(t); _CLDELETE_LCARRAY(queryText); , {
+        }_CLCATCH_ERR(CL_ERR_IO, source->close(); _CLLDELETE(t); _CLDELETE_LCARRAY(queryText); , {
           t = NULL;
             });
         if (t == NULL)
@@ -390,8 +390,8 @@ Query* QueryParser::getFieldQuery(const wchar_t* _field, wchar_t* queryText)
     {
         source->close();
     }
-    _CLCATCH_ERR_CLEANUP(CL_ERR_IO, { _CLLDELETE(source); _CLLDELETE(t); _CLDELETE_LCARRAY(queryText); }); /* cleanup */
-    _CLLDELETE(source);
+    _CLCATCH_ERR_CLEANUP(CL_ERR_IO, { _CLLDELETE(t); _CLDELETE_LCARRAY(queryText); }); /* cleanup */
+    //don't delete source, the analyzer re-uses it
 
     if (v.size() == 0)
         return NULL;
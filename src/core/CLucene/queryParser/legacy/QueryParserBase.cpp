@@ -145,7 +145,7 @@ Query* QueryParserBase::GetFieldQuery(const wchar_t* field, wchar_t* queryText){
 
   //Instantiate a stringReader for queryText
   StringReader reader(queryText);
-  TokenStream* source = analyzer->tokenStream(field, &reader);
+  TokenStream* source = analyzer->reusableTokenStream(field, &reader);
   CND_CONDITION(source != NULL,L"source is NULL");
 
   StringArrayWithDeletor v;
@@ -166,11 +166,11 @@ Query* QueryParserBase::GetFieldQuery(const wchar_t* field, wchar_t* queryText){
     }
   }catch(CLuceneError& err){
     if ( err.number() != CL_ERR_IO ) {
-      _CLLDELETE(source);
+      source->close();
       throw err;
     }
   }
-  _CLDELETE(source);
+  source->close(); //don't delete, the analyzer re-uses this stream
 
   //Check if there are any tokens retrieved
   if (v.size() == 0){
@@ -236,7 +236,7 @@ Query* QueryParserBase::ParseRangeQuery(const wchar_t* field, wchar_t* queryText
 
   // Use the analyzer to get all the tokens.  There should be 1 or 2.
   StringReader reader(queryText);
-  TokenStream* source = analyzer->tokenStream(field, &reader);
+  TokenStream* source = analyzer->reusableTokenStream(field, &reader);
 
   wchar_t* terms[2];
   terms[0]=NULL;terms[1]=NULL;
@@ -275,7 +275,7 @@ Query* QueryParserBase::ParseRangeQuery(const wchar_t* field, wchar_t* queryText
   Query* ret = GetRangeQuery(field, terms[0], terms[1],inclusive);
   _CLDELETE_CARRAY(terms[0]);
   _CLDELETE_CARRAY(terms[1]);
-  _CLDELETE(source);
+  source->close(); //don't delete, the analyzer re-uses this stream
 
   return ret;
 }
@@ -0,0 +1,245 @@
+/*------------------------------------------------------------------------------
+* Copyright (C) 2003-2006 Ben van Klinken and the CLucene Team
+
+* Updated by https://github.com/farfella/.
+*
+* Distributable under the terms of either the Apache License (Version 2.0) or
+* the GNU Lesser General Public License, as specified in the COPYING file.
+------------------------------------------------------------------------------*/
+#include "CLucene/_ApiHeader.h"
+#include "AutomatonTermEnum.h"
+#include "CLucene/index/Term.h"
+#include "CLucene/index/IndexReader.h"
+#include "CLucene/util/_Automaton.h"
+#include <algorithm>
+
+CL_NS_USE(index)
+CL_NS_USE(util)
+CL_NS_DEF(search)
+
+//Number of terms stepped over with next() before reopening the term
+//dictionary at the seek target instead
+static const int32_t MAX_LINEAR_SCAN = 16;
+
+AutomatonTermEnum::AutomatonTermEnum(IndexReader* reader, Term* term, Automaton* automaton, bool deleteAutomaton,
+    const std::vector<std::wstring>* substrings) :
+    FilteredTermEnum(),
+    reader(reader),
+    __term(_CL_POINTER(term)),
+    automaton(automaton),
+    deleteAutomaton(deleteAutomaton),
+    _endEnum(false),
+    visited(automaton->getNumStates(), 0),
+    generation(0),
+    useCandidates(false),
+    nextCandidate(0)
+{
+    //every accepted term starts with the common prefix, so start there
+    std::wstring prefix;
+    automaton->getCommonPrefix(prefix);
+
+    //without a prefix to start from, let the k-gram term index propose
+    //the terms worth looking at
+    if (prefix.empty() && substrings != NULL && !substrings->empty())
+        useCandidates = reader->getTermGramCandidates(term->field(), *substrings, candidates);
+    if (useCandidates)
+    {
+        std::sort(candidates.begin(), candidates.end());
+        candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
+        std::vector<std::wstring>::iterator last = candidates.begin();
+        for (std::vector<std::wstring>::iterator itr = candidates.begin(); itr != candidates.end(); ++itr)
+        {
+            if (automaton->run(itr->c_str(), itr->length()))
+                (last++)->swap(*itr);
+        }
+        candidates.erase(last, candidates.end());
+
+        if (candidates.empty())
+        {
+            _endEnum = true;
+            return;
+        }
+        prefix = candidates[0];
+    }
+
+    Term* t = _CLNEW Term(__term, prefix.c_str());
+    actualEnum = reader->terms(t);
+    _CLDECDELETE(t);
+
+    findMatch();
+}
+
+AutomatonTermEnum::~AutomatonTermEnum()
+{
+    close();
+}
+
+void AutomatonTermEnum::close()
+{
+    if (__term != NULL)
+    {
+        FilteredTermEnum::close();
+
+        _CLDECDELETE(__term);
+        __term = NULL;
+
+        if (deleteAutomaton)
+            _CLDELETE(automaton);
+        automaton = NULL;
+    }
+}
+
+bool AutomatonTermEnum::termCompare(Term* term)
+{
+    if (term != NULL && __term->field() == term->field())
+        return automaton->run(term->text(), term->textLength());
+    _endEnum = true;
+    return false;
+}
+
+bool AutomatonTermEnum::next()
+{
+    if (actualEnum == NULL)
+        return false;
+
+    _CLDECDELETE(currentTerm);
+    if (_endEnum || !actualEnum->next())
+    {
+        _endEnum = true;
+        return false;
+    }
+    return findMatch();
+}
+
+bool AutomatonTermEnum::findMatch()
+{
+    for (;;)
+    {
+        Term* t = actualEnum->term(false);
+        if (t == NULL || t->field() != __term->field())
+            break;
+
+        if (automaton->run(t->text(), t->textLength()))
+        {
+            currentTerm = _CL_POINTER(t);
+            return true;
+        }
+
+        if (useCandidates)
+        {
+            if (!nextCandidateString(t->text()) || !seek())
+                break;
+        }
+        else if (!nextString(t->text(), t->textLength()) || !seek())
+            break;
+    }
+    _endEnum = true;
+    return false;
+}
+
+bool AutomatonTermEnum::seek()
+{
+    for (int32_t i = 0; i < MAX_LINEAR_SCAN; i++)
+    {
+        if (!actualEnum->next())
+            return false;
+        Term* t = actualEnum->term(false);
+        if (t->field() != __term->field() || wcscmp(t->text(), seekText.c_str()) >= 0)
+            return true;
+    }
+
+    //the target is further away, so look it up in the term index
+    Term* t = _CLNEW Term(__term, seekText.c_str());
+    TermEnum* e = reader->terms(t);
+    _CLDECDELETE(t);
+
+    actualEnum->close();
+    _CLDELETE(actualEnum);
+    actualEnum = e;
+    return true;
+}
+
+bool AutomatonTermEnum::nextString(const wchar_t* text, int32_t textLen)
+{
+    //walk as much of the rejected term as the automaton allows
+    std::vector<int32_t> states(1, 0);
+    int32_t state = 0;
+    int32_t pos = 0;
+    for (; pos < textLen; pos++)
+    {
+        state = automaton->step(state, text[pos]);
+        if (state == -1)
+            break;
+        states.push_back(state);
+    }
+
+    seekText.assign(text, pos);
+    if (pos == textLen)
+    {
+        //the whole term was walked; the next candidates extend it
+        appendMinimalPath(state);
+        return true;
+    }
+
+    //find the last position where a larger character can be taken
+    for (; pos >= 0; pos--)
+    {
+        const int32_t c = (int32_t)text[pos];
+        state = states[pos];
+        const int32_t numTransitions = automaton->getNumTransitions(state);
+        for (int32_t i = 0; i < numTransitions; i++)
+        {
+            int32_t min, max, dest;
+            automaton->getTransition(state, i, min, max, dest);
+            if (max > c)
+            {
+                seekText.resize(pos);
+                seekText.push_back((wchar_t)cl_max(min, c + 1));
+                appendMinimalPath(dest);
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+bool AutomatonTermEnum::nextCandidateString(const wchar_t* text)
+{
+    while (nextCandidate < candidates.size() && wcscmp(candidates[nextCandidate].c_str(), text) <= 0)
+        nextCandidate++;
+    if (nextCandidate == candidates.size())
+        return false;
+    seekText = candidates[nextCandidate++];
+    return true;
+}
+
+void AutomatonTermEnum::appendMinimalPath(int32_t state)
+{
+    //follow the smallest transitions until an accept state is reached; a
+    //state seen twice means a loop, after which the path would only grow
+    generation++;
+    while (!automaton->isAccept(state) && visited[state] != generation
+        && automaton->getNumTransitions(state) > 0)
+    {
+        visited[state] = generation;
+        int32_t min, max, dest;
+        automaton->getTransition(state, 0, min, max, dest);
+        seekText.push_back((wchar_t)min);
+        state = dest;
+    }
+}
+
+float_t AutomatonTermEnum::difference()
+{
+    return 1.0f;
+}
+
+bool AutomatonTermEnum::endEnum()
+{
+    return _endEnum;
+}
+
+const std::wstring AutomatonTermEnum::getObjectName() const { return getClassName(); }
+const std::wstring AutomatonTermEnum::getClassName() { return L"AutomatonTermEnum"; }
+
+CL_NS_END
@@ -0,0 +1,97 @@
+/*------------------------------------------------------------------------------
+* Copyright (C) 2003-2006 Ben van Klinken and the CLucene Team
+
+* Updated by https://github.com/farfella/.
+*
+* Distributable under the terms of either the Apache License (Version 2.0) or
+* the GNU Lesser General Public License, as specified in the COPYING file.
+------------------------------------------------------------------------------*/
+#ifndef _lucene_search_AutomatonTermEnum_
+#define _lucene_search_AutomatonTermEnum_
+
+CL_CLASS_DEF(index,Term)
+CL_CLASS_DEF(index,IndexReader)
+CL_CLASS_DEF(util,Automaton)
+#include "FilteredTermEnum.h"
+#include <vector>
+
+CL_NS_DEF(search)
+    /**
+     * Subclass of FilteredTermEnum for enumerating all terms of a field
+     * accepted by an {@link Automaton}.
+     * <p>
+     * Instead of testing every term of the field, the enumeration uses the
+     * automaton to work out the smallest string that could still be
+     * accepted after a rejected term, and skips the term dictionary ahead
+     * to it. Short gaps are stepped over with next(), longer ones by
+     * reopening the dictionary at the target term.
+     * <p>
+     * When the automaton accepts terms without a common prefix, a leading
+     * wildcard for instance, the caller may pass substrings every accepted
+     * term contains. If the reader has a k-gram term index for the field
+     * (see Field::INDEX_TERMGRAMS), only the terms it proposes are visited.
+     */
+	class CLUCENE_EXPORT AutomatonTermEnum: public FilteredTermEnum {
+    private:
+        CL_NS(index)::IndexReader* reader;
+        CL_NS(index)::Term* __term;
+        CL_NS(util)::Automaton* automaton;
+        bool deleteAutomaton;
+        bool _endEnum;
+
+        std::wstring seekText;
+        std::vector<int32_t> visited;
+        int32_t generation;
+
+        bool useCandidates;
+        std::vector<std::wstring> candidates;
+        size_t nextCandidate;
+
+        /** Positions on the first accepted term at or after the current one */
+        bool findMatch();
+
+        /**
+        * Sets seekText to a string greater than <code>text</code> that no
+        * accepted term greater than <code>text</code> sorts before.
+        * Returns false if no such term can exist.
+        */
+        bool nextString(const wchar_t* text, int32_t textLen);
+
+        /** Sets seekText to the first candidate greater than <code>text</code> */
+        bool nextCandidateString(const wchar_t* text);
+
+        /** Appends the least characters from <code>state</code> towards an accept state */
+        void appendMinimalPath(int32_t state);
+
+        /** Moves actualEnum to the first term at or after seekText */
+        bool seek();
+
+    protected:
+        bool termCompare(CL_NS(index)::Term* term) ;
+
+    public:
+        /**
+        * Creates a new <code>AutomatonTermEnum</code> over the field of
+        * <code>term</code>. If <code>deleteAutomaton</code> is true the
+        * enumeration takes ownership of the automaton. <code>substrings</code>,
+        * if not NULL, are strings contained in every term the automaton
+        * accepts, used to look the terms up in the k-gram term index.
+        */
+        AutomatonTermEnum(CL_NS(index)::IndexReader* reader, CL_NS(index)::Term* term,
+            CL_NS(util)::Automaton* automaton, bool deleteAutomaton,
+            const std::vector<std::wstring>* substrings = NULL);
+        ~AutomatonTermEnum();
+
+        bool next();
+
+        float_t difference() ;
+
+        bool endEnum() ;
+
+        void close();
+
+		    const std::wstring getObjectName() const;
+		    static const std::wstring getClassName();
+    };
+CL_NS_END
+#endif
@@ -17,19 +17,30 @@
 CL_NS_USE(util)
 CL_NS_DEF(search)
 
+  /** The position of the lowest bit set in <code>word</code>, which is not 0 */
+  static inline int32_t lowestBit(const uint32_t word) {
+    static const int32_t DEBRUIJN_POSITION[32] = {
+      0, 1, 28, 2, 29, 14, 24, 3, 30, 22, 20, 15, 25, 17, 4, 8,
+      31, 27, 13, 23, 21, 19, 16, 7, 26, 12, 18, 6, 11, 5, 10, 9
+    };
+    return DEBRUIJN_POSITION[((word & (0 - word)) * 0x077CB531U) >> 27];
+  }
+
    BooleanScorer::BooleanScorer(Similarity* similarity, int32_t minNrShouldMatch ):
     Scorer(similarity),
     scorers(NULL),
     maxCoord(1),
     nextMask(1),
+	base(0),
 	end(0),
-	current(NULL),
+	word(BucketTable_SIZE / 32),
+	current(-1),
 	minNrShouldMatch(minNrShouldMatch),
     requiredMask(0),
     prohibitedMask(0),
 	coordFactors(NULL)
   {
-    bucketTable = _CLNEW BucketTable(this);
+    bucketTable = _CLNEW BucketTable();
   }
 
   BooleanScorer::~BooleanScorer(){
@@ -42,48 +53,68 @@ CL_NS_DEF(search)
       _CLDELETE(scorers);
   }
 
+  int32_t BooleanScorer::firstDoc() const {
+    int32_t first = LUCENE_INT32_MAX_SHOULDBE;
+    for (SubScorer* sub = scorers; sub != NULL; sub = sub->next) {
+      if (!sub->done && !sub->prohibited && sub->scorer->doc() < first)
+        first = sub->scorer->doc();
+    }
+    return first;
+  }
 
-  bool BooleanScorer::next() {
-	bool more;
-	do {
-		while (bucketTable->first != NULL) {         // more queued
-			current = bucketTable->first;
-			bucketTable->first = current->next;         // pop the queue
-
-			// check prohibited & required
-			if ((current->bits & prohibitedMask) == 0 &&
-				(current->bits & requiredMask) == requiredMask) {
-			return true;
-		}
-	}
-
-	// refill the queue
-	more = false;
-	end += BooleanScorer::BucketTable_SIZE;
-	for (SubScorer* sub = scorers; sub != NULL; sub = sub->next) {
-		Scorer* scorer = sub->scorer;
-			int32_t doc;
-			while (!sub->done && (doc=scorer->doc()) < end) {
-				sub->collector->collect(doc, scorer->score());
-			sub->done = !scorer->next();
-		}
-		if (!sub->done) {
-			more = true;
-		}
-	}
-	} while (bucketTable->first != NULL || more);
+  bool BooleanScorer::nextWindow(const int32_t max) {
+    // the window starts at the first document a clause that is not prohibited is on
+    const int32_t first = firstDoc();
+    if (first >= max)
+      return false;
+    base = first;
+    end = max - base < BucketTable_SIZE ? max : base + BucketTable_SIZE;
+
+    for (SubScorer* sub = scorers; sub != NULL; sub = sub->next) {
+      if (sub->done)
+        continue;
+      if (sub->scorer->doc() < base && !sub->scorer->skipTo(base)) {
+        sub->done = true;                         // a prohibited clause that ended before the window
+        continue;
+      }
+      bool more;
+      const int32_t n = sub->scorer->scoreBlock(end, bucketTable->blockDocs, bucketTable->blockScores, BucketTable_SIZE, more);
+      bucketTable->add(base, n, sub->mask);
+      sub->done = !more;
+    }
+    word = 0;
+    return true;
+  }
 
-	return false;
+  bool BooleanScorer::next() {
+    if (current >= 0) {
+      reset(current);
+      current = -1;
+    }
+    do {
+      for (; word < BucketTable_SIZE / 32; word++) {
+        uint32_t& touched = bucketTable->touched[word];
+        while (touched != 0) {
+          const int32_t slot = (word << 5) + lowestBit(touched);
+          touched &= touched - 1;
+          if (accepts(slot)) {
+            current = slot;
+            return true;
+          }
+          reset(slot);
+        }
+      }
+    } while (nextWindow(LUCENE_INT32_MAX_SHOULDBE));
+    return false;
   }
 
 	float_t BooleanScorer::score(){
 		if (coordFactors == NULL)
 			computeCoordFactors();
-		return current->score * coordFactors[current->coord];
+		return bucketTable->scores[current] * coordFactors[bucketTable->coords[current]];
 	}
 
 	void BooleanScorer::score( HitCollector* results ) {
-		next();
 		score( results, LUCENE_INT32_MAX_SHOULDBE );
 	}
 
@@ -124,9 +155,8 @@ CL_NS_DEF(search)
     else if (required)
       requiredMask |= mask;			  // update required mask
 
-    //scorer, HitCollector, and scorers is delete in the SubScorer
-    scorers = _CLNEW SubScorer(scorer, required, prohibited,
-    bucketTable->newCollector(mask), scorers);
+    //scorer and scorers is delete in the SubScorer
+    scorers = _CLNEW SubScorer(scorer, required, prohibited, mask, scorers);
   }
 
   void BooleanScorer::computeCoordFactors(){
@@ -139,73 +169,46 @@ CL_NS_DEF(search)
     if ( coordFactors == NULL ) {
     	computeCoordFactors();
     }
+    if ( current >= 0 ) {
+    	reset( current );
+    	current = -1;
+    }
 
-    bool more;
-    Bucket* tmp;
-
+    const float_t* scores = bucketTable->scores;
+    const int32_t* coords = bucketTable->coords;
     do {
-    	bucketTable->first = NULL;
-    	while ( current != NULL ) {
-
-    		if (( current->bits & prohibitedMask ) == 0 &&
-    		    ( current->bits & requiredMask ) == requiredMask ) {
-
-    			if ( current->doc >= maxDoc ) {
-    				tmp = current;
-    				current = current->next;
-    				tmp->next = bucketTable->first;
-    				bucketTable->first = tmp;
-    				continue;
-    			}
-
-    			if ( current->coord >= minNrShouldMatch ) {
-    				results->collect( current->doc, current->score * coordFactors[current->coord] );
-    			}
-    		}
-
-    		current = current->next;
-    	}
-
-    	if ( bucketTable->first != NULL ) {
-    		current = bucketTable->first;
-    		bucketTable->first = current->next;
-    		return true;
-    	}
-
-    	more = false;
-    	end += BucketTable_SIZE;
-
-    	for ( SubScorer* sub = scorers; sub != NULL; sub = sub->next ) {
-    		if ( !sub->done ) {
-    			sub->done = !sub->scorer->score( sub->collector, end );
-    			if ( !sub->done )
-    				more = true;
+    	// collect the touched slots in the order of the table, and empty them
+    	for ( ; word < BucketTable_SIZE / 32; word++ ) {
+    		uint32_t touched = bucketTable->touched[word];
+    		bucketTable->touched[word] = 0;
+    		while ( touched != 0 ) {
+    			const int32_t slot = ( word << 5 ) + lowestBit( touched );
+    			touched &= touched - 1;
+    			if ( accepts( slot ) )
+    				results->collect( base + slot, scores[slot] * coordFactors[coords[slot]] );
+    			reset( slot );
     		}
     	}
-    	current = bucketTable->first;
-
-    } while ( current != NULL || more );
+    } while ( nextWindow( maxDoc ) );
 
-    return false;
+    return firstDoc() != LUCENE_INT32_MAX_SHOULDBE;
   }
 
 
 
-  BooleanScorer::SubScorer::SubScorer(Scorer* scr, const bool r, const bool p, HitCollector* c, SubScorer* nxt):
+  BooleanScorer::SubScorer::SubScorer(Scorer* scr, const bool r, const bool p, const int32_t m, SubScorer* nxt):
       scorer(scr),
       required(r),
       prohibited(p),
-      collector(c),
+      mask(m),
       next(nxt)
   {
   //Func - Constructor
   //Pre  - scr != NULL,
-  //       c   != NULL
   //       nxt may or may not be NULL
   //Post - The instance has been created
 
       CND_PRECONDITION(scr != NULL,L"scr is NULL");
-      CND_PRECONDITION(c != NULL,L"c is NULL");
 
       done        = !scorer->next();
   }
@@ -222,78 +225,44 @@ CL_NS_DEF(search)
 		ptr = next;
 	}
 	_CLDELETE(scorer);
-	_CLDELETE(collector);
-  }
-
-  BooleanScorer::Bucket::Bucket():
-      doc(-1),
-      score(0.0),
-      bits(0),
-      coord(0),
-      next(NULL)
-  {
-  }
-  BooleanScorer::Bucket::~Bucket(){
   }
 
 
 
 
-  BooleanScorer::BucketTable::BucketTable(BooleanScorer* scr):
-    scorer(scr),
-    first(NULL)
+  BooleanScorer::BucketTable::BucketTable()
   {
-		buckets = new Bucket[BucketTable_SIZE];
+		scores = _CL_NEWARRAY(float_t, BucketTable_SIZE);
+		coords = _CL_NEWARRAY(int32_t, BucketTable_SIZE);
+		bits = _CL_NEWARRAY(int32_t, BucketTable_SIZE);
+		touched = _CL_NEWARRAY(uint32_t, BucketTable_SIZE / 32);
+		blockDocs = _CL_NEWARRAY(int32_t, BucketTable_SIZE);
+		blockScores = _CL_NEWARRAY(float_t, BucketTable_SIZE);
+		for (int32_t i = 0; i < BucketTable_SIZE; i++) {
+			scores[i] = 0;
+			coords[i] = 0;
+			bits[i] = 0;
+		}
+		for (int32_t i = 0; i < BucketTable_SIZE / 32; i++)
+			touched[i] = 0;
   }
   BooleanScorer::BucketTable::~BucketTable(){
-		clear();
-		delete [] buckets;
-  }
-
-  void BooleanScorer::BucketTable::clear(){
-    //delete first;
-    first = NULL;
+		_CLDELETE_ARRAY(scores);
+		_CLDELETE_ARRAY(coords);
+		_CLDELETE_ARRAY(bits);
+		_CLDELETE_ARRAY(touched);
+		_CLDELETE_ARRAY(blockDocs);
+		_CLDELETE_ARRAY(blockScores);
   }
-  int32_t BooleanScorer::BucketTable::size() const { return BooleanScorer::BucketTable_SIZE; }
-
-  HitCollector* BooleanScorer::BucketTable::newCollector(const int32_t mask) {
-    return _CLNEW Collector(mask, this);
-  }
-
 
-
-
-
-
-
-
-
-  BooleanScorer::Collector::Collector(const int32_t msk, BucketTable* bucketTbl):
-    bucketTable(bucketTbl),
-    mask(msk)
-  {
-  }
-
-  void BooleanScorer::Collector::collect(const int32_t doc, const float_t score){
-    BucketTable* table = bucketTable;
-    int32_t i = doc & (BooleanScorer::BucketTable_SIZE-1);
-    Bucket* bucket = &table->buckets[i];
-
-    if (bucket->doc != doc) {			  // invalid bucket
-      bucket->doc = doc;			  // set doc
-      bucket->score = score;			  // initialize score
-      bucket->bits = mask;			  // initialize mask
-      bucket->coord = 1;			  // initialize coord
-
-      bucket->next = table->first;		  // push onto valid list
-      table->first = bucket;
-    } else {					  // valid bucket
-      bucket->score += score;			  // increment score
-      bucket->bits |= mask;			  // add bits in mask
-      bucket->coord++;				  // increment coord
+  void BooleanScorer::BucketTable::add(const int32_t base, const int32_t n, const int32_t mask){
+    for (int32_t i = 0; i < n; i++) {
+      const int32_t slot = blockDocs[i] - base;
+      scores[slot] += blockScores[i];
+      coords[slot]++;
+      bits[slot] |= mask;
+      touched[slot >> 5] |= 1U << (slot & 31);
     }
   }
 
-
-
 CL_NS_END
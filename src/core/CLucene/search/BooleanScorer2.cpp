@@ -19,6 +19,7 @@
 #include "_BooleanScorer.h"
 #include "_ConjunctionScorer.h"
 #include "_DisjunctionSumScorer.h"
+#include <limits>
 
 CL_NS_USE(util)
 CL_NS_DEF(search)
@@ -65,6 +66,17 @@ public:
     {
         return coordFactors[nrMatchers];
     }
+
+    float_t maxCoordFactor() const
+    {
+        float_t max = 0.0f;
+        for (int32_t i = 0; i <= maxCoord; i++)
+        {
+            if (coordFactors[i] > max)
+                max = coordFactors[i];
+        }
+        return max;
+    }
 };
 
 class BooleanScorer2::SingleMatchScorer : public Scorer
@@ -109,6 +121,41 @@ public:
         return scorer->skipTo(docNr);
     }
 
+    bool nextCandidate()
+    {
+        return scorer->nextCandidate();
+    }
+
+    bool skipToCandidate(int32_t docNr)
+    {
+        return scorer->skipToCandidate(docNr);
+    }
+
+    bool matches()
+    {
+        return scorer->matches();
+    }
+
+    int64_t cost() const
+    {
+        return scorer->cost();
+    }
+
+    void setMinCompetitiveScore(const float_t minScore)
+    {
+        scorer->setMinCompetitiveScore(minScore);
+    }
+
+    float_t maxScoreOutsideTier()
+    {
+        return scorer->maxScoreOutsideTier();
+    }
+
+    int32_t nextTierDoc(int32_t target)
+    {
+        return scorer->nextTierDoc(target);
+    }
+
     virtual std::wstring toString()
     {
         return scorer->toString();
@@ -144,6 +191,7 @@ public:
         return 0.0;
     }
     bool skipTo(int32_t /*target*/) { return false; }
+    int64_t cost() const { return 0; }
     virtual std::wstring toString() { return L"NonMatchingScorer"; }
 
     Explanation* explain(int32_t /*doc*/)
@@ -235,6 +283,26 @@ public:
         return reqScorer->skipTo(target);
     }
 
+    bool nextCandidate()
+    {
+        return reqScorer->nextCandidate();
+    }
+
+    bool skipToCandidate(int32_t target)
+    {
+        return reqScorer->skipToCandidate(target);
+    }
+
+    bool matches()
+    {
+        return reqScorer->matches();
+    }
+
+    int64_t cost() const
+    {
+        return reqScorer->cost();
+    }
+
     virtual std::wstring toString()
     {
         return L"ReqOptSumScorer";
@@ -297,6 +365,27 @@ public:
         return reqScorer->score();
     }
 
+    int64_t cost() const
+    {
+        return reqScorer == NULL ? 0 : reqScorer->cost();
+    }
+
+    void setMinCompetitiveScore(const float_t minScore)
+    {
+        if (reqScorer != NULL)
+            reqScorer->setMinCompetitiveScore(minScore);
+    }
+
+    float_t maxScoreOutsideTier()
+    {
+        return reqScorer == NULL ? 0.0f : reqScorer->maxScoreOutsideTier();
+    }
+
+    int32_t nextTierDoc(int32_t target)
+    {
+        return reqScorer == NULL ? LUCENE_INT32_MAX_SHOULDBE : reqScorer->nextTierDoc(target);
+    }
+
     virtual std::wstring toString()
     {
         return L"ReqExclScorer";
@@ -690,9 +779,14 @@ void BooleanScorer2::add(Scorer* scorer, bool required, bool prohibited)
 
 }
 
+bool BooleanScorer2::scoresDocsOutOfOrder() const
+{
+    return _internal->allowDocsOutOfOrder && _internal->requiredScorers.size() == 0 && _internal->prohibitedScorers.size() < 32;
+}
+
 void BooleanScorer2::score(HitCollector* hc)
 {
-    if (_internal->allowDocsOutOfOrder && _internal->requiredScorers.size() == 0 && _internal->prohibitedScorers.size() < 32)
+    if (scoresDocsOutOfOrder())
     {
 
         BooleanScorer* bs = _CLNEW BooleanScorer(getSimilarity(), _internal->minNrShouldMatch);
@@ -753,6 +847,71 @@ bool BooleanScorer2::skipTo(int32_t target)
     return _internal->countingSumScorer->skipTo(target);
 }
 
+bool BooleanScorer2::nextCandidate()
+{
+    if (_internal->countingSumScorer == NULL)
+    {
+        _internal->initCountingSumScorer();
+    }
+    return _internal->countingSumScorer->nextCandidate();
+}
+
+bool BooleanScorer2::skipToCandidate(int32_t target)
+{
+    if (_internal->countingSumScorer == NULL)
+    {
+        _internal->initCountingSumScorer();
+    }
+    return _internal->countingSumScorer->skipToCandidate(target);
+}
+
+bool BooleanScorer2::matches()
+{
+    return _internal->countingSumScorer->matches();
+}
+
+int64_t BooleanScorer2::cost() const
+{
+    if (_internal->countingSumScorer == NULL)
+    {
+        _internal->initCountingSumScorer();
+    }
+    return _internal->countingSumScorer->cost();
+}
+
+void BooleanScorer2::setMinCompetitiveScore(const float_t minScore)
+{
+    if (scoresDocsOutOfOrder())
+        return;
+    if (maxScoreOutsideTier() < minScore)
+    {
+        // the counting scorer bounds the sum before coord
+        const float_t maxCoordFactor = _internal->coordinator->maxCoordFactor();
+        if (maxCoordFactor > 0.0f)
+            _internal->countingSumScorer->setMinCompetitiveScore(minScore / maxCoordFactor);
+    }
+}
+
+float_t BooleanScorer2::maxScoreOutsideTier()
+{
+    if (scoresDocsOutOfOrder())
+        return std::numeric_limits<float_t>::infinity();
+    if (_internal->countingSumScorer == NULL)
+    {
+        _internal->initCountingSumScorer();
+    }
+    return _internal->countingSumScorer->maxScoreOutsideTier() * _internal->coordinator->maxCoordFactor();
+}
+
+int32_t BooleanScorer2::nextTierDoc(int32_t target)
+{
+    if (_internal->countingSumScorer == NULL)
+    {
+        _internal->initCountingSumScorer();
+    }
+    return _internal->countingSumScorer->nextTierDoc(target);
+}
+
 std::wstring BooleanScorer2::toString()
 {
     return L"BooleanScorer2";
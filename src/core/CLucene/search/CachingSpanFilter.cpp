@@ -114,4 +114,26 @@ std::wstring CachingSpanFilter::toString()
     return L"CachingSpanFilter(" + ft + L")";
 }
 
+bool CachingSpanFilter::equals( Filter* other ) const
+{
+    if( other->getObjectName() != getClassName() )
+        return false;
+    return filter->equals( static_cast<CachingSpanFilter*>( other )->filter );
+}
+
+size_t CachingSpanFilter::hashCode() const
+{
+    return filter->hashCode() ^ 0x2B5D9E17;
+}
+
+const std::wstring CachingSpanFilter::getObjectName() const
+{
+    return getClassName();
+}
+
+const std::wstring CachingSpanFilter::getClassName()
+{
+    return L"CachingSpanFilter";
+}
+
 CL_NS_END
\ No newline at end of file
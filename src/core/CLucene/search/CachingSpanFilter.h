@@ -45,17 +45,14 @@ public:
 
     virtual std::wstring toString();
 
+    virtual bool equals( Filter* other ) const;
+    virtual size_t hashCode() const;
+
+    static const std::wstring getClassName();
+    virtual const std::wstring getObjectName() const;
+
 private:
     SpanFilterResult * getCachedResult( CL_NS(index)::IndexReader * reader );
-
-//     public boolean equals(Object o) {
-//       if (!(o instanceof CachingSpanFilter)) return false;
-//       return this.filter.equals(((CachingSpanFilter)o).filter);
-//     }
-//   
-//     public int hashCode() {
-//       return filter.hashCode() ^ 0x1117BF25;
-//     }
 };
 
 CL_NS_END
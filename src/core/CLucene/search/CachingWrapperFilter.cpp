@@ -98,6 +98,20 @@ std::wstring CachingWrapperFilter::toString(){
 	
 	return L"CachingWrapperFilter(" + fs + L")";
 }
+bool CachingWrapperFilter::equals(Filter* other) const{
+	if ( other->getObjectName() != getClassName() )
+		return false;
+	return filter->equals(static_cast<CachingWrapperFilter*>(other)->filter);
+}
+size_t CachingWrapperFilter::hashCode() const{
+	return filter->hashCode() ^ 0x1117BF25;
+}
+const std::wstring CachingWrapperFilter::getObjectName() const{
+	return getClassName();
+}
+const std::wstring CachingWrapperFilter::getClassName(){
+	return L"CachingWrapperFilter";
+}
 BitSet* CachingWrapperFilter::doBits(IndexReader* reader){
 	return filter->bits(reader);
 }
@@ -62,6 +62,13 @@ public:
 
     Filter *clone() const;
     std::wstring toString();
+
+    /** Compares the wrapped filters */
+    bool equals(Filter* other) const;
+    size_t hashCode() const;
+
+    static const std::wstring getClassName();
+    const std::wstring getObjectName() const;
 };
 
 CL_NS_END
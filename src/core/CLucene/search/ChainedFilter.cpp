@@ -24,26 +24,46 @@ ChainedFilter::ChainedFilter( Filter ** _filters, int _op ):
 	Filter(),
 	filters(_filters),
 	logicArray(NULL),
-	logic(_op)
+	logic(_op),
+	ownsFilters(false)
 {
 }
 ChainedFilter::ChainedFilter( Filter** _filters, int* _array ):
 	Filter(),
 	filters(_filters),
 	logicArray(_array),
-	logic(-1)
+	logic(-1),
+	ownsFilters(false)
 {
 }
 ChainedFilter::ChainedFilter( const ChainedFilter& copy ) :
 	Filter(copy),
-	logicArray( copy.logicArray ),
-	logic( copy.logic )
+	logicArray( NULL ),
+	logic( copy.logic ),
+	ownsFilters(true)
 {
-	filters = copy.filters;
+	size_t count = 0;
+	while ( copy.filters[count] != NULL )
+		count++;
+
+	filters = _CL_NEWARRAY(Filter*, count + 1);
+	for ( size_t i = 0; i < count; i++ )
+		filters[i] = copy.filters[i]->clone();
+	filters[count] = NULL;
+
+	if ( copy.logicArray != NULL ){
+		logicArray = _CL_NEWARRAY(int, count);
+		memcpy(logicArray, copy.logicArray, count * sizeof(int));
+	}
 }
 ChainedFilter::~ChainedFilter(void)
 {
-
+	if ( ownsFilters ){
+		for ( Filter** filter = filters; *filter != NULL; filter++ )
+			_CLDELETE(*filter);
+		_CLDELETE_ARRAY(filters);
+		_CLDELETE_ARRAY(logicArray);
+	}
 }
 
 Filter* ChainedFilter::clone() const {
@@ -92,6 +112,46 @@ std::wstring ChainedFilter::toString()
 	return buf;
 }
 
+bool ChainedFilter::equals(Filter* other) const
+{
+	if ( other->getObjectName() != getClassName() )
+		return false;
+
+	ChainedFilter* cf = static_cast<ChainedFilter*>(other);
+	size_t i = 0;
+	for ( ; filters[i] != NULL && cf->filters[i] != NULL; i++ ){
+		if ( logicAt(i) != cf->logicAt(i) )
+			return false;
+		if ( !filters[i]->equals(cf->filters[i]) )
+			return false;
+	}
+	return filters[i] == NULL && cf->filters[i] == NULL;
+}
+
+size_t ChainedFilter::hashCode() const
+{
+	size_t h = 0;
+	for ( size_t i = 0; filters[i] != NULL; i++ )
+		h = 31 * h + (filters[i]->hashCode() ^ (size_t)logicAt(i));
+	return h;
+}
+
+int ChainedFilter::logicAt(size_t i) const
+{
+	if ( logic != -1 )
+		return logic;
+	return logicArray != NULL ? logicArray[i] : DEFAULT;
+}
+
+const std::wstring ChainedFilter::getObjectName() const
+{
+	return getClassName();
+}
+const std::wstring ChainedFilter::getClassName()
+{
+	return L"ChainedFilter";
+}
+
 
 /** Returns a BitSet with true for documents which should be permitted in
 search results, and false for those that should not. */
@@ -62,12 +62,16 @@ protected:
 	Filter **filters;
 	int	    *logicArray;
 	int		 logic;
+	bool	 ownsFilters; //true for clones, which copy the chain so they can outlive it
 	
 	ChainedFilter( const ChainedFilter& copy );
 	CL_NS(util)::BitSet* bits( CL_NS(index)::IndexReader* reader, int logic );
 	CL_NS(util)::BitSet* bits( CL_NS(index)::IndexReader* reader, int* logicArray );
 	CL_NS(util)::BitSet* doChain( CL_NS(util)::BitSet* result, CL_NS(index)::IndexReader* reader, int logic, Filter* filter );
 
+	//the operation bits() applies for the i-th filter of the chain
+	int logicAt(size_t i) const;
+
 	virtual void doUserChain( CL_NS(util)::BitSet* chain, CL_NS(util)::BitSet* filter, int logic );
 	virtual const wchar_t* getLogicString(int logic);
 public:
@@ -82,6 +86,13 @@ public:
 	virtual Filter* clone() const;
 	
 	std::wstring toString();
+
+	/** Compares the logic and each filter of the chain, in order */
+	bool equals(Filter* other) const;
+	size_t hashCode() const;
+
+	static const std::wstring getClassName();
+	const std::wstring getObjectName() const;
 };
 
 CL_NS_END
@@ -55,6 +55,16 @@ int32_t ConjunctionScorer::doc()  const
 }
 
 bool ConjunctionScorer::next()
+{
+    while (nextCandidate())
+    {
+        if (matches())
+            return true;
+    }
+    return false;
+}
+
+bool ConjunctionScorer::nextCandidate()
 {
     if (firstTime)
     {
@@ -62,76 +72,108 @@ bool ConjunctionScorer::next()
     }
     else if (more)
     {
-        more = scorers->values[(scorers->length - 1)]->next();
+        more = scorers->values[0]->nextCandidate();
     }
     return doNext();
 }
 
 bool ConjunctionScorer::doNext()
 {
-    int32_t first = 0;
-    Scorer* lastScorer = scorers->values[scorers->length - 1];
-    Scorer* firstScorer;
-    while (more && (firstScorer = scorers->values[first])->doc() < (lastDoc = lastScorer->doc()))
+    if (!more)
+        return false;
+    Scorer* lead = scorers->values[0];
+    int32_t target = lead->doc();
+    for (size_t i = 1; i < scorers->length; )
     {
-        more = firstScorer->skipTo(lastDoc);
-        lastScorer = firstScorer;
-        first = (first == (scorers->length - 1)) ? 0 : first + 1;
+        Scorer* other = scorers->values[i];
+        if (other->doc() < target && !other->skipToCandidate(target))
+        {
+            more = false;
+            return false;
+        }
+        const int32_t otherDoc = other->doc();
+        if (otherDoc > target)
+        {
+            // overshot: the lead skips ahead, and the others follow it from the start
+            if (!lead->skipToCandidate(otherDoc))
+            {
+                more = false;
+                return false;
+            }
+            target = lead->doc();
+            i = 1;
+        }
+        else
+        {
+            i++;
+        }
     }
-    return more;
+    lastDoc = target;
+    return true;
 }
 
 bool ConjunctionScorer::skipTo(int32_t target)
+{
+    if (!skipToCandidate(target))
+        return false;
+    return matches() || next();
+}
+
+bool ConjunctionScorer::skipToCandidate(int32_t target)
 {
     if (firstTime)
         return init(target);
     else if (more)
-        more = scorers->values[(scorers->length - 1)]->skipTo(target);
+        more = scorers->values[0]->skipToCandidate(target);
     return doNext();
 }
-int ConjunctionScorer_sort(const void* _elem1, const void* _elem2)
+
+bool ConjunctionScorer::matches()
 {
-    const Scorer* elem1 = *(const Scorer**) _elem1;
-    const Scorer* elem2 = *(const Scorer**) _elem2;
-    return elem1->doc() - elem2->doc();
+    // every sub-scorer is on lastDoc: only now let them do the costly checks
+    for (size_t i = 0; i < scorers->length; i++)
+    {
+        if (!scorers->values[i]->matches())
+            return false;
+    }
+    return true;
+}
+
+int64_t ConjunctionScorer::cost() const
+{
+    int64_t min = LUCENE_INT32_MAX_SHOULDBE;
+    for (size_t i = 0; i < scorers->length; i++)
+    {
+        const int64_t c = scorers->values[i]->cost();
+        if (c < min)
+            min = c;
+    }
+    return min;
+}
+
+static bool ConjunctionScorer_byCost(const Scorer* elem1, const Scorer* elem2)
+{
+    return elem1->cost() < elem2->cost();
 }
 
 bool ConjunctionScorer::init(int32_t target)
 {
     firstTime = false;
-    more = scorers->length > 1;
-
+    more = scorers->length > 0;
 
     for (size_t i = 0; i < scorers->length; i++)
     {
-        more = target == 0 ? scorers->values[i]->next() : scorers->values[i]->skipTo(target);
+        more = target == 0 ? scorers->values[i]->nextCandidate() : scorers->values[i]->skipToCandidate(target);
         if (!more)
             return false;
     }
 
-    // Sort the array the first time...
-    // We don't need to sort the array in any future calls because we know
-    // it will already start off sorted (all scorers on same doc).
-
-    // note that this comparator is not consistent with equals!
-    qsort(scorers->values, scorers->length, sizeof(Scorer*), ConjunctionScorer_sort);
-
-    doNext();
+    // The rarest sub-scorer leads, and the more common ones are asked to
+    // skip in the order of their cost, so that a document is rejected by
+    // the clause most likely to reject it. The order is kept from now on.
+    std::stable_sort(scorers->values, scorers->values + scorers->length, ConjunctionScorer_byCost);
 
-    // If first-time skip distance is any predictor of
-    // scorer sparseness, then we should always try to skip first on
-    // those scorers.
-    // Keep last scorer in it's last place (it will be the first
-    // to be skipped on), but reverse all of the others so that
-    // they will be skipped on in order of original high skip.
-    int32_t end = (scorers->length - 1) - 1;
-    for (int32_t i = 0; i < (end >> 1); i++)
-    {
-        Scorer* tmp = scorers->values[i];
-        scorers->values[i] = scorers->values[end - i];
-        scorers->values[end - i] = tmp;
-    }
-    return more;
+    return doNext();
 }
 
 float_t ConjunctionScorer::score()
@@ -13,6 +13,8 @@
 #include "Scorer.h"
 #include "RangeFilter.h"
 #include "Similarity.h"
+#include "FilterCache.h"
+#include "Searchable.h"
 #include "CLucene/index/IndexReader.h"
 #include "CLucene/util/BitSet.h"
 #include "CLucene/util/StringBuffer.h"
@@ -25,23 +27,23 @@ CL_NS_DEF(search)
 
 class ConstantScorer : public Scorer
 {
-    BitSet* bits;
+    DocIdSet* docs;
     const float_t theScore;
     int32_t _doc;
 
 public:
-    ConstantScorer(Similarity* similarity, IndexReader* reader, Weight* w, Filter* filter) : Scorer(similarity),
-        bits(filter->bits(reader)), theScore(w->getValue()), _doc(-1)
+    ConstantScorer(Similarity* similarity, DocIdSet* _docs, Weight* w) : Scorer(similarity),
+        docs(_docs), theScore(w->getValue()), _doc(-1)
     {
     }
     virtual ~ConstantScorer()
     {
-        _CLLDELETE(bits);
+        _CLDECDELETE(docs);
     }
 
     bool next()
     {
-        _doc = bits->nextSetBit(_doc + 1);
+        _doc = docs->nextSetBit(_doc + 1);
         return _doc >= 0;
     }
 
@@ -57,10 +59,15 @@ public:
 
     bool skipTo(int32_t target)
     {
-        _doc = bits->nextSetBit(target);
+        _doc = docs->nextSetBit(target);
         return _doc >= 0;
     }
 
+    int64_t cost() const
+    {
+        return docs->count();
+    }
+
     Explanation* explain(int32_t /*doc*/)
     {
         _CLTHROWA(CL_ERR_UnsupportedOperation, "Unsupported operation at ConstantScoreQuery::explain");
@@ -81,13 +88,17 @@ private:
     float_t queryNorm;
     float_t queryWeight;
     const ConstantScoreQuery* parentQuery;
+    FilterCache* filterCache;
 
 public:
     ConstantWeight(ConstantScoreQuery* enclosingInstance, Searcher* searcher) :
         similarity(enclosingInstance->getSimilarity(searcher)),
         queryNorm(0), queryWeight(0),
-        parentQuery(enclosingInstance)
+        parentQuery(enclosingInstance),
+        filterCache(searcher->getFilterCache())
     {
+        if (filterCache != NULL)
+            filterCache->onUse(parentQuery->filter);
     }
     virtual ~ConstantWeight() {}
 
@@ -115,13 +126,20 @@ public:
 
     Scorer* scorer(IndexReader* reader)
     {
-        return _CLNEW ConstantScorer(similarity, reader, this, parentQuery->filter);
+        DocIdSet* docs;
+        if (filterCache != NULL) {
+            docs = filterCache->getDocIdSet(parentQuery->filter, reader);
+        } else {
+            BitSet* bits = parentQuery->filter->bits(reader);
+            docs = _CLNEW DocIdSet(bits, parentQuery->filter->shouldDeleteBitSet(bits));
+        }
+        return _CLNEW ConstantScorer(similarity, docs, this);
     }
 
     Explanation* explain(IndexReader* reader, int32_t doc)
     {
         ConstantScorer* cs = (ConstantScorer*) scorer(reader);
-        bool exists = cs->bits->get(doc);
+        bool exists = cs->docs->get(doc);
         _CLDELETE(cs);
 
         ComplexExplanation* result = _CLNEW ComplexExplanation();
@@ -99,4 +99,22 @@ CL_NS_DEF(search)
     _CLDELETE_CARRAY(ret);
 	return r;
   }
+
+  bool DateFilter::equals(Filter* other) const{
+	if ( other->getObjectName() != getClassName() )
+		return false;
+	DateFilter* df = static_cast<DateFilter*>(other);
+	return start->equals(df->start) && end->equals(df->end);
+  }
+
+  size_t DateFilter::hashCode() const{
+	return start->hashCode() ^ (end->hashCode() * 31);
+  }
+
+  const std::wstring DateFilter::getObjectName() const{
+	return getClassName();
+  }
+  const std::wstring DateFilter::getClassName(){
+	return L"DateFilter";
+  }
 CL_NS_END
@@ -58,6 +58,12 @@ CL_NS_DEF(search)
 	Filter* clone() const;
 	
 	std::wstring toString();
+
+	bool equals(Filter* other) const;
+	size_t hashCode() const;
+
+	static const std::wstring getClassName();
+	const std::wstring getObjectName() const;
   };
 CL_NS_END
 #endif
@@ -14,6 +14,7 @@
 #include "Explanation.h"
 
 #include "CLucene/util/StringBuffer.h"
+#include <limits>
 
 #include "_DisjunctionSumScorer.h"
 
@@ -27,6 +28,7 @@ DisjunctionSumScorer::DisjunctionSumScorer( DisjunctionSumScorer::ScorersType* _
     queueSize(-1),
     currentDoc(-1),
     currentScore(-1.0f),
+    tierOnly(false),
     nrScorers(0),
     _nrMatchers(-1)
 {
@@ -59,6 +61,10 @@ void DisjunctionSumScorer::score( HitCollector* hc )
 
 bool DisjunctionSumScorer::next()
 {
+	if ( tierOnly ) {
+		const int32_t target = nextTierDoc( currentDoc + 1 );
+		return target != LUCENE_INT32_MAX_SHOULDBE && skipTo( target );
+	}
 	if ( scorerDocQueue == NULL ) {
 		initScorerDocQueue();
 	}
@@ -74,6 +80,14 @@ int32_t DisjunctionSumScorer::doc() const
 	return currentDoc;
 }
 
+int64_t DisjunctionSumScorer::cost() const
+{
+	int64_t sum = 0;
+	for (ScorersType::const_iterator it = subScorers.begin(); it != subScorers.end(); ++it)
+		sum += (*it)->cost();
+	return sum;
+}
+
 int32_t DisjunctionSumScorer::nrMatchers() const
 {
 	return _nrMatchers;
@@ -101,6 +115,32 @@ bool DisjunctionSumScorer::skipTo( int32_t target )
 	} while ( true );
 }
 
+void DisjunctionSumScorer::setMinCompetitiveScore( const float_t minScore )
+{
+	if ( !tierOnly && maxScoreOutsideTier() < minScore )
+		tierOnly = true;
+}
+
+float_t DisjunctionSumScorer::maxScoreOutsideTier()
+{
+	float_t sum = 0.0f;
+	for ( ScorersType::iterator it = subScorers.begin(); it != subScorers.end(); ++it )
+		sum += (*it)->maxScoreOutsideTier();
+	// the subscorers' scores are added up in another order
+	return sum * ( 1.0f + 2 * nrScorers * std::numeric_limits<float_t>::epsilon() );
+}
+
+int32_t DisjunctionSumScorer::nextTierDoc( int32_t target )
+{
+	int32_t next = LUCENE_INT32_MAX_SHOULDBE;
+	for ( ScorersType::iterator it = subScorers.begin(); it != subScorers.end(); ++it ) {
+		const int32_t doc = (*it)->nextTierDoc( target );
+		if ( doc < next )
+			next = doc;
+	}
+	return next;
+}
+
 std::wstring DisjunctionSumScorer::toString()
 {
 	return L"DisjunctionSumScorer";
@@ -92,18 +92,30 @@ bool FieldSortedHitQueue::lessThan (FieldDoc* docA, FieldDoc* docB) {
     if (docA->scoreDoc.score > maxscore) maxscore = docA->scoreDoc.score;
     if (docB->scoreDoc.score > maxscore) maxscore = docB->scoreDoc.score;
 
-    // run comparators
-    int32_t c = 0;
-	for ( int32_t i=0; c==0 && i<comparatorsLen; ++i ) {
-		c = (fields[i]->getReverse()) ? comparators[i]->compare (&docB->scoreDoc, &docA->scoreDoc) : 
-			comparators[i]->compare (&docA->scoreDoc, &docB->scoreDoc);
-    }
+    int32_t c = compare (docA->scoreDoc, docB->scoreDoc);
     // avoid random sort order that could lead to duplicates (bug #31241):
     if (c == 0)
       return docA->scoreDoc.doc > docB->scoreDoc.doc;
     return c > 0;
 }
 
+int32_t FieldSortedHitQueue::compare (const ScoreDoc& a, const ScoreDoc& b) const {
+    ScoreDoc* docA = const_cast<ScoreDoc*>(&a);
+    ScoreDoc* docB = const_cast<ScoreDoc*>(&b);
+
+    // run comparators
+    int32_t c = 0;
+	for ( int32_t i=0; c==0 && i<comparatorsLen; ++i ) {
+		c = (fields[i]->getReverse()) ? comparators[i]->compare (docB, docA) : 
+			comparators[i]->compare (docA, docB);
+    }
+    return c;
+}
+
+void FieldSortedHitQueue::setMaxScore (const float_t maxScore) {
+    this->maxscore = maxScore;
+}
+
 
 //static
 ScoreDocComparator* FieldSortedHitQueue::comparatorString (IndexReader* reader, const wchar_t* field) {
@@ -183,6 +183,20 @@ public:
    */
 	FieldDoc* fillFields (FieldDoc* doc) const;
 
+  /**
+   * Compares two hits by the sort fields: negative if <code>a</code> sorts
+   * before <code>b</code>, positive if it sorts after, and 0 if the fields
+   * are equal. lessThan() breaks ties by document number.
+   */
+	int32_t compare (const struct ScoreDoc& a, const struct ScoreDoc& b) const;
+
+  /**
+   * Sets the highest score of the hits, which fillFields() normalizes by.
+   * The queue tracks it for the hits it is given, a collector that keeps
+   * its own hits must set it.
+   */
+	void setMaxScore (const float_t maxScore);
+
 	void setFields (SortField** fields){
 		this->fields = fields;
 	}
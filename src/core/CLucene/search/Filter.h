@@ -41,6 +41,20 @@ public:
 
     //Creates a user-readable version of this query and returns it as as string
     virtual std::wstring toString() = 0;
+
+    /**
+    * Returns true if <code>other</code> permits exactly the same documents as
+    * this filter in every reader. Caches use this, with {@link #hashCode}, to
+    * tell filters apart. The default compares identity; filters that can be
+    * recreated from their parameters override both.
+    */
+    virtual bool equals(Filter* other) const { return this == other; }
+
+    //Returns a hash code consistent with equals
+    virtual size_t hashCode() const { return (size_t)this; }
+
+    //Returns the name of the concrete filter class, which equals compares first
+    virtual const std::wstring getObjectName() const { return L"Filter"; }
 };
 CL_NS_END
 #endif
@@ -0,0 +1,276 @@
+/*------------------------------------------------------------------------------
+* Copyright (C) 2003-2006 Ben van Klinken and the CLucene Team
+
+* Updated by https://github.com/farfella/.
+*
+* Distributable under the terms of either the Apache License (Version 2.0) or
+* the GNU Lesser General Public License, as specified in the COPYING file.
+------------------------------------------------------------------------------*/
+#include "CLucene/_ApiHeader.h"
+#include "FilterCache.h"
+#include "Filter.h"
+#include "CLucene/index/IndexReader.h"
+
+CL_NS_USE(index)
+CL_NS_USE(util)
+CL_NS_DEF(search)
+
+DocIdSet::DocIdSet(BitSet* _bits, const bool _deleteBits):
+	bits(_bits),
+	deleteBits(_deleteBits),
+	docs(NULL),
+	length(0)
+{
+}
+
+DocIdSet::DocIdSet(int32_t* _docs, const int32_t _length):
+	bits(NULL),
+	deleteBits(false),
+	docs(_docs),
+	length(_length)
+{
+}
+
+DocIdSet::~DocIdSet(){
+	if (deleteBits)
+		_CLDELETE(bits);
+	_CLDELETE_ARRAY(docs);
+}
+
+DocIdSet* DocIdSet::compact(BitSet* bits){
+	const int32_t count = bits->count();
+	if ((size_t)count * sizeof(int32_t) >= (size_t)bits->size() / 8)
+		return _CLNEW DocIdSet(bits->clone(), true);
+
+	int32_t* docs = _CL_NEWARRAY(int32_t, count > 0 ? count : 1);
+	int32_t length = 0;
+	for (int32_t doc = bits->nextSetBit(0); doc >= 0 && length < count; doc = bits->nextSetBit(doc + 1))
+		docs[length++] = doc;
+	return _CLNEW DocIdSet(docs, length);
+}
+
+bool DocIdSet::isSparse() const{
+	return bits == NULL;
+}
+
+int32_t DocIdSet::count(){
+	return bits == NULL ? length : bits->count();
+}
+
+size_t DocIdSet::getSizeInBytes() const{
+	if (bits != NULL)
+		return sizeof(DocIdSet) + sizeof(BitSet) + bits->size() / 8 + 1;
+	return sizeof(DocIdSet) + length * sizeof(int32_t);
+}
+
+
+struct FilterCache::Entry {
+	Key key;
+	Filter* filter;     // a copy, to compare others with
+	DocIdSet* docs;
+	size_t bytes;
+	EntryList::iterator position;
+
+	Entry(): filter(NULL), docs(NULL), bytes(0){}
+	~Entry(){
+		_CLDELETE(filter);
+		_CLDECDELETE(docs);
+	}
+};
+
+struct FilterCache::Use {
+	Filter* filter;     // a copy, to compare others with
+	int32_t count;
+
+	Use(Filter* _filter): filter(_filter), count(0){}
+	~Use(){
+		_CLDELETE(filter);
+	}
+};
+
+std::set<FilterCache*> FilterCache::caches;
+DEFINE_MUTEX(FilterCache::caches_LOCK)
+
+FilterCache::FilterCache(const size_t _maxBytes, const int32_t _minUses, const int32_t _historySize):
+	maxBytes(_maxBytes),
+	bytes(0),
+	minUses(_minUses),
+	historySize(_historySize > 0 ? _historySize : 1),
+	hitCount(0),
+	missCount(0),
+	evictionCount(0)
+{
+	SCOPED_LOCK_MUTEX(caches_LOCK)
+	caches.insert(this);
+}
+
+FilterCache::~FilterCache(){
+	{
+		SCOPED_LOCK_MUTEX(caches_LOCK)
+		caches.erase(this);
+	}
+	clear();
+}
+
+FilterCache::EntryMap::iterator FilterCache::find(const Key& key, Filter* filter){
+	std::pair<EntryMap::iterator, EntryMap::iterator> range = index.equal_range(key);
+	for (EntryMap::iterator itr = range.first; itr != range.second; ++itr) {
+		if (itr->second->filter->equals(filter))
+			return itr;
+	}
+	return index.end();
+}
+
+FilterCache::UseMap::iterator FilterCache::findUse(const size_t hash, Filter* filter){
+	std::pair<UseMap::iterator, UseMap::iterator> range = uses.equal_range(hash);
+	for (UseMap::iterator itr = range.first; itr != range.second; ++itr) {
+		if (itr->second->filter->equals(filter))
+			return itr;
+	}
+	return uses.end();
+}
+
+void FilterCache::onUse(Filter* filter){
+	const size_t hash = filter->hashCode();
+	SCOPED_LOCK_MUTEX(THIS_LOCK)
+	UseMap::iterator used = findUse(hash, filter);
+	if (used == uses.end())
+		used = uses.insert(std::make_pair(hash, _CLNEW Use(filter->clone())));
+	Use* use = used->second;
+	use->count++;
+	history.push_back(use);
+	if (history.size() > historySize) {
+		Use* oldest = history.front();
+		history.pop_front();
+		if (--oldest->count == 0) {
+			std::pair<UseMap::iterator, UseMap::iterator> range = uses.equal_range(oldest->filter->hashCode());
+			for (UseMap::iterator itr = range.first; itr != range.second; ++itr) {
+				if (itr->second == oldest) {
+					uses.erase(itr);
+					break;
+				}
+			}
+			_CLDELETE(oldest);
+		}
+	}
+}
+
+DocIdSet* FilterCache::getDocIdSet(Filter* filter, IndexReader* reader){
+	const Key key(reader, filter->hashCode());
+	bool admit;
+	{
+		SCOPED_LOCK_MUTEX(THIS_LOCK)
+		EntryMap::iterator found = find(key, filter);
+		if (found != index.end()) {
+			hitCount++;
+			Entry* entry = found->second;
+			entries.splice(entries.begin(), entries, entry->position);
+			return _CL_POINTER(entry->docs);
+		}
+		missCount++;
+		UseMap::iterator used = findUse(key.second, filter);
+		admit = used != uses.end() && used->second->count >= minUses;
+	}
+
+	BitSet* bits = filter->bits(reader);
+	if (!admit)
+		return _CLNEW DocIdSet(bits, filter->shouldDeleteBitSet(bits));
+
+	DocIdSet* docs = DocIdSet::compact(bits);
+	if (filter->shouldDeleteBitSet(bits))
+		_CLDELETE(bits);
+	Entry* entry = _CLNEW Entry();
+	entry->key = key;
+	entry->bytes = sizeof(Entry) + docs->getSizeInBytes();
+	if (entry->bytes > maxBytes) {
+		_CLDELETE(entry);
+		return docs;
+	}
+	entry->filter = filter->clone();
+	entry->docs = _CL_POINTER(docs);
+
+	SCOPED_LOCK_MUTEX(THIS_LOCK)
+	EntryMap::iterator found = find(key, filter);
+	if (found != index.end())                      // cached by another thread in the meantime
+		remove(found->second);
+	entries.push_front(entry);
+	entry->position = entries.begin();
+	index.insert(std::make_pair(key, entry));
+	bytes += entry->bytes;
+	reader->addCloseCallback(closeCallback, NULL);
+	while (bytes > maxBytes) {
+		remove(entries.back());                    // least recently used
+		evictionCount++;
+	}
+	return docs;
+}
+
+void FilterCache::remove(Entry* entry){
+	std::pair<EntryMap::iterator, EntryMap::iterator> range = index.equal_range(entry->key);
+	for (EntryMap::iterator itr = range.first; itr != range.second; ++itr) {
+		if (itr->second == entry) {
+			index.erase(itr);
+			break;
+		}
+	}
+	entries.erase(entry->position);
+	bytes -= entry->bytes;
+	_CLDELETE(entry);
+}
+
+void FilterCache::clear(){
+	SCOPED_LOCK_MUTEX(THIS_LOCK)
+	while (!entries.empty())
+		remove(entries.front());
+	history.clear();
+	for (UseMap::iterator itr = uses.begin(); itr != uses.end(); ++itr)
+		_CLDELETE(itr->second);
+	uses.clear();
+}
+
+int32_t FilterCache::getUseCount(Filter* filter){
+	const size_t hash = filter->hashCode();
+	SCOPED_LOCK_MUTEX(THIS_LOCK)
+	UseMap::iterator used = findUse(hash, filter);
+	return used == uses.end() ? 0 : used->second->count;
+}
+
+void FilterCache::removeSegment(IndexReader* reader){
+	SCOPED_LOCK_MUTEX(THIS_LOCK)
+	EntryMap::iterator itr = index.lower_bound(Key(reader, 0));
+	while (itr != index.end() && itr->first.first == reader) {
+		Entry* entry = itr->second;
+		++itr;
+		remove(entry);
+	}
+}
+
+void FilterCache::closeCallback(IndexReader* reader, void* /*param*/){
+	SCOPED_LOCK_MUTEX(caches_LOCK)
+	for (std::set<FilterCache*>::iterator itr = caches.begin(); itr != caches.end(); ++itr)
+		(*itr)->removeSegment(reader);
+}
+
+int64_t FilterCache::getHitCount() const{
+	return hitCount;
+}
+int64_t FilterCache::getMissCount() const{
+	return missCount;
+}
+int64_t FilterCache::getEvictionCount() const{
+	return evictionCount;
+}
+size_t FilterCache::size() const{
+	return index.size();
+}
+size_t FilterCache::getSizeInBytes() const{
+	return bytes;
+}
+size_t FilterCache::getMaxBytes() const{
+	return maxBytes;
+}
+int32_t FilterCache::getMinUses() const{
+	return minUses;
+}
+
+CL_NS_END
@@ -0,0 +1,157 @@
+/*------------------------------------------------------------------------------
+* Copyright (C) 2003-2006 Ben van Klinken and the CLucene Team
+
+* Updated by https://github.com/farfella/.
+*
+* Distributable under the terms of either the Apache License (Version 2.0) or
+* the GNU Lesser General Public License, as specified in the COPYING file.
+------------------------------------------------------------------------------*/
+#ifndef _lucene_search_FilterCache_
+#define _lucene_search_FilterCache_
+
+#include "CLucene/util/BitSet.h"
+#include <algorithm>
+#include <deque>
+#include <list>
+#include <map>
+#include <set>
+
+CL_CLASS_DEF(index,IndexReader)
+
+CL_NS_DEF(search)
+class Filter;
+
+/**
+* The documents a filter permits in one reader, held as a BitSet when
+* they are many, or as the list of their numbers when they are few.
+* Reference counted: release it with _CLDECDELETE.
+*/
+class CLUCENE_EXPORT DocIdSet: LUCENE_REFBASE {
+private:
+	CL_NS(util)::BitSet* bits;   // NULL when the documents are listed
+	bool deleteBits;
+	int32_t* docs;               // in order
+	int32_t length;
+	DocIdSet(int32_t* docs, const int32_t length);
+public:
+	/** Holds <code>bits</code>, and deletes them with the set if <code>deleteBits</code> */
+	DocIdSet(CL_NS(util)::BitSet* bits, const bool deleteBits);
+	~DocIdSet();
+
+	/** Copies <code>bits</code> into the smaller of the two forms */
+	static DocIdSet* compact(CL_NS(util)::BitSet* bits);
+
+	/** Returns the first document on or after <code>from</code>, or -1. See BitSet#nextSetBit */
+	inline int32_t nextSetBit(const int32_t from) const{
+		if (bits != NULL)
+			return bits->nextSetBit(from);
+		const int32_t* next = std::lower_bound(docs, docs + length, from);
+		return next == docs + length ? -1 : *next;
+	}
+
+	inline bool get(const int32_t doc) const{
+		if (bits != NULL)
+			return bits->get(doc);
+		return std::binary_search(docs, docs + length, doc);
+	}
+
+	/** True if the documents are listed rather than held as bits */
+	bool isSparse() const;
+
+	/** The number of documents in the set */
+	int32_t count();
+
+	/** The memory the set holds */
+	size_t getSizeInBytes() const;
+};
+
+/**
+* Caches the documents that filters permit in each segment, for the
+* filters that searches use often. IndexSearcher filters each segment on
+* its own through the cache of its Searcher (see Searcher#setFilterCache),
+* and so does ConstantScoreQuery.
+*
+* <p>A filter is cached once it was used by <code>minUses</code> of the
+* last <code>historySize</code> searches; the others are computed every
+* time, as without a cache. Filters are told apart by Filter#equals and
+* Filter#hashCode, on copies the cache keeps, so a filter that does not
+* override them is never found again and is not cached. The
+* results are held per segment, so that a reopened index finds those of
+* the segments it shares with the old one, and are dropped when their
+* segment is closed. A segment whose deletions change is a new reader, and
+* its results are computed again.</p>
+*
+* <p>A result that permits few documents is held as the list of their
+* numbers, a larger one as bits (see DocIdSet). The cache holds
+* approximately no more than the number of bytes it is given, evicting the
+* least recently used result first. A cache may be shared by several
+* searchers, and is thread safe.</p>
+*/
+class CLUCENE_EXPORT FilterCache: LUCENE_BASE {
+public:
+	FilterCache(const size_t maxBytes = 32 * 1024 * 1024, const int32_t minUses = 5, const int32_t historySize = 256);
+	~FilterCache();
+
+	/** Records that a search uses <code>filter</code>. Called once for each search */
+	void onUse(Filter* filter);
+
+	/**
+	* Returns the documents <code>filter</code> permits in <code>reader</code>,
+	* usually a segment, from the cache, or computed by the filter, and
+	* cached if the filter is used often. Release them with _CLDECDELETE.
+	*/
+	DocIdSet* getDocIdSet(Filter* filter, CL_NS(index)::IndexReader* reader);
+
+	/** Drops every result, and forgets how often filters were used */
+	void clear();
+
+	/** The number of times <code>filter</code> was used in the recent searches */
+	int32_t getUseCount(Filter* filter);
+
+	/** The number of results found in the cache */
+	int64_t getHitCount() const;
+	/** The number of results computed by their filters */
+	int64_t getMissCount() const;
+	/** The number of results evicted to make room for others */
+	int64_t getEvictionCount() const;
+	/** The number of results */
+	size_t size() const;
+	/** The approximate memory held by the results */
+	size_t getSizeInBytes() const;
+	size_t getMaxBytes() const;
+	int32_t getMinUses() const;
+
+private:
+	struct Entry;
+	struct Use;
+	typedef std::list<Entry*> EntryList;
+	typedef std::pair<CL_NS(index)::IndexReader*, size_t> Key;   // segment, filter hash
+	typedef std::multimap<Key, Entry*> EntryMap;
+	typedef std::multimap<size_t, Use*> UseMap;
+
+	EntryList entries;                    // most recently used first
+	EntryMap index;                       // by segment, then filter
+	std::deque<Use*> history;             // the filters of the recent searches
+	UseMap uses;                          // how often each is in the history, by hash
+	size_t maxBytes;
+	size_t bytes;
+	int32_t minUses;
+	size_t historySize;
+	int64_t hitCount;
+	int64_t missCount;
+	int64_t evictionCount;
+	DEFINE_MUTEX(THIS_LOCK)
+
+	void remove(Entry* entry);
+	EntryMap::iterator find(const Key& key, Filter* filter);
+	UseMap::iterator findUse(const size_t hash, Filter* filter);
+
+	/** The caches, so that a segment closing can be dropped from each */
+	static std::set<FilterCache*> caches;
+	STATIC_DEFINE_MUTEX(caches_LOCK)
+	static void closeCallback(CL_NS(index)::IndexReader* reader, void* param);
+	void removeSegment(CL_NS(index)::IndexReader* reader);
+};
+
+CL_NS_END
+#endif
@@ -51,7 +51,6 @@ protected:
 
 	void setEnum(CL_NS(index)::TermEnum* actualEnum) ;
 
-private:
 	CL_NS(index)::Term* currentTerm;
 	CL_NS(index)::TermEnum* actualEnum;
 
@@ -14,9 +14,11 @@
 #include "BooleanQuery.h"
 #include "BooleanClause.h"
 #include "TermQuery.h"
+#include "AutomatonTermEnum.h"
 
 #include "CLucene/util/StringBuffer.h"
 #include "CLucene/util/PriorityQueue.h"
+#include "CLucene/util/_Automaton.h"
 
 CL_NS_USE(index)
 CL_NS_USE(util)
@@ -58,9 +60,23 @@ CL_NS_DEF(search)
     prefixLength = realPrefixLength;
 
     initializeMaxDistances();
+    initializePeq();
 
     Term* trm = _CLNEW Term(searchTerm->field(), prefix); // _CLNEW Term(term, prefix); -- not intern'd?
-    setEnum(reader->terms(trm));
+    const int32_t maxEdits = maxAcceptedDistance();
+    Automaton* automaton = NULL;
+    if (textLen > 0 && textLen <= 64 && maxEdits <= MAX_AUTOMATON_EDITS)
+        automaton = Automaton::fromLevenshtein(prefix, prefixLength, text, textLen, maxEdits);
+    if (automaton != NULL)
+    {
+        //only visit terms the automaton accepts; termCompare still applies
+        //the exact, length dependent similarity threshold
+        setEnum(_CLNEW AutomatonTermEnum(reader, trm, automaton, true));
+    }
+    else
+    {
+        setEnum(reader->terms(trm));
+    }
     _CLLDECDELETE(trm);
 
 
@@ -177,6 +193,14 @@ float_t FuzzyTermEnum::similarity(const wchar_t* target, const size_t m)
         return 0.0f;
     }
 
+    if (n <= 64)
+    {
+        const int32_t distance = editDistance(target, m);
+        if ((uint32_t) distance > maxDistance)
+            return 0.0f;
+        return 1.0f - ((float_t) distance / (float_t) (prefixLength + cl_min(n, m)));
+    }
+
     //let's make sure we have enough room in our array to do the distance calculations.
     //Check if the array must be reallocated because it is too small or does not exist
     size_t dWidth = n + 1;
@@ -249,6 +273,90 @@ float_t FuzzyTermEnum::similarity(const wchar_t* target, const size_t m)
     return 1.0f - ((float_t) d[n + m * dWidth] / (float_t) (prefixLength + cl_min(n, m)));
 }
 
+void FuzzyTermEnum::initializePeq()
+{
+    memset(peqAscii, 0, sizeof(peqAscii));
+    peqCount = 0;
+    if (textLen > 64)
+        return;
+
+    for (size_t i = 0; i < textLen; i++)
+    {
+        const wchar_t c = text[i];
+        const uint64_t bit = ((uint64_t) 1) << i;
+        if (c >= 0 && c < 128)
+        {
+            peqAscii[c] |= bit;
+            continue;
+        }
+        int32_t j = 0;
+        while (j < peqCount && peqChars[j] != c)
+            j++;
+        if (j == peqCount)
+        {
+            peqChars[peqCount] = c;
+            peqMasks[peqCount++] = 0;
+        }
+        peqMasks[j] |= bit;
+    }
+}
+
+int32_t FuzzyTermEnum::editDistance(const wchar_t* target, const size_t m) const
+{
+    //Myers' bit-vector algorithm, in Hyyrö's formulation for the distance
+    //between whole strings: bit i of pv/mv is set when the distance in row
+    //i+1 of the current column is one more/less than in row i
+    const uint64_t last = ((uint64_t) 1) << (textLen - 1);
+    uint64_t pv = ~((uint64_t) 0);
+    uint64_t mv = 0;
+    int32_t score = (int32_t) textLen;
+
+    for (size_t j = 0; j < m; j++)
+    {
+        const wchar_t c = target[j];
+        uint64_t eq = 0;
+        if (c >= 0 && c < 128)
+            eq = peqAscii[c];
+        else
+        {
+            for (int32_t k = 0; k < peqCount; k++)
+            {
+                if (peqChars[k] == c)
+                {
+                    eq = peqMasks[k];
+                    break;
+                }
+            }
+        }
+
+        const uint64_t xv = eq | mv;
+        const uint64_t xh = (((eq & pv) + pv) ^ pv) | eq;
+        uint64_t ph = mv | ~(xh | pv);
+        uint64_t mh = pv & xh;
+        if (ph & last)
+            score++;
+        else if (mh & last)
+            score--;
+        ph = (ph << 1) | 1;
+        mh <<= 1;
+        pv = mh | ~(xv | ph);
+        mv = ph & xv;
+    }
+    return score;
+}
+
+int32_t FuzzyTermEnum::maxAcceptedDistance() const
+{
+    //a term is accepted when similarity() > minimumSimilarity, and the
+    //similarity is largest for terms at least as long as the text. Use the
+    //same arithmetic as similarity() so no accepted term is missed.
+    const float_t length = (float_t) (prefixLength + textLen);
+    int32_t distance = 0;
+    while (1.0f - ((float_t) (distance + 1) / length) > minimumSimilarity)
+        distance++;
+    return distance;
+}
+
 int32_t FuzzyTermEnum::getMaxDistance(const size_t m)
 {
     return (m < LUCENE_TYPICAL_LONGEST_WORD_IN_INDEX) ? maxDistances[m] : calculateMaxDistance(m);
@@ -305,13 +413,16 @@ protected:
 };
 
 
-FuzzyQuery::FuzzyQuery(Term* term, float_t _minimumSimilarity, size_t _prefixLength) :
+FuzzyQuery::FuzzyQuery(Term* term, float_t _minimumSimilarity, size_t _prefixLength, int32_t _maxExpansions) :
     MultiTermQuery(term),
     minimumSimilarity(_minimumSimilarity),
-    prefixLength(_prefixLength)
+    prefixLength(_prefixLength),
+    maxExpansions(_maxExpansions)
 {
     if (minimumSimilarity < 0)
         minimumSimilarity = defaultMinSimilarity;
+    if (maxExpansions < 0)
+        maxExpansions = defaultMaxExpansions;
 
     CND_PRECONDITION(term != NULL, L"term is NULL");
 
@@ -323,6 +434,7 @@ FuzzyQuery::FuzzyQuery(Term* term, float_t _minimumSimilarity, size_t _prefixLen
 
 float_t FuzzyQuery::defaultMinSimilarity = 0.5f;
 int32_t FuzzyQuery::defaultPrefixLength = 0;
+int32_t FuzzyQuery::defaultMaxExpansions = 50;
 
 FuzzyQuery::~FuzzyQuery()
 {
@@ -338,6 +450,11 @@ size_t FuzzyQuery::getPrefixLength() const
     return prefixLength;
 }
 
+int32_t FuzzyQuery::getMaxExpansions() const
+{
+    return maxExpansions;
+}
+
 std::wstring FuzzyQuery::toString(const wchar_t* field) const
 {
     std::wstring buffer; // TODO: Have a better estimation for the initial buffer length
@@ -376,6 +493,7 @@ FuzzyQuery::FuzzyQuery(const FuzzyQuery& clone) :
 {
     this->minimumSimilarity = clone.getMinSimilarity();
     this->prefixLength = clone.getPrefixLength();
+    this->maxExpansions = clone.getMaxExpansions();
 
     //if(prefixLength < 0)
     //	_CLTHROWA(CL_ERR_IllegalArgument,"prefixLength < 0");
@@ -397,6 +515,7 @@ size_t FuzzyQuery::hashCode() const
     size_t val = Similarity::floatToByte(getBoost()) ^ getTerm()->hashCode();
     val ^= Similarity::floatToByte(this->getMinSimilarity());
     val ^= this->getPrefixLength();
+    val ^= this->getMaxExpansions();
     return val;
 }
 bool FuzzyQuery::equals(Query* other) const
@@ -409,6 +528,7 @@ bool FuzzyQuery::equals(Query* other) const
     return (this->getBoost() == fq->getBoost())
         && this->minimumSimilarity == fq->getMinSimilarity()
         && this->prefixLength == fq->getPrefixLength()
+        && this->maxExpansions == fq->getMaxExpansions()
         && getTerm()->equals(fq->getTerm());
 }
 
@@ -421,8 +541,19 @@ FilteredTermEnum* FuzzyQuery::getEnum(IndexReader* reader)
 
 Query* FuzzyQuery::rewrite(IndexReader* reader)
 {
+    if (getRewriteMethod() != SCORING_BOOLEAN_QUERY_REWRITE)
+        return MultiTermQuery::rewrite(reader);
+
+    //keep only the most similar terms
+    const size_t maxClauseCount = cl_min((size_t) maxExpansions, BooleanQuery::getMaxClauseCount());
+    if (maxClauseCount == 0)
+    {
+        BooleanQuery* query = _CLNEW BooleanQuery(true);
+        query->setBoost(getBoost());
+        return query;
+    }
+
     FilteredTermEnum* enumerator = getEnum(reader);
-    const size_t maxClauseCount = BooleanQuery::getMaxClauseCount();
     ScoreTermQueue* stQueue = _CLNEW ScoreTermQueue(maxClauseCount);
     ScoreTerm* reusableST = NULL;
 
@@ -445,10 +576,12 @@ Query* FuzzyQuery::rewrite(IndexReader* reader)
                     // this new score is not better than that, there's no
                     // need to try inserting it
                     reusableST->score = score;
+                    _CLLDECDELETE(reusableST->term);
                     reusableST->term = t;
                 }
                 else
                 {
+                    _CLLDECDELETE(t);
                     continue;
                 }
 
@@ -458,7 +591,7 @@ Query* FuzzyQuery::rewrite(IndexReader* reader)
     } _CLFINALLY({
         enumerator->close();
         _CLLDELETE(enumerator);
-        //_CLLDELETE(reusableST);
+        _CLLDELETE(reusableST);
         });
 
     BooleanQuery* query = _CLNEW BooleanQuery(true);
@@ -9,6 +9,7 @@
 #ifndef _lucene_search_FuzzyQuery_
 #define _lucene_search_FuzzyQuery_
 
+#include "CLucene/clucene-config.h"
 #include "MultiTermQuery.h"
 #include "FilteredTermEnum.h"
 
@@ -18,16 +19,25 @@ CL_NS_DEF(search)
 
 /** Implements the fuzzy search query. The similiarity measurement
 * is based on the Levenshtein (edit distance) algorithm.
+*
+* <p>With SCORING_BOOLEAN_QUERY_REWRITE the query rewrites to the
+* <code>maxExpansions</code> most similar terms (capped by
+* BooleanQuery::getMaxClauseCount()), each boosted by its similarity. The
+* other rewrite methods work as for any MultiTermQuery, over every similar
+* term: CONSTANT_SCORE_FILTER_REWRITE ignores <code>maxExpansions</code>
+* and scores every hit alike.</p>
 */
 class CLUCENE_EXPORT FuzzyQuery : public MultiTermQuery {
 private:
 	float_t minimumSimilarity;
 	size_t prefixLength;
+	int32_t maxExpansions;
 protected:
 	FuzzyQuery(const FuzzyQuery& clone);
 public:
 	static float_t defaultMinSimilarity;
 	static int32_t defaultPrefixLength;
+	static int32_t defaultMaxExpansions;
 
 	/**
 	* Create a new FuzzyQuery that will match terms with a similarity 
@@ -42,10 +52,12 @@ public:
 	*  as the query term is considered similar to the query term if the edit distance
 	*  between both terms is less than <code>length(term)*0.5</code>
 	* @param prefixLength length of common (non-fuzzy) prefix
+	* @param maxExpansions the maximum number of terms to match, the most
+	*  similar ones being kept. Defaults to <code>defaultMaxExpansions</code>
 	* @throws IllegalArgumentException if minimumSimilarity is &gt; 1 or &lt; 0
 	* or if prefixLength &lt; 0 or &gt; <code>term.text().length()</code>.
 	*/
-	FuzzyQuery(CL_NS(index)::Term* term, float_t minimumSimilarity=-1, size_t prefixLength=0);
+	FuzzyQuery(CL_NS(index)::Term* term, float_t minimumSimilarity=-1, size_t prefixLength=0, int32_t maxExpansions=-1);
 	virtual ~FuzzyQuery();
 
 	/**
@@ -61,6 +73,9 @@ public:
 	*/
 	size_t getPrefixLength() const;
 
+	/** Returns the maximum number of terms the query rewrites to */
+	int32_t getMaxExpansions() const;
+
 	Query* rewrite(CL_NS(index)::IndexReader* reader);
 
 	std::wstring toString(const wchar_t* field) const;
@@ -82,6 +97,11 @@ protected:
 *
 * <p>Term enumerations are always ordered by Term.compareTo().  Each term in
 * the enumeration is greater than all that precede it.
+*
+* <p>When at most MAX_AUTOMATON_EDITS edits can give an accepted term, the
+* terms are read through a Levenshtein automaton that skips the parts of
+* the dictionary too far from the search term. Distances are computed with
+* a bit-parallel algorithm when the search text fits in 64 characters.</p>
 */
 class CLUCENE_EXPORT FuzzyTermEnum: public FilteredTermEnum {
 private:
@@ -106,6 +126,23 @@ private:
 	double scale_factor;
 	int32_t maxDistances[LUCENE_TYPICAL_LONGEST_WORD_IN_INDEX];
 
+	/* Bit masks of the positions of each character in text, for the
+	* bit-parallel distance. Characters below 128 are looked up directly,
+	* the others in a short list.
+	*/
+	uint64_t peqAscii[128];
+	wchar_t peqChars[64];
+	uint64_t peqMasks[64];
+	int32_t peqCount;
+
+	void initializePeq();
+
+	/** Levenshtein distance between text and target, text being at most 64 characters */
+	int32_t editDistance(const wchar_t* target, const size_t targetLen) const;
+
+	/** The largest edit distance any term can have and still be accepted */
+	int32_t maxAcceptedDistance() const;
+
 	/******************************
 	* Compute Levenshtein distance
 	******************************/
@@ -172,6 +209,8 @@ protected:
 	/** Returns the fact if the current term in the enumeration has reached the end */
 	bool endEnum();
 public:
+	/** Largest edit distance for which the Levenshtein automaton is used */
+	LUCENE_STATIC_CONSTANT(int32_t, MAX_AUTOMATON_EDITS = 2);
 
 	/**
 	* Constructor for enumeration of all terms from specified <code>reader</code> which share a prefix of
@@ -14,6 +14,7 @@
 #include "Filter.h"
 #include "CLucene/search/SearchHeader.h"
 #include "CLucene/search/IndexSearcher.h"
+#include <vector>
 
 CL_NS_USE(document)
 CL_NS_USE(util)
@@ -103,6 +104,52 @@ CL_NS_DEF(search)
 		return *hitDoc->doc;
 	}
 
+	void Hits::loadDocs(const int32_t start, const int32_t count){
+		int32_t end = start + (count < maxDocs ? count : maxDocs);
+		if (end > (int32_t)_length)
+			end = (int32_t)_length;
+
+		// hits already cached only move to the front of the LRU cache
+		std::vector<HitDoc*> missing;
+		std::vector<int32_t> ids;
+		for (int32_t n = start; n < end; n++) {
+			HitDoc* hitDoc = getHitDoc(n);
+			if (hitDoc->doc == NULL) {
+				missing.push_back(hitDoc);
+				ids.push_back(hitDoc->id);
+			} else {
+				remove(hitDoc);
+				addToFront(hitDoc);
+			}
+		}
+		if (missing.empty())
+			return;
+
+		std::vector<Document*> docs(missing.size());
+		for (size_t i = 0; i < docs.size(); i++)
+			docs[i] = _CLNEW Document;
+		try {
+			searcher->docs(&ids[0], (int32_t)ids.size(), &docs[0]);
+		} catch (CLuceneError&) {
+			for (size_t i = 0; i < docs.size(); i++)
+				_CLLDELETE(docs[i]);
+			throw;
+		}
+
+		for (size_t i = 0; i < missing.size(); i++) {
+			HitDoc* hitDoc = missing[i];
+			hitDoc->doc = docs[i];
+			addToFront(hitDoc);
+			if (numDocs > maxDocs) {			  // if cache is full
+				HitDoc* oldLast = last;
+				remove(last);				  // flush last
+
+				_CLLDELETE( oldLast->doc );
+				oldLast->doc = NULL;
+			}
+		}
+	}
+
 	int32_t Hits::id (const int32_t n){
 		return getHitDoc(n)->id;
 	}
@@ -85,6 +85,16 @@ CL_NS_DEF(search)
 		* @memory Memory belongs to the hits object. Don't delete the return value.
 		*/
 		CL_NS(document)::Document& doc(const int32_t n);
+
+		/** Loads the stored fields of the hits <code>start</code> to
+		* <code>start+count-1</code> into the cache in one batch (see
+		* Searchable#docs), so that showing a page of results with doc(n)
+		* reads the index once rather than once per hit. At most as many
+		* hits as the cache holds are loaded.
+		* @throws CorruptIndexException if the index is corrupt
+		* @throws IOException if there is a low-level IO error
+		*/
+		void loadDocs(const int32_t start, const int32_t count);
 	      
 		/** Returns the id for the n<sup>th</sup> document in this set.
 		* Note that ids may change when the index changes, so you cannot
@@ -11,7 +11,6 @@
 
 #include "SearchHeader.h"
 #include "Scorer.h"
-#include "_HitQueue.h"
 #include "Query.h"
 #include "Filter.h"
 #include "_FieldDocSortedHitQueue.h"
@@ -19,9 +18,19 @@
 #include "CLucene/document/Document.h"
 #include "CLucene/index/IndexReader.h"
 #include "CLucene/index/Term.h"
+#include "CLucene/index/_IndexSorter.h"
 #include "CLucene/util/BitSet.h"
 #include "FieldSortedHitQueue.h"
+#include "_ScoreLoop.h"
+#include "_TopScoreDocCollector.h"
+#include "_TopFieldDocCollector.h"
+#include "FieldCache.h"
+#include "Sort.h"
 #include "Explanation.h"
+#include "QueryResultCache.h"
+#include "FilterCache.h"
+#include <algorithm>
+#include <limits>
 
 CL_NS_USE(index)
 CL_NS_USE(util)
@@ -29,84 +38,323 @@ CL_NS_USE(document)
 
 CL_NS_DEF(search)
 
-	class SimpleTopDocsCollector:public HitCollector{ 
+	/** Passes on hits to a HitCollector, numbered as documents of the whole index */
+	class HitCollectorLoop{
 	private:
-		float_t minScore;
-		const CL_NS(util)::BitSet* bits;
-		HitQueue* hq;
-		size_t nDocs;
-		int32_t* totalHits;
+		HitCollector* results;
+		int32_t docBase;
 	public:
-		SimpleTopDocsCollector(const CL_NS(util)::BitSet* bs, HitQueue* hitQueue, int32_t* totalhits, size_t ndocs, const float_t ms=-1.0f):
-    		minScore(ms),
-    		bits(bs),
-    		hq(hitQueue),
-    		nDocs(ndocs),
-    		totalHits(totalhits)
-    	{
-    	}
-		~SimpleTopDocsCollector(){}
-		void collect(const int32_t doc, const float_t score){
-    		if (score > 0.0f &&			  // ignore zeroed buckets
-    			(bits==NULL || bits->get(doc))) {	  // skip docs not in bits
-    			++totalHits[0];
-    			if (hq->size() < nDocs || (minScore==-1.0f || score >= minScore)) {
-    				ScoreDoc sd = {doc, score};
-    				hq->insert(sd);	  // update hit queue
-    				if ( minScore != -1.0f )
-    					minScore = hq->top().score; // maintain minScore
-    			}
-    		}
-    	}
+		HitCollectorLoop(HitCollector* _results):
+			results(_results),
+			docBase(0)
+		{
+		}
+		void setDocBase(const int32_t _docBase){
+			docBase = _docBase;
+		}
+		inline ScoreLoop::Status collect(const int32_t doc, const float_t score){
+			results->collect(docBase + doc, score);
+			return ScoreLoop::CONTINUE;
+		}
+		float_t getMinCompetitiveScore() const{
+			return 0.0f;
+		}
 	};
 
-	class SortedTopDocsCollector:public HitCollector{ 
+	/** Adds the segments of <code>reader</code> and the number of their first
+	* document to <code>segments</code> and <code>docBases</code>. */
+	static void gatherSegments(IndexReader* reader, int32_t docBase,
+		std::vector<IndexReader*>& segments, std::vector<int32_t>& docBases){
+		const ArrayBase<IndexReader*>* subReaders = reader->getSubReaders();
+		if (subReaders == NULL || subReaders->length == 0) {
+			segments.push_back(reader);
+			docBases.push_back(docBase);
+			return;
+		}
+		for (size_t i = 0; i < subReaders->length; i++) {
+			gatherSegments(subReaders->values[i], docBase, segments, docBases);
+			docBase += subReaders->values[i]->maxDoc();
+		}
+	}
+
+	/** The documents a search is filtered by: the bits of the filter for the
+	* whole index or, with a FilterCache, those of each segment from the cache */
+	class SegmentFilter{
 	private:
-		const CL_NS(util)::BitSet* bits;
-		FieldSortedHitQueue* hq;
-		size_t nDocs;
-		int32_t* totalHits;
+		Filter* filter;
+		FilterCache* cache;
+		BitSet* bits;
 	public:
-		SortedTopDocsCollector(const CL_NS(util)::BitSet* bs, FieldSortedHitQueue* hitQueue, int32_t* totalhits, size_t _nDocs):
-    		bits(bs),
-    		hq(hitQueue),
-    		nDocs(_nDocs),
-    		totalHits(totalhits)
-    	{
-    	}
-		~SortedTopDocsCollector(){
+		SegmentFilter(Filter* _filter, FilterCache* _cache, IndexReader* reader):
+			filter(_filter),
+			cache(_filter != NULL ? _cache : NULL),
+			bits(NULL)
+		{
+			if (cache != NULL)
+				cache->onUse(filter);
+			else if (filter != NULL)
+				bits = filter->bits(reader);
+		}
+		~SegmentFilter(){
+			if (bits != NULL && filter->shouldDeleteBitSet(bits))
+				_CLDELETE(bits);
+		}
+		/** Scores the documents of <code>scorer</code>, which scores <code>segment</code>, that the filter permits */
+		template<class Collector>
+		ScoreLoop::Status score(Scorer* scorer, IndexReader* segment, const int32_t docBase, Collector& results) const{
+			if (filter == NULL)
+				return ScoreLoop::score(scorer, results);
+			if (bits != NULL)
+				return ScoreLoop::scoreFiltered(scorer, bits, docBase, results);
+			DocIdSet* docs = cache->getDocIdSet(filter, segment);
+			const ScoreLoop::Status status = ScoreLoop::scoreFiltered(scorer, docs, 0, results);
+			_CLDECDELETE(docs);
+			return status;
 		}
-		void collect(const int32_t doc, const float_t score){
-    		if (score > 0.0f &&			  // ignore zeroed buckets
-    			(bits==NULL || bits->get(doc))) {	  // skip docs not in bits
-    			++totalHits[0];
-    			FieldDoc* fd = _CLNEW FieldDoc(doc, score); //todo: see jlucene way... with fields def???
-    			if ( !hq->insert(fd) )	  // update hit queue
-    				_CLDELETE(fd);
-    		}
-    	}
 	};
 
-	class SimpleFilteredCollector: public HitCollector{
+	/** Scores each segment of <code>reader</code> on its own, so that the
+	* scorers use the segment's norms, and collects the hits with a collector
+	* compiled into the scoring loop. See ScoreLoop. */
+	template<class Collector>
+	static void scoreSegments(IndexReader* reader, Weight* weight, const SegmentFilter& filter, Collector& results){
+		std::vector<IndexReader*> segments;
+		std::vector<int32_t> docBases;
+		gatherSegments(reader, 0, segments, docBases);
+
+		for (size_t i = 0; i < segments.size(); i++) {
+			Scorer* scorer = weight->scorer(segments[i]);
+			if (scorer == NULL)
+				continue;                                 // nothing matches in this segment
+
+			results.setDocBase(docBases[i]);
+			const ScoreLoop::Status status = filter.score(scorer, segments[i], docBases[i], results);
+			_CLDELETE(scorer);
+			if (status == ScoreLoop::TERMINATE)
+				break;
+		}
+	}
+
+	/** Passes on the hits of a segment to a TopScoreDocCollector, except
+	* those of the documents already collected from its impact tiers. */
+	class TierRestCollector{
 	private:
-		CL_NS(util)::BitSet* bits;
-		HitCollector* results;
+		TopScoreDocCollector& collector;
+		const std::vector<int32_t>& collected;   // ascending
+		size_t next;
 	public:
-		SimpleFilteredCollector(CL_NS(util)::BitSet* bs, HitCollector* collector):
-            bits(bs),
-            results(collector)
-        {
-        }
-		~SimpleFilteredCollector(){
+		TierRestCollector(TopScoreDocCollector& _collector, const std::vector<int32_t>& _collected):
+			collector(_collector),
+			collected(_collected),
+			next(0)
+		{
+		}
+		inline ScoreLoop::Status collect(const int32_t doc, const float_t score){
+			while (next < collected.size() && collected[next] < doc)
+				next++;
+			if (next < collected.size() && collected[next] == doc)
+				return ScoreLoop::CONTINUE;
+			return collector.collect(doc, score);
+		}
+		float_t getMinCompetitiveScore() const{
+			return collector.getMinCompetitiveScore();
+		}
+	};
+
+	/** Scores each segment of <code>reader</code> as scoreSegments does,
+	* but the documents of the impact tiers of the scorer's terms first. The
+	* other documents are then only scored if one of them may still be a
+	* top hit, and the scorer skips them once none can be.
+	* See IndexSearcher#setImpactTiers. */
+	static void scoreSegmentsByTiers(IndexReader* reader, Weight* weight, TopScoreDocCollector& results){
+		std::vector<IndexReader*> segments;
+		std::vector<int32_t> docBases;
+		gatherSegments(reader, 0, segments, docBases);
+
+		std::vector<int32_t> collected;
+		for (size_t i = 0; i < segments.size(); i++) {
+			Scorer* scorer = weight->scorer(segments[i]);
+			if (scorer == NULL)
+				continue;                                 // nothing matches in this segment
+
+			results.setDocBase(docBases[i]);
+			if (scorer->scoresDocsOutOfOrder() || !(scorer->maxScoreOutsideTier() < std::numeric_limits<float_t>::infinity())) {
+				ScoreLoop::score(scorer, results);        // no tiers to start with
+				_CLDELETE(scorer);
+				continue;
+			}
+
+			collected.clear();
+			int32_t target = 0;
+			int32_t doc;
+			while ((doc = scorer->nextTierDoc(target)) != LUCENE_INT32_MAX_SHOULDBE && scorer->skipTo(doc)) {
+				doc = scorer->doc();                      // past doc if it was deleted
+				results.collect(doc, scorer->score());
+				collected.push_back(doc);
+				target = doc + 1;
+			}
+			const float_t maxOutside = scorer->maxScoreOutsideTier();
+			_CLDELETE(scorer);
+			if (maxOutside < results.getMinCompetitiveScore())
+				continue;                                 // nothing else is competitive
+
+			scorer = weight->scorer(segments[i]);
+			TierRestCollector rest(results, collected);
+			ScoreLoop::score(scorer, rest);
+			_CLDELETE(scorer);
+		}
+	}
+
+	/** Passes on the hits of a sorted search to its collector, and ends
+	* each segment whose documents are in the order of the search once
+	* <code>nDocs</code> of its hits were collected: the hits after them
+	* sort after them. */
+	template<class Collector>
+	class EarlyTerminatingCollector{
+	private:
+		Collector& collector;
+		const std::vector<int32_t>& sortedDocBases;
+		const int32_t nDocs;
+		int32_t segmentStart;   // the hits collected before this segment, or -1 if it is not sorted
+	public:
+		EarlyTerminatingCollector(Collector& _collector, const std::vector<int32_t>& _sortedDocBases, const int32_t _nDocs):
+			collector(_collector),
+			sortedDocBases(_sortedDocBases),
+			nDocs(_nDocs),
+			segmentStart(-1)
+		{
+		}
+		void setDocBase(const int32_t docBase){
+			collector.setDocBase(docBase);
+			segmentStart = std::binary_search(sortedDocBases.begin(), sortedDocBases.end(), docBase) ?
+				collector.getTotalHits() : -1;
+		}
+		inline ScoreLoop::Status collect(const int32_t doc, const float_t score){
+			const ScoreLoop::Status status = collector.collect(doc, score);
+			if (segmentStart >= 0 && collector.getTotalHits() - segmentStart >= nDocs)
+				return ScoreLoop::NEXT_SEGMENT;
+			return status;
+		}
+		float_t getMinCompetitiveScore() const{
+			return collector.getMinCompetitiveScore();
 		}
-	protected:
-		void collect(const int32_t doc, const float_t score){
-            if (bits->get(doc)) {		  // skip docs not in bits
-                results->collect(doc, score);
-            }
-        }
 	};
 
+	/** Adds the first document number of each segment of <code>reader</code>
+	* that holds documents in the index sort <code>sort</code>, or in an index
+	* sort that begins with it, to <code>sortedDocBases</code> in order. */
+	static void gatherSortedSegments(IndexReader* reader, const std::wstring& sort, std::vector<int32_t>& sortedDocBases){
+		std::vector<IndexReader*> segments;
+		std::vector<int32_t> docBases;
+		gatherSegments(reader, 0, segments, docBases);
+
+		const std::wstring prefix = sort + L",";
+		for (size_t i = 0; i < segments.size(); i++) {
+			const wchar_t* segmentSort = segments[i]->getIndexSort();
+			if (segmentSort == NULL || segments[i]->maxDoc() == 0)
+				continue;                                 // empty segments share their first document number
+			if (sort.compare(segmentSort) == 0 || wcsncmp(segmentSort, prefix.c_str(), prefix.length()) == 0)
+				sortedDocBases.push_back(docBases[i]);
+		}
+	}
+
+	/** Collects the top hits of a sorted search with a collector compiled for
+	* <code>key</code>, and returns them in sort order with their sort values.
+	* The segments starting at <code>sortedDocBases</code> are sorted by
+	* <code>key</code>, and are only read until their top hits are known. */
+	template<class Key>
+	static FieldDoc** collectSorted(const Key& key, IndexReader* reader, Weight* weight, const SegmentFilter& filter,
+		const std::vector<int32_t>& sortedDocBases, FieldSortedHitQueue& hq, const int32_t nDocs, int32_t& totalHits, int32_t& length){
+		TopFieldDocCollector<Key> collector(key, nDocs);
+		if (sortedDocBases.empty()) {
+			scoreSegments(reader, weight, filter, collector);
+		} else {
+			EarlyTerminatingCollector< TopFieldDocCollector<Key> > terminating(collector, sortedDocBases, nDocs);
+			scoreSegments(reader, weight, filter, terminating);
+		}
+		hq.setMaxScore(collector.getMaxScore());
+
+		totalHits = collector.getTotalHits();
+		length = collector.size();
+		FieldDoc** fieldDocs = _CL_NEWARRAY(FieldDoc*, length);
+		for (int32_t i = length - 1; i >= 0; --i)   // put docs in array
+			fieldDocs[i] = hq.fillFields(collector.pop());
+		return fieldDocs;
+	}
+
+	/** Sorts by <code>key</code>, in either order, and by relevance where it is equal if <code>thenByScore</code> */
+	template<class Key>
+	static FieldDoc** collectSortedBy(const Key& key, const bool reverse, const bool thenByScore, IndexReader* reader, Weight* weight,
+		const SegmentFilter& filter, const std::vector<int32_t>& sortedDocBases, FieldSortedHitQueue& hq, const int32_t nDocs,
+		int32_t& totalHits, int32_t& length){
+		typedef SortKeys::Reverse<Key> ReverseKey;
+		if (thenByScore) {
+			if (reverse)
+				return collectSorted(SortKeys::Pair<ReverseKey, SortKeys::Score>(ReverseKey(key), SortKeys::Score()),
+					reader, weight, filter, sortedDocBases, hq, nDocs, totalHits, length);
+			return collectSorted(SortKeys::Pair<Key, SortKeys::Score>(key, SortKeys::Score()),
+				reader, weight, filter, sortedDocBases, hq, nDocs, totalHits, length);
+		}
+		if (reverse)
+			return collectSorted(ReverseKey(key), reader, weight, filter, sortedDocBases, hq, nDocs, totalHits, length);
+		return collectSorted(key, reader, weight, filter, sortedDocBases, hq, nDocs, totalHits, length);
+	}
+
+	/** Collects the top hits of a sorted search. A sort by one int, float, string,
+	* score or document key, or by one of the field keys and then by relevance,
+	* gets a collector compiled for it. Other sorts go through the comparators
+	* of <code>hq</code>. If <code>earlyTermination</code> is set, the segments
+	* whose documents are in the order of the sort are only read until their
+	* top hits are known. */
+	static FieldDoc** collectSorted(const Sort* sort, IndexReader* reader, Weight* weight, const SegmentFilter& filter,
+		const bool earlyTermination, FieldSortedHitQueue& hq, const int32_t nDocs, int32_t& totalHits, int32_t& length){
+		SortField** sortFields = sort->getSort();
+		SortField** fields = hq.getFields();       // with the types the comparators resolved
+		int32_t fieldsLen = 0;
+		while (fields[fieldsLen] != NULL)
+			fieldsLen++;
+
+		std::vector<int32_t> sortedDocBases;
+		if (earlyTermination) {
+			int32_t sortKeys = fieldsLen;
+			if (sortKeys > 0 && fields[sortKeys-1]->getType() == SortField::DOC && !fields[sortKeys-1]->getReverse())
+				sortKeys--;
+			if (sortKeys > 0)
+				gatherSortedSegments(reader, IndexSorter::describe(fields, sortKeys), sortedDocBases);
+		}
+
+		// every sort ends with the tie break by document number, a sort field for it changes nothing
+		int32_t keys = fieldsLen;
+		if (keys == 2 && sortFields[1]->getType() == SortField::DOC && !sortFields[1]->getReverse())
+			keys = 1;
+
+		const bool thenByScore = keys == 2 && sortFields[1]->getType() == SortField::DOCSCORE && !sortFields[1]->getReverse();
+		if ((keys == 1 || thenByScore) && sortFields[0]->getType() != SortField::CUSTOM) {
+			const wchar_t* field = fields[0]->getField();
+			const bool reverse = fields[0]->getReverse();
+			switch (fields[0]->getType()) {
+			case SortField::INT:
+				return collectSortedBy(SortKeys::Int32(FieldCache::DEFAULT()->getInts(reader, field)->intArray),
+					reverse, thenByScore, reader, weight, filter, sortedDocBases, hq, nDocs, totalHits, length);
+			case SortField::FLOAT:
+				return collectSortedBy(SortKeys::Float(FieldCache::DEFAULT()->getFloats(reader, field)->floatArray),
+					reverse, thenByScore, reader, weight, filter, sortedDocBases, hq, nDocs, totalHits, length);
+			case SortField::STRING:
+				return collectSortedBy(SortKeys::Ordinal(FieldCache::DEFAULT()->getStringIndex(reader, field)->stringIndex->order),
+					reverse, thenByScore, reader, weight, filter, sortedDocBases, hq, nDocs, totalHits, length);
+			case SortField::DOCSCORE:
+				if (!thenByScore)
+					return collectSortedBy(SortKeys::Score(), reverse, false, reader, weight, filter, sortedDocBases, hq, nDocs, totalHits, length);
+				break;
+			case SortField::DOC:
+				if (!thenByScore)
+					return collectSortedBy(SortKeys::Doc(), reverse, false, reader, weight, filter, sortedDocBases, hq, nDocs, totalHits, length);
+				break;
+			}
+		}
+		return collectSorted(SortKeys::Queue(&hq), reader, weight, filter, sortedDocBases, hq, nDocs, totalHits, length);
+	}
+
 
   IndexSearcher::IndexSearcher(const wchar_t * path){
   //Func - Constructor
@@ -118,6 +366,9 @@ CL_NS_DEF(search)
 
       reader = IndexReader::open(path);
       readerOwner = true;
+      earlyTermination = false;
+      impactTiers = false;
+      queryResultCache = NULL;
   }
   
   IndexSearcher::IndexSearcher(CL_NS(store)::Directory* directory){
@@ -130,6 +381,9 @@ CL_NS_DEF(search)
 
       reader = IndexReader::open(directory);
       readerOwner = true;
+      earlyTermination = false;
+      impactTiers = false;
+      queryResultCache = NULL;
   }
 
   IndexSearcher::IndexSearcher(IndexReader* r){
@@ -140,6 +394,9 @@ CL_NS_DEF(search)
 
       reader      = r;
       readerOwner = false;
+      earlyTermination = false;
+      impactTiers = false;
+      queryResultCache = NULL;
   }
 
   IndexSearcher::~IndexSearcher(){
@@ -200,6 +457,14 @@ CL_NS_DEF(search)
       return reader->document(i,*d);
   }
 
+  // inherit javadoc
+  void IndexSearcher::docs(const int32_t* ids, const int32_t count, CL_NS(document)::Document** result,
+      const CL_NS(document)::FieldSelector* fieldSelector) {
+      CND_PRECONDITION(reader != NULL, L"reader is NULL");
+
+      reader->documents(ids, count, result, fieldSelector);
+  }
+
   // inherit javadoc
   int32_t IndexSearcher::maxDoc() const {
   //Func - Return total number of documents including the ones marked deleted
@@ -221,48 +486,34 @@ CL_NS_DEF(search)
       CND_PRECONDITION(reader != NULL, L"reader is NULL");
       CND_PRECONDITION(query != NULL, L"query is NULL");
 
-      Weight* weight = query->weight(this);
-      Scorer* scorer = weight->scorer(reader);
-      if (scorer == NULL) {
-        Query* wq = weight->getQuery();
-        if (wq != query)
-          _CLLDELETE(wq);
-        _CLLDELETE(weight);
-          return _CLNEW TopDocs(0, NULL, 0);
+      if (queryResultCache != NULL) {
+          TopDocs* cached = queryResultCache->get(reader, query, filter, NULL, nDocs, impactTiers, getSimilarity());
+          if (cached != NULL)
+              return cached;
       }
 
-      BitSet* bits = filter != NULL ? filter->bits(reader) : NULL;
-      HitQueue* hq = _CLNEW HitQueue(nDocs);
-
-		  //Check hq has been allocated properly
-		  CND_CONDITION(hq != NULL, L"Could not allocate memory for HitQueue hq");
-	
-		  int32_t* totalHits = _CL_NEWARRAY(int32_t,1);
-      totalHits[0] = 0;
-
-      SimpleTopDocsCollector hitCol(bits,hq,totalHits,nDocs,0.0f);
-      scorer->score( &hitCol );
-      _CLDELETE(scorer);
-
-      int32_t scoreDocsLength = hq->size();
-
-		ScoreDoc* scoreDocs = new ScoreDoc[scoreDocsLength];
+      Weight* weight = query->weight(this);
+      SegmentFilter segmentFilter(filter, getFilterCache(), reader);
 
-		for (int32_t i = scoreDocsLength-1; i >= 0; --i)	  // put docs in array
-			scoreDocs[i] = hq->pop();
+      TopScoreDocCollector collector(nDocs, impactTiers);
+      if (impactTiers && filter == NULL)
+          scoreSegmentsByTiers(reader, weight, collector);
+      else
+          scoreSegments(reader, weight, segmentFilter, collector);
 
-      int32_t totalHitsInt = totalHits[0];
+      int32_t scoreDocsLength = 0;
+      ScoreDoc* scoreDocs = collector.topDocs(scoreDocsLength);
+      int32_t totalHitsInt = collector.getTotalHits();
 
-      _CLDELETE(hq);
-		  if ( bits != NULL && filter->shouldDeleteBitSet(bits) )
-				_CLDELETE(bits);
-	    _CLDELETE_ARRAY(totalHits);
 		  Query* wq = weight->getQuery();
 		  if ( query != wq ) //query was re-written
 			  _CLLDELETE(wq);
 		  _CLDELETE(weight);
 
-      return _CLNEW TopDocs(totalHitsInt, scoreDocs, scoreDocsLength);
+      TopDocs* topDocs = _CLNEW TopDocs(totalHitsInt, scoreDocs, scoreDocsLength);
+      if (queryResultCache != NULL)
+          queryResultCache->put(reader, query, filter, NULL, nDocs, impactTiers, getSimilarity(), topDocs);
+      return topDocs;
   }
 
   // inherit javadoc
@@ -272,26 +523,18 @@ CL_NS_DEF(search)
       CND_PRECONDITION(reader != NULL, L"reader is NULL");
       CND_PRECONDITION(query != NULL, L"query is NULL");
 
-    Weight* weight = query->weight(this);
-    Scorer* scorer = weight->scorer(reader);
-    if (scorer == NULL){
-		return _CLNEW TopFieldDocs(0, NULL, 0, NULL );
-	}
+    if (queryResultCache != NULL) {
+        TopDocs* cached = queryResultCache->get(reader, query, filter, sort, nDocs, earlyTermination, getSimilarity());
+        if (cached != NULL)
+            return static_cast<TopFieldDocs*>(cached);
+    }
 
-    BitSet* bits = filter != NULL ? filter->bits(reader) : NULL;
+    Weight* weight = query->weight(this);
+    SegmentFilter segmentFilter(filter, getFilterCache(), reader);
     FieldSortedHitQueue hq(reader, sort->getSort(), nDocs);
-    int32_t* totalHits = _CL_NEWARRAY(int32_t,1);
-	totalHits[0]=0;
-    
-	SortedTopDocsCollector hitCol(bits,&hq,totalHits,nDocs);
-	scorer->score(&hitCol);
-    _CLLDELETE(scorer);
-
-	int32_t hqLen = hq.size();
-    FieldDoc** fieldDocs = _CL_NEWARRAY(FieldDoc*,hqLen);
-	for (int32_t i = hqLen-1; i >= 0; --i){	  // put docs in array
-	  fieldDocs[i] = hq.fillFields (hq.pop());
-	}
+    int32_t totalHits = 0;
+    int32_t hqLen = 0;
+    FieldDoc** fieldDocs = collectSorted(sort, reader, weight, segmentFilter, earlyTermination, hq, nDocs, totalHits, hqLen);
 
     Query* wq = weight->getQuery();
 	if ( query != wq ) //query was re-written
@@ -300,11 +543,10 @@ CL_NS_DEF(search)
 
     SortField** hqFields = hq.getFields();
 	hq.setFields(NULL); //move ownership of memory over to TopFieldDocs
-    int32_t totalHits0 = totalHits[0];
-	if ( bits != NULL && filter->shouldDeleteBitSet(bits) )
-		_CLLDELETE(bits);
-    _CLDELETE_LARRAY(totalHits);
-    return _CLNEW TopFieldDocs(totalHits0, fieldDocs, hqLen, hqFields );
+    TopFieldDocs* topDocs = _CLNEW TopFieldDocs(totalHits, fieldDocs, hqLen, hqFields );
+    if (queryResultCache != NULL)
+        queryResultCache->put(reader, query, filter, sort, nDocs, earlyTermination, getSimilarity(), topDocs);
+    return topDocs;
   }
 
   void IndexSearcher::_search(Query* query, Filter* filter, HitCollector* results){
@@ -320,32 +562,16 @@ CL_NS_DEF(search)
       CND_PRECONDITION(reader != NULL, L"reader is NULL");
       CND_PRECONDITION(query != NULL, L"query is NULL");
 
-      BitSet* bits = NULL;
-      SimpleFilteredCollector* fc = NULL; 
-
-      if (filter != NULL){
-          bits = filter->bits(reader);
-          fc = _CLNEW SimpleFilteredCollector(bits, results);
-       }
+      SegmentFilter segmentFilter(filter, getFilterCache(), reader);
 
       Weight* weight = query->weight(this);
-      Scorer* scorer = weight->scorer(reader);
-      if (scorer != NULL) {
-		  if (fc == NULL){
-              scorer->score(results);
-		  }else{
-              scorer->score((HitCollector*)fc);
-		  }
-          _CLDELETE(scorer); 
-      }
+      HitCollectorLoop collector(results);
+      scoreSegments(reader, weight, segmentFilter, collector);
 
-    _CLLDELETE(fc);
 	Query* wq = weight->getQuery();
 	if (wq != query) // query was rewritten
 		_CLLDELETE(wq);
 	_CLLDELETE(weight);
-	if ( bits != NULL && filter->shouldDeleteBitSet(bits) )
-		_CLLDELETE(bits);
   }
 
   Query* IndexSearcher::rewrite(Query* original) {
@@ -365,7 +591,15 @@ CL_NS_DEF(search)
 
     void IndexSearcher::explain(Query* query, int32_t doc, Explanation* ret){
         Weight* weight = query->weight(this);
-        ret->addDetail(weight->explain(reader, doc)); // TODO: A hack until this function will return Explanation* as well
+
+        // explain in the segment the document is scored in
+        std::vector<IndexReader*> segments;
+        std::vector<int32_t> docBases;
+        gatherSegments(reader, 0, segments, docBases);
+        size_t i = segments.size() - 1;
+        while (i > 0 && docBases[i] > doc)
+            i--;
+        ret->addDetail(weight->explain(segments[i], doc - docBases[i])); // TODO: A hack until this function will return Explanation* as well
 
         Query* wq = weight->getQuery();
 	    if ( query != wq ) //query was re-written
@@ -377,6 +611,30 @@ CL_NS_DEF(search)
 		return reader;
 	}
 
+	void IndexSearcher::setEarlyTermination(const bool _earlyTermination){
+		earlyTermination = _earlyTermination;
+	}
+
+	bool IndexSearcher::getEarlyTermination() const{
+		return earlyTermination;
+	}
+
+	void IndexSearcher::setImpactTiers(const bool _impactTiers){
+		impactTiers = _impactTiers;
+	}
+
+	bool IndexSearcher::getImpactTiers() const{
+		return impactTiers;
+	}
+
+	void IndexSearcher::setQueryResultCache(QueryResultCache* cache){
+		queryResultCache = cache;
+	}
+
+	QueryResultCache* IndexSearcher::getQueryResultCache() const{
+		return queryResultCache;
+	}
+
 	const char* IndexSearcher::getClassName(){
 		return "IndexSearcher";
 	}
@@ -21,6 +21,7 @@ CL_CLASS_DEF(search,Filter)
 CL_CLASS_DEF(search,Sort)
 CL_CLASS_DEF(search,HitCollector)
 CL_CLASS_DEF(search,Explanation)
+CL_CLASS_DEF(search,QueryResultCache)
 CL_CLASS_DEF(index,IndexReader)
 //#include "CLucene/index/IndexReader.h"
 //#include "CLucene/util/BitSet.h"
@@ -36,6 +37,9 @@ CL_NS_DEF(search)
 class CLUCENE_EXPORT IndexSearcher:public Searcher{
 	CL_NS(index)::IndexReader* reader;
 	bool readerOwner;
+	bool earlyTermination;
+	bool impactTiers;
+	QueryResultCache* queryResultCache;
 
 public:
 	/** Creates a searcher searching the index in the named directory.
@@ -68,6 +72,8 @@ public:
 	bool doc(int32_t i, CL_NS(document)::Document& document);
 	bool doc(int32_t i, CL_NS(document)::Document* document);
 	_CL_DEPRECATED( doc(i, document) ) CL_NS(document)::Document* doc(int32_t i);
+	void docs(const int32_t* ids, const int32_t count, CL_NS(document)::Document** result,
+		const CL_NS(document)::FieldSelector* fieldSelector = NULL);
 
 	int32_t maxDoc() const;
 
@@ -78,6 +84,41 @@ public:
 
 	CL_NS(index)::IndexReader* getReader();
 
+	/** Expert: Stop reading a segment in a sorted search once the top hits
+	* of the segment are known. This is the case when the segment was
+	* written by a merge in the index sort of the IndexWriter (see
+	* IndexWriter#setIndexSort) and the search sorts by the same fields, or
+	* by the first of them, in the same order. The hits returned are the
+	* same, but TopFieldDocs#totalHits only counts the hits read, so that it
+	* is no more than a lower bound of the number of hits, and Hits does not
+	* find all of them. Off by default.
+	*/
+	void setEarlyTermination(const bool earlyTermination);
+	/** @see #setEarlyTermination */
+	bool getEarlyTermination() const;
+
+	/** Expert: In a search by relevance without a filter, score the
+	* documents of the impact tiers of the query's terms (see
+	* Field#INDEX_IMPACTTIERS) first in each segment, and skip the others
+	* as soon as none of them can score high enough to be among the top
+	* hits. Only term queries and disjunctions of them are scored this way.
+	* The hits returned are the same, but TopDocs#totalHits may only count
+	* the hits read, so that it is no more than a lower bound of the number
+	* of hits. Off by default.
+	*/
+	void setImpactTiers(const bool impactTiers);
+	/** @see #setImpactTiers */
+	bool getImpactTiers() const;
+
+	/** Returns the top hits of a search from <code>cache</code> when they
+	* are there, and puts them there when they are not. The cache is not
+	* owned by the searcher, and may be shared by several searchers. NULL,
+	* the default, turns caching off. See QueryResultCache.
+	*/
+	void setQueryResultCache(QueryResultCache* cache);
+	/** @see #setQueryResultCache */
+	QueryResultCache* getQueryResultCache() const;
+
 	Query* rewrite(Query* original);
 	void explain(Query* query, int32_t doc, Explanation* ret);
 
@@ -82,6 +82,20 @@ CL_NS_DEF(search)
     return searchables[i]->doc(n - starts[i], d);	  // dispatch to searcher
   }
 
+  void MultiSearcher::docs(const int32_t* ids, const int32_t count, Document** result, const FieldSelector* fieldSelector) {
+    std::vector< std::vector<int32_t> > subIds(searchablesLen);
+    std::vector< std::vector<Document*> > subResult(searchablesLen);
+    for (int32_t j = 0; j < count; j++) {
+      int32_t i = subSearcher(ids[j]);
+      subIds[i].push_back(ids[j] - starts[i]);
+      subResult[i].push_back(result[j]);
+    }
+    for (int32_t i = 0; i < searchablesLen; i++) {
+      if (!subIds[i].empty())
+        searchables[i]->docs(&subIds[i][0], (int32_t)subIds[i].size(), &subResult[i][0], fieldSelector);
+    }
+  }
+
   int32_t MultiSearcher::searcherIndex(int32_t n) const{
 	 return subSearcher(n);
   }
@@ -45,6 +45,10 @@ CL_NS_DEF(search)
       /** For use by {@link HitCollector} implementations. */
 	  bool doc(int32_t n, CL_NS(document)::Document* document);
 
+      /** Dispatches each searcher its share of the batch at once. */
+	  void docs(const int32_t* ids, const int32_t count, CL_NS(document)::Document** result,
+	    const CL_NS(document)::FieldSelector* fieldSelector = NULL);
+
       /** For use by {@link HitCollector} implementations to identify the
        * index of the sub-searcher that a particular hit came from. */
       int32_t searcherIndex(int32_t n) const;
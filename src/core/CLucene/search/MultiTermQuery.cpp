@@ -11,16 +11,23 @@
 #include "BooleanQuery.h"
 #include "FilteredTermEnum.h"
 #include "TermQuery.h"
+#include "ConstantScoreQuery.h"
 #include "CLucene/index/Term.h"
+#include "CLucene/index/Terms.h"
+#include "CLucene/index/IndexReader.h"
+#include "CLucene/util/BitSet.h"
 #include "CLucene/util/StringBuffer.h"
 
 CL_NS_USE(index)
 CL_NS_USE(util)
 CL_NS_DEF(search)
 
+MultiTermQuery::RewriteMethod MultiTermQuery::defaultRewriteMethod = MultiTermQuery::SCORING_BOOLEAN_QUERY_REWRITE;
+
 /** Constructs a query for terms matching <code>term</code>. */
 
-MultiTermQuery::MultiTermQuery(Term* t)
+MultiTermQuery::MultiTermQuery(Term* t) :
+    rewriteMethod(defaultRewriteMethod)
 {
     //Func - Constructor
     //Pre  - t != NULL
@@ -32,7 +39,8 @@ MultiTermQuery::MultiTermQuery(Term* t)
 
 }
 MultiTermQuery::MultiTermQuery(const MultiTermQuery& clone) :
-    Query(clone)
+    Query(clone),
+    rewriteMethod(clone.rewriteMethod)
 {
     term = _CLNEW Term(clone.getTerm(false), clone.getTerm(false)->text());
 }
@@ -54,8 +62,47 @@ Term* MultiTermQuery::getTerm(bool pointer) const
         return term;
 }
 
+void MultiTermQuery::setRewriteMethod(RewriteMethod method)
+{
+    rewriteMethod = method;
+}
+
+MultiTermQuery::RewriteMethod MultiTermQuery::getRewriteMethod() const
+{
+    return rewriteMethod;
+}
+
+void MultiTermQuery::setDefaultRewriteMethod(RewriteMethod method)
+{
+    defaultRewriteMethod = method;
+}
+
+MultiTermQuery::RewriteMethod MultiTermQuery::getDefaultRewriteMethod()
+{
+    return defaultRewriteMethod;
+}
+
+Query* MultiTermQuery::rewriteConstantScore()
+{
+    Query* query = _CLNEW ConstantScoreQuery(_CLNEW MultiTermQueryWrapperFilter(this));
+    query->setBoost(getBoost());
+    return query;
+}
+
 Query* MultiTermQuery::rewrite(IndexReader* reader)
 {
+    if (rewriteMethod == CONSTANT_SCORE_FILTER_REWRITE)
+        return rewriteConstantScore();
+
+    //the auto method gives up on scoring terms separately once too many
+    //terms or documents are involved
+    const bool autoRewrite = (rewriteMethod == CONSTANT_SCORE_AUTO_REWRITE);
+    const size_t termCountCutoff = cl_min((size_t) LUCENE_MULTITERMQUERY_AUTO_TERM_COUNT_CUTOFF,
+        BooleanQuery::getMaxClauseCount());
+    const int32_t docCountCutoff = (int32_t) (LUCENE_MULTITERMQUERY_AUTO_DOC_COUNT_PERCENT / 100 * reader->maxDoc());
+    int32_t docCount = 0;
+    bool useFilter = false;
+
     FilteredTermEnum* enumerator = getEnum(reader);
     BooleanQuery* query = _CLNEW BooleanQuery(true);
     try
@@ -65,12 +112,36 @@ Query* MultiTermQuery::rewrite(IndexReader* reader)
             Term* t = enumerator->term(false);
             if (t != NULL)
             {
+                if (autoRewrite)
+                {
+                    docCount += enumerator->docFreq();
+                    if (query->getClauseCount() >= termCountCutoff || docCount > docCountCutoff)
+                    {
+                        useFilter = true;
+                        break;
+                    }
+                }
                 TermQuery* tq = _CLNEW TermQuery(t);	// found a match
                 tq->setBoost(getBoost() * enumerator->difference()); // set the boost
                 query->add(tq, true, false, false);		// add to q
             }
         } while (enumerator->next());
-    } _CLFINALLY(enumerator->close(); _CLDELETE(enumerator));
+    }
+    catch (...)
+    {
+        _CLDELETE(query); //in case of error, delete the query
+        enumerator->close();
+        _CLDELETE(enumerator);
+        throw; //rethrow
+    }
+    enumerator->close();
+    _CLDELETE(enumerator);
+
+    if (useFilter)
+    {
+        _CLDELETE(query);
+        return rewriteConstantScore();
+    }
 
     //if we only added one clause and the clause is not prohibited then
     //we can just return the query
@@ -93,6 +164,12 @@ Query* MultiTermQuery::rewrite(IndexReader* reader)
 
 Query* MultiTermQuery::combine(CL_NS(util)::ArrayBase<Query*>* queries)
 {
+    //constant score (and single term) rewrites cannot be merged clause by clause
+    for (size_t i = 0; i < queries->length; i++)
+    {
+        if (!queries->values[i]->instanceOf(BooleanQuery::getClassName()))
+            return Query::combine(queries);
+    }
     return Query::mergeBooleanQueries(queries);
 }
 
@@ -116,4 +193,87 @@ std::wstring MultiTermQuery::toString(const wchar_t* field) const
     return buffer;
 }
 
+
+MultiTermQueryWrapperFilter::MultiTermQueryWrapperFilter(const MultiTermQuery* query) :
+    query((MultiTermQuery*) query->clone())
+{
+}
+
+MultiTermQueryWrapperFilter::MultiTermQueryWrapperFilter(const MultiTermQueryWrapperFilter& copy) :
+    Filter(),
+    query((MultiTermQuery*) copy.query->clone())
+{
+}
+
+MultiTermQueryWrapperFilter::~MultiTermQueryWrapperFilter()
+{
+    _CLDELETE(query);
+}
+
+Filter* MultiTermQueryWrapperFilter::clone() const
+{
+    return _CLNEW MultiTermQueryWrapperFilter(*this);
+}
+
+std::wstring MultiTermQueryWrapperFilter::toString()
+{
+    return query->toString(NULL);
+}
+
+bool MultiTermQueryWrapperFilter::equals(Filter* other) const
+{
+    if (other->getObjectName() != getClassName())
+        return false;
+    return query->equals(static_cast<MultiTermQueryWrapperFilter*>(other)->query);
+}
+
+size_t MultiTermQueryWrapperFilter::hashCode() const
+{
+    return query->hashCode() ^ 0x1D2C6B47;
+}
+
+const std::wstring MultiTermQueryWrapperFilter::getObjectName() const
+{
+    return getClassName();
+}
+const std::wstring MultiTermQueryWrapperFilter::getClassName()
+{
+    return L"MultiTermQueryWrapperFilter";
+}
+
+/** Returns a BitSet with true for documents which should be permitted in
+search results, and false for those that should not. */
+BitSet* MultiTermQueryWrapperFilter::bits(IndexReader* reader)
+{
+    BitSet* bts = _CLNEW BitSet(reader->maxDoc());
+
+    FilteredTermEnum* enumerator = query->getEnum(reader);
+    TermDocs* termDocs = reader->termDocs();
+    try
+    {
+        if (enumerator->term(false) != NULL)
+        {
+            int32_t docs[32];
+            int32_t freqs[32];
+            do
+            {
+                termDocs->seek(enumerator);
+                int32_t count;
+                while ((count = termDocs->read(docs, freqs, 32)) > 0)
+                {
+                    for (int32_t i = 0; i < count; i++)
+                        bts->set(docs[i]);
+                }
+            } while (enumerator->next());
+        }
+    } _CLFINALLY(
+        termDocs->close();
+        _CLDELETE(termDocs);
+        enumerator->close();
+        _CLDELETE(enumerator);
+    )
+
+    return bts;
+}
+
 CL_NS_END
@@ -21,6 +21,7 @@ CL_CLASS_DEF(index, IndexReader)
 //#include "BooleanQuery.h"
 //#include "TermQuery.h"
 #include "Query.h"
+#include "Filter.h"
 
 CL_NS_DEF(search)
 /**
@@ -35,16 +36,52 @@ CL_NS_DEF(search)
  * For example, {@link WildcardQuery} and {@link FuzzyQuery} extend
  * <code>MultiTermQuery</code> to provide {@link WildcardTermEnum} and
  * {@link FuzzyTermEnum}, respectively.
+ * <P>
+ * How the query is rewritten is selected with {@link #setRewriteMethod}.
+ * The default scores every matching term separately; the constant score
+ * methods avoid the per-term cost and the clause limit of BooleanQuery.
  */
     class CLUCENE_EXPORT MultiTermQuery : public Query
 {
+public:
+    enum RewriteMethod {
+        /**
+        * Rewrites to a BooleanQuery with a TermQuery for each matching
+        * term, so each term is scored by its own idf and weight. Throws
+        * TooManyClauses if more than BooleanQuery::getMaxClauseCount()
+        * terms match.
+        */
+        SCORING_BOOLEAN_QUERY_REWRITE,
+
+        /**
+        * Enumerates the matching terms once into a filter and wraps it in
+        * a ConstantScoreQuery, so every hit scores the query boost. Has no
+        * limit on the number of terms.
+        */
+        CONSTANT_SCORE_FILTER_REWRITE,
+
+        /**
+        * Uses SCORING_BOOLEAN_QUERY_REWRITE while fewer than
+        * LUCENE_MULTITERMQUERY_AUTO_TERM_COUNT_CUTOFF terms match and they
+        * visit fewer than LUCENE_MULTITERMQUERY_AUTO_DOC_COUNT_PERCENT
+        * percent of the documents, CONSTANT_SCORE_FILTER_REWRITE otherwise.
+        */
+        CONSTANT_SCORE_AUTO_REWRITE
+    };
+
 private:
     CL_NS(index)::Term* term;
+    RewriteMethod rewriteMethod;
+    static RewriteMethod defaultRewriteMethod;
+
+    Query* rewriteConstantScore();
 protected:
     MultiTermQuery(const MultiTermQuery& clone);
 
     /** Construct the enumeration to be used, expanding the pattern term. */
     virtual FilteredTermEnum* getEnum(CL_NS(index)::IndexReader* reader) = 0;
+
+    friend class MultiTermQueryWrapperFilter;
 public:
     /** Constructs a query for terms matching <code>term</code>. */
     MultiTermQuery(CL_NS(index)::Term* t);
@@ -60,6 +97,48 @@ public:
     std::wstring toString(const wchar_t* field) const;
 
     virtual Query* rewrite(CL_NS(index)::IndexReader* reader);
+
+    /** Sets how this query is rewritten */
+    void setRewriteMethod(RewriteMethod method);
+    RewriteMethod getRewriteMethod() const;
+
+    /**
+    * Sets the rewrite method of queries created afterwards. The initial
+    * default is SCORING_BOOLEAN_QUERY_REWRITE.
+    */
+    static void setDefaultRewriteMethod(RewriteMethod method);
+    static RewriteMethod getDefaultRewriteMethod();
+};
+
+/**
+ * A filter that accepts the documents containing any of the terms a
+ * MultiTermQuery expands to. This is what
+ * MultiTermQuery::CONSTANT_SCORE_FILTER_REWRITE wraps in a
+ * ConstantScoreQuery.
+ */
+class CLUCENE_EXPORT MultiTermQueryWrapperFilter: public Filter
+{
+private:
+    MultiTermQuery* query;
+protected:
+    MultiTermQueryWrapperFilter(const MultiTermQueryWrapperFilter& copy);
+public:
+    /** Creates a filter for a copy of <code>query</code> */
+    MultiTermQueryWrapperFilter(const MultiTermQuery* query);
+    ~MultiTermQueryWrapperFilter();
+
+    /** Returns a BitSet with true for documents which should be permitted in
+    search results, and false for those that should not. */
+    CL_NS(util)::BitSet* bits(CL_NS(index)::IndexReader* reader);
+
+    Filter* clone() const;
+    std::wstring toString();
+
+    bool equals(Filter* other) const;
+    size_t hashCode() const;
+
+    static const std::wstring getClassName();
+    const std::wstring getObjectName() const;
 };
 CL_NS_END
 #endif
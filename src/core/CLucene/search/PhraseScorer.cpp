@@ -23,7 +23,7 @@ CL_NS_DEF(search)
 
 	PhraseScorer::PhraseScorer(Weight* _weight, TermPositions** tps, 
 		int32_t* offsets, Similarity* similarity, uint8_t* _norms):
-		Scorer(similarity), weight(_weight), norms(_norms), value(_weight->getValue()), firstTime(true), more(true), freq(0.0f),
+		Scorer(similarity), weight(_weight), norms(_norms), value(_weight->getValue()), firstTime(true), more(true), _cost(LUCENE_INT32_MAX_SHOULDBE), freq(0.0f),
 			first(NULL), last(NULL)
 	{
 	//Func - Constructor
@@ -41,6 +41,10 @@ CL_NS_DEF(search)
 		// when all PhrasePositions have exactly the same position.
 		int32_t i = 0;
 		while(tps[i] != NULL){
+			const int32_t df = tps[i]->docFreq();
+			if (df >= 0 && df < _cost)
+				_cost = df;
+
 			PhrasePositions *pp = _CLNEW PhrasePositions(tps[i], offsets[i]);
 			CND_CONDITION(pp != NULL,L"Could not allocate memory for pp");
 
@@ -72,6 +76,14 @@ CL_NS_DEF(search)
 	}
 
 	bool PhraseScorer::next(){
+		while (nextCandidate()) {
+			if (matches())
+				return true;
+		}
+		return false;
+	}
+
+	bool PhraseScorer::nextCandidate(){
 		if (firstTime) {
 			init();
 			firstTime = false;
@@ -81,24 +93,18 @@ CL_NS_DEF(search)
 		return doNext();
 	}
 
-	// next without initial increment
+	// next document containing all the terms, without initial increment
 	bool PhraseScorer::doNext() {
-		while (more) {
-			while (more && first->doc < last->doc) {      // find doc w/ all the terms
-				more = first->skipTo(last->doc);            // skip first upto last
-				firstToLast();                            // and move it to the end
-			}
-
-			if (more) {
-				// found a doc with all of the terms
-				freq = phraseFreq();                      // check for phrase
-				if (freq == 0.0f)                         // no match
-					more = last->next();                     // trigger further scanning
-				else
-					return true;                            // found a match
-			}
+		while (more && first->doc < last->doc) {      // find doc w/ all the terms
+			more = first->skipTo(last->doc);            // skip first upto last
+			firstToLast();                            // and move it to the end
 		}
-		return false;                                 // no more matches
+		return more;
+	}
+
+	bool PhraseScorer::matches(){
+		freq = phraseFreq();                          // check for phrase
+		return freq != 0.0f;
 	}
 
 	float_t PhraseScorer::score(){
@@ -108,6 +114,12 @@ CL_NS_DEF(search)
 	}
 
 	bool PhraseScorer::skipTo(int32_t target) {
+		if (!skipToCandidate(target))
+			return false;
+		return matches() || next();
+	}
+
+	bool PhraseScorer::skipToCandidate(int32_t target) {
 		firstTime = false;
 		for (PhrasePositions* pp = first; more && pp != NULL; pp = pp->_next) {
 			more = pp->skipTo(target);
@@ -220,4 +232,6 @@ CL_NS_DEF(search)
 
 	int32_t PhraseScorer::doc() const { return first->doc; }
 
+	int64_t PhraseScorer::cost() const { return _cost; }
+
 CL_NS_END
@@ -22,20 +22,14 @@ CL_NS_USE(util)
 CL_NS_USE(index)
 CL_NS_DEF(search)
 
-PrefixQuery::PrefixQuery(Term* Prefix)
+PrefixQuery::PrefixQuery(Term* Prefix) :
+    MultiTermQuery(Prefix)
 {
-    //Func - Constructor.
-    //       Constructs a query for terms starting with prefix
-    //Pre  - Prefix != NULL 
-    //Post - The instance has been created
-
-        //Get a pointer to Prefix
-    prefix = _CL_POINTER(Prefix);
 }
 
-PrefixQuery::PrefixQuery(const PrefixQuery& clone) :Query(clone)
+PrefixQuery::PrefixQuery(const PrefixQuery& clone) :
+    MultiTermQuery(clone)
 {
-    prefix = _CL_POINTER(clone.prefix);
 }
 Query* PrefixQuery::clone() const
 {
@@ -44,42 +38,27 @@ Query* PrefixQuery::clone() const
 
 Term* PrefixQuery::getPrefix(bool pointer)
 {
-    if (pointer)
-        return _CL_POINTER(prefix);
-    else
-        return prefix;
+    return getTerm(pointer);
 }
 
 PrefixQuery::~PrefixQuery()
 {
-    //Func - Destructor
-    //Pre  - true
-    //Post - The instance has been destroyed.
-
-        //Delete prefix by finalizing it
-    _CLDECDELETE(prefix);
 }
 
 
 /** Returns a hash code value for this object.*/
 size_t PrefixQuery::hashCode() const
 {
-    return Similarity::floatToByte(getBoost()) ^ prefix->hashCode();
+    return Similarity::floatToByte(getBoost()) ^ getTerm(false)->hashCode();
 }
 
 const std::wstring PrefixQuery::getObjectName()const
 {
-    //Func - Returns the name "PrefixQuery" 
-    //Pre  - true
-    //Post - The string "PrefixQuery" has been returned
 
     return getClassName();
 }
 const std::wstring PrefixQuery::getClassName()
 {
-    //Func - Returns the name "PrefixQuery" 
-    //Pre  - true
-    //Post - The string "PrefixQuery" has been returned
 
     return L"PrefixQuery";
 }
@@ -91,128 +70,89 @@ bool PrefixQuery::equals(Query * other) const
 
     PrefixQuery* rq = (PrefixQuery*) other;
     bool ret = (this->getBoost() == rq->getBoost())
-        && (this->prefix->equals(rq->prefix));
+        && (this->getRewriteMethod() == rq->getRewriteMethod())
+        && (this->getTerm(false)->equals(rq->getTerm(false)));
 
     return ret;
 }
 
-Query* PrefixQuery::rewrite(IndexReader* reader)
+FilteredTermEnum* PrefixQuery::getEnum(IndexReader* reader)
 {
-    BooleanQuery* query = _CLNEW BooleanQuery(true);
-    TermEnum* enumerator = reader->terms(prefix);
-    Term* lastTerm = NULL;
-    try
-    {
-        const wchar_t* prefixText = prefix->text();
-        const wchar_t* prefixField = prefix->field();
-        const wchar_t* tmp;
-        size_t i;
-        size_t prefixLen = prefix->textLength();
-        do
-        {
-            lastTerm = enumerator->term();
-            if (lastTerm != NULL &&
-                lastTerm->field() == prefixField) // interned comparison
-            {
-
-                //now see if term->text() starts with prefixText
-                size_t termLen = lastTerm->textLength();
-                if (prefixLen > termLen)
-                    break; //the prefix is longer than the term, can't be matched
-
-                tmp = lastTerm->text();
-
-                //check for prefix match in reverse, since most change will be at the end
-                for (i = prefixLen - 1; i != -1; --i)
-                {
-                    if (tmp[i] != prefixText[i])
-                    {
-                        tmp = NULL;//signals inequality
-                        break;
-                    }
-                }
-                if (tmp == NULL)
-                    break;
-
-                TermQuery* tq = _CLNEW TermQuery(lastTerm);	  // found a match
-                tq->setBoost(getBoost());                // set the boost
-                query->add(tq, true, false, false);		  // add to query
-            }
-            else
-                break;
-            _CLDECDELETE(lastTerm);
-        } while (enumerator->next());
-    }_CLFINALLY(
-        enumerator->close();
-    _CLDELETE(enumerator);
-    _CLDECDELETE(lastTerm);
-    );
-    _CLDECDELETE(lastTerm);
-
-
-    //if we only added one clause and the clause is not prohibited then
-    //we can just return the query
-    if (query->getClauseCount() == 1)
-    {                    // optimize 1-clause queries
-        BooleanClause* c = 0;
-        query->getClauses(&c);
-
-        if (!c->prohibited)
-        {			  // just return clause
-            c->deleteQuery = false;
-            Query* ret = c->getQuery();
-
-            _CLDELETE(query);
-            return ret;
-        }
-    }
-
-    return query;
-}
-
-Query* PrefixQuery::combine(CL_NS(util)::ArrayBase<Query*>* queries)
-{
-    return Query::mergeBooleanQueries(queries);
+    return _CLNEW PrefixTermEnum(reader, getTerm(false));
 }
 
 std::wstring PrefixQuery::toString(const wchar_t* field) const
 {
-    //Func - Creates a user-readable version of this query and returns it as as string
-    //Pre  - field != NULL
-    //Post - a user-readable version of this query has been returned as as string
-
-      //Instantiate a stringbuffer buffer to store the readable version temporarily
+    Term* prefix = getTerm(false);
     std::wstring buffer;
-    //check if field equal to the field of prefix
     if (field == NULL ||
         wcscmp(prefix->field(), field) != 0)
     {
-        //Append the field of prefix to the buffer
         buffer.append(prefix->field());
-        //Append a colon
         buffer.append(L":");
     }
-    //Append the text of the prefix
     buffer.append(prefix->text());
-    //Append a wildchar character
     buffer.append(L"*");
-    //if the boost factor is not eaqual to 1
     if (getBoost() != 1.0f)
     {
-        //Append ^
         buffer.append(L"^");
-        //Append the boost factor
         buffer.append(float_to_wstring(getBoost(), 1));
     }
-    //Convert StringBuffer buffer to wchar_t block and return it
     return buffer;
 }
 
 
+PrefixTermEnum::PrefixTermEnum(IndexReader* reader, Term* prefix) :
+    FilteredTermEnum(),
+    prefix(_CL_POINTER(prefix)),
+    _endEnum(false)
+{
+    setEnum(reader->terms(prefix));
+}
+
+PrefixTermEnum::~PrefixTermEnum()
+{
+    close();
+}
+
+void PrefixTermEnum::close()
+{
+    if (prefix != NULL)
+    {
+        FilteredTermEnum::close();
+        _CLDECDELETE(prefix);
+        prefix = NULL;
+    }
+}
+
+bool PrefixTermEnum::termCompare(Term* term)
+{
+    //terms are sorted, so the first one without the prefix ends the enumeration
+    if (term != NULL && term->field() == prefix->field() // interned comparison
+        && term->textLength() >= prefix->textLength()
+        && wcsncmp(term->text(), prefix->text(), prefix->textLength()) == 0)
+    {
+        return true;
+    }
+    _endEnum = true;
+    return false;
+}
+
+float_t PrefixTermEnum::difference()
+{
+    return 1.0f;
+}
+
+bool PrefixTermEnum::endEnum()
+{
+    return _endEnum;
+}
+
+const std::wstring PrefixTermEnum::getObjectName() const { return getClassName(); }
+const std::wstring PrefixTermEnum::getClassName() { return L"PrefixTermEnum"; }
 
 
 
-//todo: this needs to be exposed, but java is still a bit confused about how...
 class PrefixFilter::PrefixGenerator
 {
     const Term* prefix;
@@ -333,6 +273,27 @@ std::wstring PrefixFilter::toString()
     return buffer;
 }
 
+bool PrefixFilter::equals(Filter* other) const
+{
+    if (other->getObjectName() != getClassName())
+        return false;
+    return prefix->equals(static_cast<PrefixFilter*>(other)->prefix);
+}
+
+size_t PrefixFilter::hashCode() const
+{
+    return prefix->hashCode() ^ 0x6634D93C;
+}
+
+const std::wstring PrefixFilter::getObjectName() const
+{
+    return getClassName();
+}
+const std::wstring PrefixFilter::getClassName()
+{
+    return L"PrefixFilter";
+}
+
 /** Returns a BitSet with true for documents which should be permitted in
 search results, and false for those that should not. */
 BitSet* PrefixFilter::bits(IndexReader* reader)
@@ -15,18 +15,23 @@ CL_CLASS_DEF(index,Term)
 //#include "SearchHeader.h"
 //#include "BooleanQuery.h"
 //#include "TermQuery.h"
-#include "Query.h"
+#include "MultiTermQuery.h"
+#include "FilteredTermEnum.h"
 #include "Filter.h"
 CL_CLASS_DEF(util,StringBuffer)
 
 CL_NS_DEF(search) 
 /** A Query that matches documents containing terms with a specified prefix. A PrefixQuery
-* is built by QueryParser for input like <code>app*</code>. */
-	class CLUCENE_EXPORT PrefixQuery: public Query {
-	private:
-		CL_NS(index)::Term* prefix;
+* is built by QueryParser for input like <code>app*</code>.
+*
+* <p>Broad prefixes can match more terms than BooleanQuery::getMaxClauseCount();
+* use {@link MultiTermQuery#setRewriteMethod} to rewrite to a constant score
+* query instead.</p>
+*/
+	class CLUCENE_EXPORT PrefixQuery: public MultiTermQuery {
 	protected:
 		PrefixQuery(const PrefixQuery& clone);
+		FilteredTermEnum* getEnum(CL_NS(index)::IndexReader* reader);
 	public:
 
 		//Constructor. Constructs a query for terms starting with prefix
@@ -42,8 +47,6 @@ CL_NS_DEF(search)
 		/** Returns the prefix of this query. */
 		CL_NS(index)::Term* getPrefix(bool pointer=true);
 
-    Query* combine(CL_NS(util)::ArrayBase<Query*>* queries);
-		Query* rewrite(CL_NS(index)::IndexReader* reader);
 		Query* clone() const;
 		bool equals(Query * other) const;
 
@@ -52,6 +55,28 @@ CL_NS_DEF(search)
 
 		size_t hashCode() const;
 	};
+
+    /**
+     * Subclass of FilteredTermEnum for enumerating all terms that start
+     * with the text of a prefix term.
+     */
+	class CLUCENE_EXPORT PrefixTermEnum: public FilteredTermEnum {
+	private:
+		CL_NS(index)::Term* prefix;
+		bool _endEnum;
+	protected:
+		bool termCompare(CL_NS(index)::Term* term);
+	public:
+		PrefixTermEnum(CL_NS(index)::IndexReader* reader, CL_NS(index)::Term* prefix);
+		~PrefixTermEnum();
+
+		float_t difference();
+		bool endEnum();
+		void close();
+
+		const std::wstring getObjectName() const;
+		static const std::wstring getClassName();
+	};
 	
 	
     class CLUCENE_EXPORT PrefixFilter: public Filter 
@@ -75,6 +100,12 @@ CL_NS_DEF(search)
 		/** Prints a user-readable version of this query. */
     	std::wstring toString();
 
+    	bool equals(Filter* other) const;
+    	size_t hashCode() const;
+
+    	static const std::wstring getClassName();
+    	const std::wstring getObjectName() const;
+
 		// Returns a reference of internal prefix
 		CL_NS(index)::Term* getPrefix() const;
     };
@@ -68,6 +68,27 @@ std::wstring QueryFilter::toString()
 	return L"QueryFilter("+ qt + L")";
 }
 
+bool QueryFilter::equals(Filter* other) const
+{
+	if ( other->getObjectName() != getClassName() )
+		return false;
+	return query->equals(static_cast<QueryFilter*>(other)->query);
+}
+
+size_t QueryFilter::hashCode() const
+{
+	return query->hashCode() ^ 0x923F64B9;
+}
+
+const std::wstring QueryFilter::getObjectName() const
+{
+	return getClassName();
+}
+const std::wstring QueryFilter::getClassName()
+{
+	return L"QueryFilter";
+}
+
 
 /** Returns a BitSet with true for documents which should be permitted in
 search results, and false for those that should not. */
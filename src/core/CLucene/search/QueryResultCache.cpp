@@ -0,0 +1,335 @@
+/*------------------------------------------------------------------------------
+* Copyright (C) 2003-2006 Ben van Klinken and the CLucene Team
+
+* Updated by https://github.com/farfella/.
+*
+* Distributable under the terms of either the Apache License (Version 2.0) or
+* the GNU Lesser General Public License, as specified in the COPYING file.
+------------------------------------------------------------------------------*/
+#include "CLucene/_ApiHeader.h"
+#include "QueryResultCache.h"
+#include "Query.h"
+#include "Filter.h"
+#include "Sort.h"
+#include "SearchHeader.h"
+#include "FieldDoc.h"
+#include "_FieldDocSortedHitQueue.h"
+#include "CLucene/index/IndexReader.h"
+#include "CLucene/util/Misc.h"
+
+CL_NS_USE(index)
+CL_NS_USE(util)
+CL_NS_DEF(search)
+
+/** What tells one search from another */
+struct QueryResultCache::Key {
+	Query* query;                // a clone, owned by the entry once cached
+	Filter* filter;              // likewise, or NULL
+	std::wstring sort;           // empty for a search by relevance
+	bool sorted;
+	int32_t nDocs;
+	bool earlyTermination;       // whether totalHits may only be a lower bound
+	Similarity* similarity;
+	std::vector<std::pair<IndexReader*, int32_t> > segments;   // each with its number of documents
+	size_t hash;
+
+	Key(): query(NULL), filter(NULL), sorted(false), nDocs(0), earlyTermination(false), similarity(NULL), hash(0){}
+
+	bool equals(const Key& other) const{
+		return hash == other.hash && sorted == other.sorted && nDocs == other.nDocs &&
+			earlyTermination == other.earlyTermination && similarity == other.similarity &&
+			segments == other.segments && sort == other.sort &&
+			(filter == NULL ? other.filter == NULL : other.filter != NULL && filter->equals(other.filter)) &&
+			query->equals(other.query);
+	}
+};
+
+struct QueryResultCache::Entry {
+	Key key;
+	TopDocs* topDocs;
+	size_t bytes;
+	int64_t hits;
+	EntryList::iterator position;
+
+	Entry(): topDocs(NULL), bytes(0), hits(0){}
+	~Entry(){
+		_CLDELETE(key.query);
+		_CLDELETE(key.filter);
+		_CLDELETE(topDocs);
+	}
+};
+
+namespace {
+	void gatherSegments(IndexReader* reader, std::vector<std::pair<IndexReader*, int32_t> >& segments){
+		const ArrayBase<IndexReader*>* subReaders = reader->getSubReaders();
+		if (subReaders == NULL || subReaders->length == 0) {
+			segments.push_back(std::make_pair(reader, reader->numDocs()));
+			return;
+		}
+		for (size_t i = 0; i < subReaders->length; i++)
+			gatherSegments(subReaders->values[i], segments);
+	}
+
+	/** Copies a sort value, or returns NULL if it is not one of the built-in sorts' */
+	Comparable* copySortValue(Comparable* value){
+		const std::wstring name = value->getObjectName();
+		if (name == Compare::Int32::getClassName())
+			return _CLNEW Compare::Int32(static_cast<Compare::Int32*>(value)->getValue());
+		if (name == Compare::Float::getClassName())
+			return _CLNEW Compare::Float(static_cast<Compare::Float*>(value)->getValue());
+		return NULL;   // strings point into the FieldCache of the reader, which may close first
+	}
+
+	/** Copies top hits, and adds the memory the copy holds to <code>bytes</code>. Returns NULL if they cannot be copied */
+	TopDocs* copyTopDocs(TopDocs* topDocs, const bool sorted, size_t& bytes){
+		const int32_t length = topDocs->scoreDocsLength;
+		if (!sorted) {
+			ScoreDoc* scoreDocs = new ScoreDoc[length];
+			for (int32_t i = 0; i < length; i++)
+				scoreDocs[i] = topDocs->scoreDocs[i];
+			bytes += sizeof(TopDocs) + length * sizeof(ScoreDoc);
+			return _CLNEW TopDocs(topDocs->totalHits, scoreDocs, length);
+		}
+
+		TopFieldDocs* fieldDocs = static_cast<TopFieldDocs*>(topDocs);
+		int32_t numFields = 0;
+		while (fieldDocs->fields != NULL && fieldDocs->fields[numFields] != NULL)
+			numFields++;
+
+		FieldDoc** docs = _CL_NEWARRAY(FieldDoc*, length);
+		int32_t copied = 0;
+		bool ok = true;
+		for (; ok && copied < length; copied++) {
+			Comparable** values = NULL;
+			Comparable** original = fieldDocs->fieldDocs[copied]->fields;
+			if (original != NULL) {
+				int32_t n = 0;
+				while (original[n] != NULL)
+					n++;
+				values = _CL_NEWARRAY(Comparable*, n + 1);
+				for (int32_t j = 0; j < n && ok; j++) {
+					values[j] = copySortValue(original[j]);
+					ok = values[j] != NULL;
+				}
+				values[n] = NULL;
+				bytes += (n + 1) * sizeof(Comparable*) + n * sizeof(Compare::Float);
+			}
+			const ScoreDoc& scoreDoc = fieldDocs->fieldDocs[copied]->scoreDoc;
+			docs[copied] = _CLNEW FieldDoc(scoreDoc.doc, scoreDoc.score, values);
+		}
+		SortField** fields = NULL;
+		if (fieldDocs->fields != NULL) {
+			fields = _CL_NEWARRAY(SortField*, numFields + 1);
+			for (int32_t j = 0; j < numFields; j++)
+				fields[j] = fieldDocs->fields[j]->clone();
+			fields[numFields] = NULL;
+		}
+		TopFieldDocs* result = _CLNEW TopFieldDocs(fieldDocs->totalHits, docs, copied, fields);
+		if (!ok) {
+			_CLDELETE(result);
+			return NULL;
+		}
+		bytes += sizeof(TopFieldDocs) + length * (sizeof(ScoreDoc) + sizeof(FieldDoc*) + sizeof(FieldDoc)) +
+			numFields * sizeof(SortField);
+		return result;
+	}
+}
+
+std::set<QueryResultCache*> QueryResultCache::caches;
+DEFINE_MUTEX(QueryResultCache::caches_LOCK)
+
+QueryResultCache::QueryResultCache(const size_t _maxBytes, const EvictionPolicy _policy):
+	maxBytes(_maxBytes),
+	bytes(0),
+	policy(_policy),
+	hitCount(0),
+	missCount(0),
+	evictionCount(0)
+{
+	SCOPED_LOCK_MUTEX(caches_LOCK)
+	caches.insert(this);
+}
+
+QueryResultCache::~QueryResultCache(){
+	{
+		SCOPED_LOCK_MUTEX(caches_LOCK)
+		caches.erase(this);
+	}
+	clear();
+}
+
+bool QueryResultCache::makeKey(IndexReader* reader, Query* query, Filter* filter, const Sort* sort,
+	const int32_t nDocs, const bool earlyTermination, Similarity* similarity, Key& key)
+{
+	if (sort != NULL) {
+		SortField** fields = sort->getSort();
+		for (int32_t i = 0; fields[i] != NULL; i++) {
+			if (fields[i]->getType() == SortField::CUSTOM || fields[i]->getType() == SortField::STRING)
+				return false;
+			if (i > 0)
+				key.sort.push_back(L',');
+			if (fields[i]->getField() != NULL)
+				key.sort.append(fields[i]->getField());
+			key.sort.push_back(L':');
+			key.sort.append(Misc::toString(fields[i]->getType()));
+			if (fields[i]->getReverse())
+				key.sort.push_back(L'!');
+		}
+		key.sorted = true;
+	}
+	key.filter = filter;
+	key.nDocs = nDocs;
+	key.earlyTermination = earlyTermination;
+	key.similarity = similarity;
+	gatherSegments(reader, key.segments);
+	key.query = query;
+
+	size_t h = query->hashCode();
+	h = h * 31 + (filter != NULL ? filter->hashCode() : 0);
+	h = h * 31 + Misc::thashCode(key.sort.c_str());
+	h = h * 31 + static_cast<size_t>(nDocs);
+	for (size_t i = 0; i < key.segments.size(); i++)
+		h = h * 31 + reinterpret_cast<size_t>(key.segments[i].first) + static_cast<size_t>(key.segments[i].second);
+	key.hash = h;
+	return true;
+}
+
+QueryResultCache::Entry* QueryResultCache::find(const Key& key){
+	std::pair<EntryMap::iterator, EntryMap::iterator> range = index.equal_range(key.hash);
+	for (EntryMap::iterator itr = range.first; itr != range.second; ++itr) {
+		if (itr->second->key.equals(key))
+			return itr->second;
+	}
+	return NULL;
+}
+
+TopDocs* QueryResultCache::get(IndexReader* reader, Query* query, Filter* filter, const Sort* sort,
+	const int32_t nDocs, const bool earlyTermination, Similarity* similarity)
+{
+	Key key;                                       // does not own the query, unlike an entry's
+	if (!makeKey(reader, query, filter, sort, nDocs, earlyTermination, similarity, key))
+		return NULL;
+
+	SCOPED_LOCK_MUTEX(THIS_LOCK)
+	Entry* entry = find(key);
+	if (entry == NULL) {
+		missCount++;
+		return NULL;
+	}
+	hitCount++;
+	entry->hits++;
+	entries.splice(entries.begin(), entries, entry->position);
+	size_t ignored = 0;
+	return copyTopDocs(entry->topDocs, entry->key.sorted, ignored);
+}
+
+void QueryResultCache::put(IndexReader* reader, Query* query, Filter* filter, const Sort* sort,
+	const int32_t nDocs, const bool earlyTermination, Similarity* similarity, TopDocs* topDocs)
+{
+	Entry* entry = _CLNEW Entry();
+	if (!makeKey(reader, query, filter, sort, nDocs, earlyTermination, similarity, entry->key)) {
+		entry->key.query = NULL;
+		entry->key.filter = NULL;
+		_CLDELETE(entry);
+		return;
+	}
+	entry->key.query = query->clone();
+	if (filter != NULL)
+		entry->key.filter = filter->clone();
+	entry->bytes = sizeof(Entry) + entry->key.segments.size() * sizeof(std::pair<IndexReader*, int32_t>) +
+		(entry->key.sort.length() + entry->key.query->toString().length()) * sizeof(wchar_t);
+	entry->topDocs = copyTopDocs(topDocs, entry->key.sorted, entry->bytes);
+	if (entry->topDocs == NULL || entry->bytes > maxBytes) {
+		_CLDELETE(entry);
+		return;
+	}
+
+	SCOPED_LOCK_MUTEX(THIS_LOCK)
+	Entry* existing = find(entry->key);
+	if (existing != NULL)                          // cached by another thread in the meantime
+		remove(existing);
+	entries.push_front(entry);
+	entry->position = entries.begin();
+	index.insert(std::make_pair(entry->key.hash, entry));
+	bytes += entry->bytes;
+	for (size_t i = 0; i < entry->key.segments.size(); i++)
+		entry->key.segments[i].first->addCloseCallback(closeCallback, NULL);
+	while (bytes > maxBytes)
+		evict();
+}
+
+void QueryResultCache::remove(Entry* entry){
+	std::pair<EntryMap::iterator, EntryMap::iterator> range = index.equal_range(entry->key.hash);
+	for (EntryMap::iterator itr = range.first; itr != range.second; ++itr) {
+		if (itr->second == entry) {
+			index.erase(itr);
+			break;
+		}
+	}
+	entries.erase(entry->position);
+	bytes -= entry->bytes;
+	_CLDELETE(entry);
+}
+
+void QueryResultCache::evict(){
+	EntryList::iterator victim = --entries.end();   // least recently used
+	if (policy == LFU) {
+		for (EntryList::iterator itr = victim; itr != entries.begin(); ) {
+			--itr;
+			if ((*itr)->hits < (*victim)->hits)
+				victim = itr;
+		}
+	}
+	remove(*victim);
+	evictionCount++;
+}
+
+void QueryResultCache::clear(){
+	SCOPED_LOCK_MUTEX(THIS_LOCK)
+	while (!entries.empty())
+		remove(entries.front());
+}
+
+void QueryResultCache::removeSegment(IndexReader* reader){
+	SCOPED_LOCK_MUTEX(THIS_LOCK)
+	EntryList::iterator itr = entries.begin();
+	while (itr != entries.end()) {
+		Entry* entry = *itr++;
+		for (size_t i = 0; i < entry->key.segments.size(); i++) {
+			if (entry->key.segments[i].first == reader) {
+				remove(entry);
+				break;
+			}
+		}
+	}
+}
+
+void QueryResultCache::closeCallback(IndexReader* reader, void* /*param*/){
+	SCOPED_LOCK_MUTEX(caches_LOCK)
+	for (std::set<QueryResultCache*>::iterator itr = caches.begin(); itr != caches.end(); ++itr)
+		(*itr)->removeSegment(reader);
+}
+
+int64_t QueryResultCache::getHitCount() const{
+	return hitCount;
+}
+int64_t QueryResultCache::getMissCount() const{
+	return missCount;
+}
+int64_t QueryResultCache::getEvictionCount() const{
+	return evictionCount;
+}
+size_t QueryResultCache::size() const{
+	return index.size();
+}
+size_t QueryResultCache::getSizeInBytes() const{
+	return bytes;
+}
+size_t QueryResultCache::getMaxBytes() const{
+	return maxBytes;
+}
+QueryResultCache::EvictionPolicy QueryResultCache::getEvictionPolicy() const{
+	return policy;
+}
+
+CL_NS_END
@@ -0,0 +1,118 @@
+/*------------------------------------------------------------------------------
+* Copyright (C) 2003-2006 Ben van Klinken and the CLucene Team
+
+* Updated by https://github.com/farfella/.
+*
+* Distributable under the terms of either the Apache License (Version 2.0) or
+* the GNU Lesser General Public License, as specified in the COPYING file.
+------------------------------------------------------------------------------*/
+#ifndef _lucene_search_QueryResultCache_
+#define _lucene_search_QueryResultCache_
+
+#include <list>
+#include <map>
+#include <set>
+#include <vector>
+
+CL_CLASS_DEF(index,IndexReader)
+
+CL_NS_DEF(search)
+class Query;
+class Filter;
+class Sort;
+class Similarity;
+class TopDocs;
+class TopFieldDocs;
+
+/**
+* Caches the top hits of searches, for an IndexSearcher to return when
+* the same search is repeated (see IndexSearcher#setQueryResultCache).
+*
+* <p>Two searches are the same if their queries are equal (Query#equals),
+* their filters are equal (Filter#equals, so a filter that does not
+* override it is never cached), they sort by the same fields, ask for the same number of hits and use the
+* same Similarity, and the index has not changed in between: a result is
+* kept for the segments that were searched, each with its number of
+* documents, so that a search over a reopened index that shares all the
+* segments, unchanged, still finds it. An entry is dropped as soon as one
+* of its segments is closed. Changes to norms (IndexReader#setNorm) are not
+* noticed until then.</p>
+*
+* <p>The cache holds approximately no more than the number of bytes it is
+* given, evicting the least recently used entry, or the least frequently
+* used, first. Sorts by strings or by a custom comparator are not cached. A cache may be
+* shared by several searchers, and is thread safe.</p>
+*/
+class CLUCENE_EXPORT QueryResultCache: LUCENE_BASE {
+public:
+	enum EvictionPolicy {
+		/** Evict the entry found the longest ago */
+		LRU,
+		/** Evict the entry found the fewest times, and of those the one found the longest ago */
+		LFU
+	};
+
+	QueryResultCache(const size_t maxBytes = 16 * 1024 * 1024, const EvictionPolicy policy = LRU);
+	~QueryResultCache();
+
+	/**
+	* Returns a copy of the cached top hits of a search, which the caller
+	* owns, or NULL. <code>sort</code> is NULL for a search by relevance.
+	* <code>earlyTermination</code> is set if the search may not count all
+	* its hits (see IndexSearcher#setEarlyTermination and IndexSearcher#setImpactTiers).
+	*/
+	TopDocs* get(CL_NS(index)::IndexReader* reader, Query* query, Filter* filter, const Sort* sort,
+		const int32_t nDocs, const bool earlyTermination, Similarity* similarity);
+
+	/** Caches a copy of the top hits of a search. See #get */
+	void put(CL_NS(index)::IndexReader* reader, Query* query, Filter* filter, const Sort* sort,
+		const int32_t nDocs, const bool earlyTermination, Similarity* similarity, TopDocs* topDocs);
+
+	/** Drops every entry */
+	void clear();
+
+	/** The number of searches found in the cache */
+	int64_t getHitCount() const;
+	/** The number of searches not found in the cache */
+	int64_t getMissCount() const;
+	/** The number of entries evicted to make room for others */
+	int64_t getEvictionCount() const;
+	/** The number of entries */
+	size_t size() const;
+	/** The approximate memory held by the entries */
+	size_t getSizeInBytes() const;
+	size_t getMaxBytes() const;
+	EvictionPolicy getEvictionPolicy() const;
+
+private:
+	struct Key;
+	struct Entry;
+	typedef std::list<Entry*> EntryList;
+	typedef std::multimap<size_t, Entry*> EntryMap;
+
+	EntryList entries;           // most recently used first
+	EntryMap index;              // by hash of the key
+	size_t maxBytes;
+	size_t bytes;
+	EvictionPolicy policy;
+	int64_t hitCount;
+	int64_t missCount;
+	int64_t evictionCount;
+	DEFINE_MUTEX(THIS_LOCK)
+
+	/** Returns false if the search cannot be cached */
+	static bool makeKey(CL_NS(index)::IndexReader* reader, Query* query, Filter* filter, const Sort* sort,
+		const int32_t nDocs, const bool earlyTermination, Similarity* similarity, Key& key);
+	Entry* find(const Key& key);
+	void remove(Entry* entry);
+	void evict();
+
+	/** The caches, so that a segment closing can be dropped from each */
+	static std::set<QueryResultCache*> caches;
+	STATIC_DEFINE_MUTEX(caches_LOCK)
+	static void closeCallback(CL_NS(index)::IndexReader* reader, void* param);
+	void removeSegment(CL_NS(index)::IndexReader* reader);
+};
+
+CL_NS_END
+#endif
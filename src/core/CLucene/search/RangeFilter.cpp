@@ -11,6 +11,7 @@
 #include "CLucene/index/Terms.h"
 #include "CLucene/index/IndexReader.h"
 #include "CLucene/util/BitSet.h"
+#include "CLucene/util/Misc.h"
 #include "RangeFilter.h"
 
 CL_NS_DEF(search)
@@ -150,4 +151,40 @@ Filter* RangeFilter::clone() const {
 	return _CLNEW RangeFilter(*this );
 }
 
+static bool boundEquals(const wchar_t* a, const wchar_t* b)
+{
+	if ( a == NULL || b == NULL )
+		return a == b;
+	return wcscmp(a, b) == 0;
+}
+
+bool RangeFilter::equals(Filter* other) const
+{
+	if ( other->getObjectName() != getClassName() )
+		return false;
+
+	RangeFilter* rf = static_cast<RangeFilter*>(other);
+	return includeLower == rf->includeLower && includeUpper == rf->includeUpper
+		&& boundEquals(fieldName, rf->fieldName)
+		&& boundEquals(lowerTerm, rf->lowerTerm)
+		&& boundEquals(upperTerm, rf->upperTerm);
+}
+
+size_t RangeFilter::hashCode() const
+{
+	size_t h = Misc::whashCode(fieldName);
+	h = 31 * h + (lowerTerm != NULL ? Misc::whashCode(lowerTerm) : 0);
+	h = 31 * h + (upperTerm != NULL ? Misc::whashCode(upperTerm) : 0);
+	return h ^ (includeLower ? 1 : 0) ^ (includeUpper ? 2 : 0);
+}
+
+const std::wstring RangeFilter::getObjectName() const
+{
+	return getClassName();
+}
+const std::wstring RangeFilter::getClassName()
+{
+	return L"RangeFilter";
+}
+
 CL_NS_END
@@ -69,6 +69,13 @@ public:
 	
 	std::wstring toString();
 
+	/** Compares the field, both bounds and both inclusive flags */
+	bool equals(Filter* other) const;
+	size_t hashCode() const;
+
+	static const std::wstring getClassName();
+	const std::wstring getObjectName() const;
+
 protected:
 	RangeFilter( const RangeFilter& copy );
 };
@@ -0,0 +1,95 @@
+/*------------------------------------------------------------------------------
+* Copyright (C) 2003-2006 Ben van Klinken and the CLucene Team
+
+* Updated by https://github.com/farfella/.
+*
+* Distributable under the terms of either the Apache License (Version 2.0) or
+* the GNU Lesser General Public License, as specified in the COPYING file.
+------------------------------------------------------------------------------*/
+#include "CLucene/_ApiHeader.h"
+#include "RegexpQuery.h"
+#include "AutomatonTermEnum.h"
+#include "Similarity.h"
+#include "CLucene/index/Term.h"
+#include "CLucene/util/StringBuffer.h"
+#include "CLucene/util/_Automaton.h"
+
+CL_NS_USE(index)
+CL_NS_USE(util)
+CL_NS_DEF(search)
+
+
+RegexpQuery::RegexpQuery(Term* term) :
+    MultiTermQuery(term),
+    automaton(Automaton::fromRegexp(term->text()))
+{
+}
+
+RegexpQuery::RegexpQuery(const RegexpQuery& clone) :
+    MultiTermQuery(clone),
+    automaton(Automaton::fromRegexp(clone.getTerm(false)->text()))
+{
+}
+
+RegexpQuery::~RegexpQuery()
+{
+    _CLDELETE(automaton);
+}
+
+const std::wstring RegexpQuery::getObjectName() const
+{
+    return getClassName();
+}
+
+const std::wstring RegexpQuery::getClassName()
+{
+    return L"RegexpQuery";
+}
+
+FilteredTermEnum* RegexpQuery::getEnum(IndexReader* reader)
+{
+    return _CLNEW AutomatonTermEnum(reader, getTerm(false), automaton, false);
+}
+
+Query* RegexpQuery::clone() const
+{
+    return _CLNEW RegexpQuery(*this);
+}
+
+size_t RegexpQuery::hashCode() const
+{
+    return Similarity::floatToByte(getBoost()) ^ getTerm(false)->hashCode();
+}
+
+bool RegexpQuery::equals(Query* other) const
+{
+    if (!(other->instanceOf(RegexpQuery::getClassName())))
+        return false;
+
+    RegexpQuery* rq = (RegexpQuery*) other;
+    return (this->getBoost() == rq->getBoost())
+        && (this->getRewriteMethod() == rq->getRewriteMethod())
+        && getTerm(false)->equals(rq->getTerm(false));
+}
+
+std::wstring RegexpQuery::toString(const wchar_t* field) const
+{
+    Term* term = getTerm(false);
+    std::wstring buffer;
+    if (field == NULL || wcscmp(term->field(), field) != 0)
+    {
+        buffer.append(term->field());
+        buffer.append(L":");
+    }
+    buffer.push_back(L'/');
+    buffer.append(term->text());
+    buffer.push_back(L'/');
+    if (getBoost() != 1.0f)
+    {
+        buffer.push_back('^');
+        buffer.append(float_to_wstring(getBoost(), 1));
+    }
+    return buffer;
+}
+
+CL_NS_END
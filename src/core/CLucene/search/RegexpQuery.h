@@ -0,0 +1,52 @@
+/*------------------------------------------------------------------------------
+* Copyright (C) 2003-2006 Ben van Klinken and the CLucene Team
+
+* Updated by https://github.com/farfella/.
+*
+* Distributable under the terms of either the Apache License (Version 2.0) or
+* the GNU Lesser General Public License, as specified in the COPYING file.
+------------------------------------------------------------------------------*/
+#ifndef _lucene_search_RegexpQuery_
+#define _lucene_search_RegexpQuery_
+
+CL_CLASS_DEF(index,Term)
+CL_CLASS_DEF(util,Automaton)
+#include "MultiTermQuery.h"
+
+CL_NS_DEF(search)
+
+/** Implements a regular expression query. The text of the term is a regular
+  * expression that must match the whole of a term of the field:
+  * <code>a|b</code>, <code>(...)</code>, <code>*</code>, <code>+</code>,
+  * <code>?</code>, <code>{n}</code>, <code>{n,}</code>, <code>{n,m}</code>,
+  * <code>.</code>, character classes such as <code>[a-z]</code> and
+  * <code>[^0-9]</code>, and <code>\</code> escapes are supported.
+  *
+  * The expression is compiled to an automaton when the query is created,
+  * so a malformed expression throws CL_ERR_Parse from the constructor.
+  *
+  * @see AutomatonTermEnum
+  */
+class CLUCENE_EXPORT RegexpQuery: public MultiTermQuery {
+protected:
+  FilteredTermEnum* getEnum(CL_NS(index)::IndexReader* reader);
+  RegexpQuery(const RegexpQuery& clone);
+public:
+  RegexpQuery(CL_NS(index)::Term* term);
+  ~RegexpQuery();
+
+  const std::wstring getObjectName() const;
+  static const std::wstring getClassName();
+
+  size_t hashCode() const;
+  bool equals(Query* other) const;
+  Query* clone() const;
+
+  /** Prints a user-readable version of this query. */
+  std::wstring toString(const wchar_t* field) const;
+private:
+  CL_NS(util)::Automaton* automaton;
+};
+
+CL_NS_END
+#endif
@@ -9,6 +9,7 @@
 #include "CLucene/_ApiHeader.h"
 #include "Scorer.h"
 #include "SearchHeader.h"
+#include <limits>
 
 CL_NS_DEF(search)
 
@@ -36,6 +37,53 @@ bool Scorer::score( HitCollector* results, const int32_t maxDoc ) {
 	}
 	return true;
 }
+
+int32_t Scorer::scoreBlock(const int32_t max, int32_t* docs, float_t* scores, const int32_t size, bool& more){
+	int32_t n = 0;
+	more = true;
+	while (n < size && doc() < max) {
+		docs[n] = doc();
+		scores[n] = score();
+		n++;
+		if (!next()) {
+			more = false;
+			break;
+		}
+	}
+	return n;
+}
+
+bool Scorer::nextCandidate(){
+	return next();
+}
+
+bool Scorer::skipToCandidate(int32_t target){
+	return skipTo(target);
+}
+
+bool Scorer::matches(){
+	return true;
+}
+
+bool Scorer::scoresDocsOutOfOrder() const{
+	return false;
+}
+
+void Scorer::setMinCompetitiveScore(const float_t /*minScore*/){
+}
+
+float_t Scorer::maxScoreOutsideTier(){
+	return std::numeric_limits<float_t>::infinity();
+}
+
+int32_t Scorer::nextTierDoc(int32_t target){
+	return target;
+}
+
+int64_t Scorer::cost() const{
+	return LUCENE_INT32_MAX_SHOULDBE;
+}
+
 bool Scorer::sort(const Scorer* elem1, const Scorer* elem2){
 	return elem1->doc() < elem2->doc();
 }
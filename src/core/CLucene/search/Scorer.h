@@ -61,6 +61,19 @@ public:
 	*/
 	virtual bool score( HitCollector* results, const int32_t maxDoc );
 
+	/** Expert: Scores matching documents in bulk, for scorers that add up
+	* the hits of their sub-scorers a window of documents at a time.
+	* Copies the current document, and those after it that are less than
+	* <code>max</code>, to <code>docs</code> and their scores to
+	* <code>scores</code>, no more than <code>size</code> of them, and
+	* moves to the first document not copied. As with
+	* {@link #score(HitCollector*, int32_t)}, {@link #next()} must be called
+	* once first.
+	* @param more Set to false once the scorer has no more documents.
+	* @return The number of documents copied.
+	*/
+	virtual int32_t scoreBlock(const int32_t max, int32_t* docs, float_t* scores, const int32_t size, bool& more);
+
 	/**
 	* Advances to the document matching this Scorer with the lowest doc Id
 	* greater than the current value of {@link #doc()} (or to the matching
@@ -120,6 +133,81 @@ public:
 	*/
 	virtual bool skipTo(int32_t target) = 0;
 
+	/**
+	* Expert: the approximation phase of two-phase iteration. Advances to
+	* the next document that <i>may</i> match, skipping the costly part of
+	* matching such as reading term positions. A candidate must be
+	* confirmed by {@link #matches()} before {@link #score()} is called, so
+	* that a conjunction or a filter can reject it first.
+	*
+	* <p>
+	* The default implementation calls {@link #next()}, so that every
+	* candidate is a match.
+	* </p>
+	*
+	* @return true iff there is another candidate.
+	*/
+	virtual bool nextCandidate();
+
+	/**
+	* Expert: skips to the first candidate whose doc Id is greater than or
+	* equal to <code>target</code>. See {@link #nextCandidate()}.
+	* The default implementation calls {@link #skipTo(int)}.
+	*/
+	virtual bool skipToCandidate(int32_t target);
+
+	/**
+	* Expert: the confirmation phase of two-phase iteration. Returns true
+	* iff the candidate this scorer is positioned on is a match. Must be
+	* called at most once per candidate. The default implementation
+	* returns true.
+	*/
+	virtual bool matches();
+
+	/**
+	* Expert: true if {@link #score(HitCollector)} collects the documents
+	* out of order, in which case a collector compiled into the scoring
+	* loop is called through it rather than iterating with {@link #next()}.
+	* The default implementation returns false.
+	*/
+	virtual bool scoresDocsOutOfOrder() const;
+
+	/**
+	* Expert: called by the scoring loop when the collector no longer wants
+	* documents that score less than <code>minScore</code>, so that a scorer
+	* that can bound its scores may skip them. Only scores that are raised
+	* are passed. The default implementation does nothing.
+	*/
+	virtual void setMinCompetitiveScore(const float_t minScore);
+
+	/**
+	* Expert: a bound on the score of the documents outside the impact tiers
+	* of this scorer's terms (see IndexReader#getImpactTier), so that once
+	* the collector wants no document scoring less, only the documents of
+	* the tiers need to be scored. Implementations that can bound their
+	* scores skip the other documents after
+	* {@link #setMinCompetitiveScore(float_t)} is given a higher score.
+	* The default implementation returns infinity, as every document may
+	* score highest.
+	*/
+	virtual float_t maxScoreOutsideTier();
+
+	/**
+	* Expert: the first document at or after <code>target</code> that is in
+	* the impact tier of one of this scorer's terms, without moving the
+	* scorer, or LUCENE_INT32_MAX_SHOULDBE if there is none. The document
+	* need not match. The default implementation returns <code>target</code>.
+	*/
+	virtual int32_t nextTierDoc(int32_t target);
+
+	/**
+	* Expert: an estimate of the number of documents this scorer matches,
+	* which a conjunction uses to lead with its cheapest clause and let
+	* the others skip to it. The default implementation returns
+	* LUCENE_INT32_MAX_SHOULDBE, for an unknown cost.
+	*/
+	virtual int64_t cost() const;
+
 	/** Returns an explanation of the score for a document.
 	* <br>When this method is used, the {@link #next()}, {@link #skipTo(int)} and
 	* {@link #score(HitCollector)} methods should not be used.
@@ -27,6 +27,13 @@ CL_NS(document)::Document* Searchable::doc(const int32_t i)
     return ret;
 }
 
+void Searchable::docs(const int32_t* ids, const int32_t count, CL_NS(document)::Document** result,
+    const CL_NS(document)::FieldSelector* /*fieldSelector*/)
+{
+    for (int32_t i = 0; i < count; i++)
+        doc(ids[i], result[i]);
+}
+
 //static
 Query* Query::mergeBooleanQueries(CL_NS(util)::ArrayBase<Query*>* queries)
 {
@@ -206,6 +213,7 @@ TopDocs::~TopDocs()
 Searcher::Searcher()
 {
     similarity = Similarity::getDefault();
+    filterCache = NULL;
 }
 Searcher::~Searcher()
 {
@@ -246,6 +254,16 @@ Similarity* Searcher::getSimilarity()
     return this->similarity;
 }
 
+void Searcher::setFilterCache(FilterCache* cache)
+{
+    this->filterCache = cache;
+}
+
+FilterCache* Searcher::getFilterCache()
+{
+    return this->filterCache;
+}
+
 const char* Searcher::getClassName()
 {
     return "Searcher";
@@ -14,6 +14,7 @@
 CL_CLASS_DEF(index,Term)
 //#include "Filter.h"
 CL_CLASS_DEF(document,Document)
+CL_CLASS_DEF(document,FieldSelector)
 //#include "Sort.h"
 //#include "CLucene/util/VoidList.h"
 //#include "Explanation.h"
@@ -31,6 +32,7 @@ CL_NS_DEF(search)
 	class Similarity;
 	class TopFieldDocs;
 	class Sort;
+	class FilterCache;
 	
 
    /** The interface for search implementations.
@@ -93,6 +95,16 @@ CL_NS_DEF(search)
       virtual bool doc(int32_t i, CL_NS(document)::Document* d) = 0;
       _CL_DEPRECATED( doc(i, document) ) CL_NS(document)::Document* doc(const int32_t i);
 
+      /** Expert: Returns the stored fields of a batch of documents, such as
+      * a page of hits: <code>result[i]</code> receives the fields of
+      * <code>ids[i]</code>. Searchers over an index read the batch in
+      * document order; this default calls {@link #doc(int32_t, Document*)}
+      * for each document and loads all of its fields.
+      * @see IndexReader#documents
+      */
+      virtual void docs(const int32_t* ids, const int32_t count, CL_NS(document)::Document** result,
+        const CL_NS(document)::FieldSelector* fieldSelector = NULL);
+
       /** Expert: called to re-write queries into primitive queries. */
       virtual Query* rewrite(Query* query) = 0;
 
@@ -126,6 +138,7 @@ CL_NS_DEF(search)
 	private:
 		/** The Similarity implementation used by this searcher. */
 		Similarity* similarity;
+		FilterCache* filterCache;
     public:
 		Searcher();
 		virtual ~Searcher();
@@ -174,6 +187,18 @@ CL_NS_DEF(search)
 		*/
 		Similarity* getSimilarity();
 
+		/** Expert: Filter through <code>cache</code>, which keeps the results
+		* of the filters used often, for each segment. The cache is not owned
+		* by the searcher, and may be shared by several searchers. NULL, the
+		* default, computes the filters every time.
+		*
+		* @see FilterCache
+		*/
+		void setFilterCache(FilterCache* cache);
+
+		/** Expert: Return the FilterCache of this Searcher, or NULL */
+		FilterCache* getFilterCache();
+
 		virtual const char* getObjectName() const;
 		static const char* getClassName();
 
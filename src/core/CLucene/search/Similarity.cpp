@@ -161,6 +161,11 @@ CL_NS_DEF(search)
       return NORM_TABLE[b];
    }
 
+   const float_t* Similarity::getNormDecoder() {
+      decodeNorm(0);                                // fills the table
+      return NORM_TABLE;
+   }
+
    uint8_t Similarity::encodeNorm(float_t f) {
 #ifdef _CL_HAVE_NO_FLOAT_BYTE
 	   int32_t i=0;
@@ -93,6 +93,11 @@ public:
    * @see #encodeNorm(float_t)
    */
    static float_t decodeNorm(uint8_t b);
+
+   /** Returns the table that {@link #decodeNorm(uint8_t)} looks norms up in,
+   * for scorers that decode the norms of many documents at once.
+   */
+   static const float_t* getNormDecoder();
    
    static uint8_t floatToByte(float_t f);
    static float_t byteToFloat(uint8_t b);
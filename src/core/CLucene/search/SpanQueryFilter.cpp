@@ -82,4 +82,26 @@ std::wstring SpanQueryFilter::toString()
     return std::wstring(L"QueryWrapperFilter(") + query->toString() + std::wstring(L")");
 }
 
+bool SpanQueryFilter::equals( Filter* other ) const
+{
+    if( other->getObjectName() != getClassName() )
+        return false;
+    return query->equals( static_cast<SpanQueryFilter*>( other )->query );
+}
+
+size_t SpanQueryFilter::hashCode() const
+{
+    return query->hashCode() ^ 0x923F64B9;
+}
+
+const std::wstring SpanQueryFilter::getObjectName() const
+{
+    return getClassName();
+}
+
+const std::wstring SpanQueryFilter::getClassName()
+{
+    return L"SpanQueryFilter";
+}
+
 CL_NS_END
@@ -57,14 +57,11 @@ public:
 
     virtual std::wstring toString();
 
+    virtual bool equals( Filter* other ) const;
+    virtual size_t hashCode() const;
 
-//     public boolean equals( Object o ) {
-//         return o instanceof SpanQueryFilter && this.query.equals(((SpanQueryFilter) o).query);
-//     }
-// 
-//     public int hashCode() {
-//         return query.hashCode() ^ 0x923F64B9;
-//     }
+    static const std::wstring getClassName();
+    virtual const std::wstring getObjectName() const;
 };
 
 inline CL_NS2(search,spans)::SpanQuery * SpanQueryFilter::getQuery()
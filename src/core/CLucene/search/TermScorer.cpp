@@ -11,16 +11,18 @@
 #include "SearchHeader.h"
 #include "Explanation.h"
 #include "CLucene/index/Term.h"
+#include "CLucene/index/_ImpactTiers.h"
 #include "CLucene/index/Terms.h"
 #include "TermQuery.h"
 #include "Similarity.h"
 #include "Explanation.h"
+#include <limits>
 
 CL_NS_USE(index)
 CL_NS_DEF(search)
 
 TermScorer::TermScorer(Weight* w, CL_NS(index)::TermDocs* td,
-    Similarity* similarity, uint8_t* _norms) :
+    Similarity* similarity, uint8_t* _norms, const ImpactTier* _tier) :
     Scorer(similarity),
     termDocs(td),
     norms(_norms),
@@ -28,7 +30,12 @@ TermScorer::TermScorer(Weight* w, CL_NS(index)::TermDocs* td,
     weightValue(w->getValue()),
     _doc(0),
     pointer(0),
-    pointerMax(0)
+    pointerMax(0),
+    docFreq(-2),
+    tier(_tier),
+    tierPos(0),
+    maxOutside(-1.0f),
+    tierOnly(false)
 {
     memset(docs, 0, 32 * sizeof(int32_t));
     memset(freqs, 0, 32 * sizeof(int32_t));
@@ -43,6 +50,17 @@ TermScorer::~TermScorer()
 }
 bool TermScorer::next()
 {
+    if (tierOnly)
+    {
+        const int32_t target = tier->nextDoc(_doc + 1, tierPos);
+        if (target == LUCENE_INT32_MAX_SHOULDBE)
+        {
+            _doc = LUCENE_INT32_MAX_SHOULDBE;
+            return false;
+        }
+        return skipTo(target);
+    }
+
     pointer++;
     if (pointer >= pointerMax)
     {
@@ -64,15 +82,30 @@ bool TermScorer::next()
 
 bool TermScorer::skipTo(int32_t target)
 {
-    // first scan in cache
-    for (pointer++; pointer < pointerMax; pointer++)
+    // first search the cache: gallop to a document past target, then
+    // binary search the last step
+    int32_t lo = pointer + 1;
+    if (lo < pointerMax && docs[pointerMax - 1] >= target)
     {
-        if (docs[pointer] >= target)
+        int32_t hi = lo;
+        for (int32_t step = 1; docs[hi] < target; step <<= 1)
+        {
+            lo = hi + 1;
+            hi = hi + step < pointerMax ? hi + step : pointerMax - 1;
+        }
+        while (lo < hi)
         {
-            _doc = docs[pointer];
-            return true;
+            const int32_t mid = (lo + hi) >> 1;
+            if (docs[mid] < target)
+                lo = mid + 1;
+            else
+                hi = mid;
         }
+        pointer = lo;
+        _doc = docs[pointer];
+        return true;
     }
+    pointer = pointerMax;
 
     // not found in cache, seek underlying stream
     bool result = termDocs->skipTo(target);
@@ -90,6 +123,37 @@ bool TermScorer::skipTo(int32_t target)
     return result;
 }
 
+void TermScorer::setMinCompetitiveScore(const float_t minScore)
+{
+    if (!tierOnly && tier != NULL && maxScoreOutsideTier() < minScore)
+        tierOnly = true;
+}
+
+float_t TermScorer::maxScoreOutsideTier()
+{
+    if (tier == NULL || weightValue < 0.0f)
+        return std::numeric_limits<float_t>::infinity();
+    if (maxOutside < 0.0f)
+    {
+        // scored as score() scores, for the pairs that bound the other documents
+        maxOutside = 0.0f;
+        for (size_t i = 0; i < tier->freqs.size(); i++)
+        {
+            const int32_t f = tier->freqs[i];
+            const float_t raw = f < LUCENE_SCORE_CACHE_SIZE ? scoreCache[f] : getSimilarity()->tf(f) * weightValue;
+            const float_t bound = raw * Similarity::decodeNorm(tier->norms[i]);
+            if (bound > maxOutside)
+                maxOutside = bound;
+        }
+    }
+    return maxOutside;
+}
+
+int32_t TermScorer::nextTierDoc(int32_t target)
+{
+    return tier == NULL ? target : tier->nextDoc(target, tierPos);
+}
+
 Explanation* TermScorer::explain(int32_t doc)
 {
     TermQuery* query = (TermQuery*) weight->getQuery();
@@ -139,6 +203,53 @@ float_t TermScorer::score()
     return raw * Similarity::decodeNorm(norms[_doc]); // normalize for field
 }
 
+int64_t TermScorer::cost() const
+{
+    if (docFreq == -2)
+        docFreq = termDocs->docFreq();
+    return docFreq < 0 ? LUCENE_INT32_MAX_SHOULDBE : docFreq;
+}
+
+int32_t TermScorer::scoreBlock(const int32_t max, int32_t* blockDocs, float_t* blockScores, const int32_t size, bool& more)
+{
+    const float_t* normDecoder = Similarity::getNormDecoder();
+    int32_t n = 0;
+    more = true;
+    while (n < size)
+    {
+        // the buffered documents that fit
+        int32_t last = pointer;
+        const int32_t limit = pointerMax - pointer < size - n ? pointerMax : pointer + size - n;
+        while (last < limit && docs[last] < max)
+            last++;
+        for (int32_t i = pointer; i < last; i++)
+        {
+            const int32_t f = freqs[i];
+            const float_t raw = f < LUCENE_SCORE_CACHE_SIZE ? scoreCache[f] : getSimilarity()->tf(f) * weightValue;
+            blockDocs[n] = docs[i];
+            blockScores[n++] = raw * normDecoder[norms[docs[i]]];
+        }
+        pointer = last;
+        if (pointer < pointerMax)
+        {
+            _doc = docs[pointer];                   // stopped at max or size
+            break;
+        }
+
+        pointerMax = termDocs->read(docs, freqs, 32);    // refill buffer
+        pointer = 0;
+        if (pointerMax == 0)
+        {
+            termDocs->close();
+            _doc = LUCENE_INT32_MAX_SHOULDBE;
+            more = false;
+            break;
+        }
+        _doc = docs[0];
+    }
+    return n;
+}
+
 int32_t TermScorer::doc() const { return _doc; }
 
 CL_NS_END
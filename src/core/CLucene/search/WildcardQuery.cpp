@@ -9,17 +9,37 @@
 #include "CLucene/_ApiHeader.h"
 #include "WildcardQuery.h"
 #include "TermQuery.h"
+#include "AutomatonTermEnum.h"
 #include "WildcardTermEnum.h"
 #include "Similarity.h"
 #include "CLucene/index/Term.h"
 #include "CLucene/util/BitSet.h"
 #include "CLucene/util/StringBuffer.h"
+#include "CLucene/util/_Automaton.h"
 #include "CLucene/index/IndexReader.h"
 
 CL_NS_USE(index)
 CL_NS_USE(util)
 CL_NS_DEF(search)
 
+//Collects the runs of literal characters of a wildcard pattern. Every term
+//the pattern matches contains all of them, so they can be looked up in the
+//k-gram term index of the field
+static void getLiteralRuns(const wchar_t* pattern, std::vector<std::wstring>& runs)
+{
+    const wchar_t* start = pattern;
+    for (const wchar_t* p = pattern; ; p++)
+    {
+        if (*p == 0 || *p == LUCENE_WILDCARDTERMENUM_WILDCARD_STRING || *p == LUCENE_WILDCARDTERMENUM_WILDCARD_CHAR)
+        {
+            if (p > start)
+                runs.push_back(std::wstring(start, p - start));
+            if (*p == 0)
+                break;
+            start = p + 1;
+        }
+    }
+}
 
 WildcardQuery::WildcardQuery(Term* term) :
     MultiTermQuery(term)
@@ -52,9 +72,23 @@ const std::wstring WildcardQuery::getClassName()
 }
 
 
+//Enumerates the terms a wildcard term matches through its automaton, or,
+//if the pattern is too complex to compile, by testing each term after
+//its prefix in turn
+static FilteredTermEnum* newWildcardEnum(IndexReader* reader, Term* term)
+{
+    Automaton* automaton = Automaton::fromWildcard(term->text());
+    if (automaton == NULL)
+        return _CLNEW WildcardTermEnum(reader, term);
+
+    std::vector<std::wstring> runs;
+    getLiteralRuns(term->text(), runs);
+    return _CLNEW AutomatonTermEnum(reader, term, automaton, true, &runs);
+}
+
 FilteredTermEnum* WildcardQuery::getEnum(IndexReader* reader)
 {
-    return _CLNEW WildcardTermEnum(reader, getTerm(false));
+    return newWildcardEnum(reader, getTerm(false));
 }
 
 WildcardQuery::WildcardQuery(const WildcardQuery& clone) :
@@ -79,6 +113,7 @@ bool WildcardQuery::equals(Query* other) const
 
     WildcardQuery* tq = (WildcardQuery*) other;
     return (this->getBoost() == tq->getBoost())
+        && (this->getRewriteMethod() == tq->getRewriteMethod())
         && getTerm()->equals(tq->getTerm());
 }
 
@@ -133,32 +168,57 @@ std::wstring WildcardFilter::toString()
 }
 
 
+bool WildcardFilter::equals(Filter* other) const
+{
+    if (other->getObjectName() != getClassName())
+        return false;
+    return term->equals(static_cast<WildcardFilter*>(other)->term);
+}
+
+size_t WildcardFilter::hashCode() const
+{
+    return term->hashCode() ^ 0x2F58A3B1;
+}
+
+const std::wstring WildcardFilter::getObjectName() const
+{
+    return getClassName();
+}
+const std::wstring WildcardFilter::getClassName()
+{
+    return L"WildcardFilter";
+}
+
 /** Returns a BitSet with true for documents which should be permitted in
 search results, and false for those that should not. */
 BitSet* WildcardFilter::bits(IndexReader* reader)
 {
     BitSet* bts = _CLNEW BitSet(reader->maxDoc());
 
-    WildcardTermEnum termEnum(reader, term);
-    if (termEnum.term(false) == NULL)
+    FilteredTermEnum* termEnum = newWildcardEnum(reader, term);
+    if (termEnum->term(false) == NULL)
+    {
+        _CLDELETE(termEnum);
         return bts;
+    }
 
     TermDocs* termDocs = reader->termDocs();
     try
     {
         do
         {
-            termDocs->seek(&termEnum);
+            termDocs->seek(termEnum);
 
             while (termDocs->next())
             {
                 bts->set(termDocs->doc());
             }
-        } while (termEnum.next());
+        } while (termEnum->next());
     } _CLFINALLY(
         termDocs->close();
     _CLDELETE(termDocs);
-    termEnum.close();
+    termEnum->close();
+    _CLDELETE(termEnum);
     )
 
         return bts;
@@ -19,12 +19,12 @@ CL_NS_DEF(search)
 
 /** Implements the wildcard search query. Supported wildcards are <code>*</code>, which
   * matches any character sequence (including the empty one), and <code>?</code>,
-  * which matches any single character. Note this query can be slow, as it
-  * needs to iterate over all terms. In order to prevent extremely slow WildcardQueries,
-  * a Wildcard term must not start with one of the wildcards <code>*</code> or
-  * <code>?</code>.
+  * which matches any single character. The pattern is compiled to an automaton
+  * which is used to skip over the parts of the term dictionary that cannot
+  * match, but a pattern starting with <code>*</code> or <code>?</code> still
+  * has to visit many terms of the field and can be slow.
   *
-  * @see WildcardTermEnum
+  * @see AutomatonTermEnum
   */
 class CLUCENE_EXPORT WildcardQuery: public MultiTermQuery {
 protected:
@@ -65,6 +65,12 @@ public:
 	
 	Filter* clone() const;
 	std::wstring toString();
+
+	bool equals(Filter* other) const;
+	size_t hashCode() const;
+
+	static const std::wstring getClassName();
+	const std::wstring getObjectName() const;
 };
 
 
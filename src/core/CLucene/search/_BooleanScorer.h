@@ -14,20 +14,13 @@
 
 CL_NS_DEF(search)
 	
+	/** Scores a disjunction, with prohibited clauses, out of document order.
+	* The documents are taken a window of BucketTable_SIZE at a time: each
+	* sub-scorer adds the scores of its documents in the window to the
+	* bucket table (see Scorer#scoreBlock), and the documents that matched
+	* are then collected from it in the order of the table. */
 	class BooleanScorer: public Scorer {
 	private:
-			
-		class Bucket {
-		public:
-			int32_t	doc;				  // tells if bucket is valid
-			float_t	score;				  // incremental score
-			int32_t	bits;					  // used for bool constraints
-			int32_t	coord;					  // count of terms in score
-			Bucket*	next;				  // next valid bucket
-
-			Bucket();
-			virtual ~Bucket();
-		};
 
 		class SubScorer {
 		public:
@@ -35,34 +28,28 @@ CL_NS_DEF(search)
 			Scorer* scorer;
 			bool required;
 			bool prohibited;
-			HitCollector* collector;
+			int32_t mask;
 			SubScorer* next;
-			SubScorer(Scorer* scr, const bool r, const bool p, HitCollector* c, SubScorer* nxt);
+			SubScorer(Scorer* scr, const bool r, const bool p, const int32_t m, SubScorer* nxt);
 			virtual ~SubScorer();
 		};
 
+		/** The documents of one window, held as arrays indexed by the
+		* document's offset in the window, and a bit for each slot that a
+		* sub-scorer touched, so that only those are collected and reset. */
 		class BucketTable {
-		private:
-			BooleanScorer* scorer;
 		public:
-			Bucket* buckets;
-			Bucket* first;			  // head of valid list
+			float_t* scores;              // the sum of the scores
+			int32_t* coords;              // the number of clauses that matched
+			int32_t* bits;                // the masks of the clauses that matched
+			uint32_t* touched;            // the slots with hits, a bit each
+			int32_t* blockDocs;           // a block of a sub-scorer's documents
+			float_t* blockScores;         // and their scores
 
-			BucketTable(BooleanScorer* scr);
-			int32_t size() const;
-			HitCollector* newCollector(const int32_t mask);
-			void clear();
+			BucketTable();
 			virtual ~BucketTable();
-		};
-
-		class Collector: public HitCollector {
-		private:
-			BucketTable* bucketTable;
-			int32_t mask;
-		public:
-			Collector(const int32_t mask, BucketTable* bucketTable);
-			
-			void collect(const int32_t doc, const float_t score);
+			/** Adds a block of documents, of the window starting at <code>base</code> */
+			void add(const int32_t base, const int32_t n, const int32_t mask);
 		};
 
 		SubScorer* scorers;
@@ -71,13 +58,33 @@ CL_NS_DEF(search)
 		int32_t maxCoord;
 		int32_t nextMask;
 
-      	int32_t end;
-		Bucket* current;
-		
+		int32_t base;                     // the first document of the window
+		int32_t end;                      // the first document after it
+		int32_t word;                     // the word of touched slots next() is in
+		int32_t current;                  // the slot of the current document
+
 		int32_t minNrShouldMatch;
-		
+
+		/** The first document of the clauses that are not prohibited */
+		int32_t firstDoc() const;
+		/** Fills the bucket table with the next window of documents before
+		* <code>max</code>. Returns false if no sub-scorer has any left. */
+		bool nextWindow(const int32_t max);
+		/** True if the document in <code>slot</code> matches the query */
+		inline bool accepts(const int32_t slot) const{
+			return (bucketTable->bits[slot] & prohibitedMask) == 0 &&
+				(bucketTable->bits[slot] & requiredMask) == requiredMask &&
+				bucketTable->coords[slot] >= minNrShouldMatch;
+		}
+		/** Empties <code>slot</code> for the next window */
+		inline void reset(const int32_t slot){
+			bucketTable->scores[slot] = 0;
+			bucketTable->coords[slot] = 0;
+			bucketTable->bits[slot] = 0;
+		}
+
 	public:
-		LUCENE_STATIC_CONSTANT(int32_t,BucketTable_SIZE=1024);
+		LUCENE_STATIC_CONSTANT(int32_t,BucketTable_SIZE=2048);
 		int32_t requiredMask;
 		int32_t prohibitedMask;
 		float_t* coordFactors;
@@ -85,18 +92,19 @@ CL_NS_DEF(search)
     	BooleanScorer( Similarity* similarity, int32_t minNrShouldMatch = 1 );
 		virtual ~BooleanScorer();
 		void add(Scorer* scorer, const bool required, const bool prohibited);
-		int32_t doc() const { return current->doc; }
+		int32_t doc() const { return base + current; }
 		bool next();
 		float_t score();
 		void score( HitCollector* hc );
+		bool scoresDocsOutOfOrder() const { return true; }
 		bool skipTo(int32_t target);
 		Explanation* explain(int32_t doc);
 		virtual std::wstring toString();
 		void computeCoordFactors();
-		
+
 	protected:
 		bool score( HitCollector* hc, const int32_t max );
-		
+
 	};
 
 CL_NS_END
@@ -40,6 +40,14 @@ CL_NS_DEF(search)
 		bool next();
 		float_t score();
 		bool skipTo( int32_t target );
+		bool nextCandidate();
+		bool skipToCandidate( int32_t target );
+		bool matches();
+		int64_t cost() const;
+		bool scoresDocsOutOfOrder() const;
+		void setMinCompetitiveScore( const float_t minScore );
+		float_t maxScoreOutsideTier();
+		int32_t nextTierDoc( int32_t target );
 		Explanation* explain( int32_t doc );
 		virtual std::wstring toString();
 	};
@@ -13,7 +13,13 @@
 #include "CLucene/util/Array.h"
 CL_NS_DEF(search)
 
-/** Scorer for conjunctions, sets of queries, all of which are required. */
+/** Scorer for conjunctions, sets of queries, all of which are required.
+* The sub-scorers are ordered by their cost (see {@link Scorer#cost()}) and
+* the cheapest one leads: each of its candidates (see {@link Scorer#nextCandidate()})
+* is a target the others skip to, in order, and the first that overshoots it
+* sends the lead skipping ahead in turn. A document is only confirmed by
+* them once all of them agree on it.
+*/
 class ConjunctionScorer: public Scorer {
 private:
   CL_NS(util)::ArrayBase<Scorer*>* scorers;
@@ -23,7 +29,7 @@ private:
   float_t coord;
   int32_t lastDoc;
 
-  Scorer* last();
+  /** Aligns the sub-scorers on a candidate of the lead, scorers[0] */
   bool doNext();
 
   bool init(int32_t target);
@@ -35,6 +41,11 @@ public:
   int32_t doc() const;
   bool next();
   bool skipTo(int32_t target);
+  bool nextCandidate();
+  bool skipToCandidate(int32_t target);
+  bool matches();
+  /** The cost of the cheapest sub-scorer */
+  int64_t cost() const;
   virtual float_t score();
   virtual Explanation* explain(int32_t doc);
 };
@@ -42,6 +42,9 @@ private:
 	int32_t currentDoc;
 	float_t currentScore;
 
+	/** True once only the documents of the impact tiers of the subscorers are wanted */
+	bool tierOnly;
+
 	/** Called the first time next() or skipTo() is called to
 	* initialize <code>scorerDocQueue</code>.
 	*/
@@ -117,6 +120,9 @@ public:
 
 	int32_t doc() const;
 
+	/** The sum of the costs of the subscorers */
+	int64_t cost() const;
+
 	/** Returns the number of subscorers matching the current document.
 	* Initially invalid, until {@link #next()} is called the first time.
 	*/
@@ -131,6 +137,13 @@ public:
 	*/
 	bool skipTo( int32_t target );
 
+	/** Once no document scoring less than the sum of the bounds of the
+	* subscorers outside their impact tiers is wanted, only the documents in
+	* the tier of some subscorer are scored */
+	void setMinCompetitiveScore( const float_t minScore );
+	float_t maxScoreOutsideTier();
+	int32_t nextTierDoc( int32_t target );
+
 	virtual std::wstring toString();
 
 	/** @return An explanation for the score of a given document. */
@@ -24,6 +24,9 @@ class Explanation;
 * is invoked for each document containing all the phrase query terms, in order to 
 * compute the frequency of the phrase query in that document. A non zero frequency
 * means a match. 
+* <br>Iteration is two-phase: {@link #nextCandidate()} only aligns the terms' documents,
+* using their skip lists, and the positions are read by {@link #matches()} for the
+* candidates that are not rejected first by an enclosing conjunction or a filter.
 */
 class PhraseScorer: public Scorer {
 private:
@@ -34,6 +37,7 @@ protected:
 private:
 	bool firstTime;
 	bool more;
+	int64_t _cost; //the docFreq of the rarest term
 protected:
 	float_t freq; //phrase frequency in current doc as computed by phraseFreq().
 
@@ -52,6 +56,13 @@ public:
 	float_t score();
 	bool skipTo(int32_t target);
 
+	/** The number of documents the rarest term is in, which bounds the matches */
+	int64_t cost() const;
+
+	bool nextCandidate();
+	bool skipToCandidate(int32_t target);
+	bool matches();
+
 
 	Explanation* explain(int32_t doc);
 	virtual std::wstring toString();
@@ -0,0 +1,113 @@
+/*------------------------------------------------------------------------------
+* Copyright (C) 2003-2006 Ben van Klinken and the CLucene Team
+
+* Updated by https://github.com/farfella/.
+*
+* Distributable under the terms of either the Apache License (Version 2.0) or
+* the GNU Lesser General Public License, as specified in the COPYING file.
+------------------------------------------------------------------------------*/
+#ifndef _lucene_search_ScoreLoop_
+#define _lucene_search_ScoreLoop_
+
+#include "SearchHeader.h"
+#include "Scorer.h"
+#include "CLucene/util/BitSet.h"
+
+CL_NS_DEF(search)
+
+/**
+* The loops that pass the hits of a scorer to a collector whose type is
+* known at compile time, so that the collector is inlined into the loop
+* instead of being called through HitCollector::collect for every hit.
+*
+* <p>A collector used with these loops has the methods</p>
+* <pre>
+*   void setDocBase(const int32_t docBase);
+*   ScoreLoop::Status collect(const int32_t doc, const float_t score);
+*   float_t getMinCompetitiveScore() const;
+* </pre>
+* <p><code>setDocBase</code> is called before the hits of each segment,
+* whose documents are numbered from 0. <code>collect</code> tells the loop
+* whether to go on, whether the collector's threshold was raised, in which
+* case the scorer is given {@link #getMinCompetitiveScore}, or whether to
+* stop scoring the segment or altogether.</p>
+*/
+class ScoreLoop {
+public:
+	enum Status {
+		/** Go on with the next hit */
+		CONTINUE,
+		/** Go on, documents scoring less than getMinCompetitiveScore() are no longer wanted */
+		THRESHOLD_RAISED,
+		/** Stop scoring this segment, go on with the next one */
+		NEXT_SEGMENT,
+		/** Stop scoring */
+		TERMINATE
+	};
+
+	/** Passes the hits of a scorer that may be out of order to a collector,
+	* through HitCollector. Terminating is not supported there. */
+	template<class Collector>
+	class Adapter: public HitCollector {
+		Collector& collector;
+	public:
+		Adapter(Collector& _collector): collector(_collector){}
+		void collect(const int32_t doc, const float_t score){
+			collector.collect(doc, score);
+		}
+	};
+
+	/** Scores all the documents of <code>scorer</code> */
+	template<class Collector>
+	static Status score(Scorer* scorer, Collector& collector){
+		if (scorer->scoresDocsOutOfOrder()) {
+			Adapter<Collector> adapter(collector);
+			scorer->score(&adapter);
+			return CONTINUE;
+		}
+		while (scorer->next()) {
+			const Status status = collector.collect(scorer->doc(), scorer->score());
+			if (status != CONTINUE) {
+				if (status != THRESHOLD_RAISED)
+					return status;
+				scorer->setMinCompetitiveScore(collector.getMinCompetitiveScore());
+			}
+		}
+		return CONTINUE;
+	}
+
+	/** Scores the documents of <code>scorer</code> that are set in <code>bits</code>.
+	* The filter is checked on each candidate before it is confirmed by
+	* Scorer::matches(), and the scorer skips ahead to the filter's next document.
+	* <code>bits</code>, a BitSet or a DocIdSet, may be numbered for the whole
+	* index, the scorer's documents start at <code>docBase</code>. */
+	template<class Bits, class Collector>
+	static Status scoreFiltered(Scorer* scorer, const Bits* bits, const int32_t docBase, Collector& collector){
+		bool more = scorer->nextCandidate();
+		while (more) {
+			const int32_t doc = scorer->doc();
+			const int32_t next = bits->nextSetBit(docBase + doc);
+			if (next < 0)
+				break;                                  // no more docs in bits
+			const int32_t target = next - docBase;
+
+			if (target > doc) {
+				more = scorer->skipToCandidate(target);
+			} else {
+				if (scorer->matches()) {
+					const Status status = collector.collect(doc, scorer->score());
+					if (status != CONTINUE) {
+						if (status != THRESHOLD_RAISED)
+							return status;
+						scorer->setMinCompetitiveScore(collector.getMinCompetitiveScore());
+					}
+				}
+				more = scorer->nextCandidate();
+			}
+		}
+		return CONTINUE;
+	}
+};
+
+CL_NS_END
+#endif
@@ -13,6 +13,7 @@
 #include "Scorer.h"
 #include "CLucene/index/Terms.h"
 CL_CLASS_DEF(search,Similarity)
+CL_CLASS_DEF(index,ImpactTier)
 #include "SearchHeader.h"
 
 CL_NS_DEF(search)
@@ -31,6 +32,12 @@ private:
 	int32_t freqs[32];	  // buffered term freqs
 	int32_t pointer;
 	int32_t pointerMax;
+	mutable int32_t docFreq;  // looked up when the cost is first asked for
+
+	const CL_NS(index)::ImpactTier* tier;
+	int32_t tierPos;
+	float_t maxOutside;       // computed when first asked for, -1 until then
+	bool tierOnly;            // the documents outside the tier are no longer wanted
 
 	float_t scoreCache[LUCENE_SCORE_CACHE_SIZE];
 public:
@@ -40,10 +47,11 @@ public:
 	* @param td An iterator over the documents matching the <code>Term</code>.
 	* @param similarity The </code>Similarity</code> implementation to be used for score computations.
 	* @param norms The field norms of the document fields for the <code>Term</code>.
+	* @param tier The impact tier of the <code>Term</code>, or NULL.
 	*
 	* @memory TermScorer takes TermDocs and deletes it when TermScorer is cleaned up */
 	TermScorer(Weight* weight, CL_NS(index)::TermDocs* td, 
-		Similarity* similarity, uint8_t* _norms);
+		Similarity* similarity, uint8_t* _norms, const CL_NS(index)::ImpactTier* tier = NULL);
 
 	virtual ~TermScorer();
 
@@ -62,6 +70,13 @@ public:
 
 	float_t score();
 
+	/** The number of documents the term is in */
+	int64_t cost() const;
+
+	/** Scores the buffered documents in one pass, looking up each score in
+	* the cache of tf times weight and the table of decoded norms. */
+	int32_t scoreBlock(const int32_t max, int32_t* blockDocs, float_t* blockScores, const int32_t size, bool& more);
+
 	/** Skips to the first match beyond the current whose document number is
 	* greater than or equal to a given target. 
 	* <br>The implementation uses {@link TermDocs#skipTo(int)}.
@@ -70,6 +85,12 @@ public:
 	*/
 	bool skipTo(int32_t target);
 
+	/** Once no document scoring less than the most a document outside the
+	* impact tier of the term scores is wanted, only the tier is scored */
+	void setMinCompetitiveScore(const float_t minScore);
+	float_t maxScoreOutsideTier();
+	int32_t nextTierDoc(int32_t target);
+
 	/** Returns an explanation of the score for a document.
 	* <br>When this method is used, the {@link #next()} method
 	* and the {@link #score(HitCollector)} method should not be used.
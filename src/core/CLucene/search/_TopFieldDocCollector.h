@@ -0,0 +1,245 @@
+/*------------------------------------------------------------------------------
+* Copyright (C) 2003-2006 Ben van Klinken and the CLucene Team
+
+* Updated by https://github.com/farfella/.
+*
+* Distributable under the terms of either the Apache License (Version 2.0) or
+* the GNU Lesser General Public License, as specified in the COPYING file.
+------------------------------------------------------------------------------*/
+#ifndef _lucene_search_TopFieldDocCollector_
+#define _lucene_search_TopFieldDocCollector_
+
+#include "SearchHeader.h"
+#include "FieldDoc.h"
+#include "FieldSortedHitQueue.h"
+#include "_ScoreLoop.h"
+
+CL_NS_DEF(search)
+
+/**
+* Sort keys for TopFieldDocCollector. Each compares two hits by one sort
+* criterion: negative if <code>a</code> sorts before <code>b</code>,
+* positive if after, and 0 if they are equal on this key. The keys for the
+* common sorts read the FieldCache arrays directly, so that the collector
+* is compiled for the sort instead of calling a comparator per field.
+*/
+namespace SortKeys {
+
+	/** By the value of an int field */
+	class Int32 {
+		const int32_t* values;
+	public:
+		Int32(const int32_t* _values): values(_values){}
+		inline int32_t compare(const ScoreDoc& a, const ScoreDoc& b) const{
+			const int32_t va = values[a.doc];
+			const int32_t vb = values[b.doc];
+			return va < vb ? -1 : (va > vb ? 1 : 0);
+		}
+	};
+
+	/** By the value of a float field */
+	class Float {
+		const float_t* values;
+	public:
+		Float(const float_t* _values): values(_values){}
+		inline int32_t compare(const ScoreDoc& a, const ScoreDoc& b) const{
+			const float_t va = values[a.doc];
+			const float_t vb = values[b.doc];
+			return va < vb ? -1 : (va > vb ? 1 : 0);
+		}
+	};
+
+	/** By the ordinal of a string field's term, which orders as the terms do */
+	class Ordinal {
+		const int32_t* order;
+	public:
+		Ordinal(const int32_t* _order): order(_order){}
+		inline int32_t compare(const ScoreDoc& a, const ScoreDoc& b) const{
+			const int32_t oa = order[a.doc];
+			const int32_t ob = order[b.doc];
+			return oa < ob ? -1 : (oa > ob ? 1 : 0);
+		}
+	};
+
+	/** By relevance, highest score first */
+	class Score {
+	public:
+		inline int32_t compare(const ScoreDoc& a, const ScoreDoc& b) const{
+			return a.score > b.score ? -1 : (a.score < b.score ? 1 : 0);
+		}
+	};
+
+	/** By document number */
+	class Doc {
+	public:
+		inline int32_t compare(const ScoreDoc& a, const ScoreDoc& b) const{
+			return a.doc < b.doc ? -1 : (a.doc > b.doc ? 1 : 0);
+		}
+	};
+
+	/** Key in reverse order */
+	template<class Key>
+	class Reverse {
+		Key key;
+	public:
+		Reverse(const Key& _key): key(_key){}
+		inline int32_t compare(const ScoreDoc& a, const ScoreDoc& b) const{
+			return key.compare(b, a);
+		}
+	};
+
+	/** By First, and by Second where First is equal */
+	template<class First, class Second>
+	class Pair {
+		First first;
+		Second second;
+	public:
+		Pair(const First& _first, const Second& _second): first(_first), second(_second){}
+		inline int32_t compare(const ScoreDoc& a, const ScoreDoc& b) const{
+			const int32_t c = first.compare(a, b);
+			return c != 0 ? c : second.compare(a, b);
+		}
+	};
+
+	/** By all the sort fields of a FieldSortedHitQueue, through its comparators */
+	class Queue {
+		const FieldSortedHitQueue* queue;
+	public:
+		Queue(const FieldSortedHitQueue* _queue): queue(_queue){}
+		inline int32_t compare(const ScoreDoc& a, const ScoreDoc& b) const{
+			return queue->compare(a, b);
+		}
+	};
+}
+
+/**
+* Collects the top hits of a sorted search, ordered by the sort key
+* <code>Key</code> and then by document number, as FieldSortedHitQueue
+* orders them, for ScoreLoop.
+*
+* <p>A hit is compared with the least competitive hit kept before anything
+* is allocated, and most hits of a large result go no further. The
+* collector allocates at most one FieldDoc per hit it keeps: once it holds
+* <code>size</code> hits, a competitive hit overwrites the FieldDoc of the
+* hit it displaces.</p>
+*/
+template<class Key>
+class TopFieldDocCollector {
+private:
+	Key key;
+	FieldDoc** heap;          // heap[1] is the least competitive hit kept
+	int32_t _size;
+	int32_t maxSize;
+	int32_t docBase;
+	int32_t totalHits;
+	float_t maxScore;
+
+	/** True if <code>a</code> sorts after <code>b</code> */
+	inline bool lessThan(const ScoreDoc& a, const ScoreDoc& b) const{
+		const int32_t c = key.compare(a, b);
+		if (c == 0)
+			return a.doc > b.doc;    // avoid random sort order that could lead to duplicates
+		return c > 0;
+	}
+
+	void upHeap(){
+		int32_t i = _size;
+		FieldDoc* node = heap[i];
+		int32_t j = i >> 1;
+		while (j > 0 && lessThan(node->scoreDoc, heap[j]->scoreDoc)) {
+			heap[i] = heap[j];
+			i = j;
+			j = j >> 1;
+		}
+		heap[i] = node;
+	}
+
+	void downHeap(){
+		int32_t i = 1;
+		FieldDoc* node = heap[i];
+		int32_t j = i << 1;
+		int32_t k = j + 1;
+		if (k <= _size && lessThan(heap[k]->scoreDoc, heap[j]->scoreDoc))
+			j = k;
+		while (j <= _size && lessThan(heap[j]->scoreDoc, node->scoreDoc)) {
+			heap[i] = heap[j];
+			i = j;
+			j = i << 1;
+			k = j + 1;
+			if (k <= _size && lessThan(heap[k]->scoreDoc, heap[j]->scoreDoc))
+				j = k;
+		}
+		heap[i] = node;
+	}
+
+public:
+	TopFieldDocCollector(const Key& _key, const int32_t size):
+		key(_key),
+		_size(0),
+		maxSize(size),
+		docBase(0),
+		totalHits(0),
+		maxScore(0.0f)
+	{
+		heap = _CL_NEWARRAY(FieldDoc*, maxSize + 1);
+	}
+
+	~TopFieldDocCollector(){
+		for (int32_t i = 1; i <= _size; i++)
+			_CLDELETE(heap[i]);
+		_CLDELETE_ARRAY(heap);
+	}
+
+	void setDocBase(const int32_t _docBase){
+		docBase = _docBase;
+	}
+
+	inline ScoreLoop::Status collect(const int32_t doc, const float_t score){
+		if (score <= 0.0f)
+			return ScoreLoop::CONTINUE;              // ignore zeroed buckets
+		++totalHits;
+		if (score > maxScore)
+			maxScore = score;
+
+		if (_size < maxSize) {
+			heap[++_size] = _CLNEW FieldDoc(docBase + doc, score);
+			upHeap();
+			return ScoreLoop::CONTINUE;
+		}
+		if (maxSize == 0)
+			return ScoreLoop::CONTINUE;
+
+		const ScoreDoc hit = { docBase + doc, score };
+		FieldDoc* bottom = heap[1];
+		if (!lessThan(bottom->scoreDoc, hit))
+			return ScoreLoop::CONTINUE;              // not competitive
+		bottom->scoreDoc = hit;                      // reuse the FieldDoc of the hit it displaces
+		downHeap();
+		return ScoreLoop::CONTINUE;
+	}
+
+	/** Every score is wanted: the hits are not ranked by score alone */
+	float_t getMinCompetitiveScore() const{ return 0.0f; }
+
+	/** The number of hits collected, whether they were kept or not */
+	int32_t getTotalHits() const{ return totalHits; }
+
+	/** The highest score of the hits collected */
+	float_t getMaxScore() const{ return maxScore; }
+
+	/** The number of hits kept */
+	int32_t size() const{ return _size; }
+
+	/** Removes and returns the least competitive hit kept, which the caller then owns */
+	FieldDoc* pop(){
+		FieldDoc* result = heap[1];
+		heap[1] = heap[_size];
+		heap[_size--] = NULL;
+		if (_size > 0)
+			downHeap();
+		return result;
+	}
+};
+
+CL_NS_END
+#endif
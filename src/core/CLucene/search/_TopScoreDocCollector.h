@@ -0,0 +1,142 @@
+/*------------------------------------------------------------------------------
+* Copyright (C) 2003-2006 Ben van Klinken and the CLucene Team
+
+* Updated by https://github.com/farfella/.
+*
+* Distributable under the terms of either the Apache License (Version 2.0) or
+* the GNU Lesser General Public License, as specified in the COPYING file.
+------------------------------------------------------------------------------*/
+#ifndef _lucene_search_TopScoreDocCollector_
+#define _lucene_search_TopScoreDocCollector_
+
+#include "SearchHeader.h"
+#include "_ScoreLoop.h"
+#include <limits>
+
+CL_NS_DEF(search)
+
+/**
+* Collects the top hits by relevance, highest score first and then by
+* document number, as HitQueue orders them, for ScoreLoop.
+*
+* <p>The heap is filled with sentinels that sort after any hit before
+* the first hit is collected, so that a hit is only ever compared with the
+* least competitive hit kept: there is no check of how many hits are kept,
+* and a hit that does not beat it costs one comparison. Whenever the score
+* of the least competitive hit goes up, the scorer is told that documents
+* scoring less are no longer wanted, unless the collector was made to count
+* every hit.</p>
+*/
+class TopScoreDocCollector {
+private:
+	ScoreDoc* heap;            // heap[1] is the least competitive hit kept
+	int32_t _size;             // every entry is a hit or a sentinel
+	int32_t docBase;
+	int32_t totalHits;
+	bool raiseThresholds;
+
+	/** True if <code>a</code> sorts after <code>b</code> */
+	static inline bool lessThan(const ScoreDoc& a, const ScoreDoc& b){
+		if (a.score == b.score)
+			return a.doc > b.doc;
+		return a.score < b.score;
+	}
+
+	void downHeap(){
+		int32_t i = 1;
+		const ScoreDoc node = heap[i];
+		int32_t j = i << 1;
+		int32_t k = j + 1;
+		if (k <= _size && lessThan(heap[k], heap[j]))
+			j = k;
+		while (j <= _size && lessThan(heap[j], node)) {
+			heap[i] = heap[j];
+			i = j;
+			j = i << 1;
+			k = j + 1;
+			if (k <= _size && lessThan(heap[k], heap[j]))
+				j = k;
+		}
+		heap[i] = node;
+	}
+
+	/** Removes the least competitive entry */
+	ScoreDoc pop(){
+		const ScoreDoc result = heap[1];
+		heap[1] = heap[_size--];
+		downHeap();
+		return result;
+	}
+
+public:
+	/** If <code>raiseThresholds</code> is false, #collect never returns
+	* THRESHOLD_RAISED, so that no scorer skips a hit and #getTotalHits
+	* counts them all. */
+	TopScoreDocCollector(const int32_t size, const bool _raiseThresholds = true):
+		_size(size < 0 ? 0 : size),
+		docBase(0),
+		totalHits(0),
+		raiseThresholds(_raiseThresholds)
+	{
+		heap = _CL_NEWARRAY(ScoreDoc, _size == 0 ? 2 : _size + 1);
+		for (int32_t i = 1; i <= _size; i++) {
+			heap[i].doc = std::numeric_limits<int32_t>::max(); // sorts after every hit, which scores above 0
+			heap[i].score = 0.0f;
+		}
+		if (_size == 0) {
+			heap[1].doc = -1;                         // sorts before every hit, so nothing is kept
+			heap[1].score = std::numeric_limits<float_t>::infinity();
+		}
+	}
+
+	~TopScoreDocCollector(){
+		_CLDELETE_ARRAY(heap);
+	}
+
+	void setDocBase(const int32_t _docBase){
+		docBase = _docBase;
+	}
+
+	inline ScoreLoop::Status collect(const int32_t doc, const float_t score){
+		if (score <= 0.0f)
+			return ScoreLoop::CONTINUE;                  // ignore zeroed buckets
+		++totalHits;
+
+		const ScoreDoc hit = { docBase + doc, score };
+		const float_t minScore = heap[1].score;
+		if (!lessThan(heap[1], hit))
+			return ScoreLoop::CONTINUE;                  // not competitive
+		heap[1] = hit;
+		downHeap();
+		return raiseThresholds && heap[1].score > minScore ? ScoreLoop::THRESHOLD_RAISED : ScoreLoop::CONTINUE;
+	}
+
+	/** The score of the least competitive hit kept, 0 until as many hits as were asked for are */
+	float_t getMinCompetitiveScore() const{
+		return heap[1].score;
+	}
+
+	/** The number of hits collected, whether they were kept or not */
+	int32_t getTotalHits() const{
+		return totalHits;
+	}
+
+	/**
+	* Returns the hits kept, best first, in an array of
+	* <code>length</code> ScoreDocs that the caller owns. Empties the
+	* collector.
+	*/
+	ScoreDoc* topDocs(int32_t& length){
+		length = totalHits < _size ? totalHits : _size;
+		while (_size > length)                         // the sentinels sort first
+			pop();
+
+		ScoreDoc* scoreDocs = new ScoreDoc[length];
+		for (int32_t i = length - 1; i >= 0; --i)       // put docs in array
+			scoreDocs[i] = pop();
+		return scoreDocs;
+	}
+};
+
+CL_NS_END
+#endif
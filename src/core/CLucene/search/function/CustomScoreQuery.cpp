@@ -0,0 +1,260 @@
+/*------------------------------------------------------------------------------
+* Copyright (C) 2003-2006 Ben van Klinken and the CLucene Team
+
+* Updated by https://github.com/farfella/.
+*
+* Distributable under the terms of either the Apache License (Version 2.0) or
+* the GNU Lesser General Public License, as specified in the COPYING file.
+------------------------------------------------------------------------------*/
+#include "CLucene/_ApiHeader.h"
+#include "CustomScoreQuery.h"
+#include "CLucene/search/Scorer.h"
+#include "CLucene/search/SearchHeader.h"
+#include "CLucene/search/Searchable.h"
+#include "CLucene/search/Similarity.h"
+#include "CLucene/search/Explanation.h"
+#include "CLucene/index/IndexReader.h"
+#include "CLucene/util/StringBuffer.h"
+
+CL_NS_USE(index)
+CL_NS_USE(search)
+CL_NS_DEF2(search,function)
+
+class CustomScoreQuery::CustomWeight: public Weight {
+private:
+	Similarity* similarity;
+	Weight* subWeight;
+	CustomScoreQuery* parentQuery;
+public:
+	CustomWeight(CustomScoreQuery* enclosingInstance, Searcher* searcher);
+	virtual ~CustomWeight();
+
+	std::wstring toString();
+	Query* getQuery();
+	float_t getValue();
+	float_t sumOfSquaredWeights();
+	void normalize(float_t norm);
+	Scorer* scorer(IndexReader* reader);
+	Explanation* explain(IndexReader* reader, int32_t doc);
+};
+
+/** Iterates as the scorer of the subquery does, rescoring its matches */
+class CustomScoreQuery::CustomScorer: public Scorer {
+private:
+	const CustomScoreQuery* query;
+	Scorer* subScorer;
+	DocValues* values;
+public:
+	CustomScorer(Similarity* similarity, const CustomScoreQuery* _query, Scorer* _subScorer, DocValues* _values);
+	virtual ~CustomScorer();
+
+	bool next();
+	int32_t doc() const;
+	float_t score();
+	bool skipTo(int32_t target);
+	bool nextCandidate();
+	bool skipToCandidate(int32_t target);
+	bool matches();
+	Explanation* explain(int32_t doc);
+	std::wstring toString();
+};
+
+CustomScoreQuery::CustomScorer::CustomScorer(Similarity* similarity, const CustomScoreQuery* _query,
+	Scorer* _subScorer, DocValues* _values):
+	Scorer(similarity),
+	query(_query),
+	subScorer(_subScorer),
+	values(_values)
+{
+}
+
+CustomScoreQuery::CustomScorer::~CustomScorer(){
+	_CLDELETE(subScorer);
+	_CLDELETE(values);
+}
+
+bool CustomScoreQuery::CustomScorer::next(){
+	return subScorer->next();
+}
+
+int32_t CustomScoreQuery::CustomScorer::doc() const{
+	return subScorer->doc();
+}
+
+float_t CustomScoreQuery::CustomScorer::score(){
+	const int32_t doc = subScorer->doc();
+	return query->customScore(doc, subScorer->score(), values->floatVal(doc));
+}
+
+bool CustomScoreQuery::CustomScorer::skipTo(int32_t target){
+	return subScorer->skipTo(target);
+}
+
+bool CustomScoreQuery::CustomScorer::nextCandidate(){
+	return subScorer->nextCandidate();
+}
+
+bool CustomScoreQuery::CustomScorer::skipToCandidate(int32_t target){
+	return subScorer->skipToCandidate(target);
+}
+
+bool CustomScoreQuery::CustomScorer::matches(){
+	return subScorer->matches();
+}
+
+Explanation* CustomScoreQuery::CustomScorer::explain(int32_t /*doc*/){
+	// not called... see CustomWeight::explain()
+	return NULL;
+}
+
+std::wstring CustomScoreQuery::CustomScorer::toString(){
+	std::wstring buf = L"CustomScorer(";
+	buf.append(subScorer->toString());
+	buf.push_back(L')');
+	return buf;
+}
+
+CustomScoreQuery::CustomWeight::CustomWeight(CustomScoreQuery* enclosingInstance, Searcher* searcher):
+	parentQuery(enclosingInstance)
+{
+	similarity = parentQuery->getSimilarity(searcher);
+	subWeight = parentQuery->subQuery->_createWeight(searcher);
+}
+
+CustomScoreQuery::CustomWeight::~CustomWeight(){
+	_CLDELETE(subWeight);
+}
+
+std::wstring CustomScoreQuery::CustomWeight::toString(){
+	std::wstring buf = L"weight(";
+	buf.append(parentQuery->toString());
+	buf.push_back(L')');
+	return buf;
+}
+
+Query* CustomScoreQuery::CustomWeight::getQuery(){
+	return parentQuery;
+}
+
+float_t CustomScoreQuery::CustomWeight::getValue(){
+	return parentQuery->getBoost();
+}
+
+float_t CustomScoreQuery::CustomWeight::sumOfSquaredWeights(){
+	const float_t boost = parentQuery->getBoost();
+	return subWeight->sumOfSquaredWeights() * boost * boost;
+}
+
+void CustomScoreQuery::CustomWeight::normalize(float_t norm){
+	subWeight->normalize(norm * parentQuery->getBoost());
+}
+
+Scorer* CustomScoreQuery::CustomWeight::scorer(IndexReader* reader){
+	Scorer* subScorer = subWeight->scorer(reader);
+	if (subScorer == NULL)
+		return NULL;
+	return _CLNEW CustomScorer(similarity, parentQuery, subScorer, parentQuery->source->getValues(reader));
+}
+
+Explanation* CustomScoreQuery::CustomWeight::explain(IndexReader* reader, int32_t doc){
+	Explanation* subQueryExpl = subWeight->explain(reader, doc);
+	if (!subQueryExpl->isMatch())
+		return subQueryExpl;
+
+	DocValues* values = parentQuery->source->getValues(reader);
+	Explanation* valueExpl = values->explain(doc);
+	_CLDELETE(values);
+	return parentQuery->customExplain(doc, subQueryExpl, valueExpl);
+}
+
+CustomScoreQuery::CustomScoreQuery(Query* _subQuery, ValueSource* _source):
+	subQuery(_subQuery),
+	source(_source)
+{
+}
+
+CustomScoreQuery::CustomScoreQuery(const CustomScoreQuery& clone):
+	Query(clone),
+	subQuery(clone.subQuery->clone()),
+	source(clone.source->clone())
+{
+}
+
+CustomScoreQuery::~CustomScoreQuery(){
+	_CLDELETE(subQuery);
+	_CLDELETE(source);
+}
+
+Query* CustomScoreQuery::getSubQuery() const{
+	return subQuery;
+}
+
+ValueSource* CustomScoreQuery::getValueSource() const{
+	return source;
+}
+
+float_t CustomScoreQuery::customScore(const int32_t /*doc*/, const float_t subQueryScore, const float_t value) const{
+	return subQueryScore * value;
+}
+
+Explanation* CustomScoreQuery::customExplain(const int32_t doc, Explanation* subQueryExpl, Explanation* valueExpl) const{
+	const float_t score = customScore(doc, subQueryExpl->getValue(), valueExpl->getValue());
+	std::wstring description = toString();
+	description.append(L", product of:");
+	ComplexExplanation* result = _CLNEW ComplexExplanation(score > 0.0f, score, description.c_str());
+	result->addDetail(subQueryExpl);
+	result->addDetail(valueExpl);
+	return result;
+}
+
+Weight* CustomScoreQuery::_createWeight(Searcher* searcher){
+	return _CLNEW CustomWeight(this, searcher);
+}
+
+Query* CustomScoreQuery::rewrite(IndexReader* reader){
+	Query* query = subQuery->rewrite(reader);
+	if (query == subQuery)
+		return this;
+	CustomScoreQuery* clone = static_cast<CustomScoreQuery*>(this->clone());  // subquery rewrote: must clone
+	_CLDELETE(clone->subQuery);
+	clone->subQuery = query;
+	return clone;
+}
+
+void CustomScoreQuery::extractTerms(TermSet* termset) const{
+	subQuery->extractTerms(termset);
+}
+
+std::wstring CustomScoreQuery::toString(const wchar_t* field) const{
+	std::wstring buffer = L"custom(";
+	buffer.append(subQuery->toString(field));
+	buffer.append(L", ");
+	buffer.append(source->description());
+	buffer.push_back(L')');
+	buffer.append(boost_to_wstring(getBoost()));
+	return buffer;
+}
+
+Query* CustomScoreQuery::clone() const{
+	return _CLNEW CustomScoreQuery(*this);
+}
+
+bool CustomScoreQuery::equals(Query* o) const{
+	if (!o->instanceOf(getObjectName()))
+		return false;
+	CustomScoreQuery* other = static_cast<CustomScoreQuery*>(o);
+	return getBoost() == other->getBoost() && subQuery->equals(other->subQuery) && source->equals(other->source);
+}
+
+size_t CustomScoreQuery::hashCode() const{
+	return subQuery->hashCode() ^ (source->hashCode() << 1) ^ Similarity::floatToByte(getBoost());
+}
+
+const std::wstring CustomScoreQuery::getClassName(){
+	return L"CustomScoreQuery";
+}
+const std::wstring CustomScoreQuery::getObjectName() const{
+	return getClassName();
+}
+
+CL_NS_END2
@@ -0,0 +1,86 @@
+/*------------------------------------------------------------------------------
+* Copyright (C) 2003-2006 Ben van Klinken and the CLucene Team
+
+* Updated by https://github.com/farfella/.
+*
+* Distributable under the terms of either the Apache License (Version 2.0) or
+* the GNU Lesser General Public License, as specified in the COPYING file.
+------------------------------------------------------------------------------*/
+#ifndef _lucene_search_function_CustomScoreQuery_
+#define _lucene_search_function_CustomScoreQuery_
+
+#include "CLucene/search/Query.h"
+#include "ValueSource.h"
+
+CL_CLASS_DEF(search,Weight)
+CL_CLASS_DEF(search,Searcher)
+CL_CLASS_DEF(search,Explanation)
+
+CL_NS_DEF2(search,function)
+
+/**
+* A query that matches the documents another query matches, and scores
+* each by combining the score of that query with the value of a
+* ValueSource: by default their product, so that for example a
+* RecencyFieldSource favours the newer of the documents a text query
+* finds. Subclasses change the combination by overriding customScore()
+* and customExplain().
+*
+* <p>Subclasses must also override clone(), which rewrite() uses when the
+* subquery rewrites, and getObjectName(), which equals() compares, so that
+* a rewritten query keeps its customScore() and a QueryResultCache does
+* not mistake it for a query of another class.</p>
+*
+* <p>The subquery is scored as it would be on its own, through its own
+* Weight and Scorer, with the boost of this query folded into its
+* normalization. The values are taken per segment, as the subquery is
+* scored. Documents whose combined score is not above 0 are not hits.</p>
+*/
+class CLUCENE_EXPORT CustomScoreQuery: public CL_NS(search)::Query {
+private:
+	CL_NS(search)::Query* subQuery;
+	ValueSource* source;
+protected:
+	CustomScoreQuery(const CustomScoreQuery& clone);
+public:
+	/** Takes ownership of <code>subQuery</code> and <code>source</code> */
+	CustomScoreQuery(CL_NS(search)::Query* subQuery, ValueSource* source);
+	virtual ~CustomScoreQuery();
+
+	class CustomWeight;
+	class CustomScorer;
+
+	CL_NS(search)::Query* getSubQuery() const;
+	ValueSource* getValueSource() const;
+
+	/**
+	* Combines the score of the subquery with the value of the source for
+	* a document. Returns <code>subQueryScore * value</code>.
+	*/
+	virtual float_t customScore(const int32_t doc, const float_t subQueryScore, const float_t value) const;
+
+	/**
+	* Explains customScore() for a document that the subquery matches.
+	* Takes ownership of <code>subQueryExpl</code> and <code>valueExpl</code>,
+	* which the default implementation adds as the details of a product.
+	*/
+	virtual CL_NS(search)::Explanation* customExplain(const int32_t doc,
+		CL_NS(search)::Explanation* subQueryExpl, CL_NS(search)::Explanation* valueExpl) const;
+
+	CL_NS(search)::Query* rewrite(CL_NS(index)::IndexReader* reader);
+	void extractTerms(CL_NS(search)::TermSet* termset) const;
+
+	std::wstring toString(const wchar_t* field = NULL) const;
+	CL_NS(search)::Query* clone() const;
+
+	bool equals(CL_NS(search)::Query* o) const;
+	size_t hashCode() const;
+
+	static const std::wstring getClassName();
+	const std::wstring getObjectName() const;
+
+	CL_NS(search)::Weight* _createWeight(CL_NS(search)::Searcher* searcher);
+};
+
+CL_NS_END2
+#endif
@@ -0,0 +1,254 @@
+/*------------------------------------------------------------------------------
+* Copyright (C) 2003-2006 Ben van Klinken and the CLucene Team
+
+* Updated by https://github.com/farfella/.
+*
+* Distributable under the terms of either the Apache License (Version 2.0) or
+* the GNU Lesser General Public License, as specified in the COPYING file.
+------------------------------------------------------------------------------*/
+#include "CLucene/_ApiHeader.h"
+#include "FieldCacheSource.h"
+#include "CLucene/index/IndexReader.h"
+#include "CLucene/search/FieldCache.h"
+#include "CLucene/search/Similarity.h"
+#include "CLucene/document/DateTools.h"
+#include "CLucene/util/Misc.h"
+#include <vector>
+
+CL_NS_USE(index)
+CL_NS_USE(util)
+CL_NS_USE(document)
+CL_NS_DEF2(search,function)
+
+FieldCacheSource::FieldCacheSource(const wchar_t* _field):
+	field(_field)
+{
+}
+FieldCacheSource::~FieldCacheSource(){
+}
+
+const wchar_t* FieldCacheSource::getField() const{
+	return field.c_str();
+}
+
+bool FieldCacheSource::equals(const ValueSource* other) const{
+	if (other->getObjectName() != getObjectName())
+		return false;
+	return field == static_cast<const FieldCacheSource*>(other)->field;
+}
+
+size_t FieldCacheSource::hashCode() const{
+	return Misc::thashCode(field.c_str()) ^ Misc::thashCode(getObjectName().c_str());
+}
+
+
+class IntDocValues: public DocValues {
+	const int32_t* values;
+	const wchar_t* field;
+public:
+	IntDocValues(const int32_t* _values, const wchar_t* _field): values(_values), field(_field){}
+	float_t floatVal(const int32_t doc){
+		return static_cast<float_t>(values[doc]);
+	}
+	std::wstring toString(const int32_t doc){
+		return std::wstring(L"int(") + field + L")=" + Misc::toString(values[doc]);
+	}
+};
+
+IntFieldSource::IntFieldSource(const wchar_t* field):
+	FieldCacheSource(field)
+{
+}
+IntFieldSource::~IntFieldSource(){
+}
+
+DocValues* IntFieldSource::getValues(IndexReader* reader){
+	return _CLNEW IntDocValues(FieldCache::DEFAULT()->getInts(reader, field.c_str())->intArray, field.c_str());
+}
+
+std::wstring IntFieldSource::description() const{
+	return std::wstring(L"int(") + field + L")";
+}
+
+ValueSource* IntFieldSource::clone() const{
+	return _CLNEW IntFieldSource(field.c_str());
+}
+
+const std::wstring IntFieldSource::getClassName(){
+	return L"IntFieldSource";
+}
+const std::wstring IntFieldSource::getObjectName() const{
+	return getClassName();
+}
+
+
+class FloatDocValues: public DocValues {
+	const float_t* values;
+	const wchar_t* field;
+public:
+	FloatDocValues(const float_t* _values, const wchar_t* _field): values(_values), field(_field){}
+	float_t floatVal(const int32_t doc){
+		return values[doc];
+	}
+	std::wstring toString(const int32_t doc){
+		return std::wstring(L"float(") + field + L")=" + Misc::toString(values[doc]);
+	}
+};
+
+FloatFieldSource::FloatFieldSource(const wchar_t* field):
+	FieldCacheSource(field)
+{
+}
+FloatFieldSource::~FloatFieldSource(){
+}
+
+DocValues* FloatFieldSource::getValues(IndexReader* reader){
+	return _CLNEW FloatDocValues(FieldCache::DEFAULT()->getFloats(reader, field.c_str())->floatArray, field.c_str());
+}
+
+std::wstring FloatFieldSource::description() const{
+	return std::wstring(L"float(") + field + L")";
+}
+
+ValueSource* FloatFieldSource::clone() const{
+	return _CLNEW FloatFieldSource(field.c_str());
+}
+
+const std::wstring FloatFieldSource::getClassName(){
+	return L"FloatFieldSource";
+}
+const std::wstring FloatFieldSource::getObjectName() const{
+	return getClassName();
+}
+
+
+/** The recency of each distinct date of a segment, looked up by the order of a document's term */
+class RecencyDocValues: public DocValues {
+	const FieldCache::StringIndex* index;
+	std::vector<float_t> recency;
+	std::wstring description;
+public:
+	RecencyDocValues(const FieldCache::StringIndex* _index, const int64_t now, const int64_t halfLife,
+		const std::wstring& _description):
+		index(_index),
+		recency(_index->count, 0.0f),
+		description(_description)
+	{
+		for (int32_t i = 0; i < index->count; i++) {
+			if (index->lookup[i] == NULL)
+				continue;                            // documents without a date
+			int64_t time;
+			try {
+				time = DateTools::stringToTime(index->lookup[i]);
+			} catch (CLuceneError& err) {
+				if (err.number() != CL_ERR_Parse)
+					throw;
+				continue;
+			}
+			const int64_t age = now > time ? now - time : 0;
+			recency[i] = static_cast<float_t>(pow(0.5, static_cast<double>(age) / static_cast<double>(halfLife)));
+		}
+	}
+	float_t floatVal(const int32_t doc){
+		return recency[index->order[doc]];
+	}
+	std::wstring toString(const int32_t doc){
+		const wchar_t* date = index->lookup[index->order[doc]];
+		return description + L"=" + Misc::toString(floatVal(doc)) + L" (" + (date == NULL ? L"no date" : date) + L")";
+	}
+};
+
+RecencyFieldSource::RecencyFieldSource(const wchar_t* field, const int64_t _now, const int64_t _halfLife):
+	FieldCacheSource(field),
+	now(_now),
+	halfLife(_halfLife)
+{
+	if (halfLife <= 0)
+		_CLTHROWA(CL_ERR_IllegalArgument, "The half-life of a RecencyFieldSource must be positive");
+}
+RecencyFieldSource::~RecencyFieldSource(){
+}
+
+DocValues* RecencyFieldSource::getValues(IndexReader* reader){
+	return _CLNEW RecencyDocValues(FieldCache::DEFAULT()->getStringIndex(reader, field.c_str())->stringIndex,
+		now, halfLife, description());
+}
+
+std::wstring RecencyFieldSource::description() const{
+	return std::wstring(L"recency(") + field + L",now=" + Misc::toString(now) +
+		L",halfLife=" + Misc::toString(halfLife) + L")";
+}
+
+ValueSource* RecencyFieldSource::clone() const{
+	return _CLNEW RecencyFieldSource(field.c_str(), now, halfLife);
+}
+
+bool RecencyFieldSource::equals(const ValueSource* other) const{
+	if (!FieldCacheSource::equals(other))
+		return false;
+	const RecencyFieldSource* o = static_cast<const RecencyFieldSource*>(other);
+	return now == o->now && halfLife == o->halfLife;
+}
+
+size_t RecencyFieldSource::hashCode() const{
+	return FieldCacheSource::hashCode() ^ static_cast<size_t>(now) ^ (static_cast<size_t>(halfLife) << 1);
+}
+
+const std::wstring RecencyFieldSource::getClassName(){
+	return L"RecencyFieldSource";
+}
+const std::wstring RecencyFieldSource::getObjectName() const{
+	return getClassName();
+}
+
+
+class NormDocValues: public DocValues {
+	const uint8_t* norms;
+	const wchar_t* field;
+public:
+	NormDocValues(const uint8_t* _norms, const wchar_t* _field): norms(_norms), field(_field){}
+	float_t floatVal(const int32_t doc){
+		return norms == NULL ? 0.0f : Similarity::decodeNorm(norms[doc]);
+	}
+	std::wstring toString(const int32_t doc){
+		return std::wstring(L"norm(") + field + L")=" + Misc::toString(floatVal(doc));
+	}
+};
+
+NormValueSource::NormValueSource(const wchar_t* _field):
+	field(_field)
+{
+}
+NormValueSource::~NormValueSource(){
+}
+
+DocValues* NormValueSource::getValues(IndexReader* reader){
+	return _CLNEW NormDocValues(reader->norms(field.c_str()), field.c_str());
+}
+
+std::wstring NormValueSource::description() const{
+	return std::wstring(L"norm(") + field + L")";
+}
+
+ValueSource* NormValueSource::clone() const{
+	return _CLNEW NormValueSource(field.c_str());
+}
+
+bool NormValueSource::equals(const ValueSource* other) const{
+	if (!other->instanceOf(NormValueSource::getClassName()))
+		return false;
+	return field == static_cast<const NormValueSource*>(other)->field;
+}
+
+size_t NormValueSource::hashCode() const{
+	return Misc::thashCode(field.c_str()) ^ 0x6E0F3A11;
+}
+
+const std::wstring NormValueSource::getClassName(){
+	return L"NormValueSource";
+}
+const std::wstring NormValueSource::getObjectName() const{
+	return getClassName();
+}
+
+CL_NS_END2
@@ -0,0 +1,115 @@
+/*------------------------------------------------------------------------------
+* Copyright (C) 2003-2006 Ben van Klinken and the CLucene Team
+
+* Updated by https://github.com/farfella/.
+*
+* Distributable under the terms of either the Apache License (Version 2.0) or
+* the GNU Lesser General Public License, as specified in the COPYING file.
+------------------------------------------------------------------------------*/
+#ifndef _lucene_search_function_FieldCacheSource_
+#define _lucene_search_function_FieldCacheSource_
+
+#include "ValueSource.h"
+
+CL_NS_DEF2(search,function)
+
+/**
+* Expert: a source of the values of an indexed field, read from the
+* FieldCache of each segment. The field must have at most one term per
+* document, as for sorting; a document without one has the value 0.
+*/
+class CLUCENE_EXPORT FieldCacheSource: public ValueSource {
+protected:
+	std::wstring field;
+public:
+	FieldCacheSource(const wchar_t* field);
+	virtual ~FieldCacheSource();
+
+	const wchar_t* getField() const;
+
+	bool equals(const ValueSource* other) const;
+	size_t hashCode() const;
+};
+
+/** The values of a field of integers, from FieldCache#getInts */
+class CLUCENE_EXPORT IntFieldSource: public FieldCacheSource {
+public:
+	IntFieldSource(const wchar_t* field);
+	virtual ~IntFieldSource();
+
+	DocValues* getValues(CL_NS(index)::IndexReader* reader);
+	std::wstring description() const;
+	ValueSource* clone() const;
+
+	static const std::wstring getClassName();
+	const std::wstring getObjectName() const;
+};
+
+/** The values of a field of floats, from FieldCache#getFloats */
+class CLUCENE_EXPORT FloatFieldSource: public FieldCacheSource {
+public:
+	FloatFieldSource(const wchar_t* field);
+	virtual ~FloatFieldSource();
+
+	DocValues* getValues(CL_NS(index)::IndexReader* reader);
+	std::wstring description() const;
+	ValueSource* clone() const;
+
+	static const std::wstring getClassName();
+	const std::wstring getObjectName() const;
+};
+
+/**
+* How recent the date in a field is: 1 for a date at or after
+* <code>now</code>, halving for every <code>halfLife</code> milliseconds
+* it is older. The field holds dates as DateTools writes them, at any
+* resolution. Each distinct date of a segment is parsed once, when its
+* values are taken; a document without a date, or with one DateTools
+* cannot parse, has the value 0.
+*/
+class CLUCENE_EXPORT RecencyFieldSource: public FieldCacheSource {
+private:
+	int64_t now;
+	int64_t halfLife;
+public:
+	/**
+	* @param now the time recency is measured from, in milliseconds since the epoch
+	* @param halfLife the age in milliseconds at which the value is 0.5
+	* @throws CL_ERR_IllegalArgument if <code>halfLife</code> is not positive
+	*/
+	RecencyFieldSource(const wchar_t* field, const int64_t now, const int64_t halfLife);
+	virtual ~RecencyFieldSource();
+
+	DocValues* getValues(CL_NS(index)::IndexReader* reader);
+	std::wstring description() const;
+	ValueSource* clone() const;
+	bool equals(const ValueSource* other) const;
+	size_t hashCode() const;
+
+	static const std::wstring getClassName();
+	const std::wstring getObjectName() const;
+};
+
+/**
+* The length normalization factor and index-time boost of a field, as
+* decoded from the norms of each segment by Similarity#decodeNorm.
+*/
+class CLUCENE_EXPORT NormValueSource: public ValueSource {
+private:
+	std::wstring field;
+public:
+	NormValueSource(const wchar_t* field);
+	virtual ~NormValueSource();
+
+	DocValues* getValues(CL_NS(index)::IndexReader* reader);
+	std::wstring description() const;
+	ValueSource* clone() const;
+	bool equals(const ValueSource* other) const;
+	size_t hashCode() const;
+
+	static const std::wstring getClassName();
+	const std::wstring getObjectName() const;
+};
+
+CL_NS_END2
+#endif
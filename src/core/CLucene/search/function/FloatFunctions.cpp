@@ -0,0 +1,300 @@
+/*------------------------------------------------------------------------------
+* Copyright (C) 2003-2006 Ben van Klinken and the CLucene Team
+
+* Updated by https://github.com/farfella/.
+*
+* Distributable under the terms of either the Apache License (Version 2.0) or
+* the GNU Lesser General Public License, as specified in the COPYING file.
+------------------------------------------------------------------------------*/
+#include "CLucene/_ApiHeader.h"
+#include "FloatFunctions.h"
+#include "CLucene/search/Explanation.h"
+#include "CLucene/util/Misc.h"
+
+CL_NS_USE(index)
+CL_NS_USE(util)
+CL_NS_DEF2(search,function)
+
+class LinearDocValues: public DocValues {
+	DocValues* values;
+	float_t slope;
+	float_t intercept;
+public:
+	LinearDocValues(DocValues* _values, const float_t _slope, const float_t _intercept):
+		values(_values), slope(_slope), intercept(_intercept){}
+	~LinearDocValues(){
+		_CLDELETE(values);
+	}
+	float_t floatVal(const int32_t doc){
+		return slope * values->floatVal(doc) + intercept;
+	}
+	std::wstring toString(const int32_t doc){
+		return Misc::toString(slope) + L"*float(" + values->toString(doc) + L")+" + Misc::toString(intercept);
+	}
+};
+
+LinearFloatFunction::LinearFloatFunction(ValueSource* _source, const float_t _slope, const float_t _intercept):
+	source(_source),
+	slope(_slope),
+	intercept(_intercept)
+{
+}
+LinearFloatFunction::~LinearFloatFunction(){
+	_CLDELETE(source);
+}
+
+DocValues* LinearFloatFunction::getValues(IndexReader* reader){
+	return _CLNEW LinearDocValues(source->getValues(reader), slope, intercept);
+}
+
+std::wstring LinearFloatFunction::description() const{
+	return Misc::toString(slope) + L"*float(" + source->description() + L")+" + Misc::toString(intercept);
+}
+
+ValueSource* LinearFloatFunction::clone() const{
+	return _CLNEW LinearFloatFunction(source->clone(), slope, intercept);
+}
+
+bool LinearFloatFunction::equals(const ValueSource* other) const{
+	if (!other->instanceOf(LinearFloatFunction::getClassName()))
+		return false;
+	const LinearFloatFunction* o = static_cast<const LinearFloatFunction*>(other);
+	return slope == o->slope && intercept == o->intercept && source->equals(o->source);
+}
+
+size_t LinearFloatFunction::hashCode() const{
+	return source->hashCode() ^ hashFloat(slope) ^ (hashFloat(intercept) << 1);
+}
+
+const std::wstring LinearFloatFunction::getClassName(){
+	return L"LinearFloatFunction";
+}
+const std::wstring LinearFloatFunction::getObjectName() const{
+	return getClassName();
+}
+
+
+class ReciprocalDocValues: public DocValues {
+	DocValues* values;
+	float_t m;
+	float_t a;
+	float_t b;
+public:
+	ReciprocalDocValues(DocValues* _values, const float_t _m, const float_t _a, const float_t _b):
+		values(_values), m(_m), a(_a), b(_b){}
+	~ReciprocalDocValues(){
+		_CLDELETE(values);
+	}
+	float_t floatVal(const int32_t doc){
+		return a / (m * values->floatVal(doc) + b);
+	}
+	std::wstring toString(const int32_t doc){
+		return Misc::toString(a) + L"/(" + Misc::toString(m) + L"*float(" + values->toString(doc) + L")+" +
+			Misc::toString(b) + L")";
+	}
+};
+
+ReciprocalFloatFunction::ReciprocalFloatFunction(ValueSource* _source, const float_t _m, const float_t _a, const float_t _b):
+	source(_source),
+	m(_m),
+	a(_a),
+	b(_b)
+{
+}
+ReciprocalFloatFunction::~ReciprocalFloatFunction(){
+	_CLDELETE(source);
+}
+
+DocValues* ReciprocalFloatFunction::getValues(IndexReader* reader){
+	return _CLNEW ReciprocalDocValues(source->getValues(reader), m, a, b);
+}
+
+std::wstring ReciprocalFloatFunction::description() const{
+	return Misc::toString(a) + L"/(" + Misc::toString(m) + L"*float(" + source->description() + L")+" +
+		Misc::toString(b) + L")";
+}
+
+ValueSource* ReciprocalFloatFunction::clone() const{
+	return _CLNEW ReciprocalFloatFunction(source->clone(), m, a, b);
+}
+
+bool ReciprocalFloatFunction::equals(const ValueSource* other) const{
+	if (!other->instanceOf(ReciprocalFloatFunction::getClassName()))
+		return false;
+	const ReciprocalFloatFunction* o = static_cast<const ReciprocalFloatFunction*>(other);
+	return m == o->m && a == o->a && b == o->b && source->equals(o->source);
+}
+
+size_t ReciprocalFloatFunction::hashCode() const{
+	return source->hashCode() ^ hashFloat(m) ^ (hashFloat(a) << 1) ^ (hashFloat(b) << 2);
+}
+
+const std::wstring ReciprocalFloatFunction::getClassName(){
+	return L"ReciprocalFloatFunction";
+}
+const std::wstring ReciprocalFloatFunction::getObjectName() const{
+	return getClassName();
+}
+
+
+class MultiFloatFunction::MultiDocValues: public DocValues {
+	const MultiFloatFunction* function;
+	std::vector<DocValues*> values;
+	std::vector<float_t> buffer;
+public:
+	MultiDocValues(const MultiFloatFunction* _function, IndexReader* reader):
+		function(_function),
+		buffer(_function->sources.size())
+	{
+		for (size_t i = 0; i < function->sources.size(); i++)
+			values.push_back(function->sources[i]->getValues(reader));
+	}
+	~MultiDocValues(){
+		for (size_t i = 0; i < values.size(); i++)
+			_CLDELETE(values[i]);
+	}
+	float_t floatVal(const int32_t doc){
+		for (size_t i = 0; i < values.size(); i++)
+			buffer[i] = values[i]->floatVal(doc);
+		return function->func(&buffer[0], buffer.size());
+	}
+	std::wstring toString(const int32_t doc){
+		std::wstring result = function->name();
+		result.push_back(L'(');
+		for (size_t i = 0; i < values.size(); i++) {
+			if (i > 0)
+				result.push_back(L',');
+			result.append(values[i]->toString(doc));
+		}
+		result.push_back(L')');
+		return result;
+	}
+	Explanation* explain(const int32_t doc){
+		Explanation* result = _CLNEW Explanation(floatVal(doc), (std::wstring(function->name()) + L" of:").c_str());
+		for (size_t i = 0; i < values.size(); i++)
+			result->addDetail(values[i]->explain(doc));
+		return result;
+	}
+};
+
+MultiFloatFunction::MultiFloatFunction(ValueSource** _sources, const size_t count){
+	if (count == 0)
+		_CLTHROWA(CL_ERR_IllegalArgument, "A MultiFloatFunction needs at least one source");
+	sources.assign(_sources, _sources + count);
+}
+
+MultiFloatFunction::MultiFloatFunction(const MultiFloatFunction& clone){
+	for (size_t i = 0; i < clone.sources.size(); i++)
+		sources.push_back(clone.sources[i]->clone());
+}
+
+MultiFloatFunction::~MultiFloatFunction(){
+	for (size_t i = 0; i < sources.size(); i++)
+		_CLDELETE(sources[i]);
+}
+
+DocValues* MultiFloatFunction::getValues(IndexReader* reader){
+	return _CLNEW MultiDocValues(this, reader);
+}
+
+std::wstring MultiFloatFunction::description() const{
+	std::wstring result = name();
+	result.push_back(L'(');
+	for (size_t i = 0; i < sources.size(); i++) {
+		if (i > 0)
+			result.push_back(L',');
+		result.append(sources[i]->description());
+	}
+	result.push_back(L')');
+	return result;
+}
+
+bool MultiFloatFunction::equals(const ValueSource* other) const{
+	if (other->getObjectName() != getObjectName())
+		return false;
+	const MultiFloatFunction* o = static_cast<const MultiFloatFunction*>(other);
+	if (sources.size() != o->sources.size())
+		return false;
+	for (size_t i = 0; i < sources.size(); i++) {
+		if (!sources[i]->equals(o->sources[i]))
+			return false;
+	}
+	return true;
+}
+
+size_t MultiFloatFunction::hashCode() const{
+	size_t h = Misc::thashCode(getObjectName().c_str());
+	for (size_t i = 0; i < sources.size(); i++)
+		h = h * 31 + sources[i]->hashCode();
+	return h;
+}
+
+
+ProductFloatFunction::ProductFloatFunction(ValueSource** sources, const size_t count):
+	MultiFloatFunction(sources, count)
+{
+}
+ProductFloatFunction::ProductFloatFunction(const ProductFloatFunction& clone):
+	MultiFloatFunction(clone)
+{
+}
+ProductFloatFunction::~ProductFloatFunction(){
+}
+
+float_t ProductFloatFunction::func(const float_t* values, const size_t count) const{
+	float_t product = 1.0f;
+	for (size_t i = 0; i < count; i++)
+		product *= values[i];
+	return product;
+}
+
+const wchar_t* ProductFloatFunction::name() const{
+	return L"product";
+}
+
+ValueSource* ProductFloatFunction::clone() const{
+	return _CLNEW ProductFloatFunction(*this);
+}
+
+const std::wstring ProductFloatFunction::getClassName(){
+	return L"ProductFloatFunction";
+}
+const std::wstring ProductFloatFunction::getObjectName() const{
+	return getClassName();
+}
+
+
+SumFloatFunction::SumFloatFunction(ValueSource** sources, const size_t count):
+	MultiFloatFunction(sources, count)
+{
+}
+SumFloatFunction::SumFloatFunction(const SumFloatFunction& clone):
+	MultiFloatFunction(clone)
+{
+}
+SumFloatFunction::~SumFloatFunction(){
+}
+
+float_t SumFloatFunction::func(const float_t* values, const size_t count) const{
+	float_t sum = 0.0f;
+	for (size_t i = 0; i < count; i++)
+		sum += values[i];
+	return sum;
+}
+
+const wchar_t* SumFloatFunction::name() const{
+	return L"sum";
+}
+
+ValueSource* SumFloatFunction::clone() const{
+	return _CLNEW SumFloatFunction(*this);
+}
+
+const std::wstring SumFloatFunction::getClassName(){
+	return L"SumFloatFunction";
+}
+const std::wstring SumFloatFunction::getObjectName() const{
+	return getClassName();
+}
+
+CL_NS_END2
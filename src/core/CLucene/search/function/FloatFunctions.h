@@ -0,0 +1,124 @@
+/*------------------------------------------------------------------------------
+* Copyright (C) 2003-2006 Ben van Klinken and the CLucene Team
+
+* Updated by https://github.com/farfella/.
+*
+* Distributable under the terms of either the Apache License (Version 2.0) or
+* the GNU Lesser General Public License, as specified in the COPYING file.
+------------------------------------------------------------------------------*/
+#ifndef _lucene_search_function_FloatFunctions_
+#define _lucene_search_function_FloatFunctions_
+
+#include "ValueSource.h"
+#include <vector>
+
+CL_NS_DEF2(search,function)
+
+/**
+* <code>slope * x + intercept</code>, where x is the value of another
+* source, which this one takes ownership of.
+*/
+class CLUCENE_EXPORT LinearFloatFunction: public ValueSource {
+private:
+	ValueSource* source;
+	float_t slope;
+	float_t intercept;
+public:
+	LinearFloatFunction(ValueSource* source, const float_t slope, const float_t intercept);
+	virtual ~LinearFloatFunction();
+
+	DocValues* getValues(CL_NS(index)::IndexReader* reader);
+	std::wstring description() const;
+	ValueSource* clone() const;
+	bool equals(const ValueSource* other) const;
+	size_t hashCode() const;
+
+	static const std::wstring getClassName();
+	const std::wstring getObjectName() const;
+};
+
+/**
+* <code>a / (m * x + b)</code>, where x is the value of another source,
+* which this one takes ownership of. With m and b positive this falls from
+* a/b towards 0 as x grows: for example 1/(x+1) of an age or a distance.
+*/
+class CLUCENE_EXPORT ReciprocalFloatFunction: public ValueSource {
+private:
+	ValueSource* source;
+	float_t m;
+	float_t a;
+	float_t b;
+public:
+	ReciprocalFloatFunction(ValueSource* source, const float_t m, const float_t a, const float_t b);
+	virtual ~ReciprocalFloatFunction();
+
+	DocValues* getValues(CL_NS(index)::IndexReader* reader);
+	std::wstring description() const;
+	ValueSource* clone() const;
+	bool equals(const ValueSource* other) const;
+	size_t hashCode() const;
+
+	static const std::wstring getClassName();
+	const std::wstring getObjectName() const;
+};
+
+/**
+* Abstract base for functions of the values of several sources, which it
+* takes ownership of.
+*/
+class CLUCENE_EXPORT MultiFloatFunction: public ValueSource {
+protected:
+	std::vector<ValueSource*> sources;
+
+	/** Combines the values of the sources for a document */
+	virtual float_t func(const float_t* values, const size_t count) const = 0;
+
+	/** The name of the function, in descriptions */
+	virtual const wchar_t* name() const = 0;
+
+	MultiFloatFunction(const MultiFloatFunction& clone);
+public:
+	/** @throws CL_ERR_IllegalArgument if <code>count</code> is not positive */
+	MultiFloatFunction(ValueSource** sources, const size_t count);
+	virtual ~MultiFloatFunction();
+
+	DocValues* getValues(CL_NS(index)::IndexReader* reader);
+	std::wstring description() const;
+	bool equals(const ValueSource* other) const;
+	size_t hashCode() const;
+
+	class MultiDocValues;
+};
+
+/** The product of the values of several sources */
+class CLUCENE_EXPORT ProductFloatFunction: public MultiFloatFunction {
+protected:
+	float_t func(const float_t* values, const size_t count) const;
+	const wchar_t* name() const;
+	ProductFloatFunction(const ProductFloatFunction& clone);
+public:
+	ProductFloatFunction(ValueSource** sources, const size_t count);
+	virtual ~ProductFloatFunction();
+	ValueSource* clone() const;
+
+	static const std::wstring getClassName();
+	const std::wstring getObjectName() const;
+};
+
+/** The sum of the values of several sources */
+class CLUCENE_EXPORT SumFloatFunction: public MultiFloatFunction {
+protected:
+	float_t func(const float_t* values, const size_t count) const;
+	const wchar_t* name() const;
+	SumFloatFunction(const SumFloatFunction& clone);
+public:
+	SumFloatFunction(ValueSource** sources, const size_t count);
+	virtual ~SumFloatFunction();
+	ValueSource* clone() const;
+
+	static const std::wstring getClassName();
+	const std::wstring getObjectName() const;
+};
+
+CL_NS_END2
+#endif
@@ -0,0 +1,87 @@
+/*------------------------------------------------------------------------------
+* Copyright (C) 2003-2006 Ben van Klinken and the CLucene Team
+
+* Updated by https://github.com/farfella/.
+*
+* Distributable under the terms of either the Apache License (Version 2.0) or
+* the GNU Lesser General Public License, as specified in the COPYING file.
+------------------------------------------------------------------------------*/
+#include "CLucene/_ApiHeader.h"
+#include "ValueSource.h"
+#include "CLucene/search/Explanation.h"
+#include "CLucene/util/Misc.h"
+#include <string.h>
+
+CL_NS_USE(index)
+CL_NS_USE(util)
+CL_NS_DEF2(search,function)
+
+DocValues::~DocValues(){
+}
+
+Explanation* DocValues::explain(const int32_t doc){
+	return _CLNEW Explanation(floatVal(doc), toString(doc).c_str());
+}
+
+ValueSource::~ValueSource(){
+}
+
+size_t ValueSource::hashFloat(const float_t value){
+	int32_t bits;
+	memcpy(&bits, &value, sizeof(bits));
+	return static_cast<size_t>(bits);
+}
+
+std::wstring ValueSource::toString() const{
+	return description();
+}
+
+class ConstDocValues: public DocValues {
+	float_t constant;
+public:
+	ConstDocValues(const float_t _constant): constant(_constant){}
+	float_t floatVal(const int32_t /*doc*/){
+		return constant;
+	}
+	std::wstring toString(const int32_t /*doc*/){
+		return std::wstring(L"const(") + Misc::toString(constant) + L")";
+	}
+};
+
+ConstValueSource::ConstValueSource(const float_t _constant):
+	constant(_constant)
+{
+}
+ConstValueSource::~ConstValueSource(){
+}
+
+DocValues* ConstValueSource::getValues(IndexReader* /*reader*/){
+	return _CLNEW ConstDocValues(constant);
+}
+
+std::wstring ConstValueSource::description() const{
+	return std::wstring(L"const(") + Misc::toString(constant) + L")";
+}
+
+ValueSource* ConstValueSource::clone() const{
+	return _CLNEW ConstValueSource(constant);
+}
+
+bool ConstValueSource::equals(const ValueSource* other) const{
+	if (!other->instanceOf(ConstValueSource::getClassName()))
+		return false;
+	return constant == static_cast<const ConstValueSource*>(other)->constant;
+}
+
+size_t ConstValueSource::hashCode() const{
+	return hashFloat(constant) ^ 0x3C0F5A1D;
+}
+
+const std::wstring ConstValueSource::getClassName(){
+	return L"ConstValueSource";
+}
+const std::wstring ConstValueSource::getObjectName() const{
+	return getClassName();
+}
+
+CL_NS_END2
@@ -0,0 +1,91 @@
+/*------------------------------------------------------------------------------
+* Copyright (C) 2003-2006 Ben van Klinken and the CLucene Team
+
+* Updated by https://github.com/farfella/.
+*
+* Distributable under the terms of either the Apache License (Version 2.0) or
+* the GNU Lesser General Public License, as specified in the COPYING file.
+------------------------------------------------------------------------------*/
+#ifndef _lucene_search_function_ValueSource_
+#define _lucene_search_function_ValueSource_
+
+#include "CLucene/util/Equators.h"
+CL_CLASS_DEF(index,IndexReader)
+CL_CLASS_DEF(search,Explanation)
+
+CL_NS_DEF2(search,function)
+
+/**
+* Expert: the values of a ValueSource for the documents of one reader,
+* numbered as the reader numbers them.
+*/
+class CLUCENE_EXPORT DocValues {
+public:
+	virtual ~DocValues();
+
+	/** Returns the value of document <code>doc</code> */
+	virtual float_t floatVal(const int32_t doc) = 0;
+
+	/** Describes the value of document <code>doc</code>, for explanations */
+	virtual std::wstring toString(const int32_t doc) = 0;
+
+	/** Explains the value of document <code>doc</code> */
+	virtual Explanation* explain(const int32_t doc);
+};
+
+/**
+* Expert: a source of a float value for each document, such as the value
+* of a field or a function of other sources. A ValueSourceQuery scores
+* documents by a source, and a CustomScoreQuery blends a source into the
+* score of another query.
+*
+* <p>IndexSearcher scores each segment on its own, and the values are
+* taken for one segment at a time: a source reads the FieldCache arrays
+* or the norms of the segment. Sources that are made of other sources
+* own them.</p>
+*/
+class CLUCENE_EXPORT ValueSource: public CL_NS(util)::NamedObject {
+protected:
+	/** Hashes a float by its bits, for hashCode() */
+	static size_t hashFloat(const float_t value);
+public:
+	virtual ~ValueSource();
+
+	/**
+	* Returns the values of the documents of <code>reader</code>, which
+	* the caller deletes. The values may point into arrays that
+	* <code>reader</code> or the FieldCache hold, and must not outlive the
+	* reader.
+	*/
+	virtual DocValues* getValues(CL_NS(index)::IndexReader* reader) = 0;
+
+	/** Describes the source */
+	virtual std::wstring description() const = 0;
+
+	virtual ValueSource* clone() const = 0;
+	virtual bool equals(const ValueSource* other) const = 0;
+	virtual size_t hashCode() const = 0;
+
+	std::wstring toString() const;
+};
+
+/** The same value for every document */
+class CLUCENE_EXPORT ConstValueSource: public ValueSource {
+private:
+	float_t constant;
+public:
+	ConstValueSource(const float_t constant);
+	virtual ~ConstValueSource();
+
+	DocValues* getValues(CL_NS(index)::IndexReader* reader);
+	std::wstring description() const;
+	ValueSource* clone() const;
+	bool equals(const ValueSource* other) const;
+	size_t hashCode() const;
+
+	static const std::wstring getClassName();
+	const std::wstring getObjectName() const;
+};
+
+CL_NS_END2
+#endif
@@ -0,0 +1,213 @@
+/*------------------------------------------------------------------------------
+* Copyright (C) 2003-2006 Ben van Klinken and the CLucene Team
+
+* Updated by https://github.com/farfella/.
+*
+* Distributable under the terms of either the Apache License (Version 2.0) or
+* the GNU Lesser General Public License, as specified in the COPYING file.
+------------------------------------------------------------------------------*/
+#include "CLucene/_ApiHeader.h"
+#include "ValueSourceQuery.h"
+#include "CLucene/search/Scorer.h"
+#include "CLucene/search/SearchHeader.h"
+#include "CLucene/search/Searchable.h"
+#include "CLucene/search/Similarity.h"
+#include "CLucene/search/Explanation.h"
+#include "CLucene/index/IndexReader.h"
+#include "CLucene/util/StringBuffer.h"
+
+CL_NS_USE(index)
+CL_NS_USE(search)
+CL_NS_DEF2(search,function)
+
+class ValueSourceQuery::ValueSourceWeight: public Weight {
+private:
+	Similarity* similarity;
+	float_t queryWeight;
+	float_t queryNorm;
+	ValueSourceQuery* parentQuery;
+public:
+	ValueSourceWeight(ValueSourceQuery* enclosingInstance, Searcher* searcher);
+	virtual ~ValueSourceWeight(){}
+
+	std::wstring toString();
+	Query* getQuery();
+	float_t getValue();
+	float_t sumOfSquaredWeights();
+	void normalize(float_t _queryNorm);
+	Scorer* scorer(IndexReader* reader);
+	Explanation* explain(IndexReader* reader, int32_t doc);
+};
+
+class ValueSourceQuery::ValueSourceScorer: public Scorer {
+private:
+	IndexReader* reader;
+	DocValues* values;
+	float_t queryWeight;
+	int32_t id;
+	int32_t maxId;
+public:
+	ValueSourceScorer(IndexReader* _reader, Similarity* similarity, DocValues* _values, const float_t _queryWeight);
+	virtual ~ValueSourceScorer();
+
+	int32_t doc() const;
+	bool next();
+	float_t score();
+	bool skipTo(int32_t target);
+	Explanation* explain(int32_t doc);
+	std::wstring toString();
+};
+
+ValueSourceQuery::ValueSourceScorer::ValueSourceScorer(IndexReader* _reader, Similarity* similarity,
+	DocValues* _values, const float_t _queryWeight):
+	Scorer(similarity),
+	reader(_reader),
+	values(_values),
+	queryWeight(_queryWeight),
+	id(-1)
+{
+	maxId = reader->maxDoc() - 1;
+}
+
+ValueSourceQuery::ValueSourceScorer::~ValueSourceScorer(){
+	_CLDELETE(values);
+}
+
+int32_t ValueSourceQuery::ValueSourceScorer::doc() const{
+	return id;
+}
+
+bool ValueSourceQuery::ValueSourceScorer::next(){
+	while (id < maxId) {
+		id++;
+		if (!reader->isDeleted(id))
+			return true;
+	}
+	return false;
+}
+
+float_t ValueSourceQuery::ValueSourceScorer::score(){
+	return queryWeight * values->floatVal(id);
+}
+
+bool ValueSourceQuery::ValueSourceScorer::skipTo(int32_t target){
+	id = target - 1;
+	return next();
+}
+
+Explanation* ValueSourceQuery::ValueSourceScorer::explain(int32_t /*doc*/){
+	// not called... see ValueSourceWeight::explain()
+	return NULL;
+}
+
+std::wstring ValueSourceQuery::ValueSourceScorer::toString(){
+	return L"ValueSourceScorer";
+}
+
+ValueSourceQuery::ValueSourceWeight::ValueSourceWeight(ValueSourceQuery* enclosingInstance, Searcher* searcher):
+	parentQuery(enclosingInstance)
+{
+	similarity = parentQuery->getSimilarity(searcher);
+}
+
+std::wstring ValueSourceQuery::ValueSourceWeight::toString(){
+	std::wstring buf = L"weight(";
+	buf.append(parentQuery->toString());
+	buf.push_back(L')');
+	return buf;
+}
+
+Query* ValueSourceQuery::ValueSourceWeight::getQuery(){
+	return parentQuery;
+}
+
+float_t ValueSourceQuery::ValueSourceWeight::getValue(){
+	return queryWeight;
+}
+
+float_t ValueSourceQuery::ValueSourceWeight::sumOfSquaredWeights(){
+	queryWeight = parentQuery->getBoost();
+	return queryWeight * queryWeight;
+}
+
+void ValueSourceQuery::ValueSourceWeight::normalize(float_t _queryNorm){
+	queryNorm = _queryNorm;
+	queryWeight *= queryNorm;
+}
+
+Scorer* ValueSourceQuery::ValueSourceWeight::scorer(IndexReader* reader){
+	return _CLNEW ValueSourceScorer(reader, similarity, parentQuery->source->getValues(reader), queryWeight);
+}
+
+Explanation* ValueSourceQuery::ValueSourceWeight::explain(IndexReader* reader, int32_t doc){
+	if (reader->isDeleted(doc))
+		return _CLNEW ComplexExplanation(false, 0.0f, L"deleted document");
+
+	DocValues* values = parentQuery->source->getValues(reader);
+	const float_t score = queryWeight * values->floatVal(doc);
+	std::wstring description = parentQuery->toString();
+	description.append(L", product of:");
+	ComplexExplanation* result = _CLNEW ComplexExplanation(score > 0.0f, score, description.c_str());
+	result->addDetail(values->explain(doc));
+	_CLDELETE(values);
+	if (parentQuery->getBoost() != 1.0f)
+		result->addDetail(_CLNEW Explanation(parentQuery->getBoost(), L"boost"));
+	result->addDetail(_CLNEW Explanation(queryNorm, L"queryNorm"));
+	return result;
+}
+
+ValueSourceQuery::ValueSourceQuery(ValueSource* _source):
+	source(_source)
+{
+}
+
+ValueSourceQuery::ValueSourceQuery(const ValueSourceQuery& clone):
+	Query(clone),
+	source(clone.source->clone())
+{
+}
+
+ValueSourceQuery::~ValueSourceQuery(){
+	_CLDELETE(source);
+}
+
+ValueSource* ValueSourceQuery::getValueSource() const{
+	return source;
+}
+
+Weight* ValueSourceQuery::_createWeight(Searcher* searcher){
+	return _CLNEW ValueSourceWeight(this, searcher);
+}
+
+std::wstring ValueSourceQuery::toString(const wchar_t* /*field*/) const{
+	std::wstring buffer = source->description();
+	buffer.append(boost_to_wstring(getBoost()));
+	return buffer;
+}
+
+Query* ValueSourceQuery::clone() const{
+	return _CLNEW ValueSourceQuery(*this);
+}
+
+void ValueSourceQuery::extractTerms(TermSet* /*termset*/) const{
+}
+
+bool ValueSourceQuery::equals(Query* o) const{
+	if (!o->instanceOf(ValueSourceQuery::getClassName()))
+		return false;
+	ValueSourceQuery* other = static_cast<ValueSourceQuery*>(o);
+	return getBoost() == other->getBoost() && source->equals(other->source);
+}
+
+size_t ValueSourceQuery::hashCode() const{
+	return source->hashCode() ^ Similarity::floatToByte(getBoost()) ^ 0x5F0C7A13;
+}
+
+const std::wstring ValueSourceQuery::getClassName(){
+	return L"ValueSourceQuery";
+}
+const std::wstring ValueSourceQuery::getObjectName() const{
+	return getClassName();
+}
+
+CL_NS_END2
@@ -0,0 +1,61 @@
+/*------------------------------------------------------------------------------
+* Copyright (C) 2003-2006 Ben van Klinken and the CLucene Team
+
+* Updated by https://github.com/farfella/.
+*
+* Distributable under the terms of either the Apache License (Version 2.0) or
+* the GNU Lesser General Public License, as specified in the COPYING file.
+------------------------------------------------------------------------------*/
+#ifndef _lucene_search_function_ValueSourceQuery_
+#define _lucene_search_function_ValueSourceQuery_
+
+#include "CLucene/search/Query.h"
+#include "ValueSource.h"
+
+CL_CLASS_DEF(search,Weight)
+CL_CLASS_DEF(search,Searcher)
+
+CL_NS_DEF2(search,function)
+
+/**
+* A query that matches every document that is not deleted and scores it
+* by the value of a ValueSource, times the boost and the query
+* normalization. This is the function query: on its own it ranks by a
+* field or a function of fields; as a clause of a BooleanQuery it adds
+* that value to the score of the other clauses.
+*
+* <p>As with any query, documents whose score is not above 0 are not
+* hits.</p>
+*/
+class CLUCENE_EXPORT ValueSourceQuery: public CL_NS(search)::Query {
+private:
+	ValueSource* source;
+protected:
+	ValueSourceQuery(const ValueSourceQuery& clone);
+public:
+	/** Takes ownership of <code>source</code> */
+	ValueSourceQuery(ValueSource* source);
+	virtual ~ValueSourceQuery();
+
+	class ValueSourceWeight;
+	class ValueSourceScorer;
+
+	ValueSource* getValueSource() const;
+
+	std::wstring toString(const wchar_t* field = NULL) const;
+	CL_NS(search)::Query* clone() const;
+
+	/** A ValueSourceQuery provides no terms */
+	void extractTerms(CL_NS(search)::TermSet* termset) const;
+
+	bool equals(CL_NS(search)::Query* o) const;
+	size_t hashCode() const;
+
+	static const std::wstring getClassName();
+	const std::wstring getObjectName() const;
+
+	CL_NS(search)::Weight* _createWeight(CL_NS(search)::Searcher* searcher);
+};
+
+CL_NS_END2
+#endif
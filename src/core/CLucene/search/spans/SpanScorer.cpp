@@ -11,39 +11,69 @@
 #include "CLucene/search/Similarity.h"
 #include "CLucene/search/Explanation.h"
 #include "CLucene/util/StringBuffer.h"
+#include "CLucene/index/Terms.h"
 
 #include "SpanScorer.h"
 #include "Spans.h"
 
 CL_NS_DEF2(search, spans)
 
-SpanScorer::SpanScorer( Spans * spans, Weight * weight, Similarity * similarity, uint8_t* norms ) :
-Scorer( similarity ), firstTime( true ), more( true )
+SpanScorer::SpanScorer( Spans * spans, Weight * weight, Similarity * similarity, uint8_t* norms,
+    CL_NS(index)::TermDocs** approximation ) :
+Scorer( similarity ), firstTime( true ), more( true ), approximationStarted( false ), moreCandidates( true )
 {
     this->spans = spans;
     this->norms = norms;
     this->weight = weight;
     this->value = weight->getValue();
+    this->approximation = approximation;
     doc_ = -1;
 }
 
 SpanScorer::~SpanScorer()
 {
     _CLLDELETE( spans );
+    if( approximation != NULL )
+    {
+        for( CL_NS(index)::TermDocs** td = approximation; *td != NULL; td++ )
+        {
+            (*td)->close();
+            _CLLDELETE( *td );
+        }
+        _CLDELETE_LARRAY( approximation );
+    }
 }
 
 bool SpanScorer::next()
 {
+    if( approximation != NULL )
+    {
+        while( nextCandidate() )
+        {
+            if( matches() )
+                return true;
+        }
+        return false;
+    }
+
     if( firstTime )
     {
         more = spans->next();
         firstTime = false;
     }
+
     return setFreqCurrentDoc();
 }
 
 bool SpanScorer::skipTo( int32_t target )
 {
+    if( approximation != NULL )
+    {
+        if( ! skipToCandidate( target ))
+            return false;
+        return matches() || next();
+    }
+
     if( firstTime ) 
     {
         more = spans->skipTo( target );
@@ -62,6 +92,88 @@ bool SpanScorer::skipTo( int32_t target )
     return setFreqCurrentDoc();
 }
 
+bool SpanScorer::nextCandidate()
+{
+    if( approximation == NULL )
+        return next();
+    if( ! moreCandidates || ( ! firstTime && ! more ))
+        return false;
+
+    // all the TermDocs are on doc_, or not started yet
+    approximationStarted = true;
+    for( CL_NS(index)::TermDocs** td = approximation; *td != NULL; td++ )
+    {
+        if( ! (*td)->next() )
+            return moreCandidates = false;
+    }
+    return alignApproximation();
+}
+
+bool SpanScorer::skipToCandidate( int32_t target )
+{
+    if( approximation == NULL )
+        return skipTo( target );
+    if( ! moreCandidates || ( ! firstTime && ! more ))
+        return false;
+
+    for( CL_NS(index)::TermDocs** td = approximation; *td != NULL; td++ )
+    {
+        if(( ! approximationStarted || (*td)->doc() < target ) && ! (*td)->skipTo( target ))
+            return moreCandidates = false;
+    }
+    approximationStarted = true;
+    return alignApproximation();
+}
+
+bool SpanScorer::alignApproximation()
+{
+    int32_t candidate = -1;
+    for( CL_NS(index)::TermDocs** td = approximation; *td != NULL; td++ )
+        candidate = cl_max( candidate, (*td)->doc() );
+
+    bool aligned = false;
+    while( ! aligned )
+    {
+        aligned = true;
+        for( CL_NS(index)::TermDocs** td = approximation; *td != NULL; td++ )
+        {
+            if( (*td)->doc() < candidate && ! (*td)->skipTo( candidate ))
+                return moreCandidates = false;
+            if( (*td)->doc() > candidate )
+            {
+                candidate = (*td)->doc();
+                aligned = false;
+            }
+        }
+    }
+
+    doc_ = candidate;
+    return true;
+}
+
+bool SpanScorer::matches()
+{
+    if( approximation == NULL )
+        return true;
+
+    // only now move the spans, which reads positions, to the candidate
+    if( firstTime )
+    {
+        more = spans->skipTo( doc_ );
+        firstTime = false;
+    }
+    else if( more && spans->doc() < doc_ )
+    {
+        more = spans->skipTo( doc_ );
+    }
+
+    if( ! more || spans->doc() != doc_ )
+        return false;
+
+    setFreqCurrentDoc();
+    return true;
+}
+
 bool SpanScorer::setFreqCurrentDoc()
 {
     if( ! more )
@@ -11,6 +11,7 @@
 
 #include "CLucene/search/Scorer.h"
 CL_CLASS_DEF2(search,spans,Spans)
+CL_CLASS_DEF(index,TermDocs)
 CL_CLASS_DEF(search,Explanation)
 CL_CLASS_DEF(search,Weight)
 
@@ -18,6 +19,11 @@ CL_NS_DEF2(search, spans)
 
 /**
  * Public for extension only.
+ * <p>If it is given the TermDocs of terms every match must contain, the scorer
+ * iterates in two phases: candidates are the documents containing all of
+ * those terms, found using their skip lists, and the spans (and so the
+ * positions) are only advanced to the candidates that {@link #matches()} is
+ * called on.</p>
  */
 class CLUCENE_EXPORT SpanScorer : public CL_NS(search)::Scorer 
 {
@@ -32,14 +38,25 @@ protected:
 
     int32_t                     doc_;
     float_t                     freq;
+    CL_NS(index)::TermDocs**    approximation;
+    bool                        approximationStarted;
+    bool                        moreCandidates;
 
 
 public:
-    SpanScorer( Spans * spans, Weight * weight, Similarity * similarity, uint8_t* norms );    
+    /**
+     * @param approximation NULL, or a NULL terminated array of the TermDocs of
+     * terms that every match contains. The scorer takes ownership of it.
+     */
+    SpanScorer( Spans * spans, Weight * weight, Similarity * similarity, uint8_t* norms,
+        CL_NS(index)::TermDocs** approximation = NULL );
     virtual ~SpanScorer();
 
 	bool next();
 	bool skipTo( int32_t target );
+	bool nextCandidate();
+	bool skipToCandidate( int32_t target );
+	bool matches();
 	int32_t doc() const;
 	float_t score();
 	CL_NS(search)::Explanation* explain( int32_t docIn );
@@ -47,6 +64,8 @@ public:
 
 protected:
     bool setFreqCurrentDoc();
+    /** Moves the approximation's TermDocs to the first document they all contain */
+    bool alignApproximation();
 };
 
 CL_NS_END2
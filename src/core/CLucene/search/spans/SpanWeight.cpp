@@ -16,6 +16,10 @@
 #include "SpanWeight.h"
 #include "SpanQuery.h"
 #include "SpanScorer.h"
+#include "SpanTermQuery.h"
+#include "SpanNearQuery.h"
+#include "SpanFirstQuery.h"
+#include "SpanNotQuery.h"
 
 CL_NS_USE(util)
 CL_NS_DEF2(search, spans)
@@ -63,10 +67,52 @@ void SpanWeight::normalize(float_t norm)
 
 CL_NS(search)::Scorer * SpanWeight::scorer(CL_NS(index)::IndexReader* reader)
 {
+    // the spans of a single term cost no more than its TermDocs, for
+    // others check the documents containing the required terms first
+    CL_NS(index)::TermDocs ** approximation = NULL;
+    if (!query->instanceOf(SpanTermQuery::getClassName()))
+    {
+        TermSet required;
+        extractRequiredTerms(query, &required);
+        if (!required.empty())
+        {
+            approximation = _CL_NEWARRAY(CL_NS(index)::TermDocs *, required.size() + 1);
+            size_t i = 0;
+            for (TermSet::iterator itTerms = required.begin(); itTerms != required.end(); itTerms++)
+                approximation[i++] = reader->termDocs(*itTerms);
+            approximation[i] = NULL;
+        }
+    }
+
     return _CLNEW SpanScorer(query->getSpans(reader),
         this,
         similarity,
-        reader->norms(query->getField()));
+        reader->norms(query->getField()),
+        approximation);
+}
+
+void SpanWeight::extractRequiredTerms(SpanQuery * query, TermSet * required)
+{
+    if (query->instanceOf(SpanTermQuery::getClassName()))
+    {
+        required->insert(((SpanTermQuery *) query)->getTerm(false));
+    }
+    else if (query->instanceOf(SpanNearQuery::getClassName()))
+    {
+        SpanNearQuery * nearQuery = (SpanNearQuery *) query;
+        SpanQuery ** clauses = nearQuery->getClauses();
+        for (size_t i = 0; i < nearQuery->getClausesCount(); i++)
+            extractRequiredTerms(clauses[i], required);
+    }
+    else if (query->instanceOf(SpanFirstQuery::getClassName()))
+    {
+        extractRequiredTerms(((SpanFirstQuery *) query)->getMatch(), required);
+    }
+    else if (query->instanceOf(SpanNotQuery::getClassName()))
+    {
+        extractRequiredTerms(((SpanNotQuery *) query)->getInclude(), required);
+    }
+    // any term of a SpanOrQuery may be missing
 }
 
 CL_NS(search)::Explanation * SpanWeight::explain(CL_NS(index)::IndexReader* reader, int32_t doc)
@@ -32,6 +32,12 @@ protected:
     CL_NS(search)::TermSet *    terms;
     SpanQuery *                 query;
 
+    /**
+     * Adds to <code>required</code> the terms that every span of
+     * <code>query</code> contains, without adding references to them.
+     */
+    static void extractRequiredTerms( SpanQuery * query, CL_NS(search)::TermSet * required );
+
 public:
     SpanWeight( SpanQuery * query, CL_NS(search)::Searcher * searcher );
     virtual ~SpanWeight();
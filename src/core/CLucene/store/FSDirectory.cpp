@@ -649,7 +649,7 @@ bool FSDirectory::openInput(const wchar_t * name, IndexInput *& ret, CLuceneErro
     //todo: do some tests here... like if the file
     //is >2gb, then some system cannot mmap the file
     //also some file systems mmap will fail?? could detect here too
-    if (useMMap && Misc::file_Size(fl) < LUCENE_INT32_MAX_SHOULDBE) //todo: would this be bigger on 64bit systems?. i suppose it would be...test first
+    if (useMMap && fileLength(name) < LUCENE_INT32_MAX_SHOULDBE) //todo: would this be bigger on 64bit systems?. i suppose it would be...test first
         return MMapIndexInput::open(fl, ret, error, bufferSize);
     else
 #endif
@@ -122,6 +122,10 @@ CL_NS_USE(util)
     readBytes(b, len);
   }
 
+  const uint8_t* IndexInput::getMappedBytes(const int64_t /*pos*/, const int32_t /*len*/) {
+    return NULL;
+  }
+
   void IndexInput::readChars( wchar_t* buffer, const int32_t start, const int32_t len) {
     const int32_t end = start + len;
     wchar_t b;
@@ -128,6 +128,14 @@ namespace lucene {
                  /** The number of bytes in the file. */
                  virtual int64_t length() const = 0;
 
+                 /** Expert: returns a pointer to the <code>len</code> bytes of the file
+                 * at <code>pos</code> if the file is mapped into memory, or NULL if it is
+                 * not, in which case the bytes must be read. The file pointer is not
+                 * moved. The bytes are only valid until this stream, or the stream it
+                 * was cloned from, is closed, and must not be written to.
+                 */
+                 virtual const uint8_t* getMappedBytes(const int64_t pos, const int32_t len);
+
                  virtual const std::wstring getDirectoryType() const = 0;
                  virtual const std::wstring getObjectName() const = 0;
         };
@@ -72,7 +72,7 @@ CL_NS_USE(util)
 	{
   }
   
-  bool MMapIndexInput::open(const char* path, IndexInput*& ret, CLuceneError& error, int32_t __bufferSize )    {
+  bool MMapIndexInput::open(const wchar_t * path, IndexInput*& ret, CLuceneError& error, int32_t __bufferSize )    {
 
 	//Func - Constructor.
 	//       Opens the file named path
@@ -85,7 +85,7 @@ CL_NS_USE(util)
 
 #if defined(_CL_HAVE_FUNCTION_MAPVIEWOFFILE)
 	  _internal->mmaphandle = NULL;
-	  _internal->fhandle = CreateFileA(path,GENERIC_READ,FILE_SHARE_READ, 0,OPEN_EXISTING,0,0);
+	  _internal->fhandle = CreateFileW(path,GENERIC_READ,FILE_SHARE_READ, 0,OPEN_EXISTING,0,0);
 	  
 	  //Check if a valid fhandle was retrieved
 	  if (_internal->fhandle < 0){
@@ -129,7 +129,7 @@ CL_NS_USE(util)
 	  }
 
 #else //_CL_HAVE_FUNCTION_MAPVIEWOFFILE
-     _internal->fhandle = ::_cl_open (path, _O_BINARY | O_RDONLY | _O_RANDOM, _S_IREAD);
+     _internal->fhandle = ::_wopen (path, _O_BINARY | O_RDONLY | _O_RANDOM, _S_IREAD);
   	 if (_internal->fhandle < 0){
 	    error.set(CL_ERR_IO, strerror(errno));
   	 }else{
@@ -204,6 +204,12 @@ CL_NS_USE(util)
   }
   int64_t MMapIndexInput::length() const{ return _internal->_length; }
 
+  const uint8_t* MMapIndexInput::getMappedBytes(const int64_t pos, const int32_t len){
+	  if (pos < 0 || len < 0 || pos + len > _internal->_length)
+		  return NULL;
+	  return _internal->data + pos;
+  }
+
   MMapIndexInput::~MMapIndexInput(){
   //Func - Destructor
   //Pre  - True
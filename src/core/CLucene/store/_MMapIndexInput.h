@@ -22,7 +22,7 @@ namespace lucene {
             MMapIndexInput(const MMapIndexInput& clone);
             MMapIndexInput(Internal* _internal);
         public:
-            static bool open(const char* path, IndexInput*& ret, CLuceneError& error, int32_t __bufferSize);
+            static bool open(const wchar_t * path, IndexInput*& ret, CLuceneError& error, int32_t __bufferSize);
 
             ~MMapIndexInput();
             IndexInput* clone() const;
@@ -34,6 +34,7 @@ namespace lucene {
             int64_t getFilePointer() const;
             void seek(const int64_t pos);
             int64_t length() const;
+            const uint8_t* getMappedBytes(const int64_t pos, const int32_t len);
 
             const std::wstring getObjectName() const { return MMapIndexInput::getClassName(); }
             static const std::wstring getClassName() { return L"MMapIndexInput"; }
@@ -0,0 +1,627 @@
+/*------------------------------------------------------------------------------
+* Copyright (C) 2003-2006 Ben van Klinken and the CLucene Team
+* Updated by https://github.com/farfella/.
+*
+* Distributable under the terms of either the Apache License (Version 2.0) or
+* the GNU Lesser General Public License, as specified in the COPYING file.
+------------------------------------------------------------------------------*/
+#include "CLucene/_ApiHeader.h"
+#include "_Automaton.h"
+#include <algorithm>
+#include <map>
+
+CL_NS_DEF(util)
+
+const int32_t Automaton::MAX_CHAR = (int32_t)WCHAR_MAX;
+
+/**
+* Builds a Thompson NFA for a pattern, one fragment (a start and an end
+* state) at a time, then turns it into an Automaton by subset construction.
+*/
+class Automaton::Builder {
+public:
+	struct Edge {
+		int32_t min;  //-1 for an epsilon edge
+		int32_t max;
+		int32_t to;
+	};
+	struct Fragment {
+		int32_t start;
+		int32_t end;
+	};
+
+	Builder(const wchar_t* pattern):
+		pattern(pattern),
+		pos(0),
+		len(wcslen(pattern))
+	{
+	}
+
+	Fragment wildcard() {
+		Fragment f = empty();
+		for (; pos < len; pos++) {
+			Fragment g;
+			if (pattern[pos] == LUCENE_WILDCARDTERMENUM_WILDCARD_STRING)
+				g = star(range(1, MAX_CHAR));
+			else if (pattern[pos] == LUCENE_WILDCARDTERMENUM_WILDCARD_CHAR)
+				g = range(1, MAX_CHAR);
+			else
+				g = range(pattern[pos], pattern[pos]);
+			f = concat(f, g);
+		}
+		return f;
+	}
+
+	Fragment regexp() {
+		Fragment f = parseUnion();
+		if (pos < len)
+			_CLTHROWA(CL_ERR_Parse, "unmatched ')' in regular expression");
+		return f;
+	}
+
+	/**
+	* One state per (characters of text consumed, edits used); reading a
+	* character of text keeps the edit count, any other step spends one.
+	*/
+	Fragment levenshtein(const wchar_t* prefix, size_t prefixLen,
+		const wchar_t* text, size_t textLen, int32_t maxEdits)
+	{
+		Fragment f = empty();
+		for (size_t i = 0; i < prefixLen; i++)
+			f = concat(f, range(prefix[i], prefix[i]));
+
+		const int32_t rows = maxEdits + 1;
+		const int32_t first = (int32_t)states.size();
+		for (size_t i = 0; i <= textLen; i++)
+			for (int32_t e = 0; e < rows; e++)
+				newState();
+		const int32_t end = newState();
+
+		for (size_t i = 0; i <= textLen; i++) {
+			for (int32_t e = 0; e < rows; e++) {
+				const int32_t s = first + (int32_t)i * rows + e;
+				if (i < textLen)
+					addEdge(s, text[i], text[i], s + rows);
+				if (e < maxEdits) {
+					addEdge(s, 1, MAX_CHAR, s + 1);                //insertion
+					if (i < textLen) {
+						addEdge(s, 1, MAX_CHAR, s + rows + 1);     //substitution
+						addEdge(s, -1, -1, s + rows + 1);          //deletion
+					}
+				}
+				if (i == textLen)
+					addEdge(s, -1, -1, end);
+			}
+		}
+		addEdge(f.end, -1, -1, first);
+
+		Fragment l = { f.start, end };
+		return l;
+	}
+
+	Automaton* determinize(const Fragment& f);
+
+private:
+	const wchar_t* pattern;
+	size_t pos;
+	size_t len;
+	std::vector< std::vector<Edge> > states;
+
+	int32_t newState() {
+		if (states.size() >= (size_t)MAX_STATES * 10)
+			_CLTHROWA(CL_ERR_IllegalArgument, "pattern is too complex");
+		states.push_back(std::vector<Edge>());
+		return (int32_t)states.size() - 1;
+	}
+	void addEdge(int32_t from, int32_t min, int32_t max, int32_t to) {
+		Edge e = { min, max, to };
+		states[from].push_back(e);
+	}
+
+	Fragment empty() {
+		Fragment f = { newState(), newState() };
+		addEdge(f.start, -1, -1, f.end);
+		return f;
+	}
+	Fragment range(int32_t min, int32_t max) {
+		Fragment f = { newState(), newState() };
+		addEdge(f.start, min, max, f.end);
+		return f;
+	}
+	Fragment concat(const Fragment& a, const Fragment& b) {
+		addEdge(a.end, -1, -1, b.start);
+		Fragment f = { a.start, b.end };
+		return f;
+	}
+	Fragment alternate(const Fragment& a, const Fragment& b) {
+		Fragment f = { newState(), newState() };
+		addEdge(f.start, -1, -1, a.start);
+		addEdge(f.start, -1, -1, b.start);
+		addEdge(a.end, -1, -1, f.end);
+		addEdge(b.end, -1, -1, f.end);
+		return f;
+	}
+	Fragment star(const Fragment& a) {
+		Fragment f = { newState(), newState() };
+		addEdge(f.start, -1, -1, a.start);
+		addEdge(f.start, -1, -1, f.end);
+		addEdge(a.end, -1, -1, a.start);
+		addEdge(a.end, -1, -1, f.end);
+		return f;
+	}
+	Fragment plus(const Fragment& a) {
+		Fragment f = { newState(), newState() };
+		addEdge(f.start, -1, -1, a.start);
+		addEdge(a.end, -1, -1, a.start);
+		addEdge(a.end, -1, -1, f.end);
+		return f;
+	}
+	Fragment optional(const Fragment& a) {
+		Fragment f = { newState(), newState() };
+		addEdge(f.start, -1, -1, a.start);
+		addEdge(f.start, -1, -1, f.end);
+		addEdge(a.end, -1, -1, f.end);
+		return f;
+	}
+
+	/** Duplicates a fragment that has not been linked to anything yet */
+	Fragment copy(const Fragment& a) {
+		std::map<int32_t, int32_t> mapped;
+		std::vector<int32_t> pending;
+		mapped[a.start] = newState();
+		pending.push_back(a.start);
+		while (!pending.empty()) {
+			const int32_t s = pending.back();
+			pending.pop_back();
+			for (size_t i = 0; i < states[s].size(); i++) {
+				const Edge e = states[s][i];
+				std::map<int32_t, int32_t>::iterator itr = mapped.find(e.to);
+				if (itr == mapped.end()) {
+					itr = mapped.insert(std::make_pair(e.to, newState())).first;
+					pending.push_back(e.to);
+				}
+				addEdge(mapped[s], e.min, e.max, itr->second);
+			}
+		}
+		std::map<int32_t, int32_t>::iterator end = mapped.find(a.end);
+		Fragment f = { mapped[a.start], end == mapped.end() ? newState() : end->second };
+		return f;
+	}
+
+	/** a{min,max}, max == -1 meaning unbounded */
+	Fragment repeat(const Fragment& a, int32_t min, int32_t max) {
+		const int32_t parts = max == -1 ? min + 1 : max;
+		if (parts == 0)
+			return empty();
+
+		std::vector<Fragment> copies;
+		copies.push_back(a);
+		for (int32_t i = 1; i < parts; i++)
+			copies.push_back(copy(a));
+
+		Fragment f = empty();
+		for (int32_t i = 0; i < min; i++)
+			f = concat(f, copies[i]);
+		if (max == -1)
+			f = concat(f, star(copies[min]));
+		else
+			for (int32_t i = min; i < max; i++)
+				f = concat(f, optional(copies[i]));
+		return f;
+	}
+
+	bool more() const { return pos < len; }
+	wchar_t peek() const { return pattern[pos]; }
+
+	Fragment parseUnion() {
+		Fragment f = parseConcat();
+		while (more() && peek() == L'|') {
+			pos++;
+			f = alternate(f, parseConcat());
+		}
+		return f;
+	}
+
+	Fragment parseConcat() {
+		Fragment f = empty();
+		while (more() && peek() != L'|' && peek() != L')')
+			f = concat(f, parseRepeat());
+		return f;
+	}
+
+	Fragment parseRepeat() {
+		Fragment f = parseAtom();
+		while (more()) {
+			const wchar_t c = peek();
+			if (c == L'*')
+				f = star(f);
+			else if (c == L'+')
+				f = plus(f);
+			else if (c == L'?')
+				f = optional(f);
+			else if (c == L'{') {
+				pos++;
+				const int32_t min = parseInt();
+				int32_t max = min;
+				if (more() && peek() == L',') {
+					pos++;
+					max = (more() && peek() == L'}') ? -1 : parseInt();
+				}
+				if (!more() || peek() != L'}')
+					_CLTHROWA(CL_ERR_Parse, "missing '}' in regular expression");
+				if (max != -1 && max < min)
+					_CLTHROWA(CL_ERR_Parse, "bad repetition bounds in regular expression");
+				f = repeat(f, min, max);
+			} else
+				break;
+			pos++;
+		}
+		return f;
+	}
+
+	Fragment parseAtom() {
+		wchar_t c = pattern[pos++];
+		switch (c) {
+		case L'(': {
+			Fragment f = parseUnion();
+			if (!more() || peek() != L')')
+				_CLTHROWA(CL_ERR_Parse, "missing ')' in regular expression");
+			pos++;
+			return f;
+		}
+		case L'.':
+			return range(1, MAX_CHAR);
+		case L'[':
+			return parseClass();
+		case L'\\':
+			if (!more())
+				_CLTHROWA(CL_ERR_Parse, "trailing '\\' in regular expression");
+			c = pattern[pos++];
+			return range(c, c);
+		case L'*':
+		case L'+':
+		case L'?':
+		case L'{':
+			_CLTHROWA(CL_ERR_Parse, "nothing to repeat in regular expression");
+		default:
+			return range(c, c);
+		}
+	}
+
+	int32_t parseClassChar() {
+		if (!more())
+			_CLTHROWA(CL_ERR_Parse, "missing ']' in regular expression");
+		wchar_t c = pattern[pos++];
+		if (c == L'\\') {
+			if (!more())
+				_CLTHROWA(CL_ERR_Parse, "missing ']' in regular expression");
+			c = pattern[pos++];
+		}
+		return c;
+	}
+
+	Fragment parseClass() {
+		bool negate = false;
+		if (more() && peek() == L'^') {
+			negate = true;
+			pos++;
+		}
+
+		std::vector< std::pair<int32_t, int32_t> > ranges;
+		bool first = true;
+		for (;;) {
+			if (!more())
+				_CLTHROWA(CL_ERR_Parse, "missing ']' in regular expression");
+			if (peek() == L']' && !first) {
+				pos++;
+				break;
+			}
+			first = false;
+			const int32_t from = parseClassChar();
+			int32_t to = from;
+			if (pos + 1 < len && peek() == L'-' && pattern[pos + 1] != L']') {
+				pos++;
+				to = parseClassChar();
+				if (to < from)
+					_CLTHROWA(CL_ERR_Parse, "bad character range in regular expression");
+			}
+			ranges.push_back(std::make_pair(from, to));
+		}
+
+		//sort and merge, then complement if negated
+		std::sort(ranges.begin(), ranges.end());
+		std::vector< std::pair<int32_t, int32_t> > merged;
+		for (size_t i = 0; i < ranges.size(); i++) {
+			if (!merged.empty() && (int64_t)ranges[i].first <= (int64_t)merged.back().second + 1)
+				merged.back().second = cl_max(merged.back().second, ranges[i].second);
+			else
+				merged.push_back(ranges[i]);
+		}
+		if (negate) {
+			std::vector< std::pair<int32_t, int32_t> > complement;
+			int32_t next = 1;
+			for (size_t i = 0; i < merged.size(); i++) {
+				if (merged[i].first > next)
+					complement.push_back(std::make_pair(next, merged[i].first - 1));
+				if (merged[i].second == MAX_CHAR) {
+					next = -1;
+					break;
+				}
+				next = cl_max(next, merged[i].second + 1);
+			}
+			if (next != -1)
+				complement.push_back(std::make_pair(next, MAX_CHAR));
+			merged.swap(complement);
+		}
+
+		Fragment f = { newState(), newState() };
+		for (size_t i = 0; i < merged.size(); i++)
+			addEdge(f.start, cl_max(merged[i].first, 1), merged[i].second, f.end);
+		return f;
+	}
+
+	int32_t parseInt() {
+		int32_t value = 0;
+		const size_t start = pos;
+		while (more() && peek() >= L'0' && peek() <= L'9') {
+			value = value * 10 + (peek() - L'0');
+			if (value > 1000)
+				_CLTHROWA(CL_ERR_Parse, "repetition count too large in regular expression");
+			pos++;
+		}
+		if (pos == start)
+			_CLTHROWA(CL_ERR_Parse, "expected a number in regular expression");
+		return value;
+	}
+
+	void closure(std::vector<int32_t>& set) const {
+		std::vector<int32_t> pending(set);
+		while (!pending.empty()) {
+			const int32_t s = pending.back();
+			pending.pop_back();
+			for (size_t i = 0; i < states[s].size(); i++) {
+				const Edge& e = states[s][i];
+				if (e.min == -1 && std::find(set.begin(), set.end(), e.to) == set.end()) {
+					set.push_back(e.to);
+					pending.push_back(e.to);
+				}
+			}
+		}
+		std::sort(set.begin(), set.end());
+	}
+};
+
+Automaton* Automaton::Builder::determinize(const Fragment& f)
+{
+	typedef std::map<std::vector<int32_t>, int32_t> SetIds;
+	SetIds ids;
+	std::vector< std::vector<int32_t> > sets;
+
+	std::vector<int32_t> start(1, f.start);
+	closure(start);
+	ids[start] = 0;
+	sets.push_back(start);
+
+	//subset construction; transitions are kept per state while building
+	std::vector<bool> accept;
+	std::vector< std::vector<Edge> > dfa;
+	for (size_t d = 0; d < sets.size(); d++) {
+		const std::vector<int32_t> set = sets[d];
+		accept.push_back(std::binary_search(set.begin(), set.end(), f.end));
+		dfa.push_back(std::vector<Edge>());
+
+		//split the characters leaving this set into intervals no edge straddles
+		std::vector<int64_t> points;
+		for (size_t i = 0; i < set.size(); i++) {
+			const std::vector<Edge>& edges = states[set[i]];
+			for (size_t j = 0; j < edges.size(); j++) {
+				if (edges[j].min != -1) {
+					points.push_back(edges[j].min);
+					points.push_back((int64_t)edges[j].max + 1);
+				}
+			}
+		}
+		std::sort(points.begin(), points.end());
+		points.erase(std::unique(points.begin(), points.end()), points.end());
+
+		for (size_t p = 0; p + 1 < points.size(); p++) {
+			const int32_t lo = (int32_t)points[p];
+			const int32_t hi = (int32_t)(points[p + 1] - 1);
+			std::vector<int32_t> target;
+			for (size_t i = 0; i < set.size(); i++) {
+				const std::vector<Edge>& edges = states[set[i]];
+				for (size_t j = 0; j < edges.size(); j++) {
+					if (edges[j].min != -1 && edges[j].min <= lo && edges[j].max >= hi
+						&& std::find(target.begin(), target.end(), edges[j].to) == target.end())
+						target.push_back(edges[j].to);
+				}
+			}
+			if (target.empty())
+				continue;
+			closure(target);
+
+			int32_t id;
+			SetIds::iterator itr = ids.find(target);
+			if (itr == ids.end()) {
+				if (sets.size() >= (size_t)MAX_STATES)
+					_CLTHROWA(CL_ERR_IllegalArgument, "pattern is too complex");
+				id = (int32_t)sets.size();
+				ids[target] = id;
+				sets.push_back(target);
+			} else
+				id = itr->second;
+
+			std::vector<Edge>& out = dfa[d];
+			if (!out.empty() && out.back().to == id && (int64_t)out.back().max + 1 == lo)
+				out.back().max = hi;
+			else {
+				Edge e = { lo, hi, id };
+				out.push_back(e);
+			}
+		}
+	}
+
+	//find the live states: those that can reach an accept state
+	const int32_t numStates = (int32_t)dfa.size();
+	std::vector< std::vector<int32_t> > reverse(numStates);
+	for (int32_t s = 0; s < numStates; s++)
+		for (size_t i = 0; i < dfa[s].size(); i++)
+			reverse[dfa[s][i].to].push_back(s);
+	std::vector<bool> live(numStates, false);
+	std::vector<int32_t> pending;
+	for (int32_t s = 0; s < numStates; s++) {
+		if (accept[s]) {
+			live[s] = true;
+			pending.push_back(s);
+		}
+	}
+	while (!pending.empty()) {
+		const int32_t s = pending.back();
+		pending.pop_back();
+		for (size_t i = 0; i < reverse[s].size(); i++) {
+			if (!live[reverse[s][i]]) {
+				live[reverse[s][i]] = true;
+				pending.push_back(reverse[s][i]);
+			}
+		}
+	}
+
+	//renumber the live states; the initial state stays, even if dead,
+	//as a lone state accepting nothing
+	std::vector<int32_t> renumber(numStates, -1);
+	int32_t numLive = 0;
+	for (int32_t s = 0; s < numStates; s++)
+		if (live[s] || s == 0)
+			renumber[s] = numLive++;
+
+	Automaton* a = _CLNEW Automaton();
+	for (int32_t s = 0; s < numStates; s++) {
+		if (renumber[s] == -1)
+			continue;
+		a->accept.push_back(accept[s]);
+		a->firstTransition.push_back((int32_t)a->transitionMin.size());
+		if (!live[s])
+			continue;
+		for (size_t i = 0; i < dfa[s].size(); i++) {
+			const Edge& e = dfa[s][i];
+			if (!live[e.to])
+				continue;
+			a->transitionMin.push_back(e.min);
+			a->transitionMax.push_back(e.max);
+			a->transitionDest.push_back(renumber[e.to]);
+		}
+	}
+	a->firstTransition.push_back((int32_t)a->transitionMin.size());
+	return a;
+}
+
+Automaton::Automaton()
+{
+}
+
+Automaton::~Automaton()
+{
+}
+
+Automaton* Automaton::fromWildcard(const wchar_t* pattern)
+{
+	CND_PRECONDITION(pattern != NULL, L"pattern is NULL");
+	Builder builder(pattern);
+	try {
+		return builder.determinize(builder.wildcard());
+	} catch (CLuceneError& err) {
+		if (err.number() != CL_ERR_IllegalArgument)
+			throw;
+		return NULL;                    //too many states
+	}
+}
+
+Automaton* Automaton::fromRegexp(const wchar_t* regexp)
+{
+	CND_PRECONDITION(regexp != NULL, L"regexp is NULL");
+	Builder builder(regexp);
+	return builder.determinize(builder.regexp());
+}
+
+Automaton* Automaton::fromLevenshtein(const wchar_t* prefix, size_t prefixLen,
+	const wchar_t* text, size_t textLen, int32_t maxEdits)
+{
+	CND_PRECONDITION(maxEdits >= 0, L"maxEdits is negative");
+	Builder builder(L"");
+	try {
+		return builder.determinize(builder.levenshtein(prefix, prefixLen, text, textLen, maxEdits));
+	} catch (CLuceneError& err) {
+		if (err.number() != CL_ERR_IllegalArgument)
+			throw;
+		return NULL;                    //too many states
+	}
+}
+
+int32_t Automaton::getNumStates() const
+{
+	return (int32_t)accept.size();
+}
+
+bool Automaton::isAccept(int32_t state) const
+{
+	return accept[state];
+}
+
+int32_t Automaton::step(int32_t state, int32_t c) const
+{
+	//binary search for the last transition starting at or before c
+	int32_t lo = firstTransition[state];
+	int32_t hi = firstTransition[state + 1] - 1;
+	while (lo <= hi) {
+		const int32_t mid = (lo + hi) >> 1;
+		if (transitionMin[mid] > c)
+			hi = mid - 1;
+		else if (transitionMax[mid] < c)
+			lo = mid + 1;
+		else
+			return transitionDest[mid];
+	}
+	return -1;
+}
+
+bool Automaton::run(const wchar_t* s, size_t len) const
+{
+	int32_t state = 0;
+	for (size_t i = 0; i < len; i++) {
+		state = step(state, s[i]);
+		if (state == -1)
+			return false;
+	}
+	return accept[state];
+}
+
+int32_t Automaton::getNumTransitions(int32_t state) const
+{
+	return firstTransition[state + 1] - firstTransition[state];
+}
+
+void Automaton::getTransition(int32_t state, int32_t i, int32_t& min, int32_t& max, int32_t& dest) const
+{
+	const int32_t t = firstTransition[state] + i;
+	min = transitionMin[t];
+	max = transitionMax[t];
+	dest = transitionDest[t];
+}
+
+void Automaton::getCommonPrefix(std::wstring& prefix) const
+{
+	prefix.clear();
+	int32_t state = 0;
+	//a state can only repeat through a loop, so stop after numStates steps
+	for (int32_t steps = 0; steps < getNumStates(); steps++) {
+		if (accept[state] || getNumTransitions(state) != 1)
+			break;
+		const int32_t t = firstTransition[state];
+		if (transitionMin[t] != transitionMax[t])
+			break;
+		prefix.push_back((wchar_t)transitionMin[t]);
+		state = transitionDest[t];
+	}
+}
+
+CL_NS_END
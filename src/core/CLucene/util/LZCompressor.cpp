@@ -0,0 +1,156 @@
+/*------------------------------------------------------------------------------
+* Copyright (C) 2003-2006 Ben van Klinken and the CLucene Team
+* Updated by https://github.com/farfella/.
+*
+* Distributable under the terms of either the Apache License (Version 2.0) or
+* the GNU Lesser General Public License, as specified in the COPYING file.
+------------------------------------------------------------------------------*/
+#include "CLucene/_ApiHeader.h"
+#include "_LZCompressor.h"
+
+CL_NS_DEF(util)
+
+namespace {
+	const int32_t MIN_MATCH = 4;
+	const int32_t LAST_LITERALS = 5;        // the block always ends with literals
+	const int32_t MF_LIMIT = 12;            // no match may start in the last bytes
+	const int32_t MAX_DISTANCE = 0xFFFF;
+	const int32_t HASH_LOG = 12;
+	const int32_t RUN_MASK = 15;
+
+	inline uint32_t readInt(const uint8_t* p){
+		return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24);
+	}
+
+	inline int32_t hash(const uint32_t i){
+		return (int32_t)((i * 2654435761U) >> (32 - HASH_LOG));
+	}
+
+	inline uint8_t* writeLength(uint8_t* op, int32_t length){
+		for (; length >= 255; length -= 255)
+			*op++ = 255;
+		*op++ = (uint8_t)length;
+		return op;
+	}
+
+	inline uint8_t* writeLiterals(uint8_t* op, const uint8_t* literals, const int32_t count, const int32_t matchToken){
+		uint8_t* token = op++;
+		if (count >= RUN_MASK){
+			*token = (uint8_t)((RUN_MASK << 4) | matchToken);
+			op = writeLength(op, count - RUN_MASK);
+		}else
+			*token = (uint8_t)((count << 4) | matchToken);
+		memcpy(op, literals, count);
+		return op + count;
+	}
+
+	inline int32_t readLength(const uint8_t*& ip, const uint8_t* end){
+		int32_t length = 0;
+		uint8_t b;
+		do{
+			if (ip >= end)
+				_CLTHROWA(CL_ERR_CorruptIndex, "Compressed block is truncated");
+			b = *ip++;
+			length += b;
+		}while (b == 255);
+		return length;
+	}
+}
+
+int32_t LZCompressor::maxCompressedLength(const int32_t length){
+	return length + length / 255 + 16;
+}
+
+int32_t LZCompressor::compress(const uint8_t* source, const int32_t length, ValueArray<uint8_t>& dest){
+	const int32_t bound = maxCompressedLength(length);
+	if ((int32_t)dest.length < bound)
+		dest.resize(bound);
+	uint8_t* op = dest.values;
+
+	int32_t anchor = 0;
+	if (length > MF_LIMIT){
+		int32_t table[1 << HASH_LOG];
+		for (int32_t i = 0; i < (1 << HASH_LOG); i++)
+			table[i] = -1;
+
+		const int32_t matchStartLimit = length - MF_LIMIT;
+		const int32_t matchEndLimit = length - LAST_LITERALS;
+		int32_t ip = 0;
+		while (ip < matchStartLimit){
+			const uint32_t sequence = readInt(source + ip);
+			const int32_t h = hash(sequence);
+			const int32_t ref = table[h];
+			table[h] = ip;
+			if (ref < 0 || ip - ref > MAX_DISTANCE || readInt(source + ref) != sequence){
+				ip++;
+				continue;
+			}
+
+			int32_t matchLength = MIN_MATCH;
+			while (ip + matchLength < matchEndLimit && source[ref + matchLength] == source[ip + matchLength])
+				matchLength++;
+
+			const int32_t extra = matchLength - MIN_MATCH;
+			op = writeLiterals(op, source + anchor, ip - anchor, extra >= RUN_MASK ? RUN_MASK : extra);
+			const int32_t distance = ip - ref;
+			*op++ = (uint8_t)distance;
+			*op++ = (uint8_t)(distance >> 8);
+			if (extra >= RUN_MASK)
+				op = writeLength(op, extra - RUN_MASK);
+
+			ip += matchLength;
+			anchor = ip;
+		}
+	}
+
+	op = writeLiterals(op, source + anchor, length - anchor, 0);
+	return (int32_t)(op - dest.values);
+}
+
+void LZCompressor::decompress(const uint8_t* source, const int32_t sourceLength, uint8_t* dest, const int32_t destLength){
+	const uint8_t* ip = source;
+	const uint8_t* const end = source + sourceLength;
+	uint8_t* op = dest;
+	uint8_t* const opEnd = dest + destLength;
+
+	while (ip < end){
+		const int32_t token = *ip++;
+
+		int32_t literals = token >> 4;
+		if (literals == RUN_MASK)
+			literals += readLength(ip, end);
+		if (literals > end - ip || literals > opEnd - op)
+			_CLTHROWA(CL_ERR_CorruptIndex, "Compressed block is corrupt");
+		memcpy(op, ip, literals);
+		ip += literals;
+		op += literals;
+
+		if (ip == end)
+			break;                                  // the last sequence has no match
+
+		if (end - ip < 2)
+			_CLTHROWA(CL_ERR_CorruptIndex, "Compressed block is truncated");
+		const int32_t distance = ip[0] | (ip[1] << 8);
+		ip += 2;
+		if (distance == 0 || distance > op - dest)
+			_CLTHROWA(CL_ERR_CorruptIndex, "Compressed block is corrupt");
+
+		int32_t matchLength = token & RUN_MASK;
+		if (matchLength == RUN_MASK)
+			matchLength += readLength(ip, end);
+		matchLength += MIN_MATCH;
+		if (matchLength > opEnd - op)
+			_CLTHROWA(CL_ERR_CorruptIndex, "Compressed block is corrupt");
+
+		//the match may overlap the output it is copied to
+		const uint8_t* match = op - distance;
+		for (int32_t i = 0; i < matchLength; i++)
+			op[i] = match[i];
+		op += matchLength;
+	}
+
+	if (op != opEnd)
+		_CLTHROWA(CL_ERR_CorruptIndex, "Compressed block has the wrong length");
+}
+
+CL_NS_END
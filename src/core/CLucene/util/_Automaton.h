@@ -0,0 +1,108 @@
+/*------------------------------------------------------------------------------
+* Copyright (C) 2003-2006 Ben van Klinken and the CLucene Team
+* Updated by https://github.com/farfella/.
+*
+* Distributable under the terms of either the Apache License (Version 2.0) or
+* the GNU Lesser General Public License, as specified in the COPYING file.
+------------------------------------------------------------------------------*/
+#ifndef _lucene_util_Automaton_
+#define _lucene_util_Automaton_
+
+#include "CLucene/clucene-config.h"
+#include <vector>
+
+CL_NS_DEF(util)
+
+/**
+* A deterministic finite automaton over wchar_t code units, compiled from a
+* wildcard or regular expression pattern so that terms can be matched in
+* one pass and the term dictionary can be skipped ahead to the next term
+* that could possibly match.
+*
+* <p>State 0 is the initial state. Dead states (states from which no accept
+* state can be reached) are removed while compiling, so if a walk cannot
+* continue then no string with that prefix is accepted. The transitions of
+* a state are disjoint character ranges sorted by their first character.
+* Character 0 never appears in a transition, since terms cannot contain it.</p>
+*/
+class CLUCENE_EXPORT Automaton: LUCENE_BASE {
+public:
+	/** Largest character value a transition can cover */
+	static const int32_t MAX_CHAR;
+
+	/** Upper bound on the number of states a pattern may compile to */
+	LUCENE_STATIC_CONSTANT(int32_t, MAX_STATES = 10000);
+
+	/**
+	* Compiles a wildcard pattern: <code>*</code> matches any sequence of
+	* characters (including none), <code>?</code> matches exactly one
+	* character and every other character matches itself. Returns NULL if
+	* the pattern needs more than MAX_STATES states, as <code>*a</code>
+	* followed by many <code>?</code> does; match such patterns one term at
+	* a time instead.
+	*/
+	static Automaton* fromWildcard(const wchar_t* pattern);
+
+	/**
+	* Compiles a regular expression that must match the whole term.
+	* Supported syntax:
+	* <ul>
+	* <li><code>a|b</code> alternation, <code>( )</code> grouping</li>
+	* <li><code>*</code>, <code>+</code>, <code>?</code>,
+	*   <code>{n}</code>, <code>{n,}</code> and <code>{n,m}</code> repetition</li>
+	* <li><code>.</code> any character, <code>[a-z_]</code> and
+	*   <code>[^0-9]</code> character classes</li>
+	* <li><code>\</code> escapes the following character</li>
+	* </ul>
+	* Throws CL_ERR_Parse if the expression is malformed and
+	* CL_ERR_IllegalArgument if it needs more than MAX_STATES states.
+	*/
+	static Automaton* fromRegexp(const wchar_t* regexp);
+
+	/**
+	* Compiles a Levenshtein automaton accepting the strings that start
+	* with <code>prefix</code> and whose remainder is within
+	* <code>maxEdits</code> insertions, deletions or substitutions of
+	* <code>text</code>. Meant for small distances: the number of states
+	* grows quickly with <code>maxEdits</code>. Returns NULL if it needs
+	* more than MAX_STATES states.
+	*/
+	static Automaton* fromLevenshtein(const wchar_t* prefix, size_t prefixLen,
+		const wchar_t* text, size_t textLen, int32_t maxEdits);
+
+	~Automaton();
+
+	int32_t getNumStates() const;
+	bool isAccept(int32_t state) const;
+
+	/** Returns the state reached from <code>state</code> on <code>c</code>, or -1 */
+	int32_t step(int32_t state, int32_t c) const;
+
+	/** Returns true if the automaton accepts the <code>len</code> characters of <code>s</code> */
+	bool run(const wchar_t* s, size_t len) const;
+
+	int32_t getNumTransitions(int32_t state) const;
+	void getTransition(int32_t state, int32_t i, int32_t& min, int32_t& max, int32_t& dest) const;
+
+	/**
+	* Sets <code>prefix</code> to the characters every accepted string
+	* starts with, i.e. the longest walk from the initial state through
+	* non-accepting states that have a single, single-character transition.
+	*/
+	void getCommonPrefix(std::wstring& prefix) const;
+
+private:
+	class Builder;
+	friend class Builder;
+
+	Automaton();
+
+	std::vector<bool> accept;
+	std::vector<int32_t> firstTransition; //numStates+1 entries
+	std::vector<int32_t> transitionMin;
+	std::vector<int32_t> transitionMax;
+	std::vector<int32_t> transitionDest;
+};
+
+CL_NS_END
+#endif
@@ -0,0 +1,47 @@
+/*------------------------------------------------------------------------------
+* Copyright (C) 2003-2006 Ben van Klinken and the CLucene Team
+* Updated by https://github.com/farfella/.
+*
+* Distributable under the terms of either the Apache License (Version 2.0) or
+* the GNU Lesser General Public License, as specified in the COPYING file.
+------------------------------------------------------------------------------*/
+#ifndef _lucene_util_LZCompressor_
+#define _lucene_util_LZCompressor_
+
+#include "CLucene/clucene-config.h"
+#include "CLucene/util/Array.h"
+
+CL_NS_DEF(util)
+
+/**
+* A fast LZ77 block codec, using the LZ4 block format: a sequence of
+* literal runs, each followed by a back reference of at least 4 bytes
+* into the last 64 KB of output. Matches are found greedily through a
+* single hash table, which trades some ratio for speed; use zlib through
+* Misc::deflate when the ratio matters more.
+*
+* <p>The block does not record its own decompressed length, callers must
+* store it next to the compressed data.</p>
+*/
+class CLUCENE_EXPORT LZCompressor {
+public:
+	/** Upper bound of the compressed size of <code>length</code> bytes */
+	static int32_t maxCompressedLength(const int32_t length);
+
+	/**
+	* Compresses <code>length</code> bytes of <code>source</code> into
+	* <code>dest</code>, which is resized if it is smaller than
+	* maxCompressedLength(length). Returns the compressed length.
+	*/
+	static int32_t compress(const uint8_t* source, const int32_t length, ValueArray<uint8_t>& dest);
+
+	/**
+	* Decompresses a block into <code>dest</code>, which must hold exactly
+	* <code>destLength</code> bytes. Throws CL_ERR_CorruptIndex if the block
+	* is malformed or does not decompress to <code>destLength</code> bytes.
+	*/
+	static void decompress(const uint8_t* source, const int32_t sourceLength, uint8_t* dest, const int32_t destLength);
+};
+
+CL_NS_END
+#endif
@@ -52,6 +52,7 @@
 #include "search/TestExplanations.cpp"
 #include "search/TestExtractTerms.cpp"
 #include "search/TestForDuplicates.cpp"
+#include "search/TestFunctionQuery.cpp"
 #include "search/TestIndexSearcher.cpp"
 #include "search/TestQueries.cpp"
 #include "search/TestRangeFilter.cpp"
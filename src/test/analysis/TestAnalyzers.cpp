@@ -294,6 +294,74 @@
        }
    }
 
+   // An analyzer which only implements tokenStream: the default
+   // reusableTokenStream must still hand out a stream the caller doesn't own
+   class NonReusingAnalyzer: public Analyzer {
+   public:
+       TokenStream* tokenStream(const wchar_t* /*fieldName*/, Reader* reader){
+           return _CLNEW LowerCaseFilter(_CLNEW WhitespaceTokenizer(reader), true);
+       }
+   };
+
+   void assertReusesStream(CuTest *tc, Analyzer* a, const wchar_t* field){
+       StringReader reader1(_T("first"));
+       TokenStream* ts1 = a->reusableTokenStream(field, &reader1);
+       StringReader reader2(_T("second"));
+       TokenStream* ts2 = a->reusableTokenStream(field, &reader2);
+       CLUCENE_ASSERT( ts1 == ts2 );
+   }
+
+   void testReusableTokenStream(CuTest *tc){
+       Analyzer* a = _CLNEW SimpleAnalyzer();
+       assertReusableAnalyzesTo(tc,a, _T("foo bar FOO BAR"), _T("foo;bar;foo;bar;"));
+       assertReusableAnalyzesTo(tc,a, _T("U.S.A."), _T("u;s;a;"));
+       assertReusesStream(tc,a,_T("dummy"));
+       _CLLDELETE(a);
+
+       a = _CLNEW WhitespaceAnalyzer();
+       assertReusableAnalyzesTo(tc,a, _T("foo bar FOO BAR"), _T("foo;bar;FOO;BAR;"));
+       assertReusableAnalyzesTo(tc,a, _T("C++ 2B"), _T("C++;2B;"));
+       assertReusesStream(tc,a,_T("dummy"));
+       _CLLDELETE(a);
+
+       a = _CLNEW KeywordAnalyzer();
+       assertReusableAnalyzesTo(tc,a, _T("foo bar FOO BAR"), _T("foo bar FOO BAR;"));
+       assertReusableAnalyzesTo(tc,a, _T("U.S.A."), _T("U.S.A.;"));
+       assertReusesStream(tc,a,_T("dummy"));
+       _CLLDELETE(a);
+
+       a = _CLNEW StopAnalyzer();
+       assertReusableAnalyzesTo(tc,a, _T("foo a bar such FOO THESE BAR"), _T("foo;bar;foo;bar;"));
+       assertReusableAnalyzesTo(tc,a, _T("the quick fox"), _T("quick;fox;"));
+       assertReusesStream(tc,a,_T("dummy"));
+       _CLLDELETE(a);
+
+       a = _CLNEW StandardAnalyzer();
+       assertReusableAnalyzesTo(tc,a, _T("The U.S.A. at&t"), _T("usa;at&t;"));
+       assertReusableAnalyzesTo(tc,a, _T("www.example.com"), _T("www.example.com;"));
+       assertReusesStream(tc,a,_T("dummy"));
+       _CLLDELETE(a);
+
+       PerFieldAnalyzerWrapper* pf = _CLNEW PerFieldAnalyzerWrapper(_CLNEW WhitespaceAnalyzer());
+       pf->addAnalyzer(_T("special"), _CLNEW SimpleAnalyzer());
+       StringReader reader(_T("Qwerty Two"));
+       TokenStream* ts = pf->reusableTokenStream(_T("special"), &reader);
+       CL_NS(analysis)::Token token;
+       CLUCENE_ASSERT( ts->next(&token) != NULL );
+       CuAssertStrEquals(tc, _T("token.termBuffer()"), _T("qwerty"), token.termBuffer());
+       StringReader reader2(_T("Qwerty Two"));
+       ts = pf->reusableTokenStream(_T("field"), &reader2);
+       CLUCENE_ASSERT( ts->next(&token) != NULL );
+       CuAssertStrEquals(tc, _T("token.termBuffer()"), _T("Qwerty"), token.termBuffer());
+       assertReusesStream(tc,pf,_T("special"));
+       _CLLDELETE(pf);
+
+       a = _CLNEW NonReusingAnalyzer();
+       assertReusableAnalyzesTo(tc,a, _T("foo BAR"), _T("foo;bar;"));
+       assertReusableAnalyzesTo(tc,a, _T("C++ 2B"), _T("c++;2b;"));
+       _CLLDELETE(a);
+   }
+
    void testEmptyStopList(CuTest *tc)
    {
        const wchar_t* stopWords = { NULL };
@@ -322,6 +390,21 @@
        assertReusableAnalyzesTo(tc,a, _T("[050-070]"), _T("050;-070;") );
        assertReusableAnalyzesTo(tc,a, _T("[050-070]"), _T("050;-070;") );
 
+       assertAnalyzesTo(tc,a, _T("AT&T and O'Reilly's"), _T("at&t;o'reilly;s;") );
+       assertAnalyzesTo(tc,a, _T("U.S.A. version 1.2.3.4 -1.5"), _T("usa;version;1.2.3.4;-1.5;") );
+       assertAnalyzesTo(tc,a, _T("www.example.com mail me@example.com"), _T("www.example.com;mail;me@example.com;") );
+       assertAnalyzesTo(tc,a, _T("B2B under_score"), _T("b2b;under_score;") );
+
+       //tokens that straddle the tokenizer's read blocks
+       std::wstring longText;
+       std::wstring expected;
+       for ( int32_t i=0;i<300;i++ ){
+           longText.append(_T("alpha1 beta_2 "));
+           expected.append(_T("alpha1;beta_2;"));
+       }
+       assertAnalyzesTo(tc,a, longText.c_str(), expected.c_str() );
+       assertReusableAnalyzesTo(tc,a, longText.c_str(), expected.c_str() );
+
        _CLDELETE(a);
    }
 
@@ -461,6 +544,83 @@
 	  CuAssertStrEquals(tc, _T("stringTrim compare"), CL_NS(util)::Misc::wordTrim(testString), _T("t"));
   }
 
+  const wchar_t* commonGramsWords[] = { _T("the"), _T("to"), _T("be"), _T("or"), _T("not"), NULL };
+
+  class CommonGramsTestAnalyzer: public Analyzer {
+      bool query;
+  public:
+      CommonGramsTestAnalyzer(bool _query): query(_query) {}
+      TokenStream* tokenStream(const wchar_t* /*fieldName*/, Reader* reader){
+          CommonGramsFilter* grams = _CLNEW CommonGramsFilter(
+              _CLNEW LowerCaseFilter(_CLNEW WhitespaceTokenizer(reader), true), true, commonGramsWords);
+          if (query)
+              return _CLNEW CommonGramsQueryFilter(grams, true);
+          return grams;
+      }
+  };
+
+  void testCommonGrams(CuTest *tc){
+      CommonGramsTestAnalyzer index(false);
+      assertAnalyzesTo(tc, &index, _T("the quick fox"), _T("the;the_quick;quick;fox;"));
+      assertAnalyzesTo(tc, &index, _T("The Who"), _T("the;the_who;who;"));
+      assertAnalyzesTo(tc, &index, _T("fox jumps over the dog"), _T("fox;jumps;over;over_the;the;the_dog;dog;"));
+      assertAnalyzesTo(tc, &index, _T("to be or not to be"),
+          _T("to;to_be;be;be_or;or;or_not;not;not_to;to;to_be;be;"));
+      assertAnalyzesTo(tc, &index, _T("the"), _T("the;"));
+      assertAnalyzesTo(tc, &index, _T("quick fox"), _T("quick;fox;"));
+
+      CommonGramsTestAnalyzer query(true);
+      assertAnalyzesTo(tc, &query, _T("the quick fox"), _T("the_quick;quick;fox;"));
+      assertAnalyzesTo(tc, &query, _T("The Who"), _T("the_who;"));
+      assertAnalyzesTo(tc, &query, _T("fox jumps over the dog"), _T("fox;jumps;over_the;the_dog;"));
+      assertAnalyzesTo(tc, &query, _T("to be or not to be"), _T("to_be;be_or;or_not;not_to;to_be;"));
+      assertAnalyzesTo(tc, &query, _T("the"), _T("the;"));
+      assertAnalyzesTo(tc, &query, _T("quick fox"), _T("quick;fox;"));
+
+      // offsets and positions of the bigrams
+      StringReader reader(_T("over the dog"));
+      CommonGramsFilter grams(_CLNEW WhitespaceTokenizer(&reader), true, commonGramsWords);
+      CommonGramsQueryFilter filter(&grams, false);
+      Token t;
+      CLUCENE_ASSERT(filter.next(&t) != NULL);
+      CuAssertStrEquals(tc, _T("Token compare"), _T("over_the"), t.termBuffer());
+      CLUCENE_ASSERT(t.startOffset() == 0 && t.endOffset() == 8);
+      CLUCENE_ASSERT(t.getPositionIncrement() == 1);
+      CLUCENE_ASSERT(filter.next(&t) != NULL);
+      CuAssertStrEquals(tc, _T("Token compare"), _T("the_dog"), t.termBuffer());
+      CLUCENE_ASSERT(t.startOffset() == 5 && t.endOffset() == 12);
+      CLUCENE_ASSERT(t.getPositionIncrement() == 1);
+      CLUCENE_ASSERT(filter.next(&t) == NULL);
+  }
+
+  void testCommonGramsPhrase(CuTest *tc){
+      RAMDirectory dir;
+      CommonGramsTestAnalyzer index(false);
+      IndexWriter writer(&dir, &index, true);
+      const wchar_t* docs[] = { _T("to be or not to be that is the question"),
+          _T("not to be"), _T("be or not"), _T("the who sang to the crowd"), NULL };
+      for (int32_t i = 0; docs[i] != NULL; i++){
+          Document doc;
+          doc.add(*_CLNEW Field(_T("f"), docs[i], Field::STORE_NO | Field::INDEX_TOKENIZED));
+          writer.addDocument(&doc);
+      }
+      writer.close();
+
+      IndexSearcher searcher(&dir);
+      CommonGramsTestAnalyzer query(true);
+      const wchar_t* phrases[] = { _T("\"to be or not to be\""), _T("\"not to be\""), _T("\"the who\""),
+          _T("\"to the crowd\""), _T("\"the question\""), _T("\"be not\""), NULL };
+      const int32_t expected[] = { 1, 2, 1, 1, 1, 0 };
+      for (int32_t i = 0; phrases[i] != NULL; i++){
+          Query* q = QueryParser::parse(phrases[i], _T("f"), &query);
+          Hits* h = searcher.search(q);
+          CLUCENE_ASSERT(h->length() == expected[i]);
+          _CLLDELETE(h);
+          _CLLDELETE(q);
+      }
+      searcher.close();
+  }
+
   void testMutipleDocument(CuTest *tc) {
       RAMDirectory dir;
       KeywordAnalyzer a;
@@ -502,6 +662,7 @@ CuSuite *testanalyzers(void)
     // Ported from TestPerFieldAnalzyerWrapper.java + 1 test of our own
     SUITE_ADD_TEST(suite, testPerFieldAnalzyerWrapper);
     SUITE_ADD_TEST(suite, testPerFieldAnalzyerWrapper2);
+    SUITE_ADD_TEST(suite, testReusableTokenStream);
 
 // Still incomplete:
     // Ported from TestKeywordAnalyzer.java
@@ -512,6 +673,8 @@ CuSuite *testanalyzers(void)
 
     SUITE_ADD_TEST(suite, testWordlistLoader);
     SUITE_ADD_TEST(suite, testEmptyStopList);
+    SUITE_ADD_TEST(suite, testCommonGrams);
+    SUITE_ADD_TEST(suite, testCommonGramsPhrase);
     
     // TODO: Remove testStandardAnalyzer and port TestStandardAnalyzer.java as a whole
 
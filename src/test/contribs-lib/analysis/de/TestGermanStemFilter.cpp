@@ -10,6 +10,7 @@
 #include "CLucene/analysis/Analyzers.h"
 #include "CLucene/analysis/de/GermanStemmer.h"
 #include "CLucene/analysis/de/GermanStemFilter.h"
+#include "CLucene/analysis/de/GermanAnalyzer.h"
 #include "CLucene/analysis/standard/StandardTokenizer.h"
 
 CL_NS_USE(util)
@@ -58,8 +59,49 @@ CL_NS_USE2(analysis,de)
     }
   }
 
+  void checkReusable(CuTest* tc, GermanAnalyzer& analyzer, const TCHAR* input, const TCHAR** expected) {
+    StringReader reader(input);
+    TokenStream* ts = analyzer.reusableTokenStream(_T("dummy"), &reader);
+    Token t;
+    for (int32_t i = 0; expected[i] != NULL; i++) {
+      if (ts->next(&t) == NULL)
+        CuFail(tc, _T("Token expected!"));
+      CuAssertStrEquals(tc, _T(""), expected[i], t.termBuffer());
+    }
+    CLUCENE_ASSERT(ts->next(&t) == NULL);
+  }
+
+  const TCHAR* exclusions[] = { _T("tische"), NULL };
+
+  void __cdecl setExclusions(void* analyzer) {
+    ((GermanAnalyzer*)analyzer)->setStemExclusionTable(exclusions);
+    _LUCENE_THREAD_FUNC_RETURN(0);
+  }
+
+  void testReusableTokenStream(CuTest *tc) {
+    GermanAnalyzer analyzer;
+
+    const TCHAR* stemmed[] = { _T("tisch"), _T("hau"), NULL };
+    checkReusable(tc, analyzer, _T("Tische und H\xe4user"), stemmed);
+
+    StringReader reader1(_T("tisch"));
+    TokenStream* ts1 = analyzer.reusableTokenStream(_T("dummy"), &reader1);
+    StringReader reader2(_T("tisch"));
+    TokenStream* ts2 = analyzer.reusableTokenStream(_T("dummy"), &reader2);
+    CLUCENE_ASSERT(ts1 == ts2);
+
+    // Changing the exclusion table on another thread must still reach
+    // the chain cached for this one
+    _LUCENE_THREADID_TYPE thread = _LUCENE_THREAD_CREATE(&setExclusions, &analyzer);
+    _LUCENE_THREAD_JOIN(thread);
+
+    const TCHAR* excluded[] = { _T("tische"), _T("hau"), NULL };
+    checkReusable(tc, analyzer, _T("Tische und H\xe4user"), excluded);
+  }
+
 CuSuite *testGermanAnalyzer() {
   CuSuite *suite = CuSuiteNew(_T("CLucene GermanAnalyzer Test"));
   SUITE_ADD_TEST(suite, testStemming);
+  SUITE_ADD_TEST(suite, testReusableTokenStream);
   return suite;
 }
@@ -11,6 +11,12 @@
 #include "CLucene/index/_SegmentHeader.h"
 #include "CLucene/index/_MultiSegmentReader.h"
 #include "CLucene/index/MultiReader.h"
+#include "CLucene/index/_CompoundFile.h"
+#include "CLucene/index/_IndexFileNames.h"
+#include "CLucene/index/_SegmentInfos.h"
+#include "CLucene/document/FieldSelector.h"
+#include "CLucene/index/StoredFieldVisitor.h"
+#include <CLucene/search/MatchAllDocsQuery.h>
 
 typedef IndexReader* (*TestIRModifyIndex)(CuTest* tc, IndexReader* reader, int modify);
 DEFINE_MUTEX(createReaderMutex)
@@ -300,11 +306,344 @@ void testMultiReaderReopen(CuTest *tc){
   //_CLDELETE(index2B);
 }
 
+void testDocuments(CuTest *tc){
+  RAMDirectory dir;
+  WhitespaceAnalyzer a;
+  IndexWriter writer(&dir, &a, true);
+  writer.setMaxBufferedDocs(10);
+  const int32_t numDocs = 35;
+  for (int32_t i = 0; i < numDocs; i++) {
+    Document doc;
+    std::wstring id = std::to_wstring(i);
+    doc.add(*_CLNEW Field(_T("id"), id.c_str(), Field::STORE_YES | Field::INDEX_UNTOKENIZED));
+    // one document larger than the stored fields docs() reads at once
+    std::wstring body(i == 17 ? 70000 : 10 + i, (wchar_t)(_T('a') + i % 26));
+    doc.add(*_CLNEW Field(_T("body"), body.c_str(), Field::STORE_YES | Field::INDEX_NO));
+    writer.addDocument(&doc);
+  }
+  writer.close();
+
+  IndexReader* reader = IndexReader::open(&dir);
+  CuAssertEquals(tc, numDocs, reader->maxDoc());
+
+  // out of order, across segments, with a repeat
+  int32_t ids[] = { 31, 2, 17, 16, 0, 34, 9, 10, 2, 18, 25 };
+  const int32_t count = sizeof(ids) / sizeof(ids[0]);
+  Document* docs[count];
+  for (int32_t i = 0; i < count; i++)
+    docs[i] = _CLNEW Document;
+  reader->documents(ids, count, docs);
+  for (int32_t i = 0; i < count; i++) {
+    Document expected;
+    reader->document(ids[i], expected);
+    CuAssertStrEquals(tc, _T("id"), expected.get(_T("id")), docs[i]->get(_T("id")));
+    CuAssertStrEquals(tc, _T("body"), expected.get(_T("body")), docs[i]->get(_T("body")));
+    docs[i]->clear();
+  }
+
+  // lazy fields of documents read in a batch still load
+  MapFieldSelector selector;
+  selector.add(_T("id"), FieldSelector::LOAD);
+  selector.add(_T("body"), FieldSelector::LAZY_LOAD);
+  reader->documents(ids, count, docs, &selector);
+  for (int32_t i = 0; i < count; i++) {
+    Document expected;
+    reader->document(ids[i], expected);
+    CuAssertStrEquals(tc, _T("id"), expected.get(_T("id")), docs[i]->get(_T("id")));
+    Field* body = docs[i]->getField(_T("body"));
+    CLUCENE_ASSERT(body != NULL && body->isLazy());
+    CuAssertStrEquals(tc, _T("lazy body"), expected.get(_T("body")), body->stringValue());
+    _CLDELETE(docs[i]);
+  }
+
+  // a page of hits
+  IndexSearcher searcher(reader);
+  MatchAllDocsQuery q;
+  Hits* hits = searcher.search(&q);
+  CuAssertEquals(tc, numDocs, (int32_t)hits->length());
+  hits->loadDocs(5, 20);
+  for (int32_t n = 0; n < numDocs; n++) {
+    Document expected;
+    reader->document(hits->id(n), expected);
+    CuAssertStrEquals(tc, _T("hit"), expected.get(_T("id")), hits->doc(n).get(_T("id")));
+  }
+  _CLDELETE(hits);
+  searcher.close();
+
+  reader->close();
+  _CLDELETE(reader);
+}
+
+void testSegmentNorms(CuTest *tc){
+  RAMDirectory multiDir;
+  RAMDirectory singleDir;
+  createIndex(tc, &multiDir, true);
+  createIndex(tc, &singleDir, false);
+
+  IndexReader* multi = IndexReader::open(&multiDir);
+  IndexReader* single = IndexReader::open(&singleDir);
+  CLUCENE_ASSERT(multi->getSubReaders() != NULL && multi->getSubReaders()->length > 1);
+  CLUCENE_ASSERT(single->getSubReaders() == NULL);
+
+  // a changed norm is seen by the segment and by the whole index
+  multi->setNorm(44, _T("field2"), (uint8_t)222);
+  single->setNorm(44, _T("field2"), (uint8_t)222);
+  CuAssertEquals(tc, 222, (int32_t)multi->norms(_T("field2"))[44]);
+  CuAssertEquals(tc, 222, (int32_t)single->norms(_T("field2"))[44]);
+
+  // scoring each segment with its own norms gives the scores of the optimized index
+  BooleanQuery q;
+  const wchar_t* terms[] = { _T("b44"), _T("a3"), _T("b57"), _T("a98") };
+  for (int32_t i = 0; i < 4; i++) {
+    Term* t = _CLNEW Term(_T("field2"), terms[i]);
+    q.add(_CLNEW TermQuery(t), true, BooleanClause::SHOULD);
+    _CLDECDELETE(t);
+  }
+  IndexSearcher multiSearcher(multi);
+  IndexSearcher singleSearcher(single);
+  Hits* multiHits = multiSearcher.search(&q);
+  Hits* singleHits = singleSearcher.search(&q);
+  CuAssertEquals(tc, 4, (int32_t)multiHits->length());
+  CuAssertEquals(tc, (int32_t)singleHits->length(), (int32_t)multiHits->length());
+  CuAssertEquals(tc, 44, multiHits->id(0));
+  for (size_t i = 0; i < multiHits->length(); i++) {
+    CuAssertEquals(tc, singleHits->id(i), multiHits->id(i));
+    CLUCENE_ASSERT(singleHits->score(i) == multiHits->score(i));
+
+    Explanation multiExplanation;
+    Explanation singleExplanation;
+    multiSearcher.explain(&q, multiHits->id(i), &multiExplanation);
+    singleSearcher.explain(&q, singleHits->id(i), &singleExplanation);
+    CLUCENE_ASSERT(multiExplanation.getDetail(0)->getValue() == singleExplanation.getDetail(0)->getValue());
+  }
+  _CLDELETE(multiHits);
+  _CLDELETE(singleHits);
+  multiSearcher.close();
+  singleSearcher.close();
+
+  multi->close();
+  _CLDELETE(multi);
+  single->close();
+  _CLDELETE(single);
+}
+
+// checks getMappedBytes of the norms file of a segment, read directly or from its compound file
+void checkMappedNormsFile(CuTest *tc, Directory* dir, const std::wstring& segmentName, bool compound){
+  std::wstring normsName = segmentName + _T(".") + IndexFileNames::NORMS_EXTENSION;
+  CompoundFileReader* cfs = NULL;
+  IndexInput* in;
+  if (compound) {
+    std::wstring cfsName = segmentName + _T(".") + IndexFileNames::COMPOUND_FILE_EXTENSION;
+    cfs = _CLNEW CompoundFileReader(dir, cfsName.c_str());
+    in = ((Directory*)cfs)->openInput(normsName.c_str());
+    CLUCENE_ASSERT(in->getObjectName() == _T("CSIndexInput"));
+  } else {
+    in = dir->openInput(normsName.c_str());
+  }
+
+  int32_t len = (int32_t)in->length();
+  uint8_t* bytes = _CL_NEWARRAY(uint8_t, len);
+  in->readBytes(bytes, len);
+  const uint8_t* mapped = in->getMappedBytes(0, len);
+#ifdef LUCENE_FS_MMAP
+  CLUCENE_ASSERT(mapped != NULL);
+  CLUCENE_ASSERT(memcmp(bytes, mapped, len) == 0);
+  CLUCENE_ASSERT(in->getMappedBytes(1, len - 1) == mapped + 1);
+  CuAssertEquals(tc, len, (int32_t)in->getFilePointer());
+#else
+  CLUCENE_ASSERT(mapped == NULL);
+#endif
+  // nothing outside the file is mapped
+  CLUCENE_ASSERT(in->getMappedBytes(1, len) == NULL);
+  CLUCENE_ASSERT(in->getMappedBytes(-1, 1) == NULL);
+  _CLDELETE_ARRAY(bytes);
+
+  in->close();
+  _CLDELETE(in);
+  if (cfs != NULL) {
+    cfs->close();
+    _CLDELETE(cfs);
+  }
+}
+
+void testMappedNorms(CuTest *tc){
+  wchar_t fsdir[CL_MAX_PATH];
+  _snwprintf(fsdir, CL_MAX_PATH, L"%s/%s", cl_tempDir, L"test.mappednorms");
+
+  for (int32_t pass = 0; pass < 2; pass++) {
+    bool compound = pass == 1;
+    FSDirectory* dir = FSDirectory::getDirectory(fsdir);
+    dir->setUseMMap(true);
+
+    WhitespaceAnalyzer whitespaceAnalyzer;
+    IndexWriter* w = _CLNEW IndexWriter(dir, &whitespaceAnalyzer, true);
+    w->setMergePolicy(_CLNEW LogDocMergePolicy());
+    w->setUseCompoundFile(compound);
+    Document doc;
+    for (int32_t i = 0; i < 100; i++) {
+      createDocument(doc, i, 4);
+      w->addDocument(&doc);
+      if (i == 49)
+        w->flush();
+    }
+    w->close();
+    _CLDELETE(w);
+
+    SegmentInfos infos;
+    infos.read(dir);
+    CuAssertEquals(tc, 2, infos.size());
+    std::wstring firstName = infos.info(0)->name;
+    checkMappedNormsFile(tc, dir, firstName, compound);
+    checkMappedNormsFile(tc, dir, infos.info(1)->name, compound);
+
+    IndexReader* reader = IndexReader::open(dir);
+    const ArrayBase<IndexReader*>* subReaders = reader->getSubReaders();
+    CuAssertEquals(tc, 2, (int32_t)subReaders->length);
+    SegmentReader* first = (SegmentReader*)(*subReaders)[0];
+    SegmentReader* second = (SegmentReader*)(*subReaders)[1];
+
+    uint8_t field1[100];
+    uint8_t field2[100];
+    memcpy(field1, first->norms(_T("field1")), 50);
+    memcpy(field1 + 50, second->norms(_T("field1")), 50);
+    memcpy(field2, first->norms(_T("field2")), 50);
+    memcpy(field2 + 50, second->norms(_T("field2")), 50);
+    CLUCENE_ASSERT(memcmp(field1, reader->norms(_T("field1")), 100) == 0);
+
+    // a second reader changes a norm of each segment and commits it
+    IndexReader* modifier = IndexReader::open(dir);
+    modifier->setNorm(44, _T("field2"), (uint8_t)222);
+    modifier->setNorm(57, _T("field2"), (uint8_t)111);
+    modifier->close();
+    _CLDELETE(modifier);
+
+    // the reopened segments take over the unchanged norms, and the mapping
+    // they may point into, from the reader they replace, which is then closed
+    IndexReader* reopened = reader->reopen();
+    CLUCENE_ASSERT(reopened != reader);
+    reader->close();
+    _CLDELETE(reader);
+    subReaders = reopened->getSubReaders();
+    first = (SegmentReader*)(*subReaders)[0];
+    second = (SegmentReader*)(*subReaders)[1];
+    CLUCENE_ASSERT(memcmp(field1, first->norms(_T("field1")), 50) == 0);
+    CLUCENE_ASSERT(memcmp(field1 + 50, second->norms(_T("field1")), 50) == 0);
+    field2[44] = 222;
+    field2[57] = 111;
+    CLUCENE_ASSERT(memcmp(field2, first->norms(_T("field2")), 50) == 0);
+    CLUCENE_ASSERT(memcmp(field2 + 50, second->norms(_T("field2")), 50) == 0);
+
+    // changing a mapped norm copies the norms, and leaves the file alone
+    uint8_t* before = first->norms(_T("field1"));
+    reopened->setNorm(3, _T("field1"), (uint8_t)77);
+    uint8_t* after = first->norms(_T("field1"));
+#ifdef LUCENE_FS_MMAP
+    CLUCENE_ASSERT(before != after);
+#else
+    CLUCENE_ASSERT(before == after);
+#endif
+    CuAssertEquals(tc, 77, (int32_t)after[3]);
+    CLUCENE_ASSERT(memcmp(field1 + 4, after + 4, 46) == 0);
+    checkMappedNormsFile(tc, dir, firstName, compound);
+    reopened->close();
+    _CLDELETE(reopened);
+
+    // and the committed change is read back
+    reader = IndexReader::open(dir);
+    field1[3] = 77;
+    CLUCENE_ASSERT(memcmp(field1, reader->norms(_T("field1")), 100) == 0);
+    CLUCENE_ASSERT(memcmp(field2, reader->norms(_T("field2")), 100) == 0);
+    reader->close();
+    _CLDELETE(reader);
+
+    dir->close();
+    _CLDECDELETE(dir);
+  }
+}
+
+class IdVisitor: public StoredFieldVisitor {
+public:
+  std::string id;
+  int32_t fieldsAfterId;
+  IdVisitor(): fieldsAfterId(0) {}
+  Status needsField(const wchar_t* field) {
+    if (!id.empty()) {
+      fieldsAfterId++;
+      return STOP;
+    }
+    return wcscmp(field, _T("id")) == 0 ? YES : NO;
+  }
+  void stringField(const wchar_t* /*field*/, const int /*config*/, const uint8_t* utf8, const int32_t length) {
+    id.assign((const char*)utf8, length);
+  }
+};
+
+void testVisitDocument(CuTest *tc){
+  for (int32_t pass = 0; pass < 2; pass++) {
+    RAMDirectory dir;
+    WhitespaceAnalyzer a;
+    IndexWriter writer(&dir, &a, true);
+    writer.setMaxBufferedDocs(7);
+    if (pass == 1)
+      writer.setStoredFieldsCompression(IndexWriter::STORED_FIELDS_FAST);
+    const int32_t numDocs = 20;
+    for (int32_t i = 0; i < numDocs; i++) {
+      Document doc;
+      std::wstring body = _T("caf\u00e9 \u4e2d\u6587 ") + std::to_wstring(i);
+      doc.add(*_CLNEW Field(_T("body"), body.c_str(), Field::STORE_YES | Field::INDEX_TOKENIZED | Field::TERMVECTOR_YES));
+      doc.add(*_CLNEW Field(_T("id"), std::to_wstring(i).c_str(), Field::STORE_YES | Field::INDEX_UNTOKENIZED));
+      doc.add(*_CLNEW Field(_T("packed"), body.c_str(), Field::STORE_COMPRESS | Field::INDEX_NO));
+      ValueArray<uint8_t>* bin = _CLNEW ValueArray<uint8_t>(2);
+      bin->values[0] = (uint8_t)i;
+      bin->values[1] = 0;
+      doc.add(*_CLNEW Field(_T("bin"), bin, Field::STORE_YES, false));
+      writer.addDocument(&doc);
+    }
+    writer.close();
+
+    IndexReader* reader = IndexReader::open(&dir);
+    for (int32_t n = 0; n < numDocs; n++) {
+      Document expected;
+      reader->document(n, expected);
+
+      Document visited;
+      DocumentStoredFieldVisitor visitor(&visited);
+      reader->visitDocument(n, &visitor);
+      const wchar_t* names[] = { _T("body"), _T("id"), _T("packed") };
+      for (int32_t i = 0; i < 3; i++) {
+        Field* f = visited.getField(names[i]);
+        Field* e = expected.getField(names[i]);
+        CLUCENE_ASSERT(f != NULL);
+        CuAssertStrEquals(tc, names[i], e->stringValue(), f->stringValue());
+        CuAssertEquals(tc, e->isTokenized(), f->isTokenized());
+        CuAssertEquals(tc, e->isIndexed(), f->isIndexed());
+        CuAssertEquals(tc, e->isCompressed(), f->isCompressed());
+        CuAssertEquals(tc, e->isTermVectorStored(), f->isTermVectorStored());
+      }
+      const ValueArray<uint8_t>* bin = visited.getField(_T("bin"))->binaryValue();
+      CuAssertEquals(tc, (int32_t)2, (int32_t)bin->length);
+      CuAssertEquals(tc, n, (int32_t)bin->values[0]);
+
+      // stopping after the id skips the fields after it
+      IdVisitor ids;
+      reader->visitDocument(n, &ids);
+      CLUCENE_ASSERT(ids.fieldsAfterId <= 1);
+      CLUCENE_ASSERT(ids.id == std::to_string(n));
+    }
+    reader->close();
+    _CLDELETE(reader);
+  }
+}
+
 CuSuite *testindexreader(void)
 {
 	CuSuite *suite = CuSuiteNew(_T("CLucene IndexReader Test"));
   SUITE_ADD_TEST(suite, testIndexReaderReopen);
   SUITE_ADD_TEST(suite, testMultiReaderReopen);
+  SUITE_ADD_TEST(suite, testDocuments);
+  SUITE_ADD_TEST(suite, testVisitDocument);
+  SUITE_ADD_TEST(suite, testSegmentNorms);
+  SUITE_ADD_TEST(suite, testMappedNorms);
 
   return suite;
 }
@@ -8,6 +8,9 @@
 ------------------------------------------------------------------------------*/
 #include "test.h"
 #include <CLucene/search/MatchAllDocsQuery.h>
+#include "CLucene/index/_SegmentHeader.h"
+#include "CLucene/index/_MultiSegmentReader.h"
+#include "CLucene/index/_SkipListReader.h"
 #include <stdio.h>
 
 //checks if a merged index finds phrases correctly
@@ -647,6 +650,368 @@ void testMergeIndex(CuTest* tc) {
   _CLLDELETE( dir );
 }
 
+void testGetReader(CuTest* tc) {
+    RAMDirectory dir;
+    WhitespaceAnalyzer a;
+    IndexWriter writer(&dir, false, &a, true);
+    writer.setMaxBufferedDocs(3);
+
+    wchar_t buf[10];
+    for (int32_t i = 0; i < 10; i++) {
+        Document doc;
+        _i64tot(i, buf, 10);
+        doc.add(*_CLNEW Field(_T("id"), buf, Field::STORE_YES | Field::INDEX_UNTOKENIZED));
+        writer.addDocument(&doc);
+    }
+
+    // the buffered documents are visible although nothing is committed
+    IndexReader* reader = writer.getReader();
+    CuAssertEquals(tc, 10, reader->numDocs());
+    CLUCENE_ASSERT(reader->isCurrent());
+    IndexReader* committed = IndexReader::open(&dir);
+    CuAssertEquals(tc, 0, committed->numDocs());
+    committed->close();
+    _CLDELETE(committed);
+
+    // so are buffered deletes, once the reader is reopened
+    Term* t = _CLNEW Term(_T("id"), _T("4"));
+    writer.deleteDocuments(t);
+    _CLDECDELETE(t);
+    for (int32_t i = 10; i < 15; i++) {
+        Document doc;
+        _i64tot(i, buf, 10);
+        doc.add(*_CLNEW Field(_T("id"), buf, Field::STORE_YES | Field::INDEX_UNTOKENIZED));
+        writer.addDocument(&doc);
+    }
+    CLUCENE_ASSERT(!reader->isCurrent());
+    IndexReader* refreshed = reader->reopen();
+    CLUCENE_ASSERT(refreshed != reader);
+    reader->close();
+    _CLDELETE(reader);
+    reader = refreshed;
+    CuAssertEquals(tc, 14, reader->numDocs());
+    Term deleted(_T("id"), _T("4"));
+    TermDocs* td = reader->termDocs(&deleted);
+    CLUCENE_ASSERT(!td->next());
+    _CLDELETE(td);
+    Term added(_T("id"), _T("14"));
+    CuAssertEquals(tc, 1, reader->docFreq(&added));
+    Document stored;
+    reader->document(reader->maxDoc() - 1, stored);
+    CuAssertStrEquals(tc, _T("id"), _T("14"), stored.get(_T("id")));
+
+    // nothing changed: the same reader is returned
+    CLUCENE_ASSERT(reader->reopen() == reader);
+
+    // the writer owns the index, not the reader
+    try {
+        reader->deleteDocument(0);
+        CuFail(tc, _T("expected deleting through a getReader() reader to fail"));
+    } catch (CLuceneError& err) {
+        CuAssertEquals(tc, CL_ERR_UnsupportedOperation, err.number());
+    }
+
+    reader->close();
+    _CLDELETE(reader);
+    writer.close();
+
+    reader = IndexReader::open(&dir);
+    CuAssertEquals(tc, 14, reader->numDocs());
+    reader->close();
+    _CLDELETE(reader);
+    dir.close();
+}
+
+void testGetReaderOutlivesWriter(CuTest* tc) {
+    RAMDirectory dir;
+    WhitespaceAnalyzer a;
+    IndexWriter* writer = _CLNEW IndexWriter(&dir, false, &a, true);
+
+    wchar_t buf[10];
+    for (int32_t i = 0; i < 5; i++) {
+        Document doc;
+        _i64tot(i, buf, 10);
+        doc.add(*_CLNEW Field(_T("id"), buf, Field::STORE_YES | Field::INDEX_UNTOKENIZED));
+        writer->addDocument(&doc);
+    }
+    IndexReader* reader = writer->getReader();
+    IndexReader* closed = writer->getReader();
+    closed->close();
+    _CLDELETE(closed);
+
+    writer->close();
+    _CLDELETE(writer);
+
+    // the reader still searches its segments, but has no writer to ask
+    CuAssertEquals(tc, 5, reader->numDocs());
+    try {
+        reader->isCurrent();
+        CuFail(tc, _T("expected isCurrent to fail once the writer is gone"));
+    } catch (CLuceneError& err) {
+        CuAssertEquals(tc, CL_ERR_AlreadyClosed, err.number());
+    }
+    try {
+        reader->reopen();
+        CuFail(tc, _T("expected reopen to fail once the writer is gone"));
+    } catch (CLuceneError& err) {
+        CuAssertEquals(tc, CL_ERR_AlreadyClosed, err.number());
+    }
+    reader->close();
+    _CLDELETE(reader);
+    dir.close();
+}
+
+static std::wstring storedBody(int32_t i) {
+    wchar_t buf[20];
+    _i64tot(i, buf, 10);
+    std::wstring body = _T("stored fields of document ");
+    body += buf;
+    body += _T(" are compressed in chunks with the stored fields of the documents next to it");
+    if (i % 50 == 7)
+        body.append(20000, (wchar_t)(_T('a') + i % 26)); // larger than a chunk
+    return body;
+}
+
+static void addStoredDocs(IndexWriter& writer, int32_t from, int32_t to) {
+    wchar_t buf[20];
+    for (int32_t i = from; i < to; i++) {
+        Document doc;
+        _i64tot(i, buf, 10);
+        doc.add(*_CLNEW Field(_T("id"), buf, Field::STORE_YES | Field::INDEX_UNTOKENIZED));
+        const std::wstring body = storedBody(i);
+        doc.add(*_CLNEW Field(_T("body"), body.c_str(), Field::STORE_YES | Field::INDEX_TOKENIZED));
+        doc.add(*_CLNEW Field(_T("compressed"), body.c_str(), Field::STORE_COMPRESS | Field::INDEX_NO));
+        ValueArray<uint8_t>* bin = _CLNEW ValueArray<uint8_t>(3);
+        bin->values[0] = (uint8_t)i;
+        bin->values[1] = (uint8_t)(i >> 8);
+        bin->values[2] = 0xFF;
+        doc.add(*_CLNEW Field(_T("bin"), bin, Field::STORE_YES, false));
+        writer.addDocument(&doc);
+    }
+}
+
+static void checkStoredDocs(CuTest* tc, Directory* dir, int32_t numDocs) {
+    IndexReader* reader = IndexReader::open(dir);
+    CuAssertEquals(tc, numDocs, reader->maxDoc());
+
+    // read in index order, then jumping between chunks
+    for (int32_t pass = 0; pass < 2; pass++) {
+        for (int32_t n = 0; n < numDocs; n++) {
+            const int32_t docId = pass == 0 ? n : (int32_t)(((int64_t)n * 7919) % numDocs);
+            Document doc;
+            reader->document(docId, doc);
+            const int32_t i = _wtoi(doc.get(_T("id")));
+            const std::wstring body = storedBody(i);
+            CuAssertStrEquals(tc, _T("body"), body.c_str(), doc.get(_T("body")));
+            CuAssertStrEquals(tc, _T("compressed"), body.c_str(), doc.get(_T("compressed")));
+            const ValueArray<uint8_t>* bin = doc.getField(_T("bin"))->binaryValue();
+            CuAssertEquals(tc, (int32_t)3, (int32_t)bin->length);
+            CuAssertEquals(tc, (int32_t)(uint8_t)i, (int32_t)bin->values[0]);
+            CuAssertEquals(tc, (int32_t)(uint8_t)(i >> 8), (int32_t)bin->values[1]);
+            CuAssertEquals(tc, (int32_t)0xFF, (int32_t)bin->values[2]);
+        }
+    }
+    reader->close();
+    _CLDELETE(reader);
+}
+
+void testStoredFieldsCompression(CuTest* tc) {
+    const int32_t modes[] = { IndexWriter::STORED_FIELDS_FAST, IndexWriter::STORED_FIELDS_HIGH_COMPRESSION };
+    for (int32_t m = 0; m < 2; m++) {
+        RAMDirectory dir;
+        WhitespaceAnalyzer a;
+        IndexWriter* writer = _CLNEW IndexWriter(&dir, &a, true);
+        writer->setMaxBufferedDocs(100);
+        writer->setMergeFactor(50);
+        writer->setStoredFieldsCompression(modes[m]);
+        CuAssertEquals(tc, modes[m], writer->getStoredFieldsCompression());
+        addStoredDocs(*writer, 0, 350);
+        writer->close();
+        _CLDELETE(writer);
+        checkStoredDocs(tc, &dir, 350);
+
+        // merging compressed segments
+        writer = _CLNEW IndexWriter(&dir, &a, false);
+        writer->setStoredFieldsCompression(modes[m]);
+        writer->optimize();
+        writer->close();
+        _CLDELETE(writer);
+        checkStoredDocs(tc, &dir, 350);
+        dir.close();
+    }
+
+    // segments written without compression are merged into compressed ones and back
+    RAMDirectory dir;
+    WhitespaceAnalyzer a;
+    IndexWriter* writer = _CLNEW IndexWriter(&dir, &a, true);
+    writer->setMaxBufferedDocs(100);
+    writer->setMergeFactor(50);
+    addStoredDocs(*writer, 0, 150);
+    writer->setStoredFieldsCompression(IndexWriter::STORED_FIELDS_FAST);
+    addStoredDocs(*writer, 150, 300);
+    writer->flush();
+    checkStoredDocs(tc, &dir, 300);
+    writer->optimize();
+    writer->close();
+    _CLDELETE(writer);
+    checkStoredDocs(tc, &dir, 300);
+
+    writer = _CLNEW IndexWriter(&dir, &a, false);
+    addStoredDocs(*writer, 300, 320);
+    writer->optimize();
+    try {
+        writer->setStoredFieldsCompression(5);
+        CuFail(tc, _T("expected an invalid stored fields compression to fail"));
+    } catch (CLuceneError& err) {
+        CuAssertEquals(tc, CL_ERR_IllegalArgument, err.number());
+    }
+    writer->close();
+    _CLDELETE(writer);
+    checkStoredDocs(tc, &dir, 320);
+    dir.close();
+}
+
+static void checkSkipTo(CuTest* tc, IndexReader* reader, const TCHAR* text, int32_t step) {
+    Term* t = _CLNEW Term(_T("body"), text);
+    const int32_t maxDoc = reader->maxDoc();
+    for (int32_t round = 0; round < 2; round++) {
+        TermDocs* termDocs = reader->termDocs(t);
+        for (int32_t target = 0; target < maxDoc; target += 37 + round) {
+            const int32_t expected = ((target + step - 1) / step) * step;
+            if (expected >= maxDoc) {
+                CuAssertTrue(tc, !termDocs->skipTo(target));
+                break;
+            }
+            CuAssertTrue(tc, termDocs->skipTo(target));
+            CuAssertEquals(tc, expected, termDocs->doc());
+            // a few postings after each skip
+            if (termDocs->next())
+                CuAssertEquals(tc, expected + step, termDocs->doc());
+        }
+        termDocs->close();
+        _CLDELETE(termDocs);
+    }
+    _CLDECDELETE(t);
+}
+
+/** The skip list caches of the segments of a reader, added up */
+struct SkipListCacheStats {
+    int32_t segments;
+    int64_t hits;
+    int64_t misses;
+    size_t size;
+
+    SkipListCacheStats(IndexReader* reader): segments(0), hits(0), misses(0), size(0) {
+        if (reader->instanceOf(MultiSegmentReader::getClassName())) {
+            const CL_NS(util)::ArrayBase<IndexReader*>& subReaders = *((MultiSegmentReader*) reader)->getSubReaders();
+            for (size_t i = 0; i < subReaders.length; i++)
+                add((SegmentReader*) subReaders[i]);
+        } else
+            add((SegmentReader*) reader);
+    }
+    void add(SegmentReader* segment) {
+        segments++;
+        SkipListCache* cache = segment->getSkipListCache();
+        if (cache != NULL) {
+            hits += cache->getHitCount();
+            misses += cache->getMissCount();
+            size += cache->size();
+        }
+    }
+};
+
+static void checkSkipLists(CuTest* tc, Directory* dir) {
+    IndexReader* reader = IndexReader::open(dir);
+    CuAssertEquals(tc, (int32_t)0, (int32_t)reader->getSkipListCacheSize());
+    checkSkipTo(tc, reader, _T("all"), 1);
+    checkSkipTo(tc, reader, _T("three"), 3);
+    checkSkipTo(tc, reader, _T("rare"), 18);
+
+    reader->setSkipListCache(1 << 20, 150);
+    CuAssertEquals(tc, (int32_t)(1 << 20), (int32_t)reader->getSkipListCacheSize());
+    CuAssertEquals(tc, (int32_t)150, reader->getSkipListCacheMinDocFreq());
+    // the first round decodes the list of each segment, the second finds it
+    checkSkipTo(tc, reader, _T("all"), 1);
+    SkipListCacheStats stats(reader);
+    CuAssertEquals(tc, stats.segments, (int32_t)stats.misses);
+    CuAssertEquals(tc, stats.segments, (int32_t)stats.hits);
+    CuAssertEquals(tc, stats.segments, (int32_t)stats.size);
+    checkSkipTo(tc, reader, _T("three"), 3);
+    stats = SkipListCacheStats(reader);
+    CuAssertEquals(tc, 2 * stats.segments, (int32_t)stats.hits);
+    CuAssertEquals(tc, 2 * stats.segments, (int32_t)stats.size);
+    // terms in fewer documents than minDocFreq skip through the .frq file
+    checkSkipTo(tc, reader, _T("rare"), 18);
+    SkipListCacheStats rare(reader);
+    CuAssertEquals(tc, (int32_t)stats.misses, (int32_t)rare.misses);
+    CuAssertEquals(tc, (int32_t)stats.hits, (int32_t)rare.hits);
+    CuAssertEquals(tc, (int32_t)stats.size, (int32_t)rare.size);
+
+    reader->close();
+    _CLDELETE(reader);
+}
+
+void testSkipLists(CuTest* tc) {
+    RAMDirectory dir;
+    WhitespaceAnalyzer a;
+    IndexWriter* writer = _CLNEW IndexWriter(&dir, &a, true);
+    CuAssertEquals(tc, IndexWriter::DEFAULT_SKIP_INTERVAL, writer->getSkipInterval());
+    CuAssertEquals(tc, IndexWriter::DEFAULT_MAX_SKIP_LEVELS, writer->getMaxSkipLevels());
+    writer->setMaxBufferedDocs(700);
+    writer->setMergeFactor(50);
+    writer->setSkipInterval(4);
+    writer->setMaxSkipLevels(3);
+    CuAssertEquals(tc, (int32_t)4, writer->getSkipInterval());
+    CuAssertEquals(tc, (int32_t)3, writer->getMaxSkipLevels());
+    try {
+        writer->setSkipInterval(1);
+        CuFail(tc, _T("expected a skip interval of 1 to fail"));
+    } catch (CLuceneError& err) {
+        CuAssertEquals(tc, CL_ERR_IllegalArgument, err.number());
+    }
+    try {
+        writer->setMaxSkipLevels(0);
+        CuFail(tc, _T("expected no skip levels to fail"));
+    } catch (CLuceneError& err) {
+        CuAssertEquals(tc, CL_ERR_IllegalArgument, err.number());
+    }
+
+    for (int32_t i = 0; i < 2000; i++) {
+        Document doc;
+        std::wstring body(i % 3 == 0 ? _T("all three") : _T("all"));
+        if (i % 18 == 0)
+            body.append(_T(" rare"));
+        doc.add(*_CLNEW Field(_T("body"), body.c_str(), Field::STORE_NO | Field::INDEX_TOKENIZED));
+        writer->addDocument(&doc);
+    }
+    writer->flush();
+    checkSkipLists(tc, &dir);
+
+    // reopened readers keep the cache settings
+    IndexReader* reader = IndexReader::open(&dir);
+    reader->setSkipListCache(1 << 16, 100);
+    Document doc;
+    doc.add(*_CLNEW Field(_T("body"), _T("all"), Field::STORE_NO | Field::INDEX_TOKENIZED));
+    writer->addDocument(&doc);
+    writer->flush();
+    IndexReader* reopened = reader->reopen();
+    CuAssertTrue(tc, reopened != reader);
+    CuAssertEquals(tc, (int32_t)(1 << 16), (int32_t)reopened->getSkipListCacheSize());
+    CuAssertEquals(tc, (int32_t)100, reopened->getSkipListCacheMinDocFreq());
+    reopened->close();
+    _CLDELETE(reopened);
+    reader->close();
+    _CLDELETE(reader);
+
+    // merged with the default skip interval
+    writer->setSkipInterval(IndexWriter::DEFAULT_SKIP_INTERVAL);
+    writer->optimize();
+    writer->close();
+    _CLDELETE(writer);
+    checkSkipLists(tc, &dir);
+    dir.close();
+}
+
 CuSuite *testindexwriter(void)
 {
     CuSuite *suite = CuSuiteNew(_T("CLucene IndexWriter Test"));
@@ -664,6 +1029,10 @@ CuSuite *testindexwriter(void)
     SUITE_ADD_TEST(suite, testExceptionFromTokenStream);
     SUITE_ADD_TEST(suite, testDeleteDocument);
     SUITE_ADD_TEST(suite, testMergeIndex);
+    SUITE_ADD_TEST(suite, testGetReader);
+    SUITE_ADD_TEST(suite, testGetReaderOutlivesWriter);
+    SUITE_ADD_TEST(suite, testStoredFieldsCompression);
+    SUITE_ADD_TEST(suite, testSkipLists);
 
     return suite;
 }
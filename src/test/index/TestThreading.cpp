@@ -11,6 +11,7 @@
 #include "CLucene/index/_SegmentHeader.h"
 #include "CLucene/index/_MultiSegmentReader.h"
 #include "CLucene/index/MultiReader.h"
+#include "CLucene/index/IndexingPipeline.h"
 #include <stdio.h>
 
 
@@ -170,12 +171,265 @@ void testFSThreading(CuTest *tc)
     _CLDECDELETE(directory);
 }
 
+#define CONCURRENT_FLUSH_THREADS 4
+#define CONCURRENT_FLUSH_DOCS 200
+struct ConcurrentFlushArgs {
+    IndexWriter* writer;
+    int32_t thread;
+};
+bool concurrentFlushFailed = false;
+void __cdecl concurrentFlushIndexer(void* _args)
+{
+    ConcurrentFlushArgs* args = (ConcurrentFlushArgs*)_args;
+    try {
+        wchar_t buf[30];
+        std::wstring sb;
+        for (int32_t i = 0; i < CONCURRENT_FLUSH_DOCS; i++) {
+            const int32_t id = args->thread * CONCURRENT_FLUSH_DOCS + i;
+            Document d;
+            _i64tot(id, buf, 10);
+            d.add(*_CLNEW Field(_T("id"), buf, Field::STORE_YES | Field::INDEX_UNTOKENIZED));
+            sb.clear();
+            English::IntToEnglish(id, sb);
+            d.add(*_CLNEW Field(_T("contents"), sb.c_str(), Field::STORE_YES | Field::INDEX_TOKENIZED));
+            args->writer->addDocument(&d);
+
+            // Replace some docs again, so that delete terms
+            // buffered while a segment is flushed must still
+            // reach the docs in that segment
+            if (i % 4 == 0) {
+                Term* t = _CLNEW Term(_T("id"), buf);
+                args->writer->updateDocument(t, &d);
+                _CLDECDELETE(t);
+            }
+        }
+    }
+    catch (CLuceneError& e) {
+        fprintf(stderr, "concurrent flush: #%d: %s\n", e.number(), e.what());
+        concurrentFlushFailed = true;
+    }
+
+    _LUCENE_THREAD_FUNC_RETURN(0);
+}
+
+/*
+  Several threads adding and updating documents with a writer that
+  flushes every few documents into compound files, so threads go on
+  indexing the next segment while the previous one is written.
+  Without autoCommit, the segments share the doc store being written.
+ */
+void runConcurrentFlush(CuTest *tc, bool autoCommit)
+{
+    RAMDirectory directory;
+    SimpleAnalyzer analyzer;
+    IndexWriter writer(&directory, autoCommit, &analyzer, true);
+    writer.setMaxBufferedDocs(7);
+    writer.setUseCompoundFile(true);
+
+    ConcurrentFlushArgs args[CONCURRENT_FLUSH_THREADS];
+    _LUCENE_THREADID_TYPE threads[CONCURRENT_FLUSH_THREADS];
+    for (int32_t i = 0; i < CONCURRENT_FLUSH_THREADS; i++) {
+        args[i].writer = &writer;
+        args[i].thread = i;
+        threads[i] = _LUCENE_THREAD_CREATE(&concurrentFlushIndexer, &args[i]);
+    }
+    for (int32_t i = 0; i < CONCURRENT_FLUSH_THREADS; i++)
+        _LUCENE_THREAD_JOIN(threads[i]);
+    CuAssert(tc, _T("hit unexpected exception in one of the threads\n"), !concurrentFlushFailed);
+
+    writer.close();
+
+    IndexReader* reader = IndexReader::open(&directory);
+    const int32_t numDocs = CONCURRENT_FLUSH_THREADS * CONCURRENT_FLUSH_DOCS;
+    CuAssertEquals(tc, numDocs, reader->numDocs());
+
+    // every id made it in exactly once, with its own stored contents
+    bool* seen = _CL_NEWARRAY(bool, numDocs);
+    for (int32_t i = 0; i < numDocs; i++)
+        seen[i] = false;
+    std::wstring sb;
+    for (int32_t i = 0; i < reader->maxDoc(); i++) {
+        if (reader->isDeleted(i))
+            continue;
+        Document doc;
+        reader->document(i, doc);
+        const int32_t id = _ttoi(doc.get(_T("id")));
+        CLUCENE_ASSERT(id >= 0 && id < numDocs && !seen[id]);
+        seen[id] = true;
+        sb.clear();
+        English::IntToEnglish(id, sb);
+        CuAssertStrEquals(tc, _T("contents"), sb.c_str(), doc.get(_T("contents")));
+    }
+    _CLDELETE_ARRAY(seen);
+
+    reader->close();
+    _CLDELETE(reader);
+    directory.close();
+}
+
+void testConcurrentFlush(CuTest *tc)
+{
+    runConcurrentFlush(tc, true);
+    runConcurrentFlush(tc, false);
+}
+
+class CountingBatchListener: public IndexingPipeline::BatchListener {
+public:
+    DEFINE_MUTEX(THIS_LOCK)
+    int32_t batches, docs, failed;
+    CountingBatchListener(): batches(0), docs(0), failed(0) {}
+    void batchCompleted(int64_t /*batchId*/, int32_t numDocs, int32_t numFailed) {
+        SCOPED_LOCK_MUTEX(THIS_LOCK)
+        batches++;
+        docs += numDocs;
+        failed += numFailed;
+    }
+};
+
+/*
+  Feed documents through an IndexingPipeline with a queue much smaller
+  than a batch, so producers are held back, and a tiny RAM buffer so the
+  workers flush while the producer is still adding.
+ */
+void testIndexingPipeline(CuTest *tc)
+{
+    const int32_t NUM_BATCHES = 20;
+    const int32_t BATCH_SIZE = 50;
+
+    RAMDirectory directory;
+    SimpleAnalyzer analyzer;
+    IndexWriter writer(&directory, &analyzer, true);
+    writer.setRAMBufferSizeMB(0.1f);
+
+    CountingBatchListener listener;
+    IndexingPipeline pipeline(&writer, 4, 8);
+    pipeline.setBatchListener(&listener);
+
+    std::wstring sb;
+    wchar_t buf[10];
+    int64_t batchIds[NUM_BATCHES];
+    Document* docs[BATCH_SIZE];
+    for (int32_t b = 0; b < NUM_BATCHES; b++) {
+        for (int32_t i = 0; i < BATCH_SIZE; i++) {
+            const int32_t id = b * BATCH_SIZE + i;
+            docs[i] = _CLNEW Document();
+            _i64tot(id, buf, 10);
+            docs[i]->add(*_CLNEW Field(_T("id"), buf, Field::STORE_YES | Field::INDEX_UNTOKENIZED));
+            sb.clear();
+            English::IntToEnglish(id, sb);
+            docs[i]->add(*_CLNEW Field(_T("contents"), sb.c_str(), Field::STORE_NO | Field::INDEX_TOKENIZED));
+        }
+        batchIds[b] = pipeline.addDocuments(docs, BATCH_SIZE);
+    }
+
+    pipeline.waitForBatch(batchIds[0]);
+    CLUCENE_ASSERT(pipeline.isBatchComplete(batchIds[0]));
+    pipeline.waitForAll();
+    for (int32_t b = 0; b < NUM_BATCHES; b++)
+        CLUCENE_ASSERT(pipeline.isBatchComplete(batchIds[b]));
+    pipeline.close();
+
+    CuAssertEquals(tc, NUM_BATCHES * BATCH_SIZE, (int32_t)pipeline.getNumIndexed());
+    CuAssertEquals(tc, 0, (int32_t)pipeline.getNumFailed());
+    CuAssertEquals(tc, NUM_BATCHES, listener.batches);
+    CuAssertEquals(tc, NUM_BATCHES * BATCH_SIZE, listener.docs);
+    CuAssertEquals(tc, 0, listener.failed);
+
+    Document* late = _CLNEW Document();
+    try {
+        pipeline.addDocument(late);
+        CuFail(tc, _T("expected adding to a closed pipeline to fail"));
+    } catch (CLuceneError& err) {
+        CuAssertEquals(tc, CL_ERR_IllegalState, err.number());
+        _CLDELETE(late);
+    }
+
+    writer.close();
+    IndexReader* reader = IndexReader::open(&directory);
+    CuAssertEquals(tc, NUM_BATCHES * BATCH_SIZE, reader->numDocs());
+    reader->close();
+    _CLDELETE(reader);
+    directory.close();
+}
+
+/*
+  Holds every document it analyzes until a second one is being analyzed
+  at the same time, or gives up after a few seconds.
+ */
+class GateAnalyzer: public WhitespaceAnalyzer {
+public:
+    DEFINE_MUTEX(THIS_LOCK)
+    int32_t arrived;
+    bool timedOut;
+    GateAnalyzer(): arrived(0), timedOut(false) {}
+    TokenStream* reusableTokenStream(const TCHAR* fieldName, Reader* reader) {
+        {
+            SCOPED_LOCK_MUTEX(THIS_LOCK)
+            arrived++;
+        }
+        for (int32_t i = 0; i < 5000; i++) {
+            {
+                SCOPED_LOCK_MUTEX(THIS_LOCK)
+                if (arrived >= 2)
+                    return WhitespaceAnalyzer::reusableTokenStream(fieldName, reader);
+            }
+            Misc::Sleep(1);
+        }
+        SCOPED_LOCK_MUTEX(THIS_LOCK)
+        timedOut = true;
+        return WhitespaceAnalyzer::reusableTokenStream(fieldName, reader);
+    }
+};
+
+/*
+  With the RAM buffer just short of full, and no flush running, the
+  pipeline must still let more than one document in flight at a time.
+ */
+void testIndexingPipelineNearRAMLimit(CuTest *tc)
+{
+    RAMDirectory directory;
+    WhitespaceAnalyzer analyzer;
+    IndexWriter writer(&directory, &analyzer, true);
+    writer.setMaxBufferedDocs(IndexWriter::DISABLE_AUTO_FLUSH);
+    writer.setRAMBufferSizeMB(1.0f);
+    const int64_t limit = 1024 * 1024;
+
+    std::wstring sb;
+    for (int32_t id = 0; writer.ramSizeInBytes() <= limit * 9 / 10; id++) {
+        Document doc;
+        sb.clear();
+        English::IntToEnglish(id, sb);
+        doc.add(*_CLNEW Field(_T("contents"), sb.c_str(), Field::STORE_NO | Field::INDEX_TOKENIZED));
+        writer.addDocument(&doc);
+    }
+    CLUCENE_ASSERT(writer.ramSizeInBytes() < limit);
+
+    GateAnalyzer gate;
+    IndexingPipeline pipeline(&writer, 2, 8, &gate);
+    Document* docs[2];
+    for (int32_t i = 0; i < 2; i++) {
+        docs[i] = _CLNEW Document();
+        docs[i]->add(*_CLNEW Field(_T("contents"), _T("near the limit"), Field::STORE_NO | Field::INDEX_TOKENIZED));
+    }
+    pipeline.addDocuments(docs, 2);
+    pipeline.close();
+
+    CLUCENE_ASSERT(!gate.timedOut);
+    CuAssertEquals(tc, 2, (int32_t)pipeline.getNumIndexed());
+
+    writer.close();
+    directory.close();
+}
+
 CuSuite *testatomicupdates(void)
 {
     srand((unsigned int)Misc::currentTimeMillis());
     CuSuite *suite = CuSuiteNew(_T("CLucene Atomic Updates Test"));
     SUITE_ADD_TEST(suite, testRAMThreading);
     SUITE_ADD_TEST(suite, testFSThreading);
+    SUITE_ADD_TEST(suite, testConcurrentFlush);
+    SUITE_ADD_TEST(suite, testIndexingPipeline);
+    SUITE_ADD_TEST(suite, testIndexingPipelineNearRAMLimit);
 
     return suite;
 }
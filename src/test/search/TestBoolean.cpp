@@ -8,9 +8,11 @@
 ------------------------------------------------------------------------------*/
 #include "test.h"
 #include "CLucene/search/_BooleanScorer2.h"
+#include "CLucene/search/_ConjunctionScorer.h"
 #include "CLucene/search/Similarity.h"
 #include "MockScorer.h"
 #include "MockHitCollector.h"
+#include <map>
 
 /// TestBooleanQuery.java, ported 5/9/2009
 void testEquality(CuTest *tc) {
@@ -180,6 +182,227 @@ void testBooleanScorer2WithProhibitedScorer(CuTest* tc) {
     CuAssertIntEquals(tc, _T("Unexpected calls of next()!"), 1, prohibitedScorer.getNextCalls());
 }
 
+/** Iterates over every <code>step</code>th document, counting how it is moved */
+class StepScorer: public Scorer {
+    int32_t step;
+    int32_t maxDoc;
+    int32_t current;
+public:
+    int32_t nextCalls;
+    int32_t skipToCalls;
+    StepScorer(Similarity* similarity, const int32_t _step, const int32_t _maxDoc):
+        Scorer(similarity), step(_step), maxDoc(_maxDoc), current(-1), nextCalls(0), skipToCalls(0) {}
+    bool next() {
+        nextCalls++;
+        current = current < 0 ? 0 : current + step;
+        return current < maxDoc;
+    }
+    bool skipTo(int32_t target) {
+        skipToCalls++;
+        if (target <= current)
+            target = current + 1;
+        current = (target + step - 1) / step * step;
+        return current < maxDoc;
+    }
+    int32_t doc() const { return current; }
+    float_t score() { return 1.0f; }
+    int64_t cost() const { return (maxDoc + step - 1) / step; }
+    Explanation* explain(int32_t) { return NULL; }
+    std::wstring toString() { return L"StepScorer"; }
+};
+
+void testConjunctionLeadsWithRarest(CuTest* tc) {
+    // the common clauses are added first, but only skip to the rare one
+    CL_NS(search)::DefaultSimilarity similarity;
+    StepScorer* common = _CLNEW StepScorer(&similarity, 1, 10000);
+    StepScorer* half = _CLNEW StepScorer(&similarity, 2, 10000);
+    StepScorer* rare = _CLNEW StepScorer(&similarity, 1000, 10000);
+    ValueArray<Scorer*> scorers(3);
+    scorers[0] = common;
+    scorers[1] = half;
+    scorers[2] = rare;
+    ConjunctionScorer* conjunction = _CLNEW ConjunctionScorer(&similarity, &scorers);
+
+    CuAssertIntEquals(tc, _T("cost"), 10, (int32_t)conjunction->cost());
+    int32_t hits = 0;
+    while (conjunction->next()) {
+        CuAssertIntEquals(tc, _T("doc"), hits * 1000, conjunction->doc());
+        hits++;
+    }
+    CuAssertIntEquals(tc, _T("hits"), 10, hits);
+    CuAssertIntEquals(tc, _T("rare clause moved"), 11, rare->nextCalls + rare->skipToCalls);
+    CuAssertTrue(tc, common->nextCalls + common->skipToCalls <= 11, _T("common clause leads"));
+    CuAssertTrue(tc, half->nextCalls + half->skipToCalls <= 11, _T("half clause leads"));
+    _CLLDELETE(conjunction);
+
+    // scorers of an index know the cost of their terms
+    RAMDirectory directory;
+    WhitespaceAnalyzer a;
+    IndexWriter writer(&directory, &a, true);
+    writer.setMaxBufferedDocs(500);
+    for (int32_t i = 0; i < 2000; i++) {
+        Document doc;
+        doc.add(*_CLNEW Field(_T("content"), i % 250 == 0 ? _T("common half rare") :
+            i % 2 == 0 ? _T("common half") : _T("common"), Field::INDEX_TOKENIZED));
+        writer.addDocument(&doc);
+    }
+    writer.close();
+    IndexReader* reader = IndexReader::open(&directory);
+    IndexSearcher searcher(reader);
+
+    Term* tCommon = _CLNEW Term(_T("content"), _T("common"));
+    Term* tHalf = _CLNEW Term(_T("content"), _T("half"));
+    Term* tRare = _CLNEW Term(_T("content"), _T("rare"));
+    BooleanQuery* query = _CLNEW BooleanQuery();
+    query->add(_CLNEW TermQuery(tCommon), true, BooleanClause::MUST);
+    query->add(_CLNEW TermQuery(tHalf), true, BooleanClause::MUST);
+    query->add(_CLNEW TermQuery(tRare), true, BooleanClause::MUST);
+    BooleanQuery* nested = _CLNEW BooleanQuery();
+    nested->add(_CLNEW TermQuery(tCommon), true, BooleanClause::SHOULD);
+    nested->add(_CLNEW TermQuery(tHalf), true, BooleanClause::SHOULD);
+    query->add(nested, true, BooleanClause::MUST);
+    PhraseQuery* phrase = _CLNEW PhraseQuery();
+    phrase->add(tHalf);
+    phrase->add(tRare);
+    query->add(phrase, true, BooleanClause::MUST);
+
+    Weight* weight = query->weight(&searcher);
+    Scorer* scorer = weight->scorer(reader);
+    CuAssertIntEquals(tc, _T("conjunction cost"), 8, (int32_t)scorer->cost());
+    hits = 0;
+    while (scorer->next()) {
+        CuAssertIntEquals(tc, _T("doc"), hits * 250, scorer->doc());
+        hits++;
+    }
+    CuAssertIntEquals(tc, _T("hits"), 8, hits);
+    _CLDELETE(scorer);
+    _CLDELETE(weight);
+
+    Weight* nestedWeight = nested->weight(&searcher);
+    scorer = nestedWeight->scorer(reader);
+    CuAssertIntEquals(tc, _T("disjunction cost"), 3000, (int32_t)scorer->cost());
+    _CLDELETE(scorer);
+    _CLDELETE(nestedWeight);
+
+    _CLDECDELETE(tCommon);
+    _CLDECDELETE(tHalf);
+    _CLDECDELETE(tRare);
+    _CLLDELETE(query);
+    searcher.close();
+    reader->close();
+    _CLLDELETE(reader);
+}
+
+/** Collects the hits of a search by document, counting the documents collected twice */
+class ScoresByDoc: public HitCollector {
+public:
+    std::map<int32_t, float_t> scores;
+    int32_t duplicates;
+    ScoresByDoc(): duplicates(0) {}
+    void collect(const int32_t doc, const float_t score) {
+        if (!scores.insert(std::make_pair(doc, score)).second)
+            duplicates++;
+    }
+};
+
+/** Checks that the out of order disjunction scores like the in order one */
+static void checkOutOfOrder(CuTest* tc, IndexSearcher* searcher, BooleanQuery* query, const int32_t expectedHits) {
+    ScoresByDoc inOrder;
+    searcher->_search(query, NULL, &inOrder);
+    BooleanQuery::setAllowDocsOutOfOrder(true);
+    ScoresByDoc outOfOrder;
+    searcher->_search(query, NULL, &outOfOrder);
+    BooleanQuery::setAllowDocsOutOfOrder(false);
+
+    CuAssertIntEquals(tc, _T("hits"), expectedHits, (int32_t)inOrder.scores.size());
+    CuAssertIntEquals(tc, _T("duplicates"), 0, outOfOrder.duplicates);
+    CuAssertIntEquals(tc, _T("out of order hits"), (int32_t)inOrder.scores.size(), (int32_t)outOfOrder.scores.size());
+    std::map<int32_t, float_t>::iterator expected = inOrder.scores.begin();
+    std::map<int32_t, float_t>::iterator actual = outOfOrder.scores.begin();
+    for (; expected != inOrder.scores.end(); ++expected, ++actual) {
+        CuAssertIntEquals(tc, _T("doc"), expected->first, actual->first);
+        CuAssertTrue(tc, fabs(expected->second - actual->second) < 1e-6, _T("score"));
+    }
+}
+
+void testBooleanScorerWindows(CuTest* tc) {
+    RAMDirectory directory;
+    WhitespaceAnalyzer a;
+    IndexWriter writer(&directory, &a, true);
+    writer.setMaxBufferedDocs(10000);                 // one segment, of several windows
+    for (int32_t i = 0; i < 7000; i++) {
+        std::wstring content;
+        for (int32_t t = 0; t < 12; t++) {
+            // term t is in every (t+2)th document, and a few times in some
+            if (i % (t + 2) == 0 || (t == 11 && i > 6500)) {
+                content.append(_T("t"));
+                content.append(std::to_wstring(t));
+                for (int32_t r = 0; r < i % 3; r++)
+                    content.append(_T(" t")).append(std::to_wstring(t));
+                content.push_back(_T(' '));
+            }
+        }
+        content.append(_T("all"));
+        Document doc;
+        doc.add(*_CLNEW Field(_T("content"), content.c_str(), Field::INDEX_TOKENIZED));
+        writer.addDocument(&doc);
+    }
+    writer.close();
+    IndexSearcher searcher(&directory);
+
+    // a broad disjunction
+    BooleanQuery broad;
+    for (int32_t t = 0; t < 12; t++) {
+        Term* term = _CLNEW Term(_T("content"), (_T("t") + std::to_wstring(t)).c_str());
+        broad.add(_CLNEW TermQuery(term), true, BooleanClause::SHOULD);
+        _CLDECDELETE(term);
+    }
+    int32_t any = 0;
+    for (int32_t i = 0; i < 7000; i++) {
+        bool matches = i > 6500;
+        for (int32_t t = 0; t < 12; t++)
+            matches = matches || i % (t + 2) == 0;
+        if (matches)
+            any++;
+    }
+    checkOutOfOrder(tc, &searcher, &broad, any);
+
+    // with prohibited clauses, and clauses that match late only
+    BooleanQuery prohibited;
+    Term* t3 = _CLNEW Term(_T("content"), _T("t3"));
+    Term* t5 = _CLNEW Term(_T("content"), _T("t5"));
+    Term* t11 = _CLNEW Term(_T("content"), _T("t11"));
+    Term* t0 = _CLNEW Term(_T("content"), _T("t0"));
+    prohibited.add(_CLNEW TermQuery(t3), true, BooleanClause::SHOULD);
+    prohibited.add(_CLNEW TermQuery(t11), true, BooleanClause::SHOULD);
+    prohibited.add(_CLNEW TermQuery(t0), true, BooleanClause::MUST_NOT);
+    int32_t expected = 0;
+    for (int32_t i = 0; i < 7000; i++) {
+        if ((i % 5 == 0 || i % 13 == 0 || i > 6500) && i % 2 != 0)
+            expected++;
+    }
+    checkOutOfOrder(tc, &searcher, &prohibited, expected);
+
+    // with several prohibited clauses, leaving sparse windows
+    BooleanQuery sparse;
+    sparse.add(_CLNEW TermQuery(t3), true, BooleanClause::SHOULD);
+    sparse.add(_CLNEW TermQuery(t5), true, BooleanClause::SHOULD);
+    sparse.add(_CLNEW TermQuery(t0), true, BooleanClause::MUST_NOT);
+    sparse.add(_CLNEW TermQuery(t11), true, BooleanClause::MUST_NOT);
+    expected = 0;
+    for (int32_t i = 0; i < 7000; i++) {
+        if ((i % 5 == 0 || i % 7 == 0) && i % 2 != 0 && i % 13 != 0 && i <= 6500)
+            expected++;
+    }
+    checkOutOfOrder(tc, &searcher, &sparse, expected);
+
+    _CLDECDELETE(t3);
+    _CLDECDELETE(t5);
+    _CLDECDELETE(t11);
+    _CLDECDELETE(t0);
+    searcher.close();
+}
+
 CuSuite *testBoolean(void)
 {
     CuSuite *suite = CuSuiteNew(_T("CLucene Boolean Tests"));
@@ -191,6 +414,8 @@ CuSuite *testBoolean(void)
 
     SUITE_ADD_TEST(suite, testBooleanPrefixQuery);
     SUITE_ADD_TEST(suite, testBooleanScorer2WithProhibitedScorer);
+    SUITE_ADD_TEST(suite, testBooleanScorerWindows);
+    SUITE_ADD_TEST(suite, testConjunctionLeadsWithRarest);
 
     //_CrtSetBreakAlloc(1179);
 
@@ -0,0 +1,333 @@
+/*------------------------------------------------------------------------------
+* Copyright (C) 2003-2006 Ben van Klinken and the CLucene Team
+
+* Updated by https://github.com/farfella/.
+*
+* Distributable under the terms of either the Apache License (Version 2.0) or
+* the GNU Lesser General Public License, as specified in the COPYING file.
+------------------------------------------------------------------------------*/
+#include "test.h"
+#include "CheckHits.h"
+#include "CLucene/search/function/ValueSourceQuery.h"
+#include "CLucene/search/function/CustomScoreQuery.h"
+#include "CLucene/search/function/FieldCacheSource.h"
+#include "CLucene/search/function/FloatFunctions.h"
+#include "CLucene/search/QueryResultCache.h"
+#include <map>
+
+CL_NS_USE2(search,function)
+
+static RAMDirectory* functionDir = NULL;
+static const int32_t functionDocs = 40;
+static const int32_t functionDeleted = 13;
+static const int64_t functionDay = 24 * 60 * 60 * 1000;
+static int64_t functionNow = 0;
+
+// the values of the documents of the index, by their id
+static int32_t functionInt(int32_t id) { return id % 7; }
+static float_t functionFloat(int32_t id) { return (id % 5) * 0.5f; }
+static float_t functionRecency(int32_t id) {
+    if (id % 10 == 9 || id == 20)
+        return 0.0f;                              // no date, or one that does not parse
+    return (float_t)pow(0.5, id % 4);
+}
+
+static int32_t functionId(IndexReader* reader, int32_t doc)
+{
+    Document stored;
+    reader->document(doc, stored);
+    return _wtoi(stored.get(_T("id")));
+}
+
+void testFunctionSetup(CuTest *tc)
+{
+    functionNow = DateTools::getTime(2010, 6, 15);
+    functionDir = _CLNEW RAMDirectory();
+    WhitespaceAnalyzer analyzer;
+    IndexWriter* writer = _CLNEW IndexWriter(functionDir, &analyzer, true);
+    writer->setMaxBufferedDocs(10);
+    writer->setMergeFactor(100);                 // several segments, each scored on its own
+
+    for (int32_t id = 0; id < functionDocs; id++) {
+        Document doc;
+        doc.add(*_CLNEW Field(_T("id"), std::to_wstring(id).c_str(), Field::STORE_YES | Field::INDEX_UNTOKENIZED));
+        std::wstring contents(_T("x"));
+        for (int32_t j = 0; j < id % 3; j++)
+            contents.append(_T(" y"));
+        for (int32_t j = 0; j < id % 5; j++)
+            contents.append(_T(" z"));
+        doc.add(*_CLNEW Field(_T("contents"), contents.c_str(), Field::INDEX_TOKENIZED));
+        doc.add(*_CLNEW Field(_T("int"), std::to_wstring(functionInt(id)).c_str(), Field::INDEX_UNTOKENIZED));
+        doc.add(*_CLNEW Field(_T("float"), Misc::toString(functionFloat(id)).c_str(), Field::INDEX_UNTOKENIZED));
+        if (id == 20) {
+            doc.add(*_CLNEW Field(_T("date"), _T("notadate"), Field::INDEX_UNTOKENIZED));
+        } else if (id % 10 != 9) {
+            wchar_t* date = DateTools::timeToString(functionNow - (id % 4) * functionDay, DateTools::DAY_FORMAT);
+            doc.add(*_CLNEW Field(_T("date"), date, Field::INDEX_UNTOKENIZED));
+            _CLDELETE_LCARRAY(date);
+        }
+        writer->addDocument(&doc);
+    }
+    Term* t = _CLNEW Term(_T("id"), std::to_wstring(functionDeleted).c_str());
+    writer->deleteDocuments(t);
+    _CLDECDELETE(t);
+    writer->close();
+    _CLDELETE(writer);
+}
+
+void testFunctionCleanup(CuTest *tc)
+{
+    functionDir->close();
+    _CLDELETE(functionDir);
+}
+
+typedef float_t (*ExpectedValue)(IndexReader* reader, int32_t doc);
+
+static float_t expectInt(IndexReader* reader, int32_t doc) { return (float_t)functionInt(functionId(reader, doc)); }
+static float_t expectFloat(IndexReader* reader, int32_t doc) { return functionFloat(functionId(reader, doc)); }
+static float_t expectConst(IndexReader* /*reader*/, int32_t /*doc*/) { return 2.5f; }
+static float_t expectLinear(IndexReader* reader, int32_t doc) { return 2.0f * expectInt(reader, doc) + 1.0f; }
+static float_t expectReciprocal(IndexReader* reader, int32_t doc) { return 3.0f / (expectInt(reader, doc) + 1.0f); }
+static float_t expectSum(IndexReader* reader, int32_t doc) { return expectInt(reader, doc) + expectFloat(reader, doc); }
+static float_t expectProduct(IndexReader* reader, int32_t doc) { return expectInt(reader, doc) * expectFloat(reader, doc); }
+static float_t expectRecency(IndexReader* reader, int32_t doc) { return functionRecency(functionId(reader, doc)); }
+static float_t expectNorm(IndexReader* reader, int32_t doc) { return Similarity::decodeNorm(reader->norms(_T("contents"))[doc]); }
+
+// a ValueSourceQuery must score each document by its value, and match those whose value is above 0
+static void checkValueSource(CuTest* tc, IndexReader* reader, ValueSource* source, ExpectedValue expected)
+{
+    IndexSearcher searcher(reader);
+    ValueSourceQuery query(source);
+    query.setBoost(2.0f);                        // normalized away: the query is on its own
+
+    TopDocs* topDocs = searcher._search(&query, NULL, functionDocs);
+    int32_t expectedHits = 0;
+    for (int32_t doc = 0; doc < reader->maxDoc(); doc++) {
+        if (!reader->isDeleted(doc) && expected(reader, doc) > 0.0f)
+            expectedHits++;
+    }
+    CuAssertIntEquals(tc, query.toString().c_str(), expectedHits, topDocs->totalHits);
+    CuAssertIntEquals(tc, query.toString().c_str(), expectedHits, topDocs->scoreDocsLength);
+    for (int32_t i = 0; i < topDocs->scoreDocsLength; i++) {
+        const ScoreDoc& hit = topDocs->scoreDocs[i];
+        CLUCENE_ASSERT(hit.doc != functionDeleted);
+        const float_t value = expected(reader, hit.doc);
+        CuAssertTrue(tc, fabs(hit.score - value) < 1e-5f, query.toString().c_str());
+        if (i > 0)
+            CLUCENE_ASSERT(topDocs->scoreDocs[i - 1].score >= hit.score);
+    }
+    _CLDELETE(topDocs);
+
+    CheckHits::checkExplanations(tc, &query, _T("contents"), &searcher, true);
+}
+
+void testValueSourceQuery(CuTest *tc)
+{
+    IndexReader* reader = IndexReader::open(functionDir);
+    CLUCENE_ASSERT(reader->maxDoc() == functionDocs);
+
+    checkValueSource(tc, reader, _CLNEW IntFieldSource(_T("int")), expectInt);
+    checkValueSource(tc, reader, _CLNEW FloatFieldSource(_T("float")), expectFloat);
+    checkValueSource(tc, reader, _CLNEW ConstValueSource(2.5f), expectConst);
+    checkValueSource(tc, reader, _CLNEW LinearFloatFunction(_CLNEW IntFieldSource(_T("int")), 2.0f, 1.0f), expectLinear);
+    checkValueSource(tc, reader, _CLNEW ReciprocalFloatFunction(_CLNEW IntFieldSource(_T("int")), 1.0f, 3.0f, 1.0f), expectReciprocal);
+    checkValueSource(tc, reader, _CLNEW RecencyFieldSource(_T("date"), functionNow, functionDay), expectRecency);
+    checkValueSource(tc, reader, _CLNEW NormValueSource(_T("contents")), expectNorm);
+
+    ValueSource* sources[2] = { _CLNEW IntFieldSource(_T("int")), _CLNEW FloatFieldSource(_T("float")) };
+    checkValueSource(tc, reader, _CLNEW SumFloatFunction(sources, 2), expectSum);
+    sources[0] = _CLNEW IntFieldSource(_T("int"));
+    sources[1] = _CLNEW FloatFieldSource(_T("float"));
+    checkValueSource(tc, reader, _CLNEW ProductFloatFunction(sources, 2), expectProduct);
+
+    try {
+        RecencyFieldSource source(_T("date"), functionNow, 0);
+        CuFail(tc, _T("a half-life must be positive"));
+    } catch (CLuceneError& e) {
+        CuAssertIntEquals(tc, _T("error"), CL_ERR_IllegalArgument, e.number());
+    }
+
+    reader->close();
+    _CLDELETE(reader);
+}
+
+// a CustomScoreQuery must match what its subquery matches, scoring each by the subquery's score times the value
+void testCustomScoreQuery(CuTest *tc)
+{
+    IndexReader* reader = IndexReader::open(functionDir);
+    IndexSearcher searcher(reader);
+
+    Term* t = _CLNEW Term(_T("contents"), _T("y"));
+    TermQuery* termQuery = _CLNEW TermQuery(t);
+    _CLDECDELETE(t);
+
+    std::map<int32_t, float_t> subScores;
+    TopDocs* topDocs = searcher._search(termQuery, NULL, functionDocs);
+    for (int32_t i = 0; i < topDocs->scoreDocsLength; i++)
+        subScores[topDocs->scoreDocs[i].doc] = topDocs->scoreDocs[i].score;
+    _CLDELETE(topDocs);
+    CLUCENE_ASSERT(subScores.size() > 0);
+
+    for (int32_t b = 0; b < 2; b++) {
+        CustomScoreQuery query(termQuery->clone(), _CLNEW IntFieldSource(_T("int")));
+        if (b == 1)
+            query.setBoost(3.0f);                // normalized away: the query is on its own
+
+        int32_t expectedHits = 0;
+        for (std::map<int32_t, float_t>::iterator itr = subScores.begin(); itr != subScores.end(); ++itr) {
+            if (expectInt(reader, itr->first) > 0.0f)
+                expectedHits++;
+        }
+        topDocs = searcher._search(&query, NULL, functionDocs);
+        CuAssertIntEquals(tc, _T("hits"), expectedHits, topDocs->totalHits);
+        for (int32_t i = 0; i < topDocs->scoreDocsLength; i++) {
+            const ScoreDoc& hit = topDocs->scoreDocs[i];
+            CLUCENE_ASSERT(subScores.find(hit.doc) != subScores.end());
+            const float_t score = subScores[hit.doc] * expectInt(reader, hit.doc);
+            CuAssertTrue(tc, fabs(hit.score - score) < 1e-5f, _T("score"));
+        }
+        _CLDELETE(topDocs);
+
+        CheckHits::checkExplanations(tc, &query, _T("contents"), &searcher, true);
+    }
+
+    // a recency boost of the documents a boolean query matches
+    BooleanQuery* boolQuery = _CLNEW BooleanQuery();
+    boolQuery->add(termQuery->clone(), true, BooleanClause::SHOULD);
+    t = _CLNEW Term(_T("contents"), _T("z"));
+    boolQuery->add(_CLNEW TermQuery(t), true, BooleanClause::SHOULD);
+    _CLDECDELETE(t);
+    CustomScoreQuery recent(boolQuery, _CLNEW RecencyFieldSource(_T("date"), functionNow, functionDay));
+    topDocs = searcher._search(&recent, NULL, functionDocs);
+    CLUCENE_ASSERT(topDocs->totalHits > 0);
+    for (int32_t i = 0; i < topDocs->scoreDocsLength; i++)
+        CLUCENE_ASSERT(expectRecency(reader, topDocs->scoreDocs[i].doc) > 0.0f);
+    _CLDELETE(topDocs);
+    CheckHits::checkExplanations(tc, &recent, _T("contents"), &searcher, true);
+
+    _CLDELETE(termQuery);
+    searcher.close();
+    reader->close();
+    _CLDELETE(reader);
+}
+
+void testFunctionQueryEquality(CuTest *tc)
+{
+    Term* t = _CLNEW Term(_T("contents"), _T("y"));
+    CustomScoreQuery q1(_CLNEW TermQuery(t), _CLNEW LinearFloatFunction(_CLNEW IntFieldSource(_T("int")), 2.0f, 1.0f));
+    CustomScoreQuery q2(_CLNEW TermQuery(t), _CLNEW LinearFloatFunction(_CLNEW IntFieldSource(_T("int")), 2.0f, 1.0f));
+    CustomScoreQuery q3(_CLNEW TermQuery(t), _CLNEW LinearFloatFunction(_CLNEW FloatFieldSource(_T("int")), 2.0f, 1.0f));
+    _CLDECDELETE(t);
+
+    CLUCENE_ASSERT(q1.equals(&q2));
+    CuAssertTrue(tc, q1.hashCode() == q2.hashCode(), _T("hashCode"));
+    CLUCENE_ASSERT(!q1.equals(&q3));
+    CuAssertStrEquals(tc, _T("toString"), _T("custom(contents:y, 2.00*float(int(int))+1.00)"), q1.toString().c_str());
+
+    Query* clone = q1.clone();
+    CLUCENE_ASSERT(q1.equals(clone));
+    _CLDELETE(clone);
+
+    ValueSourceQuery v1(_CLNEW RecencyFieldSource(_T("date"), 1000, 10));
+    ValueSourceQuery v2(_CLNEW RecencyFieldSource(_T("date"), 1000, 20));
+    CLUCENE_ASSERT(!v1.equals(&v2));
+    clone = v2.clone();
+    CLUCENE_ASSERT(v2.equals(clone));
+    CuAssertTrue(tc, v2.hashCode() == clone->hashCode(), _T("hashCode"));
+    _CLDELETE(clone);
+
+    // a subquery that rewrites is rewritten in a clone
+    IndexReader* reader = IndexReader::open(functionDir);
+    IndexSearcher searcher(reader);
+    t = _CLNEW Term(_T("contents"), _T("y"));
+    CustomScoreQuery prefix(_CLNEW PrefixQuery(t), _CLNEW IntFieldSource(_T("int")));
+    _CLDECDELETE(t);
+    Query* rewritten = prefix.rewrite(reader);
+    CLUCENE_ASSERT(rewritten != &prefix);
+    CLUCENE_ASSERT(rewritten->instanceOf(CustomScoreQuery::getClassName()));
+    _CLDELETE(rewritten);
+    TopDocs* topDocs = searcher._search(&prefix, NULL, functionDocs);
+    CLUCENE_ASSERT(topDocs->totalHits > 0);
+    _CLDELETE(topDocs);
+
+    searcher.close();
+    reader->close();
+    _CLDELETE(reader);
+}
+
+// scores by the subquery's score times the square of the value
+class SquaredScoreQuery: public CustomScoreQuery {
+protected:
+    SquaredScoreQuery(const SquaredScoreQuery& clone): CustomScoreQuery(clone) {}
+public:
+    SquaredScoreQuery(Query* subQuery, ValueSource* source): CustomScoreQuery(subQuery, source) {}
+    float_t customScore(const int32_t /*doc*/, const float_t subQueryScore, const float_t value) const {
+        return subQueryScore * value * value;
+    }
+    Query* clone() const { return _CLNEW SquaredScoreQuery(*this); }
+    static const std::wstring getClassName() { return L"SquaredScoreQuery"; }
+    const std::wstring getObjectName() const { return getClassName(); }
+};
+
+// a subclass keeps its customScore when its subquery rewrites, and is neither equal to nor
+// cached as a CustomScoreQuery on the same subquery and source
+void testCustomScoreSubclass(CuTest *tc)
+{
+    IndexReader* reader = IndexReader::open(functionDir);
+    IndexSearcher searcher(reader);
+    QueryResultCache cache;
+    searcher.setQueryResultCache(&cache);
+
+    Term* t = _CLNEW Term(_T("contents"), _T("y"));
+    CustomScoreQuery product(_CLNEW PrefixQuery(t), _CLNEW IntFieldSource(_T("int")));
+    SquaredScoreQuery squared(_CLNEW PrefixQuery(t), _CLNEW IntFieldSource(_T("int")));
+    _CLDECDELETE(t);
+
+    CLUCENE_ASSERT(!product.equals(&squared));
+    CLUCENE_ASSERT(!squared.equals(&product));
+    Query* clone = squared.clone();
+    CLUCENE_ASSERT(squared.equals(clone));
+    _CLDELETE(clone);
+
+    Query* rewritten = squared.rewrite(reader);
+    CLUCENE_ASSERT(rewritten != &squared);
+    CLUCENE_ASSERT(rewritten->instanceOf(SquaredScoreQuery::getClassName()));
+    _CLDELETE(rewritten);
+
+    TopDocs* productDocs = searcher._search(&product, NULL, functionDocs);
+    const int64_t hits = cache.getHitCount();
+    TopDocs* squaredDocs = searcher._search(&squared, NULL, functionDocs);
+    CuAssertIntEquals(tc, _T("subclass found in the cache"), 0, (int32_t)(cache.getHitCount() - hits));
+
+    std::map<int32_t, float_t> productScores;
+    for (int32_t i = 0; i < productDocs->scoreDocsLength; i++)
+        productScores[productDocs->scoreDocs[i].doc] = productDocs->scoreDocs[i].score;
+    CuAssertIntEquals(tc, _T("hits"), productDocs->totalHits, squaredDocs->totalHits);
+    for (int32_t i = 0; i < squaredDocs->scoreDocsLength; i++) {
+        const ScoreDoc& hit = squaredDocs->scoreDocs[i];
+        CLUCENE_ASSERT(productScores.find(hit.doc) != productScores.end());
+        const float_t expected = productScores[hit.doc] * expectInt(reader, hit.doc);
+        CuAssertTrue(tc, fabs(hit.score - expected) < 1e-4f, squared.toString().c_str());
+    }
+    _CLDELETE(productDocs);
+    _CLDELETE(squaredDocs);
+
+    searcher.close();
+    reader->close();
+    _CLDELETE(reader);
+}
+
+CuSuite *testFunctionQuery(void)
+{
+    CuSuite *suite = CuSuiteNew(_T("CLucene Function Query Test"));
+    SUITE_ADD_TEST(suite, testFunctionSetup);
+
+    SUITE_ADD_TEST(suite, testValueSourceQuery);
+    SUITE_ADD_TEST(suite, testCustomScoreQuery);
+    SUITE_ADD_TEST(suite, testFunctionQueryEquality);
+    SUITE_ADD_TEST(suite, testCustomScoreSubclass);
+
+    SUITE_ADD_TEST(suite, testFunctionCleanup);
+    return suite;
+}
+// EOF
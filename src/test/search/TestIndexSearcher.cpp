@@ -5,6 +5,16 @@
 * the GNU Lesser General Public License, as specified in the COPYING file.
 ------------------------------------------------------------------------------*/
 #include "test.h"
+#include "CLucene/search/_ScoreLoop.h"
+#include "CLucene/search/_TopScoreDocCollector.h"
+#include "CLucene/search/QueryFilter.h"
+#include "CLucene/search/ConstantScoreQuery.h"
+#include "CLucene/search/QueryResultCache.h"
+#include "CLucene/search/FilterCache.h"
+#include "CLucene/search/RangeFilter.h"
+#include "CLucene/search/_FieldDocSortedHitQueue.h"
+#include "CLucene/index/_ImpactTiers.h"
+#include <algorithm>
 
 DEFINE_MUTEX(searchMutex);
 DEFINE_CONDITION(searchCondition);
@@ -89,11 +99,569 @@ void testEndThreadException(CuTest *tc) {
 }
 
 
+/** Records every hit of a search */
+class AllHitsCollector: public HitCollector {
+public:
+    std::vector<ScoreDoc> hits;
+    void collect(const int32_t doc, const float_t score) {
+        ScoreDoc sd = { doc, score };
+        hits.push_back(sd);
+    }
+};
+
+static bool byRelevance(const ScoreDoc& a, const ScoreDoc& b) {
+    if (a.score != b.score)
+        return a.score > b.score;
+    return a.doc < b.doc;
+}
+
+/** Compares the top hits of a search with the best of all its hits */
+static void checkTopDocs(CuTest* tc, IndexSearcher* searcher, Query* query, const bool evenOnly, Filter* filter, const int32_t nDocs) {
+    AllHitsCollector all;
+    searcher->_search(query, NULL, &all);
+    std::vector<ScoreDoc> expected;
+    for (size_t i = 0; i < all.hits.size(); i++) {
+        if (!evenOnly || all.hits[i].doc % 2 == 0)
+            expected.push_back(all.hits[i]);
+    }
+    std::sort(expected.begin(), expected.end(), byRelevance);
+
+    TopDocs* topDocs = searcher->_search(query, filter, nDocs);
+    CuAssertIntEquals(tc, _T("totalHits"), (int32_t)expected.size(), topDocs->totalHits);
+    CuAssertIntEquals(tc, _T("number of hits"), (int32_t)(expected.size() < (size_t)nDocs ? expected.size() : nDocs), topDocs->scoreDocsLength);
+    for (int32_t i = 0; i < topDocs->scoreDocsLength; i++) {
+        CuAssertIntEquals(tc, _T("doc"), expected[i].doc, topDocs->scoreDocs[i].doc);
+        CLUCENE_ASSERT(expected[i].score == topDocs->scoreDocs[i].score);
+    }
+    _CLLDELETE(topDocs);
+}
+
+/** Counts hits, stops after <code>limit</code> and raises its threshold with every hit */
+class LimitCollector {
+public:
+    int32_t limit;
+    int32_t count;
+    LimitCollector(const int32_t _limit): limit(_limit), count(0) {}
+    void setDocBase(const int32_t /*docBase*/) {}
+    ScoreLoop::Status collect(const int32_t /*doc*/, const float_t /*score*/) {
+        return ++count == limit ? ScoreLoop::TERMINATE : ScoreLoop::THRESHOLD_RAISED;
+    }
+    float_t getMinCompetitiveScore() const { return (float_t)count; }
+};
+
+/** A scorer over documents 0..n-1 that records the thresholds it is given */
+class ThresholdScorer: public Scorer {
+public:
+    int32_t current;
+    int32_t n;
+    std::vector<float_t> thresholds;
+    ThresholdScorer(Similarity* similarity, const int32_t _n): Scorer(similarity), current(-1), n(_n) {}
+    bool next() { return ++current < n; }
+    int32_t doc() const { return current; }
+    float_t score() { return 1.0f; }
+    bool skipTo(int32_t target) { current = target; return current < n; }
+    Explanation* explain(int32_t /*doc*/) { return NULL; }
+    std::wstring toString() { return L"ThresholdScorer"; }
+    void setMinCompetitiveScore(const float_t minScore) { thresholds.push_back(minScore); }
+};
+
+void testTopScoreDocs(CuTest *tc) {
+    RAMDirectory dir;
+    WhitespaceAnalyzer an;
+    IndexWriter writer(&dir, &an, true);
+    writer.setMaxBufferedDocs(40);
+    for (int32_t i = 0; i < 300; i++) {
+        Document doc;
+        std::wstring content;
+        for (int32_t j = 0; j <= i % 5; j++)
+            content.append(_T("a "));
+        if (i % 3 == 0)
+            content.append(_T("b "));
+        for (int32_t j = 0; j < i % 4; j++)
+            content.append(_T("c "));
+        doc.add(*_CLNEW Field(_T("content"), content.c_str(), Field::INDEX_TOKENIZED));
+        doc.add(*_CLNEW Field(_T("parity"), i % 2 == 0 ? _T("even") : _T("odd"), Field::INDEX_UNTOKENIZED));
+        writer.addDocument(&doc);
+    }
+    writer.close();
+
+    IndexSearcher searcher(&dir);
+    Term* ta = _CLNEW Term(_T("content"), _T("a"));
+    Term* tb = _CLNEW Term(_T("content"), _T("b"));
+    Term* tc2 = _CLNEW Term(_T("content"), _T("c"));
+    Term* teven = _CLNEW Term(_T("parity"), _T("even"));
+    TermQuery termQuery(ta);
+    BooleanQuery booleanQuery;
+    booleanQuery.add(_CLNEW TermQuery(tb), true, BooleanClause::SHOULD);
+    booleanQuery.add(_CLNEW TermQuery(tc2), true, BooleanClause::SHOULD);
+    QueryFilter evenFilter(_CLNEW TermQuery(teven), true);
+
+    const int32_t nDocs[] = { 0, 1, 10, 400 };
+    for (int32_t n = 0; n < 4; n++) {
+        checkTopDocs(tc, &searcher, &termQuery, false, NULL, nDocs[n]);
+        checkTopDocs(tc, &searcher, &termQuery, true, &evenFilter, nDocs[n]);
+        checkTopDocs(tc, &searcher, &booleanQuery, false, NULL, nDocs[n]);
+        checkTopDocs(tc, &searcher, &booleanQuery, true, &evenFilter, nDocs[n]);
+
+        // the disjunction is scored out of order
+        BooleanQuery::setAllowDocsOutOfOrder(true);
+        checkTopDocs(tc, &searcher, &booleanQuery, false, NULL, nDocs[n]);
+        BooleanQuery::setAllowDocsOutOfOrder(false);
+    }
+
+    // a collector stops the loop, and raises the scorer's threshold
+    ThresholdScorer scorer(Similarity::getDefault(), 20);
+    LimitCollector collector(5);
+    CLUCENE_ASSERT(ScoreLoop::score(&scorer, collector) == ScoreLoop::TERMINATE);
+    CuAssertIntEquals(tc, _T("hits collected"), 5, collector.count);
+    CuAssertIntEquals(tc, _T("thresholds"), 4, (int32_t)scorer.thresholds.size());
+    CLUCENE_ASSERT(scorer.thresholds[3] == 4.0f);
+
+    // the sentinels are not returned, and the threshold rises once the heap holds real hits
+    TopScoreDocCollector top(3);
+    CLUCENE_ASSERT(top.collect(7, 2.0f) == ScoreLoop::CONTINUE);
+    CLUCENE_ASSERT(top.collect(8, 1.0f) == ScoreLoop::CONTINUE);
+    CLUCENE_ASSERT(top.getMinCompetitiveScore() == 0.0f);
+    CLUCENE_ASSERT(top.collect(9, 3.0f) == ScoreLoop::THRESHOLD_RAISED);
+    CLUCENE_ASSERT(top.getMinCompetitiveScore() == 1.0f);
+    CLUCENE_ASSERT(top.collect(10, 0.5f) == ScoreLoop::CONTINUE);
+    CLUCENE_ASSERT(top.collect(11, 0.0f) == ScoreLoop::CONTINUE);
+    CuAssertIntEquals(tc, _T("totalHits"), 4, top.getTotalHits());
+    int32_t length = 0;
+    ScoreDoc* scoreDocs = top.topDocs(length);
+    CuAssertIntEquals(tc, _T("length"), 3, length);
+    CuAssertIntEquals(tc, _T("first"), 9, scoreDocs[0].doc);
+    CuAssertIntEquals(tc, _T("last"), 8, scoreDocs[2].doc);
+    delete[] scoreDocs;
+
+    _CLDECDELETE(ta);
+    _CLDECDELETE(tb);
+    _CLDECDELETE(tc2);
+    _CLDECDELETE(teven);
+    searcher.close();
+}
+
+/** Checks that two searches returned the same top hits */
+static void checkSameTopDocs(CuTest* tc, TopDocs* expected, TopDocs* actual) {
+    CLUCENE_ASSERT(expected != actual);
+    CuAssertIntEquals(tc, _T("totalHits"), expected->totalHits, actual->totalHits);
+    CuAssertIntEquals(tc, _T("number of hits"), expected->scoreDocsLength, actual->scoreDocsLength);
+    for (int32_t i = 0; i < expected->scoreDocsLength; i++) {
+        CuAssertIntEquals(tc, _T("doc"), expected->scoreDocs[i].doc, actual->scoreDocs[i].doc);
+        CLUCENE_ASSERT(expected->scoreDocs[i].score == actual->scoreDocs[i].score);
+    }
+}
+
+/** Searches with and without the cache, and checks the results are the same */
+static void checkCachedSearch(CuTest* tc, IndexSearcher* searcher, Query* query, Filter* filter, const int32_t nDocs, const bool hit) {
+    QueryResultCache* cache = searcher->getQueryResultCache();
+    const int64_t hits = cache->getHitCount();
+    TopDocs* cached = searcher->_search(query, filter, nDocs);
+    CuAssertIntEquals(tc, _T("found in the cache"), hit ? 1 : 0, (int32_t)(cache->getHitCount() - hits));
+
+    searcher->setQueryResultCache(NULL);
+    TopDocs* expected = searcher->_search(query, filter, nDocs);
+    searcher->setQueryResultCache(cache);
+    checkSameTopDocs(tc, expected, cached);
+    _CLLDELETE(expected);
+    _CLLDELETE(cached);
+}
+
+void testQueryResultCache(CuTest *tc) {
+    RAMDirectory dir;
+    WhitespaceAnalyzer an;
+    IndexWriter writer(&dir, &an, true);
+    writer.setMaxBufferedDocs(30);
+    TCHAR num[10];
+    for (int32_t i = 0; i < 100; i++) {
+        Document doc;
+        doc.add(*_CLNEW Field(_T("content"), i % 3 == 0 ? _T("a b") : _T("a"), Field::INDEX_TOKENIZED));
+        doc.add(*_CLNEW Field(_T("parity"), i % 2 == 0 ? _T("even") : _T("odd"), Field::INDEX_UNTOKENIZED));
+        _i64tot(100 - i, num, 10);
+        doc.add(*_CLNEW Field(_T("num"), num, Field::INDEX_UNTOKENIZED));
+        writer.addDocument(&doc);
+    }
+    writer.close();
+
+    IndexReader* reader = IndexReader::open(&dir);
+    IndexSearcher searcher(reader);
+    QueryResultCache cache;
+    searcher.setQueryResultCache(&cache);
+    Term* ta = _CLNEW Term(_T("content"), _T("a"));
+    Term* tb = _CLNEW Term(_T("content"), _T("b"));
+    Term* teven = _CLNEW Term(_T("parity"), _T("even"));
+    TermQuery queryA(ta);
+    TermQuery queryB(tb);
+    QueryFilter evenFilter(_CLNEW TermQuery(teven), true);
+
+    // a repeated search is found, a search for more hits is not
+    checkCachedSearch(tc, &searcher, &queryB, NULL, 10, false);
+    checkCachedSearch(tc, &searcher, &queryB, NULL, 10, true);
+    checkCachedSearch(tc, &searcher, &queryB, NULL, 20, false);
+    TermQuery equalQuery(tb);
+    checkCachedSearch(tc, &searcher, &equalQuery, NULL, 10, true);
+
+    // the filter is part of the key
+    checkCachedSearch(tc, &searcher, &queryB, &evenFilter, 10, false);
+    checkCachedSearch(tc, &searcher, &queryB, &evenFilter, 10, true);
+    RangeFilter inclusive(_T("num"), _T("50"), _T("60"), true, true);
+    RangeFilter exclusive(_T("num"), _T("50"), _T("60"), false, false);
+    RangeFilter inclusiveAgain(_T("num"), _T("50"), _T("60"), true, true);
+    checkCachedSearch(tc, &searcher, &queryA, &inclusive, 20, false);
+    checkCachedSearch(tc, &searcher, &queryA, &exclusive, 20, false);
+    checkCachedSearch(tc, &searcher, &queryA, &inclusiveAgain, 20, true);
+
+    // sorted searches are cached with their sort values
+    Sort sort(_T("num"));
+    TopFieldDocs* sorted = searcher._search(&queryA, NULL, 5, &sort);
+    const int64_t hits = cache.getHitCount();
+    TopFieldDocs* cachedSorted = searcher._search(&queryA, NULL, 5, &sort);
+    CuAssertIntEquals(tc, _T("sorted search found"), 1, (int32_t)(cache.getHitCount() - hits));
+    checkSameTopDocs(tc, sorted, cachedSorted);
+    CuAssertIntEquals(tc, _T("first by num"), 99, cachedSorted->scoreDocs[0].doc);
+    CuAssertIntEquals(tc, _T("sort value"), 1, static_cast<Compare::Int32*>(cachedSorted->fieldDocs[0]->fields[0])->getValue());
+    CLUCENE_ASSERT(cachedSorted->fields[0]->getField() != NULL);
+    _CLLDELETE(sorted);
+    _CLLDELETE(cachedSorted);
+    Sort reverse(_T("num"), true);
+    TopFieldDocs* reversed = searcher._search(&queryA, NULL, 5, &reverse);
+    CuAssertIntEquals(tc, _T("first by reverse num"), 0, reversed->scoreDocs[0].doc);
+    _CLLDELETE(reversed);
+
+    // a deletion changes the segment, and the search is not found
+    reader->deleteDocument(3);
+    checkCachedSearch(tc, &searcher, &queryB, NULL, 10, false);
+    TopDocs* afterDelete = searcher._search(&queryB, NULL, 100);
+    CuAssertIntEquals(tc, _T("hits after delete"), 33, afterDelete->totalHits);
+    _CLLDELETE(afterDelete);
+
+    // closing the reader drops its entries
+    CLUCENE_ASSERT(cache.size() > 0);
+    CLUCENE_ASSERT(cache.getSizeInBytes() > 0);
+    searcher.close();
+    reader->close();
+    CuAssertIntEquals(tc, _T("entries after close"), 0, (int32_t)cache.size());
+    CuAssertIntEquals(tc, _T("bytes after close"), 0, (int32_t)cache.getSizeInBytes());
+    _CLDELETE(reader);
+
+    // a full cache evicts the least recently, or the least frequently, used entry
+    reader = IndexReader::open(&dir);
+    IndexSearcher small(reader);
+    QueryResultCache lru(1);
+    small.setQueryResultCache(&lru);
+    TopDocs* tooLarge = small._search(&queryA, NULL, 10);
+    CuAssertIntEquals(tc, _T("larger than the cache"), 0, (int32_t)lru.size());
+    _CLLDELETE(tooLarge);
+
+    const int32_t sizes[] = { 1, 2, 3 };
+    for (int32_t p = 0; p < 2; p++) {
+        QueryResultCache measure;
+        small.setQueryResultCache(&measure);
+        for (int32_t i = 0; i < 3; i++)
+            _CLLDELETE(small._search(&queryA, NULL, sizes[i]));
+        // room for two of the three entries
+        QueryResultCache bounded(measure.getSizeInBytes() - 1, p == 0 ? QueryResultCache::LRU : QueryResultCache::LFU);
+        small.setQueryResultCache(&bounded);
+        _CLLDELETE(small._search(&queryA, NULL, 1));
+        _CLLDELETE(small._search(&queryA, NULL, 1));
+        _CLLDELETE(small._search(&queryA, NULL, 2));
+        _CLLDELETE(small._search(&queryA, NULL, 3));
+        CuAssertIntEquals(tc, _T("evictions"), 1, (int32_t)bounded.getEvictionCount());
+        CuAssertIntEquals(tc, _T("entries"), 2, (int32_t)bounded.size());
+        CLUCENE_ASSERT(bounded.getSizeInBytes() <= bounded.getMaxBytes());
+
+        // LRU evicted the entry for 1 hit, LFU the entry for 2 hits, which was never found
+        const int64_t found = bounded.getHitCount();
+        _CLLDELETE(small._search(&queryA, NULL, 1));
+        CuAssertIntEquals(tc, _T("kept"), p == 0 ? 0 : 1, (int32_t)(bounded.getHitCount() - found));
+        small.setQueryResultCache(NULL);
+    }
+
+    _CLDECDELETE(ta);
+    _CLDECDELETE(tb);
+    _CLDECDELETE(teven);
+    small.close();
+    reader->close();
+    _CLDELETE(reader);
+}
+
+/** Adds documents <code>from</code> to <code>to</code>, in segments of 30 */
+static void addFilterCacheDocs(Directory* dir, const int32_t from, const int32_t to) {
+    WhitespaceAnalyzer an;
+    IndexWriter writer(dir, &an, from == 0);
+    writer.setMaxBufferedDocs(30);
+    TCHAR num[10];
+    for (int32_t i = from; i < to; i++) {
+        Document doc;
+        doc.add(*_CLNEW Field(_T("content"), i % 3 == 0 ? _T("a b") : _T("a"), Field::INDEX_TOKENIZED));
+        doc.add(*_CLNEW Field(_T("parity"), i % 2 == 0 ? _T("even") : _T("odd"), Field::INDEX_UNTOKENIZED));
+        _i64tot(1000 - i, num, 10);
+        doc.add(*_CLNEW Field(_T("num"), num, Field::INDEX_UNTOKENIZED));
+        writer.addDocument(&doc);
+    }
+    writer.close();
+}
+
+void testFilterCache(CuTest *tc) {
+    // few documents are listed, many are held as bits
+    BitSet few(1000);
+    few.set(3);
+    few.set(500);
+    few.set(999);
+    DocIdSet* sparse = DocIdSet::compact(&few);
+    CLUCENE_ASSERT(sparse->isSparse());
+    CuAssertIntEquals(tc, _T("first"), 3, sparse->nextSetBit(0));
+    CuAssertIntEquals(tc, _T("next"), 500, sparse->nextSetBit(4));
+    CuAssertIntEquals(tc, _T("last"), 999, sparse->nextSetBit(999));
+    CuAssertIntEquals(tc, _T("none"), -1, sparse->nextSetBit(1000));
+    CLUCENE_ASSERT(sparse->get(500) && !sparse->get(501));
+    _CLDECDELETE(sparse);
+    BitSet many(1000);
+    for (int32_t i = 0; i < 1000; i += 2)
+        many.set(i);
+    DocIdSet* dense = DocIdSet::compact(&many);
+    CLUCENE_ASSERT(!dense->isSparse());
+    CuAssertIntEquals(tc, _T("dense next"), 2, dense->nextSetBit(1));
+    CLUCENE_ASSERT(dense->getSizeInBytes() < 1000);
+    _CLDECDELETE(dense);
+
+    RAMDirectory dir;
+    addFilterCacheDocs(&dir, 0, 100);                     // 4 segments
+    IndexReader* reader = IndexReader::open(&dir);
+    IndexSearcher searcher(reader);
+    FilterCache cache(1024 * 1024, 2, 8);
+    searcher.setFilterCache(&cache);
+    Term* ta = _CLNEW Term(_T("content"), _T("a"));
+    Term* tb = _CLNEW Term(_T("content"), _T("b"));
+    Term* teven = _CLNEW Term(_T("parity"), _T("even"));
+    TermQuery queryA(ta);
+    QueryFilter evenFilter(_CLNEW TermQuery(teven), true);
+
+    // a filter is cached for each segment once it was used twice
+    checkTopDocs(tc, &searcher, &queryA, true, &evenFilter, 10);
+    CuAssertIntEquals(tc, _T("uses"), 1, cache.getUseCount(&evenFilter));
+    CuAssertIntEquals(tc, _T("not cached yet"), 0, (int32_t)cache.size());
+    checkTopDocs(tc, &searcher, &queryA, true, &evenFilter, 10);
+    CuAssertIntEquals(tc, _T("segments cached"), 4, (int32_t)cache.size());
+    int64_t hits = cache.getHitCount();
+    checkTopDocs(tc, &searcher, &queryA, true, &evenFilter, 10);
+    CuAssertIntEquals(tc, _T("segments found"), 4, (int32_t)(cache.getHitCount() - hits));
+
+    // sorted searches and hit collectors are filtered through the cache too
+    Sort sort(_T("num"));
+    TopFieldDocs* sorted = searcher._search(&queryA, &evenFilter, 5, &sort);
+    CuAssertIntEquals(tc, _T("sorted hits"), 50, sorted->totalHits);
+    CuAssertIntEquals(tc, _T("first by num"), 98, sorted->scoreDocs[0].doc);
+    _CLLDELETE(sorted);
+    AllHitsCollector all;
+    searcher._search(&queryA, &evenFilter, &all);
+    CuAssertIntEquals(tc, _T("collected"), 50, (int32_t)all.hits.size());
+
+    // and so are the filters of constant score queries
+    ConstantScoreQuery constant(_CLNEW QueryFilter(_CLNEW TermQuery(tb), true));
+    for (int32_t i = 0; i < 3; i++) {
+        TopDocs* topDocs = searcher._search(&constant, NULL, 100);
+        CuAssertIntEquals(tc, _T("constant score hits"), 34, topDocs->totalHits);
+        _CLLDELETE(topDocs);
+    }
+    CuAssertIntEquals(tc, _T("both cached"), 8, (int32_t)cache.size());
+
+    // a filter not used in the recent searches is no longer counted
+    for (int32_t i = 0; i < 8; i++)
+        _CLLDELETE(searcher._search(&queryA, &evenFilter, 1));
+    CuAssertIntEquals(tc, _T("forgotten"), 0, cache.getUseCount(constant.getFilter()));
+    CuAssertIntEquals(tc, _T("history"), 8, cache.getUseCount(&evenFilter));
+
+    // a reopened index finds the results of the segments it kept
+    addFilterCacheDocs(&dir, 100, 110);
+    IndexReader* reopened = reader->reopen();
+    CLUCENE_ASSERT(reopened != reader);
+    searcher.close();
+    reader->close();
+    _CLDELETE(reader);
+    CuAssertIntEquals(tc, _T("kept"), 8, (int32_t)cache.size());
+    IndexSearcher searcher2(reopened);
+    searcher2.setFilterCache(&cache);
+    hits = cache.getHitCount();
+    const int64_t misses = cache.getMissCount();
+    TopDocs* afterReopen = searcher2._search(&queryA, &evenFilter, 200);
+    CuAssertIntEquals(tc, _T("hits after reopen"), 55, afterReopen->totalHits);
+    CuAssertIntEquals(tc, _T("kept segments found"), 4, (int32_t)(cache.getHitCount() - hits));
+    CuAssertIntEquals(tc, _T("new segment computed"), 1, (int32_t)(cache.getMissCount() - misses));
+    _CLLDELETE(afterReopen);
+
+    // the cache holds no more than its budget
+    FilterCache measure(1024 * 1024, 1);
+    searcher2.setFilterCache(&measure);
+    _CLLDELETE(searcher2._search(&queryA, &evenFilter, 1));
+    CuAssertIntEquals(tc, _T("measured"), 5, (int32_t)measure.size());
+    FilterCache bounded(measure.getSizeInBytes() - 1, 1);
+    searcher2.setFilterCache(&bounded);
+    _CLLDELETE(searcher2._search(&queryA, &evenFilter, 1));
+    CuAssertIntEquals(tc, _T("evicted"), 1, (int32_t)bounded.getEvictionCount());
+    CuAssertIntEquals(tc, _T("bounded entries"), 4, (int32_t)bounded.size());
+    CLUCENE_ASSERT(bounded.getSizeInBytes() <= bounded.getMaxBytes());
+
+    // filters that print alike but permit different documents are told apart
+    FilterCache ranges(1024 * 1024, 1);
+    searcher2.setFilterCache(&ranges);
+    RangeFilter inclusive(_T("num"), _T("950"), _T("960"), true, true);
+    RangeFilter exclusive(_T("num"), _T("950"), _T("960"), false, false);
+    CLUCENE_ASSERT(inclusive.toString() == exclusive.toString());
+    CLUCENE_ASSERT(!inclusive.equals(&exclusive));
+    TopDocs* ranged = searcher2._search(&queryA, &inclusive, 20);
+    CuAssertIntEquals(tc, _T("inclusive range"), 11, ranged->totalHits);
+    _CLLDELETE(ranged);
+    ranged = searcher2._search(&queryA, &exclusive, 20);
+    CuAssertIntEquals(tc, _T("exclusive range"), 9, ranged->totalHits);
+    _CLLDELETE(ranged);
+    CuAssertIntEquals(tc, _T("both ranges cached"), 10, (int32_t)ranges.size());
+    RangeFilter inclusiveAgain(_T("num"), _T("950"), _T("960"), true, true);
+    hits = ranges.getHitCount();
+    ranged = searcher2._search(&queryA, &inclusiveAgain, 20);
+    CuAssertIntEquals(tc, _T("equal range"), 11, ranged->totalHits);
+    _CLLDELETE(ranged);
+    CuAssertIntEquals(tc, _T("equal range found"), 5, (int32_t)(ranges.getHitCount() - hits));
+
+    // closing the segments drops their results
+    searcher2.close();
+    reopened->close();
+    _CLDELETE(reopened);
+    CuAssertIntEquals(tc, _T("entries after close"), 0, (int32_t)cache.size());
+    CuAssertIntEquals(tc, _T("bytes after close"), 0, (int32_t)cache.getSizeInBytes());
+    CuAssertIntEquals(tc, _T("bounded after close"), 0, (int32_t)bounded.size());
+
+    _CLDECDELETE(ta);
+    _CLDECDELETE(tb);
+    _CLDECDELETE(teven);
+}
+
+/** Adds documents <code>from</code> to <code>to</code>, all of the same
+* length. Every document has a, and some many more times than the others;
+* some have b, few c. */
+static void addImpactTierDocs(IndexWriter* writer, const int32_t from, const int32_t to) {
+    for (int32_t i = from; i < to; i++) {
+        Document doc;
+        std::wstring content;
+        const int32_t as = i % 40 == 0 ? 20 + i / 40 : 1 + (i * 7) % 13;
+        const int32_t bs = i % 30 == 5 ? 15 + i / 30 : (i % 3 == 0 ? 1 : 0);
+        const int32_t cs = i % 50 == 0 ? 1 : 0;
+        for (int32_t j = 0; j < as; j++)
+            content.append(_T("a "));
+        for (int32_t j = 0; j < bs; j++)
+            content.append(_T("b "));
+        for (int32_t j = 0; j < cs; j++)
+            content.append(_T("c "));
+        for (int32_t j = as + bs + cs; j < 60; j++)
+            content.append(_T("x "));
+        doc.add(*_CLNEW Field(_T("content"), content.c_str(), Field::INDEX_TOKENIZED | Field::INDEX_IMPACTTIERS));
+        writer->addDocument(&doc);
+    }
+}
+
+/** Searches with and without the impact tiers, and checks the top hits are
+* the same. Returns the number of hits the search with tiers counted. */
+static int32_t checkImpactTierSearch(CuTest* tc, IndexSearcher* searcher, Query* query, const int32_t nDocs) {
+    searcher->setImpactTiers(false);
+    TopDocs* expected = searcher->_search(query, NULL, nDocs);
+    searcher->setImpactTiers(true);
+    TopDocs* tiered = searcher->_search(query, NULL, nDocs);
+    searcher->setImpactTiers(false);
+
+    CLUCENE_ASSERT(tiered->totalHits <= expected->totalHits);
+    CuAssertIntEquals(tc, _T("number of hits"), expected->scoreDocsLength, tiered->scoreDocsLength);
+    for (int32_t i = 0; i < expected->scoreDocsLength; i++) {
+        CuAssertIntEquals(tc, _T("doc"), expected->scoreDocs[i].doc, tiered->scoreDocs[i].doc);
+        CLUCENE_ASSERT(expected->scoreDocs[i].score == tiered->scoreDocs[i].score);
+    }
+    const int32_t totalHits = tiered->totalHits;
+    _CLLDELETE(expected);
+    _CLLDELETE(tiered);
+    return totalHits;
+}
+
+void testImpactTiers(CuTest *tc) {
+    RAMDirectory dir;
+    WhitespaceAnalyzer an;
+    IndexWriter* writer = _CLNEW IndexWriter(&dir, &an, true);
+    writer->setMaxBufferedDocs(100);
+    writer->setImpactTierSize(8);
+    CuAssertIntEquals(tc, _T("tier size"), 8, writer->getImpactTierSize());
+    try {
+        writer->setImpactTierSize(0);
+        CuFail(tc, _T("expected an empty tier to fail"));
+    } catch (CLuceneError& err) {
+        CuAssertEquals(tc, CL_ERR_IllegalArgument, err.number());
+    }
+    addImpactTierDocs(writer, 0, 600);
+    writer->optimize();                                   // the merge writes the tiers
+    addImpactTierDocs(writer, 600, 650);                  // a flushed segment has none
+    writer->close();
+    _CLDELETE(writer);
+
+    IndexReader* reader = IndexReader::open(&dir);
+    reader->deleteDocument(560);                          // in the tier of a
+    reader->deleteDocument(575);                          // in the tier of b
+    const ArrayBase<IndexReader*>* segments = reader->getSubReaders();
+    CuAssertIntEquals(tc, _T("segments"), 2, (int32_t)segments->length);
+    Term* ta = _CLNEW Term(_T("content"), _T("a"));
+    Term* tb = _CLNEW Term(_T("content"), _T("b"));
+    Term* tc2 = _CLNEW Term(_T("content"), _T("c"));
+    const ImpactTier* tier = segments->values[0]->getImpactTier(ta);
+    CLUCENE_ASSERT(tier != NULL);
+    CuAssertIntEquals(tc, _T("tier docs"), 8, (int32_t)tier->docs.size());
+    CuAssertIntEquals(tc, _T("first tier doc"), 280, tier->docs[0]);
+    CuAssertIntEquals(tc, _T("last tier doc"), 560, tier->docs[7]);
+    CLUCENE_ASSERT(segments->values[0]->getImpactTier(tc2) == NULL);   // too rare for a tier
+    CLUCENE_ASSERT(segments->values[1]->getImpactTier(ta) == NULL);
+
+    IndexSearcher searcher(reader);
+    TermQuery queryA(ta);
+    TermQuery queryB(tb);
+    BooleanQuery either;
+    either.add(_CLNEW TermQuery(ta), true, BooleanClause::SHOULD);
+    either.add(_CLNEW TermQuery(tb), true, BooleanClause::SHOULD);
+    BooleanQuery eitherNotC;
+    eitherNotC.add(_CLNEW TermQuery(ta), true, BooleanClause::SHOULD);
+    eitherNotC.add(_CLNEW TermQuery(tb), true, BooleanClause::SHOULD);
+    eitherNotC.add(_CLNEW TermQuery(tc2), true, BooleanClause::MUST_NOT);
+
+    // the documents outside the tiers are skipped once none can be a top hit
+    CLUCENE_ASSERT(checkImpactTierSearch(tc, &searcher, &queryA, 5) < 648);
+    CLUCENE_ASSERT(checkImpactTierSearch(tc, &searcher, &queryB, 5) < 238);
+    CLUCENE_ASSERT(checkImpactTierSearch(tc, &searcher, &either, 1) < 648);
+    CLUCENE_ASSERT(checkImpactTierSearch(tc, &searcher, &eitherNotC, 1) < 635);
+    // but not while they can, and the tiers are not scored twice
+    CuAssertIntEquals(tc, _T("every hit"), 648, checkImpactTierSearch(tc, &searcher, &queryA, 20));
+    const int32_t nDocs[] = { 3, 10, 100 };
+    for (int32_t n = 0; n < 3; n++) {
+        checkImpactTierSearch(tc, &searcher, &queryA, nDocs[n]);
+        checkImpactTierSearch(tc, &searcher, &either, nDocs[n]);
+        checkImpactTierSearch(tc, &searcher, &eitherNotC, nDocs[n]);
+    }
+
+    // changed norms no longer agree with the tiers
+    reader->setNorm(100, _T("content"), 1.0f);
+    CLUCENE_ASSERT(segments->values[0]->getImpactTier(ta) == NULL);
+    CuAssertIntEquals(tc, _T("every hit after setNorm"), 648, checkImpactTierSearch(tc, &searcher, &queryA, 5));
+
+    _CLDECDELETE(ta);
+    _CLDECDELETE(tb);
+    _CLDECDELETE(tc2);
+    searcher.close();
+    reader->close();
+    _CLDELETE(reader);
+}
+
 CuSuite *testIndexSearcher(void)
 {
     CuSuite *suite = CuSuiteNew(_T("CLucene IndexSearcher Test"));
 
     SUITE_ADD_TEST(suite, testEndThreadException);
+    SUITE_ADD_TEST(suite, testTopScoreDocs);
+    SUITE_ADD_TEST(suite, testQueryResultCache);
+    SUITE_ADD_TEST(suite, testFilterCache);
+    SUITE_ADD_TEST(suite, testImpactTiers);
 
     return suite;
   }
@@ -8,7 +8,13 @@
 ------------------------------------------------------------------------------*/
 #include "test.h"
 #include "CLucene/search/MultiPhraseQuery.h"
+#include "CLucene/search/ConstantScoreQuery.h"
+#include "CLucene/search/QueryFilter.h"
+#include "CLucene/search/Scorer.h"
+#include "CLucene/search/spans/SpanTermQuery.h"
+#include "CLucene/search/spans/SpanNearQuery.h"
 #include "QueryUtils.h"
+#include <algorithm>
 
 /// Java PrefixQuery test, 2009-06-02
 void testPrefixQuery(CuTest *tc){
@@ -268,6 +274,63 @@ public:
         searcher.close();
         directory.close();
     }
+
+	void testMaxExpansions() {
+		RAMDirectory directory;
+		WhitespaceAnalyzer a;
+		IndexWriter writer(&directory, &a, true);
+		addDoc(_T("aaaaa"), &writer);
+		addDoc(_T("aaaab"), &writer);
+		addDoc(_T("aaabb"), &writer);
+		addDoc(_T("aabbb"), &writer);
+		addDoc(_T("abaaa"), &writer);
+		addDoc(_T("\u00e9aaaa"), &writer);
+		writer.optimize();
+		writer.close();
+		IndexSearcher searcher(&directory);
+
+		// "aaaaa", "aaaab", "abaaa", "\u00e9aaaa" and "aaabb" are all within two edits
+		CLUCENE_ASSERT( getHitsLength(&searcher, _T("field"), _T("aaaaa")) == 5);
+
+		// only the most similar terms are kept
+		Term* t = _CLNEW Term(_T("field"), _T("aaaaa"));
+		FuzzyQuery* query = _CLNEW FuzzyQuery(t, FuzzyQuery::defaultMinSimilarity, 0, 1);
+		Hits* hits = searcher.search(query);
+		CLUCENE_ASSERT( hits->length() == 1);
+		CuAssertStrEquals(tc, NULL, _T("aaaaa"), hits->doc(0).get(_T("field")));
+		_CLLDELETE(hits);
+
+		Query* clone = query->clone();
+		CLUCENE_ASSERT( query->equals(clone) );
+		_CLLDELETE(clone);
+		_CLLDELETE(query);
+
+		query = _CLNEW FuzzyQuery(t, FuzzyQuery::defaultMinSimilarity, 0, 0);
+		hits = searcher.search(query);
+		CLUCENE_ASSERT( hits->length() == 0);
+		_CLLDELETE(hits);
+		_CLLDELETE(query);
+
+		// the constant score rewrites match every similar term
+		query = _CLNEW FuzzyQuery(t, FuzzyQuery::defaultMinSimilarity, 0, 1);
+		query->setRewriteMethod(MultiTermQuery::CONSTANT_SCORE_FILTER_REWRITE);
+		Query* rewritten = query->rewrite(searcher.getReader());
+		CLUCENE_ASSERT( rewritten->instanceOf(ConstantScoreQuery::getClassName()) );
+		_CLLDELETE(rewritten);
+		hits = searcher.search(query);
+		CLUCENE_ASSERT( hits->length() == 5);
+		CLUCENE_ASSERT( hits->score(0) == hits->score(4) );
+		_CLLDELETE(hits);
+		query->setRewriteMethod(MultiTermQuery::CONSTANT_SCORE_AUTO_REWRITE);
+		hits = searcher.search(query);
+		CLUCENE_ASSERT( hits->length() == 5);
+		_CLLDELETE(hits);
+		_CLLDELETE(query);
+		_CLLDECDELETE(t);
+
+		searcher.close();
+		directory.close();
+	}
 };
 
 void testFuzzyQuery(CuTest *tc){
@@ -275,6 +338,7 @@ void testFuzzyQuery(CuTest *tc){
 	/// Run Java Lucene tests
 	TestFuzzyQuery tester(tc);
 	tester.testFuzziness();
+	tester.testMaxExpansions();
 
 	/// Legacy CLucene tests
 	RAMDirectory ram;
@@ -367,12 +431,191 @@ void testMultiPhraseQuery( CuTest * tc )
     _CLLDELETE( pClone );
 }
 
+void testMultiTermRewrite(CuTest *tc){
+	WhitespaceAnalyzer analyzer;
+	RAMDirectory directory;
+	IndexWriter writer( &directory, &analyzer, true);
+	wchar_t text[20];
+	for (int i = 0; i < 1500; i++) {
+		Document doc;
+		_snwprintf(text, 20, _T("term%04d"), i);
+		doc.add(*_CLNEW Field(_T("field"), text, Field::STORE_YES | Field::INDEX_UNTOKENIZED));
+		writer.addDocument(&doc);
+	}
+	writer.close();
+
+	IndexReader* reader = IndexReader::open(&directory);
+	IndexSearcher searcher(reader);
+	Term* t = _CLNEW Term(_T("field"), _T("term"));
+	PrefixQuery* query = _CLNEW PrefixQuery(t);
+	CLUCENE_ASSERT(query->getRewriteMethod() == MultiTermQuery::SCORING_BOOLEAN_QUERY_REWRITE);
+
+	// more terms than the BooleanQuery clause limit
+	try {
+		Hits* hits = searcher.search(query);
+		_CLDELETE(hits);
+		CuFail(tc, _T("Expected TooManyClauses"));
+	} catch (CLuceneError& e) {
+		CLUCENE_ASSERT(e.number() == CL_ERR_TooManyClauses);
+	}
+
+	query->setRewriteMethod(MultiTermQuery::CONSTANT_SCORE_FILTER_REWRITE);
+	Hits* hits = searcher.search(query);
+	CLUCENE_ASSERT(1500 == hits->length());
+	CLUCENE_ASSERT(hits->score(0) == hits->score(1499));
+	_CLDELETE(hits);
+
+	// the automatic rewrite switches to a filter for this many terms...
+	query->setRewriteMethod(MultiTermQuery::CONSTANT_SCORE_AUTO_REWRITE);
+	Query* rewritten = query->rewrite(reader);
+	CLUCENE_ASSERT(rewritten->instanceOf(ConstantScoreQuery::getClassName()));
+	_CLDELETE(rewritten);
+	hits = searcher.search(query);
+	CLUCENE_ASSERT(1500 == hits->length());
+	_CLDELETE(hits);
+	_CLDELETE(query);
+	_CLDECDELETE(t);
+
+	// ...but keeps scoring a single rare term
+	t = _CLNEW Term(_T("field"), _T("term0042"));
+	query = _CLNEW PrefixQuery(t);
+	query->setRewriteMethod(MultiTermQuery::CONSTANT_SCORE_AUTO_REWRITE);
+	rewritten = query->rewrite(reader);
+	CLUCENE_ASSERT(rewritten->instanceOf(TermQuery::getClassName()));
+	_CLDELETE(rewritten);
+	_CLDELETE(query);
+	_CLDECDELETE(t);
+
+	t = _CLNEW Term(_T("field"), _T("term1*"));
+	WildcardQuery* wildcard = _CLNEW WildcardQuery(t);
+	wildcard->setRewriteMethod(MultiTermQuery::CONSTANT_SCORE_FILTER_REWRITE);
+	hits = searcher.search(wildcard);
+	CLUCENE_ASSERT(500 == hits->length());
+	_CLDELETE(hits);
+	Query* clone = wildcard->clone();
+	CLUCENE_ASSERT(wildcard->equals(clone));
+	_CLDELETE(clone);
+	_CLDELETE(wildcard);
+	_CLDECDELETE(t);
+
+	searcher.close();
+	reader->close();
+	_CLDELETE(reader);
+}
+
+/// checks that the query (and filter) match exactly the documents in expected, given in ascending order
+void _checkDocs(CuTest *tc, Searcher* searcher, Query* query, Filter* filter, const int32_t* expected, size_t expectedLength){
+	Hits* hits = searcher->search(query, filter);
+	CLUCENE_ASSERT(hits->length() == expectedLength);
+	std::vector<int32_t> ids;
+	for (size_t i = 0; i < hits->length(); i++)
+		ids.push_back(hits->id(i));
+	std::sort(ids.begin(), ids.end());
+	for (size_t i = 0; i < ids.size() && i < expectedLength; i++)
+		CLUCENE_ASSERT(ids[i] == expected[i]);
+	_CLDELETE(hits);
+}
+
+void testTwoPhasePhrase(CuTest *tc){
+	WhitespaceAnalyzer analyzer;
+	RAMDirectory directory;
+	IndexWriter writer( &directory, &analyzer, true);
+	const wchar_t* texts[] = { _T("a b c"), _T("b a c"), _T("a b d"), _T("a x b c"), _T("c a b"), NULL };
+	for (int i = 0; texts[i] != NULL; i++) {
+		Document doc;
+		doc.add(*_CLNEW Field(_T("body"), texts[i], Field::STORE_YES | Field::INDEX_TOKENIZED));
+		writer.addDocument(&doc);
+	}
+	writer.close();
+
+	IndexReader* reader = IndexReader::open(&directory);
+	IndexSearcher searcher(reader);
+	Term* a = _CLNEW Term(_T("body"), _T("a"));
+	Term* b = _CLNEW Term(_T("body"), _T("b"));
+	Term* c = _CLNEW Term(_T("body"), _T("c"));
+	Term* x = _CLNEW Term(_T("body"), _T("x"));
+
+	// every doc with both terms is a candidate, only the phrases match
+	PhraseQuery* phrase = _CLNEW PhraseQuery();
+	phrase->add(a);
+	phrase->add(b);
+	Weight* weight = phrase->weight(&searcher);
+	Scorer* scorer = weight->scorer(reader);
+	int32_t candidates = 0, matches = 0;
+	while (scorer->nextCandidate()) {
+		candidates++;
+		if (scorer->matches())
+			matches++;
+	}
+	CLUCENE_ASSERT(candidates == 5);
+	CLUCENE_ASSERT(matches == 3);
+	_CLDELETE(scorer);
+	scorer = weight->scorer(reader);
+	CLUCENE_ASSERT(scorer->skipTo(3));
+	CLUCENE_ASSERT(scorer->doc() == 4);
+	CLUCENE_ASSERT(!scorer->next());
+	_CLDELETE(scorer);
+	_CLDELETE(weight);
+
+	const int32_t phraseDocs[] = { 0, 2, 4 };
+	_checkDocs(tc, &searcher, phrase, NULL, phraseDocs, 3);
+
+	// confirmed only where the conjunction or the filter agrees
+	const int32_t phraseAndC[] = { 0, 4 };
+	BooleanQuery* bq = _CLNEW BooleanQuery();
+	bq->add(phrase, true, BooleanClause::MUST);
+	bq->add(_CLNEW TermQuery(c), true, BooleanClause::MUST);
+	_checkDocs(tc, &searcher, bq, NULL, phraseAndC, 2);
+	_CLDELETE(bq);
+
+	phrase = _CLNEW PhraseQuery();
+	phrase->add(a);
+	phrase->add(b);
+	QueryFilter filter(_CLNEW TermQuery(c), true);
+	_checkDocs(tc, &searcher, phrase, &filter, phraseAndC, 2);
+	_CLDELETE(phrase);
+
+	MultiPhraseQuery* multiPhrase = _CLNEW MultiPhraseQuery();
+	multiPhrase->add(a);
+	CL_NS(util)::ValueArray<CL_NS(index)::Term*> bx( 2 );
+	bx[0] = b;
+	bx[1] = x;
+	multiPhrase->add(&bx);
+	const int32_t multiPhraseAndC[] = { 0, 3, 4 };
+	bq = _CLNEW BooleanQuery();
+	bq->add(multiPhrase, true, BooleanClause::MUST);
+	bq->add(_CLNEW TermQuery(c), true, BooleanClause::MUST);
+	_checkDocs(tc, &searcher, bq, NULL, multiPhraseAndC, 3);
+	_CLDELETE(bq);
+
+	CL_NS2(search,spans)::SpanQuery* clauses[2];
+	clauses[0] = _CLNEW CL_NS2(search,spans)::SpanTermQuery(a);
+	clauses[1] = _CLNEW CL_NS2(search,spans)::SpanTermQuery(b);
+	CL_NS2(search,spans)::SpanNearQuery* nearQuery = _CLNEW CL_NS2(search,spans)::SpanNearQuery(clauses, clauses + 2, 1, true, true);
+	_checkDocs(tc, &searcher, nearQuery, &filter, multiPhraseAndC, 3);
+	bq = _CLNEW BooleanQuery();
+	bq->add(nearQuery, true, BooleanClause::MUST);
+	bq->add(_CLNEW TermQuery(c), true, BooleanClause::MUST);
+	_checkDocs(tc, &searcher, bq, NULL, multiPhraseAndC, 3);
+	_CLDELETE(bq);
+
+	_CLDECDELETE(a);
+	_CLDECDELETE(b);
+	_CLDECDELETE(c);
+	_CLDECDELETE(x);
+	searcher.close();
+	reader->close();
+	_CLDELETE(reader);
+}
+
 CuSuite *testqueries(void)
 {
 	CuSuite *suite = CuSuiteNew(_T("CLucene Queries Test"));
 
 	SUITE_ADD_TEST(suite, testPrefixQuery);
+	SUITE_ADD_TEST(suite, testMultiTermRewrite);
 	SUITE_ADD_TEST(suite, testMultiPhraseQuery);
+	SUITE_ADD_TEST(suite, testTwoPhasePhrase);
 	#ifndef NO_FUZZY_QUERY
 		SUITE_ADD_TEST(suite, testFuzzyQuery);
 	#else
@@ -7,6 +7,8 @@
 * the GNU Lesser General Public License, as specified in the COPYING file.
 ------------------------------------------------------------------------------*/
 #include "test.h"
+#include "CLucene/search/FieldSortedHitQueue.h"
+#include "CLucene/search/_FieldDocSortedHitQueue.h"
 /**
  * Unit tests for sorting code.
  *
@@ -555,6 +557,286 @@ void testNormalizedScores(CuTest *tc)
     _CLDELETE(scoresA);
 }
 
+class SortHitRecorder : public HitCollector
+{
+public:
+    std::vector<ScoreDoc> hits;
+    void collect(const int32_t doc, const float_t score)
+    {
+        ScoreDoc hit = { doc, score };
+        if (score > 0.0f)
+            hits.push_back(hit);
+    }
+};
+
+// the top hits of a sorted search must be those a FieldSortedHitQueue keeps of all the hits
+void sortTopMatches(CuTest* tc, IndexSearcher* searcher, Query* query, Sort* sort, int32_t nDocs)
+{
+    SortHitRecorder recorder;
+    searcher->_search(query, NULL, &recorder);
+    FieldSortedHitQueue expected(searcher->getReader(), sort->getSort(), nDocs);
+    for (size_t i = 0; i < recorder.hits.size(); i++)
+        expected.insert(_CLNEW FieldDoc(recorder.hits[i].doc, recorder.hits[i].score));
+
+    TopFieldDocs* docs = searcher->_search(query, NULL, nDocs, sort);
+    CuAssertEquals(tc, (int32_t)recorder.hits.size(), docs->totalHits);
+    CuAssertEquals(tc, (int32_t)expected.size(), docs->scoreDocsLength);
+    for (int32_t i = docs->scoreDocsLength - 1; i >= 0; i--) {
+        FieldDoc* hit = expected.pop();
+        CuAssertEquals(tc, hit->scoreDoc.doc, docs->fieldDocs[i]->scoreDoc.doc);
+        _CLDELETE(hit);
+    }
+    _CLDELETE(docs);
+}
+
+// many hits with equal keys, in several segments, keeping fewer hits than match
+void testSortTopDocs(CuTest *tc)
+{
+    RAMDirectory dir;
+    WhitespaceAnalyzer analyzer;
+    IndexWriter writer(&dir, &analyzer, true);
+    writer.setMaxBufferedDocs(50);
+    for (int32_t i = 0; i < 300; i++) {
+        Document doc;
+        std::wstring contents(_T("x"));
+        for (int32_t j = 0; j < i % 7; j++)
+            contents.append(j % 2 == 0 ? _T(" x") : _T(" y"));
+        doc.add(*_CLNEW Field(_T("contents"), contents.c_str(), Field::INDEX_TOKENIZED));
+        doc.add(*_CLNEW Field(_T("int"), std::to_wstring((i * 7) % 23 - 11).c_str(), Field::INDEX_UNTOKENIZED));
+        doc.add(*_CLNEW Field(_T("float"), std::to_wstring((i % 13) * 0.25f).c_str(), Field::INDEX_UNTOKENIZED));
+        wchar_t str[3] = { (wchar_t)(_T('a') + i % 5), (wchar_t)(_T('a') + i % 17), 0 };
+        doc.add(*_CLNEW Field(_T("string"), str, Field::INDEX_UNTOKENIZED));
+        writer.addDocument(&doc);
+    }
+    writer.close();
+
+    IndexSearcher searcher(&dir);
+    Term* t = _CLNEW Term(_T("contents"), _T("x"));
+    TermQuery query(t);
+    _CLDECDELETE(t);
+
+    Sort sort;
+    const int32_t nDocs[] = { 1, 10, 400 };
+    for (int32_t n = 0; n < 3; n++) {
+        sort.setSort(_CLNEW SortField(_T("int"), SortField::INT, false));
+        sortTopMatches(tc, &searcher, &query, &sort, nDocs[n]);
+        sort.setSort(_CLNEW SortField(_T("int"), SortField::AUTO, true));
+        sortTopMatches(tc, &searcher, &query, &sort, nDocs[n]);
+        sort.setSort(_CLNEW SortField(_T("float"), SortField::FLOAT, false));
+        sortTopMatches(tc, &searcher, &query, &sort, nDocs[n]);
+        sort.setSort(_CLNEW SortField(_T("string"), SortField::STRING, true));
+        sortTopMatches(tc, &searcher, &query, &sort, nDocs[n]);
+        sort.setSort(SortField::FIELD_SCORE());
+        sortTopMatches(tc, &searcher, &query, &sort, nDocs[n]);
+        sort.setSort(_CLNEW SortField(NULL, SortField::DOC, true));
+        sortTopMatches(tc, &searcher, &query, &sort, nDocs[n]);
+
+        // a key, then document order
+        sort.setSort(_T("string"), false);
+        sortTopMatches(tc, &searcher, &query, &sort, nDocs[n]);
+
+        // a key, then relevance
+        SortField* byStringThenScore[3] = { _CLNEW SortField(_T("string"), SortField::STRING, false), SortField::FIELD_SCORE(), NULL };
+        sort.setSort(byStringThenScore);
+        sortTopMatches(tc, &searcher, &query, &sort, nDocs[n]);
+        SortField* byIntThenScore[3] = { _CLNEW SortField(_T("int"), SortField::INT, true), SortField::FIELD_SCORE(), NULL };
+        sort.setSort(byIntThenScore);
+        sortTopMatches(tc, &searcher, &query, &sort, nDocs[n]);
+
+        // sorts the queue's comparators handle
+        const wchar_t* byIntThenString[3] = { _T("int"), _T("string"), NULL };
+        sort.setSort(byIntThenString);
+        sortTopMatches(tc, &searcher, &query, &sort, nDocs[n]);
+        SortField* byFloatThenDoc[3] = { _CLNEW SortField(_T("float"), SortField::FLOAT, false), _CLNEW SortField(NULL, SortField::DOC, true), NULL };
+        sort.setSort(byFloatThenDoc);
+        sortTopMatches(tc, &searcher, &query, &sort, nDocs[n]);
+    }
+    searcher.close();
+}
+
+// the values of the documents of testIndexSort, by their id
+static int32_t sortIndexInt(int32_t id) { return (id * 7) % 23 - 11; }
+static wchar_t sortIndexString(int32_t id) { return (wchar_t)(_T('a') + id % 5); }
+
+static void sortIndexAdd(IndexWriter& writer, int32_t id)
+{
+    Document doc;
+    doc.add(*_CLNEW Field(_T("id"), std::to_wstring(id).c_str(), Field::STORE_YES | Field::INDEX_UNTOKENIZED));
+    std::wstring contents(_T("x"));
+    for (int32_t j = 0; j < id % 9; j++)
+        contents.append(j % 2 == 0 ? _T(" y") : _T(" z"));
+    doc.add(*_CLNEW Field(_T("contents"), contents.c_str(), Field::INDEX_TOKENIZED | Field::TERMVECTOR_YES));
+    doc.add(*_CLNEW Field(_T("int"), std::to_wstring(sortIndexInt(id)).c_str(), Field::INDEX_UNTOKENIZED));
+    const wchar_t str[2] = { sortIndexString(id), 0 };
+    doc.add(*_CLNEW Field(_T("string"), str, Field::INDEX_UNTOKENIZED));
+    writer.addDocument(&doc);
+}
+
+static int32_t sortIndexId(IndexReader* reader, int32_t doc)
+{
+    Document stored;
+    reader->document(doc, stored);
+    return _wtoi(stored.get(_T("id")));
+}
+
+// sorted searches must find the same hits whether they end sorted segments early or not
+static void sortIndexSearches(CuTest* tc, Directory* dir, bool sorted)
+{
+    IndexSearcher searcher(dir);
+    Term* t = _CLNEW Term(_T("contents"), _T("x"));
+    TermQuery query(t);
+    _CLDECDELETE(t);
+
+    Sort sort;
+    for (int32_t s = 0; s < 4; s++) {
+        bool prefix = true;                 // the sort is the index sort, or begins it
+        if (s == 0) {
+            sort.setSort(_CLNEW SortField(_T("int"), SortField::INT, false));
+        } else if (s == 1) {
+            SortField* fields[3] = { _CLNEW SortField(_T("int"), SortField::INT, false), _CLNEW SortField(_T("string"), SortField::STRING, true), NULL };
+            sort.setSort(fields);
+        } else if (s == 2) {
+            sort.setSort(_CLNEW SortField(_T("int"), SortField::INT, true));
+            prefix = false;
+        } else {
+            sort.setSort(_CLNEW SortField(_T("string"), SortField::STRING, true));
+            prefix = false;
+        }
+        const int32_t nDocs[] = { 1, 10, 400 };
+        for (int32_t n = 0; n < 3; n++) {
+            searcher.setEarlyTermination(false);
+            TopFieldDocs* all = searcher._search(&query, NULL, nDocs[n], &sort);
+            searcher.setEarlyTermination(true);
+            TopFieldDocs* early = searcher._search(&query, NULL, nDocs[n], &sort);
+
+            CuAssertIntEquals(tc, _T("hits"), all->scoreDocsLength, early->scoreDocsLength);
+            for (int32_t i = 0; i < all->scoreDocsLength; i++)
+                CuAssertIntEquals(tc, _T("hit"), all->fieldDocs[i]->scoreDoc.doc, early->fieldDocs[i]->scoreDoc.doc);
+            CLUCENE_ASSERT(early->totalHits <= all->totalHits);
+            if (sorted && prefix && nDocs[n] < all->totalHits)
+                CLUCENE_ASSERT(early->totalHits < all->totalHits);
+            else if (!prefix)
+                CuAssertIntEquals(tc, _T("totalHits"), all->totalHits, early->totalHits);
+            _CLDELETE(all);
+            _CLDELETE(early);
+        }
+    }
+    searcher.close();
+}
+
+// merges write documents in the index sort of the writer
+void testIndexSort(CuTest *tc)
+{
+    RAMDirectory dir;
+    WhitespaceAnalyzer analyzer;
+    IndexWriter* writer = _CLNEW IndexWriter(&dir, &analyzer, true);
+    writer->setMaxBufferedDocs(50);
+    writer->setMergeFactor(100);             // no merges before optimize
+
+    SortField* fields[3] = { _CLNEW SortField(_T("int"), SortField::INT, false), _CLNEW SortField(_T("string"), SortField::STRING, true), NULL };
+    Sort indexSort(fields);
+    writer->setIndexSort(&indexSort);
+    Sort byScore(SortField::FIELD_SCORE());
+    try {
+        writer->setIndexSort(&byScore);
+        CuFail(tc, _T("a sort by relevance cannot be an index sort"));
+    } catch (CLuceneError& e) {
+        CuAssertIntEquals(tc, _T("error"), CL_ERR_IllegalArgument, e.number());
+    }
+    CLUCENE_ASSERT(writer->getIndexSorter() != NULL);
+
+    for (int32_t id = 0; id < 300; id++)
+        sortIndexAdd(*writer, id);
+    for (int32_t id = 0; id < 300; id += 11) {
+        Term* t = _CLNEW Term(_T("id"), std::to_wstring(id).c_str());
+        writer->deleteDocuments(t);
+        _CLDECDELETE(t);
+    }
+    writer->close();
+    _CLDELETE(writer);
+
+    // the norms and term vectors of each document before it moves
+    std::map<int32_t, uint8_t> norms;
+    std::map<int32_t, int32_t> vectorSizes;
+    IndexReader* reader = IndexReader::open(&dir);
+    CLUCENE_ASSERT(reader->getIndexSort() == NULL);
+    for (int32_t doc = 0; doc < reader->maxDoc(); doc++) {
+        if (reader->isDeleted(doc))
+            continue;
+        const int32_t id = sortIndexId(reader, doc);
+        norms[id] = reader->norms(_T("contents"))[doc];
+        TermFreqVector* vector = reader->getTermFreqVector(doc, _T("contents"));
+        vectorSizes[id] = vector->size();
+        _CLDELETE(vector);
+    }
+    reader->close();
+    _CLDELETE(reader);
+    sortIndexSearches(tc, &dir, false);
+
+    writer = _CLNEW IndexWriter(&dir, &analyzer, false);
+    writer->setIndexSort(&indexSort);
+    writer->optimize();
+    writer->close();
+    _CLDELETE(writer);
+
+    reader = IndexReader::open(&dir);
+    CLUCENE_ASSERT(reader->getIndexSort() != NULL);
+    CuAssertStrEquals(tc, _T("index sort"), _T("int:int,string:string!"), reader->getIndexSort());
+    CuAssertIntEquals(tc, _T("docs"), (int32_t)norms.size(), reader->maxDoc());
+    int32_t lastId = -1;
+    for (int32_t doc = 0; doc < reader->maxDoc(); doc++) {
+        const int32_t id = sortIndexId(reader, doc);
+        if (lastId >= 0) {
+            // by int, then by string in reverse, then in the order they were added
+            const int32_t c = sortIndexInt(lastId) != sortIndexInt(id) ? sortIndexInt(lastId) - sortIndexInt(id) :
+                (sortIndexString(id) != sortIndexString(lastId) ? sortIndexString(id) - sortIndexString(lastId) : lastId - id);
+            CLUCENE_ASSERT(c < 0);
+        }
+        lastId = id;
+
+        CuAssertIntEquals(tc, _T("norm"), norms[id], reader->norms(_T("contents"))[doc]);
+        TermFreqVector* vector = reader->getTermFreqVector(doc, _T("contents"));
+        CuAssertIntEquals(tc, _T("term vector"), vectorSizes[id], vector->size());
+        _CLDELETE(vector);
+
+        // the postings follow the documents
+        Term* t = _CLNEW Term(_T("id"), std::to_wstring(id).c_str());
+        TermDocs* termDocs = reader->termDocs(t);
+        _CLDECDELETE(t);
+        CLUCENE_ASSERT(termDocs->next());
+        CuAssertIntEquals(tc, _T("posting"), doc, termDocs->doc());
+        CLUCENE_ASSERT(!termDocs->next());
+        _CLDELETE(termDocs);
+    }
+    Term* t = _CLNEW Term(_T("contents"), _T("z"));
+    TermPositions* positions = reader->termPositions(t);
+    _CLDECDELETE(t);
+    int32_t lastDoc = -1;
+    while (positions->next()) {
+        CLUCENE_ASSERT(positions->doc() > lastDoc);
+        lastDoc = positions->doc();
+        const int32_t id = sortIndexId(reader, lastDoc);
+        CuAssertIntEquals(tc, _T("freq"), (id % 9) / 2, positions->freq());
+        for (int32_t j = 0; j < positions->freq(); j++)
+            CuAssertIntEquals(tc, _T("position"), 2 * j + 2, positions->nextPosition());
+    }
+    _CLDELETE(positions);
+    reader->close();
+    _CLDELETE(reader);
+    sortIndexSearches(tc, &dir, true);
+
+    // flushed segments keep the order the documents were added in
+    writer = _CLNEW IndexWriter(&dir, &analyzer, false);
+    writer->setIndexSort(&indexSort);
+    for (int32_t id = 300; id < 330; id++)
+        sortIndexAdd(*writer, id);
+    writer->close();
+    _CLDELETE(writer);
+    sortIndexSearches(tc, &dir, true);
+
+    dir.close();
+}
+
 CuSuite *testsort(void)
 {
     CuSuite *suite = CuSuiteNew(_T("CLucene Sort Test"));
@@ -570,6 +852,8 @@ CuSuite *testsort(void)
     SUITE_ADD_TEST(suite, testMultiSort);
     SUITE_ADD_TEST(suite, testNormalizedScores);
     SUITE_ADD_TEST(suite, testReverseSort);
+    SUITE_ADD_TEST(suite, testSortTopDocs);
+    SUITE_ADD_TEST(suite, testIndexSort);
 
     SUITE_ADD_TEST(suite, testSortCleanup);
     return suite;
@@ -7,6 +7,7 @@
 * the GNU Lesser General Public License, as specified in the COPYING file.
 ------------------------------------------------------------------------------*/
 #include "test.h"
+#include "CLucene/util/_Automaton.h"
 
 #ifndef NO_WILDCARD_QUERY
 
@@ -111,6 +112,211 @@ void _testWildcard(CuTest* tc, IndexSearcher* searcher, const wchar_t* qt, int e
 		_CLDELETE(reader);
 		_CLDELETE(searcher);
 	}
+
+	void _addWords(RAMDirectory* indexStore, const wchar_t** words){
+		SimpleAnalyzer an;
+		IndexWriter* writer = _CLNEW IndexWriter(indexStore, &an, true);
+		for ( int32_t i=0;words[i]!=NULL;i++ ){
+			Document doc;
+			doc.add(*_CLNEW Field(_T("body"), words[i],Field::STORE_YES | Field::INDEX_TOKENIZED));
+			writer->addDocument(&doc);
+		}
+		writer->close();
+		_CLDELETE(writer);
+	}
+
+	void testLeadingWildcard(CuTest *tc){
+		const wchar_t* words[] = { _T("metal"), _T("metals"), _T("petal"), _T("total"), _T("mXtals"), _T("tally"), NULL };
+		RAMDirectory indexStore;
+		_addWords(&indexStore, words);
+
+		IndexReader* reader = IndexReader::open(&indexStore);
+		IndexSearcher* searcher = _CLNEW IndexSearcher(reader);
+
+		_testWildcard(tc, searcher, _T("*tal"), 3);
+		_testWildcard(tc, searcher, _T("?etal*"), 3);
+		_testWildcard(tc, searcher, _T("*tal?"), 2);
+		_testWildcard(tc, searcher, _T("t*l*"), 2);
+		_testWildcard(tc, searcher, _T("*x*"), 1);
+		_testWildcard(tc, searcher, _T("*"), 6);
+		_testWildcard(tc, searcher, _T("*q*"), 0);
+
+		searcher->close();
+		reader->close();
+		_CLDELETE(reader);
+		_CLDELETE(searcher);
+	}
+
+	void _addTermGramWords(RAMDirectory* indexStore, const wchar_t** words, bool create){
+		SimpleAnalyzer an;
+		IndexWriter* writer = _CLNEW IndexWriter(indexStore, &an, create);
+		writer->setUseCompoundFile(!create);
+		for ( int32_t i=0;words[i]!=NULL;i++ ){
+			Document doc;
+			doc.add(*_CLNEW Field(_T("body"), words[i],Field::STORE_YES | Field::INDEX_TOKENIZED | Field::INDEX_TERMGRAMS));
+			writer->addDocument(&doc);
+		}
+		writer->close();
+		_CLDELETE(writer);
+	}
+
+	void _testTermGramWildcards(CuTest *tc, IndexReader* reader){
+		IndexSearcher* searcher = _CLNEW IndexSearcher(reader);
+		_testWildcard(tc, searcher, _T("*tal"), 3);
+		_testWildcard(tc, searcher, _T("?etal*"), 3);
+		_testWildcard(tc, searcher, _T("*tal?"), 2);
+		_testWildcard(tc, searcher, _T("*eta*"), 3);
+		_testWildcard(tc, searcher, _T("*x*"), 1);
+		_testWildcard(tc, searcher, _T("*"), 6);
+		_testWildcard(tc, searcher, _T("*qqq*"), 0);
+		searcher->close();
+		_CLDELETE(searcher);
+
+		std::vector<std::wstring> substrings;
+		std::vector<std::wstring> candidates;
+		substrings.push_back(_T("tal"));
+		CLUCENE_ASSERT(reader->getTermGramCandidates(_T("body"), substrings, candidates));
+		CLUCENE_ASSERT(candidates.size() == 6);
+		candidates.clear();
+		substrings.push_back(_T("ly"));
+		CLUCENE_ASSERT(reader->getTermGramCandidates(_T("body"), substrings, candidates));
+		substrings.clear();
+		substrings.push_back(_T("ta"));
+		candidates.clear();
+		CLUCENE_ASSERT(!reader->getTermGramCandidates(_T("body"), substrings, candidates));
+	}
+
+	void testTermGramWildcard(CuTest *tc){
+		const wchar_t* words1[] = { _T("metal"), _T("metals"), _T("petal"), NULL };
+		const wchar_t* words2[] = { _T("total"), _T("mXtals"), _T("tally"), NULL };
+		RAMDirectory indexStore;
+		_addTermGramWords(&indexStore, words1, true);
+		_addTermGramWords(&indexStore, words2, false);
+
+		IndexReader* reader = IndexReader::open(&indexStore);
+		_testTermGramWildcards(tc, reader);
+		reader->close();
+		_CLDELETE(reader);
+
+		//the merged segment gets a k-gram index of its own
+		SimpleAnalyzer an;
+		IndexWriter* writer = _CLNEW IndexWriter(&indexStore, &an, false);
+		writer->optimize();
+		writer->close();
+		_CLDELETE(writer);
+
+		reader = IndexReader::open(&indexStore);
+		_testTermGramWildcards(tc, reader);
+		reader->close();
+		_CLDELETE(reader);
+
+		//without the k-gram index the caller has to scan
+		const wchar_t* words[] = { _T("metal"), _T("total"), NULL };
+		RAMDirectory plainStore;
+		_addWords(&plainStore, words);
+		reader = IndexReader::open(&plainStore);
+		std::vector<std::wstring> substrings;
+		std::vector<std::wstring> candidates;
+		substrings.push_back(_T("tal"));
+		CLUCENE_ASSERT(!reader->getTermGramCandidates(_T("body"), substrings, candidates));
+		reader->close();
+		_CLDELETE(reader);
+	}
+
+	void testManyTerms(CuTest *tc){
+		//more terms than AutomatonTermEnum steps over before seeking
+		RAMDirectory indexStore;
+		SimpleAnalyzer an;
+		IndexWriter* writer = _CLNEW IndexWriter(&indexStore, &an, true);
+		wchar_t word[17];
+		for ( int32_t i=0;i<260;i++ ){
+			//metaa, metab, ... methz
+			_snwprintf(word, 17, _T("met%c%c"), _T('a') + i / 26, _T('a') + i % 26);
+			Document doc;
+			doc.add(*_CLNEW Field(_T("body"), word, Field::STORE_NO | Field::INDEX_TOKENIZED));
+			writer->addDocument(&doc);
+		}
+		for ( int32_t i=0;i<40;i++ ){
+			//baxxxxxxxxxxxxka, bcxxxxxxxxxxxxka, baxxxxxxxxxxxxkb, ...
+			_snwprintf(word, 17, _T("b%cxxxxxxxxxxxxk%c"), i % 2 == 0 ? _T('a') : _T('c'), _T('a') + i / 2);
+			Document doc;
+			doc.add(*_CLNEW Field(_T("body"), word, Field::STORE_NO | Field::INDEX_TOKENIZED));
+			writer->addDocument(&doc);
+		}
+		writer->close();
+		_CLDELETE(writer);
+
+		IndexReader* reader = IndexReader::open(&indexStore);
+		IndexSearcher* searcher = _CLNEW IndexSearcher(reader);
+
+		_testWildcard(tc, searcher, _T("met?a"), 10);
+		_testWildcard(tc, searcher, _T("me*z"), 10);
+		_testWildcard(tc, searcher, _T("*a"), 12);
+		_testWildcard(tc, searcher, _T("b?x*"), 40);
+		_testWildcard(tc, searcher, _T("met??"), 260);
+
+		//too many states to compile: terms are tested one by one instead
+		Automaton* automaton = Automaton::fromWildcard(_T("*a??????????????"));
+		CLUCENE_ASSERT(automaton == NULL);
+		_testWildcard(tc, searcher, _T("*a??????????????"), 20);
+		_testWildcard(tc, searcher, _T("b*a??????????????"), 20);
+
+		searcher->close();
+		reader->close();
+		_CLDELETE(reader);
+		_CLDELETE(searcher);
+	}
+
+	void _testRegexp(CuTest* tc, IndexSearcher* searcher, const wchar_t* qt, int expectedLen){
+		Term* term = _CLNEW Term(_T("body"), qt);
+		Query* query = _CLNEW RegexpQuery(term);
+		_CLDECDELETE(term);
+
+		Hits* result = searcher->search(query);
+		CLUCENE_ASSERT(expectedLen == result->length());
+		_CLDELETE(result);
+		_CLDELETE(query);
+	}
+
+	void testRegexp(CuTest *tc){
+		const wchar_t* words[] = { _T("metal"), _T("metals"), _T("petal"), _T("total"), _T("mXtals"), _T("tally"), NULL };
+		RAMDirectory indexStore;
+		_addWords(&indexStore, words);
+
+		IndexReader* reader = IndexReader::open(&indexStore);
+		IndexSearcher* searcher = _CLNEW IndexSearcher(reader);
+
+		_testRegexp(tc, searcher, _T("m.tals?"), 3);
+		_testRegexp(tc, searcher, _T("[pt].*"), 3);
+		_testRegexp(tc, searcher, _T("(me|pe)tal"), 2);
+		_testRegexp(tc, searcher, _T("ta(l|x){2}y"), 1);
+		_testRegexp(tc, searcher, _T("[^m].{4}"), 3);
+		_testRegexp(tc, searcher, _T("metal"), 1);
+		_testRegexp(tc, searcher, _T("meta"), 0);
+
+		Term* term = _CLNEW Term(_T("body"), _T("m.tals?"));
+		RegexpQuery* query = _CLNEW RegexpQuery(term);
+		CuAssertStrEquals(tc, NULL, _T("/m.tals?/"), query->toString(_T("body")).c_str());
+		Query* clone = query->clone();
+		CLUCENE_ASSERT(query->equals(clone));
+		_CLDELETE(clone);
+		_CLDELETE(query);
+		_CLDECDELETE(term);
+
+		term = _CLNEW Term(_T("body"), _T("(metal"));
+		try {
+			RegexpQuery bad(term);
+			CuFail(tc, _T("unbalanced regexp did not throw an exception"));
+		} catch (CLuceneError& e) {
+			CLUCENE_ASSERT(e.number() == CL_ERR_Parse);
+		}
+		_CLDECDELETE(term);
+
+		searcher->close();
+		reader->close();
+		_CLDELETE(reader);
+		_CLDELETE(searcher);
+	}
 #else
 	void _NO_WILDCARD_QUERY(CuTest *tc){
 		CuNotImpl(tc,_T("Wildcard"));
@@ -125,6 +331,10 @@ CuSuite *testwildcard(void)
 	#ifndef NO_WILDCARD_QUERY
 		SUITE_ADD_TEST(suite, testQuestionmark);
 		SUITE_ADD_TEST(suite, testAsterisk);
+		SUITE_ADD_TEST(suite, testLeadingWildcard);
+		SUITE_ADD_TEST(suite, testTermGramWildcard);
+		SUITE_ADD_TEST(suite, testManyTerms);
+		SUITE_ADD_TEST(suite, testRegexp);
 	#else
 		SUITE_ADD_TEST(suite, _NO_WILDCARD_QUERY);
     #endif
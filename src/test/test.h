@@ -77,6 +77,7 @@ CuSuite *testBoolean(void);
 CuSuite *testBitSet(void);
 CuSuite *testExtractTerms(void);
 CuSuite *testSpanQueries(void);
+CuSuite *testFunctionQuery(void);
 CuSuite *testStringBuffer(void);
 CuSuite *testTermVectorsReader(void);
 
@@ -43,6 +43,7 @@ unittest tests[] = {
     {"bitset", testBitSet},
     {"extractterms",testExtractTerms},
     {"spanqueries",testSpanQueries},
+    {"functionqueries",testFunctionQuery},
     {"stringbuffer", testStringBuffer},
     {"termvectorsreader",testTermVectorsReader},
 #ifdef TEST_CONTRIB_LIBS